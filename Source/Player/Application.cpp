@@ -33,6 +33,7 @@ static void RegisterApp(LuaCpp::Module &module) {
 
 void Application::Init() {
     BE1::cmdSystem.AddCommand("map", Cmd_Map_f);
+    BE1::cmdSystem.AddCommand("cookMap", Cmd_CookMap_f);
 
     BE1::prefabManager.Init();
 
@@ -60,6 +61,7 @@ void Application::Shutdown() {
     BE1::GameSettings::Shutdown();
 
     BE1::cmdSystem.RemoveCommand("map");
+    BE1::cmdSystem.RemoveCommand("cookMap");
 }
 
 bool Application::LoadAppScript(const char *sandboxName) {
@@ -156,3 +158,19 @@ void Application::Cmd_Map_f(const BE1::CmdArgs &args) {
 
     app.LoadMap(filename.c_str());
 }
+
+void Application::Cmd_CookMap_f(const BE1::CmdArgs &args) {
+    if (args.Argc() != 2) {
+        BE_LOG("cookMap <filename>\n");
+        return;
+    }
+
+    BE1::Str filename;
+    filename.sPrintf("maps/%s", args.Argv(1));
+    filename.DefaultFileExtension(".map");
+
+    BE1::Str cookedFilename = filename;
+    cookedFilename.SetFileExtension(".bmap");
+
+    BE1::GameWorld::CookMap(filename.c_str(), cookedFilename.c_str());
+}
@@ -42,6 +42,7 @@ public:
     LuaCpp::Selector        sandbox;
     
     static void             Cmd_Map_f(const BE1::CmdArgs &args);
+    static void             Cmd_CookMap_f(const BE1::CmdArgs &args);
 };
 
 extern Application          app;
@@ -17,6 +17,7 @@
 #include "Animator/Animator.h"
 #include "Asset/GuidMapper.h"
 #include "Core/JointPose.h"
+#include "Core/ScratchAllocator.h"
 #include "Simd/Simd.h"
 #include "File/File.h"
 
@@ -461,7 +462,9 @@ void AnimBlendTree::GetFrame(const Animator *animator, float normalizedTime, int
         float weights[AnimLayer::MaxBlendTreeChildren] = { 0, };
         ComputeChildrenWeights(animator, weights);
 
-        JointPose *mixSrcFrame = (JointPose *)_alloca16(numJoints * sizeof(outJointFrame[0]));
+        ScratchAllocator::Scope scratchScope;
+
+        JointPose *mixSrcFrame = scratchAllocator.Alloc<JointPose>(numJoints);
         JointPose *ptr = outJointFrame;
 
         float blendedWeight = 0.0f;
@@ -109,20 +109,18 @@ int AnimState::GetDuration(const Animator *animator) const {
     return animClip->Length();
 }
 
-void AnimState::GetFrame(const Animator *animator, float normalizedTime, int numJoints, JointPose *outJointPose) const {
-    const Array<int> &maskJoints = animLayer->GetMaskJoints();
-
+void AnimState::GetFrame(const Animator *animator, float normalizedTime, int numMaskJoints, const int *maskJoints, int numJoints, JointPose *outJointPose) const {
     if (IS_ANIM_NODE(nodeNum)) {
         const AnimBlendTree *blendTree = animLayer->GetNodeAnimBlendTree(nodeNum);
         if (blendTree) {
-            blendTree->GetFrame(animator, normalizedTime, maskJoints.Count(), maskJoints.Ptr(), numJoints, outJointPose);
+            blendTree->GetFrame(animator, normalizedTime, numMaskJoints, maskJoints, numJoints, outJointPose);
         }
     } else {
         Anim::FrameInterpolation frameInterpolation;
         const AnimClip *animClip = animLayer->GetNodeAnimClip(nodeNum);
         if (animClip) {
             animClip->TimeToFrameInterpolation(normalizedTime * animClip->Length(), frameInterpolation);
-            animClip->GetInterpolatedFrame(frameInterpolation, maskJoints.Count(), maskJoints.Ptr(), outJointPose);
+            animClip->GetInterpolatedFrame(frameInterpolation, numMaskJoints, maskJoints, outJointPose);
         }
     }
 }
@@ -17,6 +17,7 @@
 #include "AnimController/AnimState.h"
 #include "Animator/Animator.h"
 #include "Core/JointPose.h"
+#include "Core/ScratchAllocator.h"
 #include "Simd/Simd.h"
 #include "Game/Entity.h"
 #include "Components/ComScript.h"
@@ -174,7 +175,7 @@ void AnimStateBlender::CallEvents(Entity *entity, int fromTime, int toTime) {
     }
 }
 
-bool AnimStateBlender::BlendFrame(int currentTime, int numJoints, JointPose *blendedFrame, float &blendedWeight) const {
+bool AnimStateBlender::BlendFrame(int currentTime, int numMaskJoints, const int *maskJoints, int numJoints, JointPose *blendedFrame, float &blendedWeight) const {
     if (!animState) {
         return false;
     }
@@ -185,18 +186,20 @@ bool AnimStateBlender::BlendFrame(int currentTime, int numJoints, JointPose *ble
         return false;
     }
 
+    ScratchAllocator::Scope scratchScope;
+
     JointPose *jointFrame;
     if (blendedWeight == 0.0f) {
         // we don't need a temporary buffer, so just store it directly in the blendedFrame
         jointFrame = blendedFrame;
     } else {
         // allocate a temporary buffer to copy the joints from
-        jointFrame = (JointPose *)_alloca16(numJoints * sizeof(jointFrame[0]));
+        jointFrame = scratchAllocator.Alloc<JointPose>(numJoints);
     }
 
     float time = NormalizedTime(currentTime);
 
-    animState->GetFrame(animator, time, numJoints, jointFrame);
+    animState->GetFrame(animator, time, numMaskJoints, maskJoints, numJoints, jointFrame);
 
     if (blendedWeight == 0.0f) {
         blendedWeight = currentWeight;
@@ -204,8 +207,7 @@ bool AnimStateBlender::BlendFrame(int currentTime, int numJoints, JointPose *ble
         blendedWeight += currentWeight;
         float fraction = currentWeight / blendedWeight;
 
-        const Array<int> &maskJoints = animState->animLayer->GetMaskJoints();
-        simdProcessor->BlendJoints(blendedFrame, jointFrame, fraction, maskJoints.Ptr(), maskJoints.Count());
+        simdProcessor->BlendJoints(blendedFrame, jointFrame, fraction, maskJoints, numMaskJoints);
     }
 
     return true;
@@ -20,6 +20,7 @@
 #include "Animator/Animator.h"
 #include "Simd/Simd.h"
 #include "Core/JointPose.h"
+#include "Core/ScratchAllocator.h"
 #include "Game/Entity.h"
 
 BE_NAMESPACE_BEGIN
@@ -29,6 +30,7 @@ Animator::Animator() {
     numJoints = 0;
     jointMats = nullptr;
     ignoreRootTranslation = false;
+    lodJointMaskEnabled = false;
 
     for (int i = 0; i < MaxLayers; i++) {
         for (int j = 0; j < MaxBlendersPerLayer; j++) {
@@ -57,12 +59,20 @@ void Animator::FreeData() {
         jointMats = nullptr;
     }
 
+    for (int i = 0; i < MaxLayers; i++) {
+        lodMaskJoints[i].Clear();
+    }
+
     numJoints = 0;
     animController = nullptr;
 }
 
 size_t Animator::Allocated() const {
-    return numJoints * sizeof(jointMats[0]);
+    size_t size = numJoints * sizeof(jointMats[0]);
+    for (int i = 0; i < MaxLayers; i++) {
+        size += lodMaskJoints[i].Allocated();
+    }
+    return size;
 }
 
 size_t Animator::Size() const {
@@ -219,6 +229,56 @@ void Animator::SetAnimController(const Str &name) {
     for (int i = 0; i < parameters.Count(); i++) {
         parameters[i] = 0;
     }
+
+    BuildLodMaskJoints();
+}
+
+void Animator::SetLodJointMask(const char *jointNames) {
+    lodJointMask = jointNames;
+
+    BuildLodMaskJoints();
+}
+
+void Animator::BuildLodMaskJoints() {
+    for (int i = 0; i < MaxLayers; i++) {
+        lodMaskJoints[i].Clear();
+    }
+
+    if (!animController || lodJointMask.IsEmpty()) {
+        return;
+    }
+
+    Array<int> lodJoints;
+    animController->GetJointNumListByString(lodJointMask, lodJoints);
+
+    Array<bool> isLodJoint;
+    isLodJoint.SetCount(numJoints);
+    isLodJoint.Fill(false);
+    for (int i = 0; i < lodJoints.Count(); i++) {
+        isLodJoint[lodJoints[i]] = true;
+    }
+
+    // Keep the order of the layer mask joints
+    for (int i = 0; i < MaxLayers; i++) {
+        const AnimLayer *animLayer = animController->GetAnimLayerByIndex(i);
+        if (!animLayer) {
+            break;
+        }
+
+        const Array<int> &maskJoints = animLayer->GetMaskJoints();
+        for (int j = 0; j < maskJoints.Count(); j++) {
+            if (isLodJoint[maskJoints[j]]) {
+                lodMaskJoints[i].Append(maskJoints[j]);
+            }
+        }
+    }
+}
+
+const Array<int> &Animator::GetLayerMaskJoints(int layerNum) const {
+    if (lodJointMaskEnabled && !lodJointMask.IsEmpty()) {
+        return lodMaskJoints[layerNum];
+    }
+    return animController->GetAnimLayerByIndex(layerNum)->GetMaskJoints();
 }
 
 const char *Animator::GetJointName(int jointIndex) const {
@@ -354,8 +414,11 @@ void Animator::ComputeFrame(int currentTime) {
         return;
     }
 
+    // Temporary buffers are allocated from the scratch memory, this function can be called from the job system workers
+    ScratchAllocator::Scope scratchScope;
+
     // Temporary buffer for the joint poses of base layer
-    JointPose *jointFrame1 = (JointPose *)_alloca16(numJoints * sizeof(jointFrame1[0]));
+    JointPose *jointFrame1 = scratchAllocator.Alloc<JointPose>(numJoints);
     // Copy bindposes for all joints
     // Masked joints will be calculated against a layer so unmasked joints still have bindposes
     simdProcessor->Memcpy(jointFrame1, bindPoses, numJoints * sizeof(jointFrame1[0]));
@@ -363,11 +426,12 @@ void Animator::ComputeFrame(int currentTime) {
     bool hasAnim = false;
 
     // Blending animation state only for base layer 
+    const Array<int> &baseMaskJoints = GetLayerMaskJoints(0);
     float blendedWeight = 0.0f;
     AnimStateBlender *stateBlender = layerAnimStateBlenders[0];
     for (int i = 0; i < MaxBlendersPerLayer; i++, stateBlender++) {
         if (stateBlender->animState) {
-            if (stateBlender->BlendFrame(currentTime, numJoints, jointFrame1, blendedWeight)) {
+            if (stateBlender->BlendFrame(currentTime, baseMaskJoints.Count(), baseMaskJoints.Ptr(), numJoints, jointFrame1, blendedWeight)) {
                 hasAnim = true;
                 if (blendedWeight >= 1.0f) {
                     break;
@@ -377,7 +441,7 @@ void Animator::ComputeFrame(int currentTime) {
     }
 
     // Temporary buffer for the joint poses of the other layers
-    JointPose *jointFrame2 = (JointPose *)_alloca16(numJoints * sizeof(jointFrame2[0]));
+    JointPose *jointFrame2 = scratchAllocator.Alloc<JointPose>(numJoints);
 
     // Blending animation state for other layers
     for (int i = 1; i < MaxLayers; i++) {
@@ -386,11 +450,14 @@ void Animator::ComputeFrame(int currentTime) {
             break;
         }
 
+        // other layers have the mask joints
+        const Array<int> &maskJoints = GetLayerMaskJoints(i);
+
         blendedWeight = 0.0f;        
         stateBlender = layerAnimStateBlenders[i];
         for (int j = 0; j < MaxBlendersPerLayer; j++, stateBlender++) {
             if (stateBlender->animState) {
-                if (stateBlender->BlendFrame(currentTime, numJoints, jointFrame2, blendedWeight)) {
+                if (stateBlender->BlendFrame(currentTime, maskJoints.Count(), maskJoints.Ptr(), numJoints, jointFrame2, blendedWeight)) {
                     hasAnim = true;
                     if (blendedWeight >= 1.0f) {
                         break;
@@ -401,8 +468,6 @@ void Animator::ComputeFrame(int currentTime) {
 
         // layer 의 blended weight 가 있다면 layer 끼리 블렌딩한다
         if (blendedWeight > 0) {
-            // other layers have the mask joints
-            const Array<int> &maskJoints = animLayer->GetMaskJoints();
             float layerBlendWeight = blendedWeight * animLayer->GetWeight(); // NOTE: anim layer weight -- is it really necessary ?
 
             if (animLayer->GetBlending() == AnimLayer::Blending::Override) {
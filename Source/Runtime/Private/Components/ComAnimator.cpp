@@ -23,6 +23,8 @@
 
 BE_NAMESPACE_BEGIN
 
+static CVAR(anim_parallelUpdate, "1", CVar::Flag::Bool, "Compute the animator frames in parallel after updating entities");
+
 OBJECT_DECLARATION("Animator", ComAnimator, Component)
 BEGIN_EVENTS(ComAnimator)
 END_EVENTS
@@ -30,10 +32,30 @@ END_EVENTS
 void ComAnimator::RegisterProperties() {
     REGISTER_MIXED_ACCESSOR_PROPERTY("animController", "Anim Controller", Guid, GetAnimControllerGuid, SetAnimControllerGuid, GuidMapper::defaultAnimControllerGuid, 
         "", PropertyInfo::Flag::Editor).SetMetaObject(&AnimControllerAsset::metaObject);
+    REGISTER_PROPERTY("cullingMode", "Culling Mode", CullingMode::Enum, cullingMode, CullingMode::AlwaysAnimate,
+        "", PropertyInfo::Flag::Editor).SetEnumString("Always Animate;Cull Completely");
+    REGISTER_PROPERTY("useLod", "LOD/Use LOD", bool, useLod, false,
+        "Reduce the update rate and the joint set by the screen size", PropertyInfo::Flag::Editor);
+    REGISTER_PROPERTY("lodScreenSize", "LOD/Screen Size", float, lodScreenSize, 0.25f,
+        "Screen size under which the update rate is reduced", PropertyInfo::Flag::Editor).SetRange(0, 4, 0.01f);
+    REGISTER_PROPERTY("lodMaxUpdateInterval", "LOD/Max Update Interval", int, lodMaxUpdateInterval, 4,
+        "Maximum number of frames between the updates", PropertyInfo::Flag::Editor).SetRange(1, 16, 1);
+    REGISTER_MIXED_ACCESSOR_PROPERTY("lodJointMask", "LOD/Joint Mask", Str, GetLodJointMask, SetLodJointMask, "",
+        "Joints to evaluate when the update rate is reduced. Same syntax with the layer joint mask. Empty means all joints", PropertyInfo::Flag::Editor);
 }
 
 ComAnimator::ComAnimator() {
     animControllerAsset = nullptr;
+    animUpdatePending = false;
+
+    cullingMode = CullingMode::AlwaysAnimate;
+    useLod = false;
+    lodScreenSize = 0.25f;
+    lodMaxUpdateInterval = 4;
+
+    lodFrameCount = 0;
+    visibleTime = -1;
+    visibleScreenSize = 0.0f;
 }
 
 ComAnimator::~ComAnimator() {
@@ -48,6 +70,11 @@ bool ComAnimator::IsConflictComponent(const MetaObject &componentClass) const {
 }
 
 void ComAnimator::Purge(bool chainPurge) {
+    if (animUpdatePending) {
+        GetGameWorld()->UnregisterAnimatorToUpdate(this);
+        animUpdatePending = false;
+    }
+
     animator.ClearAnimController();
 
     if (chainPurge) {
@@ -58,6 +85,8 @@ void ComAnimator::Purge(bool chainPurge) {
 void ComAnimator::Init() {
     Component::Init();
 
+    lodFrameCount = GetInstanceID();
+
     // Mark as initialized
     SetInitialized(true);
 }
@@ -81,7 +110,39 @@ void ComAnimator::Update() {
 
     int currentTime = GetGameWorld()->GetTime();
 
-    UpdateAnim(currentTime);
+    GameWorld::AnimatorCounter &animatorCounter = GetGameWorld()->GetAnimatorCounter();
+
+    // Keep the last frame while the skinned meshes are not visible
+    if (cullingMode == CullingMode::CullCompletely && visibleTime < GetGameWorld()->GetPrevTime()) {
+        animatorCounter.numSkipped++;
+        return;
+    }
+
+    int updateInterval = ComputeUpdateInterval();
+    if (updateInterval > 1) {
+        animatorCounter.numThrottled++;
+
+        animator.EnableLodJointMask(true);
+
+        // Time-sliced updates, staggered across the animators by the instance ID
+        if (lodFrameCount++ % updateInterval) {
+            return;
+        }
+    } else {
+        animatorCounter.numFullUpdates++;
+
+        animator.EnableLodJointMask(false);
+    }
+
+    if (anim_parallelUpdate.GetBool()) {
+        // Frame will be computed with the other animators after updating all the entities
+        if (!animUpdatePending) {
+            GetGameWorld()->RegisterAnimatorToUpdate(this);
+            animUpdatePending = true;
+        }
+    } else {
+        UpdateAnim(currentTime);
+    }
 }
 
 void ComAnimator::UpdateAnim(int currentTime) {
@@ -95,6 +156,52 @@ void ComAnimator::UpdateAnim(int currentTime) {
     animator.GetAABB(renderObjectDef.localAABB);*/
 }
 
+void ComAnimator::UpdatePendingAnim(int currentTime) {
+    animUpdatePending = false;
+
+    UpdateAnim(currentTime);
+}
+
+int ComAnimator::ComputeUpdateInterval() const {
+    if (!useLod) {
+        return 1;
+    }
+
+    // Not visible but always animated
+    if (visibleTime < GetGameWorld()->GetPrevTime()) {
+        return lodMaxUpdateInterval;
+    }
+
+    if (visibleScreenSize >= lodScreenSize) {
+        return 1;
+    }
+
+    // Halving the screen size doubles the update interval
+    return Clamp((int)(lodScreenSize / Max(visibleScreenSize, 0.0001f)), 1, lodMaxUpdateInterval);
+}
+
+void ComAnimator::NotifyVisible(float screenSize) {
+    int currentTime = GetGameWorld()->GetTime();
+
+    // Take the largest one if there are multiple skinned meshes
+    if (visibleTime != currentTime) {
+        visibleTime = currentTime;
+        visibleScreenSize = screenSize;
+    } else {
+        visibleScreenSize = Max(visibleScreenSize, screenSize);
+    }
+}
+
+Str ComAnimator::GetLodJointMask() const {
+    return lodJointMask;
+}
+
+void ComAnimator::SetLodJointMask(const Str &lodJointMask) {
+    this->lodJointMask = lodJointMask;
+
+    animator.SetLodJointMask(lodJointMask);
+}
+
 const char *ComAnimator::GetCurrentAnimState(int layerNum) const {
     const AnimState *animState = animator.CurrentAnimState(layerNum);
     if (animState) {
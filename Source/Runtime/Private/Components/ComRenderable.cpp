@@ -65,7 +65,13 @@ void ComRenderable::Purge(bool chainPurge) {
         renderWorld = nullptr;
     }
 
-    staticBatchIndex = -1;
+    if (staticBatchIndex >= 0) {
+        StaticBatch *staticBatch = StaticBatch::GetStaticBatchByIndex(staticBatchIndex);
+        if (staticBatch) {
+            staticBatch->RemoveRenderable(this);
+        }
+        staticBatchIndex = -1;
+    }
 
     if (chainPurge) {
         Component::Purge();
@@ -77,6 +83,7 @@ void ComRenderable::Init() {
 
     renderWorld = GetGameWorld()->GetRenderWorld();
 
+    renderObjectDef.userPointer = this;
     renderObjectDef.layer = GetEntity()->GetLayer();
     renderObjectDef.staticMask = GetEntity()->GetStaticMask();
     renderObjectDef.wireframeColor.Set(1, 1, 1, 1);
@@ -142,7 +149,11 @@ const AABB ComRenderable::GetAABB() {
 }
 
 bool ComRenderable::IntersectRay(const Ray &ray, bool backFaceCull, float *hitDist) const {
-    if (!renderObjectDef.mesh) {
+    return IntersectRayMesh(renderObjectDef.mesh, ray, backFaceCull, hitDist);
+}
+
+bool ComRenderable::IntersectRayMesh(const Mesh *mesh, const Ray &ray, bool backFaceCull, float *hitDist) const {
+    if (!mesh) {
         return false;
     }
 
@@ -153,11 +164,11 @@ bool ComRenderable::IntersectRay(const Ray &ray, bool backFaceCull, float *hitDi
     localRay.dir = worldToLocal.TransformNormal(ray.dir);
     //localRay.dir.Normalize();
 
-    if (!renderObjectDef.mesh->GetAABB().IntersectRay(localRay, hitDist)) {
+    if (!mesh->GetAABB().IntersectRay(localRay, hitDist)) {
         return false;
     }
 
-    if (!renderObjectDef.mesh->IntersectRay(localRay, backFaceCull, hitDist)) {
+    if (!mesh->IntersectRay(localRay, backFaceCull, hitDist)) {
         return false;
     }
 
@@ -21,6 +21,7 @@
 #include "Components/ComAnimator.h"
 #include "AnimController/AnimController.h"
 #include "Game/GameWorld.h"
+#include "Simd/Simd.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -105,6 +106,16 @@ void ComSkinnedMeshRenderer::UpdateSkeleton() {
 void ComSkinnedMeshRenderer::Update() { 
     if (IsVisibleInPreviousFrame()) {
         UpdateVisuals();
+
+        // Let the animator know the screen size for the animation LOD
+        Object *rootObject = Entity::FindInstance(rootGuid);
+        if (rootObject) {
+            ComAnimator *animatorComponent = rootObject->Cast<Entity>()->GetComponent<ComAnimator>();
+            if (animatorComponent) {
+                const RenderObject *renderObject = renderWorld->GetRenderObject(renderObjectHandle);
+                animatorComponent->NotifyVisible(renderObject->GetScreenSize());
+            }
+        }
     }
 }
 
@@ -119,6 +130,26 @@ void ComSkinnedMeshRenderer::UpdateVisuals() {
     ComRenderable::UpdateVisuals();
 }
 
+bool ComSkinnedMeshRenderer::IntersectRay(const Ray &ray, bool backFaceCull, float *hitDist) const {
+    if (!renderObjectDef.mesh || !renderObjectDef.skeleton || !renderObjectDef.joints) {
+        return ComMeshRenderer::IntersectRay(ray, backFaceCull, hitDist);
+    }
+
+    Mat3x4 *skinningJoints = (Mat3x4 *)_alloca16(renderObjectDef.numJoints * sizeof(skinningJoints[0]));
+    simdProcessor->MultiplyJoints(skinningJoints, renderObjectDef.joints, renderObjectDef.skeleton->GetInvBindPoseMatrices(), renderObjectDef.numJoints);
+
+    renderObjectDef.mesh->PoseTriangleBVHs(skinningJoints);
+
+    Mat3x4 worldToLocal = renderObjectDef.worldMatrix.Inverse();
+
+    Ray localRay;
+    localRay.origin = worldToLocal.Transform(ray.origin);
+    localRay.dir = worldToLocal.TransformNormal(ray.dir);
+
+    // Posed triangles can be out of the AABB of the mesh in the bind pose, so no AABB test here
+    return renderObjectDef.mesh->IntersectRay(localRay, backFaceCull, hitDist);
+}
+
 Guid ComSkinnedMeshRenderer::GetRootGuid() const {
     return rootGuid;
 }
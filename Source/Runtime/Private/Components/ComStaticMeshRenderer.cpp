@@ -64,6 +64,15 @@ void ComStaticMeshRenderer::Init() {
 void ComStaticMeshRenderer::Update() {
 }
 
+bool ComStaticMeshRenderer::IntersectRay(const Ray &ray, bool backFaceCull, float *hitDist) const {
+    // The root of a static batch renders the combined mesh, which includes the meshes of the other renderers in the batch
+    if (staticBatchIndex >= 0) {
+        return IntersectRayMesh(referenceMesh, ray, backFaceCull, hitDist);
+    }
+
+    return ComRenderable::IntersectRay(ray, backFaceCull, hitDist);
+}
+
 void ComStaticMeshRenderer::MeshUpdated() {
     if (!IsInitialized()) {
         return;
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Allocator.h"
 #include "Components/ComTransform.h"
 #include "Components/ComRigidBody.h"
 #include "Components/ComVehicleWheel.h"
@@ -47,6 +48,21 @@ ComTransform::ComTransform() {
 ComTransform::~ComTransform() {
 }
 
+struct ComTransformStorage {
+    byte                    data[sizeof(ComTransform)];
+};
+
+static BlockAllocator<ComTransformStorage, 256> transformAllocator;
+
+void *ComTransform::operator new(size_t size) {
+    assert(size == sizeof(ComTransformStorage));
+    return transformAllocator.Alloc();
+}
+
+void ComTransform::operator delete(void *ptr) {
+    transformAllocator.Free(reinterpret_cast<ComTransformStorage *>(ptr));
+}
+
 ComTransform *ComTransform::GetParent() const { 
     const Entity *parent = GetEntity()->GetNode().GetParent();
     if (!parent) {
@@ -15,6 +15,9 @@
 #include "Precompiled.h"
 #include "Core/DynamicAABBTree.h"
 #include "Core/Heap.h"
+#if defined(__X86__)
+#include "Simd/SSE/sse.h"
+#endif
 
 BE_NAMESPACE_BEGIN
 
@@ -24,14 +27,27 @@ const float     DISPLACEMENT_MULTIPLIER     = 2.0f;
 DynamicAABBTree::DynamicAABBTree() {
     nodeCapacity = DEFAULT_CAPACITY;
     nodes = (Node *)Mem_Alloc(nodeCapacity * sizeof(nodes[0]));
+
+    queryNodes = nullptr;
+    queryNodeCount = 0;
+    queryNodeCapacity = 0;
+    queryLeafSlots = nullptr;
+    queryLeafSlotCapacity = 0;
+    numQueryRefits = 0;
+    queryTreeValid = false;
+
     Purge();
 }
 
 DynamicAABBTree::~DynamicAABBTree() {
     Mem_Free(nodes);
+
+    FreeQueryTree();
 }
 
 void DynamicAABBTree::Purge(bool clearNodes) {
+    queryTreeValid = false;
+
     if (clearNodes) {
         Mem_Free(nodes);
         nodeCapacity = DEFAULT_CAPACITY;
@@ -106,6 +122,9 @@ void DynamicAABBTree::FreeNode(int32_t nodeId) {
 // Create a proxy in the tree as a leaf node. We return the index
 // of the node instead of a pointer so that we can grow the node pool.
 int32_t DynamicAABBTree::CreateProxy(const AABB &aabb, float expansion, void *userData) {
+    // New proxies are added to the query tree by rebuilding.
+    queryTreeValid = false;
+
     int32_t proxyId = AllocNode();
 
     // Fatten the aabb.
@@ -123,6 +142,10 @@ void DynamicAABBTree::DestroyProxy(int32_t proxyId) {
     assert(0 <= proxyId && proxyId < nodeCapacity);
     assert(nodes[proxyId].IsLeaf());
 
+    if (queryTreeValid) {
+        RemoveQueryLeaf(proxyId);
+    }
+
     RemoveLeaf(proxyId);
     FreeNode(proxyId);
 }
@@ -165,6 +188,10 @@ bool DynamicAABBTree::MoveProxy(int32_t proxyId, const AABB &aabb, float expansi
     nodes[proxyId].aabb = b;
 
     InsertLeaf(proxyId);
+
+    if (queryTreeValid) {
+        RefitQueryLeaf(proxyId);
+    }
     return true;
 }
 
@@ -614,6 +641,8 @@ void DynamicAABBTree::RebuildBottomUp() {
         return;
     }
 
+    queryTreeValid = false;
+
     int32_t *nodeIndexes = (int32_t *)Mem_Alloc(nodeCount * sizeof(int32_t));
     int32_t count = 0;
 
@@ -678,6 +707,508 @@ void DynamicAABBTree::RebuildBottomUp() {
     Validate();
 }
 
+//-------------------------------------------------------------------------------------------------
+// 4-wide query tree
+//
+// Each query node holds the bounds of up to 4 children in SoA layout, so one node visit tests
+// all of its children with a single SIMD comparison per plane/axis. Query nodes are built by
+// collapsing the binary tree, opening the largest internal child until 4 children are collected.
+// Children keep the depth-first order of the binary tree, so queries report proxies in the same
+// order as the binary tree traversal until moved proxies are refitted in their old places.
+// GetQuerySubtrees() and QuerySubtree() collect and traverse the query tree as well, so parallel
+// queries always report proxies in the same order as Query().
+//-------------------------------------------------------------------------------------------------
+
+static constexpr int32_t QUERY_EMPTY_CHILD = -1;
+static constexpr int32_t QUERY_MAX_STACK_DEPTH = 256;
+
+// Leaf children are encoded as -(proxyId + 2).
+BE_INLINE static bool IsQueryLeaf(int32_t child) { return child < QUERY_EMPTY_CHILD; }
+BE_INLINE static int32_t ToQueryLeaf(int32_t proxyId) { return -(proxyId + 2); }
+BE_INLINE static int32_t FromQueryLeaf(int32_t child) { return -child - 2; }
+
+struct ALIGN_AS16 DynamicAABBTree::QueryNode {
+    float           minX[4];
+    float           minY[4];
+    float           minZ[4];
+    float           maxX[4];
+    float           maxY[4];
+    float           maxZ[4];
+    int32_t         children[4];
+    int32_t         parentSlot;             ///< Parent query node index * 4 + child slot, -1 for the root
+
+    void SetChildBounds(int slot, const AABB &aabb) {
+        minX[slot] = aabb[0].x; minY[slot] = aabb[0].y; minZ[slot] = aabb[0].z;
+        maxX[slot] = aabb[1].x; maxY[slot] = aabb[1].y; maxZ[slot] = aabb[1].z;
+    }
+
+    void AddChildBounds(int slot, const AABB &aabb) {
+        minX[slot] = Min(minX[slot], aabb[0].x); minY[slot] = Min(minY[slot], aabb[0].y); minZ[slot] = Min(minZ[slot], aabb[0].z);
+        maxX[slot] = Max(maxX[slot], aabb[1].x); maxY[slot] = Max(maxY[slot], aabb[1].y); maxZ[slot] = Max(maxZ[slot], aabb[1].z);
+    }
+
+    bool IsContainChildBounds(int slot, const AABB &aabb) const {
+        return minX[slot] <= aabb[0].x && minY[slot] <= aabb[0].y && minZ[slot] <= aabb[0].z &&
+            maxX[slot] >= aabb[1].x && maxY[slot] >= aabb[1].y && maxZ[slot] >= aabb[1].z;
+    }
+
+    void ClearChild(int slot) {
+        children[slot] = QUERY_EMPTY_CHILD;
+        // Inverted bounds never intersect.
+        minX[slot] = minY[slot] = minZ[slot] = FLT_MAX;
+        maxX[slot] = maxY[slot] = maxZ[slot] = -FLT_MAX;
+    }
+
+    AABB GetChildBounds(int slot) const {
+        return AABB(Vec3(minX[slot], minY[slot], minZ[slot]), Vec3(maxX[slot], maxY[slot], maxZ[slot]));
+    }
+};
+
+void DynamicAABBTree::FreeQueryTree() {
+    if (queryNodes) {
+        Mem_AlignedFree(queryNodes);
+        queryNodes = nullptr;
+    }
+    if (queryLeafSlots) {
+        Mem_Free(queryLeafSlots);
+        queryLeafSlots = nullptr;
+    }
+    queryNodeCount = 0;
+    queryNodeCapacity = 0;
+    queryLeafSlotCapacity = 0;
+    queryTreeValid = false;
+}
+
+void DynamicAABBTree::UpdateQueryTree() {
+    if (queryTreeValid) {
+        return;
+    }
+
+    // Each query node except a single leaf root consumes at least one internal node of the binary tree.
+    int32_t requiredCapacity = Max(nodeCount, 1);
+    if (queryNodeCapacity < requiredCapacity) {
+        if (queryNodes) {
+            Mem_AlignedFree(queryNodes);
+        }
+        queryNodeCapacity = Max(requiredCapacity, queryNodeCapacity * 2);
+        queryNodes = (QueryNode *)Mem_Alloc16(queryNodeCapacity * sizeof(queryNodes[0]));
+    }
+
+    if (queryLeafSlotCapacity < nodeCapacity) {
+        if (queryLeafSlots) {
+            Mem_Free(queryLeafSlots);
+        }
+        queryLeafSlotCapacity = nodeCapacity;
+        queryLeafSlots = (int32_t *)Mem_Alloc(queryLeafSlotCapacity * sizeof(queryLeafSlots[0]));
+    }
+
+    queryNodeCount = 0;
+    numQueryRefits = 0;
+
+    if (root != -1) {
+        BuildQueryNode(root, -1);
+    }
+
+    queryTreeValid = true;
+}
+
+int32_t DynamicAABBTree::BuildQueryNode(int32_t nodeId, int32_t parentSlot) {
+    int32_t children[4];
+    int numChildren = 1;
+    children[0] = nodeId;
+
+    // Open the largest internal child until 4 children are collected.
+    // Opened node is replaced with child2 and child1 in place to keep the depth-first order of the binary tree.
+    while (numChildren < 4) {
+        int openIndex = -1;
+        float maxArea = -1.0f;
+
+        for (int i = 0; i < numChildren; i++) {
+            const Node *child = &nodes[children[i]];
+            if (!child->IsLeaf()) {
+                float area = child->aabb.Area();
+                if (area > maxArea) {
+                    maxArea = area;
+                    openIndex = i;
+                }
+            }
+        }
+
+        if (openIndex == -1) {
+            break;
+        }
+
+        const Node *opened = &nodes[children[openIndex]];
+
+        for (int i = numChildren; i > openIndex + 1; i--) {
+            children[i] = children[i - 1];
+        }
+        children[openIndex] = opened->child2;
+        children[openIndex + 1] = opened->child1;
+        numChildren++;
+    }
+
+    assert(queryNodeCount < queryNodeCapacity);
+    int32_t queryNodeId = queryNodeCount++;
+    queryNodes[queryNodeId].parentSlot = parentSlot;
+
+    for (int slot = 0; slot < 4; slot++) {
+        if (slot >= numChildren) {
+            queryNodes[queryNodeId].ClearChild(slot);
+            continue;
+        }
+
+        const int32_t childId = children[slot];
+
+        queryNodes[queryNodeId].SetChildBounds(slot, nodes[childId].aabb);
+
+        if (nodes[childId].IsLeaf()) {
+            queryNodes[queryNodeId].children[slot] = ToQueryLeaf(childId);
+            queryLeafSlots[childId] = queryNodeId * 4 + slot;
+        } else {
+            queryNodes[queryNodeId].children[slot] = BuildQueryNode(childId, queryNodeId * 4 + slot);
+        }
+    }
+
+    return queryNodeId;
+}
+
+// Moved proxy keeps its place in the query tree. Enlarge the bounds of the ancestors to contain the new fat AABB.
+// The query tree is rebuilt at the next update after too many refits, since refitted bounds only grow.
+void DynamicAABBTree::RefitQueryLeaf(int32_t proxyId) {
+    const AABB &aabb = nodes[proxyId].aabb;
+
+    int32_t leafSlot = queryLeafSlots[proxyId];
+    queryNodes[leafSlot >> 2].SetChildBounds(leafSlot & 3, aabb);
+
+    for (int32_t slot = queryNodes[leafSlot >> 2].parentSlot; slot != -1; slot = queryNodes[slot >> 2].parentSlot) {
+        QueryNode &parent = queryNodes[slot >> 2];
+        if (parent.IsContainChildBounds(slot & 3, aabb)) {
+            break;
+        }
+        parent.AddChildBounds(slot & 3, aabb);
+    }
+
+    numQueryRefits++;
+
+    // Number of leaves is about a half of the node count.
+    if (numQueryRefits > Max(16, nodeCount / 8)) {
+        queryTreeValid = false;
+    }
+}
+
+void DynamicAABBTree::RemoveQueryLeaf(int32_t proxyId) {
+    int32_t leafSlot = queryLeafSlots[proxyId];
+    queryNodes[leafSlot >> 2].ClearChild(leafSlot & 3);
+}
+
+// Traverses the query tree depth-first. tester.TestChildren() returns a bit mask of the children intersecting with the query volume.
+// tester.TestChild() is an exact test for the children that passed TestChildren(), if the SIMD test is conservative.
+template <typename Tester>
+void DynamicAABBTree::TraverseQueryTree(const Tester &tester, int32_t subtreeRoot, QueryLeafFunc func, void *data) const {
+    if (queryNodeCount == 0) {
+        return;
+    }
+
+    // Leaves are pushed on the stack as well to report them in depth-first order.
+    int32_t stack[QUERY_MAX_STACK_DEPTH];
+    int stackCount = 0;
+    stack[stackCount++] = subtreeRoot;
+
+    while (stackCount > 0) {
+        const int32_t nodeId = stack[--stackCount];
+
+        if (IsQueryLeaf(nodeId)) {
+            if (!func(data, FromQueryLeaf(nodeId))) {
+                return;
+            }
+            continue;
+        }
+
+        const QueryNode &node = queryNodes[nodeId];
+
+        int mask = tester.TestChildren(node);
+
+        // Push in reverse order to visit the children in order.
+        for (int slot = 3; slot >= 0; slot--) {
+            if (!(mask & BIT(slot))) {
+                continue;
+            }
+
+            if (node.children[slot] == QUERY_EMPTY_CHILD || !tester.TestChild(node, slot)) {
+                continue;
+            }
+
+            assert(stackCount < QUERY_MAX_STACK_DEPTH);
+            stack[stackCount++] = node.children[slot];
+        }
+    }
+}
+
+// Collects the children of the query tree in the same way as GetQuerySubtrees() collects the nodes of the binary tree.
+// Each query node is replaced with its intersecting children in slot order, so concatenating the traversals of the subtrees
+// gives the same order as TraverseQueryTree() from the root. Leaf children are collected as subtrees of a single proxy.
+template <typename Tester>
+void DynamicAABBTree::CollectQuerySubtrees(const Tester &tester, int maxSubtrees, Array<int32_t> &subtrees) const {
+    subtrees.SetCount(0, false);
+
+    if (queryNodeCount == 0) {
+        return;
+    }
+
+    subtrees.Append(0);
+
+    Array<int32_t> expanded;
+
+    while (subtrees.Count() < maxSubtrees) {
+        expanded.SetCount(0, false);
+
+        bool hasInternalNode = false;
+
+        for (int i = 0; i < subtrees.Count(); i++) {
+            const int32_t nodeId = subtrees[i];
+
+            if (IsQueryLeaf(nodeId)) {
+                expanded.Append(nodeId);
+                continue;
+            }
+
+            hasInternalNode = true;
+
+            const QueryNode &node = queryNodes[nodeId];
+
+            int mask = tester.TestChildren(node);
+
+            for (int slot = 0; slot < 4; slot++) {
+                if (!(mask & BIT(slot))) {
+                    continue;
+                }
+
+                if (node.children[slot] == QUERY_EMPTY_CHILD || !tester.TestChild(node, slot)) {
+                    continue;
+                }
+
+                expanded.Append(node.children[slot]);
+            }
+        }
+
+        if (!hasInternalNode || expanded.Count() > maxSubtrees) {
+            break;
+        }
+
+        subtrees.Swap(expanded);
+    }
+}
+
+// Tests 4 children against the AABB.
+struct AABBQueryTester {
+    AABB            aabb;
+
+    template <typename QueryNode>
+    int TestChildren(const QueryNode &node) const {
+#if defined(__X86__)
+        sseb outside = ssef(_mm_load_ps(node.maxX)) < ssef(aabb[0].x);
+        outside |= ssef(_mm_load_ps(node.maxY)) < ssef(aabb[0].y);
+        outside |= ssef(_mm_load_ps(node.maxZ)) < ssef(aabb[0].z);
+        outside |= ssef(_mm_load_ps(node.minX)) > ssef(aabb[1].x);
+        outside |= ssef(_mm_load_ps(node.minY)) > ssef(aabb[1].y);
+        outside |= ssef(_mm_load_ps(node.minZ)) > ssef(aabb[1].z);
+        return ~(int)movemask(outside) & 0xF;
+#else
+        int mask = 0;
+        for (int i = 0; i < 4; i++) {
+            if (aabb.IsIntersectAABB(node.GetChildBounds(i))) {
+                mask |= BIT(i);
+            }
+        }
+        return mask;
+#endif
+    }
+
+    template <typename QueryNode>
+    bool TestChild(const QueryNode &node, int slot) const { return true; }
+};
+
+// Tests 4 children against the sphere using the squared distance from the center to the boxes.
+struct SphereQueryTester {
+    Sphere          sphere;
+
+    template <typename QueryNode>
+    int TestChildren(const QueryNode &node) const {
+#if defined(__X86__)
+        const ssef cx(sphere.Center().x);
+        const ssef cy(sphere.Center().y);
+        const ssef cz(sphere.Center().z);
+
+        ssef dx = vmax(vmax(ssef(_mm_load_ps(node.minX)) - cx, cx - ssef(_mm_load_ps(node.maxX))), 0.0f);
+        ssef dy = vmax(vmax(ssef(_mm_load_ps(node.minY)) - cy, cy - ssef(_mm_load_ps(node.maxY))), 0.0f);
+        ssef dz = vmax(vmax(ssef(_mm_load_ps(node.minZ)) - cz, cz - ssef(_mm_load_ps(node.maxZ))), 0.0f);
+        ssef distSqr = dx * dx + dy * dy + dz * dz;
+
+        return (int)movemask(distSqr <= sphere.Radius() * sphere.Radius());
+#else
+        int mask = 0;
+        for (int i = 0; i < 4; i++) {
+            if (sphere.IsIntersectAABB(node.GetChildBounds(i))) {
+                mask |= BIT(i);
+            }
+        }
+        return mask;
+#endif
+    }
+
+    template <typename QueryNode>
+    bool TestChild(const QueryNode &node, int slot) const { return true; }
+};
+
+// Tests 4 children against the world AABB of the OBB, and then the children passed are tested exactly.
+struct OBBQueryTester {
+    AABBQueryTester aabbTester;
+    OBB             obb;
+
+    template <typename QueryNode>
+    int TestChildren(const QueryNode &node) const { return aabbTester.TestChildren(node); }
+
+    template <typename QueryNode>
+    bool TestChild(const QueryNode &node, int slot) const { return obb.IsIntersectOBB(OBB(node.GetChildBounds(slot))); }
+};
+
+// Tests 4 children against the 6 planes of the frustum.
+// The planes are the same separating planes that Frustum::CullAABB() tests, but in world space.
+struct FrustumQueryTester {
+    Vec3            normals[6];         ///< Outward plane normals
+    float           dists[6];
+    bool            positive[6][3];     ///< Sign of the normal components, selects the nearest corner to the plane
+
+    FrustumQueryTester(const Frustum &frustum) {
+        const Vec3 &origin = frustum.GetOrigin();
+        const Mat3 &axis = frustum.GetAxis();
+        const float dNear = frustum.GetNearDistance();
+        const float dFar = frustum.GetFarDistance();
+        const float dLeft = frustum.GetLeft();
+        const float dUp = frustum.GetUp();
+
+        // Plane normals in frustum space.
+        const Vec3 localNormals[6] = {
+            Vec3(-1.0f, 0.0f, 0.0f),
+            Vec3(1.0f, 0.0f, 0.0f),
+            Vec3(-dLeft, dFar, 0.0f),
+            Vec3(-dLeft, -dFar, 0.0f),
+            Vec3(-dUp, 0.0f, dFar),
+            Vec3(-dUp, 0.0f, -dFar)
+        };
+
+        for (int i = 0; i < 6; i++) {
+            normals[i] = axis[0] * localNormals[i].x + axis[1] * localNormals[i].y + axis[2] * localNormals[i].z;
+            dists[i] = -normals[i].Dot(origin);
+
+            for (int j = 0; j < 3; j++) {
+                positive[i][j] = normals[i][j] > 0.0f;
+            }
+        }
+
+        dists[0] += dNear;
+        dists[1] -= dFar;
+    }
+
+    template <typename QueryNode>
+    int TestChildren(const QueryNode &node) const {
+#if defined(__X86__)
+        sseb culled(false);
+
+        for (int i = 0; i < 6; i++) {
+            // Signed distance of the nearest corner, all of the box is outside if it is positive.
+            ssef x(_mm_load_ps(positive[i][0] ? node.minX : node.maxX));
+            ssef y(_mm_load_ps(positive[i][1] ? node.minY : node.maxY));
+            ssef z(_mm_load_ps(positive[i][2] ? node.minZ : node.maxZ));
+
+            ssef d = x * normals[i].x + y * normals[i].y + z * normals[i].z + dists[i];
+
+            culled |= d > 0.0f;
+        }
+
+        return ~(int)movemask(culled) & 0xF;
+#else
+        int mask = 0;
+        for (int slot = 0; slot < 4; slot++) {
+            bool culled = false;
+
+            for (int i = 0; i < 6 && !culled; i++) {
+                float x = positive[i][0] ? node.minX[slot] : node.maxX[slot];
+                float y = positive[i][1] ? node.minY[slot] : node.maxY[slot];
+                float z = positive[i][2] ? node.minZ[slot] : node.maxZ[slot];
+
+                culled = normals[i].x * x + normals[i].y * y + normals[i].z * z + dists[i] > 0.0f;
+            }
+
+            if (!culled) {
+                mask |= BIT(slot);
+            }
+        }
+        return mask;
+#endif
+    }
+
+    template <typename QueryNode>
+    bool TestChild(const QueryNode &node, int slot) const { return true; }
+};
+
+void DynamicAABBTree::QueryWide(const Sphere &sphere, int32_t subtreeRoot, QueryLeafFunc func, void *data) const {
+    SphereQueryTester tester;
+    tester.sphere = sphere;
+
+    TraverseQueryTree(tester, subtreeRoot, func, data);
+}
+
+void DynamicAABBTree::QueryWide(const AABB &aabb, int32_t subtreeRoot, QueryLeafFunc func, void *data) const {
+    AABBQueryTester tester;
+    tester.aabb = aabb;
+
+    TraverseQueryTree(tester, subtreeRoot, func, data);
+}
+
+void DynamicAABBTree::QueryWide(const OBB &obb, int32_t subtreeRoot, QueryLeafFunc func, void *data) const {
+    OBBQueryTester tester;
+    tester.aabbTester.aabb = obb.ToAABB();
+    tester.obb = obb;
+
+    TraverseQueryTree(tester, subtreeRoot, func, data);
+}
+
+void DynamicAABBTree::QueryWide(const Frustum &frustum, int32_t subtreeRoot, QueryLeafFunc func, void *data) const {
+    FrustumQueryTester tester(frustum);
+
+    TraverseQueryTree(tester, subtreeRoot, func, data);
+}
+
+void DynamicAABBTree::GetQuerySubtreesWide(const Sphere &sphere, int maxSubtrees, Array<int32_t> &subtrees) const {
+    SphereQueryTester tester;
+    tester.sphere = sphere;
+
+    CollectQuerySubtrees(tester, maxSubtrees, subtrees);
+}
+
+void DynamicAABBTree::GetQuerySubtreesWide(const AABB &aabb, int maxSubtrees, Array<int32_t> &subtrees) const {
+    AABBQueryTester tester;
+    tester.aabb = aabb;
+
+    CollectQuerySubtrees(tester, maxSubtrees, subtrees);
+}
+
+void DynamicAABBTree::GetQuerySubtreesWide(const OBB &obb, int maxSubtrees, Array<int32_t> &subtrees) const {
+    OBBQueryTester tester;
+    tester.aabbTester.aabb = obb.ToAABB();
+    tester.obb = obb;
+
+    CollectQuerySubtrees(tester, maxSubtrees, subtrees);
+}
+
+void DynamicAABBTree::GetQuerySubtreesWide(const Frustum &frustum, int maxSubtrees, Array<int32_t> &subtrees) const {
+    FrustumQueryTester tester(frustum);
+
+    CollectQuerySubtrees(tester, maxSubtrees, subtrees);
+}
+
 #pragma optimize("", off)
 
 BE_NAMESPACE_END
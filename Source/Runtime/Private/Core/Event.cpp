@@ -149,23 +149,130 @@ const EventDef *EventDef::FindEvent(const char *name) {
 
 //-----------------------------------------------------------------------------------------
 
-bool                EventSystem::initialized = false;
-Event               EventSystem::eventPool[EventSystem::MaxEvents];
-LinkList<Event>     EventSystem::freeEvents;
-LinkList<Event>     EventSystem::eventQueue;
-LinkList<Event>     EventSystem::guiEventQueue;
-
 Event::~Event() {
-    EventSystem::FreeEvent(this);
+    if (data) {
+        Mem_Free(data);
+    }
+}
+
+//-----------------------------------------------------------------------------------------
+
+BE_INLINE bool EventQueue::IsEarlier(const Event *a, const Event *b) {
+    if (a->time != b->time) {
+        return a->time < b->time;
+    }
+    return a->sequence < b->sequence;
 }
 
+void EventQueue::SiftUp(int index) {
+    Event *event = events[index];
+
+    while (index > 0) {
+        int parentIndex = (index - 1) / Arity;
+        if (!IsEarlier(event, events[parentIndex])) {
+            break;
+        }
+        Place(events[parentIndex], index);
+        index = parentIndex;
+    }
+
+    Place(event, index);
+}
+
+void EventQueue::SiftDown(int index) {
+    Event *event = events[index];
+    const int count = events.Count();
+
+    while (1) {
+        int firstChildIndex = index * Arity + 1;
+        if (firstChildIndex >= count) {
+            break;
+        }
+
+        int lastChildIndex = Min(firstChildIndex + Arity, count);
+        int earliestIndex = firstChildIndex;
+
+        for (int childIndex = firstChildIndex + 1; childIndex < lastChildIndex; childIndex++) {
+            if (IsEarlier(events[childIndex], events[earliestIndex])) {
+                earliestIndex = childIndex;
+            }
+        }
+
+        if (!IsEarlier(events[earliestIndex], event)) {
+            break;
+        }
+        Place(events[earliestIndex], index);
+        index = earliestIndex;
+    }
+
+    Place(event, index);
+}
+
+void EventQueue::Push(Event *event) {
+    assert(event->queueIndex < 0);
+
+    events.Append(event);
+    SiftUp(events.Count() - 1);
+}
+
+void EventQueue::Remove(Event *event) {
+    const int index = event->queueIndex;
+    assert(index >= 0 && index < events.Count() && events[index] == event);
+
+    event->queueIndex = -1;
+
+    Event *lastEvent = events[events.Count() - 1];
+    events.SetCount(events.Count() - 1, false);
+
+    if (lastEvent == event) {
+        return;
+    }
+
+    // Fill the hole with the last event and restore the heap order
+    Place(lastEvent, index);
+    if (index > 0 && IsEarlier(lastEvent, events[(index - 1) / Arity])) {
+        SiftUp(index);
+    } else {
+        SiftDown(index);
+    }
+}
+
+void EventQueue::Clear() {
+    for (int i = 0; i < events.Count(); i++) {
+        events[i]->queueIndex = -1;
+    }
+    events.SetCount(0, false);
+}
+
+//-----------------------------------------------------------------------------------------
+
+bool                EventSystem::initialized = false;
+Array<Event *>      EventSystem::eventBlocks;
+LinkList<Event>     EventSystem::freeEvents;
+EventQueue          EventSystem::eventQueue;
+EventQueue          EventSystem::guiEventQueue;
+uint64_t            EventSystem::eventSequence = 0;
+
 void EventSystem::Clear() {
     freeEvents.Clear();
     eventQueue.Clear();
     guiEventQueue.Clear();
 
-    for (int i = 0; i < EventSystem::MaxEvents; i++) {
-        FreeEvent(&eventPool[i]);
+    for (int blockIndex = 0; blockIndex < eventBlocks.Count(); blockIndex++) {
+        Event *block = eventBlocks[blockIndex];
+
+        for (int i = 0; i < EventBlockSize; i++) {
+            FreeEvent(&block[i]);
+        }
+    }
+}
+
+void EventSystem::AllocEventBlock() {
+    Event *block = new Event[EventBlockSize];
+    eventBlocks.Append(block);
+
+    for (int i = 0; i < EventBlockSize; i++) {
+        FreeEvent(&block[i]);
     }
 }
 
@@ -198,10 +305,25 @@ void EventSystem::Shutdown() {
 
     Clear();
 
+    // Unlink all the events before deleting them
+    freeEvents.Clear();
+
+    for (int blockIndex = 0; blockIndex < eventBlocks.Count(); blockIndex++) {
+        delete [] eventBlocks[blockIndex];
+    }
+    eventBlocks.Clear();
+
     initialized = false;
 }
 
 void EventSystem::FreeEvent(Event *event) {
+    if (event->queueIndex >= 0) {
+        EventQueue &queue = event->eventDef->IsGuiEvent() ? guiEventQueue : eventQueue;
+        queue.Remove(event);
+    }
+
+    event->senderNode.Remove();
+
     if (event->data) {
         Mem_Free(event->data);
         event->data = nullptr;
@@ -213,11 +335,12 @@ void EventSystem::FreeEvent(Event *event) {
 
     event->node.SetOwner(event);
     event->node.AddToEnd(EventSystem::freeEvents);
+    event->senderNode.SetOwner(event);
 }
 
 Event *EventSystem::AllocEvent(const EventDef *evdef, int numArgs, va_list args) {
     if (freeEvents.IsListEmpty()) {
-        BE_ERRLOG("Event::Alloc: No more free events\n");
+        AllocEventBlock();
     }
 
     Event *newEvent = freeEvents.Next();
@@ -324,23 +447,24 @@ void EventSystem::ScheduleEvent(Event *event, Object *sender, int time) {
         return;
     }
 
+    EventQueue &queue = event->eventDef->IsGuiEvent() ? guiEventQueue : eventQueue;
+
+    if (event->queueIndex >= 0) {
+        queue.Remove(event);
+    }
+
     event->sender = sender;
     event->time = common.realTime + time;
+    event->sequence = eventSequence++;
     event->node.Remove();
 
-    LinkList<Event> &queue = event->eventDef->IsGuiEvent() ? guiEventQueue : eventQueue;
-
-    // event queue 는 시간 순으로 정렬되어 있다.
-    Event *ev = queue.Next();
-    while (ev && (event->time >= ev->time)) {
-        ev = ev->node.Next();
+    event->senderNode.Remove();
+    if (sender) {
+        event->senderNode.AddToEnd(sender->postedEvents);
     }
 
-    if (ev) {
-        event->node.InsertBefore(ev->node);
-    } else {
-        event->node.AddToEnd(queue);
-    }
+    // Events at the same time are serviced in the scheduled order.
+    queue.Push(event);
 }
 
 void EventSystem::CancelEvents(const Object *sender, const EventDef *evdef) {
@@ -348,15 +472,12 @@ void EventSystem::CancelEvents(const Object *sender, const EventDef *evdef) {
         return;
     }
 
-    LinkList<Event> &queue = eventQueue; // evdef->IsGuiEvent() ? guiEventQueue : eventQueue;
-        
+    // Walk only the events posted by the sender
     Event *next;
-    for (Event *event = queue.Next(); event != nullptr; event = next) {
-        next = event->node.Next();
-        if (event->sender == sender) {
-            if (!evdef || (evdef == event->eventDef)) {
-                FreeEvent(event);
-            }
+    for (Event *event = sender->postedEvents.Next(); event != nullptr; event = next) {
+        next = event->senderNode.Next();
+        if (!evdef || (evdef == event->eventDef)) {
+            FreeEvent(event);
         }
     }
 }
@@ -411,7 +532,11 @@ void EventSystem::ServiceEvent(Event *event) {
 
     // the event is removed from its list so that if then object
     // is deleted, the event won't be freed twice
-    event->node.Remove();
+    if (event->queueIndex >= 0) {
+        EventQueue &queue = evdef->IsGuiEvent() ? guiEventQueue : eventQueue;
+        queue.Remove(event);
+    }
+    event->senderNode.Remove();
 
     assert(event->sender);
     event->sender->ProcessEventArgPtr(evdef, argPtrs);
@@ -423,8 +548,8 @@ void EventSystem::ServiceEvent(Event *event) {
 void EventSystem::ServiceEvents() {
     int processedCount = 0;
 
-    while (!eventQueue.IsListEmpty()) {
-        Event *ev = eventQueue.Next();
+    while (!eventQueue.IsEmpty()) {
+        Event *ev = eventQueue.First();
         assert(ev);
 
         if (ev->time > common.realTime) {
@@ -445,8 +570,8 @@ void EventSystem::ServiceEvents() {
 void EventSystem::ServiceGuiEvents() {
     int processedCount = 0;
 
-    while (!guiEventQueue.IsListEmpty()) {
-        Event *ev = guiEventQueue.Next();
+    while (!guiEventQueue.IsEmpty()) {
+        Event *ev = guiEventQueue.First();
         assert(ev);
 
         if (ev->time > common.realTime) {
@@ -0,0 +1,566 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Platform/PlatformSystem.h"
+#include "Platform/PlatformProcess.h"
+#include "Platform/PlatformTLS.h"
+#include "Platform/cpuid.h"
+#include "Core/JobSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+JobSystem           jobSystem;
+
+struct Job {
+    JobFunc                 function;
+    void *                  data;
+    Job *                   parent;
+    std::atomic<int32_t>    unfinishedJobs;         ///< 1 for the job itself + number of unfinished children
+    std::atomic<int32_t>    pendingDependencies;    ///< 1 until Run() is called + number of unfinished prerequisites
+    std::atomic<int32_t>    released;               ///< 1 when the slot can be reused, set after continuations and parent are handled
+    std::atomic<uint32_t>   generation;             ///< Incremented when the slot is released
+    std::atomic<int32_t>    continuationLock;
+    bool                    continuationsClosed;    ///< Set when the job is finished, no more continuations can be added
+    int32_t                 numContinuations;
+    Job *                   continuations[JobSystem::MaxContinuations];
+    ALIGN_AS16 byte         payload[JobSystem::MaxJobDataSize];
+};
+
+//-------------------------------------------------------------------------------------------------
+// Chase-Lev work-stealing deque
+//
+// Push() and Pop() are only called by the owner thread, Steal() can be called by any thread.
+//-------------------------------------------------------------------------------------------------
+
+class JobQueue {
+public:
+    static constexpr int64_t Capacity = JobSystem::MaxJobs;
+    static constexpr int64_t Mask = Capacity - 1;
+
+    JobQueue() : top(0), bottom(0) {
+        for (int i = 0; i < Capacity; i++) {
+            jobs[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    bool                    IsEmpty() const { return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed); }
+
+    void                    Push(Job *job);
+    Job *                   Pop();
+    Job *                   Steal();
+
+private:
+    std::atomic<int64_t>    top;
+    char                    pad[64 - sizeof(std::atomic<int64_t>)];  // keep top and bottom on separate cache lines
+    std::atomic<int64_t>    bottom;
+    std::atomic<Job *>      jobs[Capacity];
+};
+
+void JobQueue::Push(Job *job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+
+    if (b - t >= Capacity) {
+        BE_FATALERROR("JobQueue::Push: queue overflow");
+        return;
+    }
+
+    jobs[b & Mask].store(job, std::memory_order_relaxed);
+    // Publish the job to the stealers.
+    bottom.store(b + 1, std::memory_order_release);
+}
+
+Job *JobQueue::Pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Queue is empty.
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job *job = jobs[b & Mask].load(std::memory_order_relaxed);
+    if (t != b) {
+        // There is still more than one job left in the queue.
+        return job;
+    }
+
+    // This is the last job in the queue, race against steals.
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        job = nullptr;
+    }
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return job;
+}
+
+Job *JobQueue::Steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+
+    if (t >= b) {
+        return nullptr;
+    }
+
+    Job *job = jobs[t & Mask].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        // Lost the race against another steal or pop.
+        return nullptr;
+    }
+    return job;
+}
+
+//-------------------------------------------------------------------------------------------------
+// JobSystem
+//-------------------------------------------------------------------------------------------------
+
+static void InitCPU() {
+#ifdef __WIN32__
+    int cpuid = GetCpuInfo()->cpuid;
+    if (cpuid & CPUID_FTZ) {
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+    }
+    if (cpuid & CPUID_DAZ) {
+        _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    }
+#endif
+}
+
+JobSystem::JobSystem() {
+    initialized = false;
+    jobPool = nullptr;
+    numAllocatedJobs = 0;
+    numWorkers = 0;
+    workers = nullptr;
+    workerTlsSlot = 0;
+    sharedQueue = nullptr;
+    sharedQueueMutex = nullptr;
+    stopping = 0;
+    numSleepingWorkers = 0;
+    numPushedJobs = 0;
+    sleepMutex = nullptr;
+    sleepCondition = nullptr;
+}
+
+void JobSystem::Init(int numThreads) {
+    if (initialized) {
+        return;
+    }
+
+    if (numThreads < 0) {
+        // Get thread count as number of logical processors except the calling thread.
+        numThreads = Max(PlatformSystem::NumCPUCoresIncludingHyperthreads() - 1, 0);
+    }
+
+    jobPool = new Job[MaxJobs];
+    for (int i = 0; i < MaxJobs; i++) {
+        jobPool[i].unfinishedJobs = 0;
+        jobPool[i].released = 1;
+        jobPool[i].generation = 0;
+        jobPool[i].continuationLock = 0;
+    }
+    numAllocatedJobs = 0;
+
+    sharedQueue = new JobQueue;
+    sharedQueueMutex = (PlatformMutex *)PlatformMutex::Create();
+
+    sleepMutex = (PlatformMutex *)PlatformMutex::Create();
+    sleepCondition = (PlatformCondition *)PlatformCondition::Create();
+
+    stopping = 0;
+    numSleepingWorkers = 0;
+    numPushedJobs = 0;
+
+    numWorkers = numThreads + 1;
+    workers = new Worker[numWorkers];
+
+    workerTlsSlot = PlatformTLS::AllocTlsSlot();
+
+    for (int i = 0; i < numWorkers; i++) {
+        Worker *worker = &workers[i];
+        worker->jobSystem = this;
+        worker->index = i;
+        worker->queue = new JobQueue;
+        worker->thread = nullptr;
+    }
+
+    // Worker 0 is the calling thread.
+    PlatformTLS::SetTlsValue(workerTlsSlot, &workers[0]);
+
+    initialized = true;
+
+    for (int i = 1; i < numWorkers; i++) {
+        workers[i].thread = (PlatformThread *)PlatformThread::Create(WorkerThreadProc, (void *)&workers[i], 0);
+    }
+}
+
+void JobSystem::Shutdown() {
+    if (!initialized) {
+        return;
+    }
+
+    // Set the stopping and wake all the worker threads.
+    stopping = 1;
+
+    PlatformMutex::Lock(sleepMutex);
+    PlatformCondition::Broadcast(sleepCondition);
+    PlatformMutex::Unlock(sleepMutex);
+
+    for (int i = 1; i < numWorkers; i++) {
+        // Join() also releases the thread object.
+        PlatformThread::Join(workers[i].thread);
+    }
+
+    for (int i = 0; i < numWorkers; i++) {
+        delete workers[i].queue;
+    }
+    delete [] workers;
+    workers = nullptr;
+    numWorkers = 0;
+
+    PlatformTLS::SetTlsValue(workerTlsSlot, nullptr);
+    PlatformTLS::FreeTlsSlot(workerTlsSlot);
+
+    PlatformCondition::Destroy(sleepCondition);
+    PlatformMutex::Destroy(sleepMutex);
+
+    PlatformMutex::Destroy(sharedQueueMutex);
+    delete sharedQueue;
+    sharedQueue = nullptr;
+
+    delete [] jobPool;
+    jobPool = nullptr;
+
+    initialized = false;
+}
+
+JobSystem::Worker *JobSystem::GetCurrentWorker() const {
+    return (Worker *)PlatformTLS::GetTlsValue(workerTlsSlot);
+}
+
+int JobSystem::GetCurrentWorkerIndex() const {
+    if (!initialized) {
+        return -1;
+    }
+    const Worker *worker = GetCurrentWorker();
+    return worker ? worker->index : -1;
+}
+
+JobHandle JobSystem::AllocJob() {
+    // Skip the slots of long-lived jobs which are still unfinished or being finished.
+    for (int i = 0; i < MaxJobs; i++) {
+        uint32_t index = numAllocatedJobs.fetch_add(1, std::memory_order_relaxed);
+        Job *job = &jobPool[index & (MaxJobs - 1)];
+
+        // Claims the slot, two threads can reach the same slot after the allocation counter wraps around.
+        int32_t released = 1;
+        if (job->released.compare_exchange_strong(released, 0, std::memory_order_acquire, std::memory_order_relaxed)) {
+            JobHandle handle;
+            handle.job = job;
+            handle.generation = job->generation.load(std::memory_order_relaxed);
+            return handle;
+        }
+    }
+
+    BE_FATALERROR("JobSystem::AllocJob: too many jobs (max %i)", MaxJobs);
+    return JobHandle();
+}
+
+JobHandle JobSystem::CreateJob(JobFunc function, const void *data, size_t dataSize) {
+    return CreateChildJob(JobHandle(), function, data, dataSize);
+}
+
+JobHandle JobSystem::CreateChildJob(const JobHandle &parent, JobFunc function, const void *data, size_t dataSize) {
+    assert(dataSize <= MaxJobDataSize);
+
+    if (parent.job) {
+        assert(!IsFinished(parent));
+        parent.job->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    JobHandle handle = AllocJob();
+    Job *job = handle.job;
+    job->function = function;
+    job->parent = parent.job;
+    job->unfinishedJobs.store(1, std::memory_order_relaxed);
+    job->pendingDependencies.store(1, std::memory_order_relaxed);
+    job->continuationsClosed = false;
+    job->numContinuations = 0;
+
+    if (dataSize > 0) {
+        memcpy(job->payload, data, dataSize);
+        job->data = job->payload;
+    } else {
+        job->data = const_cast<void *>(data);
+    }
+    return handle;
+}
+
+static void LockContinuations(Job *job) {
+    while (job->continuationLock.exchange(1, std::memory_order_acquire)) {
+        PlatformProcess::Sleep(0);
+    }
+}
+
+static void UnlockContinuations(Job *job) {
+    job->continuationLock.store(0, std::memory_order_release);
+}
+
+void JobSystem::AddDependency(const JobHandle &job, const JobHandle &prerequisiteHandle) {
+    Job *prerequisite = prerequisiteHandle.job;
+
+    LockContinuations(prerequisite);
+
+    // The prerequisite is already finished, nothing to wait for.
+    // The generation is incremented after the list is closed, a changed generation means the slot belongs to another job.
+    if (prerequisite->generation.load(std::memory_order_acquire) != prerequisiteHandle.generation || prerequisite->continuationsClosed) {
+        UnlockContinuations(prerequisite);
+        return;
+    }
+
+    if (prerequisite->numContinuations >= MaxContinuations) {
+        UnlockContinuations(prerequisite);
+        BE_FATALERROR("JobSystem::AddDependency: too many continuations (max %i)", MaxContinuations);
+        return;
+    }
+
+    job.job->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+    prerequisite->continuations[prerequisite->numContinuations++] = job.job;
+
+    UnlockContinuations(prerequisite);
+}
+
+void JobSystem::Run(const JobHandle &job) {
+    // Drop the submission reference, the last finished prerequisite pushes it otherwise.
+    if (job.job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Push(job.job);
+    }
+}
+
+void JobSystem::Push(Job *job) {
+    Worker *worker = GetCurrentWorker();
+
+    if (worker) {
+        worker->queue->Push(job);
+    } else {
+        PlatformMutex::Lock(sharedQueueMutex);
+        sharedQueue->Push(job);
+        PlatformMutex::Unlock(sharedQueueMutex);
+    }
+
+    numPushedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+    WakeWorkers();
+}
+
+void JobSystem::WakeWorkers() {
+    if (numSleepingWorkers.load(std::memory_order_seq_cst) > 0) {
+        PlatformMutex::Lock(sleepMutex);
+        PlatformCondition::Signal(sleepCondition);
+        PlatformMutex::Unlock(sleepMutex);
+    }
+}
+
+Job *JobSystem::GetJob(Worker *worker) {
+    Job *job = nullptr;
+
+    if (worker) {
+        job = worker->queue->Pop();
+        if (job) {
+            return job;
+        }
+    }
+
+    if (!sharedQueue->IsEmpty()) {
+        PlatformMutex::Lock(sharedQueueMutex);
+        job = sharedQueue->Pop();
+        PlatformMutex::Unlock(sharedQueueMutex);
+        if (job) {
+            return job;
+        }
+    }
+
+    // Steal from other workers starting from the next one.
+    int start = worker ? worker->index + 1 : 0;
+    for (int i = 0; i < numWorkers; i++) {
+        Worker *victim = &workers[(start + i) % numWorkers];
+        if (victim == worker) {
+            continue;
+        }
+        job = victim->queue->Steal();
+        if (job) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::Execute(Job *job) {
+    job->function(job->data);
+
+    Finish(job);
+}
+
+void JobSystem::Finish(Job *job) {
+    if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // No more continuations can be added after this, AddDependency() on this job doesn't wait.
+    LockContinuations(job);
+    job->continuationsClosed = true;
+    int numContinuations = job->numContinuations;
+    UnlockContinuations(job);
+
+    // Submit continuations which have no more pending prerequisites.
+    for (int i = 0; i < numContinuations; i++) {
+        Job *continuation = job->continuations[i];
+        if (continuation->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Push(continuation);
+        }
+    }
+
+    Job *parent = job->parent;
+
+    // The slot can be reused by AllocJob() from now on.
+    job->generation.fetch_add(1, std::memory_order_release);
+    job->released.store(1, std::memory_order_release);
+
+    if (parent) {
+        Finish(parent);
+    }
+}
+
+bool JobSystem::IsFinished(const JobHandle &job) const {
+    if (job.job->unfinishedJobs.load(std::memory_order_acquire) == 0) {
+        return true;
+    }
+    // The counter may belong to a new job if the slot has been reused, which happens only after the generation is incremented.
+    return job.job->generation.load(std::memory_order_acquire) != job.generation;
+}
+
+void JobSystem::Wait(const JobHandle &job) {
+    Worker *worker = GetCurrentWorker();
+
+    while (!IsFinished(job)) {
+        if (!worker) {
+            // Non-worker threads don't run jobs, they would share the per-worker data of the main thread.
+            PlatformProcess::Sleep(0.001f);
+            continue;
+        }
+
+        // Help by running other jobs instead of blocking.
+        Job *nextJob = GetJob(worker);
+        if (nextJob) {
+            Execute(nextJob);
+        } else {
+            PlatformProcess::Sleep(0);
+        }
+    }
+}
+
+struct ParallelForJobData {
+    ParallelForFunc         function;
+    void *                  data;
+    JobHandle               job;
+    int                     begin;
+    int                     end;
+    int                     batchSize;
+};
+
+static void ParallelForJob(void *data) {
+    ParallelForJobData *pf = (ParallelForJobData *)data;
+
+    // Split range in half recursively so that idle workers can steal large chunks.
+    while (pf->end - pf->begin > pf->batchSize) {
+        int mid = pf->begin + (pf->end - pf->begin) / 2;
+
+        ParallelForJobData right = *pf;
+        right.begin = mid;
+
+        JobHandle child = jobSystem.CreateChildJob(pf->job, ParallelForJob, &right, sizeof(right));
+        ((ParallelForJobData *)child.job->data)->job = child;
+        jobSystem.Run(child);
+
+        pf->end = mid;
+    }
+
+    pf->function(pf->data, pf->begin, pf->end);
+}
+
+JobHandle JobSystem::CreateParallelForJob(int count, int minBatchSize, ParallelForFunc function, void *data) {
+    ParallelForJobData pf;
+    pf.function = function;
+    pf.data = data;
+    pf.begin = 0;
+    pf.end = count;
+    // Limit the number of batches to a few per worker.
+    pf.batchSize = Max(Max(minBatchSize, 1), (count + numWorkers * 8 - 1) / (numWorkers * 8));
+
+    JobHandle job = CreateJob(ParallelForJob, &pf, sizeof(pf));
+    ((ParallelForJobData *)job.job->data)->job = job;
+    return job;
+}
+
+void JobSystem::ParallelFor(int count, int minBatchSize, ParallelForFunc function, void *data) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Runs serially without worker threads, non-worker threads couldn't wait for the jobs otherwise.
+    if (!initialized || numWorkers <= 1 || count <= minBatchSize) {
+        function(data, 0, count);
+        return;
+    }
+
+    JobHandle job = CreateParallelForJob(count, minBatchSize, function, data);
+    Run(job);
+    Wait(job);
+}
+
+void JobSystem::WorkerThreadProc(void *param) {
+    InitCPU();
+
+    Worker *worker = (Worker *)param;
+    JobSystem *js = worker->jobSystem;
+
+    PlatformTLS::SetTlsValue(js->workerTlsSlot, worker);
+
+    while (!js->stopping) {
+        uint32_t pushedCount = js->numPushedJobs.load(std::memory_order_seq_cst);
+
+        Job *job = js->GetJob(worker);
+        if (job) {
+            js->Execute(job);
+            continue;
+        }
+
+        // Sleep until a new job is pushed. Re-checking the push counter under the lock prevents lost wake-ups.
+        PlatformMutex::Lock(js->sleepMutex);
+        js->numSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        if (!js->stopping && js->numPushedJobs.load(std::memory_order_seq_cst) == pushedCount) {
+            PlatformCondition::TimedWait(js->sleepCondition, js->sleepMutex, 10);
+        }
+        js->numSleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+        PlatformMutex::Unlock(js->sleepMutex);
+    }
+
+    PlatformTLS::SetTlsValue(js->workerTlsSlot, nullptr);
+}
+
+BE_NAMESPACE_END
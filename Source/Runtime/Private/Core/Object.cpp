@@ -256,6 +256,10 @@ bool Object::InitInstance(Guid guid) {
 }
 
 Object::~Object() {
+    // Pending events would have a dangling sender
+    if (!postedEvents.IsListEmpty()) {
+        EventSystem::CancelEvents(this);
+    }
 }
 
 void Object::Init() {
@@ -385,6 +389,24 @@ Object *Object::FindInstance(const Guid &guid) {
     return instance;
 }
 
+void Object::UnregisterInstance() {
+    Object *instance;
+    if (instanceHash.Get(guid, &instance) && instance == this) {
+        instanceHash.Remove(guid);
+    }
+}
+
+bool Object::RegisterInstance() {
+    Object *instance;
+    if (instanceHash.Get(guid, &instance)) {
+        return instance == this;
+    }
+
+    Object *object = this;
+    instanceHash.Set(guid, object);
+    return true;
+}
+
 void Object::ListClasses(const CmdArgs &args) {
     BE_LOG("%-24s %-24s %-6s %-6s\n", "ClassName", "SuperClass", "Type", "SubClasses");
     BE_LOG("----------------------------------------------------------------------\n");
@@ -1004,7 +1026,8 @@ bool Object::ProcessEventArgPtr(const EventDef *evdef, intptr_t *data) {
 }
 
 void Object::Event_ImmediateDestroy() {
-    instanceHash.Remove(guid);
+    // Pooled instance might be already unregistered
+    UnregisterInstance();
 
     delete this;
 }
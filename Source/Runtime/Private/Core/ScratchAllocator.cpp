@@ -0,0 +1,168 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/Heap.h"
+#include "Core/JobSystem.h"
+#include "Core/ScratchAllocator.h"
+#include "Platform/PlatformTLS.h"
+#include "Platform/PlatformThread.h"
+
+BE_NAMESPACE_BEGIN
+
+ScratchAllocator    scratchAllocator;
+
+struct ScratchAllocator::Block {
+    Block *             next;
+    int32_t             size;
+    int32_t             used;
+    byte *              base;
+};
+
+static ScratchAllocator::Block *AllocScratchBlock(int size) {
+    ScratchAllocator::Block *block = (ScratchAllocator::Block *)Mem_Alloc16(AlignUp(sizeof(ScratchAllocator::Block), 16) + size);
+    if (!block) {
+        BE_FATALERROR("ScratchAllocator::Alloc: Mem_Alloc16() failed");
+    }
+    block->next = nullptr;
+    block->size = size;
+    block->used = 0;
+    block->base = (byte *)block + AlignUp(sizeof(ScratchAllocator::Block), 16);
+    return block;
+}
+
+ScratchAllocator::ScratchAllocator() {
+    memset(stacks, 0, sizeof(stacks));
+    threadTlsSlot = 0;
+    otherStacksMutex = nullptr;
+}
+
+void ScratchAllocator::Init() {
+    threadTlsSlot = PlatformTLS::AllocTlsSlot();
+    otherStacksMutex = (PlatformMutex *)PlatformMutex::Create();
+}
+
+void ScratchAllocator::Shutdown() {
+    for (int i = 0; i < MaxThreads; i++) {
+        Block *nextBlock;
+        for (Block *block = stacks[i].first; block; block = nextBlock) {
+            nextBlock = block->next;
+            Mem_AlignedFree(block);
+        }
+        stacks[i].first = nullptr;
+        stacks[i].current = nullptr;
+        stacks[i].numScopes = 0;
+        stacks[i].taken = false;
+    }
+
+    PlatformMutex::Destroy(otherStacksMutex);
+    otherStacksMutex = nullptr;
+
+    PlatformTLS::FreeTlsSlot(threadTlsSlot);
+}
+
+int ScratchAllocator::GetThreadIndex() {
+    int threadIndex = jobSystem.GetCurrentWorkerIndex();
+    if (threadIndex >= 0) {
+        // Worker stacks must not run into the stacks of non-worker threads
+        assert(!scratchAllocator.stacks[threadIndex].taken);
+        return threadIndex;
+    }
+
+    threadIndex = (int)(intptr_t)PlatformTLS::GetTlsValue(scratchAllocator.threadTlsSlot) - 1;
+    if (threadIndex >= 0) {
+        return threadIndex;
+    }
+
+    // Non-worker threads take a free stack from the last one
+    PlatformMutex::Lock(scratchAllocator.otherStacksMutex);
+
+    for (int i = MaxThreads - 1; i >= jobSystem.NumWorkers(); i--) {
+        if (!scratchAllocator.stacks[i].taken) {
+            scratchAllocator.stacks[i].taken = true;
+            threadIndex = i;
+            break;
+        }
+    }
+
+    PlatformMutex::Unlock(scratchAllocator.otherStacksMutex);
+
+    if (threadIndex < 0) {
+        BE_FATALERROR("ScratchAllocator::GetThreadIndex: too many threads");
+    }
+
+    PlatformTLS::SetTlsValue(scratchAllocator.threadTlsSlot, (void *)(intptr_t)(threadIndex + 1));
+    return threadIndex;
+}
+
+void ScratchAllocator::ReleaseThreadIndex(int threadIndex) {
+    PlatformTLS::SetTlsValue(scratchAllocator.threadTlsSlot, nullptr);
+
+    // Blocks are kept for the next thread that takes this stack
+    PlatformMutex::Lock(scratchAllocator.otherStacksMutex);
+    scratchAllocator.stacks[threadIndex].taken = false;
+    PlatformMutex::Unlock(scratchAllocator.otherStacksMutex);
+}
+
+void *ScratchAllocator::Alloc(int bytes) {
+    bytes = AlignUp(bytes, 16);
+
+    Stack *stack = &stacks[GetThreadIndex()];
+
+    Block *block = stack->current;
+    if (block && block->size - block->used >= bytes) {
+        void *buf = block->base + block->used;
+        block->used += bytes;
+        return buf;
+    }
+
+    // Move on to the next block. The blocks after the current one are not in use.
+    Block **link = block ? &block->next : &stack->first;
+    if (!*link || (*link)->size < bytes) {
+        Block *newBlock = AllocScratchBlock(Max(bytes, (int)BlockSize));
+        newBlock->next = *link;
+        *link = newBlock;
+    }
+
+    block = *link;
+    block->used = bytes;
+    stack->current = block;
+    return block->base;
+}
+
+ScratchAllocator::Scope::Scope() {
+    threadIndex = GetThreadIndex();
+
+    Stack *stack = &scratchAllocator.stacks[threadIndex];
+    stack->numScopes++;
+    block = stack->current;
+    used = block ? block->used : 0;
+}
+
+ScratchAllocator::Scope::~Scope() {
+    assert(threadIndex == GetThreadIndex());
+
+    Stack *stack = &scratchAllocator.stacks[threadIndex];
+    stack->current = block;
+    if (block) {
+        block->used = used;
+    }
+
+    // Non-worker threads give back their stacks when nothing is left in them
+    if (--stack->numScopes == 0 && !block && stack->taken) {
+        ReleaseThreadIndex(threadIndex);
+    }
+}
+
+BE_NAMESPACE_END
@@ -107,221 +107,63 @@ void Serializable::Deserialize(const Json::Value &node) {
             SetPropertyArrayCount(propertyIndex, subNode.size());
 
             for (int elementIndex = 0; elementIndex < subNode.size(); elementIndex++) {
-                switch (type) {
-                case Variant::Type::Int: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<int>());
-                    SetArrayProperty(propertyIndex, elementIndex, value.asInt());
-                    break;
-                }
-                case Variant::Type::Int64: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<int64_t>());
-                    SetArrayProperty(propertyIndex, elementIndex, value.asInt64());
-                    break;
-                }
-                case Variant::Type::Bool: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<bool>());
-                    SetArrayProperty(propertyIndex, elementIndex, value.asBool());
-                    break; 
-                }
-                case Variant::Type::Float: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<float>());
-                    SetArrayProperty(propertyIndex, elementIndex, value.asFloat());
-                    break; 
-                }
-                case Variant::Type::Vec2: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Vec2>().ToString());
-                    Vec2 v = value.type() == Json::stringValue ? Vec2::FromString(value.asCString()) : defaultValue.As<Vec2>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Vec3: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Vec3>().ToString());
-                    Vec3 v = value.type() == Json::stringValue ? Vec3::FromString(value.asCString()) : defaultValue.As<Vec3>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Vec4: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Vec4>().ToString());
-                    Vec4 v = value.type() == Json::stringValue ? Vec4::FromString(value.asCString()) : defaultValue.As<Vec4>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Color3: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Color3>().ToString());
-                    Color3 v = value.type() == Json::stringValue ? Color3::FromString(value.asCString()) : defaultValue.As<Color3>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Color4: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Color4>().ToString());
-                    Color4 v = value.type() == Json::stringValue ? Color4::FromString(value.asCString()) : defaultValue.As<Color4>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Mat2: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Mat2>().ToString());
-                    Mat2 v = value.type() == Json::stringValue ? Mat2::FromString(value.asCString()) : defaultValue.As<Mat2>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Mat3: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Mat3>().ToString());
-                    Mat3 v = value.type() == Json::stringValue ? Mat3::FromString(value.asCString()) : defaultValue.As<Mat3>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Mat3x4: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Mat3x4>().ToString());
-                    Mat3x4 v = value.type() == Json::stringValue ? Mat3x4::FromString(value.asCString()) : defaultValue.As<Mat3x4>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Mat4: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Mat4>().ToString());
-                    Mat4 v = value.type() == Json::stringValue ? Mat4::FromString(value.asCString()) : defaultValue.As<Mat4>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Angles: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Angles>().ToString());
-                    Angles v = value.type() == Json::stringValue ? Angles::FromString(value.asCString()) : defaultValue.As<Angles>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break; 
-                }
-                case Variant::Type::Quat: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Quat>().ToString());
-                    Quat v = value.type() == Json::stringValue ? Quat::FromString(value.asCString()) : defaultValue.As<Quat>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Point: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Point>().ToString());
-                    Point v = value.type() == Json::stringValue ? Point::FromString(value.asCString()) : defaultValue.As<Point>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Rect: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Rect>().ToString());
-                    Rect v = value.type() == Json::stringValue ? Rect::FromString(value.asCString()) : defaultValue.As<Rect>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Guid: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Guid>().ToString());
-                    Guid v = value.type() == Json::stringValue ? Guid::FromString(value.asCString()) : defaultValue.As<Guid>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                case Variant::Type::Str: {
-                    const Json::Value value = subNode.get(elementIndex, defaultValue.As<Str>().c_str());
-                    Str v = value.type() == Json::stringValue ? Str(value.asCString()) : defaultValue.As<Str>();
-                    SetArrayProperty(propertyIndex, elementIndex, v);
-                    break;
-                }
-                default:
-                    assert(0);
-                    break;
-                }
+                const Json::Value value = subNode.get(elementIndex, defaultValue.ToJsonValue());
+                SetArrayProperty(propertyIndex, elementIndex, JsonValueToVariant(type, value, defaultValue));
             }
         } else {
             const Json::Value value = node.get(name, defaultValue.ToJsonValue());
-
-            switch (type) {
-            case Variant::Type::Int:
-                SetProperty(propertyIndex, value.asInt());
-                break;
-            case Variant::Type::Int64:
-                SetProperty(propertyIndex, value.asInt64());
-                break;
-            case Variant::Type::Bool:
-                SetProperty(propertyIndex, value.asBool());
-                break;
-            case Variant::Type::Float:
-                SetProperty(propertyIndex, value.asFloat());
-                break;
-            case Variant::Type::Vec2: {
-                Vec2 v = value.type() == Json::stringValue ? Vec2::FromString(value.asCString()) : defaultValue.As<Vec2>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Vec3: {
-                Vec3 v = value.type() == Json::stringValue ? Vec3::FromString(value.asCString()) : defaultValue.As<Vec3>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Vec4: {
-                Vec4 v = value.type() == Json::stringValue ? Vec4::FromString(value.asCString()) : defaultValue.As<Vec4>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Color3: {
-                Color3 v = value.type() == Json::stringValue ? Color3::FromString(value.asCString()) : defaultValue.As<Color3>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Color4: {
-                Color4 v = value.type() == Json::stringValue ? Color4::FromString(value.asCString()) : defaultValue.As<Color4>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Mat2: {
-                Mat2 v = value.type() == Json::stringValue ? Mat2::FromString(value.asCString()) : defaultValue.As<Mat2>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Mat3: {
-                Mat3 v = value.type() == Json::stringValue ? Mat3::FromString(value.asCString()) : defaultValue.As<Mat3>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Mat3x4: {
-                Mat3x4 v = value.type() == Json::stringValue ? Mat3x4::FromString(value.asCString()) : defaultValue.As<Mat3x4>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Mat4: {
-                Mat4 v = value.type() == Json::stringValue ? Mat4::FromString(value.asCString()) : defaultValue.As<Mat4>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Angles: {
-                Angles v = value.type() == Json::stringValue ? Angles::FromString(value.asCString()) : defaultValue.As<Angles>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Quat: {
-                Quat v = value.type() == Json::stringValue ? Quat::FromString(value.asCString()) : defaultValue.As<Quat>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Point: {
-                Point v = value.type() == Json::stringValue ? Point::FromString(value.asCString()) : defaultValue.As<Point>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Rect: {
-                Rect v = value.type() == Json::stringValue ? Rect::FromString(value.asCString()) : defaultValue.As<Rect>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Guid: {
-                Guid v = value.type() == Json::stringValue ? Guid::FromString(value.asCString()) : defaultValue.As<Guid>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            case Variant::Type::Str: {
-                Str v = value.type() == Json::stringValue ? Str(value.asCString()) : defaultValue.As<Str>();
-                SetProperty(propertyIndex, v);
-                break;
-            }
-            default:
-                assert(0);
-                break;
-            }
+            SetProperty(propertyIndex, JsonValueToVariant(type, value, defaultValue));
         }
     }
 }
 
+Variant Serializable::JsonValueToVariant(Variant::Type::Enum type, const Json::Value &value, const Variant &defaultValue) {
+    switch (type) {
+    case Variant::Type::Int:
+        return value.asInt();
+    case Variant::Type::Int64:
+        return (int64_t)value.asInt64();
+    case Variant::Type::Bool:
+        return value.asBool();
+    case Variant::Type::Float:
+        return value.asFloat();
+    case Variant::Type::Vec2:
+        return value.type() == Json::stringValue ? Vec2::FromString(value.asCString()) : defaultValue.As<Vec2>();
+    case Variant::Type::Vec3:
+        return value.type() == Json::stringValue ? Vec3::FromString(value.asCString()) : defaultValue.As<Vec3>();
+    case Variant::Type::Vec4:
+        return value.type() == Json::stringValue ? Vec4::FromString(value.asCString()) : defaultValue.As<Vec4>();
+    case Variant::Type::Color3:
+        return value.type() == Json::stringValue ? Color3::FromString(value.asCString()) : defaultValue.As<Color3>();
+    case Variant::Type::Color4:
+        return value.type() == Json::stringValue ? Color4::FromString(value.asCString()) : defaultValue.As<Color4>();
+    case Variant::Type::Mat2:
+        return value.type() == Json::stringValue ? Mat2::FromString(value.asCString()) : defaultValue.As<Mat2>();
+    case Variant::Type::Mat3:
+        return value.type() == Json::stringValue ? Mat3::FromString(value.asCString()) : defaultValue.As<Mat3>();
+    case Variant::Type::Mat3x4:
+        return value.type() == Json::stringValue ? Mat3x4::FromString(value.asCString()) : defaultValue.As<Mat3x4>();
+    case Variant::Type::Mat4:
+        return value.type() == Json::stringValue ? Mat4::FromString(value.asCString()) : defaultValue.As<Mat4>();
+    case Variant::Type::Angles:
+        return value.type() == Json::stringValue ? Angles::FromString(value.asCString()) : defaultValue.As<Angles>();
+    case Variant::Type::Quat:
+        return value.type() == Json::stringValue ? Quat::FromString(value.asCString()) : defaultValue.As<Quat>();
+    case Variant::Type::Point:
+        return value.type() == Json::stringValue ? Point::FromString(value.asCString()) : defaultValue.As<Point>();
+    case Variant::Type::Rect:
+        return value.type() == Json::stringValue ? Rect::FromString(value.asCString()) : defaultValue.As<Rect>();
+    case Variant::Type::Guid:
+        return value.type() == Json::stringValue ? Guid::FromString(value.asCString()) : defaultValue.As<Guid>();
+    case Variant::Type::Str:
+        return value.type() == Json::stringValue ? Str(value.asCString()) : defaultValue.As<Str>();
+    default:
+        assert(0);
+        break;
+    }
+    return Variant();
+}
+
 Variant Serializable::GetPropertyDefault(const char *name) const {
     PropertyInfo propertyInfo;
     Variant out;
@@ -60,12 +60,6 @@ TaskManager::~TaskManager() {
     PlatformCondition::Destroy(finishCondition);
     PlatformMutex::Destroy(finishMutex);
 
-    // Destroy all the task threads.
-    for (int i = 0; i < taskThreads.Count(); i++) {
-        PlatformThread::Destroy(taskThreads[i]);
-    }
-    taskThreads.Clear();
-
     delete [] taskBuffer;
 }
 
@@ -109,8 +103,9 @@ void TaskManager::Stop() {
     PlatformCondition::Broadcast(taskCondition);
     PlatformMutex::Unlock(taskMutex);
 
-    // Wait until finishing all the task threads.
+    // Wait until finishing all the task threads. JoinAll() also releases the thread objects.
     PlatformThread::JoinAll(taskThreads.Count(), (PlatformBaseThread **)taskThreads.Ptr());
+    taskThreads.Clear();
 }
 
 void TaskManager::WaitFinish() {
@@ -54,9 +54,17 @@ void Engine::InitBase(const char *baseDir, bool forceGenericSIMD, const streamOu
     PlatformTime::Init();
 
     Math::Init();
+
+    scratchAllocator.Init();
+
+    jobSystem.Init();
 }
 
 void Engine::ShutdownBase() {
+    jobSystem.Shutdown();
+
+    scratchAllocator.Shutdown();
+
     PlatformTime::Shutdown();
     
     SIMD::Shutdown();
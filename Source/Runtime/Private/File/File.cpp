@@ -17,6 +17,7 @@
 #include "Core/Guid.h"
 #include "Core/Object.h"
 #include "File/File.h"
+#include "File/FileSystem.h"
 #include "minizip/unzip.h"
 
 BE_NAMESPACE_BEGIN
@@ -285,13 +286,16 @@ bool FileReal::Write(const void *buffer, size_t bytesToWrite) {
 // FileInZip
 //---------------------------------------------------------------
 
-FileInZip::FileInZip(const char *filename, void *pointer) {
+FileInZip::FileInZip(const char *filename, ZipArchive *archive, void *pointer) {
     Str::Copynz(this->filename, filename, COUNT_OF(this->filename));
+    this->archive = archive;
     this->pointer = pointer;
 }
 
 FileInZip::~FileInZip() {
     unzCloseCurrentFile(pointer);
+
+    FileSystem::FreeZipHandle(archive, pointer);
 }
 
 size_t FileInZip::Size() const {
@@ -18,6 +18,7 @@
 #include "Core/Cmds.h"
 #include "Platform/PlatformSystem.h"
 #include "Platform/PlatformProcess.h"
+#include "Platform/PlatformThread.h"
 #include "File/FileSystem.h"
 #include "minizip/zip.h"
 #include "minizip/unzip.h"
@@ -44,13 +45,17 @@ struct ZipEntry {
     uLong               unzOffset;
 };
 
+// Each open file in the archive reads with its own unzFile handle, because the handle keeps the current file.
+// Handles are kept for reuse after the files are closed, so that the files can be read from multiple threads.
 struct ZipArchive {
     char                name[MaxRelativePath];
     char                fullPath[MaxAbsolutePath];
-    unzFile             unzArchive;
     int                 numEntries;
     Array<ZipEntry *>   entryList;
     HashIndex           entryHash;
+    PlatformMutex *     handleMutex;
+    Array<unzFile>      handles;
+    Array<unzFile>      freeHandles;
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -88,7 +93,13 @@ void FileSystem::ClearSearchPath() {
         if (s->archive) {
             s->archive->entryList.DeleteContents(true);
             s->archive->entryHash.Free();
-            unzClose(s->archive->unzArchive);
+
+            // All the files in the archive should be closed before
+            assert(s->archive->freeHandles.Count() == s->archive->handles.Count());
+            for (int i = 0; i < s->archive->handles.Count(); i++) {
+                unzClose(s->archive->handles[i]);
+            }
+            PlatformMutex::Destroy(s->archive->handleMutex);
             delete s->archive;
         } else if (s->pathname) {
             delete[] s->pathname;
@@ -224,18 +235,22 @@ static void _fill_fopen_filefunc(zlib_filefunc_def* pzlib_filefunc_def) {
 
 #endif
 
+static unzFile OpenUnzArchive(const char *fullPath) {
+#if defined(__ANDROID__)
+    zlib_filefunc_def zlib_filefunc32_def;
+    _fill_fopen_filefunc(&zlib_filefunc32_def);
+    return unzOpen2(fileSystem.ToRelativePath(fullPath), &zlib_filefunc32_def);
+#else
+    return unzOpen(fullPath);
+#endif
+}
+
 void FileSystem::AddSearchPath_ZIP(const char *path, const char *filename) {
     char fullpath[MaxAbsolutePath];
     fileSystem.MakeFullPath(fullpath, sizeof(fullpath), path, "", filename);
     
     unz_global_info z_global_info;
-#if defined(__ANDROID__) 
-    zlib_filefunc_def zlib_filefunc32_def;
-    _fill_fopen_filefunc(&zlib_filefunc32_def);
-    unzFile z_file = unzOpen2(ToRelativePath(fullpath), &zlib_filefunc32_def);
-#else
-    unzFile z_file = unzOpen(fullpath);
-#endif
+    unzFile z_file = OpenUnzArchive(fullpath);
     if (unzGetGlobalInfo(z_file, &z_global_info) != UNZ_OK) {
         return;
     }
@@ -245,7 +260,9 @@ void FileSystem::AddSearchPath_ZIP(const char *path, const char *filename) {
     strcpy(archive->fullPath, fullpath);
     strcpy(archive->name, filename);
 
-    archive->unzArchive = z_file;
+    archive->handleMutex = (PlatformMutex *)PlatformMutex::Create();
+    archive->handles.Append(z_file);
+    archive->freeHandles.Append(z_file);
     archive->numEntries = (int)z_global_info.number_entry;
     
     archive->entryList.Resize((int)z_global_info.number_entry);
@@ -612,9 +629,15 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
                     BE_LOG("FileSystem::OpenFileRead: %s (found in '%s')\n", filename, archive->name);
                 }
 
-                unzSetOffset(archive->unzArchive, entry->unzOffset);
-                unzOpenCurrentFile(archive->unzArchive);
-                FileInZip *file = new FileInZip(filename, (void *)archive->unzArchive);
+                unzFile handle = (unzFile)AllocZipHandle(archive);
+                if (!handle) {
+                    BE_WARNLOG("FileSystem::OpenFileRead: failed to open '%s'\n", archive->fullPath);
+                    break;
+                }
+
+                unzSetOffset(handle, entry->unzOffset);
+                unzOpenCurrentFile(handle);
+                FileInZip *file = new FileInZip(filename, archive, (void *)handle);
 
                 if (fileSize) {
                     file->size = *fileSize = entry->uncompressedSize;
@@ -649,6 +672,31 @@ File *FileSystem::OpenFileRead(const char *filename, bool useSearchPath, size_t
     return resultFile;
 }
 
+void *FileSystem::AllocZipHandle(ZipArchive *archive) {
+    PlatformMutex::Lock(archive->handleMutex);
+
+    unzFile handle;
+    if (archive->freeHandles.Count() > 0) {
+        handle = archive->freeHandles[archive->freeHandles.Count() - 1];
+        archive->freeHandles.RemoveIndex(archive->freeHandles.Count() - 1);
+    } else {
+        handle = OpenUnzArchive(archive->fullPath);
+        if (handle) {
+            archive->handles.Append(handle);
+        }
+    }
+
+    PlatformMutex::Unlock(archive->handleMutex);
+
+    return (void *)handle;
+}
+
+void FileSystem::FreeZipHandle(ZipArchive *archive, void *handle) {
+    PlatformMutex::Lock(archive->handleMutex);
+    archive->freeHandles.Append((unzFile)handle);
+    PlatformMutex::Unlock(archive->handleMutex);
+}
+
 File *FileSystem::OpenFileWrite(const char *filename) {
     if (fs_debug.GetBool()) {
         BE_LOG("FileSystem::OpenFileWrite: %s\n", filename);
@@ -0,0 +1,137 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+BE_NAMESPACE_BEGIN
+
+#define BMAP_IDENT      MAKE_FOURCC('B', 'E', 'W', '1')
+#define BMAP_VERSION    1
+
+#define BMAP_NULL_INDEX 0xFFFFFFFF
+
+// Cooked map file layout. Every table is addressed by the byte offset from the beginning of the file,
+// and aligned to 4 bytes so that the file can be used in place after mapping to memory.
+//
+// BMapHeader
+// string offsets       uint32_t[numStrings], null-terminated characters follow
+// GUIDs                Guid[numGuids]
+// classes              BMapClass[numClasses]
+// properties           BMapProperty[numProperties], property schema of each class in PropertyInfo order
+// objects              BMapObject[numObjects], entity object followed by it's component objects
+// entities             BMapEntity[numEntities]
+// values               property value blobs of objects
+//
+// Property value blob of an object has values of each property in the class schema order.
+// Array property is prefixed by uint32_t number of elements. Str value is stored as string index,
+// Guid value is stored as GUID index and bool value is stored as uint32_t. The other values are
+// stored as it's raw memory layout.
+
+#pragma pack(1)
+
+struct BMapHeader {
+    int32_t         ident;
+    int32_t         version;
+    int32_t         mapVersion;
+    uint32_t        renderSettingsObject;
+    uint32_t        numStrings;
+    uint32_t        stringsOffset;
+    uint32_t        numGuids;
+    uint32_t        guidsOffset;
+    uint32_t        numClasses;
+    uint32_t        classesOffset;
+    uint32_t        numProperties;
+    uint32_t        propertiesOffset;
+    uint32_t        numObjects;
+    uint32_t        objectsOffset;
+    uint32_t        numEntities;
+    uint32_t        entitiesOffset;
+    uint32_t        valuesSize;
+    uint32_t        valuesOffset;
+};
+
+struct BMapClass {
+    uint32_t        nameString;
+    uint32_t        firstProperty;
+    uint32_t        numProperties;
+};
+
+struct BMapProperty {
+    uint32_t        nameString;
+    int32_t         type;
+    uint32_t        isArray;
+};
+
+struct BMapObject {
+    uint32_t        classIndex;
+    uint32_t        guidIndex;
+    uint32_t        valueOffset;        // byte offset in the values section
+    uint32_t        jsonString;         // JSON text to deserialize for the object which has dynamic property list, otherwise BMAP_NULL_INDEX
+};
+
+struct BMapEntity {
+    uint32_t        objectIndex;
+    uint32_t        numComponents;
+    int32_t         spawnEntityNum;
+};
+
+#pragma pack()
+
+class MapRenderSettings;
+
+struct BMapLoadClass {
+    const MetaObject *          metaObject;
+    Array<PropertyInfo>         propertyInfoList;
+};
+
+struct BMapDecodedObject {
+    Array<Variant>              values;             ///< Decoded values of all properties in PropertyInfo order
+    Array<int>                  arrayCounts;        ///< Number of elements for each property, -1 for non-array property
+    Json::Value                 deserializeValue;   ///< Parsed JSON value for the object that should be deserialized by itself
+    bool                        decoded = false;    ///< False if the object data is out of the file bounds or malformed
+};
+
+/// Reader of the cooked map file. Open() doesn't touch the game world so it can be called from any thread.
+class BMapReader {
+public:
+    ~BMapReader() { Close(); }
+
+                                /// Reads and validates the file, and then decodes property values of all objects in parallel.
+                                /// Returns false without touching anything if any table, index or value is out of the file bounds.
+    bool                        Open(const char *filename);
+    void                        Close();
+
+    int                         NumEntities() const { return header ? header->numEntities : 0; }
+
+                                /// Sets the properties of the given object with the decoded values of the object.
+    void                        ReadObject(int objectIndex, Serializable *object) const;
+
+    void                        ReadRenderSettings(MapRenderSettings *mapRenderSettings) const;
+
+    const char *                GetString(uint32_t stringIndex) const { return stringData + stringOffsets[stringIndex]; }
+
+    PlatformFileMapping *       fileMapping = nullptr;
+    byte *                      fileData = nullptr;
+    const BMapHeader *          header = nullptr;
+    const uint32_t *            stringOffsets = nullptr;
+    const char *                stringData = nullptr;
+    const Guid *                guids = nullptr;
+    const BMapObject *          objects = nullptr;
+    const BMapEntity *          entities = nullptr;
+    const byte *                values = nullptr;
+    Array<BMapLoadClass>        classes;
+    Array<BMapDecodedObject>    decodedObjects;
+};
+
+BE_NAMESPACE_END
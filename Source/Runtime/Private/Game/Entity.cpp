@@ -13,12 +13,14 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/Allocator.h"
 #include "Components/Component.h"
 #include "Components/ComTransform.h"
 #include "Components/ComRenderable.h"
 #include "Components/ComScript.h"
 #include "Game/Entity.h"
 #include "Game/GameWorld.h"
+#include "Game/EntityPool.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -80,6 +82,21 @@ Entity::~Entity() {
     Purge();
 }
 
+struct EntityStorage {
+    byte                        data[sizeof(Entity)];
+};
+
+static BlockAllocator<EntityStorage, 256> entityAllocator;
+
+void *Entity::operator new(size_t size) {
+    assert(size == sizeof(EntityStorage));
+    return entityAllocator.Alloc();
+}
+
+void Entity::operator delete(void *ptr) {
+    entityAllocator.Free(reinterpret_cast<EntityStorage *>(ptr));
+}
+
 void Entity::Purge() {
     // Purge all the components in opposite order
     for (int componentIndex = components.Count() - 1; componentIndex >= 0; componentIndex--) {
@@ -96,6 +113,10 @@ void Entity::Purge() {
 
 void Entity::Event_ImmediateDestroy() {
     if (gameWorld) {
+        if (pool) {
+            gameWorld->entitiesToRecycle.Remove(this);
+        }
+
         if (gameWorld->IsRegisteredEntity(this)) {
             gameWorld->UnregisterEntity(this);
         }
@@ -570,6 +591,12 @@ bool Entity::IntersectRay(const Ray &ray, bool backFaceCull, float &lastDist) co
 }
 
 void Entity::DestroyInstance(Entity *entity) {
+    // Pooled instance will be returned to the pool at the end of the frame
+    if (entity->pool) {
+        entity->gameWorld->RecycleEntity(entity);
+        return;
+    }
+
     EntityPtrArray children;
     entity->GetChildren(children);
 
@@ -579,6 +606,24 @@ void Entity::DestroyInstance(Entity *entity) {
     Object::DestroyInstance(entity);
 }
 
+void Entity::PurgeForReuse() {
+    if (gameWorld && gameWorld->IsRegisteredEntity(this)) {
+        gameWorld->UnregisterEntity(this);
+    } else {
+        node.RemoveFromHierarchy();
+    }
+
+    Purge();
+
+    // Back to the initial states of newly created entity
+    activeSelf = true;
+    activeInHierarchy = true;
+
+    for (int componentIndex = 0; componentIndex < components.Count(); componentIndex++) {
+        components[componentIndex]->enabled = true;
+    }
+}
+
 void Entity::SetName(const Str &name) {
     this->name = name;
 
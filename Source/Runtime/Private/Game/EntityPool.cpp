@@ -0,0 +1,148 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Game/Entity.h"
+#include "Game/EntityPool.h"
+#include "Game/GameWorld.h"
+#include "Game/Prefab.h"
+#include "Components/Component.h"
+
+BE_NAMESPACE_BEGIN
+
+EntityPool::EntityPool(GameWorld *gameWorld, Prefab *prefab) {
+    this->gameWorld = gameWorld;
+    this->prefab = prefab;
+}
+
+EntityPool::~EntityPool() {
+    Clear();
+}
+
+void EntityPool::Clear() {
+    for (int instanceIndex = 0; instanceIndex < freeInstances.Count(); instanceIndex++) {
+        const EntityPtrArray &entities = freeInstances[instanceIndex];
+
+        for (int entityIndex = entities.Count() - 1; entityIndex >= 0; entityIndex--) {
+            Entity::DestroyInstanceImmediate(entities[entityIndex]);
+        }
+    }
+
+    freeInstances.Clear();
+}
+
+void EntityPool::DetachPrefab() {
+    Clear();
+
+    prefab = nullptr;
+}
+
+static void SetInstanceRegistered(const EntityPtrArray &entities, bool registered) {
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        Entity *entity = entities[entityIndex];
+
+        if (registered) {
+            entity->RegisterInstance();
+        } else {
+            entity->UnregisterInstance();
+        }
+
+        for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+            Component *component = entity->GetComponent(componentIndex);
+
+            if (registered) {
+                component->RegisterInstance();
+            } else {
+                component->UnregisterInstance();
+            }
+        }
+    }
+}
+
+Entity *EntityPool::Alloc(const EntityTemplate &entityTemplate, int sceneIndex) {
+    assert(prefab);
+    Prefab::PoolStats &poolStats = prefab->GetPoolStats();
+
+    poolStats.numSpawns++;
+
+    Entity *rootEntity = nullptr;
+
+    while (freeInstances.Count() > 0) {
+        EntityPtrArray entities = freeInstances.Last();
+        freeInstances.RemoveIndex(freeInstances.Count() - 1);
+
+        // Template might be recompiled with the different structure after this instance was pooled
+        if (!entityTemplate.Matches(entities)) {
+            for (int entityIndex = entities.Count() - 1; entityIndex >= 0; entityIndex--) {
+                Entity::DestroyInstanceImmediate(entities[entityIndex]);
+            }
+            poolStats.numDiscards++;
+            continue;
+        }
+
+        SetInstanceRegistered(entities, true);
+
+        rootEntity = entityTemplate.Reset(entities, gameWorld, sceneIndex);
+
+        poolStats.numHits++;
+        break;
+    }
+
+    if (!rootEntity) {
+        rootEntity = entityTemplate.Instantiate(gameWorld, sceneIndex);
+    }
+
+    rootEntity->pool = this;
+
+    return rootEntity;
+}
+
+bool EntityPool::Free(Entity *rootEntity) {
+    assert(rootEntity->pool == this);
+    rootEntity->pool = nullptr;
+
+    // Prefab has been cleared, so this instance is out of date
+    if (!prefab) {
+        return false;
+    }
+
+    Prefab::PoolStats &poolStats = prefab->GetPoolStats();
+
+    EntityPtrArray entities;
+    entities.Append(rootEntity);
+    rootEntity->GetChildren(entities);
+
+    // Instances which are modified structurally can't be reset by the template
+    const EntityTemplate *entityTemplate = prefab->GetInstantiationTemplate();
+    if (freeInstances.Count() >= prefab->GetPoolCapacity() || !entityTemplate || !entityTemplate->Matches(entities)) {
+        poolStats.numDiscards++;
+        return false;
+    }
+
+    // Remove from the game world and release the render/physics resources in reverse depth-first order
+    for (int entityIndex = entities.Count() - 1; entityIndex >= 0; entityIndex--) {
+        entities[entityIndex]->PurgeForReuse();
+    }
+
+    // Pooled objects shouldn't be found by GUID until reused
+    SetInstanceRegistered(entities, false);
+
+    freeInstances.Append(entities);
+
+    poolStats.numRecycles++;
+
+    return true;
+}
+
+BE_NAMESPACE_END
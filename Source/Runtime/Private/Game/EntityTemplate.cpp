@@ -0,0 +1,342 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Game/Entity.h"
+#include "Game/EntityTemplate.h"
+#include "Game/GameWorld.h"
+#include "Components/ComScript.h"
+
+BE_NAMESPACE_BEGIN
+
+void EntityTemplate::Clear() {
+    entities.Clear();
+    objects.Clear();
+    properties.Clear();
+    values.Clear();
+    valueGuidSlots.Clear();
+    sourceGuids.Clear();
+}
+
+bool EntityTemplate::Compile(const Entity *rootEntity) {
+    Clear();
+
+    // Serialize source entity and it's children as the JSON cloning path does, 
+    // so that the compiled values are exactly the same with the deserialized ones.
+    Json::Value entitiesValue;
+    Entity::SerializeHierarchy(rootEntity, entitiesValue);
+
+    // Assign GUID slots for all of the entities and components
+    HashTable<Guid, int> guidSlotTable;
+
+    for (int entityIndex = 0; entityIndex < entitiesValue.size(); entityIndex++) {
+        const Json::Value &entityValue = entitiesValue[entityIndex];
+
+        Guid entityGuid = Guid::FromString(entityValue["guid"].asCString());
+        int entitySlot = sourceGuids.Append(entityGuid);
+        guidSlotTable.Set(entityGuid, entitySlot);
+
+        const Json::Value &componentsValue = entityValue["components"];
+
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            Guid componentGuid = Guid::FromString(componentsValue[componentIndex]["guid"].asCString());
+            int componentSlot = sourceGuids.Append(componentGuid);
+            guidSlotTable.Set(componentGuid, componentSlot);
+        }
+    }
+
+    Array<PropertyInfo> entityPropertyInfoList;
+    Entity::metaObject.GetPropertyInfoList(entityPropertyInfoList);
+
+    int guidSlot = 0;
+
+    for (int entityIndex = 0; entityIndex < entitiesValue.size(); entityIndex++) {
+        const Json::Value &entityValue = entitiesValue[entityIndex];
+        const Json::Value &componentsValue = entityValue["components"];
+
+        EntityEntry &entry = entities.Alloc();
+        entry.objectIndex = objects.Count();
+        entry.numComponents = 0;
+        entry.needRemapGuids = false;
+        entry.prefabSourceGuid = entityValue["prefab"].asBool() ? sourceGuids[guidSlot] : Guid::zero;
+
+        CompileObject(&Entity::metaObject, entityPropertyInfoList, entityValue, guidSlot++, guidSlotTable);
+
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            const Json::Value &componentValue = componentsValue[componentIndex];
+            const int componentSlot = guidSlot++;
+
+            const char *classname = componentValue["classname"].asCString();
+            const MetaObject *metaComponent = Object::FindMetaObject(classname);
+
+            if (!metaComponent) {
+                BE_WARNLOG("Unknown component class '%s'\n", classname);
+                continue;
+            }
+            if (!metaComponent->IsTypeOf(Component::metaObject)) {
+                BE_WARNLOG("'%s' is not a component class\n", classname);
+                continue;
+            }
+
+            if (metaComponent->IsTypeOf(ComScript::metaObject)) {
+                // Script component builds it's property list from the script while deserializing,
+                // so keep the JSON value and let it deserialize by itself.
+                ObjectTemplate &objectTemplate = objects.Alloc();
+                objectTemplate.metaObject = metaComponent;
+                objectTemplate.guidSlot = componentSlot;
+                objectTemplate.firstProperty = properties.Count();
+                objectTemplate.numProperties = 0;
+                objectTemplate.deserializeValue = componentValue;
+
+                entry.needRemapGuids = true;
+            } else {
+                Array<PropertyInfo> propertyInfoList;
+                metaComponent->GetPropertyInfoList(propertyInfoList);
+
+                CompileObject(metaComponent, propertyInfoList, componentValue, componentSlot, guidSlotTable);
+            }
+
+            entry.numComponents++;
+        }
+    }
+
+    return true;
+}
+
+void EntityTemplate::CompileObject(const MetaObject *metaObject, const Array<PropertyInfo> &propertyInfoList, const Json::Value &objectValue, int guidSlot, const HashTable<Guid, int> &guidSlotTable) {
+    ObjectTemplate &objectTemplate = objects.Alloc();
+    objectTemplate.metaObject = metaObject;
+    objectTemplate.guidSlot = guidSlot;
+    objectTemplate.firstProperty = properties.Count();
+
+    // Same rules with Serializable::Deserialize()
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+
+        if (propertyInfo.GetFlags() & PropertyInfo::Flag::ReadOnly) {
+            continue;
+        }
+
+        const char *name = propertyInfo.GetName();
+        const Variant::Type::Enum type = propertyInfo.GetType();
+        const Variant defaultValue = propertyInfo.GetDefaultValue();
+
+        PropertyBinding &binding = properties.Alloc();
+        binding.propertyInfo = propertyInfo;
+        binding.firstValue = values.Count();
+
+        if (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) {
+            const Json::Value subNode = objectValue.get(name, Json::Value());
+
+            binding.arrayCount = subNode.size();
+
+            for (int elementIndex = 0; elementIndex < subNode.size(); elementIndex++) {
+                CompileValue(type, subNode.get(elementIndex, defaultValue.ToJsonValue()), defaultValue, guidSlotTable);
+            }
+        } else {
+            binding.arrayCount = -1;
+
+            CompileValue(type, objectValue.get(name, defaultValue.ToJsonValue()), defaultValue, guidSlotTable);
+        }
+    }
+
+    objectTemplate.numProperties = properties.Count() - objectTemplate.firstProperty;
+}
+
+void EntityTemplate::CompileValue(Variant::Type::Enum type, const Json::Value &jsonValue, const Variant &defaultValue, const HashTable<Guid, int> &guidSlotTable) {
+    Variant value = Serializable::JsonValueToVariant(type, jsonValue, defaultValue);
+
+    // GUID which references an object in this template will be replaced to the new one at instantiation
+    int guidSlot = -1;
+    if (type == Variant::Type::Guid) {
+        guidSlotTable.Get(value.As<Guid>(), &guidSlot);
+    }
+
+    values.Append(value);
+    valueGuidSlots.Append(guidSlot);
+}
+
+void EntityTemplate::ApplyProperties(Serializable *object, const ObjectTemplate &objectTemplate, const Guid *newGuids) const {
+    for (int bindingIndex = 0; bindingIndex < objectTemplate.numProperties; bindingIndex++) {
+        const PropertyBinding &binding = properties[objectTemplate.firstProperty + bindingIndex];
+
+        if (binding.arrayCount < 0) {
+            const int guidSlot = valueGuidSlots[binding.firstValue];
+
+            if (guidSlot >= 0) {
+                object->SetProperty(binding.propertyInfo, newGuids[guidSlot]);
+            } else {
+                object->SetProperty(binding.propertyInfo, values[binding.firstValue]);
+            }
+        } else {
+            object->SetPropertyArrayCount(binding.propertyInfo, binding.arrayCount);
+
+            for (int elementIndex = 0; elementIndex < binding.arrayCount; elementIndex++) {
+                const int guidSlot = valueGuidSlots[binding.firstValue + elementIndex];
+
+                if (guidSlot >= 0) {
+                    object->SetArrayProperty(binding.propertyInfo, elementIndex, newGuids[guidSlot]);
+                } else {
+                    object->SetArrayProperty(binding.propertyInfo, elementIndex, values[binding.firstValue + elementIndex]);
+                }
+            }
+        }
+    }
+}
+
+void EntityTemplate::InitEntity(Entity *entity, const EntityEntry &entry, const ComponentPtrArray &components, const Array<Guid> &newGuids, HashTable<Guid, Guid> &guidMap) const {
+    ApplyProperties(entity, objects[entry.objectIndex], newGuids.Ptr());
+
+    for (int componentIndex = 0; componentIndex < entry.numComponents; componentIndex++) {
+        const ObjectTemplate &componentTemplate = objects[entry.objectIndex + 1 + componentIndex];
+
+        Component *component = components[componentIndex];
+        component->SetEntity(entity);
+
+        if (componentTemplate.deserializeValue.isNull()) {
+            ApplyProperties(component, componentTemplate, newGuids.Ptr());
+        } else {
+            component->Deserialize(componentTemplate.deserializeValue);
+        }
+
+        entity->AddComponent(component);
+    }
+
+    if (entry.needRemapGuids) {
+        // GUID map is needed only for the objects deserialized from JSON value
+        if (guidMap.Count() == 0) {
+            for (int guidSlot = 0; guidSlot < newGuids.Count(); guidSlot++) {
+                Guid newGuid = newGuids[guidSlot];
+                guidMap.Set(sourceGuids[guidSlot], newGuid);
+            }
+        }
+
+        Entity::RemapGuids(entity, guidMap);
+    }
+
+    // If source entity is prefab source, mark instantiated entity originated from prefab entity
+    if (!entry.prefabSourceGuid.IsZero()) {
+        entity->SetProperty("prefabSource", entry.prefabSourceGuid);
+        entity->SetProperty("prefab", false);
+    }
+
+    entity->Init();
+    entity->InitComponents();
+}
+
+Entity *EntityTemplate::Instantiate(GameWorld *gameWorld, int sceneIndex) const {
+    if (entities.Count() == 0) {
+        return nullptr;
+    }
+
+    // Allocate new GUIDs for all of the objects in this template
+    Array<Guid> newGuids;
+    newGuids.SetCount(sourceGuids.Count());
+
+    for (int guidSlot = 0; guidSlot < newGuids.Count(); guidSlot++) {
+        newGuids[guidSlot] = Guid::CreateGuid();
+    }
+
+    HashTable<Guid, Guid> guidMap;
+    ComponentPtrArray components;
+
+    Entity *rootEntity = nullptr;
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        const EntityEntry &entry = entities[entityIndex];
+
+        Entity *entity = static_cast<Entity *>(Entity::metaObject.CreateInstance(newGuids[objects[entry.objectIndex].guidSlot]));
+
+        entity->gameWorld = gameWorld;
+        entity->sceneIndex = sceneIndex;
+
+        components.SetCount(entry.numComponents);
+
+        for (int componentIndex = 0; componentIndex < entry.numComponents; componentIndex++) {
+            const ObjectTemplate &componentTemplate = objects[entry.objectIndex + 1 + componentIndex];
+
+            components[componentIndex] = static_cast<Component *>(componentTemplate.metaObject->CreateInstance(newGuids[componentTemplate.guidSlot]));
+        }
+
+        InitEntity(entity, entry, components, newGuids, guidMap);
+
+        if (!rootEntity) {
+            rootEntity = entity;
+        }
+    }
+
+    return rootEntity;
+}
+
+bool EntityTemplate::Matches(const EntityPtrArray &hierarchyEntities) const {
+    if (hierarchyEntities.Count() != entities.Count()) {
+        return false;
+    }
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        const EntityEntry &entry = entities[entityIndex];
+        const Entity *entity = hierarchyEntities[entityIndex];
+
+        if (entity->NumComponents() != entry.numComponents) {
+            return false;
+        }
+
+        for (int componentIndex = 0; componentIndex < entry.numComponents; componentIndex++) {
+            if (entity->GetComponent(componentIndex)->GetMetaObject() != objects[entry.objectIndex + 1 + componentIndex].metaObject) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+Entity *EntityTemplate::Reset(const EntityPtrArray &hierarchyEntities, GameWorld *gameWorld, int sceneIndex) const {
+    assert(Matches(hierarchyEntities));
+
+    // Reuse GUIDs of the existing objects
+    Array<Guid> newGuids;
+    newGuids.SetCount(sourceGuids.Count());
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        const EntityEntry &entry = entities[entityIndex];
+        const Entity *entity = hierarchyEntities[entityIndex];
+
+        newGuids[objects[entry.objectIndex].guidSlot] = entity->GetGuid();
+
+        for (int componentIndex = 0; componentIndex < entry.numComponents; componentIndex++) {
+            newGuids[objects[entry.objectIndex + 1 + componentIndex].guidSlot] = entity->GetComponent(componentIndex)->GetGuid();
+        }
+    }
+
+    HashTable<Guid, Guid> guidMap;
+    ComponentPtrArray components;
+
+    for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
+        Entity *entity = hierarchyEntities[entityIndex];
+
+        entity->gameWorld = gameWorld;
+        entity->sceneIndex = sceneIndex;
+
+        // Detach components to set the entity properties in the same order with the new instance
+        components = entity->components;
+        entity->components.Clear();
+
+        InitEntity(entity, entities[entityIndex], components, newGuids, guidMap);
+    }
+
+    return hierarchyEntities[0];
+}
+
+BE_NAMESPACE_END
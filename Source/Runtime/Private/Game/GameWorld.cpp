@@ -13,6 +13,9 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/JobSystem.h"
+#include "Core/Task.h"
+#include "Platform/PlatformTime.h"
 #include "File/FileSystem.h"
 #include "Render/Render.h"
 #include "Physics/Collider.h"
@@ -23,22 +26,30 @@
 #include "Asset/GuidMapper.h"
 #include "Components/ComTransform.h"
 #include "Components/ComCamera.h"
+#include "Components/ComAnimator.h"
+#include "Components/ComRenderable.h"
 #include "Components/ComScript.h"
 #include "Game/Entity.h"
 #include "Game/MapRenderSettings.h"
 #include "Game/GameWorld.h"
+#include "Game/Prefab.h"
+#include "Game/EntityPool.h"
 #include "Game/GameSettings.h"
 #include "Scripting/LuaVM.h"
 #include "StaticBatching/StaticBatch.h"
 #include "../StaticBatching/MeshCombiner.h"
 #include "Profiler/Profiler.h"
+#include "BMap.h"
 
 BE_NAMESPACE_BEGIN
 
+static CVAR(g_mapLoadTimeBudget, "4", CVar::Flag::Float, "Time budget in milliseconds per frame for spawning entities of the map loaded asynchronously");
+
 const EventDef EV_RestartGame("restartGame", false, "s");
 
 const SignalDef GameWorld::SIG_EntityRegistered("GameWorld::EntityRegistered", "a");
 const SignalDef GameWorld::SIG_EntityUnregistered("GameWorld::EntityUnregistered", "a");
+const SignalDef GameWorld::SIG_MapLoaded("GameWorld::MapLoaded", "ai");
 
 OBJECT_DECLARATION("Game World", GameWorld, Object)
 BEGIN_EVENTS(GameWorld)
@@ -65,8 +76,19 @@ GameWorld::GameWorld() {
 }
 
 GameWorld::~GameWorld() {
+    // Stop reading maps in the background before releasing the requests
+    if (mapLoadTaskManager) {
+        delete mapLoadTaskManager;
+    }
+    for (int requestIndex = 0; requestIndex < mapLoadRequests.Count(); requestIndex++) {
+        delete mapLoadRequests[requestIndex];
+    }
+    mapLoadRequests.Clear();
+
     ClearEntities();
 
+    entityPools.DeleteContents(true);
+
     StaticBatch::ClearAllStaticBatches();
 
     if (mapRenderSettings) {
@@ -107,6 +129,10 @@ void GameWorld::DontDestroyOnLoad(Entity *entity) {
 }
 
 void GameWorld::ClearEntities(bool clearAll) {
+    // Return pending entities to the pools and then destroy all of the pooled entities
+    RecycleEntities();
+    ClearEntityPools();
+
     // List up all of the entities to remove in depth first order
     EntityPtrArray entitiesToRemove;
 
@@ -351,6 +377,24 @@ void GameWorld::UnregisterEntity(Entity *ent) {
 }
 
 Entity *GameWorld::CloneEntity(const Entity *originalEntity) {
+    // Prefab root entity is instantiated from the compiled template of the prefab
+    if (originalEntity->IsPrefabSource() && originalEntity->GetGameWorld() == prefabManager.GetPrefabWorld()) {
+        Prefab *prefab = prefabManager.FindPrefabByRootEntity(originalEntity);
+
+        const EntityTemplate *entityTemplate = prefab ? prefab->GetInstantiationTemplate() : nullptr;
+
+        if (entityTemplate && !entityTemplate->IsEmpty()) {
+            if (prefab->GetPoolCapacity() > 0) {
+                return GetEntityPool(prefab)->Alloc(*entityTemplate, originalEntity->sceneIndex);
+            }
+            return entityTemplate->Instantiate(this, originalEntity->sceneIndex);
+        }
+    }
+
+    return CloneEntityFromJson(originalEntity);
+}
+
+Entity *GameWorld::CloneEntityFromJson(const Entity *originalEntity) {
     // Serialize source entity and it's children
     Json::Value originalEntitiesValue;
     Entity::SerializeHierarchy(originalEntity, originalEntitiesValue);
@@ -433,6 +477,62 @@ Entity *GameWorld::InstantiateEntityWithTransform(const Entity *originalEntity,
     return clonedEntity;
 }
 
+EntityPool *GameWorld::GetEntityPool(Prefab *prefab) {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        if (entityPools[poolIndex]->GetPrefab() == prefab) {
+            return entityPools[poolIndex];
+        }
+    }
+
+    EntityPool *pool = new EntityPool(this, prefab);
+    entityPools.Append(pool);
+
+    prefab->Connect(&Prefab::SIG_Cleared, this, (SignalCallback)&GameWorld::PrefabCleared, SignalObject::ConnectionType::Unique);
+
+    return pool;
+}
+
+void GameWorld::PrefabCleared(Prefab *prefab) {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        if (entityPools[poolIndex]->GetPrefab() == prefab) {
+            // Allocated instances still refer this pool, so keep it and destroy them when freed
+            entityPools[poolIndex]->DetachPrefab();
+        }
+    }
+}
+
+void GameWorld::RecycleEntity(Entity *entity) {
+    assert(entity->pool);
+
+    if (entitiesToRecycle.Find(entity)) {
+        return;
+    }
+
+    // Deactivate immediately, actual recycling will be done at safe time
+    entity->SetActive(false);
+
+    entitiesToRecycle.Append(entity);
+}
+
+void GameWorld::RecycleEntities() {
+    for (int i = 0; i < entitiesToRecycle.Count(); i++) {
+        Entity *entity = entitiesToRecycle[i];
+
+        if (!entity->pool->Free(entity)) {
+            // Couldn't be pooled, so destroy it normally
+            Entity::DestroyInstance(entity);
+        }
+    }
+
+    entitiesToRecycle.Clear();
+}
+
+void GameWorld::ClearEntityPools() {
+    for (int poolIndex = 0; poolIndex < entityPools.Count(); poolIndex++) {
+        entityPools[poolIndex]->Clear();
+    }
+}
+
 Entity *GameWorld::SpawnEntityFromJson(Json::Value &entityValue, int sceneIndex) {
     const char *classname = entityValue["classname"].asCString();
     if (Str::Cmp(classname, Entity::metaObject.ClassName()) != 0) {
@@ -595,6 +695,33 @@ void GameWorld::NewMap() {
     FinishMapLoading();
 }
 
+// Returns true if the cooked map should be tried first.
+static bool GetCookedMapFilename(const char *filename, Str &cookedFilename) {
+    cookedFilename = filename;
+
+    if (Str::CheckExtension(filename, ".bmap")) {
+        return true;
+    }
+
+    // Prefer the cooked map if it is not older than the JSON map
+    cookedFilename.SetFileExtension(".bmap");
+
+    return fileSystem.FileExists(cookedFilename) && fileSystem.GetTimeStamp(cookedFilename) >= fileSystem.GetTimeStamp(filename);
+}
+
+int GameWorld::FindFreeSceneIndex() const {
+    int sceneIndex = 0;
+    for (; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
+        if (!scenes[sceneIndex].root.GetChild() && !scenes[sceneIndex].isLoading) {
+            break;
+        }
+    }
+
+    assert(sceneIndex < COUNT_OF(scenes));
+
+    return sceneIndex;
+}
+
 bool GameWorld::LoadMap(const char *filename, LoadSceneMode::Enum mode) {
     BE_LOG("Loading map '%s'...\n", filename);
 
@@ -606,20 +733,41 @@ bool GameWorld::LoadMap(const char *filename, LoadSceneMode::Enum mode) {
 
     BeginMapLoading();
 
+    int sceneIndex = FindFreeSceneIndex();
+
+    bool loaded = false;
+
+    Str cookedFilename;
+    if (GetCookedMapFilename(filename, cookedFilename)) {
+        loaded = LoadBinaryMap(cookedFilename, sceneIndex);
+    }
+
+    if (!loaded && !Str::CheckExtension(filename, ".bmap")) {
+        loaded = LoadJsonMap(filename, sceneIndex);
+    }
+
+    if (loaded) {
+        mapName = filename;
+    }
+
+    FinishMapLoading();
+
+    return loaded;
+}
+
+bool GameWorld::LoadJsonMap(const char *filename, int sceneIndex) {
     char *text = nullptr;
     fileSystem.LoadFile(filename, true, (void **)&text);
     if (!text) {
         BE_WARNLOG("Couldn't load '%s'\n", filename);
-        FinishMapLoading();
         return false;
     }
 
-    mapName = filename;
-
     Json::Value map;
     Json::Reader jsonReader;
     if (!jsonReader.parse(text, map)) {
         BE_WARNLOG("Failed to parse JSON text\n");
+        fileSystem.FreeFile(text);
         return false;
     }
 
@@ -632,20 +780,9 @@ bool GameWorld::LoadMap(const char *filename, LoadSceneMode::Enum mode) {
     mapRenderSettings->Deserialize(map["renderSettings"]);
     mapRenderSettings->Init();
 
-    int sceneIndex = 0;
-    for (; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
-        if (!scenes[sceneIndex].root.GetChild()) {
-            break;
-        }
-    }
-
-    assert(sceneIndex < COUNT_OF(scenes));
-
     // Read and spawn entities
     SpawnEntitiesFromJson(map["entities"], sceneIndex);
 
-    FinishMapLoading();
-
     return true;
 }
 
@@ -671,6 +808,240 @@ void GameWorld::SaveMap(const char *filename) {
     fileSystem.WriteFile(filename, jsonText.c_str(), jsonText.Length());
 }
 
+MapLoadRequest::MapLoadRequest(const char *filename, GameWorld::LoadSceneMode::Enum mode) {
+    this->filename = filename;
+    this->mode = mode;
+    this->readFinished = false;
+}
+
+MapLoadRequest::~MapLoadRequest() {
+    delete binaryMap;
+}
+
+float MapLoadRequest::GetProgress() const {
+    switch (state) {
+    case State::Reading:
+        return 0.0f;
+    case State::Spawning:
+        return numEntities > 0 ? (float)numSpawnedEntities / numEntities : 1.0f;
+    default:
+        return 1.0f;
+    }
+}
+
+void MapLoadRequest::ReadTask(void *data) {
+    MapLoadRequest *request = (MapLoadRequest *)data;
+
+    request->Read();
+
+    request->readFinished.store(true, std::memory_order_release);
+}
+
+void MapLoadRequest::Read() {
+    // Same rules with GameWorld::LoadMap()
+    Str cookedFilename;
+    if (GetCookedMapFilename(filename, cookedFilename)) {
+        binaryMap = new BMapReader;
+
+        if (binaryMap->Open(cookedFilename)) {
+            readSucceeded = true;
+            return;
+        }
+
+        delete binaryMap;
+        binaryMap = nullptr;
+    }
+
+    if (Str::CheckExtension(filename, ".bmap")) {
+        return;
+    }
+
+    char *text = nullptr;
+    fileSystem.LoadFile(filename, true, (void **)&text);
+    if (!text) {
+        return;
+    }
+
+    Json::Reader jsonReader;
+    readSucceeded = jsonReader.parse(text, map);
+
+    fileSystem.FreeFile(text);
+}
+
+MapLoadRequest *GameWorld::LoadMapAsync(const char *filename, LoadSceneMode::Enum mode) {
+    BE_LOG("Loading map '%s' asynchronously...\n", filename);
+
+    if (!mapLoadTaskManager) {
+        // Reading blocks on I/O, so it runs in the dedicated thread instead of the job system workers
+        mapLoadTaskManager = new TaskManager(64, 1);
+    }
+
+    MapLoadRequest *request = new MapLoadRequest(filename, mode);
+    mapLoadRequests.Append(request);
+
+    if (!mapLoadTaskManager->AddTask(MapLoadRequest::ReadTask, request)) {
+        request->readFinished = true;
+    }
+    mapLoadTaskManager->Start();
+
+    return request;
+}
+
+void GameWorld::ReleaseMapLoadRequest(MapLoadRequest *request) {
+    if (request->state == MapLoadRequest::State::Spawning) {
+        // Entities spawned so far are left in the scene
+        scenes[request->sceneIndex].isLoading = false;
+        request->state = MapLoadRequest::State::Failed;
+    }
+
+    if (request->readFinished.load(std::memory_order_acquire)) {
+        mapLoadRequests.Remove(request);
+        delete request;
+    } else {
+        // Deleted in UpdateMapLoadRequests() after the background reading is finished
+        request->released = true;
+    }
+}
+
+void GameWorld::UpdateMapLoadRequests() {
+    if (mapLoadRequests.Count() == 0) {
+        return;
+    }
+
+    BE_PROFILE_CPU_SCOPE("GameWorld::UpdateMapLoadRequests", Color3::white);
+
+    const uint64_t startTime = PlatformTime::Microseconds();
+    const uint64_t timeBudget = (uint64_t)(g_mapLoadTimeBudget.GetFloat() * 1000.0f);
+
+    for (int requestIndex = 0; requestIndex < mapLoadRequests.Count(); requestIndex++) {
+        MapLoadRequest *request = mapLoadRequests[requestIndex];
+
+        if (request->released) {
+            if (request->readFinished.load(std::memory_order_acquire)) {
+                mapLoadRequests.RemoveIndex(requestIndex--);
+                delete request;
+            }
+            continue;
+        }
+
+        if (request->IsDone()) {
+            continue;
+        }
+
+        if (request->state == MapLoadRequest::State::Reading) {
+            // Spawn maps in the order of requests
+            if (!request->readFinished.load(std::memory_order_acquire)) {
+                break;
+            }
+
+            if (!request->readSucceeded) {
+                BE_WARNLOG("Couldn't load '%s'\n", request->filename.c_str());
+
+                request->state = MapLoadRequest::State::Failed;
+                EmitSignal(&SIG_MapLoaded, request, 0);
+                continue;
+            }
+
+            BeginMapLoadRequest(request);
+        }
+
+        // Spawn at least one entity per frame
+        while (request->numSpawnedEntities < request->numEntities) {
+            SpawnMapLoadRequestEntity(request);
+
+            if (PlatformTime::Microseconds() - startTime >= timeBudget) {
+                return;
+            }
+        }
+
+        FinishMapLoadRequest(request);
+
+        if (PlatformTime::Microseconds() - startTime >= timeBudget) {
+            return;
+        }
+    }
+}
+
+void GameWorld::BeginMapLoadRequest(MapLoadRequest *request) {
+    if (request->mode != LoadSceneMode::Additive) {
+        ClearEntities(request->mode == LoadSceneMode::Editor);
+
+        Reset();
+    }
+
+    request->sceneIndex = FindFreeSceneIndex();
+    request->state = MapLoadRequest::State::Spawning;
+
+    scenes[request->sceneIndex].isLoading = true;
+
+    // Read map render settings
+    if (request->binaryMap) {
+        request->binaryMap->ReadRenderSettings(mapRenderSettings);
+        request->numEntities = request->binaryMap->NumEntities();
+    } else {
+        mapRenderSettings->Deserialize(request->map["renderSettings"]);
+        request->numEntities = request->map["entities"].size();
+    }
+    mapRenderSettings->Init();
+}
+
+void GameWorld::SpawnMapLoadRequestEntity(MapLoadRequest *request) {
+    // Awake/Start is deferred until all of the entities in the scene are spawned
+    bool wasMapLoading = isMapLoading;
+    isMapLoading = true;
+
+    if (request->binaryMap) {
+        SpawnEntityFromBinaryMap(*request->binaryMap, request->numSpawnedEntities, request->sceneIndex);
+    } else {
+        SpawnEntityFromJson(request->map["entities"][request->numSpawnedEntities], request->sceneIndex);
+    }
+
+    isMapLoading = wasMapLoading;
+
+    request->numSpawnedEntities++;
+}
+
+void GameWorld::FinishMapLoadRequest(MapLoadRequest *request) {
+    GameScene &scene = scenes[request->sceneIndex];
+    scene.isLoading = false;
+
+    // Free decoded data
+    delete request->binaryMap;
+    request->binaryMap = nullptr;
+    request->map = Json::Value();
+
+    mapName = request->filename;
+
+    if (gameStarted) {
+        // Keep the static batches and resources of the running scenes, and start the loaded scene
+        renderWorld->FinishMapLoading();
+
+        StaticBatch::CombineAll(scene.root);
+
+        gameAwaking = true;
+
+        for (Entity *ent = scene.root.GetChild(); ent; ent = ent->node.GetNext()) {
+            if (!ent->awaked) {
+                ent->Awake();
+            }
+        }
+
+        gameAwaking = false;
+
+        for (Entity *ent = scene.root.GetChild(); ent; ent = ent->node.GetNext()) {
+            if (!ent->started) {
+                ent->Start();
+            }
+        }
+    } else {
+        FinishMapLoading();
+    }
+
+    request->state = MapLoadRequest::State::Finished;
+
+    EmitSignal(&SIG_MapLoaded, request, 1);
+}
+
 void GameWorld::Update(int elapsedTime) {
     BE_PROFILE_CPU_SCOPE("GameWorld::Update", Color3::white);
 
@@ -678,6 +1049,8 @@ void GameWorld::Update(int elapsedTime) {
         luaVM.PollDebuggee();
     }
 
+    UpdateMapLoadRequests();
+
     prevTime = time;
 
     int scaledElapsedTime = elapsedTime * timeScale;
@@ -688,8 +1061,13 @@ void GameWorld::Update(int elapsedTime) {
         // FixedUpdate() is called in StepSimulation() internally
         physicsWorld->StepSimulation(scaledElapsedTime);
 
+        memset(&animatorCounter, 0, sizeof(animatorCounter));
+
         UpdateEntities();
 
+        // Compute the animator frames which are registered in UpdateEntities()
+        UpdateAnimators();
+
         LateUpdateEntities();
 
         // Wake up waiting coroutine in Lua scripts
@@ -698,13 +1076,23 @@ void GameWorld::Update(int elapsedTime) {
         // Update tweeners in Lua scripts
         luaVM.UpdateTweeners(MS2SEC(elapsedTime), timeScale);
 
-        luaVM.State().ForceGC();
+        {
+            BE_PROFILE_CPU_SCOPE("LuaVM::CollectGarbage", Color3::magenta);
+
+            luaVM.CollectGarbage();
+        }
     }
+
+    RecycleEntities();
 }
 
 void GameWorld::FixedUpdateEntities(float timeStep) {
     // Call fixed update function for each entities in depth-first order
     for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
+        if (scenes[sceneIndex].isLoading) {
+            continue;
+        }
+
         for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
             ent->FixedUpdate(timeStep * timeScale);
         }
@@ -714,6 +1102,10 @@ void GameWorld::FixedUpdateEntities(float timeStep) {
 void GameWorld::FixedLateUpdateEntities(float timeStep) {
     // Call fixed post-update function for each entities in depth-first order
     for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
+        if (scenes[sceneIndex].isLoading) {
+            continue;
+        }
+
         for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
             ent->FixedLateUpdate(timeStep * timeScale);
         }
@@ -723,15 +1115,52 @@ void GameWorld::FixedLateUpdateEntities(float timeStep) {
 void GameWorld::UpdateEntities() {
     // Call update function for each entities in depth-first order
     for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
+        if (scenes[sceneIndex].isLoading) {
+            continue;
+        }
+
         for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
             ent->Update();
         }
     }
 }
 
+void GameWorld::RegisterAnimatorToUpdate(ComAnimator *animator) {
+    animatorsToUpdate.Append(animator);
+}
+
+void GameWorld::UnregisterAnimatorToUpdate(ComAnimator *animator) {
+    animatorsToUpdate.RemoveFast(animator);
+}
+
+void GameWorld::UpdateAnimators() {
+    if (animatorsToUpdate.Count() == 0) {
+        return;
+    }
+
+    BE_PROFILE_CPU_SCOPE("GameWorld::UpdateAnimators", Color3::orange);
+
+    // Each animator only writes its own joint matrices, so they can be computed in parallel.
+    // Transitions, events and root motion are processed before in ComAnimator::Update() serially.
+    jobSystem.ParallelFor(animatorsToUpdate.Count(), 1, [](void *data, int begin, int end) {
+        GameWorld *gameWorld = (GameWorld *)data;
+
+        for (int i = begin; i < end; i++) {
+            gameWorld->animatorsToUpdate[i]->UpdatePendingAnim(gameWorld->time);
+        }
+    }, this);
+
+    // Keep the memory for the next frame
+    animatorsToUpdate.SetCount(0, false);
+}
+
 void GameWorld::LateUpdateEntities() {
     // Call post-update function for each entities in depth-first order
     for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
+        if (scenes[sceneIndex].isLoading) {
+            continue;
+        }
+
         for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
             ent->LateUpdate();
         }
@@ -779,49 +1208,56 @@ void GameWorld::ProcessPointerInput() {
 }
 
 Entity *GameWorld::IntersectRay(const Ray &ray, int layerMask) const {
+    return IntersectRay(ray, layerMask, Array<Entity *>(), nullptr);
+}
+
+Entity *GameWorld::IntersectRay(const Ray &ray, int layerMask, const Array<Entity *> &excludingEntities, float *hitDist) const {
     Entity *minEntity = nullptr;
     float minDist = FLT_MAX;
 
-    for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
-        for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
-            if (!(BIT(ent->GetLayer()) & layerMask)) {
-                continue;
-            }
+    // Only renderable components can be hit by rays, so cast the ray against the render objects of them.
+    // The render objects are visited nearest first and the ray is clipped by the closest hit so far.
+    auto rayCastCallback = [&](const RenderObject *renderObject, float maxDist) -> float {
+        const ComRenderable *renderable = (const ComRenderable *)renderObject->GetState().userPointer;
+        if (!renderable) {
+            return maxDist;
+        }
 
-            if (ent->IntersectRay(ray, true, minDist)) {
-                minEntity = ent;
+        // The render object of a static batch has the combined mesh of all the renderers in the batch,
+        // so test each renderer with its own mesh to find the entity that is hit.
+        const StaticBatch *staticBatch = StaticBatch::GetStaticBatchByIndex(renderable->GetStaticBatchIndex());
+        if (staticBatch) {
+            Entity *entity = staticBatch->IntersectRay(ray, true, layerMask, excludingEntities, minDist);
+            if (entity) {
+                minEntity = entity;
             }
+            return Min(minDist, maxDist);
         }
-    }
 
-    return minEntity;
-}
+        Entity *entity = renderable->GetEntity();
 
-Entity *GameWorld::IntersectRay(const Ray &ray, int layerMask, const Array<Entity *> &excludingEntities, float *hitDist) const {
-    float minDist = FLT_MAX;
-    if (hitDist) {
-        *hitDist = minDist;
-    }
+        if (!(BIT(entity->GetLayer()) & layerMask)) {
+            return maxDist;
+        }
 
-    Entity *minEntity = nullptr;
+        if (excludingEntities.Find(entity)) {
+            return maxDist;
+        }
 
-    for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
-        for (Entity *ent = scenes[sceneIndex].root.GetChild(); ent; ent = ent->node.GetNext()) {
-            if (!(BIT(ent->GetLayer()) & layerMask)) {
-                continue;
-            }
+        float dist;
+        if (renderable->IntersectRay(ray, true, &dist) && dist < minDist) {
+            minDist = dist;
+            minEntity = entity;
+            return dist;
+        }
 
-            if (excludingEntities.Find(ent)) {
-                continue;
-            }
+        return maxDist;
+    };
 
-            if (ent->IntersectRay(ray, true, minDist)) {
-                minEntity = ent;
-                if (hitDist) {
-                    *hitDist = minDist;
-                }
-            }
-        }
+    renderWorld->RayCastRenderObjects(ray, FLT_MAX, rayCastCallback);
+
+    if (hitDist) {
+        *hitDist = minDist;
     }
 
     return minEntity;
@@ -0,0 +1,886 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Core/JobSystem.h"
+#include "File/FileSystem.h"
+#include "Render/Render.h"
+#include "Components/ComScript.h"
+#include "Game/Entity.h"
+#include "Game/MapRenderSettings.h"
+#include "Game/GameWorld.h"
+#include "BMap.h"
+
+BE_NAMESPACE_BEGIN
+
+static const int MinDecodeObjectsPerJob = 32;
+
+// Returns the size of the value in the property value blob, or 0 if the type can't be serialized.
+static int BinaryValueSize(Variant::Type::Enum type) {
+    switch (type) {
+    case Variant::Type::Int:
+    case Variant::Type::Bool:
+    case Variant::Type::Float:
+    case Variant::Type::Guid:
+    case Variant::Type::Str:
+        return sizeof(uint32_t);
+    case Variant::Type::Int64:
+        return sizeof(int64_t);
+    case Variant::Type::Vec2:
+        return sizeof(Vec2);
+    case Variant::Type::Vec3:
+        return sizeof(Vec3);
+    case Variant::Type::Vec4:
+        return sizeof(Vec4);
+    case Variant::Type::Color3:
+        return sizeof(Color3);
+    case Variant::Type::Color4:
+        return sizeof(Color4);
+    case Variant::Type::Mat2:
+        return sizeof(Mat2);
+    case Variant::Type::Mat3:
+        return sizeof(Mat3);
+    case Variant::Type::Mat3x4:
+        return sizeof(Mat3x4);
+    case Variant::Type::Mat4:
+        return sizeof(Mat4);
+    case Variant::Type::Angles:
+        return sizeof(Angles);
+    case Variant::Type::Quat:
+        return sizeof(Quat);
+    case Variant::Type::Point:
+        return sizeof(Point);
+    case Variant::Type::Rect:
+        return sizeof(Rect);
+    default:
+        break;
+    }
+    return 0;
+}
+
+// Gathers property infos which are serialized in the same order with Serializable::Deserialize().
+static void GetSerializedPropertyInfoList(const MetaObject *metaObject, Array<PropertyInfo> &propertyInfoList) {
+    Array<PropertyInfo> allPropertyInfoList;
+    metaObject->GetPropertyInfoList(allPropertyInfoList);
+
+    for (int propertyIndex = 0; propertyIndex < allPropertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = allPropertyInfoList[propertyIndex];
+
+        if (!(propertyInfo.GetFlags() & PropertyInfo::Flag::ReadOnly)) {
+            propertyInfoList.Append(propertyInfo);
+        }
+    }
+}
+
+static uint32_t AlignedSize(uint32_t size) {
+    return (size + 3) & ~3;
+}
+
+/*
+-------------------------------------------------------------------------------
+
+    Map cooker
+
+-------------------------------------------------------------------------------
+*/
+
+class BMapCooker {
+public:
+    BMapCooker();
+
+    int                         AddString(const char *string);
+    int                         AddGuid(const Guid &guid);
+    int                         AddClass(const MetaObject *metaObject);
+    int                         AddObject(const MetaObject *metaObject, const Json::Value &objectValue, bool hasGuid);
+
+    bool                        HasError() const { return hasError; }
+
+    bool                        Write(const char *filename, int mapVersion, uint32_t renderSettingsObject, const Array<BMapEntity> &entities) const;
+
+private:
+    template <typename T>
+    void                        WriteRaw(const T &value);
+    void                        WriteValue(Variant::Type::Enum type, const Variant &value);
+
+    Array<uint32_t>             stringOffsets;
+    Array<char>                 stringData;
+    HashTable<Str, int>         stringTable;
+    Array<Guid>                 guids;
+    HashTable<Guid, int>        guidTable;
+    Array<BMapClass>            classes;
+    Array<BMapProperty>         properties;
+    Array<Array<PropertyInfo>>  classPropertyInfos;
+    HashTable<Str, int>         classTable;
+    Array<BMapObject>           objects;
+    Array<byte>                 values;
+    bool                        hasError = false;
+};
+
+BMapCooker::BMapCooker() {
+    stringData.SetGranularity(4096);
+    values.SetGranularity(4096);
+}
+
+int BMapCooker::AddString(const char *string) {
+    int stringIndex;
+    if (stringTable.Get(string, &stringIndex)) {
+        return stringIndex;
+    }
+
+    stringIndex = stringOffsets.Append(stringData.Count());
+    stringTable.Set(string, stringIndex);
+
+    const int length = Str::Length(string) + 1;
+    const int offset = stringData.Count();
+    stringData.Reserve(offset + length);
+    stringData.SetCount(offset + length, false);
+    memcpy(stringData.Ptr() + offset, string, length);
+
+    return stringIndex;
+}
+
+int BMapCooker::AddGuid(const Guid &guid) {
+    int guidIndex;
+    if (guidTable.Get(guid, &guidIndex)) {
+        return guidIndex;
+    }
+
+    guidIndex = guids.Append(guid);
+    guidTable.Set(guid, guidIndex);
+
+    return guidIndex;
+}
+
+int BMapCooker::AddClass(const MetaObject *metaObject) {
+    int classIndex;
+    if (classTable.Get(metaObject->ClassName(), &classIndex)) {
+        return classIndex;
+    }
+
+    Array<PropertyInfo> &propertyInfoList = classPropertyInfos.Alloc();
+    GetSerializedPropertyInfoList(metaObject, propertyInfoList);
+
+    BMapClass bClass;
+    bClass.nameString = AddString(metaObject->ClassName());
+    bClass.firstProperty = properties.Count();
+    bClass.numProperties = propertyInfoList.Count();
+
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+
+        if (!BinaryValueSize(propertyInfo.GetType())) {
+            BE_WARNLOG("BMapCooker::AddClass: unsupported type of property '%s' in class '%s'\n", propertyInfo.GetName(), metaObject->ClassName());
+            hasError = true;
+        }
+
+        BMapProperty bProperty;
+        bProperty.nameString = AddString(propertyInfo.GetName());
+        bProperty.type = propertyInfo.GetType();
+        bProperty.isArray = (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) ? 1 : 0;
+        properties.Append(bProperty);
+    }
+
+    classIndex = classes.Append(bClass);
+    classTable.Set(metaObject->ClassName(), classIndex);
+
+    return classIndex;
+}
+
+int BMapCooker::AddObject(const MetaObject *metaObject, const Json::Value &objectValue, bool hasGuid) {
+    BMapObject bObject;
+    bObject.classIndex = AddClass(metaObject);
+    bObject.guidIndex = hasGuid ? AddGuid(Guid::FromString(objectValue.get("guid", Guid::zero.ToString()).asCString())) : BMAP_NULL_INDEX;
+    bObject.valueOffset = values.Count();
+    bObject.jsonString = BMAP_NULL_INDEX;
+
+    if (metaObject->IsTypeOf(ComScript::metaObject)) {
+        // Script component builds it's property list from the script while deserializing,
+        // so keep the JSON text and let it deserialize by itself.
+        Json::FastWriter jsonWriter;
+        bObject.jsonString = AddString(jsonWriter.write(objectValue).c_str());
+
+        return objects.Append(bObject);
+    }
+
+    const Array<PropertyInfo> &propertyInfoList = classPropertyInfos[bObject.classIndex];
+
+    // Same rules with Serializable::Deserialize()
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+        const char *name = propertyInfo.GetName();
+        const Variant::Type::Enum type = propertyInfo.GetType();
+        const Variant defaultValue = propertyInfo.GetDefaultValue();
+
+        if (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) {
+            const Json::Value subNode = objectValue.get(name, Json::Value());
+
+            WriteRaw<uint32_t>(subNode.size());
+
+            for (int elementIndex = 0; elementIndex < subNode.size(); elementIndex++) {
+                const Json::Value value = subNode.get(elementIndex, defaultValue.ToJsonValue());
+                WriteValue(type, Serializable::JsonValueToVariant(type, value, defaultValue));
+            }
+        } else {
+            const Json::Value value = objectValue.get(name, defaultValue.ToJsonValue());
+            WriteValue(type, Serializable::JsonValueToVariant(type, value, defaultValue));
+        }
+    }
+
+    return objects.Append(bObject);
+}
+
+template <typename T>
+BE_INLINE void BMapCooker::WriteRaw(const T &value) {
+    const int offset = values.Count();
+    values.Reserve(offset + sizeof(T));
+    values.SetCount(offset + sizeof(T), false);
+    memcpy(values.Ptr() + offset, &value, sizeof(T));
+}
+
+void BMapCooker::WriteValue(Variant::Type::Enum type, const Variant &value) {
+    switch (type) {
+    case Variant::Type::Int:
+        WriteRaw<int32_t>(value.As<int>());
+        break;
+    case Variant::Type::Int64:
+        WriteRaw<int64_t>(value.As<int64_t>());
+        break;
+    case Variant::Type::Bool:
+        WriteRaw<uint32_t>(value.As<bool>() ? 1 : 0);
+        break;
+    case Variant::Type::Float:
+        WriteRaw<float>(value.As<float>());
+        break;
+    case Variant::Type::Vec2:
+        WriteRaw<Vec2>(value.As<Vec2>());
+        break;
+    case Variant::Type::Vec3:
+        WriteRaw<Vec3>(value.As<Vec3>());
+        break;
+    case Variant::Type::Vec4:
+        WriteRaw<Vec4>(value.As<Vec4>());
+        break;
+    case Variant::Type::Color3:
+        WriteRaw<Color3>(value.As<Color3>());
+        break;
+    case Variant::Type::Color4:
+        WriteRaw<Color4>(value.As<Color4>());
+        break;
+    case Variant::Type::Mat2:
+        WriteRaw<Mat2>(value.As<Mat2>());
+        break;
+    case Variant::Type::Mat3:
+        WriteRaw<Mat3>(value.As<Mat3>());
+        break;
+    case Variant::Type::Mat3x4:
+        WriteRaw<Mat3x4>(value.As<Mat3x4>());
+        break;
+    case Variant::Type::Mat4:
+        WriteRaw<Mat4>(value.As<Mat4>());
+        break;
+    case Variant::Type::Angles:
+        WriteRaw<Angles>(value.As<Angles>());
+        break;
+    case Variant::Type::Quat:
+        WriteRaw<Quat>(value.As<Quat>());
+        break;
+    case Variant::Type::Point:
+        WriteRaw<Point>(value.As<Point>());
+        break;
+    case Variant::Type::Rect:
+        WriteRaw<Rect>(value.As<Rect>());
+        break;
+    case Variant::Type::Guid:
+        WriteRaw<uint32_t>(AddGuid(value.As<Guid>()));
+        break;
+    case Variant::Type::Str:
+        WriteRaw<uint32_t>(AddString(value.As<Str>()));
+        break;
+    default:
+        assert(0);
+        break;
+    }
+}
+
+bool BMapCooker::Write(const char *filename, int mapVersion, uint32_t renderSettingsObject, const Array<BMapEntity> &entities) const {
+    File *fp = fileSystem.OpenFile(filename, File::Mode::Write);
+    if (!fp) {
+        BE_WARNLOG("BMapCooker::Write: file open error\n");
+        return false;
+    }
+
+    const uint32_t stringsSize = sizeof(uint32_t) * stringOffsets.Count() + AlignedSize(stringData.Count());
+
+    BMapHeader bMapHeader;
+    bMapHeader.ident = BMAP_IDENT;
+    bMapHeader.version = BMAP_VERSION;
+    bMapHeader.mapVersion = mapVersion;
+    bMapHeader.renderSettingsObject = renderSettingsObject;
+    bMapHeader.numStrings = stringOffsets.Count();
+    bMapHeader.stringsOffset = sizeof(BMapHeader);
+    bMapHeader.numGuids = guids.Count();
+    bMapHeader.guidsOffset = bMapHeader.stringsOffset + stringsSize;
+    bMapHeader.numClasses = classes.Count();
+    bMapHeader.classesOffset = bMapHeader.guidsOffset + sizeof(Guid) * guids.Count();
+    bMapHeader.numProperties = properties.Count();
+    bMapHeader.propertiesOffset = bMapHeader.classesOffset + sizeof(BMapClass) * classes.Count();
+    bMapHeader.numObjects = objects.Count();
+    bMapHeader.objectsOffset = bMapHeader.propertiesOffset + sizeof(BMapProperty) * properties.Count();
+    bMapHeader.numEntities = entities.Count();
+    bMapHeader.entitiesOffset = bMapHeader.objectsOffset + sizeof(BMapObject) * objects.Count();
+    bMapHeader.valuesSize = values.Count();
+    bMapHeader.valuesOffset = bMapHeader.entitiesOffset + sizeof(BMapEntity) * entities.Count();
+    fp->Write(&bMapHeader, sizeof(bMapHeader));
+
+    // --- strings ---
+    fp->Write(stringOffsets.Ptr(), stringOffsets.MemoryUsed());
+    fp->Write(stringData.Ptr(), stringData.Count());
+
+    static const byte padding[4] = { 0, };
+    fp->Write(padding, AlignedSize(stringData.Count()) - stringData.Count());
+
+    // --- GUIDs ---
+    fp->Write(guids.Ptr(), guids.MemoryUsed());
+
+    // --- classes ---
+    fp->Write(classes.Ptr(), classes.MemoryUsed());
+    fp->Write(properties.Ptr(), properties.MemoryUsed());
+
+    // --- objects ---
+    fp->Write(objects.Ptr(), objects.MemoryUsed());
+    fp->Write(entities.Ptr(), entities.MemoryUsed());
+
+    // --- values ---
+    fp->Write(values.Ptr(), values.MemoryUsed());
+
+    fileSystem.CloseFile(fp);
+
+    return true;
+}
+
+bool GameWorld::CookMap(const char *filename, const char *cookedFilename) {
+    char *text = nullptr;
+    fileSystem.LoadFile(filename, true, (void **)&text);
+    if (!text) {
+        BE_WARNLOG("Couldn't load '%s'\n", filename);
+        return false;
+    }
+
+    Json::Value map;
+    Json::Reader jsonReader;
+    bool parsed = jsonReader.parse(text, map);
+
+    fileSystem.FreeFile(text);
+
+    if (!parsed) {
+        BE_WARNLOG("Failed to parse JSON text\n");
+        return false;
+    }
+
+    BE_LOG("Cooking map '%s'...\n", filename);
+
+    BMapCooker cooker;
+
+    uint32_t renderSettingsObject = cooker.AddObject(&MapRenderSettings::metaObject, map["renderSettings"], false);
+
+    const Json::Value &entitiesValue = map["entities"];
+
+    Array<BMapEntity> entities;
+
+    for (int entityIndex = 0; entityIndex < entitiesValue.size(); entityIndex++) {
+        const Json::Value &entityValue = entitiesValue[entityIndex];
+
+        // Same rules with SpawnEntityFromJson() and Entity::Deserialize()
+        const char *classname = entityValue["classname"].asCString();
+        if (Str::Cmp(classname, Entity::metaObject.ClassName()) != 0) {
+            BE_WARNLOG("GameWorld::CookMap: Bad classname '%s' for entity\n", classname);
+            continue;
+        }
+
+        BMapEntity &bEntity = entities.Alloc();
+        bEntity.objectIndex = cooker.AddObject(&Entity::metaObject, entityValue, true);
+        bEntity.numComponents = 0;
+        bEntity.spawnEntityNum = entityValue.get("spawn_entnum", -1).asInt();
+
+        const Json::Value &componentsValue = entityValue["components"];
+
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            const Json::Value &componentValue = componentsValue[componentIndex];
+
+            const char *componentClassname = componentValue["classname"].asCString();
+            const MetaObject *metaComponent = Object::FindMetaObject(componentClassname);
+
+            if (!metaComponent) {
+                BE_WARNLOG("Unknown component class '%s'\n", componentClassname);
+                continue;
+            }
+            if (!metaComponent->IsTypeOf(Component::metaObject)) {
+                BE_WARNLOG("'%s' is not a component class\n", componentClassname);
+                continue;
+            }
+
+            cooker.AddObject(metaComponent, componentValue, true);
+
+            bEntity.numComponents++;
+        }
+    }
+
+    if (cooker.HasError()) {
+        BE_WARNLOG("Failed to cook map '%s'\n", filename);
+        return false;
+    }
+
+    return cooker.Write(cookedFilename, map["version"].asInt(), renderSettingsObject, entities);
+}
+
+/*
+-------------------------------------------------------------------------------
+
+    Map loader
+
+-------------------------------------------------------------------------------
+*/
+
+// Reads a value from the value blob. Returns false instead of reading past the end of the blob.
+template <typename T>
+static BE_INLINE bool ReadRaw(const byte *&ptr, const byte *end, T &value) {
+    if (end - ptr < (ptrdiff_t)sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return true;
+}
+
+template <typename T>
+static BE_INLINE bool ReadRawValue(const byte *&ptr, const byte *end, Variant &value) {
+    T rawValue;
+    if (!ReadRaw(ptr, end, rawValue)) {
+        return false;
+    }
+    value = rawValue;
+    return true;
+}
+
+static bool ReadValue(const BMapReader &reader, Variant::Type::Enum type, const byte *&ptr, const byte *end, Variant &value) {
+    uint32_t index;
+
+    switch (type) {
+    case Variant::Type::Int: {
+        int32_t intValue;
+        if (!ReadRaw(ptr, end, intValue)) {
+            return false;
+        }
+        value = (int)intValue;
+        return true;
+    }
+    case Variant::Type::Int64:
+        return ReadRawValue<int64_t>(ptr, end, value);
+    case Variant::Type::Bool: {
+        uint32_t boolValue;
+        if (!ReadRaw(ptr, end, boolValue)) {
+            return false;
+        }
+        value = boolValue ? true : false;
+        return true;
+    }
+    case Variant::Type::Float:
+        return ReadRawValue<float>(ptr, end, value);
+    case Variant::Type::Vec2:
+        return ReadRawValue<Vec2>(ptr, end, value);
+    case Variant::Type::Vec3:
+        return ReadRawValue<Vec3>(ptr, end, value);
+    case Variant::Type::Vec4:
+        return ReadRawValue<Vec4>(ptr, end, value);
+    case Variant::Type::Color3:
+        return ReadRawValue<Color3>(ptr, end, value);
+    case Variant::Type::Color4:
+        return ReadRawValue<Color4>(ptr, end, value);
+    case Variant::Type::Mat2:
+        return ReadRawValue<Mat2>(ptr, end, value);
+    case Variant::Type::Mat3:
+        return ReadRawValue<Mat3>(ptr, end, value);
+    case Variant::Type::Mat3x4:
+        return ReadRawValue<Mat3x4>(ptr, end, value);
+    case Variant::Type::Mat4:
+        return ReadRawValue<Mat4>(ptr, end, value);
+    case Variant::Type::Angles:
+        return ReadRawValue<Angles>(ptr, end, value);
+    case Variant::Type::Quat:
+        return ReadRawValue<Quat>(ptr, end, value);
+    case Variant::Type::Point:
+        return ReadRawValue<Point>(ptr, end, value);
+    case Variant::Type::Rect:
+        return ReadRawValue<Rect>(ptr, end, value);
+    case Variant::Type::Guid:
+        if (!ReadRaw(ptr, end, index) || index >= reader.header->numGuids) {
+            return false;
+        }
+        value = reader.guids[index];
+        return true;
+    case Variant::Type::Str:
+        if (!ReadRaw(ptr, end, index) || index >= reader.header->numStrings) {
+            return false;
+        }
+        value = Str(reader.GetString(index));
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+static bool DecodeObject(const BMapReader &reader, int objectIndex, BMapDecodedObject &decodedObject) {
+    const BMapObject &bObject = reader.objects[objectIndex];
+
+    if (bObject.jsonString != BMAP_NULL_INDEX) {
+        Json::Reader jsonReader;
+        return jsonReader.parse(reader.GetString(bObject.jsonString), decodedObject.deserializeValue);
+    }
+
+    const Array<PropertyInfo> &propertyInfoList = reader.classes[bObject.classIndex].propertyInfoList;
+    const byte *ptr = reader.values + bObject.valueOffset;
+    const byte *end = reader.values + reader.header->valuesSize;
+
+    decodedObject.arrayCounts.SetCount(propertyInfoList.Count());
+    decodedObject.values.Reserve(propertyInfoList.Count());
+
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+        const Variant::Type::Enum type = propertyInfo.GetType();
+
+        if (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) {
+            uint32_t numElements;
+            // Every element takes at least 4 bytes, so the count can be checked before decoding the elements
+            if (!ReadRaw(ptr, end, numElements) || numElements > (uint32_t)(end - ptr) / sizeof(uint32_t)) {
+                return false;
+            }
+
+            decodedObject.arrayCounts[propertyIndex] = (int)numElements;
+
+            for (uint32_t elementIndex = 0; elementIndex < numElements; elementIndex++) {
+                if (!ReadValue(reader, type, ptr, end, decodedObject.values.Alloc())) {
+                    return false;
+                }
+            }
+        } else {
+            decodedObject.arrayCounts[propertyIndex] = -1;
+
+            if (!ReadValue(reader, type, ptr, end, decodedObject.values.Alloc())) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static void ApplyDecodedObject(Serializable *object, const Array<PropertyInfo> &propertyInfoList, const BMapDecodedObject &decodedObject) {
+    int valueIndex = 0;
+
+    for (int propertyIndex = 0; propertyIndex < propertyInfoList.Count(); propertyIndex++) {
+        const PropertyInfo &propertyInfo = propertyInfoList[propertyIndex];
+        const int numElements = decodedObject.arrayCounts[propertyIndex];
+
+        if (numElements < 0) {
+            object->SetProperty(propertyInfo, decodedObject.values[valueIndex++]);
+        } else {
+            object->SetPropertyArrayCount(propertyInfo, numElements);
+
+            for (int elementIndex = 0; elementIndex < numElements; elementIndex++) {
+                object->SetArrayProperty(propertyInfo, elementIndex, decodedObject.values[valueIndex++]);
+            }
+        }
+    }
+}
+
+// Validates the tables and binds the class schema of the file to the current property infos.
+// Nothing is created in the game world if this fails.
+static bool PrepareReader(const byte *data, size_t size, BMapReader &reader) {
+    if (size < sizeof(BMapHeader)) {
+        return false;
+    }
+
+    const BMapHeader *bMapHeader = (const BMapHeader *)data;
+    if (bMapHeader->ident != BMAP_IDENT || bMapHeader->version != BMAP_VERSION) {
+        return false;
+    }
+
+    auto checkSection = [size](uint32_t offset, uint64_t sectionSize) {
+        return (uint64_t)offset + sectionSize <= (uint64_t)size;
+    };
+
+    if (!checkSection(bMapHeader->stringsOffset, (uint64_t)sizeof(uint32_t) * bMapHeader->numStrings) ||
+        !checkSection(bMapHeader->guidsOffset, (uint64_t)sizeof(Guid) * bMapHeader->numGuids) ||
+        !checkSection(bMapHeader->classesOffset, (uint64_t)sizeof(BMapClass) * bMapHeader->numClasses) ||
+        !checkSection(bMapHeader->propertiesOffset, (uint64_t)sizeof(BMapProperty) * bMapHeader->numProperties) ||
+        !checkSection(bMapHeader->objectsOffset, (uint64_t)sizeof(BMapObject) * bMapHeader->numObjects) ||
+        !checkSection(bMapHeader->entitiesOffset, (uint64_t)sizeof(BMapEntity) * bMapHeader->numEntities) ||
+        !checkSection(bMapHeader->valuesOffset, bMapHeader->valuesSize) ||
+        bMapHeader->renderSettingsObject >= bMapHeader->numObjects) {
+        return false;
+    }
+
+    reader.header = bMapHeader;
+    reader.stringOffsets = (const uint32_t *)(data + bMapHeader->stringsOffset);
+    reader.stringData = (const char *)(reader.stringOffsets + bMapHeader->numStrings);
+    reader.guids = (const Guid *)(data + bMapHeader->guidsOffset);
+    reader.objects = (const BMapObject *)(data + bMapHeader->objectsOffset);
+    reader.entities = (const BMapEntity *)(data + bMapHeader->entitiesOffset);
+    reader.values = data + bMapHeader->valuesOffset;
+
+    // String characters fill the space up to the GUIDs, so every string should be terminated in that space
+    const uint64_t stringDataOffset = (uint64_t)bMapHeader->stringsOffset + sizeof(uint32_t) * bMapHeader->numStrings;
+    if (stringDataOffset > bMapHeader->guidsOffset) {
+        return false;
+    }
+
+    const uint32_t stringDataSize = bMapHeader->guidsOffset - (uint32_t)stringDataOffset;
+    if (bMapHeader->numStrings > 0 && (stringDataSize == 0 || reader.stringData[stringDataSize - 1] != '\0')) {
+        return false;
+    }
+
+    for (int stringIndex = 0; stringIndex < bMapHeader->numStrings; stringIndex++) {
+        if (reader.stringOffsets[stringIndex] >= stringDataSize) {
+            return false;
+        }
+    }
+
+    for (int objectIndex = 0; objectIndex < bMapHeader->numObjects; objectIndex++) {
+        const BMapObject &bObject = reader.objects[objectIndex];
+
+        if (bObject.classIndex >= bMapHeader->numClasses || bObject.valueOffset > bMapHeader->valuesSize ||
+            (bObject.guidIndex != BMAP_NULL_INDEX && bObject.guidIndex >= bMapHeader->numGuids) ||
+            (bObject.jsonString != BMAP_NULL_INDEX && bObject.jsonString >= bMapHeader->numStrings)) {
+            return false;
+        }
+    }
+
+    const BMapClass *bClasses = (const BMapClass *)(data + bMapHeader->classesOffset);
+    const BMapProperty *bProperties = (const BMapProperty *)(data + bMapHeader->propertiesOffset);
+
+    reader.classes.SetCount(bMapHeader->numClasses);
+
+    for (int classIndex = 0; classIndex < bMapHeader->numClasses; classIndex++) {
+        const BMapClass &bClass = bClasses[classIndex];
+        if (bClass.nameString >= bMapHeader->numStrings || (uint64_t)bClass.firstProperty + bClass.numProperties > bMapHeader->numProperties) {
+            return false;
+        }
+
+        const char *classname = reader.GetString(bClass.nameString);
+
+        BMapLoadClass &loadClass = reader.classes[classIndex];
+        loadClass.metaObject = Object::FindMetaObject(classname);
+
+        if (!loadClass.metaObject) {
+            BE_WARNLOG("Unknown class '%s' in cooked map\n", classname);
+            return false;
+        }
+
+        GetSerializedPropertyInfoList(loadClass.metaObject, loadClass.propertyInfoList);
+
+        // Property layout of the class should not be changed after cooking
+        if (loadClass.propertyInfoList.Count() != bClass.numProperties) {
+            BE_WARNLOG("Property layout of class '%s' has been changed since the map was cooked\n", classname);
+            return false;
+        }
+
+        for (int propertyIndex = 0; propertyIndex < bClass.numProperties; propertyIndex++) {
+            const BMapProperty &bProperty = bProperties[bClass.firstProperty + propertyIndex];
+            if (bProperty.nameString >= bMapHeader->numStrings) {
+                return false;
+            }
+
+            const PropertyInfo &propertyInfo = loadClass.propertyInfoList[propertyIndex];
+            const bool isArray = (propertyInfo.GetFlags() & PropertyInfo::Flag::Array) ? true : false;
+
+            if (Str::Cmp(propertyInfo.GetName(), reader.GetString(bProperty.nameString)) != 0 ||
+                propertyInfo.GetType() != bProperty.type || isArray != (bProperty.isArray != 0)) {
+                BE_WARNLOG("Property layout of class '%s' has been changed since the map was cooked\n", classname);
+                return false;
+            }
+        }
+    }
+
+    // Objects are created by the class of the file, so the classes should be the expected types
+    if (reader.classes[reader.objects[bMapHeader->renderSettingsObject].classIndex].metaObject != &MapRenderSettings::metaObject) {
+        return false;
+    }
+
+    for (int entityIndex = 0; entityIndex < bMapHeader->numEntities; entityIndex++) {
+        const BMapEntity &bEntity = reader.entities[entityIndex];
+
+        if ((uint64_t)bEntity.objectIndex + bEntity.numComponents >= bMapHeader->numObjects) {
+            return false;
+        }
+
+        for (uint32_t objectIndex = bEntity.objectIndex; objectIndex <= bEntity.objectIndex + bEntity.numComponents; objectIndex++) {
+            const BMapObject &bObject = reader.objects[objectIndex];
+            const MetaObject *metaObject = reader.classes[bObject.classIndex].metaObject;
+
+            if (bObject.guidIndex == BMAP_NULL_INDEX) {
+                return false;
+            }
+            if (objectIndex == bEntity.objectIndex ? metaObject != &Entity::metaObject : !metaObject->IsTypeOf(Component::metaObject)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool BMapReader::Open(const char *filename) {
+    Close();
+
+    // Map the file to memory if it is on the disk, otherwise read it through the search paths
+    const byte *mapData;
+    size_t size;
+
+    if (fileSystem.FileExists(filename)) {
+        fileMapping = PlatformFileMapping::OpenFileRead(filename);
+    }
+
+    if (fileMapping) {
+        mapData = (const byte *)fileMapping->GetData();
+        size = fileMapping->GetSize();
+    } else {
+        size = fileSystem.LoadFile(filename, true, (void **)&fileData);
+        if (!fileData) {
+            return false;
+        }
+        mapData = fileData;
+    }
+
+    if (!PrepareReader(mapData, size, *this)) {
+        BE_WARNLOG("BMapReader::Open: bad format %s\n", filename);
+        Close();
+        return false;
+    }
+
+    // Decode property values of all objects in parallel
+    // Asynchronous map loading calls this from a non-worker thread, which only waits for the workers to decode
+    decodedObjects.SetCount(header->numObjects);
+
+    jobSystem.ParallelFor(header->numObjects, MinDecodeObjectsPerJob, [](void *data, int begin, int end) {
+        BMapReader *reader = (BMapReader *)data;
+
+        for (int objectIndex = begin; objectIndex < end; objectIndex++) {
+            BMapDecodedObject &decodedObject = reader->decodedObjects[objectIndex];
+            decodedObject.decoded = DecodeObject(*reader, objectIndex, decodedObject);
+        }
+    }, this);
+
+    for (int objectIndex = 0; objectIndex < decodedObjects.Count(); objectIndex++) {
+        if (!decodedObjects[objectIndex].decoded) {
+            BE_WARNLOG("BMapReader::Open: bad object %i in %s\n", objectIndex, filename);
+            Close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BMapReader::Close() {
+    if (fileMapping) {
+        delete fileMapping;
+        fileMapping = nullptr;
+    }
+    if (fileData) {
+        fileSystem.FreeFile(fileData);
+        fileData = nullptr;
+    }
+
+    header = nullptr;
+    classes.Clear();
+    decodedObjects.Clear();
+}
+
+void BMapReader::ReadObject(int objectIndex, Serializable *object) const {
+    const BMapObject &bObject = objects[objectIndex];
+
+    if (bObject.jsonString != BMAP_NULL_INDEX) {
+        object->Deserialize(decodedObjects[objectIndex].deserializeValue);
+    } else {
+        ApplyDecodedObject(object, classes[bObject.classIndex].propertyInfoList, decodedObjects[objectIndex]);
+    }
+}
+
+void BMapReader::ReadRenderSettings(MapRenderSettings *mapRenderSettings) const {
+    ReadObject(header->renderSettingsObject, mapRenderSettings);
+}
+
+// Same as SpawnEntityFromJson()
+Entity *GameWorld::SpawnEntityFromBinaryMap(const BMapReader &reader, int entityIndex, int sceneIndex) {
+    const BMapEntity &bEntity = reader.entities[entityIndex];
+    const BMapObject &bEntityObject = reader.objects[bEntity.objectIndex];
+
+    Guid entityGuid = reader.guids[bEntityObject.guidIndex];
+    if (entityGuid.IsZero()) {
+        entityGuid = Guid::CreateGuid();
+    }
+
+    Entity *entity = static_cast<Entity *>(Entity::metaObject.CreateInstance(entityGuid));
+
+    entity->gameWorld = this;
+    entity->sceneIndex = sceneIndex;
+
+    reader.ReadObject(bEntity.objectIndex, entity);
+
+    for (int componentIndex = 0; componentIndex < bEntity.numComponents; componentIndex++) {
+        const int objectIndex = bEntity.objectIndex + 1 + componentIndex;
+        const BMapObject &bComponentObject = reader.objects[objectIndex];
+        const BMapLoadClass &componentClass = reader.classes[bComponentObject.classIndex];
+
+        Guid componentGuid = reader.guids[bComponentObject.guidIndex];
+        if (componentGuid.IsZero()) {
+            componentGuid = Guid::CreateGuid();
+        }
+
+        Component *component = static_cast<Component *>(componentClass.metaObject->CreateInstance(componentGuid));
+        component->SetEntity(entity);
+
+        reader.ReadObject(objectIndex, component);
+
+        entity->AddComponent(component);
+    }
+
+    entity->Init();
+    entity->InitComponents();
+
+    RegisterEntity(entity, bEntity.spawnEntityNum);
+
+    return entity;
+}
+
+bool GameWorld::LoadBinaryMap(const char *filename, int sceneIndex) {
+    BMapReader reader;
+    if (!reader.Open(filename)) {
+        return false;
+    }
+
+    // Read map render settings
+    reader.ReadRenderSettings(mapRenderSettings);
+    mapRenderSettings->Init();
+
+    // Create and register entities serially in order
+    for (int entityIndex = 0; entityIndex < reader.NumEntities(); entityIndex++) {
+        SpawnEntityFromBinaryMap(reader, entityIndex, sceneIndex);
+    }
+
+    return true;
+}
+
+BE_NAMESPACE_END
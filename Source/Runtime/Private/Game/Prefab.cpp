@@ -16,18 +16,35 @@
 #include "Game/Entity.h"
 #include "Game/Prefab.h"
 #include "Game/GameWorld.h"
+#include "Components/Component.h"
+#include "Core/CVars.h"
 #include "File/FileSystem.h"
 
 BE_NAMESPACE_BEGIN
 
+static CVAR(g_verifyPrefabTemplate, "1", CVar::Flag::Bool, "Verify compiled prefab template against cloning through JSON serialization, and fall back to JSON cloning if it doesn't match");
+
 OBJECT_DECLARATION("Prefab", Prefab, Object)
 BEGIN_EVENTS(Prefab)
 END_EVENTS
 
+const SignalDef Prefab::SIG_Cleared("Prefab::Cleared", "a");
+
 void Prefab::RegisterProperties() {
 }
 
 void Prefab::Clear() {
+    // Pooled instances of the game worlds can't be reset by the new template
+    EmitSignal(&SIG_Cleared, this);
+
+    instantiationTemplate.Clear();
+    instantiationTemplateInvalidated = true;
+    instantiationTemplateVerified = false;
+
+    if (GetRootEntity()) {
+        prefabManager.rootEntityGuidToPrefabMap.Remove(GetRootEntity()->GetGuid());
+    }
+
     entityHierarchy.RemoveFromHierarchy();
 
     for (int entityIndex = 0; entityIndex < entities.Count(); entityIndex++) {
@@ -64,9 +81,81 @@ bool Prefab::Create(const Json::Value &entitiesValue) {
         }
     }
 
+    // Template is compiled lazily on first instantiation
+    if (GetRootEntity()) {
+        prefabManager.rootEntityGuidToPrefabMap.Set(GetRootEntity()->GetGuid(), this);
+    }
+
     return true;
 }
 
+const EntityTemplate *Prefab::GetInstantiationTemplate() {
+    Entity *rootEntity = GetRootEntity();
+    if (!rootEntity) {
+        return nullptr;
+    }
+
+    if (!instantiationTemplateInvalidated) {
+        // Structural changes of the prefab entities are not notified by the property signals
+        EntityPtrArray hierarchyEntities;
+        hierarchyEntities.Append(rootEntity);
+        rootEntity->GetChildren(hierarchyEntities);
+
+        if (!instantiationTemplate.Matches(hierarchyEntities)) {
+            instantiationTemplateInvalidated = true;
+        }
+    }
+
+    if (instantiationTemplateInvalidated) {
+        CompileInstantiationTemplate();
+    }
+
+    return instantiationTemplateVerified ? &instantiationTemplate : nullptr;
+}
+
+void Prefab::CompileInstantiationTemplate() {
+    Entity *rootEntity = GetRootEntity();
+
+    instantiationTemplate.Compile(rootEntity);
+    instantiationTemplateInvalidated = false;
+    instantiationTemplateVerified = true;
+
+    if (g_verifyPrefabTemplate.GetBool()) {
+        if (!PrefabManager::VerifyInstantiationTemplate(rootEntity, instantiationTemplate, prefabManager.GetPrefabWorld())) {
+            BE_WARNLOG("Prefab '%s' template instance doesn't match JSON instance\n", hashName.c_str());
+            instantiationTemplateVerified = false;
+        }
+    }
+
+    // Connect to all of the prefab entities and components to be notified of the property changes.
+    // Newly added ones are connected when the structural change is detected.
+    EntityPtrArray hierarchyEntities;
+    hierarchyEntities.Append(rootEntity);
+    rootEntity->GetChildren(hierarchyEntities);
+
+    for (int entityIndex = 0; entityIndex < hierarchyEntities.Count(); entityIndex++) {
+        Entity *entity = hierarchyEntities[entityIndex];
+
+        entity->Connect(&Serializable::SIG_PropertyChanged, this, (SignalCallback)&Prefab::PropertyChanged, SignalObject::ConnectionType::Unique);
+        entity->Connect(&Serializable::SIG_PropertyArrayCountChanged, this, (SignalCallback)&Prefab::PropertyArrayCountChanged, SignalObject::ConnectionType::Unique);
+
+        for (int componentIndex = 0; componentIndex < entity->NumComponents(); componentIndex++) {
+            Component *component = entity->GetComponent(componentIndex);
+
+            component->Connect(&Serializable::SIG_PropertyChanged, this, (SignalCallback)&Prefab::PropertyChanged, SignalObject::ConnectionType::Unique);
+            component->Connect(&Serializable::SIG_PropertyArrayCountChanged, this, (SignalCallback)&Prefab::PropertyArrayCountChanged, SignalObject::ConnectionType::Unique);
+        }
+    }
+}
+
+void Prefab::PropertyChanged(const char *propName, int index) {
+    instantiationTemplateInvalidated = true;
+}
+
+void Prefab::PropertyArrayCountChanged(const char *propName) {
+    instantiationTemplateInvalidated = true;
+}
+
 bool Prefab::Load(const char *filename) {
     char *text = nullptr;
 
@@ -101,6 +190,9 @@ void Prefab::Write(const char *filename) {
     Str jsonText = jsonWriter.write(entitiesValue).c_str();
 
     fileSystem.WriteFile(filename, jsonText.c_str(), jsonText.Length());
+
+    // Prefab entities might be modified without notification before being written
+    instantiationTemplateInvalidated = true;
 }
 
 bool Prefab::Reload() {
@@ -17,6 +17,8 @@
 #include "Game/Prefab.h"
 #include "Game/GameWorld.h"
 #include "Asset/GuidMapper.h"
+#include "Core/Cmds.h"
+#include "Platform/PlatformTime.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -28,10 +30,14 @@ void PrefabManager::Init() {
     }
 
     prefabHashMap.Init(1024, 64, 64);
+    rootEntityGuidToPrefabMap.Init(1024, 64, 64);
 
     prefabWorld = (GameWorld *)GameWorld::CreateInstance();
     prefabWorld->GetLuaVM().InitEngineModule(prefabWorld);
 
+    cmdSystem.AddCommand("listPrefabs", Cmd_ListPrefabs);
+    cmdSystem.AddCommand("benchPrefab", Cmd_BenchPrefab);
+
     initialized = true;
 }
 
@@ -40,6 +46,9 @@ void PrefabManager::Shutdown() {
         return;
     }
 
+    cmdSystem.RemoveCommand("listPrefabs");
+    cmdSystem.RemoveCommand("benchPrefab");
+
     for (int i = 0; i < prefabHashMap.Count(); i++) {
         const auto *entry = prefabHashMap.GetByIndex(i);
         Prefab *prefab = entry->second;
@@ -53,6 +62,7 @@ void PrefabManager::Shutdown() {
     }
 
     prefabHashMap.Clear();
+    rootEntityGuidToPrefabMap.Clear();
 
     initialized = false;
 }
@@ -66,6 +76,15 @@ Prefab *PrefabManager::FindPrefab(const char *hashName) const {
     return nullptr;
 }
 
+Prefab *PrefabManager::FindPrefabByRootEntity(const Entity *rootEntity) const {
+    const auto *entry = rootEntityGuidToPrefabMap.Get(rootEntity->GetGuid());
+    if (entry && entry->second->GetRootEntity() == rootEntity) {
+        return entry->second;
+    }
+
+    return nullptr;
+}
+
 Prefab *PrefabManager::AllocPrefab(const char *hashName, const Guid &guid) {
     if (prefabHashMap.Get(hashName)) {
         BE_FATALERROR("%s prefab already allocated", hashName);
@@ -163,4 +182,153 @@ Json::Value PrefabManager::CreatePrefabValue(const Entity *originalEntity) {
     return prefabEntitiesValue;
 }
 
-BE_NAMESPACE_END
\ No newline at end of file
+void PrefabManager::Cmd_ListPrefabs(const CmdArgs &args) {
+    int numPooled = 0;
+
+    for (int i = 0; i < prefabManager.prefabHashMap.Count(); i++) {
+        const auto *entry = prefabManager.prefabHashMap.GetByIndex(i);
+        Prefab *prefab = entry->second;
+
+        const EntityTemplate *entityTemplate = prefab->GetInstantiationTemplate();
+
+        BE_LOG("%3i entities: %s%s\n", prefab->entities.Count(), prefab->GetFileName().c_str(), entityTemplate ? "" : " (JSON cloning)");
+
+        if (prefab->GetPoolCapacity() > 0) {
+            const Prefab::PoolStats &poolStats = prefab->GetPoolStats();
+            const float hitRate = poolStats.numSpawns > 0 ? 100.0f * poolStats.numHits / poolStats.numSpawns : 0.0f;
+
+            BE_LOG("    pool capacity %i, %i spawns, %i hits (%.1f%%), %i recycles, %i discards\n", 
+                prefab->GetPoolCapacity(), poolStats.numSpawns, poolStats.numHits, hitRate, poolStats.numRecycles, poolStats.numDiscards);
+
+            numPooled++;
+        }
+    }
+
+    BE_LOG("total %i prefabs, %i pooled\n", prefabManager.prefabHashMap.Count(), numPooled);
+}
+
+static void DestroyEntityHierarchies(EntityPtrArray &rootEntities) {
+    for (int i = 0; i < rootEntities.Count(); i++) {
+        EntityPtrArray children;
+        rootEntities[i]->GetChildren(children);
+
+        for (int j = children.Count() - 1; j >= 0; j--) {
+            Entity::DestroyInstanceImmediate(children[j]);
+        }
+
+        Entity::DestroyInstanceImmediate(rootEntities[i]);
+    }
+
+    rootEntities.Clear();
+}
+
+// Replaces GUID strings of entities/components to it's serialization order, 
+// so that hierarchies instantiated from the same source can be compared.
+static void ReplaceGuidStrings(Json::Value &value, const StrHashMap<int> &guidOrderMap) {
+    if (value.isString()) {
+        const auto *entry = guidOrderMap.Get(value.asCString());
+        if (entry) {
+            value = entry->second;
+        }
+    } else if (value.isArray() || value.isObject()) {
+        for (auto it = value.begin(); it != value.end(); ++it) {
+            ReplaceGuidStrings(*it, guidOrderMap);
+        }
+    }
+}
+
+static Json::Value SerializeNormalizedHierarchy(const Entity *rootEntity) {
+    Json::Value entitiesValue;
+    Entity::SerializeHierarchy(rootEntity, entitiesValue);
+
+    StrHashMap<int> guidOrderMap;
+
+    for (int entityIndex = 0; entityIndex < entitiesValue.size(); entityIndex++) {
+        const Json::Value &entityValue = entitiesValue[entityIndex];
+        guidOrderMap.Set(entityValue["guid"].asCString(), guidOrderMap.Count());
+
+        const Json::Value &componentsValue = entityValue["components"];
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            guidOrderMap.Set(componentsValue[componentIndex]["guid"].asCString(), guidOrderMap.Count());
+        }
+    }
+
+    ReplaceGuidStrings(entitiesValue, guidOrderMap);
+
+    return entitiesValue;
+}
+
+bool PrefabManager::VerifyInstantiationTemplate(const Entity *rootEntity, const EntityTemplate &entityTemplate, GameWorld *gameWorld) {
+    EntityPtrArray instances;
+
+    instances.Append(gameWorld->CloneEntityFromJson(rootEntity));
+    Json::Value jsonResultValue = SerializeNormalizedHierarchy(instances[0]);
+    DestroyEntityHierarchies(instances);
+
+    instances.Append(entityTemplate.Instantiate(gameWorld));
+    Json::Value templateResultValue = SerializeNormalizedHierarchy(instances[0]);
+    DestroyEntityHierarchies(instances);
+
+    return templateResultValue == jsonResultValue;
+}
+
+void PrefabManager::Cmd_BenchPrefab(const CmdArgs &args) {
+    if (args.Argc() < 2) {
+        BE_LOG("benchPrefab <filename> [count]\n");
+        return;
+    }
+
+    Prefab *prefab = prefabManager.GetPrefab(args.Argv(1));
+    if (!prefab || !prefab->GetRootEntity()) {
+        return;
+    }
+
+    const Entity *rootEntity = prefab->GetRootEntity();
+    const int count = args.Argc() > 2 ? Max(atoi(args.Argv(2)), 1) : 10000;
+
+    // Template might be unverified, bench it anyway
+    prefab->GetInstantiationTemplate();
+    const EntityTemplate &entityTemplate = prefab->instantiationTemplate;
+
+    GameWorld *benchWorld = (GameWorld *)GameWorld::CreateInstance();
+    benchWorld->GetLuaVM().InitEngineModule(benchWorld);
+
+    EntityPtrArray instances;
+    instances.Reserve(count);
+
+    // Instantiate through JSON serialization
+    uint64_t startTime = PlatformTime::Microseconds();
+
+    for (int i = 0; i < count; i++) {
+        instances.Append(benchWorld->CloneEntityFromJson(rootEntity));
+    }
+
+    uint64_t jsonTime = PlatformTime::Microseconds() - startTime;
+
+    DestroyEntityHierarchies(instances);
+
+    // Instantiate from compiled template
+    startTime = PlatformTime::Microseconds();
+
+    for (int i = 0; i < count; i++) {
+        instances.Append(entityTemplate.Instantiate(benchWorld));
+    }
+
+    uint64_t templateTime = PlatformTime::Microseconds() - startTime;
+
+    DestroyEntityHierarchies(instances);
+
+    bool matches = VerifyInstantiationTemplate(rootEntity, entityTemplate, benchWorld);
+
+    GameWorld::DestroyInstanceImmediate(benchWorld);
+
+    BE_LOG("%i instances of '%s' (%i entities)\n", count, prefab->GetName(), entityTemplate.NumEntities());
+    BE_LOG("JSON: %.2f ms (%.2f us per instance)\n", jsonTime / 1000.0f, (float)jsonTime / count);
+    BE_LOG("template: %.2f ms (%.2f us per instance)\n", templateTime / 1000.0f, (float)templateTime / count);
+
+    if (!matches) {
+        BE_WARNLOG("template instance doesn't match JSON instance\n");
+    }
+}
+
+BE_NAMESPACE_END
@@ -17,6 +17,9 @@
 #include "Math/Math.h"
 #include "Image/DxtEncoder.h"
 #include "Eigen/Eigen/Dense"
+#if defined(__X86__)
+#include <emmintrin.h>
+#endif
 
 BE_NAMESPACE_BEGIN
 
@@ -962,4 +965,406 @@ void DXTEncoder::CompressImageDXN2HQ(const byte *src, const int width, const int
     }
 }
 
+//--------------------------------------------------------------------------------
+//
+// SIMD fast compression
+//
+// Each 4x4 block is loaded into four SSE registers and the bounding box,
+// the color distances and the alpha thresholds of all 16 pixels are computed at once.
+// The results are identical with the scalar fast compression.
+//
+//--------------------------------------------------------------------------------
+
+#if defined(__X86__)
+
+// Spreads the lower 16 bits to the even bits.
+static BE_FORCE_INLINE uint32_t Part1By1(uint32_t x) {
+    x &= 0x0000FFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+static BE_FORCE_INLINE void LoadBlockSSE(const byte *src, int srcPitch, __m128i *rows) {
+    rows[0] = _mm_loadu_si128((const __m128i *)(src + srcPitch * 0));
+    rows[1] = _mm_loadu_si128((const __m128i *)(src + srcPitch * 1));
+    rows[2] = _mm_loadu_si128((const __m128i *)(src + srcPitch * 2));
+    rows[3] = _mm_loadu_si128((const __m128i *)(src + srcPitch * 3));
+}
+
+// Returns the bounding box of the block colors replicated in all four 32 bits lanes.
+static BE_FORCE_INLINE void GetMinMaxBBoxSSE(const __m128i *rows, __m128i &minColor, __m128i &maxColor) {
+    __m128i mn = _mm_min_epu8(_mm_min_epu8(rows[0], rows[1]), _mm_min_epu8(rows[2], rows[3]));
+    __m128i mx = _mm_max_epu8(_mm_max_epu8(rows[0], rows[1]), _mm_max_epu8(rows[2], rows[3]));
+
+    mn = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(1, 0, 3, 2)));
+    mx = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(1, 0, 3, 2)));
+    minColor = _mm_min_epu8(mn, _mm_shuffle_epi32(mn, _MM_SHUFFLE(2, 3, 0, 1)));
+    maxColor = _mm_max_epu8(mx, _mm_shuffle_epi32(mx, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// Same as InsetColorsBBox. The inset never exceeds the range, so no clamping is needed.
+static BE_FORCE_INLINE void InsetColorsBBoxSSE(__m128i &minColor, __m128i &maxColor) {
+    const __m128i zero = _mm_setzero_si128();
+
+    __m128i mn = _mm_unpacklo_epi8(minColor, zero);
+    __m128i mx = _mm_unpacklo_epi8(maxColor, zero);
+    __m128i inset = _mm_srli_epi16(_mm_sub_epi16(mx, mn), INSET_COLOR_SHIFT);
+
+    minColor = _mm_packus_epi16(_mm_add_epi16(mn, inset), _mm_add_epi16(mn, inset));
+    maxColor = _mm_packus_epi16(_mm_sub_epi16(mx, inset), _mm_sub_epi16(mx, inset));
+}
+
+static BE_FORCE_INLINE void StoreColorSSE(const __m128i &color, byte *out) {
+    uint32_t c = _mm_cvtsi128_si32(color);
+    memcpy(out, &c, 4);
+}
+
+// Sum of absolute differences of RGB components for each pixel, alpha must be masked out in both.
+static BE_FORCE_INLINE __m128i ColorSADSSE(const __m128i &pixels, const __m128i &color) {
+    __m128i ad = _mm_or_si128(_mm_subs_epu8(pixels, color), _mm_subs_epu8(color, pixels));
+    __m128i t = _mm_add_epi16(_mm_and_si128(ad, _mm_set1_epi16(0xFF)), _mm_srli_epi16(ad, 8));
+    return _mm_madd_epi16(t, _mm_set1_epi16(1));
+}
+
+static BE_FORCE_INLINE uint32_t ComputeColorIndicesFastSSE(const __m128i *rows, const __m128i &maxColor, const __m128i &minColor) {
+    // Expand max and min colors to 565 precision in 16 bits lanes, right shifts by 5 and 6 are done with multiplications
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i c565Mask = _mm_setr_epi16(C565_5_MASK, C565_6_MASK, C565_5_MASK, 0, C565_5_MASK, C565_6_MASK, C565_5_MASK, 0);
+    const __m128i c565Shift = _mm_setr_epi16(1 << 11, 1 << 10, 1 << 11, 0, 1 << 11, 1 << 10, 1 << 11, 0);
+
+    __m128i c01 = _mm_unpacklo_epi8(_mm_unpacklo_epi32(maxColor, minColor), zero);
+    c01 = _mm_or_si128(_mm_and_si128(c01, c565Mask), _mm_mulhi_epu16(c01, c565Shift));
+
+    // (2 * c0 + c1) / 3 and (c0 + 2 * c1) / 3, division by 3 is exact for numerators up to 765
+    __m128i c10 = _mm_shuffle_epi32(c01, _MM_SHUFFLE(1, 0, 3, 2));
+    __m128i c23 = _mm_mulhi_epu16(_mm_add_epi16(_mm_add_epi16(c01, c01), c10), _mm_set1_epi16(21846));
+
+    c01 = _mm_packus_epi16(c01, c01);
+    c23 = _mm_packus_epi16(c23, c23);
+
+    __m128i c0 = _mm_shuffle_epi32(c01, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128i c1 = _mm_shuffle_epi32(c01, _MM_SHUFFLE(1, 1, 1, 1));
+    __m128i c2 = _mm_shuffle_epi32(c23, _MM_SHUFFLE(0, 0, 0, 0));
+    __m128i c3 = _mm_shuffle_epi32(c23, _MM_SHUFFLE(1, 1, 1, 1));
+
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i one = _mm_set1_epi32(1);
+    const __m128i two = _mm_set1_epi32(2);
+
+    __m128i indexes[4];
+
+    for (int i = 0; i < 4; i++) {
+        __m128i pixels = _mm_and_si128(rows[i], rgbMask);
+
+        __m128i d0 = ColorSADSSE(pixels, c0);
+        __m128i d1 = ColorSADSSE(pixels, c1);
+        __m128i d2 = ColorSADSSE(pixels, c2);
+        __m128i d3 = ColorSADSSE(pixels, c3);
+
+        __m128i b0 = _mm_cmpgt_epi32(d0, d3);
+        __m128i b1 = _mm_cmpgt_epi32(d1, d2);
+        __m128i b2 = _mm_cmpgt_epi32(d0, d2);
+        __m128i b3 = _mm_cmpgt_epi32(d1, d3);
+        __m128i b4 = _mm_cmpgt_epi32(d2, d3);
+
+        __m128i x0 = _mm_and_si128(b1, b2);
+        __m128i x1 = _mm_and_si128(b0, b3);
+        __m128i x2 = _mm_and_si128(b0, b4);
+
+        indexes[i] = _mm_or_si128(_mm_and_si128(x2, one), _mm_and_si128(_mm_or_si128(x0, x1), two));
+    }
+
+    // Pack indexes to bytes in pixel order and gather the low and high bits of them
+    __m128i packed = _mm_packus_epi16(_mm_packs_epi32(indexes[0], indexes[1]), _mm_packs_epi32(indexes[2], indexes[3]));
+
+    uint32_t lowBits = _mm_movemask_epi8(_mm_slli_epi16(packed, 7));
+    uint32_t highBits = _mm_movemask_epi8(_mm_slli_epi16(packed, 6));
+
+    return Part1By1(lowBits) | (Part1By1(highBits) << 1);
+}
+
+static BE_FORCE_INLINE void ComputeAlphaIndicesFastSSE(const __m128i *rows, const int alphaOffset, const byte maxAlpha, const byte minAlpha, byte *out) {
+    assert(maxAlpha >= minAlpha);
+    const int ALPHA_RANGE = 7;
+
+    byte ab[7];
+    ab[0] = (13 * maxAlpha +  1 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[1] = (11 * maxAlpha +  3 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[2] = ( 9 * maxAlpha +  5 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[3] = ( 7 * maxAlpha +  7 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[4] = ( 5 * maxAlpha +  9 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[5] = ( 3 * maxAlpha + 11 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+    ab[6] = ( 1 * maxAlpha + 13 * minAlpha + ALPHA_RANGE) / (ALPHA_RANGE * 2);
+
+    // Gather the alpha components of 16 pixels to bytes
+    const __m128i shift = _mm_cvtsi32_si128(alphaOffset * 8);
+    const __m128i byteMask = _mm_set1_epi32(0xFF);
+
+    __m128i a0 = _mm_and_si128(_mm_srl_epi32(rows[0], shift), byteMask);
+    __m128i a1 = _mm_and_si128(_mm_srl_epi32(rows[1], shift), byteMask);
+    __m128i a2 = _mm_and_si128(_mm_srl_epi32(rows[2], shift), byteMask);
+    __m128i a3 = _mm_and_si128(_mm_srl_epi32(rows[3], shift), byteMask);
+    __m128i alphas = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+
+    // Count the thresholds that each alpha is greater than or equal to, comparison masks are -1
+    __m128i count = _mm_setzero_si128();
+    for (int i = 0; i < 7; i++) {
+        __m128i threshold = _mm_set1_epi8((char)ab[i]);
+        count = _mm_add_epi8(count, _mm_cmpeq_epi8(_mm_max_epu8(alphas, threshold), alphas));
+    }
+
+    __m128i index = _mm_and_si128(_mm_add_epi8(count, _mm_set1_epi8(8)), _mm_set1_epi8(7));
+    index = _mm_xor_si128(index, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(2), index), _mm_set1_epi8(1)));
+
+    // Pack 3 bits indexes, pairs to 6 bits in 16 bits lanes, then to 12 bits and 24 bits
+    index = _mm_or_si128(_mm_and_si128(index, _mm_set1_epi16(0xFF)), _mm_srli_epi16(index, 5));
+    index = _mm_or_si128(_mm_and_si128(index, _mm_set1_epi32(0xFFFF)), _mm_srli_epi32(index, 10));
+    index = _mm_or_si128(_mm_and_si128(index, _mm_set_epi32(0, -1, 0, -1)), _mm_srli_epi64(index, 20));
+
+    uint32_t bits0 = _mm_cvtsi128_si32(index);
+    uint32_t bits1 = _mm_cvtsi128_si32(_mm_shuffle_epi32(index, _MM_SHUFFLE(2, 2, 2, 2)));
+
+    out[0] = (byte)(bits0 >> 0);
+    out[1] = (byte)(bits0 >> 8);
+    out[2] = (byte)(bits0 >> 16);
+
+    out[3] = (byte)(bits1 >> 0);
+    out[4] = (byte)(bits1 >> 8);
+    out[5] = (byte)(bits1 >> 16);
+}
+
+void DXTEncoder::EncodeDXT1BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr) {
+    ALIGN_AS16 byte minColor[4];
+    ALIGN_AS16 byte maxColor[4];
+    ALIGN_AS16 DXTBlock::ColorBlock dxtColorBlock;
+    __m128i rows[4];
+    __m128i minColorSSE, maxColorSSE;
+
+    LoadBlockSSE(src, srcPitch, rows);
+
+    GetMinMaxBBoxSSE(rows, minColorSSE, maxColorSSE);
+    InsetColorsBBoxSSE(minColorSSE, maxColorSSE);
+
+    StoreColorSSE(minColorSSE, minColor);
+    StoreColorSSE(maxColorSSE, maxColor);
+
+    dxtColorBlock.color0 = RGB888To565(maxColor);
+    dxtColorBlock.color1 = RGB888To565(minColor);
+    dxtColorBlock.indexes = ComputeColorIndicesFastSSE(rows, maxColorSSE, minColorSSE);
+
+    memcpy(*dstPtr, &dxtColorBlock, sizeof(dxtColorBlock));
+    *dstPtr += sizeof(dxtColorBlock);
+}
+
+void DXTEncoder::EncodeDXT3BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr) {
+    ALIGN_AS16 byte minColor[4];
+    ALIGN_AS16 byte maxColor[4];
+    ALIGN_AS16 DXTBlock::ColorBlock dxtColorBlock;
+    ALIGN_AS16 DXTBlock::AlphaExplicitBlock dxtAlphaBlock;
+    ALIGN_AS16 byte colorBlock[4 * 16];
+    __m128i rows[4];
+    __m128i minColorSSE, maxColorSSE;
+
+    LoadBlockSSE(src, srcPitch, rows);
+
+    GetMinMaxBBoxSSE(rows, minColorSSE, maxColorSSE);
+    InsetColorsBBoxSSE(minColorSSE, maxColorSSE);
+
+    StoreColorSSE(minColorSSE, minColor);
+    StoreColorSSE(maxColorSSE, maxColor);
+
+    // Explicit alpha is taken from the contiguous block
+    _mm_store_si128((__m128i *)(colorBlock + 0), rows[0]);
+    _mm_store_si128((__m128i *)(colorBlock + 16), rows[1]);
+    _mm_store_si128((__m128i *)(colorBlock + 32), rows[2]);
+    _mm_store_si128((__m128i *)(colorBlock + 48), rows[3]);
+
+    Compute4BitsAlpha(colorBlock, 3, dxtAlphaBlock.row);
+
+    memcpy(*dstPtr, &dxtAlphaBlock, sizeof(dxtAlphaBlock));
+    *dstPtr += sizeof(dxtAlphaBlock);
+
+    dxtColorBlock.color0 = RGB888To565(maxColor);
+    dxtColorBlock.color1 = RGB888To565(minColor);
+    dxtColorBlock.indexes = ComputeColorIndicesFastSSE(rows, maxColorSSE, minColorSSE);
+
+    memcpy(*dstPtr, &dxtColorBlock, sizeof(dxtColorBlock));
+    *dstPtr += sizeof(dxtColorBlock);
+}
+
+void DXTEncoder::EncodeDXT5BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr) {
+    ALIGN_AS16 byte minColor[4];
+    ALIGN_AS16 byte maxColor[4];
+    ALIGN_AS16 DXTBlock::ColorBlock dxtColorBlock;
+    ALIGN_AS16 DXTBlock::AlphaBlock dxtAlphaBlock;
+    __m128i rows[4];
+    __m128i minColorSSE, maxColorSSE;
+
+    LoadBlockSSE(src, srcPitch, rows);
+
+    GetMinMaxBBoxSSE(rows, minColorSSE, maxColorSSE);
+    InsetColorsBBoxSSE(minColorSSE, maxColorSSE);
+
+    StoreColorSSE(minColorSSE, minColor);
+    StoreColorSSE(maxColorSSE, maxColor);
+
+    dxtAlphaBlock.alpha0 = maxColor[3];
+    dxtAlphaBlock.alpha1 = minColor[3];
+
+    ComputeAlphaIndicesFastSSE(rows, 3, maxColor[3], minColor[3], dxtAlphaBlock.indexes);
+
+    memcpy(*dstPtr, &dxtAlphaBlock, sizeof(dxtAlphaBlock));
+    *dstPtr += sizeof(dxtAlphaBlock);
+
+    dxtColorBlock.color0 = RGB888To565(maxColor);
+    dxtColorBlock.color1 = RGB888To565(minColor);
+    dxtColorBlock.indexes = ComputeColorIndicesFastSSE(rows, maxColorSSE, minColorSSE);
+
+    memcpy(*dstPtr, &dxtColorBlock, sizeof(dxtColorBlock));
+    *dstPtr += sizeof(dxtColorBlock);
+}
+
+void DXTEncoder::EncodeDXN2BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr) {
+    ALIGN_AS16 byte minNormal[4];
+    ALIGN_AS16 byte maxNormal[4];
+    ALIGN_AS16 DXTBlock::AlphaBlock dxtAlphaBlock;
+    __m128i rows[4];
+    __m128i minNormalSSE, maxNormalSSE;
+
+    LoadBlockSSE(src, srcPitch, rows);
+
+    GetMinMaxBBoxSSE(rows, minNormalSSE, maxNormalSSE);
+
+    StoreColorSSE(minNormalSSE, minNormal);
+    StoreColorSSE(maxNormalSSE, maxNormal);
+
+    InsetNormalsBBox3Dc(minNormal, maxNormal);
+
+    for (int i = 0; i < 2; i++) {
+        dxtAlphaBlock.alpha0 = maxNormal[i];
+        dxtAlphaBlock.alpha1 = minNormal[i];
+
+        ComputeAlphaIndicesFastSSE(rows, i, maxNormal[i], minNormal[i], dxtAlphaBlock.indexes);
+
+        memcpy(*dstPtr, &dxtAlphaBlock, sizeof(dxtAlphaBlock));
+        *dstPtr += sizeof(dxtAlphaBlock);
+    }
+}
+
+// Full blocks are read directly from the image, partial blocks on the right and bottom edges are extracted first.
+void DXTEncoder::CompressImageDXT1FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    ALIGN_AS16 byte colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            int bh = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4) {
+                int bw = Min(4, width - x);
+
+                if (bw == 4 && bh == 4) {
+                    EncodeDXT1BlockFastSIMD(src + 4 * x, 4 * width, &dstPtr);
+                } else {
+                    ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                    EncodeDXT1BlockFastSIMD(colorBlock, 4 * 4, &dstPtr);
+                }
+            }
+        }
+    }
+}
+
+void DXTEncoder::CompressImageDXT3FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    ALIGN_AS16 byte colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            int bh = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4) {
+                int bw = Min(4, width - x);
+
+                if (bw == 4 && bh == 4) {
+                    EncodeDXT3BlockFastSIMD(src + 4 * x, 4 * width, &dstPtr);
+                } else {
+                    ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                    EncodeDXT3BlockFastSIMD(colorBlock, 4 * 4, &dstPtr);
+                }
+            }
+        }
+    }
+}
+
+void DXTEncoder::CompressImageDXT5FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    ALIGN_AS16 byte colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            int bh = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4) {
+                int bw = Min(4, width - x);
+
+                if (bw == 4 && bh == 4) {
+                    EncodeDXT5BlockFastSIMD(src + 4 * x, 4 * width, &dstPtr);
+                } else {
+                    ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                    EncodeDXT5BlockFastSIMD(colorBlock, 4 * 4, &dstPtr);
+                }
+            }
+        }
+    }
+}
+
+void DXTEncoder::CompressImageDXN2FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    ALIGN_AS16 byte colorBlock[4 * 16];
+    byte *dstPtr = dst;
+
+    for (int z = 0; z < depth; z++) {
+        for (int y = 0; y < height; y += 4, src += width * 4 * 4) {
+            int bh = Min(4, height - y);
+
+            for (int x = 0; x < width; x += 4) {
+                int bw = Min(4, width - x);
+
+                if (bw == 4 && bh == 4) {
+                    EncodeDXN2BlockFastSIMD(src + 4 * x, 4 * width, &dstPtr);
+                } else {
+                    ExtractBlock(src + 4 * x, 4 * width, bw, bh, colorBlock);
+
+                    EncodeDXN2BlockFastSIMD(colorBlock, 4 * 4, &dstPtr);
+                }
+            }
+        }
+    }
+}
+
+#else
+
+void DXTEncoder::CompressImageDXT1FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    CompressImageDXT1Fast(src, width, height, depth, dst);
+}
+
+void DXTEncoder::CompressImageDXT3FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    CompressImageDXT3Fast(src, width, height, depth, dst);
+}
+
+void DXTEncoder::CompressImageDXT5FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    CompressImageDXT5Fast(src, width, height, depth, dst);
+}
+
+void DXTEncoder::CompressImageDXN2FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst) {
+    CompressImageDXN2Fast(src, width, height, depth, dst);
+}
+
+#endif
+
 BE_NAMESPACE_END
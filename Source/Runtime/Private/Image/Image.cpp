@@ -560,7 +560,7 @@ bool Image::IsFloatFormat(Image::Format::Enum imageFormat) {
 }
 
 bool Image::IsHalfFormat(Image::Format::Enum imageFormat) {
-    return !!(GetImageFormatInfo(imageFormat)->type & FormatType::Half);
+    return (GetImageFormatInfo(imageFormat)->type & FormatType::Half) == FormatType::Half;
 }
 
 bool Image::IsDepthFormat(Image::Format::Enum imageFormat) {
@@ -13,37 +13,39 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Core/JobSystem.h"
 #include "Image/Image.h"
 #include "Image/DxtEncoder.h"
 #include "ImageInternal.h"
 
 BE_NAMESPACE_BEGIN
 
-void CompressDXT1(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
-    int numMipmaps = srcImage.NumMipmaps();
-    int numSlices = srcImage.NumSlices();
+// Number of 4x4 block rows compressed in a single tile
+static const int BlockRowsPerTile = 8;
 
-    for (int mipLevel = 0; mipLevel < numMipmaps; mipLevel++) {
-        int w = srcImage.GetWidth(mipLevel);
-        int h = srcImage.GetHeight(mipLevel);
-        int d = srcImage.GetDepth(mipLevel);
+using CompressImageFunc = void (*)(const byte *src, const int width, const int height, const int depth, byte *dst);
 
-        for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
-            byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
-            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+struct CompressTile {
+    const byte *            src;
+    byte *                  dst;
+    int                     width;
+    int                     height;
+    int                     depth;
+};
 
-            if (compressoinQuality == Image::CompressionQuality::HighQuality) {
-                DXTEncoder::CompressImageDXT1HQ(src, w, h, d, dst);
-            } else {
-                DXTEncoder::CompressImageDXT1Fast(src, w, h, d, dst);
-            }
-        }
-    }
-}
+struct CompressTilesData {
+    CompressImageFunc       compressFunc;
+    const CompressTile *    tiles;
+};
 
-void CompressDXT3(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
+// Splits all mip levels and slices into tiles of block rows and compresses them in parallel.
+// Every block is encoded independently, so the result is identical with the serial compression.
+static void CompressImageParallel(const Image &srcImage, Image &dstImage, CompressImageFunc compressFunc) {
     int numMipmaps = srcImage.NumMipmaps();
     int numSlices = srcImage.NumSlices();
+    int blockBytes = Image::BytesPerBlock(dstImage.GetFormat());
+
+    Array<CompressTile> tiles;
 
     for (int mipLevel = 0; mipLevel < numMipmaps; mipLevel++) {
         int w = srcImage.GetWidth(mipLevel);
@@ -51,59 +53,76 @@ void CompressDXT3(const Image &srcImage, Image &dstImage, Image::CompressionQual
         int d = srcImage.GetDepth(mipLevel);
 
         for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
-            byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
-            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+            CompressTile tile;
+            tile.src = srcImage.GetPixels(mipLevel, sliceIndex);
+            tile.dst = dstImage.GetPixels(mipLevel, sliceIndex);
+            tile.width = w;
+            tile.height = h;
+            tile.depth = d;
+
+            // Volume textures are compressed as a whole because the encoder steps through depth slices by block rows
+            if (d > 1) {
+                tiles.Append(tile);
+                continue;
+            }
 
-            if (compressoinQuality == Image::CompressionQuality::HighQuality) {
-                DXTEncoder::CompressImageDXT3HQ(src, w, h, d, dst);
-            } else {
-                DXTEncoder::CompressImageDXT3Fast(src, w, h, d, dst);
+            int numBlocksX = (w + 3) / 4;
+            int numBlocksY = (h + 3) / 4;
+
+            for (int blockY = 0; blockY < numBlocksY; blockY += BlockRowsPerTile) {
+                tile.src = srcImage.GetPixels(mipLevel, sliceIndex) + blockY * 4 * w * 4;
+                tile.dst = dstImage.GetPixels(mipLevel, sliceIndex) + blockY * numBlocksX * blockBytes;
+                tile.height = Min(BlockRowsPerTile * 4, h - blockY * 4);
+
+                tiles.Append(tile);
             }
         }
     }
-}
 
-void CompressDXT5(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
-    int numMipmaps = srcImage.NumMipmaps();
-    int numSlices = srcImage.NumSlices();
+    CompressTilesData data;
+    data.compressFunc = compressFunc;
+    data.tiles = tiles.Ptr();
 
-    for (int mipLevel = 0; mipLevel < numMipmaps; mipLevel++) {
-        int w = srcImage.GetWidth(mipLevel);
-        int h = srcImage.GetHeight(mipLevel);
-        int d = srcImage.GetDepth(mipLevel);
+    jobSystem.ParallelFor(tiles.Count(), 1, [](void *data, int begin, int end) {
+        const CompressTilesData *tilesData = (const CompressTilesData *)data;
 
-        for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
-            byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
-            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+        for (int tileIndex = begin; tileIndex < end; tileIndex++) {
+            const CompressTile &tile = tilesData->tiles[tileIndex];
 
-            if (compressoinQuality == Image::CompressionQuality::HighQuality) {
-                DXTEncoder::CompressImageDXT5HQ(src, w, h, d, dst);
-            } else {
-                DXTEncoder::CompressImageDXT5Fast(src, w, h, d, dst);
-            }
+            tilesData->compressFunc(tile.src, tile.width, tile.height, tile.depth, tile.dst);
         }
-    }
+    }, &data);
 }
 
-void CompressDXN2(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
-    int numMipmaps = srcImage.NumMipmaps();
-    int numSlices = srcImage.NumSlices();
+void CompressDXT1(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
+    if (compressoinQuality == Image::CompressionQuality::HighQuality) {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT1HQ);
+    } else {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT1FastSIMD);
+    }
+}
 
-    for (int mipLevel = 0; mipLevel < numMipmaps; mipLevel++) {
-        int w = srcImage.GetWidth(mipLevel);
-        int h = srcImage.GetHeight(mipLevel);
-        int d = srcImage.GetDepth(mipLevel);
+void CompressDXT3(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
+    if (compressoinQuality == Image::CompressionQuality::HighQuality) {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT3HQ);
+    } else {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT3FastSIMD);
+    }
+}
 
-        for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
-            byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
-            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+void CompressDXT5(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
+    if (compressoinQuality == Image::CompressionQuality::HighQuality) {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT5HQ);
+    } else {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXT5FastSIMD);
+    }
+}
 
-            if (compressoinQuality == Image::CompressionQuality::HighQuality) {
-                DXTEncoder::CompressImageDXN2HQ(src, w, h, d, dst);
-            } else {
-                DXTEncoder::CompressImageDXN2Fast(src, w, h, d, dst);
-            }
-        }
+void CompressDXN2(const Image &srcImage, Image &dstImage, Image::CompressionQuality::Enum compressoinQuality) {
+    if (compressoinQuality == Image::CompressionQuality::HighQuality) {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXN2HQ);
+    } else {
+        CompressImageParallel(srcImage, dstImage, DXTEncoder::CompressImageDXN2FastSIMD);
     }
 }
 
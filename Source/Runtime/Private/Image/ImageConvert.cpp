@@ -15,12 +15,57 @@
 #include "Precompiled.h"
 #include "Core/Str.h"
 #include "Core/Heap.h"
+#include "Core/JobSystem.h"
 #include "Math/Math.h"
 #include "Image/Image.h"
 #include "ImageInternal.h"
 
 BE_NAMESPACE_BEGIN
 
+// Number of pixels converted in a single job
+static const int ConvertPixelsPerJob = 64 * 1024;
+
+struct ConvertPixelsData {
+    ImageConvertFunc        convertFunc;
+    const byte *            src;
+    byte *                  dst;
+    int                     srcPixelSize;
+    int                     dstPixelSize;
+    int                     numPixels;
+    bool                    isGamma;
+};
+
+// Converts pixels with the direct conversion function. Large images are split into jobs of consecutive pixels.
+static void ConvertPixels(ImageConvertFunc convertFunc, const byte *src, byte *dst, int srcPixelSize, int dstPixelSize, int numPixels, bool isGamma, bool parallel) {
+    if (!parallel || numPixels <= ConvertPixelsPerJob) {
+        convertFunc(src, dst, numPixels, isGamma);
+        return;
+    }
+
+    ConvertPixelsData data;
+    data.convertFunc = convertFunc;
+    data.src = src;
+    data.dst = dst;
+    data.srcPixelSize = srcPixelSize;
+    data.dstPixelSize = dstPixelSize;
+    data.numPixels = numPixels;
+    data.isGamma = isGamma;
+
+    int numJobs = (numPixels + ConvertPixelsPerJob - 1) / ConvertPixelsPerJob;
+
+    jobSystem.ParallelFor(numJobs, 1, [](void *data, int begin, int end) {
+        const ConvertPixelsData *convertData = (const ConvertPixelsData *)data;
+
+        for (int jobIndex = begin; jobIndex < end; jobIndex++) {
+            int firstPixel = jobIndex * ConvertPixelsPerJob;
+            int count = Min(ConvertPixelsPerJob, convertData->numPixels - firstPixel);
+
+            convertData->convertFunc(convertData->src + firstPixel * convertData->srcPixelSize, 
+                convertData->dst + firstPixel * convertData->dstPixelSize, count, convertData->isGamma);
+        }
+    }, &data);
+}
+
 static bool DecompressImage(const Image &srcImage, Image &dstImage) {
     assert(dstImage.GetFormat() == Image::Format::RGBA_8_8_8_8);
     assert(dstImage.GetPixels());
@@ -177,6 +222,17 @@ bool Image::ConvertFormat(Image::Format::Enum dstFormat, Image &dstImage, bool r
         return true;
     }
 
+    bool isGamma = !(flags & Flag::LinearSpace);
+
+    // Common format pairs are converted directly without the intermediate buffer
+    ImageConvertFunc directConvertFunc = GetImageDirectConvertFunc(srcImage->GetFormat(), dstFormat, isGamma);
+    if (directConvertFunc) {
+        int numPixels = srcImage->NumPixels(0, srcImage->numMipmaps) * srcImage->numSlices;
+
+        ConvertPixels(directConvertFunc, srcImage->GetPixels(), dstImage.GetPixels(), srcImage->BytesPerPixel(), dstImage.BytesPerPixel(), numPixels, isGamma, true);
+        return true;
+    }
+
     ImageUnpackFunc unpackFunc;
     ImagePackFunc packFunc;
 
@@ -196,8 +252,6 @@ bool Image::ConvertFormat(Image::Format::Enum dstFormat, Image &dstImage, bool r
         return false;
     }
 
-    bool isGamma = !(flags & Flag::LinearSpace);
-
     byte *unpackedBuffer = (byte *)Mem_Alloc16(width * 4 * (unpackFloat ? sizeof(float) : 1));
 
     byte *srcPtr = srcImage->GetPixels();
@@ -231,6 +285,28 @@ bool Image::ConvertFormatSelf(Image::Format::Enum dstFormat, bool regenerateMipm
         return true;
     }
 
+    // Converts in-place if the destination pixels are not larger than the source pixels
+    if (alloced && !regenerateMipmaps) {
+        bool isGamma = !(flags & Flag::LinearSpace);
+        ImageConvertFunc directConvertFunc = GetImageDirectConvertFunc(format, dstFormat, isGamma);
+
+        if (directConvertFunc) {
+            int srcPixelSize = BytesPerPixel(format);
+            int dstPixelSize = BytesPerPixel(dstFormat);
+
+            if (dstPixelSize <= srcPixelSize) {
+                int numPixels = NumPixels(0, numMipmaps) * numSlices;
+
+                // Smaller destination pixels are written behind the read position of the previous pixels,
+                // so only the same size conversion can be split into jobs.
+                ConvertPixels(directConvertFunc, pic, pic, srcPixelSize, dstPixelSize, numPixels, isGamma, dstPixelSize == srcPixelSize);
+
+                format = dstFormat;
+                return true;
+            }
+        }
+    }
+
     Image dstImage;
     bool ret = ConvertFormat(dstFormat, dstImage, regenerateMipmaps, compressionQuality);
     if (ret) {
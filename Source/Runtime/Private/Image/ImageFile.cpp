@@ -21,13 +21,37 @@
 
 BE_NAMESPACE_BEGIN
 
-bool Image::Load(const char *filename) {
+bool Image::Load(const char *filename, int firstMipLevel, int *skippedMipLevels) {
     if (!filename || filename[0] == 0) {
         return false;
     }
 
     Str name = filename;
 
+    if (skippedMipLevels) {
+        *skippedMipLevels = 0;
+    }
+
+    // Map the file to memory for the formats that have pre-built mipmaps,
+    // so that the pages of skipped mip levels are never read from the disk.
+    if (firstMipLevel > 0 && (name.CheckExtension(".dds") || name.CheckExtension(".pvr")) && fileSystem.FileExists(name)) {
+        PlatformFileMapping *fileMapping = PlatformFileMapping::OpenFileRead(name);
+        if (fileMapping) {
+            const byte *data = (const byte *)fileMapping->GetData();
+            size_t size = fileMapping->GetSize();
+
+            if (name.CheckExtension(".dds")) {
+                LoadDDSFromMemory(name, data, size, firstMipLevel, skippedMipLevels);
+            } else {
+                LoadPVRFromMemory(name, data, size, firstMipLevel, skippedMipLevels);
+            }
+
+            delete fileMapping;
+
+            return pic ? true : false;
+        }
+    }
+
     byte *data;
     size_t size = fileSystem.LoadFile(name, true, (void **)&data);
     if (data) {
@@ -35,9 +59,9 @@ bool Image::Load(const char *filename) {
         if (name.CheckExtension(".btex")) {
             //LoadBTexFromMemory(name, data, size);
         } else if (name.CheckExtension(".dds")) {
-            LoadDDSFromMemory(name, data, size);
+            LoadDDSFromMemory(name, data, size, firstMipLevel, skippedMipLevels);
         } else if (name.CheckExtension(".pvr")) {
-            LoadPVRFromMemory(name, data, size);
+            LoadPVRFromMemory(name, data, size, firstMipLevel, skippedMipLevels);
         } else if (name.CheckExtension(".tga")) {
             LoadTGAFromMemory(name, data, size);
         } else if (name.CheckExtension(".jpg")) {
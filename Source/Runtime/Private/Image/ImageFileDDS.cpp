@@ -324,7 +324,7 @@ struct DdsFileHeaderDX10 {
     uint32_t miscFlag2;
 };
 
-bool Image::LoadDDSFromMemory(const char *name, const byte *data, size_t size) {
+bool Image::LoadDDSFromMemory(const char *name, const byte *data, size_t size, int firstMipLevel, int *skippedMipLevels) {
     const byte *ptr = data;
     uint32_t fourcc = *(uint32_t *)ptr;
     ptr += sizeof(uint32_t);
@@ -568,7 +568,27 @@ bool Image::LoadDDSFromMemory(const char *name, const byte *data, size_t size) {
         this->flags |= Flag::LinearSpace;
     }
 
+    // Skip top mip levels without touching their data, the last mip level is always kept
+    int skipLevels = Min(Max(firstMipLevel, 0), numMipmaps - 1);
+    if (skipLevels > 0) {
+        ptr += GetSize(0, skipLevels);
+
+        this->width = GetWidth(skipLevels);
+        this->height = GetHeight(skipLevels);
+        this->depth = GetDepth(skipLevels);
+        this->numMipmaps -= skipLevels;
+    }
+
+    if (skippedMipLevels) {
+        *skippedMipLevels = skipLevels;
+    }
+
     int bufSize = GetSize(0, numMipmaps);
+    if (ptr + bufSize > data + size) {
+        BE_WARNLOG("Image::LoadDDSFromMemory: truncated DDS data %s\n", name);
+        return false;
+    }
+
     this->pic = (byte *)Mem_Alloc16(bufSize);
     this->alloced = true;
 
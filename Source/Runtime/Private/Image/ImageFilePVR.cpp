@@ -23,7 +23,7 @@
 
 BE_NAMESPACE_BEGIN
 
-bool Image::LoadPVR2FromMemory(const char *name, const byte *data, size_t fileSize) {
+bool Image::LoadPVR2FromMemory(const char *name, const byte *data, size_t fileSize, int firstMipLevel, int *skippedMipLevels) {
     const byte *ptr = data;
     
     PVR_Texture_Header *header = (PVR_Texture_Header *)ptr;
@@ -82,10 +82,39 @@ bool Image::LoadPVR2FromMemory(const char *name, const byte *data, size_t fileSi
     this->depth = 1;
     this->numMipmaps = Max(1, (int)header->dwMipMapCount);
     this->numSlices = Max(1, (int)header->dwNumSurfs);
-    
-    this->pic = (byte *)Mem_Alloc16(header->dwTextureDataSize);
-    simdProcessor->Memcpy(this->pic, ptr, header->dwTextureDataSize);
+
+    // Surfaces are stored one after another with their own mip chain
+    int skipLevels = Min(Max(firstMipLevel, 0), numMipmaps - 1);
+    if (skipLevels == 0) {
+        this->pic = (byte *)Mem_Alloc16(header->dwTextureDataSize);
+        simdProcessor->Memcpy(this->pic, ptr, header->dwTextureDataSize);
+    } else {
+        // Skip top mip levels of each surface without touching their data
+        int srcSurfaceSize = GetSliceSize(0, numMipmaps);
+        int skipSize = GetSliceSize(0, skipLevels);
+
+        this->width = GetWidth(skipLevels);
+        this->height = GetHeight(skipLevels);
+        this->numMipmaps -= skipLevels;
+
+        int dstSurfaceSize = GetSliceSize(0, numMipmaps);
+
+        if (sizeof(PVR_Texture_Header) + (size_t)srcSurfaceSize * numSlices > fileSize) {
+            BE_WARNLOG("truncated PVR data %s\n", name);
+            return false;
+        }
+
+        this->pic = (byte *)Mem_Alloc16(dstSurfaceSize * numSlices);
+
+        for (int surfaceIndex = 0; surfaceIndex < numSlices; surfaceIndex++) {
+            simdProcessor->Memcpy(this->pic + surfaceIndex * dstSurfaceSize, ptr + surfaceIndex * srcSurfaceSize + skipSize, dstSurfaceSize);
+        }
+    }
     this->alloced = true;
+
+    if (skippedMipLevels) {
+        *skippedMipLevels = skipLevels;
+    }
     
     return true;
 }
@@ -100,7 +129,7 @@ static bool IsSignedChannelType(uint32_t channelType) {
     return false;
 }
 
-bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSize) {
+bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSize, int firstMipLevel, int *skippedMipLevels) {
     const byte *ptr = data;
     
     PVRTextureHeaderV3 *header = (PVRTextureHeaderV3 *)ptr;
@@ -297,6 +326,26 @@ bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSi
 
     this->flags |= header->u32NumFaces == 6 ? Flag::CubeMap : 0;
     
+    // Texture data is ordered by mip level, so the top mip levels can be skipped without touching their data
+    int skipLevels = Min(Max(firstMipLevel, 0), numMipmaps - 1);
+    if (skipLevels > 0) {
+        int skipSize = GetSize(0, skipLevels);
+        if (ptr + skipSize > data + fileSize) {
+            BE_WARNLOG("Image::LoadPVR3FromMemory: truncated PVR data %s\n", name);
+            return false;
+        }
+        ptr += skipSize;
+
+        this->width = GetWidth(skipLevels);
+        this->height = GetHeight(skipLevels);
+        this->depth = GetDepth(skipLevels);
+        this->numMipmaps -= skipLevels;
+    }
+
+    if (skippedMipLevels) {
+        *skippedMipLevels = skipLevels;
+    }
+
     size_t dataSize = fileSize - (ptr - data);
     
     this->pic = (byte *)Mem_Alloc16(dataSize);
@@ -306,14 +355,14 @@ bool Image::LoadPVR3FromMemory(const char *name, const byte *data, size_t fileSi
     return false;
 }
 
-bool Image::LoadPVRFromMemory(const char *name, const byte *data, size_t size) {
+bool Image::LoadPVRFromMemory(const char *name, const byte *data, size_t size, int firstMipLevel, int *skippedMipLevels) {
     bool ret;
     uint32_t v3magic = *reinterpret_cast<const uint32_t *>(data);
     
     if (v3magic == PVRTEX3_IDENT) {
-        ret = LoadPVR3FromMemory(name, data, size);
+        ret = LoadPVR3FromMemory(name, data, size, firstMipLevel, skippedMipLevels);
     } else {
-        ret = LoadPVR2FromMemory(name, data, size);
+        ret = LoadPVR2FromMemory(name, data, size, firstMipLevel, skippedMipLevels);
     }
 
     return ret;
@@ -18,6 +18,10 @@
 #include "Image/Image.h"
 #include "ImageInternal.h"
 
+#if defined(__X86__)
+#include <emmintrin.h>
+#endif
+
 BE_NAMESPACE_BEGIN
 
 //--------------------------------------------------------------------------------------------------
@@ -341,7 +345,7 @@ static void RGB565ToRGBA8888(const byte *src, byte *dst, int numPixels, bool isG
     for (; srcPtr < srcEnd; srcPtr++, dstPtr += 4) {
         dstPtr[0] = ((*srcPtr << 3) & 0xF8) | ((*srcPtr >> 2) & 0x7);
         dstPtr[1] = ((*srcPtr >> 3) & 0xFC) | ((*srcPtr >> 9) & 0x3);
-        dstPtr[2] = ((*srcPtr >> 8) & 0xF8) | ((*srcPtr >> 14) & 0x7);
+        dstPtr[2] = ((*srcPtr >> 8) & 0xF8) | ((*srcPtr >> 13) & 0x7);
         dstPtr[3] = 255;
     }
 }
@@ -351,7 +355,7 @@ static void BGR565ToRGBA8888(const byte *src, byte *dst, int numPixels, bool isG
     byte *dstPtr = dst;
 
     for (; srcPtr < srcEnd; srcPtr++, dstPtr += 4) {
-        dstPtr[0] = ((*srcPtr >> 8) & 0xF8) | ((*srcPtr >> 14) & 0x7);
+        dstPtr[0] = ((*srcPtr >> 8) & 0xF8) | ((*srcPtr >> 13) & 0x7);
         dstPtr[1] = ((*srcPtr >> 3) & 0xFC) | ((*srcPtr >> 9) & 0x3);
         dstPtr[2] = ((*srcPtr << 3) & 0xF8) | ((*srcPtr >> 2) & 0x7);
         dstPtr[3] = 255;
@@ -631,7 +635,7 @@ static void RGBA32FToRGBA8888(const byte *src, byte *dst, int numPixels, bool is
             dstPtr[0] = Math::Ftob(255.0f * Image::LinearToGammaFast(srcPtr[0]));
             dstPtr[1] = Math::Ftob(255.0f * Image::LinearToGammaFast(srcPtr[1]));
             dstPtr[2] = Math::Ftob(255.0f * Image::LinearToGammaFast(srcPtr[2]));
-            dstPtr[3] = Math::Ftob(255.0f * Image::LinearToGammaFast(srcPtr[3]));
+            dstPtr[3] = Math::Ftob(255.0f * srcPtr[3]);
         }
     } else {
         for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 4) {
@@ -1055,14 +1059,14 @@ static void RGBA8888ToRGBA16F(const byte *src, byte *dst, int numPixels, bool is
     float16_t *dstPtr = (float16_t *)dst;
 
     if (isGamma) {
-        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 3) {
+        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 4) {
             dstPtr[0] = F16Converter::FromF32(gammaToLinearTable[srcPtr[0]]);
             dstPtr[1] = F16Converter::FromF32(gammaToLinearTable[srcPtr[1]]);
             dstPtr[2] = F16Converter::FromF32(gammaToLinearTable[srcPtr[2]]);
             dstPtr[3] = F16Converter::FromF32(srcPtr[3] * invNorm);
         }
     } else {
-        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 3) {
+        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 4) {
             dstPtr[0] = F16Converter::FromF32(srcPtr[0] * invNorm);
             dstPtr[1] = F16Converter::FromF32(srcPtr[1] * invNorm);
             dstPtr[2] = F16Converter::FromF32(srcPtr[2] * invNorm);
@@ -1175,14 +1179,14 @@ static void RGBA8888ToRGBA32F(const byte *src, byte *dst, int numPixels, bool is
     float *dstPtr = (float *)dst;
 
     if (isGamma) {
-        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 3) {
+        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 4) {
             dstPtr[0] = gammaToLinearTable[srcPtr[0]];
             dstPtr[1] = gammaToLinearTable[srcPtr[1]];
             dstPtr[2] = gammaToLinearTable[srcPtr[2]];
             dstPtr[3] = srcPtr[3] * invNorm;
         }
     } else {
-        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 3) {
+        for (; srcPtr < srcEnd; srcPtr += 4, dstPtr += 4) {
             dstPtr[0] = srcPtr[0] * invNorm;
             dstPtr[1] = srcPtr[1] * invNorm;
             dstPtr[2] = srcPtr[2] * invNorm;
@@ -2191,4 +2195,429 @@ bool CompressedFormatBlockDimensions(Image::Format::Enum imageFormat, int &block
     return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+//
+// XXXToYYY (direct conversion functions between common formats)
+//
+// These convert without the RGBA8888/RGBA32F intermediate buffer and give the same result as the
+// unpack/pack pair. Every function loads a group of pixels before storing them, and the destination
+// pixel size is never larger than the source pixel size when converting in place.
+//
+//--------------------------------------------------------------------------------------------------
+
+static void RGB888ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4, src += 12, dst += 16) {
+        uint32_t w[3];
+        uint32_t p[4];
+        memcpy(w, src, sizeof(w));
+        p[0] = w[0] | 0xFF000000;
+        p[1] = (w[0] >> 24) | (w[1] << 8) | 0xFF000000;
+        p[2] = (w[1] >> 16) | (w[2] << 16) | 0xFF000000;
+        p[3] = (w[2] >> 8) | 0xFF000000;
+        memcpy(dst, p, sizeof(p));
+    }
+    RGB888ToRGBA8888(src, dst, numPixels - i, isGamma);
+}
+static void RGBA8888ToRGB888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+#if defined(__X86__)
+    const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i lo24Mask = _mm_set_epi32(0, 0x00FFFFFF, 0, 0x00FFFFFF);
+    const __m128i hi24Mask = _mm_set_epi32(0x0000FFFF, 0xFF000000, 0x0000FFFF, 0xFF000000);
+    const __m128i lo48Mask = _mm_set_epi32(0, 0, 0x0000FFFF, 0xFFFFFFFF);
+    const __m128i mid48Mask = _mm_set_epi32(0, 0xFFFFFFFF, 0xFFFF0000, 0);
+
+    for (; i + 4 <= numPixels; i += 4, src += 16, dst += 12) {
+        __m128i x = _mm_and_si128(_mm_loadu_si128((const __m128i *)src), rgbMask);
+        // Packs two pixels into the low 6 bytes of each 64-bit lane
+        x = _mm_or_si128(_mm_and_si128(x, lo24Mask), _mm_and_si128(_mm_srli_epi64(x, 8), hi24Mask));
+        // Moves the high lane right after the low lane
+        x = _mm_or_si128(_mm_and_si128(x, lo48Mask), _mm_and_si128(_mm_srli_si128(x, 2), mid48Mask));
+        _mm_storel_epi64((__m128i *)dst, x);
+        *(uint32_t *)(dst + 8) = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(x, 8));
+    }
+#else
+    for (; i + 4 <= numPixels; i += 4, src += 16, dst += 12) {
+        uint32_t p[4];
+        uint32_t w[3];
+        memcpy(p, src, sizeof(p));
+        w[0] = (p[0] & 0xFFFFFF) | (p[1] << 24);
+        w[1] = ((p[1] >> 8) & 0xFFFF) | (p[2] << 16);
+        w[2] = ((p[2] >> 16) & 0xFF) | (p[3] << 8);
+        memcpy(dst, w, sizeof(w));
+    }
+#endif
+    RGBA8888ToRGB888(src, dst, numPixels - i, isGamma);
+}
+
+#if defined(__X86__)
+
+// Swaps red and blue, and ORs alpha with alphaMask
+static void SwapRB8888SSE(const byte *src, byte *dst, int numPixels, uint32_t alphaMask) {
+    const __m128i agMask = _mm_set1_epi32(0xFF00FF00);
+    const __m128i rMask = _mm_set1_epi32(0x000000FF);
+    const __m128i bMask = _mm_set1_epi32(0x00FF0000);
+    const __m128i aMask = _mm_set1_epi32(alphaMask);
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i y = _mm_and_si128(x, agMask);
+        y = _mm_or_si128(y, _mm_and_si128(_mm_srli_epi32(x, 16), rMask));
+        y = _mm_or_si128(y, _mm_and_si128(_mm_slli_epi32(x, 16), bMask));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_or_si128(y, aMask));
+    }
+    for (; i < numPixels; i++) {
+        uint32_t x;
+        memcpy(&x, src + i * 4, 4);
+        x = (x & 0xFF00FF00) | ((x >> 16) & 0xFF) | ((x & 0xFF) << 16) | alphaMask;
+        memcpy(dst + i * 4, &x, 4);
+    }
+}
+static void BGRA8888ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    SwapRB8888SSE(src, dst, numPixels, 0);
+}
+static void BGRX8888ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    SwapRB8888SSE(src, dst, numPixels, 0xFF000000);
+}
+static void RGBX8888ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i aMask = _mm_set1_epi32(0xFF000000);
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_or_si128(x, aMask));
+    }
+    RGBX8888ToRGBA8888(src + i * 4, dst + i * 4, numPixels - i, isGamma);
+}
+static void L8ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+
+    int i = 0;
+    for (; i + 16 <= numPixels; i += 16) {
+        __m128i l = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i ll = _mm_unpacklo_epi8(l, l);
+        __m128i la = _mm_unpacklo_epi8(l, ones);
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 16), _mm_unpackhi_epi16(ll, la));
+        ll = _mm_unpackhi_epi8(l, l);
+        la = _mm_unpackhi_epi8(l, ones);
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 32), _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 48), _mm_unpackhi_epi16(ll, la));
+    }
+    L8ToRGBA8888(src + i, dst + i * 4, numPixels - i, isGamma);
+}
+static void A8ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i ones = _mm_set1_epi8((char)0xFF);
+
+    int i = 0;
+    for (; i + 16 <= numPixels; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i fa = _mm_unpacklo_epi8(ones, a);
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_unpacklo_epi16(ones, fa));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 16), _mm_unpackhi_epi16(ones, fa));
+        fa = _mm_unpackhi_epi8(ones, a);
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 32), _mm_unpacklo_epi16(ones, fa));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 48), _mm_unpackhi_epi16(ones, fa));
+    }
+    A8ToRGBA8888(src + i, dst + i * 4, numPixels - i, isGamma);
+}
+static void LA88ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i lMask = _mm_set1_epi16(0x00FF);
+
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i la = _mm_loadu_si128((const __m128i *)(src + i * 2));
+        __m128i l = _mm_and_si128(la, lMask);
+        __m128i ll = _mm_or_si128(l, _mm_slli_epi16(l, 8));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_unpacklo_epi16(ll, la));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 16), _mm_unpackhi_epi16(ll, la));
+    }
+    LA88ToRGBA8888(src + i * 2, dst + i * 4, numPixels - i, isGamma);
+}
+static void RGBA8888ToA8Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+    for (; i + 16 <= numPixels; i += 16) {
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i * 4)), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i * 4 + 16)), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i * 4 + 32)), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(src + i * 4 + 48)), 24);
+        __m128i a = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+        _mm_storeu_si128((__m128i *)(dst + i), a);
+    }
+    RGBA8888ToA8(src + i * 4, dst + i, numPixels - i, isGamma);
+}
+
+// Interleaves 16-bit (r | g << 8) and (b | a << 8) lanes to 8 RGBA8888 pixels
+static BE_FORCE_INLINE void StoreRGBA8888SSE(byte *dst, __m128i rg, __m128i ba) {
+    _mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128((__m128i *)(dst + 16), _mm_unpackhi_epi16(rg, ba));
+}
+static void RGB565ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i mask3 = _mm_set1_epi16(0x03);
+    const __m128i mask7 = _mm_set1_epi16(0x07);
+    const __m128i maskF8 = _mm_set1_epi16(0xF8);
+    const __m128i maskFC = _mm_set1_epi16(0xFC);
+    const __m128i alpha = _mm_set1_epi16((short)0xFF00);
+
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+        __m128i r = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), maskF8), _mm_and_si128(_mm_srli_epi16(v, 2), mask7));
+        __m128i g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 3), maskFC), _mm_and_si128(_mm_srli_epi16(v, 9), mask3));
+        __m128i b = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 8), maskF8), _mm_srli_epi16(v, 13));
+        StoreRGBA8888SSE(dst + i * 4, _mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, alpha));
+    }
+    RGB565ToRGBA8888(src + i * 2, dst + i * 4, numPixels - i, isGamma);
+}
+static void RGBA4444ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i mask = _mm_set1_epi16(0x0F0F);
+
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+        // Nibbles to bytes by replicating them, bytes of rb are r, b and bytes of ga are g, a
+        __m128i rb = _mm_and_si128(v, mask);
+        __m128i ga = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        rb = _mm_or_si128(rb, _mm_slli_epi16(rb, 4));
+        ga = _mm_or_si128(ga, _mm_slli_epi16(ga, 4));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), _mm_unpacklo_epi8(rb, ga));
+        _mm_storeu_si128((__m128i *)(dst + i * 4 + 16), _mm_unpackhi_epi8(rb, ga));
+    }
+    RGBA4444ToRGBA8888(src + i * 2, dst + i * 4, numPixels - i, isGamma);
+}
+static void RGBA5551ToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i mask7 = _mm_set1_epi16(0x07);
+    const __m128i maskF8 = _mm_set1_epi16(0xF8);
+    const __m128i alphaMask = _mm_set1_epi16((short)0xFF00);
+
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i * 2));
+        __m128i r = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), maskF8), _mm_and_si128(_mm_srli_epi16(v, 2), mask7));
+        __m128i g = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 2), maskF8), _mm_and_si128(_mm_srli_epi16(v, 7), mask7));
+        __m128i b = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 7), maskF8), _mm_and_si128(_mm_srli_epi16(v, 12), mask7));
+        __m128i a = _mm_and_si128(_mm_srai_epi16(v, 15), alphaMask);
+        StoreRGBA8888SSE(dst + i * 4, _mm_or_si128(r, _mm_slli_epi16(g, 8)), _mm_or_si128(b, a));
+    }
+    RGBA5551ToRGBA8888(src + i * 2, dst + i * 4, numPixels - i, isGamma);
+}
+
+// Packs 32-bit lanes holding 16-bit values into 16-bit lanes without signed saturation
+static BE_FORCE_INLINE __m128i Pack16SSE(__m128i lo, __m128i hi) {
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+static BE_FORCE_INLINE __m128i ShiftAndMaskSSE(__m128i x, int shift, int mask) {
+    return _mm_and_si128(_mm_srli_epi32(x, shift), _mm_set1_epi32(mask));
+}
+static BE_FORCE_INLINE __m128i RGBA8888To565SSE(__m128i x) {
+    return _mm_or_si128(_mm_or_si128(ShiftAndMaskSSE(x, 3, 0x1F), ShiftAndMaskSSE(x, 5, 0x7E0)), ShiftAndMaskSSE(x, 8, 0xF800));
+}
+static BE_FORCE_INLINE __m128i RGBA8888To4444SSE(__m128i x) {
+    return _mm_or_si128(_mm_or_si128(ShiftAndMaskSSE(x, 4, 0xF), ShiftAndMaskSSE(x, 8, 0xF0)), _mm_or_si128(ShiftAndMaskSSE(x, 12, 0xF00), ShiftAndMaskSSE(x, 16, 0xF000)));
+}
+static BE_FORCE_INLINE __m128i RGBA8888To5551SSE(__m128i x) {
+    return _mm_or_si128(_mm_or_si128(ShiftAndMaskSSE(x, 3, 0x1F), ShiftAndMaskSSE(x, 6, 0x3E0)), _mm_or_si128(ShiftAndMaskSSE(x, 9, 0x7C00), ShiftAndMaskSSE(x, 16, 0x8000)));
+}
+static void RGBA8888ToRGB565Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i lo = RGBA8888To565SSE(_mm_loadu_si128((const __m128i *)(src + i * 4)));
+        __m128i hi = RGBA8888To565SSE(_mm_loadu_si128((const __m128i *)(src + i * 4 + 16)));
+        _mm_storeu_si128((__m128i *)(dst + i * 2), Pack16SSE(lo, hi));
+    }
+    RGBA8888ToRGB565(src + i * 4, dst + i * 2, numPixels - i, isGamma);
+}
+static void RGBA8888ToRGBA4444Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i lo = RGBA8888To4444SSE(_mm_loadu_si128((const __m128i *)(src + i * 4)));
+        __m128i hi = RGBA8888To4444SSE(_mm_loadu_si128((const __m128i *)(src + i * 4 + 16)));
+        _mm_storeu_si128((__m128i *)(dst + i * 2), Pack16SSE(lo, hi));
+    }
+    RGBA8888ToRGBA4444(src + i * 4, dst + i * 2, numPixels - i, isGamma);
+}
+static void RGBA8888ToRGBA5551Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    int i = 0;
+    for (; i + 8 <= numPixels; i += 8) {
+        __m128i lo = RGBA8888To5551SSE(_mm_loadu_si128((const __m128i *)(src + i * 4)));
+        __m128i hi = RGBA8888To5551SSE(_mm_loadu_si128((const __m128i *)(src + i * 4 + 16)));
+        _mm_storeu_si128((__m128i *)(dst + i * 2), Pack16SSE(lo, hi));
+    }
+    RGBA8888ToRGBA5551(src + i * 4, dst + i * 2, numPixels - i, isGamma);
+}
+
+static void RGBA8888ToRGBA32FDirect(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const float invNorm = 1.0f / 255.0f;
+    float *dstPtr = (float *)dst;
+
+    if (isGamma) {
+        for (int i = 0; i < numPixels; i++, src += 4, dstPtr += 4) {
+            dstPtr[0] = gammaToLinearTable[src[0]];
+            dstPtr[1] = gammaToLinearTable[src[1]];
+            dstPtr[2] = gammaToLinearTable[src[2]];
+            dstPtr[3] = src[3] * invNorm;
+        }
+        return;
+    }
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(invNorm);
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i * 4));
+        __m128i lo = _mm_unpacklo_epi8(x, zero);
+        __m128i hi = _mm_unpackhi_epi8(x, zero);
+        _mm_storeu_ps(dstPtr + i * 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dstPtr + i * 4 + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dstPtr + i * 4 + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(dstPtr + i * 4 + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+    for (; i < numPixels * 4; i++) {
+        dstPtr[i] = src[i] * invNorm;
+    }
+}
+
+// Same as Math::Ftob(255 * x) on 16 floats
+static BE_FORCE_INLINE __m128i FloatToByte16SSE(__m128 x0, __m128 x1, __m128 x2, __m128 x3) {
+    const __m128 scale = _mm_set1_ps(255.0f);
+    const __m128 zero = _mm_setzero_ps();
+
+    __m128i i0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x0, scale), zero), scale));
+    __m128i i1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x1, scale), zero), scale));
+    __m128i i2 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x2, scale), zero), scale));
+    __m128i i3 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(x3, scale), zero), scale));
+    return _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3));
+}
+static void RGBA32FToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const float *srcPtr = (const float *)src;
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i x = FloatToByte16SSE(_mm_loadu_ps(srcPtr + i * 4), _mm_loadu_ps(srcPtr + i * 4 + 4), _mm_loadu_ps(srcPtr + i * 4 + 8), _mm_loadu_ps(srcPtr + i * 4 + 12));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), x);
+    }
+    RGBA32FToRGBA8888((const byte *)(srcPtr + i * 4), dst + i * 4, numPixels - i, isGamma);
+}
+
+// Converts 4 halfs in the low 16 bits of 32-bit lanes to floats.
+// Denormals are converted as integers so that the result does not depend on the denormals-are-zero mode.
+// INF and NaN are converted to zero, F16Converter::ToF32 returns tiny denormals for them which are also 0 as bytes.
+static BE_FORCE_INLINE __m128 HalfToFloatSSE(__m128i h) {
+    const __m128i expMantMask = _mm_set1_epi32(0x7FFF);
+    const __m128i expMask = _mm_set1_epi32(0x7C00);
+    const __m128i mantMask = _mm_set1_epi32(0x03FF);
+    const __m128i expBias = _mm_set1_epi32((127 - 15) << 23);
+    const __m128 denormScale = _mm_set1_ps(1.0f / (1 << 24));
+
+    __m128i exp = _mm_and_si128(h, expMask);
+    __m128i sign = _mm_slli_epi32(_mm_srli_epi32(h, 15), 31);
+    __m128i normal = _mm_add_epi32(_mm_slli_epi32(_mm_and_si128(h, expMantMask), 13), expBias);
+    __m128 denormal = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(h, mantMask)), denormScale);
+
+    __m128i isDenormal = _mm_cmpeq_epi32(exp, _mm_setzero_si128());
+    __m128i isSpecial = _mm_cmpeq_epi32(exp, expMask);
+
+    __m128i bits = _mm_or_si128(_mm_and_si128(isDenormal, _mm_castps_si128(denormal)), _mm_andnot_si128(isDenormal, normal));
+    bits = _mm_andnot_si128(isSpecial, bits);
+    return _mm_castsi128_ps(_mm_or_si128(bits, sign));
+}
+static void RGBA16FToRGBA8888Direct(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= numPixels; i += 4) {
+        __m128i h0 = _mm_loadu_si128((const __m128i *)(src + i * 8));
+        __m128i h1 = _mm_loadu_si128((const __m128i *)(src + i * 8 + 16));
+        __m128i x = FloatToByte16SSE(HalfToFloatSSE(_mm_unpacklo_epi16(h0, zero)), HalfToFloatSSE(_mm_unpackhi_epi16(h0, zero)), 
+            HalfToFloatSSE(_mm_unpacklo_epi16(h1, zero)), HalfToFloatSSE(_mm_unpackhi_epi16(h1, zero)));
+        _mm_storeu_si128((__m128i *)(dst + i * 4), x);
+    }
+    RGBA16FToRGBA8888(src + i * 8, dst + i * 4, numPixels - i, isGamma);
+}
+
+#endif
+
+// 8-bit to half conversion tables
+struct ByteToHalfTable {
+    ByteToHalfTable() {
+        const float invNorm = 1.0f / 255.0f;
+
+        for (int i = 0; i < 256; i++) {
+            linear[i] = F16Converter::FromF32(i * invNorm);
+            gamma[i] = F16Converter::FromF32(gammaToLinearTable[i]);
+        }
+    }
+
+    float16_t linear[256];
+    float16_t gamma[256];
+};
+
+static const ByteToHalfTable &GetByteToHalfTable() {
+    static const ByteToHalfTable table;
+    return table;
+}
+
+static void RGBA8888ToRGBA16FDirect(const byte *src, byte *dst, int numPixels, bool isGamma) {
+    const ByteToHalfTable &table = GetByteToHalfTable();
+    const float16_t *rgbTable = isGamma ? table.gamma : table.linear;
+    const byte *srcEnd = src + numPixels * 4;
+    float16_t *dstPtr = (float16_t *)dst;
+
+    for (; src < srcEnd; src += 4, dstPtr += 4) {
+        dstPtr[0] = rgbTable[src[0]];
+        dstPtr[1] = rgbTable[src[1]];
+        dstPtr[2] = rgbTable[src[2]];
+        dstPtr[3] = table.linear[src[3]];
+    }
+}
+
+struct ImageDirectConvert {
+    Image::Format::Enum     srcFormat;
+    Image::Format::Enum     dstFormat;
+    ImageConvertFunc        convertFunc;        // conversion in linear space
+    ImageConvertFunc        convertGammaFunc;   // conversion in gamma space
+};
+
+static const ImageDirectConvert imageDirectConvertTable[] = {
+    { Image::Format::RGB_8_8_8,             Image::Format::RGBA_8_8_8_8,            RGB888ToRGBA8888Direct, RGB888ToRGBA8888Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGB_8_8_8,               RGBA8888ToRGB888Direct, RGBA8888ToRGB888Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGBA_16F_16F_16F_16F,    RGBA8888ToRGBA16FDirect, RGBA8888ToRGBA16FDirect },
+#if defined(__X86__)
+    { Image::Format::BGRA_8_8_8_8,          Image::Format::RGBA_8_8_8_8,            BGRA8888ToRGBA8888Direct, BGRA8888ToRGBA8888Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::BGRA_8_8_8_8,            BGRA8888ToRGBA8888Direct, BGRA8888ToRGBA8888Direct },
+    { Image::Format::BGRX_8_8_8_8,          Image::Format::RGBA_8_8_8_8,            BGRX8888ToRGBA8888Direct, BGRX8888ToRGBA8888Direct },
+    { Image::Format::RGBX_8_8_8_8,          Image::Format::RGBA_8_8_8_8,            RGBX8888ToRGBA8888Direct, RGBX8888ToRGBA8888Direct },
+    { Image::Format::L_8,                   Image::Format::RGBA_8_8_8_8,            L8ToRGBA8888Direct, L8ToRGBA8888Direct },
+    { Image::Format::A_8,                   Image::Format::RGBA_8_8_8_8,            A8ToRGBA8888Direct, A8ToRGBA8888Direct },
+    { Image::Format::LA_8_8,                Image::Format::RGBA_8_8_8_8,            LA88ToRGBA8888Direct, LA88ToRGBA8888Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::A_8,                     RGBA8888ToA8Direct, RGBA8888ToA8Direct },
+    { Image::Format::RGB_5_6_5,             Image::Format::RGBA_8_8_8_8,            RGB565ToRGBA8888Direct, RGB565ToRGBA8888Direct },
+    { Image::Format::RGBA_4_4_4_4,          Image::Format::RGBA_8_8_8_8,            RGBA4444ToRGBA8888Direct, RGBA4444ToRGBA8888Direct },
+    { Image::Format::RGBA_5_5_5_1,          Image::Format::RGBA_8_8_8_8,            RGBA5551ToRGBA8888Direct, RGBA5551ToRGBA8888Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGB_5_6_5,               RGBA8888ToRGB565Direct, RGBA8888ToRGB565Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGBA_4_4_4_4,            RGBA8888ToRGBA4444Direct, RGBA8888ToRGBA4444Direct },
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGBA_5_5_5_1,            RGBA8888ToRGBA5551Direct, RGBA8888ToRGBA5551Direct },
+    // Gamma space conversions from float need pow per component, they use the unpack/pack path
+    { Image::Format::RGBA_8_8_8_8,          Image::Format::RGBA_32F_32F_32F_32F,    RGBA8888ToRGBA32FDirect, RGBA8888ToRGBA32FDirect },
+    { Image::Format::RGBA_32F_32F_32F_32F,  Image::Format::RGBA_8_8_8_8,            RGBA32FToRGBA8888Direct, nullptr },
+    { Image::Format::RGBA_16F_16F_16F_16F,  Image::Format::RGBA_8_8_8_8,            RGBA16FToRGBA8888Direct, nullptr },
+#endif
+};
+
+ImageConvertFunc GetImageDirectConvertFunc(Image::Format::Enum srcFormat, Image::Format::Enum dstFormat, bool isGamma) {
+    for (int i = 0; i < COUNT_OF(imageDirectConvertTable); i++) {
+        const ImageDirectConvert &entry = imageDirectConvertTable[i];
+
+        if (entry.srcFormat == srcFormat && entry.dstFormat == dstFormat) {
+            return isGamma ? entry.convertGammaFunc : entry.convertFunc;
+        }
+    }
+    return nullptr;
+}
+
 BE_NAMESPACE_END
@@ -21,6 +21,7 @@ BE_NAMESPACE_BEGIN
 //--------------------------------------------------------------------------------------------------
 using ImageUnpackFunc = void(*)(const byte *src, byte *dst, int numPixels, bool isGamma);
 using ImagePackFunc = void(*)(const byte *src, byte *dst, int numPixels, bool isGamma);
+using ImageConvertFunc = void(*)(const byte *src, byte *dst, int numPixels, bool isGamma);
 
 struct ImageFormatInfo {
     const char *name;
@@ -70,6 +71,9 @@ bool CompressedFormatMinDimensions(Image::Format::Enum imageFormat, int &minWidt
 
 const ImageFormatInfo *GetImageFormatInfo(Image::Format::Enum imageFormat);
 
+// Returns the direct conversion function between two formats, or nullptr if the conversion has to go through unpack/pack functions.
+ImageConvertFunc GetImageDirectConvertFunc(Image::Format::Enum srcFormat, Image::Format::Enum dstFormat, bool isGamma);
+
 void RGBToYCoCg(short *YCoCg, const byte *rgb, int stride);
 void RGBAToYCoCgA(short *YCoCgA, const byte *rgba, int stride);
 void YCoCgToRGB(byte *rgb, int stride, const short *YCoCg);
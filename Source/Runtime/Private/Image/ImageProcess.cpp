@@ -15,10 +15,15 @@
 #include "Precompiled.h"
 #include "Core/Str.h"
 #include "Core/Heap.h"
+#include "Core/JobSystem.h"
 #include "Math/Math.h"
 #include "Image/Image.h"
 #include "ImageInternal.h"
 
+#if defined(__X86__)
+#include <emmintrin.h>
+#endif
+
 BE_NAMESPACE_BEGIN
 
 // gammaToLinearTable[i] = (i/255)^2.2
@@ -271,11 +276,99 @@ Image &Image::AddNormalMapRGBA8888(const Image &normalMap) {
     return *this;
 }
 
+// Number of destination rows built in a single tile
+static const int MipmapRowsPerTile = 16;
+
+// Mipmaps are always a 2:1 reduction, so windowed filters use the same 12 taps for every destination pixel.
+// Taps of destination pixel x are the source pixels 2x - 5 ... 2x + 6.
+static const int MipmapFilterTaps = 12;
+static const int MipmapFilterFirstTap = -5;
+
+enum MipmapSampleType {
+    ByteSample,
+    ByteGammaSample,
+    HalfSample,
+    FloatSample
+};
+
+// Converts linear values to gamma space bytes without calling pow per component.
+// The result is identical with Ftob(255 * x^(1/2.2)).
+struct LinearToGammaTable {
+    // Linear values below 2^-18 are converted to 0
+    static const int MinExponent = -18;
+    // 256 buckets for each exponent in [2^-18, 1) indexed by the 8 high bits of mantissa
+    static const int NumBuckets = -MinExponent * 256;
+
+    LinearToGammaTable() {
+        thresholds[0] = 0.0f;
+
+        for (int i = 1; i < 256; i++) {
+            float x = Math::Pow(i / 255.0f, 2.2f);
+            // Walk to the exact boundary so that the result is identical with the pow based conversion
+            while (LinearToGammaExact(x) < i) {
+                x = nextafterf(x, 2.0f);
+            }
+            while (x > 0.0f && LinearToGammaExact(nextafterf(x, 0.0f)) >= i) {
+                x = nextafterf(x, 0.0f);
+            }
+            thresholds[i] = x;
+        }
+        // Sentinel, never reached because values >= 1 are handled before lookup
+        thresholds[256] = 2.0f;
+
+        // Gamma value of each bucket start. Output changes at most by one inside a bucket
+        // because the bucket width is 1/256 of the bucket start.
+        int i = 0;
+        for (int bucket = 0; bucket < NumBuckets; bucket++) {
+            uint32_t bits = (uint32_t)((127 + MinExponent) * 256 + bucket) << 15;
+            float x;
+            memcpy(&x, &bits, sizeof(x));
+
+            while (i < 255 && x >= thresholds[i + 1]) {
+                i++;
+            }
+            buckets[bucket] = (byte)i;
+        }
+    }
+
+    static int LinearToGammaExact(float x) {
+        return Math::Ftob(255.0f * Math::Pow(x, 1.0f / 2.2f));
+    }
+
+    BE_FORCE_INLINE byte Convert(float x) const {
+        if (x < 1.0f / (1 << -MinExponent)) {
+            return 0;
+        }
+        if (x >= 1.0f) {
+            return 255;
+        }
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        int i = buckets[(bits >> 15) - (127 + MinExponent) * 256];
+        return (byte)(i + (x >= thresholds[i + 1] ? 1 : 0));
+    }
+
+    float thresholds[257];
+    byte buckets[NumBuckets];
+};
+
+static const LinearToGammaTable *GetLinearToGammaTable() {
+    static const LinearToGammaTable table;
+    return &table;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Box filter
+//
+// Every destination pixel averages the source pixels 2x and 2x + 1 in each dimension.
+// Odd sizes drop the last source pixel, dimensions of size 1 are not filtered.
+//-------------------------------------------------------------------------------------------------
+
 template <typename T>
-void BuildMipMap1D(T *dst, const T *src, const int width, const int components) {
-    int xOff = (width  < 2) ? 0 : components;
+static void BoxFilterRow1D(T *dst, const T *src, const int width, const int dstWidth, const int components) {
+    const int xOff = (width < 2) ? 0 : components;
 
-    for (int x = 0; x < width; x += 2) {
+    for (int x = 0; x < dstWidth; x++) {
         for (int i = 0; i < components; i++) {
             *dst++ = (src[0] + src[xOff]) / 2;
             src++;
@@ -285,114 +378,463 @@ void BuildMipMap1D(T *dst, const T *src, const int width, const int components)
 }
 
 template <typename T>
-void BuildMipMap2D(T *dst, const T *src, const int width, const int height, const int components) {
-    int xOff = (width  < 2) ? 0 : components;
-    int yOff = (height < 2) ? 0 : components * width;
-
-    for (int y = 0; y < height; y += 2) {
-        for (int x = 0; x < width; x += 2) {
-            for (int i = 0; i < components; i++) {
-                *dst++ = (src[0] + src[xOff] + src[yOff] + src[yOff + xOff]) / 4;
-                src++;
-            }
-            src += xOff;
+static void BoxFilterRow2D(T *dst, const T *row0, const T *row1, const int width, const int dstWidth, const int components) {
+    const int xOff = (width < 2) ? 0 : components;
+
+    for (int x = 0; x < dstWidth; x++) {
+        for (int i = 0; i < components; i++) {
+            *dst++ = (row0[0] + row0[xOff] + row1[0] + row1[xOff]) / 4;
+            row0++;
+            row1++;
         }
-        src += yOff;
+        row0 += xOff;
+        row1 += xOff;
     }
 }
 
 template <typename T>
-void BuildMipMap3D(T *dst, const T *src, const int width, const int height, const int depth, const int components) {
-    int xOff = (width  < 2) ? 0 : components;
-    int yOff = (height < 2) ? 0 : components * width;
-    int zOff = (depth  < 2) ? 0 : components * width * height;
-
-    for (int z = 0; z < depth; z += 2) {
-        for (int y = 0; y < height; y += 2) {
-            for (int x = 0; x < width; x += 2) {
-                for (int i = 0; i < components; i++) {
-                    *dst++ = (src[0] + src[xOff] + src[yOff] + src[yOff + xOff] + src[zOff] + src[zOff + xOff] + src[zOff + yOff] + src[zOff + yOff + xOff]) / 8;
-                    src++;
-                }
-                src += xOff;
-            }
-            src += yOff;
+static void BoxFilterRow3D(T *dst, const T *row00, const T *row01, const T *row10, const T *row11, const int width, const int dstWidth, const int components) {
+    const int xOff = (width < 2) ? 0 : components;
+
+    for (int x = 0; x < dstWidth; x++) {
+        for (int i = 0; i < components; i++) {
+            *dst++ = (row00[0] + row00[xOff] + row01[0] + row01[xOff] + row10[0] + row10[xOff] + row11[0] + row11[xOff]) / 8;
+            row00++;
+            row01++;
+            row10++;
+            row11++;
         }
-        src += zOff;
+        row00 += xOff;
+        row01 += xOff;
+        row10 += xOff;
+        row11 += xOff;
     }
 }
 
+// Box filter of two rows with SIMD kernels for the common formats.
 template <typename T>
-void BuildMipMap(T *dst, const T *src, const int width, const int height, const int depth, const int components) {
-    if (depth > 1) {
-        BuildMipMap3D(dst, src, width, height, depth, components);
-    } else if (height > 1) {
-        BuildMipMap2D(dst, src, width, height, components);
-    } else {
-        BuildMipMap1D(dst, src, width, components);
+static void BoxFilterRow2DSIMD(T *dst, const T *row0, const T *row1, const int width, const int dstWidth, const int components) {
+    BoxFilterRow2D(dst, row0, row1, width, dstWidth, components);
+}
+
+#if defined(__X86__)
+
+// 8-bit 2x2 box filter with SSE2. The sums are done in 16 bits and truncated like the scalar version.
+static void BoxFilterRow2DSIMD(byte *dst, const byte *row0, const byte *row1, const int width, const int dstWidth, const int components) {
+    if (components != 1 && components != 2 && components != 4) {
+        BoxFilterRow2D(dst, row0, row1, width, dstWidth, components);
+        return;
     }
+
+    // Each iteration reads 16 bytes of two rows and writes 8 bytes
+    int numIterations = (width * components) / 16;
+    int numPixels = numIterations * (8 / components);
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+
+    for (int i = 0; i < numIterations; i++) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(row0 + i * 16));
+        __m128i b = _mm_loadu_si128((const __m128i *)(row1 + i * 16));
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+        __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        __m128i sum;
+
+        if (components == 4) {
+            sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+        } else if (components == 2) {
+            lo = _mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0));
+            hi = _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0));
+            sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+        } else {
+            sum = _mm_packs_epi32(_mm_madd_epi16(lo, one), _mm_madd_epi16(hi, one));
+        }
+
+        sum = _mm_srli_epi16(sum, 2);
+        _mm_storel_epi64((__m128i *)(dst + i * 8), _mm_packus_epi16(sum, sum));
+    }
+
+    // Remaining pixels
+    int offset = numPixels * 2 * components;
+    BoxFilterRow2D(dst + numPixels * components, row0 + offset, row1 + offset, width - numPixels * 2, dstWidth - numPixels, components);
 }
 
-void BuildMipMap1DWithGamma(byte *dst, const byte *src, const int width, const int components) {
-    int xOff = (width < 2) ? 0 : components;
+// 32-bit float RGBA 2x2 box filter with SSE. Additions are in the same order as the scalar version.
+static void BoxFilterRow2DSIMD(float *dst, const float *row0, const float *row1, const int width, const int dstWidth, const int components) {
+    if (components != 4) {
+        BoxFilterRow2D(dst, row0, row1, width, dstWidth, components);
+        return;
+    }
+
+    const __m128 quarter = _mm_set1_ps(0.25f);
 
-    for (int x = 0; x < width; x += 2) {
+    const int xOff = (width < 2) ? 0 : 4;
+
+    for (int x = 0; x < dstWidth; x++) {
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(row0), _mm_loadu_ps(row0 + xOff));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(row1));
+        sum = _mm_add_ps(sum, _mm_loadu_ps(row1 + xOff));
+        _mm_storeu_ps(dst, _mm_mul_ps(sum, quarter));
+        dst += 4;
+        row0 += 4 + xOff;
+        row1 += 4 + xOff;
+    }
+}
+
+#endif
+
+static void GammaBoxFilterRow1D(byte *dst, const byte *src, const int width, const int dstWidth, const int components, const LinearToGammaTable *gammaTable) {
+    const int xOff = (width < 2) ? 0 : components;
+
+    for (int x = 0; x < dstWidth; x++) {
         for (int i = 0; i < components; i++) {
-            *dst++ = Math::Ftob(255.0f * Math::Pow(0.5f * (gammaToLinearTable[src[0]] + gammaToLinearTable[src[xOff]]), 1.0f / 2.2f));
+            *dst++ = gammaTable->Convert(0.5f * (gammaToLinearTable[src[0]] + gammaToLinearTable[src[xOff]]));
             src++;
         }
         src += xOff;
     }
 }
 
-void BuildMipMap2DWithGamma(byte *dst, const byte *src, const int width, const int height, const int components) {
-    int xOff = (width < 2) ? 0 : components;
-    int yOff = (height < 2) ? 0 : components * width;
+static void GammaBoxFilterRow2D(byte *dst, const byte *row0, const byte *row1, const int width, const int dstWidth, const int components, const LinearToGammaTable *gammaTable) {
+    const int xOff = (width < 2) ? 0 : components;
 
-    for (int y = 0; y < height; y += 2) {
-        for (int x = 0; x < width; x += 2) {
-            for (int i = 0; i < components; i++) {
-                *dst++ = Math::Ftob(255.0f * Math::Pow(0.25f * (gammaToLinearTable[src[0]] + gammaToLinearTable[src[xOff]] + gammaToLinearTable[src[yOff]] + gammaToLinearTable[src[yOff + xOff]]), 1.0f / 2.2f));
-                src++;
-            }
-            src += xOff;
+    for (int x = 0; x < dstWidth; x++) {
+        for (int i = 0; i < components; i++) {
+            *dst++ = gammaTable->Convert(0.25f * (gammaToLinearTable[row0[0]] + gammaToLinearTable[row0[xOff]] + gammaToLinearTable[row1[0]] + gammaToLinearTable[row1[xOff]]));
+            row0++;
+            row1++;
         }
-        src += yOff;
+        row0 += xOff;
+        row1 += xOff;
     }
 }
 
-void BuildMipMap3DWithGamma(byte *dst, const byte *src, const int width, const int height, const int depth, const int components) {
-    int xOff = (width < 2) ? 0 : components;
-    int yOff = (height < 2) ? 0 : components * width;
-    int zOff = (depth < 2) ? 0 : components * width * height;
-
-    for (int z = 0; z < depth; z += 2) {
-        for (int y = 0; y < height; y += 2) {
-            for (int x = 0; x < width; x += 2) {
-                for (int i = 0; i < components; i++) {
-                    *dst++ = Math::Ftob(255.0f * Math::Pow(0.125f * (gammaToLinearTable[src[0]] + gammaToLinearTable[src[xOff]] + gammaToLinearTable[src[yOff]] + gammaToLinearTable[src[yOff + xOff]] +
-                        gammaToLinearTable[src[zOff]] + gammaToLinearTable[src[zOff + xOff]] + gammaToLinearTable[src[zOff + yOff]] + gammaToLinearTable[src[zOff + yOff + xOff]]), 1.0f / 2.2f));
-                    src++;
-                }
-                src += xOff;
+static void GammaBoxFilterRow3D(byte *dst, const byte *row00, const byte *row01, const byte *row10, const byte *row11, const int width, const int dstWidth, const int components, const LinearToGammaTable *gammaTable) {
+    const int xOff = (width < 2) ? 0 : components;
+
+    for (int x = 0; x < dstWidth; x++) {
+        for (int i = 0; i < components; i++) {
+            *dst++ = gammaTable->Convert(0.125f * (gammaToLinearTable[row00[0]] + gammaToLinearTable[row00[xOff]] + gammaToLinearTable[row01[0]] + gammaToLinearTable[row01[xOff]] +
+                gammaToLinearTable[row10[0]] + gammaToLinearTable[row10[xOff]] + gammaToLinearTable[row11[0]] + gammaToLinearTable[row11[xOff]]));
+            row00++;
+            row01++;
+            row10++;
+            row11++;
+        }
+        row00 += xOff;
+        row01 += xOff;
+        row10 += xOff;
+        row11 += xOff;
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+// Windowed filters
+//-------------------------------------------------------------------------------------------------
+
+static double Sinc(double x) {
+    if (fabs(x) < 1e-6) {
+        return 1.0;
+    }
+    double pix = Math::Pi * x;
+    return sin(pix) / pix;
+}
+
+// Zeroth order modified Bessel function of the first kind
+static double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 32; k++) {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+// Computes normalized weights of the 12 taps for the 2:1 reduction.
+static void ComputeMipmapFilterWeights(Image::MipmapFilter::Enum filter, float *weights) {
+    // Kernel width in destination pixels
+    const double kernelWidth = 3.0;
+    // Kaiser window shape parameter
+    const double kaiserAlpha = 4.0;
+
+    double w[MipmapFilterTaps];
+    double sum = 0.0;
+
+    for (int k = 0; k < MipmapFilterTaps; k++) {
+        // Distance between the source pixel center and the destination pixel center in destination pixels
+        double x = (k + MipmapFilterFirstTap - 0.5) * 0.5;
+        double t = x / kernelWidth;
+
+        if (t * t >= 1.0) {
+            w[k] = 0.0;
+        } else if (filter == Image::MipmapFilter::Kaiser) {
+            w[k] = Sinc(x) * BesselI0(kaiserAlpha * sqrt(1.0 - t * t)) / BesselI0(kaiserAlpha);
+        } else {
+            w[k] = Sinc(x) * Sinc(t);
+        }
+        sum += w[k];
+    }
+
+    for (int k = 0; k < MipmapFilterTaps; k++) {
+        weights[k] = (float)(w[k] / sum);
+    }
+}
+
+static void ConvertRowToFloat(float *dst, const byte *src, const int count, MipmapSampleType sampleType) {
+    switch (sampleType) {
+    case ByteSample:
+        for (int i = 0; i < count; i++) {
+            dst[i] = (float)src[i];
+        }
+        break;
+    case ByteGammaSample:
+        for (int i = 0; i < count; i++) {
+            dst[i] = gammaToLinearTable[src[i]];
+        }
+        break;
+    case HalfSample:
+        for (int i = 0; i < count; i++) {
+            dst[i] = (float)((const half *)src)[i];
+        }
+        break;
+    case FloatSample:
+        memcpy(dst, src, count * sizeof(float));
+        break;
+    }
+}
+
+static void ConvertRowFromFloat(byte *dst, const float *src, const int count, MipmapSampleType sampleType, const LinearToGammaTable *gammaTable) {
+    switch (sampleType) {
+    case ByteSample:
+        for (int i = 0; i < count; i++) {
+            dst[i] = Math::Ftob(src[i] + 0.5f);
+        }
+        break;
+    case ByteGammaSample:
+        for (int i = 0; i < count; i++) {
+            dst[i] = gammaTable->Convert(src[i]);
+        }
+        break;
+    case HalfSample:
+        for (int i = 0; i < count; i++) {
+            ((half *)dst)[i] = half(src[i]);
+        }
+        break;
+    case FloatSample:
+        memcpy(dst, src, count * sizeof(float));
+        break;
+    }
+}
+
+// dst[i] = sum of weights[k] * rows[k][i]
+static void FilterColumns(float *dst, const float **rows, const float *weights, const int count) {
+    int i = 0;
+#if defined(__X86__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_mul_ps(_mm_load1_ps(&weights[0]), _mm_load_ps(rows[0] + i));
+        for (int k = 1; k < MipmapFilterTaps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(&weights[k]), _mm_load_ps(rows[k] + i)));
+        }
+        _mm_store_ps(dst + i, sum);
+    }
+#endif
+    for (; i < count; i++) {
+        float sum = 0.0f;
+        for (int k = 0; k < MipmapFilterTaps; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        dst[i] = sum;
+    }
+}
+
+static void FilterRow(float *dst, const float *src, const int width, const int dstWidth, const int components, const float *weights) {
+#if defined(__X86__)
+    if (components == 4) {
+        for (int x = 0; x < dstWidth; x++) {
+            __m128 sum = _mm_setzero_ps();
+            for (int k = 0; k < MipmapFilterTaps; k++) {
+                int sx = Min(Max(2 * x + MipmapFilterFirstTap + k, 0), width - 1);
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(&weights[k]), _mm_load_ps(src + sx * 4)));
             }
-            src += yOff;
+            _mm_storeu_ps(dst + x * 4, sum);
+        }
+        return;
+    }
+#endif
+    for (int x = 0; x < dstWidth; x++) {
+        for (int i = 0; i < components; i++) {
+            float sum = 0.0f;
+            for (int k = 0; k < MipmapFilterTaps; k++) {
+                int sx = Min(Max(2 * x + MipmapFilterFirstTap + k, 0), width - 1);
+                sum += weights[k] * src[sx * components + i];
+            }
+            dst[x * components + i] = sum;
         }
-        src += zOff;
     }
 }
 
-void BuildMipMapWithGamma(byte *dst, const byte *src, const int width, const int height, const int depth, const int components) {
-    if (depth > 1) {
-        BuildMipMap3DWithGamma(dst, src, width, height, depth, components);
-    } else if (height > 1) {
-        BuildMipMap2DWithGamma(dst, src, width, height, components);
-    } else {
-        BuildMipMap1DWithGamma(dst, src, width, components);
+//-------------------------------------------------------------------------------------------------
+// Parallel mipmap generation
+//-------------------------------------------------------------------------------------------------
+
+struct MipmapTile {
+    const byte *            src;            // source slice
+    byte *                  dst;            // destination slice
+    int                     z;              // destination depth plane
+    int                     firstRow;       // first destination row
+    int                     numRows;        // number of destination rows
+};
+
+struct MipmapLevelData {
+    const MipmapTile *      tiles;
+    MipmapSampleType        sampleType;
+    Image::MipmapFilter::Enum filter;
+    int                     width;          // source dimensions
+    int                     height;
+    int                     depth;
+    int                     components;
+    const LinearToGammaTable *gammaTable;   // linear to gamma conversion table
+    const float *           weights;        // windowed filter weights
+};
+
+template <typename T>
+static void BuildMipMapTileBox(const MipmapLevelData &level, const MipmapTile &tile) {
+    const int w = level.width;
+    const int h = level.height;
+    const int d = level.depth;
+    const int c = level.components;
+    const int dstW = Max(w >> 1, 1);
+    const int dstH = Max(h >> 1, 1);
+
+    const T *src = (const T *)tile.src;
+    const int rowSize = w * c;
+    const int planeSize = rowSize * h;
+
+    const int z0 = 2 * tile.z;
+    const int z1 = (d < 2) ? z0 : z0 + 1;
+
+    for (int y = tile.firstRow; y < tile.firstRow + tile.numRows; y++) {
+        const int y0 = 2 * y;
+        const int y1 = (h < 2) ? y0 : y0 + 1;
+
+        T *dst = (T *)tile.dst + (tile.z * dstH + y) * dstW * c;
+
+        if (d > 1) {
+            BoxFilterRow3D(dst, src + z0 * planeSize + y0 * rowSize, src + z0 * planeSize + y1 * rowSize, 
+                src + z1 * planeSize + y0 * rowSize, src + z1 * planeSize + y1 * rowSize, w, dstW, c);
+        } else if (h > 1) {
+            BoxFilterRow2DSIMD(dst, src + y0 * rowSize, src + y1 * rowSize, w, dstW, c);
+        } else {
+            BoxFilterRow1D(dst, src, w, dstW, c);
+        }
+    }
+}
+
+static void BuildMipMapTileGammaBox(const MipmapLevelData &level, const MipmapTile &tile) {
+    const int w = level.width;
+    const int h = level.height;
+    const int d = level.depth;
+    const int c = level.components;
+    const int dstW = Max(w >> 1, 1);
+    const int dstH = Max(h >> 1, 1);
+
+    const byte *src = tile.src;
+    const int rowSize = w * c;
+    const int planeSize = rowSize * h;
+
+    const int z0 = 2 * tile.z;
+    const int z1 = (d < 2) ? z0 : z0 + 1;
+
+    for (int y = tile.firstRow; y < tile.firstRow + tile.numRows; y++) {
+        const int y0 = 2 * y;
+        const int y1 = (h < 2) ? y0 : y0 + 1;
+
+        byte *dst = tile.dst + (tile.z * dstH + y) * dstW * c;
+
+        if (d > 1) {
+            GammaBoxFilterRow3D(dst, src + z0 * planeSize + y0 * rowSize, src + z0 * planeSize + y1 * rowSize, 
+                src + z1 * planeSize + y0 * rowSize, src + z1 * planeSize + y1 * rowSize, w, dstW, c, level.gammaTable);
+        } else if (h > 1) {
+            GammaBoxFilterRow2D(dst, src + y0 * rowSize, src + y1 * rowSize, w, dstW, c, level.gammaTable);
+        } else {
+            GammaBoxFilterRow1D(dst, src, w, dstW, c, level.gammaTable);
+        }
+    }
+}
+
+// Separable windowed filter for 1D and 2D images. The source rows of the tile are converted to linear floats once,
+// filtered vertically and then horizontally.
+static void BuildMipMapTileWindowed(const MipmapLevelData &level, const MipmapTile &tile) {
+    const int w = level.width;
+    const int h = level.height;
+    const int c = level.components;
+    const int dstW = Max(w >> 1, 1);
+    const int sampleSize = level.sampleType == HalfSample ? sizeof(half) : (level.sampleType == FloatSample ? sizeof(float) : sizeof(byte));
+
+    const int rowSize = w * c;
+    // Keeps every row 16 bytes aligned
+    const int rowPitch = (rowSize + 3) & ~3;
+
+    const int firstSrcRow = Max(2 * tile.firstRow + MipmapFilterFirstTap, 0);
+    const int lastSrcRow = Min(2 * (tile.firstRow + tile.numRows - 1) + MipmapFilterFirstTap + MipmapFilterTaps - 1, h - 1);
+    const int numSrcRows = lastSrcRow - firstSrcRow + 1;
+
+    float *buffer = (float *)Mem_Alloc16((numSrcRows + 2) * rowPitch * sizeof(float));
+    float *srcRows = buffer;
+    float *columnRow = buffer + numSrcRows * rowPitch;
+    float *dstRow = columnRow + rowPitch;
+
+    for (int y = firstSrcRow; y <= lastSrcRow; y++) {
+        ConvertRowToFloat(srcRows + (y - firstSrcRow) * rowPitch, tile.src + y * rowSize * sampleSize, rowSize, level.sampleType);
+    }
+
+    const float *rows[MipmapFilterTaps];
+
+    for (int y = tile.firstRow; y < tile.firstRow + tile.numRows; y++) {
+        for (int k = 0; k < MipmapFilterTaps; k++) {
+            int sy = Min(Max(2 * y + MipmapFilterFirstTap + k, 0), h - 1);
+            rows[k] = srcRows + (sy - firstSrcRow) * rowPitch;
+        }
+
+        FilterColumns(columnRow, rows, level.weights, rowSize);
+
+        FilterRow(dstRow, columnRow, w, dstW, c, level.weights);
+
+        ConvertRowFromFloat(tile.dst + y * dstW * c * sampleSize, dstRow, dstW * c, level.sampleType, level.gammaTable);
+    }
+
+    Mem_AlignedFree(buffer);
+}
+
+static void BuildMipMapTile(const MipmapLevelData &level, const MipmapTile &tile) {
+    if (level.filter != Image::MipmapFilter::Box && level.depth == 1) {
+        BuildMipMapTileWindowed(level, tile);
+        return;
+    }
+
+    switch (level.sampleType) {
+    case ByteSample:
+        BuildMipMapTileBox<byte>(level, tile);
+        break;
+    case ByteGammaSample:
+        BuildMipMapTileGammaBox(level, tile);
+        break;
+    case HalfSample:
+        BuildMipMapTileBox<half>(level, tile);
+        break;
+    case FloatSample:
+        BuildMipMapTileBox<float>(level, tile);
+        break;
     }
 }
 
-Image &Image::GenerateMipmaps() {
+Image &Image::GenerateMipmaps(MipmapFilter::Enum filter) {
     if (IsCompressed()) {
         BE_WARNLOG("Couldn't generate mipmaps for a compressed image.\n");
         return *this;
@@ -403,34 +845,65 @@ Image &Image::GenerateMipmaps() {
         return *this;
     }
 
-    int numComponents = NumComponents();
+    float weights[MipmapFilterTaps];
+    if (filter != MipmapFilter::Box) {
+        ComputeMipmapFilterWeights(filter, weights);
+    }
+
+    MipmapLevelData level;
+    level.filter = filter;
+    level.components = NumComponents();
+    level.gammaTable = nullptr;
+    level.weights = weights;
+
+    if (IsFloatFormat()) {
+        level.sampleType = IsHalfFormat() ? HalfSample : FloatSample;
+    } else if (!(flags & Flag::LinearSpace)) {
+        level.sampleType = ByteGammaSample;
+        level.gammaTable = GetLinearToGammaTable();
+    } else {
+        level.sampleType = ByteSample;
+    }
 
+    Array<MipmapTile> tiles;
+
+    // Each level is built from the previous one, rows of all slices in a level are built in parallel
     for (int mipLevel = 0; mipLevel < numMipmaps - 1; mipLevel++) {
-        int w = GetWidth(mipLevel);
-        int h = GetHeight(mipLevel);
-        int d = GetDepth(mipLevel);
+        level.width = GetWidth(mipLevel);
+        level.height = GetHeight(mipLevel);
+        level.depth = GetDepth(mipLevel);
+
+        int dstHeight = GetHeight(mipLevel + 1);
+        int dstDepth = GetDepth(mipLevel + 1);
 
-        int srcSize = GetSliceSize(mipLevel, 1);
-        int dstSize = GetSliceSize(mipLevel + 1, 1);
+        tiles.SetCount(0, false);
 
         for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
-            byte *src = GetPixels(mipLevel, sliceIndex);
-            byte *dst = GetPixels(mipLevel + 1, sliceIndex);
-
-            if (IsFloatFormat()) {
-                if (IsHalfFormat()) {
-                    BuildMipMap<half>((half *)dst, (half *)src, w, h, d, numComponents);
-                } else {
-                    BuildMipMap<float>((float *)dst, (float *)src, w, h, d, numComponents);
-                }
-            } else {
-                if (!(flags & Flag::LinearSpace)) {
-                    BuildMipMapWithGamma(dst, src, w, h, d, numComponents);
-                } else {
-                    BuildMipMap(dst, src, w, h, d, numComponents);
+            MipmapTile tile;
+            tile.src = GetPixels(mipLevel, sliceIndex);
+            tile.dst = GetPixels(mipLevel + 1, sliceIndex);
+
+            for (int z = 0; z < dstDepth; z++) {
+                tile.z = z;
+
+                for (int y = 0; y < dstHeight; y += MipmapRowsPerTile) {
+                    tile.firstRow = y;
+                    tile.numRows = Min(MipmapRowsPerTile, dstHeight - y);
+
+                    tiles.Append(tile);
                 }
             }
         }
+
+        level.tiles = tiles.Ptr();
+
+        jobSystem.ParallelFor(tiles.Count(), 1, [](void *data, int begin, int end) {
+            const MipmapLevelData *level = (const MipmapLevelData *)data;
+
+            for (int tileIndex = begin; tileIndex < end; tileIndex++) {
+                BuildMipMapTile(*level, level->tiles[tileIndex]);
+            }
+        }, &level);
     }
 
     return *this;
@@ -15,157 +15,419 @@
 #include "Precompiled.h"
 #include "Core/Str.h"
 #include "Core/Heap.h"
+#include "Core/JobSystem.h"
 #include "Math/Math.h"
 #include "Image/Image.h"
 #include "ImageInternal.h"
 
+#if defined(__X86__)
+#include <emmintrin.h>
+#endif
+
 BE_NAMESPACE_BEGIN
 
-template <typename T>
-void ResizeImageNearest(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int numComponents) {
-    int srcPitch = srcWidth * numComponents;
+// Number of destination rows resized in a single tile
+static const int ResizeRowsPerTile = 16;
 
-    float ratioX = (float)srcWidth / dstWidth;
-    float ratioY = (float)srcHeight / dstHeight;
+// Rows are padded so that SIMD can load and store 4 components for every pixel
+static const int ResizeRowPadding = 4;
 
-    for (int y = 0; y < dstHeight; y++) {
-        int iY = y * ratioY;
+static int ResampleFilterTaps(Image::ResampleFilter::Enum filter) {
+    switch (filter) {
+    case Image::ResampleFilter::Bilinear:
+        return 2;
+    case Image::ResampleFilter::Bicubic:
+        return 4;
+    default:
+        return 1;
+    }
+}
 
-        int offsetY = iY * srcPitch;
+// Computes source pixel indices and weights of every destination pixel along one axis.
+// Destination pixel i samples the source at i * srcSize / dstSize.
+static void ComputeResampleWeights(Image::ResampleFilter::Enum filter, int srcSize, int dstSize, int *indices, float *weights) {
+    float ratio = (float)srcSize / dstSize;
+
+    for (int i = 0; i < dstSize; i++) {
+        float f = i * ratio;
+        float frac = Math::Fract(f);
+        int i1 = f - frac;
+
+        switch (filter) {
+        case Image::ResampleFilter::Nearest:
+            indices[0] = (int)f;
+            weights[0] = 1.0f;
+            break;
+        case Image::ResampleFilter::Bilinear:
+            indices[0] = i1;
+            indices[1] = Min(i1 + 1, srcSize - 1);
+            weights[0] = 1.0f - frac;
+            weights[1] = frac;
+            break;
+        case Image::ResampleFilter::Bicubic: {
+            // Catmull-Rom spline weights, same as Cerp()
+            float frac2 = frac * frac;
+            float frac3 = frac2 * frac;
+            indices[0] = Max(i1 - 1, 0);
+            indices[1] = i1;
+            indices[2] = Min(i1 + 1, srcSize - 1);
+            indices[3] = Min(i1 + 2, srcSize - 1);
+            weights[0] = 0.5f * (-frac3 + 2.0f * frac2 - frac);
+            weights[1] = 0.5f * (3.0f * frac3 - 5.0f * frac2 + 2.0f);
+            weights[2] = 0.5f * (-3.0f * frac3 + 4.0f * frac2 + frac);
+            weights[3] = 0.5f * (frac3 - frac2);
+            break;
+        }
+        }
 
-        for (int x = 0; x < dstWidth; x++) {
-            int iX = x * ratioX;
+        indices += ResampleFilterTaps(filter);
+        weights += ResampleFilterTaps(filter);
+    }
+}
 
-            int offsetX = iX * numComponents;
-        
-            const T *srcPtrY = &src[offsetY];
+// Bicubic overshoot is clamped to [0, MaxSampleValue]
+template <typename T> static float MaxSampleValue();
+template <> float MaxSampleValue<byte>() { return 255.0f; }
+template <> float MaxSampleValue<half>() { return HALF_MAX; }
+template <> float MaxSampleValue<float>() { return FLT_MAX; }
+
+static void LoadResampleRow(float *dst, const byte *src, const int count) {
+    int i = 0;
+#if defined(__X86__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(x, zero);
+        __m128i hi = _mm_unpackhi_epi8(x, zero);
+        _mm_store_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_store_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_store_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_store_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = (float)src[i];
+    }
+}
 
-            for (int i = 0; i < numComponents; i++) {
-                *dst++ = srcPtrY[offsetX + i];
-            }
+static void LoadResampleRow(float *dst, const half *src, const int count) {
+    int i = 0;
+#if defined(__X86__)
+    // Same result as half to float conversion including denormals, INF and NaN
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i expMantMask = _mm_set1_epi32(0x7FFF);
+    const __m128i expMask = _mm_set1_epi32(0x7C00);
+    const __m128i mantMask = _mm_set1_epi32(0x03FF);
+    const __m128i expBias = _mm_set1_epi32((127 - 15) << 23);
+    const __m128i infNanExp = _mm_set1_epi32(0x7F800000);
+    const __m128 denormScale = _mm_set1_ps(1.0f / (1 << 24));
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)&src[i]);
+        for (int j = 0; j < 2; j++) {
+            __m128i h = j == 0 ? _mm_unpacklo_epi16(x, zero) : _mm_unpackhi_epi16(x, zero);
+            __m128i exp = _mm_and_si128(h, expMask);
+            __m128i sign = _mm_slli_epi32(_mm_srli_epi32(h, 15), 31);
+            __m128i bits = _mm_slli_epi32(_mm_and_si128(h, expMantMask), 13);
+            __m128i normal = _mm_add_epi32(bits, expBias);
+            __m128i infNan = _mm_or_si128(bits, infNanExp);
+            __m128 denormal = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(h, mantMask)), denormScale);
+
+            __m128i isDenormal = _mm_cmpeq_epi32(exp, zero);
+            __m128i isInfNan = _mm_cmpeq_epi32(exp, expMask);
+
+            bits = _mm_or_si128(_mm_and_si128(isInfNan, infNan), _mm_andnot_si128(isInfNan, normal));
+            bits = _mm_or_si128(_mm_and_si128(isDenormal, _mm_castps_si128(denormal)), _mm_andnot_si128(isDenormal, bits));
+            _mm_store_ps(dst + i + j * 4, _mm_castsi128_ps(_mm_or_si128(bits, sign)));
         }
     }
+#endif
+    for (; i < count; i++) {
+        dst[i] = (float)src[i];
+    }
+}
+
+static void LoadResampleRow(float *dst, const float *src, const int count) {
+    memcpy(dst, src, count * sizeof(float));
 }
 
+// Converts only the given source pixels, used when downscaling skips most of the source pixels
 template <typename T>
-static void ResizeImageBilinear(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int numComponents) {
-    int srcPitch = srcWidth * numComponents;
+static void LoadResampleColumns(float *dst, const T *src, const int *columns, const int numColumns, const int components) {
+    for (int i = 0; i < numColumns; i++) {
+        int offset = columns[i] * components;
+        for (int j = 0; j < components; j++) {
+            dst[offset + j] = (float)src[offset + j];
+        }
+    }
+}
 
-    float ratioX = (float)srcWidth / dstWidth;
-    float ratioY = (float)srcHeight / dstHeight;
+static void StoreResampleRow(byte *dst, const float *src, const int count, bool clamp) {
+    int i = 0;
+#if defined(__X86__)
+    const __m128 bias = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 maxValue = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16) {
+        __m128i i0 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_load_ps(src + i), bias), zero), maxValue));
+        __m128i i1 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_load_ps(src + i + 4), bias), zero), maxValue));
+        __m128i i2 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_load_ps(src + i + 8), bias), zero), maxValue));
+        __m128i i3 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_load_ps(src + i + 12), bias), zero), maxValue));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(_mm_packs_epi32(i0, i1), _mm_packs_epi32(i2, i3)));
+    }
+#endif
+    // Bytes are always clamped
+    for (; i < count; i++) {
+        dst[i] = Math::Ftob(src[i] + 0.5f);
+    }
+}
+
+static void StoreResampleRow(half *dst, const float *src, const int count, bool clamp) {
+    if (clamp) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = half(Clamp(src[i], 0.0f, MaxSampleValue<half>()));
+        }
+    } else {
+        for (int i = 0; i < count; i++) {
+            dst[i] = half(src[i]);
+        }
+    }
+}
 
-    for (int y = 0; y < dstHeight; y++) {
-        float fY0 = y * ratioY;
-        float fracY = Math::Fract(fY0);
+static void StoreResampleRow(float *dst, const float *src, const int count, bool clamp) {
+    if (clamp) {
+        for (int i = 0; i < count; i++) {
+            dst[i] = Clamp(src[i], 0.0f, MaxSampleValue<float>());
+        }
+    } else {
+        memcpy(dst, src, count * sizeof(float));
+    }
+}
 
-        int iY0 = fY0 - fracY;
-        int iY1 = Min(iY0 + 1, srcHeight - 1);
+// Horizontal pass. offsets are source pixel indices multiplied by components.
+// src and dst rows should be padded with ResizeRowPadding floats.
+static void ResampleRow(float *dst, const float *src, const int dstWidth, const int components, const int numTaps, const int *offsets, const float *weights) {
+#if defined(__X86__)
+    // Every pixel is computed with 4 lanes, extra lanes are overwritten by the next pixel or land in the padding.
+    for (int x = 0; x < dstWidth; x++, offsets += numTaps, weights += numTaps) {
+        __m128 sum = _mm_mul_ps(_mm_load1_ps(&weights[0]), _mm_loadu_ps(src + offsets[0]));
+        for (int k = 1; k < numTaps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(&weights[k]), _mm_loadu_ps(src + offsets[k])));
+        }
+        _mm_storeu_ps(dst + x * components, sum);
+    }
+#else
+    for (int x = 0; x < dstWidth; x++, offsets += numTaps, weights += numTaps) {
+        for (int i = 0; i < components; i++) {
+            float sum = 0.0f;
+            for (int k = 0; k < numTaps; k++) {
+                sum += weights[k] * src[offsets[k] + i];
+            }
+            dst[x * components + i] = sum;
+        }
+    }
+#endif
+}
 
-        int offsetY0 = iY0 * srcPitch;
-        int offsetY1 = iY1 * srcPitch;
+// Vertical pass. dst[i] = sum of weights[k] * rows[k][i]
+static void ResampleColumns(float *dst, const float **rows, const float *weights, const int numTaps, const int count) {
+    int i = 0;
+#if defined(__X86__)
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_mul_ps(_mm_load1_ps(&weights[0]), _mm_load_ps(rows[0] + i));
+        for (int k = 1; k < numTaps; k++) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_load1_ps(&weights[k]), _mm_load_ps(rows[k] + i)));
+        }
+        _mm_store_ps(dst + i, sum);
+    }
+#endif
+    for (; i < count; i++) {
+        float sum = 0.0f;
+        for (int k = 0; k < numTaps; k++) {
+            sum += weights[k] * rows[k][i];
+        }
+        dst[i] = sum;
+    }
+}
 
-        for (int x = 0; x < dstWidth; x++) {
-            float fX0 = x * ratioX;
-            float fracX = Math::Fract(fX0);
+//-------------------------------------------------------------------------------------------------
+// Parallel resize
+//-------------------------------------------------------------------------------------------------
+
+struct ResizeData {
+    const byte *            src;
+    byte *                  dst;
+    int                     srcWidth;
+    int                     srcHeight;
+    int                     dstWidth;
+    int                     dstHeight;
+    int                     components;
+    int                     numTaps;
+    bool                    clamp;          // clamps filter overshoot
+    const int *             srcColumns;     // source pixels referenced by horizontal taps, nullptr to convert whole rows
+    int                     numSrcColumns;
+    const int *             xOffsets;       // source component offsets of horizontal taps
+    const float *           xWeights;
+    const int *             yIndices;       // source rows of vertical taps
+    const float *           yWeights;
+};
+
+// Resizes destination rows of a tile. Source rows referenced by the tile are resampled horizontally once on demand,
+// and then destination rows are resampled vertically.
+template <typename T>
+static void ResizeTile(const ResizeData &data, int firstRow, int numRows) {
+    const int numTaps = data.numTaps;
+    const int c = data.components;
+    const int srcRowSize = data.srcWidth * c;
+    const int dstRowSize = data.dstWidth * c;
+    // Keeps every row 16 bytes aligned
+    const int srcRowPitch = (srcRowSize + ResizeRowPadding + 3) & ~3;
+    const int dstRowPitch = (dstRowSize + ResizeRowPadding + 3) & ~3;
+
+    const int *yIndices = data.yIndices + firstRow * numTaps;
+    const float *yWeights = data.yWeights + firstRow * numTaps;
+
+    int firstSrcRow = data.srcHeight - 1;
+    int lastSrcRow = 0;
+    for (int i = 0; i < numRows * numTaps; i++) {
+        firstSrcRow = Min(firstSrcRow, yIndices[i]);
+        lastSrcRow = Max(lastSrcRow, yIndices[i]);
+    }
+    const int numSrcRows = lastSrcRow - firstSrcRow + 1;
+
+    float *buffer = (float *)Mem_Alloc16((srcRowPitch + (numSrcRows + 1) * dstRowPitch) * sizeof(float) + numSrcRows * sizeof(bool));
+    float *srcRow = buffer;
+    float *resampledRows = srcRow + srcRowPitch;
+    float *dstRow = resampledRows + numSrcRows * dstRowPitch;
+    bool *resampled = (bool *)(dstRow + dstRowPitch);
+
+    memset(srcRow + srcRowSize, 0, (srcRowPitch - srcRowSize) * sizeof(float));
+    memset(resampled, 0, numSrcRows * sizeof(bool));
+
+    const float *rows[4];
+
+    for (int y = 0; y < numRows; y++, yIndices += numTaps, yWeights += numTaps) {
+        for (int k = 0; k < numTaps; k++) {
+            int rowIndex = yIndices[k] - firstSrcRow;
+            float *row = resampledRows + rowIndex * dstRowPitch;
+
+            if (!resampled[rowIndex]) {
+                const T *src = (const T *)data.src + yIndices[k] * srcRowSize;
+                if (std::is_same<T, float>::value && c == 4) {
+                    // 4 component float rows can be resampled from the source directly
+                    ResampleRow(row, (const float *)src, data.dstWidth, c, numTaps, data.xOffsets, data.xWeights);
+                } else {
+                    if (data.srcColumns) {
+                        LoadResampleColumns(srcRow, src, data.srcColumns, data.numSrcColumns, c);
+                    } else {
+                        LoadResampleRow(srcRow, src, srcRowSize);
+                    }
+                    ResampleRow(row, srcRow, data.dstWidth, c, numTaps, data.xOffsets, data.xWeights);
+                }
+                resampled[rowIndex] = true;
+            }
+            rows[k] = row;
+        }
 
-            int iX0 = fX0 - fracX;
-            int iX1 = Min(iX0 + 1, srcWidth - 1);
+        ResampleColumns(dstRow, rows, yWeights, numTaps, dstRowSize);
 
-            int offsetX0 = iX0 * numComponents;
-            int offsetX1 = iX1 * numComponents;
+        StoreResampleRow((T *)data.dst + (firstRow + y) * dstRowSize, dstRow, dstRowSize, data.clamp);
+    }
 
-            const T *srcPtrY[2];
-            srcPtrY[0] = &src[offsetY0];
-            srcPtrY[1] = &src[offsetY1];
+    Mem_AlignedFree(buffer);
+}
 
-            for (int i = 0; i < numComponents; i++) {
-                int index0 = offsetX0 + i;
-                int index1 = offsetX1 + i;
+// Nearest filter copies source pixels without conversion
+template <typename T>
+static void ResizeTileNearest(const ResizeData &data, int firstRow, int numRows) {
+    const int c = data.components;
 
-                // NOTE: Should we need to lerp in linear color space ?
-                float p0 = Lerp<float>(srcPtrY[0][index0], srcPtrY[0][index1], fracX);
-                float p1 = Lerp<float>(srcPtrY[1][index0], srcPtrY[1][index1], fracX);
-                float po = Lerp<float>(p0, p1, fracY);
+    for (int y = firstRow; y < firstRow + numRows; y++) {
+        const T *src = (const T *)data.src + data.yIndices[y] * data.srcWidth * c;
+        T *dst = (T *)data.dst + y * data.dstWidth * c;
 
-                *dst++ = po;
+        for (int x = 0; x < data.dstWidth; x++) {
+            const T *srcPtr = src + data.xOffsets[x];
+            for (int i = 0; i < c; i++) {
+                *dst++ = srcPtr[i];
             }
         }
     }
 }
 
 template <typename T>
-static void ResizeImageBicubic(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int numComponents) {
-    int srcPitch = srcWidth * numComponents;
-
-    float ratioX = (float)srcWidth / dstWidth;
-    float ratioY = (float)srcHeight / dstHeight;
-
-    for (int y = 0; y < dstHeight; y++) {
-        float fY1 = y * ratioY;
-        float fracY = Math::Fract(fY1);
-
-        int iY1 = fY1 - fracY;
-        int iY0 = Max(iY1 - 1, 0);
-        int iY2 = Min(iY1 + 1, srcHeight - 1);
-        int iY3 = Min(iY1 + 2, srcHeight - 1);
-
-        int offsetY0 = iY0 * srcPitch;
-        int offsetY1 = iY1 * srcPitch;
-        int offsetY2 = iY2 * srcPitch;
-        int offsetY3 = iY3 * srcPitch;
-
-        for (int x = 0; x < dstWidth; x++) {
-            float fX1 = x * ratioX;
-            float fracX = Math::Fract(fX1);
-
-            int iX1 = fX1 - fracX;
-            int iX0 = Max(iX1 - 1, 0);
-            int iX2 = Min(iX1 + 1, srcWidth - 1);
-            int iX3 = Min(iX1 + 2, srcWidth - 1);
-
-            int offsetX0 = iX0 * numComponents;
-            int offsetX1 = iX1 * numComponents;
-            int offsetX2 = iX2 * numComponents;
-            int offsetX3 = iX3 * numComponents;
-
-            const T *srcPtrY[4];
-            srcPtrY[0] = &src[offsetY0];
-            srcPtrY[1] = &src[offsetY1];
-            srcPtrY[2] = &src[offsetY2];
-            srcPtrY[3] = &src[offsetY3];
-
-            for (int i = 0; i < numComponents; i++) {
-                int index0 = offsetX0 + i;
-                int index1 = offsetX1 + i;
-                int index2 = offsetX2 + i;
-                int index3 = offsetX3 + i;
-
-                // NOTE: Should we need to lerp in linear color space ?
-                float p0 = Cerp<float>(srcPtrY[0][index0], srcPtrY[0][index1], srcPtrY[0][index2], srcPtrY[0][index3], fracX);
-                float p1 = Cerp<float>(srcPtrY[1][index0], srcPtrY[1][index1], srcPtrY[1][index2], srcPtrY[1][index3], fracX);
-                float p2 = Cerp<float>(srcPtrY[2][index0], srcPtrY[2][index1], srcPtrY[2][index2], srcPtrY[2][index3], fracX);
-                float p3 = Cerp<float>(srcPtrY[3][index0], srcPtrY[3][index1], srcPtrY[3][index2], srcPtrY[3][index3], fracX);
-                float po = Cerp<float>(p0, p1, p2, p3, fracY);
-
-                *dst++ = ClampFloat(std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), po);
-            }
+static void ResizeImage(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int numComponents, Image::ResampleFilter::Enum filter) {
+    const int numTaps = ResampleFilterTaps(filter);
+
+    int *indices = (int *)Mem_Alloc16((dstWidth + dstHeight) * numTaps * sizeof(int));
+    float *weights = (float *)Mem_Alloc16((dstWidth + dstHeight) * numTaps * sizeof(float));
+
+    int *xOffsets = indices;
+    int *yIndices = indices + dstWidth * numTaps;
+
+    ComputeResampleWeights(filter, srcWidth, dstWidth, xOffsets, weights);
+    ComputeResampleWeights(filter, srcHeight, dstHeight, yIndices, weights + dstWidth * numTaps);
+
+    // Finds source pixels referenced by horizontal taps
+    int *srcColumns = (int *)Mem_Alloc16(srcWidth * sizeof(int));
+    int numSrcColumns = 0;
+
+    memset(srcColumns, 0, srcWidth * sizeof(int));
+    for (int i = 0; i < dstWidth * numTaps; i++) {
+        srcColumns[xOffsets[i]] = 1;
+    }
+    for (int i = 0; i < srcWidth; i++) {
+        if (srcColumns[i]) {
+            srcColumns[numSrcColumns++] = i;
         }
     }
-}
 
-template <typename T>
-static void ResizeImage(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int numComponents, Image::ResampleFilter::Enum filter) {
-    switch (filter) {
-    case Image::ResampleFilter::Nearest:
-        ResizeImageNearest(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numComponents);
-        break;
-    case Image::ResampleFilter::Bilinear:
-        ResizeImageBilinear(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numComponents);
-        break;
-    case Image::ResampleFilter::Bicubic:
-        ResizeImageBicubic(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, numComponents);
-        break;
+    for (int i = 0; i < dstWidth * numTaps; i++) {
+        xOffsets[i] *= numComponents;
     }
+
+    ResizeData data;
+    data.src = (const byte *)src;
+    data.dst = (byte *)dst;
+    data.srcWidth = srcWidth;
+    data.srcHeight = srcHeight;
+    data.dstWidth = dstWidth;
+    data.dstHeight = dstHeight;
+    data.components = numComponents;
+    data.numTaps = numTaps;
+    data.clamp = filter == Image::ResampleFilter::Bicubic;
+    // Converting whole rows is faster unless most of the source pixels are skipped
+    data.srcColumns = numSrcColumns * 2 <= srcWidth ? srcColumns : nullptr;
+    data.numSrcColumns = numSrcColumns;
+    data.xOffsets = xOffsets;
+    data.xWeights = weights;
+    data.yIndices = yIndices;
+    data.yWeights = weights + dstWidth * numTaps;
+
+    int numTiles = (dstHeight + ResizeRowsPerTile - 1) / ResizeRowsPerTile;
+
+    if (filter == Image::ResampleFilter::Nearest) {
+        jobSystem.ParallelFor(numTiles, 1, [](void *data, int begin, int end) {
+            const ResizeData *resizeData = (const ResizeData *)data;
+
+            for (int tileIndex = begin; tileIndex < end; tileIndex++) {
+                int firstRow = tileIndex * ResizeRowsPerTile;
+                ResizeTileNearest<T>(*resizeData, firstRow, Min(ResizeRowsPerTile, resizeData->dstHeight - firstRow));
+            }
+        }, &data);
+    } else {
+        jobSystem.ParallelFor(numTiles, 1, [](void *data, int begin, int end) {
+            const ResizeData *resizeData = (const ResizeData *)data;
+
+            for (int tileIndex = begin; tileIndex < end; tileIndex++) {
+                int firstRow = tileIndex * ResizeRowsPerTile;
+                ResizeTile<T>(*resizeData, firstRow, Min(ResizeRowsPerTile, resizeData->dstHeight - firstRow));
+            }
+        }, &data);
+    }
+
+    Mem_AlignedFree(srcColumns);
+    Mem_AlignedFree(indices);
+    Mem_AlignedFree(weights);
 }
 
 bool Image::Resize(int dstWidth, int dstHeight, Image::ResampleFilter::Enum filter, Image &dstImage) const {
@@ -240,8 +502,10 @@ bool Image::ResizeSelf(int dstWidth, int dstHeight, Image::ResampleFilter::Enum
     }
 
     this->pic = dst;
+    this->alloced = true;
     this->width = dstWidth;
     this->height = dstHeight;
+    this->numMipmaps = 1;
 
     return true;
 }
@@ -87,8 +87,8 @@ void DetectCpu() {
         }
     }
 
-    // If Visual Studio 2010 SP1 or later
-#if (_MSC_FULL_VER >= 160040219)
+    // XGETBV is available in Visual Studio 2010 SP1 or later
+#if !defined(_MSC_VER) || (_MSC_FULL_VER >= 160040219)
     // Checking for AVX requires 3 things:
     // 1) CPUID indicates that the OS uses XSAVE and XRSTORE
     //     instructions (allowing saving YMM registers on context
@@ -104,9 +104,23 @@ void DetectCpu() {
 
     if (osUsesXSAVE_XRSTORE && cpuAVXSupport) {
         // Check if the OS will save the YMM registers
-        unsigned long long xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
-        if (xcrFeatureMask & 0x6) {
+        uint64_t xcrFeatureMask = read_xcr(0);
+        if ((xcrFeatureMask & 0x6) == 0x6) {
             cpuInfo.cpuid |= CPUID_AVX;
+
+            if (info[2] & BIT(12)) {
+                cpuInfo.cpuid |= CPUID_FMA3;
+            }
+
+            // AVX2 is reported in the extended features
+            int extInfo[4] = { 0, };
+            __cpuid(extInfo, 0);
+            if (extInfo[0] >= 7) {
+                __cpuidex(extInfo, 7, 0);
+                if (extInfo[1] & BIT(5)) {
+                    cpuInfo.cpuid |= CPUID_AVX2;
+                }
+            }
         }
     }
 #endif
@@ -16,6 +16,8 @@
 #include "Core/BinSearch.h"
 #include "Render/Render.h"
 #include "Core/JointPose.h"
+#include "Core/ScratchAllocator.h"
+#include "Core/CVars.h"
 #include "Simd/Simd.h"
 #include "Simd/Simd.h"
 
@@ -23,8 +25,11 @@
 
 BE_NAMESPACE_BEGIN
 
+static CVAR(anim_compress, "0", CVar::Flag::Bool, "Compress the uncompressed anims when loading");
+
 size_t Anim::Allocated() const {
     size_t size = joints.Allocated() + components.Allocated() + frameTimes.Allocated() + hashName.Allocated();
+    size += jointTracks.Allocated() + compressedTracks.Allocated() + keyFrameNums.Allocated() + keyValues.Allocated();
     return size;
 }
 
@@ -43,6 +48,12 @@ void Anim::Purge() {
     joints.Clear();
     components.Clear();
     frameTimes.Clear();
+
+    isCompressed = false;
+    jointTracks.Clear();
+    compressedTracks.Clear();
+    keyFrameNums.Clear();
+    keyValues.Clear();
 }
 
 Anim &Anim::Copy(const Anim &other) {
@@ -62,6 +73,12 @@ Anim &Anim::Copy(const Anim &other) {
     frameTimes = other.frameTimes;
     totalDelta = other.totalDelta;
 
+    isCompressed = other.isCompressed;
+    jointTracks = other.jointTracks;
+    compressedTracks = other.compressedTracks;
+    keyFrameNums = other.keyFrameNums;
+    keyValues = other.keyValues;
+
     return *this;
 }
 
@@ -109,6 +126,11 @@ void Anim::CreateDefaultAnim(const Skeleton *skeleton) {
 }
 
 Anim *Anim::CreateAdditiveAnim(const char *hashName, const JointPose *firstFrame, int numJointIndexes, const int *jointIndexes) {
+    if (isCompressed) {
+        BE_WARNLOG("Anim::CreateAdditiveAnim: can't create additive anim from compressed anim '%s'\n", this->hashName.c_str());
+        return nullptr;
+    }
+
     Anim *additiveAnim = animManager.AllocAnim(hashName);
     additiveAnim->Copy(*this);
 
@@ -230,6 +252,10 @@ bool Anim::Load(const char *filename) {
         return false;
     }
 
+    if (anim_compress.GetBool() && !isCompressed) {
+        Compress();
+    }
+
     isDefaultAnim = false;
     isAdditiveAnim = false;
     
@@ -482,23 +508,30 @@ void Anim::GetTranslation(Vec3 &outTranslation, int time, bool isCyclicTranslati
 
     TimeToFrameInterpolation(time, frame);
 
-    const float *componentPtr1 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame1];
-    const float *componentPtr2 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame2];
+    if (isCompressed) {
+        const CompressedTrack *track = GetCompressedTrack(0, TrackChannel::Translation);
+        if (track) {
+            outTranslation = DecodeCompressedVec3(*track, frame.frame1, FrameInterpolationToTime(frame));
+        }
+    } else {
+        const float *componentPtr1 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame1];
+        const float *componentPtr2 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame2];
 
-    if (rootJoint.componentBits & ComponentBit::Tx) {
-        outTranslation.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-        componentPtr1++;
-        componentPtr2++;
-    }
+        if (rootJoint.componentBits & ComponentBit::Tx) {
+            outTranslation.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
+            componentPtr1++;
+            componentPtr2++;
+        }
 
-    if (rootJoint.componentBits & ComponentBit::Ty) {
-        outTranslation.y = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
-        componentPtr1++;
-        componentPtr2++;
-    }
+        if (rootJoint.componentBits & ComponentBit::Ty) {
+            outTranslation.y = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
+            componentPtr1++;
+            componentPtr2++;
+        }
 
-    if (rootJoint.componentBits & ComponentBit::Tz) {
-        outTranslation.z = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
+        if (rootJoint.componentBits & ComponentBit::Tz) {
+            outTranslation.z = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
+        }
     }
 
     if (frame.cycleCount && isCyclicTranslation) {
@@ -536,6 +569,12 @@ void Anim::GetRotation(Quat &outRotation, int time) const {
     FrameInterpolation frame;
     TimeToFrameInterpolation(time, frame);
 
+    if (isCompressed) {
+        const CompressedTrack *track = GetCompressedTrack(0, TrackChannel::Rotation);
+        outRotation = track ? DecodeCompressedQuat(*track, frame.frame1, FrameInterpolationToTime(frame)) : baseFrame[0].q;
+        return;
+    }
+
     const float *componentPtr1 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame1];
     const float *componentPtr2 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame2];
 
@@ -646,6 +685,12 @@ void Anim::GetScaling(Vec3 &outScaling, int time) const {
     FrameInterpolation frame;
     TimeToFrameInterpolation(time, frame);
 
+    if (isCompressed) {
+        const CompressedTrack *track = GetCompressedTrack(0, TrackChannel::Scale);
+        outScaling = track ? DecodeCompressedVec3(*track, frame.frame1, FrameInterpolationToTime(frame)) : baseFrame[0].s;
+        return;
+    }
+
     const float *componentPtr1 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame1];
     const float *componentPtr2 = &components[rootJoint.componentOffset + numComponentsPerFrame * frame.frame2];
 
@@ -791,14 +836,18 @@ void Anim::GetSingleFrame(int frameNum, int numJointIndexes, const int *jointInd
     // Copy the base frame
     simdProcessor->Memcpy(frame, baseFrame.Ptr(), baseFrame.Count() * sizeof(baseFrame[0]));
 
-    if (frameNum == 0 || !numComponentsPerFrame) {
-        // Just use the base frame
-        return;
-    }
+    if (isCompressed) {
+        DecodeCompressedFrame(frameNum, (float)frameTimes[frameNum], numJointIndexes, jointIndexes, frame);
+    } else {
+        if (frameNum == 0 || !numComponentsPerFrame) {
+            // Just use the base frame
+            return;
+        }
 
-    const float *frameComponents = &components[frameNum * numComponentsPerFrame];
+        const float *frameComponents = &components[frameNum * numComponentsPerFrame];
 
-    DecodeSingleFrame(joints.Ptr(), numJointIndexes, jointIndexes, frameComponents, frame);
+        DecodeSingleFrame(joints.Ptr(), numJointIndexes, jointIndexes, frameComponents, frame);
+    }
 
     if (!rootTranslationXY) {
         frame[0].t.x = baseFrame[0].t.x;
@@ -814,6 +863,24 @@ void Anim::GetSingleFrame(int frameNum, int numJointIndexes, const int *jointInd
     }
 }
 
+void Anim::DecodeRawFrame(int frameNum, JointPose *frame) const {
+    simdProcessor->Memcpy(frame, baseFrame.Ptr(), baseFrame.Count() * sizeof(baseFrame[0]));
+
+    if (!numComponentsPerFrame) {
+        return;
+    }
+
+    ScratchAllocator::Scope scratchScope;
+
+    int *jointIndexes = scratchAllocator.Alloc<int>(numJoints);
+    for (int i = 0; i < numJoints; i++) {
+        jointIndexes[i] = i;
+    }
+
+    // Root joint is not affected by the root motion flags
+    DecodeSingleFrame(joints.Ptr(), numJoints, jointIndexes, &components[frameNum * numComponentsPerFrame], frame);
+}
+
 static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIndexes, const int *jointIndexes, const float *frameComponents1, const float *frameComponents2,
     JointPose *frame, JointPose *blendFrame, int *lerpIndex) {
     int numLerpJoints = 0;
@@ -913,6 +980,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.z = frameJointPtr->q.z;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1++;
+            jointComponentPtr2++;
             break;
         case Anim::ComponentBit::Qy:
             frameJointPtr->q.y = jointComponentPtr1[0];
@@ -921,6 +990,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.z = frameJointPtr->q.z;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1++;
+            jointComponentPtr2++;
             break;
         case Anim::ComponentBit::Qz:
             frameJointPtr->q.z = jointComponentPtr1[0];
@@ -929,6 +1000,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.y = frameJointPtr->q.y;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1++;
+            jointComponentPtr2++;
             break;
         case Anim::ComponentBit::Qx | Anim::ComponentBit::Qy:
             frameJointPtr->q.x = jointComponentPtr1[0];
@@ -938,6 +1011,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.z = frameJointPtr->q.z;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1 += 2;
+            jointComponentPtr2 += 2;
             break;
         case Anim::ComponentBit::Qx | Anim::ComponentBit::Qz:
             frameJointPtr->q.x = jointComponentPtr1[0];
@@ -947,6 +1022,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.y = frameJointPtr->q.y;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1 += 2;
+            jointComponentPtr2 += 2;
             break;
         case Anim::ComponentBit::Qy | Anim::ComponentBit::Qz:
             frameJointPtr->q.y = jointComponentPtr1[0];
@@ -956,6 +1033,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.x = frameJointPtr->q.x;
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1 += 2;
+            jointComponentPtr2 += 2;
             break;
         case Anim::ComponentBit::Qx | Anim::ComponentBit::Qy | Anim::ComponentBit::Qz:
             frameJointPtr->q.x = jointComponentPtr1[0];
@@ -966,6 +1045,8 @@ static int DecodeInterpolatedFrame(const Anim::JointInfo *joints, int numJointIn
             blendJointPtr->q.z = jointComponentPtr2[2];
             frameJointPtr->q.w = frameJointPtr->q.CalcW();
             blendJointPtr->q.w = blendJointPtr->q.CalcW();
+            jointComponentPtr1 += 3;
+            jointComponentPtr2 += 3;
             break;
         }
 
@@ -1044,20 +1125,27 @@ void Anim::GetInterpolatedFrame(FrameInterpolation &frameInterpolation, int numJ
     // Copy the base frame
     simdProcessor->Memcpy(frame, baseFrame.Ptr(), baseFrame.Count() * sizeof(baseFrame[0]));
 
-    if (!numComponentsPerFrame) {
-        // Just use the base frame
-        return;
-    }
+    if (isCompressed) {
+        // Compressed tracks are interpolated between their own keys
+        DecodeCompressedFrame(frameInterpolation.frame1, FrameInterpolationToTime(frameInterpolation), numJointIndexes, jointIndexes, frame);
+    } else {
+        if (!numComponentsPerFrame) {
+            // Just use the base frame
+            return;
+        }
 
-    JointPose *blendFrame = (JointPose *)_alloca16(baseFrame.Count() * sizeof(JointPose));
-    int *lerpIndex = (int *)_alloca16(baseFrame.Count() * sizeof(lerpIndex[0]));
+        ScratchAllocator::Scope scratchScope;
 
-    const float *frameComponents1 = &components[frameInterpolation.frame1 * numComponentsPerFrame];
-    const float *frameComponents2 = &components[frameInterpolation.frame2 * numComponentsPerFrame];
+        JointPose *blendFrame = scratchAllocator.Alloc<JointPose>(baseFrame.Count());
+        int *lerpIndex = scratchAllocator.Alloc<int>(baseFrame.Count());
 
-    int numLerpJoints = DecodeInterpolatedFrame(joints.Ptr(), numJointIndexes, jointIndexes, frameComponents1, frameComponents2, frame, blendFrame, lerpIndex);
+        const float *frameComponents1 = &components[frameInterpolation.frame1 * numComponentsPerFrame];
+        const float *frameComponents2 = &components[frameInterpolation.frame2 * numComponentsPerFrame];
 
-    simdProcessor->BlendJoints(frame, blendFrame, frameInterpolation.backlerp, lerpIndex, numLerpJoints);
+        int numLerpJoints = DecodeInterpolatedFrame(joints.Ptr(), numJointIndexes, jointIndexes, frameComponents1, frameComponents2, frame, blendFrame, lerpIndex);
+
+        simdProcessor->BlendJoints(frame, blendFrame, frameInterpolation.backlerp, lerpIndex, numLerpJoints);
+    }
 
 #if CYCLIC_DELTA_MOVEMENT
     if (frameInterpolation.cycleCount) {
@@ -14,7 +14,10 @@
 
 #include "Precompiled.h"
 #include "Render/Render.h"
+#include "Core/JointPose.h"
+#include "Core/Heap.h"
 #include "Core/Cmds.h"
+#include "Platform/PlatformTime.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -176,9 +179,37 @@ void AnimManager::ReloadAnims() {
 
 //--------------------------------------------------------------------------------------------------
 
+// Average time to decode an interpolated frame of all joints in the anim, in microseconds
+static float MeasureDecodeTime(const Anim *anim) {
+    const int numSamples = 64;
+
+    Array<int> jointIndexes;
+    jointIndexes.SetCount(anim->NumJoints());
+    for (int i = 0; i < jointIndexes.Count(); i++) {
+        jointIndexes[i] = i;
+    }
+
+    JointPose *frame = (JointPose *)Mem_Alloc16(anim->NumJoints() * sizeof(JointPose));
+
+    uint64_t startTime = PlatformTime::Microseconds();
+
+    for (int i = 0; i < numSamples; i++) {
+        Anim::FrameInterpolation frameInterpolation;
+        anim->TimeToFrameInterpolation((int)(anim->Length() * i / numSamples), frameInterpolation);
+        anim->GetInterpolatedFrame(frameInterpolation, jointIndexes.Count(), jointIndexes.Ptr(), frame);
+    }
+
+    uint64_t elapsedTime = PlatformTime::Microseconds() - startTime;
+
+    Mem_AlignedFree(frame);
+
+    return (float)elapsedTime / numSamples;
+}
+
 void AnimManager::Cmd_ListAnims(const CmdArgs &args) {
     int num = 0;
     size_t size = 0;
+    bool measureDecode = !Str::Icmp(args.Argv(1), "decode");
 
     for (int i = 0; i < animManager.animHashMap.Count(); i++) {
         const auto *entry = animManager.animHashMap.GetByIndex(i);
@@ -186,8 +217,12 @@ void AnimManager::Cmd_ListAnims(const CmdArgs &args) {
 
         if (anim) {
             size_t s = anim->Size();
-            BE_LOG("%2i refs %9s %.2f secs: %s\n", 
-                anim->refCount, Str::FormatBytes((int)s).c_str(), anim->length / 1000.0f, anim->hashName.c_str());
+            BE_LOG("%2i refs %9s %.2f secs %s: %s\n", 
+                anim->refCount, Str::FormatBytes((int)s).c_str(), anim->length / 1000.0f, anim->IsCompressed() ? "C" : " ", anim->hashName.c_str());
+
+            if (measureDecode) {
+                BE_LOG("    %.2f us per frame\n", MeasureDecodeTime(anim));
+            }
 
             size += s;
             num++;
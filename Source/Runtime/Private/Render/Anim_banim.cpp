@@ -92,11 +92,57 @@ bool Anim::LoadBinaryAnim(const char *filename) {
         ptr += sizeof(baseFrame[jointIndex].s);
     }
 
-    // --- frames ---
-    components.SetGranularity(1);
-    components.SetCount(numComponentsPerFrame * numFrames);
-    memcpy(components.Ptr(), ptr, components.MemoryUsed());
-    ptr += components.MemoryUsed();
+    isCompressed = (bAnimHeader->version >= 3 && (bAnimHeader->flags & BAnimFlag::Compressed)) ? true : false;
+
+    if (isCompressed) {
+        // --- joint tracks ---
+        int jointTracksCount = *(const int *)ptr;
+        ptr += sizeof(jointTracksCount);
+
+        jointTracks.SetGranularity(1);
+        jointTracks.SetCount(jointTracksCount);
+        memcpy(jointTracks.Ptr(), ptr, jointTracks.MemoryUsed());
+        ptr += jointTracks.MemoryUsed();
+
+        // --- compressed tracks ---
+        int tracksCount = *(const int *)ptr;
+        ptr += sizeof(tracksCount);
+
+        compressedTracks.SetGranularity(1);
+        compressedTracks.SetCount(tracksCount);
+
+        for (int trackIndex = 0; trackIndex < tracksCount; trackIndex++) {
+            const BAnimTrack *bAnimTrack = (const BAnimTrack *)ptr;
+            ptr += sizeof(BAnimTrack);
+
+            CompressedTrack *track = &compressedTracks[trackIndex];
+
+            track->numKeys = bAnimTrack->numKeys;
+            track->keyOffset = bAnimTrack->keyOffset;
+            track->rangeMin.Set(bAnimTrack->rangeMin[0], bAnimTrack->rangeMin[1], bAnimTrack->rangeMin[2]);
+            track->rangeExtent.Set(bAnimTrack->rangeExtent[0], bAnimTrack->rangeExtent[1], bAnimTrack->rangeExtent[2]);
+        }
+
+        // --- keys ---
+        int keysCount = *(const int *)ptr;
+        ptr += sizeof(keysCount);
+
+        keyFrameNums.SetGranularity(1);
+        keyFrameNums.SetCount(keysCount);
+        memcpy(keyFrameNums.Ptr(), ptr, keyFrameNums.MemoryUsed());
+        ptr += keyFrameNums.MemoryUsed();
+
+        keyValues.SetGranularity(1);
+        keyValues.SetCount(keysCount * 3);
+        memcpy(keyValues.Ptr(), ptr, keyValues.MemoryUsed());
+        ptr += keyValues.MemoryUsed();
+    } else {
+        // --- frames ---
+        components.SetGranularity(1);
+        components.SetCount(numComponentsPerFrame * numFrames);
+        memcpy(components.Ptr(), ptr, components.MemoryUsed());
+        ptr += components.MemoryUsed();
+    }
 
     // --- total delta ---
     memcpy(&totalDelta, ptr, sizeof(totalDelta));
@@ -118,6 +164,7 @@ void Anim::WriteBinaryAnim(const char *filename) {
     flags |= rootTranslationXY ? BAnimFlag::RootTranslationXY : 0;
     flags |= rootTranslationZ ? BAnimFlag::RootTranslationZ : 0;
     flags |= rootRotation ? BAnimFlag::RootRotation : 0;
+    flags |= isCompressed ? BAnimFlag::Compressed : 0;
 
     BAnimHeader bAnimHeader;
     bAnimHeader.ident = BANIM_IDENT;
@@ -154,8 +201,38 @@ void Anim::WriteBinaryAnim(const char *filename) {
         fp->Write(&baseFrame[jointIndex].s, sizeof(baseFrame[jointIndex].s));
     }
 
-    // --- frames ---
-    fp->Write(components.Ptr(), components.MemoryUsed());
+    if (isCompressed) {
+        // --- joint tracks ---
+        int jointTracksCount = jointTracks.Count();
+        fp->Write(&jointTracksCount, sizeof(jointTracksCount));
+        fp->Write(jointTracks.Ptr(), jointTracks.MemoryUsed());
+
+        // --- compressed tracks ---
+        int tracksCount = compressedTracks.Count();
+        fp->Write(&tracksCount, sizeof(tracksCount));
+
+        for (int trackIndex = 0; trackIndex < tracksCount; trackIndex++) {
+            const CompressedTrack *track = &compressedTracks[trackIndex];
+
+            BAnimTrack bAnimTrack;
+            bAnimTrack.numKeys = track->numKeys;
+            bAnimTrack.keyOffset = track->keyOffset;
+            for (int i = 0; i < 3; i++) {
+                bAnimTrack.rangeMin[i] = track->rangeMin[i];
+                bAnimTrack.rangeExtent[i] = track->rangeExtent[i];
+            }
+            fp->Write(&bAnimTrack, sizeof(bAnimTrack));
+        }
+
+        // --- keys ---
+        int keysCount = keyFrameNums.Count();
+        fp->Write(&keysCount, sizeof(keysCount));
+        fp->Write(keyFrameNums.Ptr(), keyFrameNums.MemoryUsed());
+        fp->Write(keyValues.Ptr(), keyValues.MemoryUsed());
+    } else {
+        // --- frames ---
+        fp->Write(components.Ptr(), components.MemoryUsed());
+    }
     
     // --- total delta ---
     fp->Write(&totalDelta, sizeof(totalDelta));
@@ -0,0 +1,459 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "Core/JointPose.h"
+#include "Core/Heap.h"
+#include "Core/BinSearch.h"
+
+BE_NAMESPACE_BEGIN
+
+// Distance to the virtual vertex of the leaf joints for measuring rotation and scale errors in position
+static const float LeafVirtualVertexDistance = CentiToUnit(3.0f);
+
+// Maximum number of frames between two keys. Bounds the key reduction cost of long clips.
+static const int MaxKeySpan = 256;
+
+static const float Sqrt2 = 1.41421356f;
+
+static const int ChannelComponentBits[Anim::TrackChannel::Count] = {
+    Anim::ComponentBit::Tx | Anim::ComponentBit::Ty | Anim::ComponentBit::Tz,
+    Anim::ComponentBit::Qx | Anim::ComponentBit::Qy | Anim::ComponentBit::Qz,
+    Anim::ComponentBit::Sx | Anim::ComponentBit::Sy | Anim::ComponentBit::Sz
+};
+
+// Smallest three quaternion in 48 bits.
+// The three smallest components are quantized to 15 bits in [-1/sqrt(2), 1/sqrt(2)],
+// and the index of the largest component is stored in the top bits of the first two.
+static void QuantizeQuat(const Quat &q, uint16_t *out) {
+    int largestIndex = 0;
+    for (int i = 1; i < 4; i++) {
+        if (Math::Fabs(q[i]) > Math::Fabs(q[largestIndex])) {
+            largestIndex = i;
+        }
+    }
+
+    // q and -q are the same rotation, so make the largest component positive
+    const float sign = q[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    uint16_t codes[3];
+    for (int i = 0, n = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            float x = (q[i] * sign * Sqrt2 * 0.5f + 0.5f) * 32767.0f + 0.5f;
+            codes[n++] = (uint16_t)Clamp((int)x, 0, 32767);
+        }
+    }
+
+    out[0] = codes[0] | ((largestIndex >> 1) << 15);
+    out[1] = codes[1] | ((largestIndex & 1) << 15);
+    out[2] = codes[2];
+}
+
+static Quat DequantizeQuat(const uint16_t *in) {
+    const int largestIndex = ((in[0] >> 15) << 1) | (in[1] >> 15);
+
+    float c[3];
+    c[0] = ((in[0] & 0x7fff) * (1.0f / 32767.0f) - 0.5f) * Sqrt2;
+    c[1] = ((in[1] & 0x7fff) * (1.0f / 32767.0f) - 0.5f) * Sqrt2;
+    c[2] = ((in[2] & 0x7fff) * (1.0f / 32767.0f) - 0.5f) * Sqrt2;
+
+    Quat q;
+    for (int i = 0, n = 0; i < 4; i++) {
+        if (i != largestIndex) {
+            q[i] = c[n++];
+        }
+    }
+    q[largestIndex] = Math::Sqrt(Max(1.0f - (c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), 0.0f));
+    return q;
+}
+
+// Translation and scale are normalized in the range of the track and quantized to 16 bits for each axis.
+static void QuantizeVec3(const Vec3 &v, const Vec3 &rangeMin, const Vec3 &rangeExtent, uint16_t *out) {
+    for (int i = 0; i < 3; i++) {
+        float x = rangeExtent[i] > 0.0f ? (v[i] - rangeMin[i]) / rangeExtent[i] * 65535.0f + 0.5f : 0.0f;
+        out[i] = (uint16_t)Clamp((int)x, 0, 65535);
+    }
+}
+
+static Vec3 DequantizeVec3(const uint16_t *in, const Vec3 &rangeMin, const Vec3 &rangeExtent) {
+    return Vec3(
+        rangeMin.x + in[0] * rangeExtent.x * (1.0f / 65535.0f),
+        rangeMin.y + in[1] * rangeExtent.y * (1.0f / 65535.0f),
+        rangeMin.z + in[2] * rangeExtent.z * (1.0f / 65535.0f));
+}
+
+static float QuatDot(const Quat &q1, const Quat &q2) {
+    return q1.x * q2.x + q1.y * q2.y + q1.z * q2.z + q1.w * q2.w;
+}
+
+// Normalized lerp in the shortest path. Close enough to slerp between the keys after the key reduction.
+static Quat LerpQuat(const Quat &q1, const Quat &q2, float t) {
+    const float t2 = QuatDot(q1, q2) < 0.0f ? -t : t;
+    Quat q;
+    q.x = q1.x * (1.0f - t) + q2.x * t2;
+    q.y = q1.y * (1.0f - t) + q2.y * t2;
+    q.z = q1.z * (1.0f - t) + q2.z * t2;
+    q.w = q1.w * (1.0f - t) + q2.w * t2;
+    return q.Normalize();
+}
+
+// Returns the keys around the given frame and the fraction between them.
+static float FindKeys(const uint16_t *keyFrameNums, int numKeys, const int *frameTimes, int frameNum, float frameTime, int &key1, int &key2) {
+    key1 = BinSearch_LessEqual<uint16_t>(keyFrameNums, numKeys, (uint16_t)frameNum);
+    key2 = Min(key1 + 1, numKeys - 1);
+    if (key1 == key2) {
+        return 0.0f;
+    }
+
+    const float t1 = (float)frameTimes[keyFrameNums[key1]];
+    const float t2 = (float)frameTimes[keyFrameNums[key2]];
+    return Clamp((frameTime - t1) / (t2 - t1), 0.0f, 1.0f);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Compresses the samples of one channel of a joint.
+// All errors are measured in position at the distance of the farthest descendant joint.
+class AnimTrackCompressor {
+public:
+    AnimTrackCompressor(Anim::TrackChannel::Enum channel, const JointPose *frameJoints, int stride, int numFrames, const int *frameTimes, float distance);
+
+    bool                    IsConstant(float tolerance) const;
+
+                            /// Appends the keys to the key arrays and returns the track.
+    Anim::CompressedTrack   Reduce(float tolerance, Array<uint16_t> &keyFrameNums, Array<uint16_t> &keyValues);
+
+private:
+    Vec4                    GetSample(int frameNum) const;
+    Vec4                    Interpolate(const Vec4 &v1, const Vec4 &v2, float t) const;
+    float                   Error(const Vec4 &v1, const Vec4 &v2) const;
+    float                   QuantizationError() const;
+    bool                    SpanFits(int frameNum1, int frameNum2, float tolerance) const;
+
+    Anim::TrackChannel::Enum channel;
+    const JointPose *       frameJoints;
+    int                     stride;
+    int                     numFrames;
+    const int *             frameTimes;
+    float                   distance;
+
+    Vec3                    rangeMin;
+    Vec3                    rangeExtent;
+    Array<uint16_t>         quantized;      // quantized samples of all frames
+    Array<Vec4>             reconstructed;  // dequantized samples of all frames
+};
+
+AnimTrackCompressor::AnimTrackCompressor(Anim::TrackChannel::Enum channel, const JointPose *frameJoints, int stride, int numFrames, const int *frameTimes, float distance) {
+    this->channel = channel;
+    this->frameJoints = frameJoints;
+    this->stride = stride;
+    this->numFrames = numFrames;
+    this->frameTimes = frameTimes;
+    this->distance = distance;
+
+    rangeMin = Vec3::zero;
+    rangeExtent = Vec3::zero;
+
+    if (channel != Anim::TrackChannel::Rotation) {
+        Vec3 rangeMax;
+        rangeMin = GetSample(0).ToVec3();
+        rangeMax = rangeMin;
+        for (int frameNum = 1; frameNum < numFrames; frameNum++) {
+            const Vec3 v = GetSample(frameNum).ToVec3();
+            rangeMin.x = Min(rangeMin.x, v.x);
+            rangeMin.y = Min(rangeMin.y, v.y);
+            rangeMin.z = Min(rangeMin.z, v.z);
+            rangeMax.x = Max(rangeMax.x, v.x);
+            rangeMax.y = Max(rangeMax.y, v.y);
+            rangeMax.z = Max(rangeMax.z, v.z);
+        }
+        rangeExtent = rangeMax - rangeMin;
+    }
+
+    quantized.SetCount(numFrames * 3);
+    reconstructed.SetCount(numFrames);
+
+    for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+        uint16_t *q = &quantized[frameNum * 3];
+        const Vec4 v = GetSample(frameNum);
+
+        if (channel == Anim::TrackChannel::Rotation) {
+            QuantizeQuat(Quat(v.x, v.y, v.z, v.w), q);
+            const Quat r = DequantizeQuat(q);
+            reconstructed[frameNum] = Vec4(r.x, r.y, r.z, r.w);
+        } else {
+            QuantizeVec3(v.ToVec3(), rangeMin, rangeExtent, q);
+            reconstructed[frameNum] = Vec4(DequantizeVec3(q, rangeMin, rangeExtent), 0.0f);
+        }
+    }
+}
+
+Vec4 AnimTrackCompressor::GetSample(int frameNum) const {
+    const JointPose &joint = frameJoints[frameNum * stride];
+
+    switch (channel) {
+    case Anim::TrackChannel::Translation:
+        return Vec4(joint.t, 0.0f);
+    case Anim::TrackChannel::Rotation:
+        return Vec4(joint.q.x, joint.q.y, joint.q.z, joint.q.w);
+    default:
+        return Vec4(joint.s, 0.0f);
+    }
+}
+
+Vec4 AnimTrackCompressor::Interpolate(const Vec4 &v1, const Vec4 &v2, float t) const {
+    if (channel == Anim::TrackChannel::Rotation) {
+        const Quat q = LerpQuat(Quat(v1.x, v1.y, v1.z, v1.w), Quat(v2.x, v2.y, v2.z, v2.w), t);
+        return Vec4(q.x, q.y, q.z, q.w);
+    }
+    return v1 + (v2 - v1) * t;
+}
+
+float AnimTrackCompressor::Error(const Vec4 &v1, const Vec4 &v2) const {
+    switch (channel) {
+    case Anim::TrackChannel::Translation:
+        return v1.ToVec3().Distance(v2.ToVec3());
+    case Anim::TrackChannel::Rotation: {
+        // Chord length of the rotated virtual vertex
+        const float dot = v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+        return 2.0f * distance * Math::Sqrt(Max(1.0f - dot * dot, 0.0f)); }
+    default:
+        return v1.ToVec3().Distance(v2.ToVec3()) * distance;
+    }
+}
+
+float AnimTrackCompressor::QuantizationError() const {
+    switch (channel) {
+    case Anim::TrackChannel::Translation:
+        return rangeExtent.Length() * (0.5f / 65535.0f);
+    case Anim::TrackChannel::Rotation:
+        // Half step of 15 bits for three components in the rotation angle
+        return distance * 2.0f * Math::Sqrt(3.0f) * (0.5f * Sqrt2 / 32767.0f);
+    default:
+        return rangeExtent.Length() * (0.5f / 65535.0f) * distance;
+    }
+}
+
+bool AnimTrackCompressor::IsConstant(float tolerance) const {
+    const Vec4 v0 = GetSample(0);
+
+    for (int frameNum = 1; frameNum < numFrames; frameNum++) {
+        if (Error(GetSample(frameNum), v0) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AnimTrackCompressor::SpanFits(int frameNum1, int frameNum2, float tolerance) const {
+    const float t1 = (float)frameTimes[frameNum1];
+    const float invDeltaTime = 1.0f / (float)(frameTimes[frameNum2] - frameTimes[frameNum1]);
+
+    for (int frameNum = frameNum1 + 1; frameNum < frameNum2; frameNum++) {
+        const float t = ((float)frameTimes[frameNum] - t1) * invDeltaTime;
+        const Vec4 v = Interpolate(reconstructed[frameNum1], reconstructed[frameNum2], t);
+
+        if (Error(v, GetSample(frameNum)) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Anim::CompressedTrack AnimTrackCompressor::Reduce(float tolerance, Array<uint16_t> &keyFrameNums, Array<uint16_t> &keyValues) {
+    // Quantization error can't be reduced by adding keys
+    tolerance = Max(tolerance, QuantizationError() * 1.01f);
+
+    Anim::CompressedTrack track;
+    track.numKeys = 0;
+    track.keyOffset = keyFrameNums.Count();
+    track.rangeMin = rangeMin;
+    track.rangeExtent = rangeExtent;
+
+    // Greedy key reduction, extends each span as far as all the frames in it are within the tolerance
+    int keyFrameNum = 0;
+    while (1) {
+        keyFrameNums.Append((uint16_t)keyFrameNum);
+        keyValues.Append(quantized[keyFrameNum * 3 + 0]);
+        keyValues.Append(quantized[keyFrameNum * 3 + 1]);
+        keyValues.Append(quantized[keyFrameNum * 3 + 2]);
+        track.numKeys++;
+
+        if (keyFrameNum == numFrames - 1) {
+            break;
+        }
+
+        int nextKeyFrameNum = keyFrameNum + 1;
+        int lastFrameNum = Min(keyFrameNum + MaxKeySpan, numFrames - 1);
+        for (int frameNum = nextKeyFrameNum + 1; frameNum <= lastFrameNum; frameNum++) {
+            if (!SpanFits(keyFrameNum, frameNum, tolerance)) {
+                break;
+            }
+            nextKeyFrameNum = frameNum;
+        }
+
+        keyFrameNum = nextKeyFrameNum;
+    }
+
+    return track;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Anim::Compress(float positionTolerance) {
+    if (isCompressed || numFrames < 2 || !numComponentsPerFrame) {
+        return;
+    }
+
+    if (numFrames > 65536) {
+        BE_WARNLOG("Anim::Compress: too many frames in '%s'\n", hashName.c_str());
+        return;
+    }
+
+    size_t uncompressedSize = components.Allocated();
+
+    // Decode all the frames
+    JointPose *frameJoints = (JointPose *)Mem_Alloc16(numFrames * numJoints * sizeof(JointPose));
+
+    for (int frameNum = 0; frameNum < numFrames; frameNum++) {
+        DecodeRawFrame(frameNum, &frameJoints[frameNum * numJoints]);
+    }
+
+    // Distance from each joint to its farthest descendant.
+    // Rotation and scale errors of a joint displace its descendants as much as this distance.
+    Array<float> jointDistances;
+    jointDistances.SetCount(numJoints);
+    jointDistances.Fill(0.0f);
+
+    for (int jointIndex = numJoints - 1; jointIndex > 0; jointIndex--) {
+        int parentIndex = joints[jointIndex].parentIndex;
+        if (parentIndex >= 0) {
+            jointDistances[parentIndex] = Max(jointDistances[parentIndex], baseFrame[jointIndex].t.Length() + jointDistances[jointIndex]);
+        }
+    }
+
+    jointTracks.SetGranularity(1);
+    jointTracks.SetCount(numJoints * TrackChannel::Count);
+    jointTracks.Fill(-1);
+
+    compressedTracks.Clear();
+    keyFrameNums.Clear();
+    keyValues.Clear();
+
+    for (int jointIndex = 0; jointIndex < numJoints; jointIndex++) {
+        const JointPose *jointFrames = &frameJoints[jointIndex];
+        const float distance = Max(jointDistances[jointIndex], LeafVirtualVertexDistance);
+
+        for (int channel = 0; channel < TrackChannel::Count; channel++) {
+            if (!(joints[jointIndex].componentBits & ChannelComponentBits[channel])) {
+                continue;
+            }
+
+            AnimTrackCompressor compressor((TrackChannel::Enum)channel, jointFrames, numJoints, numFrames, frameTimes.Ptr(), distance);
+
+            // Constant channel is stripped, base frame has the value of the first frame
+            if (compressor.IsConstant(positionTolerance)) {
+                if (channel == TrackChannel::Translation) {
+                    baseFrame[jointIndex].t = jointFrames[0].t;
+                } else if (channel == TrackChannel::Rotation) {
+                    baseFrame[jointIndex].q = jointFrames[0].q;
+                } else {
+                    baseFrame[jointIndex].s = jointFrames[0].s;
+                }
+                continue;
+            }
+
+            jointTracks[jointIndex * TrackChannel::Count + channel] = compressedTracks.Append(compressor.Reduce(positionTolerance, keyFrameNums, keyValues));
+        }
+    }
+
+    Mem_AlignedFree(frameJoints);
+
+    compressedTracks.SetGranularity(1);
+    compressedTracks.Resize(compressedTracks.Count());
+    keyFrameNums.SetGranularity(1);
+    keyFrameNums.Resize(keyFrameNums.Count());
+    keyValues.SetGranularity(1);
+    keyValues.Resize(keyValues.Count());
+
+    components.Clear();
+    numComponentsPerFrame = 0;
+
+    isCompressed = true;
+
+    size_t compressedSize = jointTracks.Allocated() + compressedTracks.Allocated() + keyFrameNums.Allocated() + keyValues.Allocated();
+
+    BE_LOG("Compressed anim '%s': %s -> %s, %i tracks, %.1f%% keys\n", hashName.c_str(),
+        Str::FormatBytes((int)uncompressedSize).c_str(), Str::FormatBytes((int)compressedSize).c_str(), compressedTracks.Count(),
+        compressedTracks.Count() > 0 ? 100.0f * keyFrameNums.Count() / (compressedTracks.Count() * numFrames) : 0.0f);
+}
+
+const Anim::CompressedTrack *Anim::GetCompressedTrack(int jointIndex, TrackChannel::Enum channel) const {
+    int trackIndex = jointTracks[jointIndex * TrackChannel::Count + channel];
+    return trackIndex >= 0 ? &compressedTracks[trackIndex] : nullptr;
+}
+
+float Anim::FrameInterpolationToTime(const FrameInterpolation &frameInterpolation) const {
+    const float t1 = (float)frameTimes[frameInterpolation.frame1];
+    const float t2 = (float)frameTimes[frameInterpolation.frame2];
+    return t1 + (t2 - t1) * frameInterpolation.backlerp;
+}
+
+Vec3 Anim::DecodeCompressedVec3(const CompressedTrack &track, int frameNum, float frameTime) const {
+    int key1, key2;
+    float t = FindKeys(&keyFrameNums[track.keyOffset], track.numKeys, frameTimes.Ptr(), frameNum, frameTime, key1, key2);
+
+    const uint16_t *values = &keyValues[track.keyOffset * 3];
+    const Vec3 v1 = DequantizeVec3(&values[key1 * 3], track.rangeMin, track.rangeExtent);
+    if (t == 0.0f) {
+        return v1;
+    }
+    const Vec3 v2 = DequantizeVec3(&values[key2 * 3], track.rangeMin, track.rangeExtent);
+    return v1 + (v2 - v1) * t;
+}
+
+Quat Anim::DecodeCompressedQuat(const CompressedTrack &track, int frameNum, float frameTime) const {
+    int key1, key2;
+    float t = FindKeys(&keyFrameNums[track.keyOffset], track.numKeys, frameTimes.Ptr(), frameNum, frameTime, key1, key2);
+
+    const uint16_t *values = &keyValues[track.keyOffset * 3];
+    const Quat q1 = DequantizeQuat(&values[key1 * 3]);
+    if (t == 0.0f) {
+        return q1;
+    }
+    const Quat q2 = DequantizeQuat(&values[key2 * 3]);
+    return LerpQuat(q1, q2, t);
+}
+
+void Anim::DecodeCompressedFrame(int frameNum, float frameTime, int numJointIndexes, const int *jointIndexes, JointPose *frame) const {
+    for (int i = 0; i < numJointIndexes; i++) {
+        const int jointIndex = jointIndexes[i];
+        const int32_t *trackIndexes = &jointTracks[jointIndex * TrackChannel::Count];
+
+        if (trackIndexes[TrackChannel::Translation] >= 0) {
+            frame[jointIndex].t = DecodeCompressedVec3(compressedTracks[trackIndexes[TrackChannel::Translation]], frameNum, frameTime);
+        }
+
+        if (trackIndexes[TrackChannel::Rotation] >= 0) {
+            frame[jointIndex].q = DecodeCompressedQuat(compressedTracks[trackIndexes[TrackChannel::Rotation]], frameNum, frameTime);
+        }
+
+        if (trackIndexes[TrackChannel::Scale] >= 0) {
+            frame[jointIndex].s = DecodeCompressedVec3(compressedTracks[trackIndexes[TrackChannel::Scale]], frameNum, frameTime);
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -20,15 +20,16 @@ BE_NAMESPACE_BEGIN
 #define BSKEL_VERSION   1
 
 #define BMESH_IDENT     MAKE_FOURCC('B', 'E', 'M', '1')
-#define BMESH_VERSION   1
+#define BMESH_VERSION   3
 
 #define BANIM_IDENT     MAKE_FOURCC('B', 'E', 'A', '1')
-#define BANIM_VERSION   2
+#define BANIM_VERSION   3
 
 enum BAnimFlag {
     RootTranslationXY   = BIT(0),
     RootTranslationZ    = BIT(1),
     RootRotation        = BIT(2),
+    Compressed          = BIT(3)
 };
 
 #pragma pack(1)
@@ -64,6 +65,15 @@ struct BMeshSurf {
     Vec3            aabbMax;
 };
 
+// Indexes of the surfaces are optimized for the post-transform vertex cache since version 3.
+
+// LOD section follows the surfaces since version 2.
+// Each surface has uint32_t number of LOD levels followed by BMeshSurf of each level.
+struct BMeshLods {
+    uint32_t        numLodLevels;
+    float           screenSizes[MeshSurf::MaxLodLevels];
+};
+
 struct BMeshVert {
     Vec3            position;
     Vec2            texCoord;
@@ -92,6 +102,13 @@ struct BAnimJoint {
     int32_t         componentOffset;
 };
 
+struct BAnimTrack {
+    int32_t         numKeys;
+    int32_t         keyOffset;
+    float           rangeMin[3];
+    float           rangeExtent[3];
+};
+
 #pragma pack()
 
 BE_NAMESPACE_END
@@ -17,6 +17,7 @@
 #include "RenderInternal.h"
 #include "Core/Heap.h"
 #include "Simd/Simd.h"
+#include "Core/JobSystem.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -24,6 +25,16 @@ static constexpr int MEMORY_BLOCK_SIZE = 0x100000;
 
 FrameData   frameData;
 
+FrameData::FrameData() {
+    mem = nullptr;
+    nextFreeBlock = nullptr;
+    lastBlock = nullptr;
+    memset(alloc, 0, sizeof(alloc));
+    sharedAlloc = nullptr;
+    blockMutex = nullptr;
+    sharedAllocMutex = nullptr;
+}
+
 void FrameData::Init() {
     Shutdown();
 
@@ -38,7 +49,12 @@ void FrameData::Init() {
     block->next = nullptr;
 
     this->mem = block;
-    this->alloc = block;
+    this->nextFreeBlock = block;
+    this->lastBlock = block;
+    memset(this->alloc, 0, sizeof(this->alloc));
+    this->sharedAlloc = nullptr;
+    this->blockMutex = (PlatformMutex *)PlatformMutex::Create();
+    this->sharedAllocMutex = (PlatformMutex *)PlatformMutex::Create();
     this->commands.used = 0;
 }
 
@@ -50,11 +66,27 @@ void FrameData::Shutdown() {
     }
     
     this->mem = nullptr;
+    this->nextFreeBlock = nullptr;
+    this->lastBlock = nullptr;
+    memset(this->alloc, 0, sizeof(this->alloc));
+    this->sharedAlloc = nullptr;
+
+    if (this->blockMutex) {
+        PlatformMutex::Destroy(this->blockMutex);
+        this->blockMutex = nullptr;
+    }
+
+    if (this->sharedAllocMutex) {
+        PlatformMutex::Destroy(this->sharedAllocMutex);
+        this->sharedAllocMutex = nullptr;
+    }
 }
 
 void FrameData::ToggleFrame() {
     // reset the mem allocation to the first block
-    this->alloc = this->mem;
+    this->nextFreeBlock = this->mem;
+    memset(this->alloc, 0, sizeof(this->alloc));
+    this->sharedAlloc = nullptr;
 
     // clear all the blocks
     for (MemBlock *block = this->mem; block; block = block->next) {
@@ -62,40 +94,68 @@ void FrameData::ToggleFrame() {
     }
 }
 
-void *FrameData::Alloc(int bytes) {
-    bytes = AlignUp(bytes, 16);
-    MemBlock *block = this->alloc;
-
-    if (block->size - block->used >= bytes) {
-        void *buf = block->base + block->used;
-        block->used += bytes;
-        return buf;
-    }
+FrameData::MemBlock *FrameData::AllocBlock() {
+    PlatformMutex::Lock(blockMutex);
 
-    // advance to the next mem block if available
-    block = block->next;
-    // create a new block if we are at the end of the chain
-    if (!block) {
+    // take the next unused block if available
+    MemBlock *block = this->nextFreeBlock;
+    if (block) {
+        this->nextFreeBlock = block->next;
+    } else {
+        // create a new block if we are at the end of the chain
         int size = MEMORY_BLOCK_SIZE;
         block = (MemBlock *)Mem_Alloc(sizeof(*block) + 15 + size);
         if (!block) {
+            PlatformMutex::Unlock(blockMutex);
             BE_FATALERROR("FrameData::Alloc: Mem_Alloc() failed");
         }
         block->base = (byte *)AlignUp((intptr_t)block + sizeof(*block), 16);
         block->size = size;
         block->used = 0;
         block->next = nullptr;
-        this->alloc->next = block;
+        this->lastBlock->next = block;
+        this->lastBlock = block;
     }
 
-    if (bytes > block->size) {
+    PlatformMutex::Unlock(blockMutex);
+
+    return block;
+}
+
+void *FrameData::AllocFromBlock(MemBlock **block, int bytes) {
+    if (*block && (*block)->size - (*block)->used >= bytes) {
+        void *buf = (*block)->base + (*block)->used;
+        (*block)->used += bytes;
+        return buf;
+    }
+
+    if (bytes > MEMORY_BLOCK_SIZE) {
         BE_FATALERROR("FrameData::Alloc of %i exceeded MEMORY_BLOCK_SIZE", bytes);
     }
 
-    this->alloc = block;
-    block->used = bytes;
+    // advance to the next mem block
+    *block = AllocBlock();
+    (*block)->used = bytes;
+
+    return (*block)->base;
+}
+
+void *FrameData::Alloc(int bytes) {
+    bytes = AlignUp(bytes, 16);
+
+    int threadIndex = jobSystem.GetCurrentWorkerIndex();
+
+    if (threadIndex < 0) {
+        // non-worker threads share a block under the lock
+        PlatformMutex::Lock(sharedAllocMutex);
+        void *buf = AllocFromBlock(&this->sharedAlloc, bytes);
+        PlatformMutex::Unlock(sharedAllocMutex);
+        return buf;
+    }
+
+    assert(threadIndex < MaxAllocThreads);
 
-    return block->base;
+    return AllocFromBlock(&this->alloc[threadIndex], bytes);
 }
 
 void *FrameData::ClearedAlloc(int bytes) {
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "Platform/PlatformThread.h"
 #include "RenderCmd.h"
 
 BE_NAMESPACE_BEGIN
@@ -21,10 +22,16 @@ BE_NAMESPACE_BEGIN
 /// All of the information needed by the back end must be contained in.
 class FrameData {
 public:
+    static constexpr int MaxAllocThreads = 64;
+
+    FrameData();
+
     void                    Init();
     void                    Shutdown();
     void                    ToggleFrame();
 
+                            /// Allocates frame memory. Safe to call from the job system workers concurrently,
+                            /// each worker allocates from its own memory block. Other threads share a block under a lock.
     void *                  Alloc(int bytes);
     void *                  ClearedAlloc(int bytes);
 
@@ -38,8 +45,16 @@ private:
         byte *              base;
     };
 
+    MemBlock *              AllocBlock();
+    void *                  AllocFromBlock(MemBlock **block, int bytes);
+
     MemBlock *              mem;
-    MemBlock *              alloc;
+    MemBlock *              nextFreeBlock;          ///< Next unused block in the chain for this frame
+    MemBlock *              lastBlock;
+    MemBlock *              alloc[MaxAllocThreads]; ///< Current block of each worker
+    MemBlock *              sharedAlloc;            ///< Current block of the non-worker threads
+    PlatformMutex *         blockMutex;
+    PlatformMutex *         sharedAllocMutex;
     RenderCommandBuffer     commands;
 };
 
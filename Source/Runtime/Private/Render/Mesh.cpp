@@ -31,9 +31,21 @@ void Mesh::Purge() {
     }
     surfaces.Clear();
 
+    numLodLevels = 0;
+
     if (isInstantiated) {
         SAFE_DELETE(skinningJointCache);
 
+        if (posedSkinningJoints) {
+            Mem_AlignedFree(posedSkinningJoints);
+            posedSkinningJoints = nullptr;
+        }
+
+        if (poseMutex) {
+            PlatformMutex::Destroy(poseMutex);
+            poseMutex = nullptr;
+        }
+
         if (originalMesh) {
             originalMesh->instantiatedMeshes.RemoveFast(this);
             originalMesh = nullptr;
@@ -47,6 +59,7 @@ MeshSurf *Mesh::AllocSurface(int numVerts, int numIndexes) const {
     MeshSurf *surf = new MeshSurf;
     surf->materialIndex = 0;
     surf->subMesh       = new SubMesh;
+    surf->numLodLevels  = 0;
     surf->drawSurf      = nullptr;
     surf->viewCount     = 0;
     
@@ -60,6 +73,12 @@ void Mesh::FreeSurface(MeshSurf *surf) const {
 
     delete surf->subMesh;
 
+    for (int lodLevel = 0; lodLevel < surf->numLodLevels; lodLevel++) {
+        surf->lodSubMeshes[lodLevel]->FreeSubMesh();
+
+        delete surf->lodSubMeshes[lodLevel];
+    }
+
     SAFE_DELETE(surf);
 }
 
@@ -67,10 +86,16 @@ MeshSurf *Mesh::AllocInstantiatedSurface(const MeshSurf *refSurf, int meshType)
     MeshSurf *surf = new MeshSurf;
     surf->materialIndex = refSurf->materialIndex;
     surf->subMesh       = new SubMesh;
+    surf->numLodLevels  = refSurf->numLodLevels;
     surf->drawSurf      = nullptr;
     surf->viewCount     = 0;
 
-    surf->subMesh->AllocInstantiatedSubMesh(refSurf->subMesh, meshType);
+    surf->subMesh->AllocInstantiatedSubMesh(refSurf->subMesh, meshType, useGpuSkinning);
+
+    for (int lodLevel = 0; lodLevel < refSurf->numLodLevels; lodLevel++) {
+        surf->lodSubMeshes[lodLevel] = new SubMesh;
+        surf->lodSubMeshes[lodLevel]->AllocInstantiatedSubMesh(refSurf->lodSubMeshes[lodLevel], meshType, useGpuSkinning);
+    }
 
     return surf;
 }
@@ -99,11 +124,20 @@ void Mesh::Instantiate(int meshType) {
     if (isSkinnedMesh) {
         useGpuSkinning = SkinningJointCache::CapableGPUJointSkinning((SkinningJointCache::SkinningMethod::Enum)renderGlobal.skinningMethod, numJoints);
 
-        if (useGpuSkinning) {
-            skinningJointCache = new SkinningJointCache(numJoints);
+        // CPU skinning also uses the skinning matrices of the joint cache
+        skinningJointCache = new SkinningJointCache(numJoints);
+
+        if (!poseMutex) {
+            poseMutex = (PlatformMutex *)PlatformMutex::Create();
         }
     }
 
+    // New surfaces are in the bind pose
+    if (posedSkinningJoints) {
+        Mem_AlignedFree(posedSkinningJoints);
+        posedSkinningJoints = nullptr;
+    }
+
     // Free previously allocated surfaces
     if (surfaces.Count() > 0) {
         for (int i = 0; i < surfaces.Count(); i++) {
@@ -116,6 +150,11 @@ void Mesh::Instantiate(int meshType) {
         MeshSurf *surf = AllocInstantiatedSurface(originalMesh->surfaces[surfaceIndex], meshType);
         surfaces.Append(surf);
     }
+
+    numLodLevels = originalMesh->numLodLevels;
+    for (int lodLevel = 0; lodLevel < numLodLevels; lodLevel++) {
+        lodScreenSizes[lodLevel] = originalMesh->lodScreenSizes[lodLevel];
+    }
 }
 
 void Mesh::Reinstantiate() {
@@ -181,6 +220,56 @@ void Mesh::OptimizeIndexedTriangles() {
     }
 }
 
+void Mesh::FreeLods() {
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+
+        for (int lodLevel = 0; lodLevel < surf->numLodLevels; lodLevel++) {
+            surf->lodSubMeshes[lodLevel]->FreeSubMesh();
+
+            delete surf->lodSubMeshes[lodLevel];
+        }
+        surf->numLodLevels = 0;
+    }
+
+    numLodLevels = 0;
+}
+
+void Mesh::SetLodScreenSize(int lodLevel, float screenSize) {
+    assert(lodLevel > 0 && lodLevel <= numLodLevels);
+    lodScreenSizes[lodLevel - 1] = screenSize;
+
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->lodScreenSizes[lodLevel - 1] = screenSize;
+    }
+}
+
+int Mesh::SelectLodLevel(float screenSize, int currentLodLevel) const {
+    // Fraction of the threshold to pass over before switching LOD level to avoid popping
+    static constexpr float LodHysteresis = 0.1f;
+
+    int lodLevel = 0;
+    while (lodLevel < numLodLevels && screenSize < lodScreenSizes[lodLevel]) {
+        lodLevel++;
+    }
+
+    currentLodLevel = Min(currentLodLevel, (int)numLodLevels);
+
+    if (lodLevel > currentLodLevel) {
+        // Switch to coarser level only if the size is smaller enough than the threshold
+        while (lodLevel > currentLodLevel && screenSize >= lodScreenSizes[lodLevel - 1] * (1.0f - LodHysteresis)) {
+            lodLevel--;
+        }
+    } else if (lodLevel < currentLodLevel) {
+        // Switch to finer level only if the size is larger enough than the threshold
+        while (lodLevel < currentLodLevel && screenSize <= lodScreenSizes[lodLevel] * (1.0f + LodHysteresis)) {
+            lodLevel++;
+        }
+    }
+
+    return lodLevel;
+}
+
 void Mesh::Voxelize() {
 }
 
@@ -230,6 +319,32 @@ float Mesh::IntersectRay(const Ray &ray, bool ignoreBackFace) const {
     return FLT_MAX;
 }
 
+void Mesh::PoseTriangleBVHs(const Mat3x4 *skinningJoints) {
+    if (!isSkinnedMesh) {
+        return;
+    }
+
+    PlatformMutex::Lock(poseMutex);
+
+    // Concurrent ray tests with the same pose skin the vertices only once
+    if (!posedSkinningJoints || memcmp(posedSkinningJoints, skinningJoints, sizeof(Mat3x4) * numJoints)) {
+        if (!posedSkinningJoints) {
+            posedSkinningJoints = (Mat3x4 *)Mem_Alloc16(sizeof(Mat3x4) * numJoints);
+        }
+        simdProcessor->Memcpy(posedSkinningJoints, skinningJoints, sizeof(Mat3x4) * numJoints);
+
+        for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+            SubMesh *subMesh = surfaces[surfaceIndex]->subMesh;
+
+            if (subMesh->vertWeights) {
+                subMesh->PoseTriangleBVH(skinningJoints);
+            }
+        }
+    }
+
+    PlatformMutex::Unlock(poseMutex);
+}
+
 void Mesh::SplitMirroredVerts() {
     for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
         surfaces[surfaceIndex]->subMesh->SplitMirroredVerts();
@@ -308,7 +423,7 @@ bool Mesh::IsCompatibleSkeleton(const Skeleton *skeleton) const {
 }
 
 void Mesh::UpdateSkinningJointCache(const Skeleton *skeleton, const Mat3x4 *jointMats) {
-    if (!useGpuSkinning || !skinningJointCache) {
+    if (!skinningJointCache) {
         return;
     }
 
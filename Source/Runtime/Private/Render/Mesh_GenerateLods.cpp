@@ -0,0 +1,743 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    Mesh simplification
+
+    Garland and Heckbert's quadric error metric with half edge collapses.
+    A vertex is always collapsed to one of its neighbors, so the simplified
+    triangles use a subset of the original vertices and all the vertex
+    attributes including the skinning weights are kept as they are.
+
+    Vertices at the same position are welded to find the topology.
+    Attribute seams (UV or normal discontinuities) are collapsed only along
+    the seam so that both sides are collapsed together. Open borders are
+    collapsed only along the border, non-manifold vertices are never moved.
+
+-------------------------------------------------------------------------------
+*/
+
+// Weight of the constraint planes of border and seam edges
+static constexpr double BorderWeight = 10.0;
+static constexpr int    MaxSimplifyPasses = 100;
+static constexpr int    MaxWeldedVerts = 16;
+// Collapses rotating a triangle normal more than about 75 degrees are rejected
+static constexpr float  MinNormalCosAngle = 0.25f;
+// Surfaces are not simplified below this number of triangles
+static constexpr int    MinLodTriangles = 32;
+
+struct Quadric {
+    void                Clear() { a2 = ab = ac = ad = b2 = bc = bd = c2 = cd = d2 = 0.0; }
+
+    void                AddPlane(const Vec3 &normal, float dist, double weight);
+    void                Add(const Quadric &q);
+
+    double              Evaluate(const Vec3 &p) const;
+
+    double              a2, ab, ac, ad;
+    double              b2, bc, bd;
+    double              c2, cd;
+    double              d2;
+};
+
+void Quadric::AddPlane(const Vec3 &normal, float dist, double weight) {
+    const double a = normal.x;
+    const double b = normal.y;
+    const double c = normal.z;
+    const double d = dist;
+
+    a2 += a * a * weight; ab += a * b * weight; ac += a * c * weight; ad += a * d * weight;
+    b2 += b * b * weight; bc += b * c * weight; bd += b * d * weight;
+    c2 += c * c * weight; cd += c * d * weight;
+    d2 += d * d * weight;
+}
+
+void Quadric::Add(const Quadric &q) {
+    a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+    b2 += q.b2; bc += q.bc; bd += q.bd;
+    c2 += q.c2; cd += q.cd;
+    d2 += q.d2;
+}
+
+double Quadric::Evaluate(const Vec3 &p) const {
+    const double x = p.x;
+    const double y = p.y;
+    const double z = p.z;
+
+    return a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x
+        + b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y
+        + c2 * z * z + 2.0 * cd * z
+        + d2;
+}
+
+struct SimplifyEdge {
+    int                 v0, v1;         ///< welded vertices, v0 < v1
+    int                 triIndex;
+    int                 a0, a1;         ///< attribute vertices of the triangle
+};
+
+struct EdgeCollapse {
+    int                 from;
+    int                 to;
+    double              cost;
+};
+
+class MeshSimplifier {
+public:
+    MeshSimplifier(const VertexGenericLit *verts, int numVerts);
+
+                        // Returns the number of simplified indexes.
+    int                 Simplify(const TriIndex *indexes, int numIndexes, int targetNumTris, TriIndex *dstIndexes);
+
+private:
+    struct VertexClass {
+        enum Enum {
+            Free,
+            Border,
+            Locked
+        };
+    };
+
+    void                WeldVertices();
+    void                ComputeQuadrics();
+    void                BuildEdges();
+    void                BuildAdjacency();
+    void                ClassifyVertices();
+    void                AddEdgeConstraint(int triIndex, int v0, int v1, double weight);
+    bool                IsValidCollapse(int from, int to, int &numRemovedTris);
+    void                ApplyCollapses();
+
+    const Vec3 &        Position(int v) const { return verts[v].xyz; }
+
+    const VertexGenericLit *verts;
+    int                 numVerts;
+
+    Array<int>          weld;               // representative vertex of the welded vertices
+    Array<int>          nextWelded;         // circular list of the welded vertices
+
+    Array<int>          tris;               // live triangles with the attribute vertices
+    int                 numTris;
+
+    Array<Quadric>      quadrics;           // per representative vertex
+    Array<SimplifyEdge> edges;              // sorted by welded vertices
+    Array<int>          adjacencyOffsets;   // per representative vertex triangles
+    Array<int>          adjacencyTris;
+    Array<int>          vertexClasses;
+    Array<int>          passMarks;          // vertices changed in this pass
+    Array<int>          attrRemap;          // attribute vertex remap of this pass
+    Array<int>          neighborMarks;
+    int                 neighborMarkCount;
+
+    int                 partnerFrom[MaxWeldedVerts];
+    int                 partnerTo[MaxWeldedVerts];
+    int                 numPartners;
+};
+
+MeshSimplifier::MeshSimplifier(const VertexGenericLit *verts, int numVerts) {
+    this->verts = verts;
+    this->numVerts = numVerts;
+
+    WeldVertices();
+
+    quadrics.SetCount(numVerts);
+    passMarks.SetCount(numVerts);
+    attrRemap.SetCount(numVerts);
+    neighborMarks.SetCount(numVerts);
+    vertexClasses.SetCount(numVerts);
+    adjacencyOffsets.SetCount(numVerts + 1);
+
+    for (int i = 0; i < numVerts; i++) {
+        attrRemap[i] = i;
+        neighborMarks[i] = 0;
+    }
+    neighborMarkCount = 0;
+}
+
+void MeshSimplifier::WeldVertices() {
+    Array<int> sortedVerts;
+    sortedVerts.SetCount(numVerts);
+    for (int i = 0; i < numVerts; i++) {
+        sortedVerts[i] = i;
+    }
+
+    const VertexGenericLit *verts = this->verts;
+    sortedVerts.Sort([verts](int a, int b) {
+        const Vec3 &pa = verts[a].xyz;
+        const Vec3 &pb = verts[b].xyz;
+        if (pa.x != pb.x) {
+            return pa.x < pb.x;
+        }
+        if (pa.y != pb.y) {
+            return pa.y < pb.y;
+        }
+        if (pa.z != pb.z) {
+            return pa.z < pb.z;
+        }
+        return a < b;
+    });
+
+    weld.SetCount(numVerts);
+    nextWelded.SetCount(numVerts);
+
+    for (int i = 0; i < numVerts; ) {
+        int j = i + 1;
+        while (j < numVerts && verts[sortedVerts[j]].xyz == verts[sortedVerts[i]].xyz) {
+            j++;
+        }
+
+        for (int k = i; k < j; k++) {
+            weld[sortedVerts[k]] = sortedVerts[i];
+            nextWelded[sortedVerts[k]] = sortedVerts[k + 1 < j ? k + 1 : i];
+        }
+        i = j;
+    }
+}
+
+void MeshSimplifier::AddEdgeConstraint(int triIndex, int v0, int v1, double weight) {
+    const int *tri = &tris[triIndex * 3];
+    const Vec3 faceNormal = (Position(tri[1]) - Position(tri[0])).Cross(Position(tri[2]) - Position(tri[0]));
+    const Vec3 edgeDir = Position(v1) - Position(v0);
+
+    // Plane containing the edge and perpendicular to the face
+    Vec3 normal = edgeDir.Cross(faceNormal);
+    if (normal.Normalize() == 0.0f) {
+        return;
+    }
+
+    const float dist = -normal.Dot(Position(v0));
+    const double w = weight * edgeDir.LengthSqr();
+
+    quadrics[v0].AddPlane(normal, dist, w);
+    quadrics[v1].AddPlane(normal, dist, w);
+}
+
+void MeshSimplifier::ComputeQuadrics() {
+    for (int i = 0; i < numVerts; i++) {
+        quadrics[i].Clear();
+    }
+
+    for (int triIndex = 0; triIndex < numTris; triIndex++) {
+        const int *tri = &tris[triIndex * 3];
+        const Vec3 &p0 = Position(tri[0]);
+
+        Vec3 normal = (Position(tri[1]) - p0).Cross(Position(tri[2]) - p0);
+        const float area = normal.Normalize();
+        if (area == 0.0f) {
+            continue;
+        }
+
+        const float dist = -normal.Dot(p0);
+
+        for (int k = 0; k < 3; k++) {
+            quadrics[weld[tri[k]]].AddPlane(normal, dist, area);
+        }
+    }
+
+    // Constraint planes to keep the open borders and the attribute seams
+    BuildEdges();
+
+    for (int i = 0; i < edges.Count(); ) {
+        int j = i + 1;
+        while (j < edges.Count() && edges[j].v0 == edges[i].v0 && edges[j].v1 == edges[i].v1) {
+            j++;
+        }
+
+        if (j - i == 1) {
+            AddEdgeConstraint(edges[i].triIndex, edges[i].v0, edges[i].v1, BorderWeight);
+        } else if (j - i == 2 && (edges[i].a0 != edges[i + 1].a0 || edges[i].a1 != edges[i + 1].a1)) {
+            AddEdgeConstraint(edges[i].triIndex, edges[i].v0, edges[i].v1, BorderWeight);
+        }
+        i = j;
+    }
+}
+
+void MeshSimplifier::BuildEdges() {
+    edges.SetCount(numTris * 3);
+
+    for (int triIndex = 0; triIndex < numTris; triIndex++) {
+        const int *tri = &tris[triIndex * 3];
+
+        for (int k = 0; k < 3; k++) {
+            int a0 = tri[k];
+            int a1 = tri[k == 2 ? 0 : k + 1];
+            if (weld[a0] > weld[a1]) {
+                Swap(a0, a1);
+            }
+
+            SimplifyEdge &edge = edges[triIndex * 3 + k];
+            edge.v0 = weld[a0];
+            edge.v1 = weld[a1];
+            edge.a0 = a0;
+            edge.a1 = a1;
+            edge.triIndex = triIndex;
+        }
+    }
+
+    edges.Sort([](const SimplifyEdge &a, const SimplifyEdge &b) {
+        if (a.v0 != b.v0) {
+            return a.v0 < b.v0;
+        }
+        if (a.v1 != b.v1) {
+            return a.v1 < b.v1;
+        }
+        return a.triIndex < b.triIndex;
+    });
+}
+
+void MeshSimplifier::BuildAdjacency() {
+    for (int i = 0; i <= numVerts; i++) {
+        adjacencyOffsets[i] = 0;
+    }
+
+    for (int i = 0; i < numTris * 3; i++) {
+        adjacencyOffsets[weld[tris[i]] + 1]++;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        adjacencyOffsets[i + 1] += adjacencyOffsets[i];
+    }
+
+    adjacencyTris.SetCount(numTris * 3, false);
+
+    // Use passMarks as a temporary counter
+    for (int i = 0; i < numVerts; i++) {
+        passMarks[i] = 0;
+    }
+
+    for (int i = 0; i < numTris * 3; i++) {
+        const int v = weld[tris[i]];
+        adjacencyTris[adjacencyOffsets[v] + passMarks[v]++] = i / 3;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        passMarks[i] = 0;
+    }
+}
+
+void MeshSimplifier::ClassifyVertices() {
+    Array<int> numBorderEdges;
+    numBorderEdges.SetCount(numVerts);
+
+    for (int i = 0; i < numVerts; i++) {
+        vertexClasses[i] = VertexClass::Free;
+        numBorderEdges[i] = 0;
+    }
+
+    for (int i = 0; i < edges.Count(); ) {
+        int j = i + 1;
+        while (j < edges.Count() && edges[j].v0 == edges[i].v0 && edges[j].v1 == edges[i].v1) {
+            j++;
+        }
+
+        if (j - i > 2) {
+            // Non-manifold edge
+            vertexClasses[edges[i].v0] = VertexClass::Locked;
+            vertexClasses[edges[i].v1] = VertexClass::Locked;
+        } else if (j - i == 1) {
+            if (vertexClasses[edges[i].v0] == VertexClass::Free) {
+                vertexClasses[edges[i].v0] = VertexClass::Border;
+            }
+            if (vertexClasses[edges[i].v1] == VertexClass::Free) {
+                vertexClasses[edges[i].v1] = VertexClass::Border;
+            }
+            numBorderEdges[edges[i].v0]++;
+            numBorderEdges[edges[i].v1]++;
+        }
+        i = j;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        // Border vertex shared by more than one border loop
+        if (numBorderEdges[i] > 2) {
+            vertexClasses[i] = VertexClass::Locked;
+        }
+    }
+}
+
+bool MeshSimplifier::IsValidCollapse(int from, int to, int &numRemovedTris) {
+    const int *adjacency = &adjacencyTris[adjacencyOffsets[from]];
+    const int numAdjacentTris = adjacencyOffsets[from + 1] - adjacencyOffsets[from];
+
+    const Vec3 &toPosition = Position(to);
+
+    numRemovedTris = 0;
+
+    // Mark the neighbors of the from vertex
+    const int fromMark = ++neighborMarkCount;
+
+    for (int i = 0; i < numAdjacentTris; i++) {
+        const int *tri = &tris[adjacency[i] * 3];
+        const int w0 = weld[tri[0]];
+        const int w1 = weld[tri[1]];
+        const int w2 = weld[tri[2]];
+
+        if (w0 == to || w1 == to || w2 == to) {
+            numRemovedTris++;
+        } else {
+            // Triangle should not be flipped
+            const Vec3 &p0 = w0 == from ? toPosition : Position(tri[0]);
+            const Vec3 &p1 = w1 == from ? toPosition : Position(tri[1]);
+            const Vec3 &p2 = w2 == from ? toPosition : Position(tri[2]);
+
+            const Vec3 oldNormal = (Position(tri[1]) - Position(tri[0])).Cross(Position(tri[2]) - Position(tri[0]));
+            const Vec3 newNormal = (p1 - p0).Cross(p2 - p0);
+
+            if (oldNormal.Dot(newNormal) <= MinNormalCosAngle * oldNormal.Length() * newNormal.Length()) {
+                return false;
+            }
+        }
+
+        neighborMarks[w0] = fromMark;
+        neighborMarks[w1] = fromMark;
+        neighborMarks[w2] = fromMark;
+    }
+
+    if (numRemovedTris == 0) {
+        return false;
+    }
+
+    // Link condition: the common neighbors should be only the opposite vertices of the collapsing edge
+    const int toMark = ++neighborMarkCount;
+    int numCommonNeighbors = 0;
+
+    const int *toAdjacency = &adjacencyTris[adjacencyOffsets[to]];
+    const int numToAdjacentTris = adjacencyOffsets[to + 1] - adjacencyOffsets[to];
+
+    for (int i = 0; i < numToAdjacentTris; i++) {
+        const int *tri = &tris[toAdjacency[i] * 3];
+
+        for (int k = 0; k < 3; k++) {
+            const int w = weld[tri[k]];
+            if (w == from || w == to) {
+                continue;
+            }
+            if (neighborMarks[w] == fromMark) {
+                // Mark as counted
+                neighborMarks[w] = toMark;
+                numCommonNeighbors++;
+            }
+        }
+    }
+
+    if (numCommonNeighbors != numRemovedTris) {
+        return false;
+    }
+
+    // Find the attribute vertex to collapse to for each attribute vertex of the from vertex
+    numPartners = 0;
+    int a = from;
+    do {
+        int partner = -1;
+        bool referenced = false;
+
+        for (int i = 0; i < numAdjacentTris; i++) {
+            const int *tri = &tris[adjacency[i] * 3];
+            if (tri[0] != a && tri[1] != a && tri[2] != a) {
+                continue;
+            }
+            referenced = true;
+
+            for (int k = 0; k < 3; k++) {
+                if (weld[tri[k]] == to) {
+                    if (partner >= 0 && partner != tri[k]) {
+                        // Seam continues through the to vertex only
+                        return false;
+                    }
+                    partner = tri[k];
+                }
+            }
+        }
+
+        if (referenced) {
+            if (partner < 0 || numPartners == MaxWeldedVerts) {
+                // Collapsing across the seam
+                return false;
+            }
+            partnerFrom[numPartners] = a;
+            partnerTo[numPartners] = partner;
+            numPartners++;
+        }
+
+        a = nextWelded[a];
+    } while (a != from);
+
+    return true;
+}
+
+void MeshSimplifier::ApplyCollapses() {
+    int numLiveTris = 0;
+
+    for (int triIndex = 0; triIndex < numTris; triIndex++) {
+        const int a0 = attrRemap[tris[triIndex * 3 + 0]];
+        const int a1 = attrRemap[tris[triIndex * 3 + 1]];
+        const int a2 = attrRemap[tris[triIndex * 3 + 2]];
+
+        // Remove degenerate triangles
+        if (weld[a0] == weld[a1] || weld[a1] == weld[a2] || weld[a2] == weld[a0]) {
+            continue;
+        }
+
+        tris[numLiveTris * 3 + 0] = a0;
+        tris[numLiveTris * 3 + 1] = a1;
+        tris[numLiveTris * 3 + 2] = a2;
+        numLiveTris++;
+    }
+
+    numTris = numLiveTris;
+
+    for (int i = 0; i < numVerts; i++) {
+        attrRemap[i] = i;
+    }
+}
+
+int MeshSimplifier::Simplify(const TriIndex *indexes, int numIndexes, int targetNumTris, TriIndex *dstIndexes) {
+    tris.SetCount(numIndexes, false);
+    for (int i = 0; i < numIndexes; i++) {
+        tris[i] = indexes[i];
+    }
+    numTris = numIndexes / 3;
+
+    // Remove degenerate triangles of the welded vertices
+    ApplyCollapses();
+
+    ComputeQuadrics();
+
+    Array<EdgeCollapse> collapses;
+
+    for (int pass = 0; pass < MaxSimplifyPasses && numTris > targetNumTris; pass++) {
+        if (pass > 0) {
+            BuildEdges();
+        }
+        BuildAdjacency();
+        ClassifyVertices();
+
+        // Collect the candidates of edge collapses
+        collapses.SetCount(0, false);
+        collapses.Reserve(edges.Count() * 2);
+
+        for (int i = 0; i < edges.Count(); ) {
+            int j = i + 1;
+            while (j < edges.Count() && edges[j].v0 == edges[i].v0 && edges[j].v1 == edges[i].v1) {
+                j++;
+            }
+
+            if (j - i <= 2) {
+                const bool isBorderEdge = (j - i == 1);
+
+                for (int dir = 0; dir < 2; dir++) {
+                    const int from = dir == 0 ? edges[i].v0 : edges[i].v1;
+                    const int to = dir == 0 ? edges[i].v1 : edges[i].v0;
+
+                    if (vertexClasses[from] == VertexClass::Locked) {
+                        continue;
+                    }
+                    // Border vertex can be moved only along the border
+                    if (vertexClasses[from] == VertexClass::Border && !isBorderEdge) {
+                        continue;
+                    }
+
+                    Quadric q = quadrics[from];
+                    q.Add(quadrics[to]);
+
+                    EdgeCollapse collapse;
+                    collapse.from = from;
+                    collapse.to = to;
+                    collapse.cost = q.Evaluate(Position(to));
+                    collapses.Append(collapse);
+                }
+            }
+            i = j;
+        }
+
+        collapses.Sort([](const EdgeCollapse &a, const EdgeCollapse &b) {
+            return a.cost < b.cost;
+        });
+
+        int numCollapses = 0;
+        int numLiveTris = numTris;
+
+        for (int i = 0; i < collapses.Count() && numLiveTris > targetNumTris; i++) {
+            const EdgeCollapse &collapse = collapses[i];
+
+            // Each vertex is changed only once in a pass because the adjacency is not updated
+            if (passMarks[collapse.from] || passMarks[collapse.to]) {
+                continue;
+            }
+
+            int numRemovedTris;
+            if (!IsValidCollapse(collapse.from, collapse.to, numRemovedTris)) {
+                continue;
+            }
+
+            for (int k = 0; k < numPartners; k++) {
+                attrRemap[partnerFrom[k]] = partnerTo[k];
+            }
+
+            quadrics[collapse.to].Add(quadrics[collapse.from]);
+
+            // Lock the one-ring of the from vertex for the rest of this pass
+            const int *adjacency = &adjacencyTris[adjacencyOffsets[collapse.from]];
+            const int numAdjacentTris = adjacencyOffsets[collapse.from + 1] - adjacencyOffsets[collapse.from];
+            for (int t = 0; t < numAdjacentTris; t++) {
+                const int *tri = &tris[adjacency[t] * 3];
+                passMarks[weld[tri[0]]] = 1;
+                passMarks[weld[tri[1]]] = 1;
+                passMarks[weld[tri[2]]] = 1;
+            }
+
+            numLiveTris -= numRemovedTris;
+            numCollapses++;
+        }
+
+        for (int i = 0; i < numVerts; i++) {
+            passMarks[i] = 0;
+        }
+
+        if (numCollapses == 0) {
+            break;
+        }
+
+        ApplyCollapses();
+    }
+
+    for (int i = 0; i < numTris * 3; i++) {
+        dstIndexes[i] = tris[i];
+    }
+    return numTris * 3;
+}
+
+SubMesh *Mesh::AllocLodSubMesh(const SubMesh *subMesh, const TriIndex *lodIndexes, int numLodIndexes) const {
+    // Collect the vertices used in the simplified triangles
+    int *vertexRemap = (int *)Mem_Alloc(sizeof(int) * subMesh->numVerts);
+    for (int i = 0; i < subMesh->numVerts; i++) {
+        vertexRemap[i] = -1;
+    }
+
+    int numLodVerts = 0;
+    for (int i = 0; i < numLodIndexes; i++) {
+        if (vertexRemap[lodIndexes[i]] < 0) {
+            vertexRemap[lodIndexes[i]] = numLodVerts++;
+        }
+    }
+
+    SubMesh *lodSubMesh = new SubMesh;
+    lodSubMesh->AllocSubMesh(numLodVerts, numLodIndexes);
+
+    for (int i = 0; i < subMesh->numVerts; i++) {
+        if (vertexRemap[i] >= 0) {
+            lodSubMesh->verts[vertexRemap[i]] = subMesh->verts[i];
+        }
+    }
+
+    if (subMesh->vertWeights) {
+        const int vertexWeightSize = subMesh->VertexWeightSize();
+        lodSubMesh->vertWeights = Mem_Alloc16(vertexWeightSize * numLodVerts);
+        lodSubMesh->gpuSkinningVersionIndex = subMesh->gpuSkinningVersionIndex;
+
+        for (int i = 0; i < subMesh->numVerts; i++) {
+            if (vertexRemap[i] >= 0) {
+                memcpy((byte *)lodSubMesh->vertWeights + vertexRemap[i] * vertexWeightSize, (const byte *)subMesh->vertWeights + i * vertexWeightSize, vertexWeightSize);
+            }
+        }
+    }
+
+    for (int i = 0; i < numLodIndexes; i++) {
+        lodSubMesh->indexes[i] = vertexRemap[lodIndexes[i]];
+    }
+
+    Mem_Free(vertexRemap);
+
+    lodSubMesh->normalsCalculated = subMesh->normalsCalculated;
+    lodSubMesh->tangentsCalculated = subMesh->tangentsCalculated;
+
+    lodSubMesh->ComputeAABB();
+    lodSubMesh->OptimizeIndexedTriangles(false);
+
+    return lodSubMesh;
+}
+
+void Mesh::GenerateLods(int numLevels, float reductionRatio) {
+    assert(!isInstantiated);
+
+    FreeLods();
+
+    numLevels = Min(numLevels, MeshSurf::MaxLodLevels);
+
+    for (int surfaceIndex = 0; surfaceIndex < surfaces.Count(); surfaceIndex++) {
+        MeshSurf *surf = surfaces[surfaceIndex];
+        const SubMesh *subMesh = surf->subMesh;
+
+        // Joint weights for CPU skinning are stored in vertex order
+        if (subMesh->numJointWeights > 0 || subMesh->numIndexes < 3) {
+            continue;
+        }
+
+        MeshSimplifier simplifier(subMesh->verts, subMesh->numVerts);
+
+        // Each level is simplified from the previous level
+        TriIndex *srcIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * subMesh->numIndexes);
+        TriIndex *dstIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * subMesh->numIndexes);
+        int numSrcIndexes = subMesh->numIndexes;
+
+        memcpy(srcIndexes, subMesh->indexes, sizeof(TriIndex) * numSrcIndexes);
+
+        for (int lodLevel = 1; lodLevel <= numLevels; lodLevel++) {
+            const int targetNumTris = (int)(subMesh->numIndexes / 3 * Math::Pow(reductionRatio, (float)lodLevel));
+            if (targetNumTris < MinLodTriangles) {
+                break;
+            }
+
+            const int numDstIndexes = simplifier.Simplify(srcIndexes, numSrcIndexes, targetNumTris, dstIndexes);
+
+            // Can't be simplified any more
+            if (numDstIndexes == 0 || numDstIndexes >= numSrcIndexes) {
+                break;
+            }
+
+            surf->lodSubMeshes[surf->numLodLevels++] = AllocLodSubMesh(subMesh, dstIndexes, numDstIndexes);
+
+            BE_LOG("surface %i LOD %i: %i tris -> %i tris (%i verts)\n", surfaceIndex, lodLevel,
+                subMesh->numIndexes / 3, numDstIndexes / 3, surf->lodSubMeshes[surf->numLodLevels - 1]->numVerts);
+
+            Swap(srcIndexes, dstIndexes);
+            numSrcIndexes = numDstIndexes;
+        }
+
+        Mem_AlignedFree(srcIndexes);
+        Mem_AlignedFree(dstIndexes);
+
+        numLodLevels = Max(numLodLevels, surf->numLodLevels);
+    }
+
+    // Half of the screen height for the first level, then the threshold goes down
+    // keeping the triangle density on screen the same.
+    for (int lodLevel = 0; lodLevel < numLodLevels; lodLevel++) {
+        lodScreenSizes[lodLevel] = 0.5f * Math::Pow(reductionRatio, lodLevel * 0.5f);
+    }
+
+    for (int i = 0; i < instantiatedMeshes.Count(); i++) {
+        instantiatedMeshes[i]->Reinstantiate();
+    }
+}
+
+BE_NAMESPACE_END
@@ -28,7 +28,7 @@ bool Mesh::LoadBinaryMesh(const char *filename) {
     }
  
     const BMeshHeader *bMeshHeader = (const BMeshHeader *)data;
-    byte *ptr = data + sizeof(BMeshHeader);
+    const byte *ptr = data + sizeof(BMeshHeader);
     
     if (bMeshHeader->ident != BMESH_IDENT) {
         BE_WARNLOG("Mesh::LoadBinaryMesh: bad format %s\n", filename);
@@ -36,6 +36,8 @@ bool Mesh::LoadBinaryMesh(const char *filename) {
         return false;
     }
 
+    const int version = bMeshHeader->version;
+
     numJoints = bMeshHeader->numJoints;
     if (numJoints > 0) {
         joints = new Joint[numJoints];
@@ -61,109 +63,153 @@ bool Mesh::LoadBinaryMesh(const char *filename) {
         MeshSurf *meshSurf = AllocSurface(bMeshSurf->numVerts, bMeshSurf->numIndexes);
         surfaces.Append(meshSurf);
         SubMesh *subMesh = meshSurf->subMesh;
-        subMesh->aabb = AABB(bMeshSurf->aabbMin, bMeshSurf->aabbMax);
 
         meshSurf->materialIndex = bMeshSurf->materialIndex;
 
-        // --- vertexes ---
-        for (int i = 0; i < bMeshSurf->numVerts; i++) {
-            VertexGenericLit *v = &subMesh->verts[i];
-            
-            const BMeshVert *bMeshVert = (const BMeshVert *)ptr;
+        ReadBinarySubMesh(bMeshSurf, ptr, subMesh);
+    }
 
-            v->SetPosition(bMeshVert->position);
-            v->SetTexCoord(bMeshVert->texCoord);
-            v->SetNormal(bMeshVert->normal);
-            v->SetTangent(bMeshVert->tangent);
-            v->SetBiTangent(bMeshVert->bitangent);
-            v->SetColor(bMeshVert->color);
+    // --- LODs ---
+    if (bMeshHeader->version >= 2) {
+        const BMeshLods *bMeshLods = (const BMeshLods *)ptr;
+        ptr += sizeof(BMeshLods);
 
-            ptr += sizeof(BMeshVert);
+        numLodLevels = Min((int)bMeshLods->numLodLevels, MeshSurf::MaxLodLevels);
+        for (int lodLevel = 0; lodLevel < numLodLevels; lodLevel++) {
+            lodScreenSizes[lodLevel] = bMeshLods->screenSizes[lodLevel];
         }
 
-        // --- vertex weights ---
-        if (bMeshSurf->maxWeights > 0) {
-            int vertexWeightSize = 0;
+        for (int surfaceIndex = 0; surfaceIndex < bMeshHeader->numSurfs; surfaceIndex++) {
+            MeshSurf *meshSurf = surfaces[surfaceIndex];
 
-            if (bMeshSurf->maxWeights == 1) {
-                vertexWeightSize = sizeof(VertexWeight1);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 0;
+            const int numSurfLodLevels = *(const uint32_t *)ptr;
+            ptr += sizeof(uint32_t);
 
-                VertexWeight1 *dstPtr = (VertexWeight1 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->jointIndex = *ptr++;
-                }
-            } else if (bMeshSurf->maxWeights <= 4) {
-                vertexWeightSize = sizeof(VertexWeight4);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 1;
-
-                VertexWeight4 *dstPtr = (VertexWeight4 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->jointIndexes[0] = *ptr++;
-                    dstPtr->jointIndexes[1] = *ptr++;
-                    dstPtr->jointIndexes[2] = *ptr++;
-                    dstPtr->jointIndexes[3] = *ptr++;
-
-                    dstPtr->jointWeights[0] = *ptr++;
-                    dstPtr->jointWeights[1] = *ptr++;
-                    dstPtr->jointWeights[2] = *ptr++;
-                    dstPtr->jointWeights[3] = *ptr++;
-                }
-            } else if (bMeshSurf->maxWeights <= 8) {
-                vertexWeightSize = sizeof(VertexWeight8);
-                subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
-                subMesh->gpuSkinningVersionIndex = 2;
-
-                VertexWeight8 *dstPtr = (VertexWeight8 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
-                    dstPtr->jointIndexes[0] = *ptr++;
-                    dstPtr->jointIndexes[1] = *ptr++;
-                    dstPtr->jointIndexes[2] = *ptr++;
-                    dstPtr->jointIndexes[3] = *ptr++;
-                    dstPtr->jointIndexes[4] = *ptr++;
-                    dstPtr->jointIndexes[5] = *ptr++;
-                    dstPtr->jointIndexes[6] = *ptr++;
-                    dstPtr->jointIndexes[7] = *ptr++;
-
-                    dstPtr->jointWeights[0] = *ptr++;
-                    dstPtr->jointWeights[1] = *ptr++;
-                    dstPtr->jointWeights[2] = *ptr++;
-                    dstPtr->jointWeights[3] = *ptr++;
-                    dstPtr->jointWeights[4] = *ptr++;
-                    dstPtr->jointWeights[5] = *ptr++;
-                    dstPtr->jointWeights[6] = *ptr++;
-                    dstPtr->jointWeights[7] = *ptr++;
+            for (int lodLevel = 0; lodLevel < numSurfLodLevels; lodLevel++) {
+                const BMeshSurf *bMeshSurf = (const BMeshSurf *)ptr;
+                ptr += sizeof(BMeshSurf);
+
+                SubMesh *lodSubMesh = new SubMesh;
+                lodSubMesh->AllocSubMesh(bMeshSurf->numVerts, bMeshSurf->numIndexes);
+
+                ReadBinarySubMesh(bMeshSurf, ptr, lodSubMesh);
+
+                lodSubMesh->ComputeEdges();
+
+                if (lodLevel < numLodLevels) {
+                    meshSurf->lodSubMeshes[meshSurf->numLodLevels++] = lodSubMesh;
+                } else {
+                    lodSubMesh->FreeSubMesh();
+                    delete lodSubMesh;
                 }
-            } else {
-                assert(0);
             }
         }
+    }
+
+    fileSystem.FreeFile(data);
+
+    // Optimize the indexes of the old files at load time.
+    FinishSurfaces(version < 3 ? FinishFlag::OptimizeIndices : 0);
+
+    return true;
+}
+
+// Reads vertexes, vertex weights and indexes following the BMeshSurf.
+void Mesh::ReadBinarySubMesh(const BMeshSurf *bMeshSurf, const byte *&ptr, SubMesh *subMesh) const {
+    subMesh->aabb = AABB(bMeshSurf->aabbMin, bMeshSurf->aabbMax);
 
-        // --- indexes ---
-        if (bMeshSurf->indexSize == 4) {
-            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
-                subMesh->indexes[i] = *(uint32_t *)ptr;
-                ptr += sizeof(uint32_t);
+    // --- vertexes ---
+    for (int i = 0; i < bMeshSurf->numVerts; i++) {
+        VertexGenericLit *v = &subMesh->verts[i];
+        
+        const BMeshVert *bMeshVert = (const BMeshVert *)ptr;
+
+        v->SetPosition(bMeshVert->position);
+        v->SetTexCoord(bMeshVert->texCoord);
+        v->SetNormal(bMeshVert->normal);
+        v->SetTangent(bMeshVert->tangent);
+        v->SetBiTangent(bMeshVert->bitangent);
+        v->SetColor(bMeshVert->color);
+
+        ptr += sizeof(BMeshVert);
+    }
+
+    // --- vertex weights ---
+    if (bMeshSurf->maxWeights > 0) {
+        int vertexWeightSize = 0;
+
+        if (bMeshSurf->maxWeights == 1) {
+            vertexWeightSize = sizeof(VertexWeight1);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 0;
+
+            VertexWeight1 *dstPtr = (VertexWeight1 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->jointIndex = *ptr++;
             }
-        } else if (bMeshSurf->indexSize == 2) {
-            for (int i = 0; i < bMeshSurf->numIndexes; i++) {
-                subMesh->indexes[i] = *(uint16_t *)ptr;
-                ptr += sizeof(uint16_t);
+        } else if (bMeshSurf->maxWeights <= 4) {
+            vertexWeightSize = sizeof(VertexWeight4);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 1;
+
+            VertexWeight4 *dstPtr = (VertexWeight4 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->jointIndexes[0] = *ptr++;
+                dstPtr->jointIndexes[1] = *ptr++;
+                dstPtr->jointIndexes[2] = *ptr++;
+                dstPtr->jointIndexes[3] = *ptr++;
+
+                dstPtr->jointWeights[0] = *ptr++;
+                dstPtr->jointWeights[1] = *ptr++;
+                dstPtr->jointWeights[2] = *ptr++;
+                dstPtr->jointWeights[3] = *ptr++;
             }
+        } else if (bMeshSurf->maxWeights <= 8) {
+            vertexWeightSize = sizeof(VertexWeight8);
+            subMesh->vertWeights = Mem_Alloc16(vertexWeightSize * bMeshSurf->numVerts);
+            subMesh->gpuSkinningVersionIndex = 2;
+
+            VertexWeight8 *dstPtr = (VertexWeight8 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf->numVerts; i++, dstPtr++) {
+                dstPtr->jointIndexes[0] = *ptr++;
+                dstPtr->jointIndexes[1] = *ptr++;
+                dstPtr->jointIndexes[2] = *ptr++;
+                dstPtr->jointIndexes[3] = *ptr++;
+                dstPtr->jointIndexes[4] = *ptr++;
+                dstPtr->jointIndexes[5] = *ptr++;
+                dstPtr->jointIndexes[6] = *ptr++;
+                dstPtr->jointIndexes[7] = *ptr++;
+
+                dstPtr->jointWeights[0] = *ptr++;
+                dstPtr->jointWeights[1] = *ptr++;
+                dstPtr->jointWeights[2] = *ptr++;
+                dstPtr->jointWeights[3] = *ptr++;
+                dstPtr->jointWeights[4] = *ptr++;
+                dstPtr->jointWeights[5] = *ptr++;
+                dstPtr->jointWeights[6] = *ptr++;
+                dstPtr->jointWeights[7] = *ptr++;
+            }
+        } else {
+            assert(0);
         }
-
-        // guarantee 8 bytes aligned read
-        long offset = (intptr_t)ptr;
-        ptr += AlignUp(offset, 8) - offset;
     }
 
-    fileSystem.FreeFile(data);
-
-    FinishSurfaces();
+    // --- indexes ---
+    if (bMeshSurf->indexSize == 4) {
+        for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+            subMesh->indexes[i] = *(const uint32_t *)ptr;
+            ptr += sizeof(uint32_t);
+        }
+    } else if (bMeshSurf->indexSize == 2) {
+        for (int i = 0; i < bMeshSurf->numIndexes; i++) {
+            subMesh->indexes[i] = *(const uint16_t *)ptr;
+            ptr += sizeof(uint16_t);
+        }
+    }
 
-    return true;
+    // guarantee 8 bytes aligned read
+    long offset = (intptr_t)ptr;
+    ptr += AlignUp(offset, 8) - offset;
 }
 
 void Mesh::WriteBinaryMesh(const char *filename) {
@@ -173,6 +219,16 @@ void Mesh::WriteBinaryMesh(const char *filename) {
         return;
     }
 
+    BE_LOG("Writing mesh '%s'...\n", filename);
+
+    // Cooked meshes get the default LOD levels unless they already have them.
+    if (numLodLevels == 0 && !isInstantiated) {
+        GenerateLods(DefaultNumLodLevels);
+    }
+
+    // Written indexes are optimized so that the loading doesn't need to.
+    OptimizeIndexedTriangles();
+
     BMeshHeader bMeshHeader;
     bMeshHeader.ident = BMESH_IDENT;
     bMeshHeader.version = BMESH_VERSION;
@@ -197,95 +253,138 @@ void Mesh::WriteBinaryMesh(const char *filename) {
     // --- surfaces ---
     for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
         const MeshSurf *meshSurf = GetSurface(surfaceIndex);
-        const SubMesh *subMesh = meshSurf->subMesh;
-
-        BMeshSurf bMeshSurf;
-        bMeshSurf.materialIndex     = meshSurf->materialIndex;
-        bMeshSurf.numVerts          = subMesh->numVerts;
-        bMeshSurf.numIndexes        = subMesh->numIndexes;
-        bMeshSurf.indexSize         = subMesh->numIndexes < BIT(16) ? sizeof(uint16_t) : sizeof(uint32_t);
-        bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
-        bMeshSurf.aabbMin           = subMesh->GetAABB()[0];
-        bMeshSurf.aabbMax           = subMesh->GetAABB()[1];
-        fp->Write(&bMeshSurf, sizeof(bMeshSurf));
-
-        // --- vertexes ---
-        for (int i = 0; i < subMesh->numVerts; i++) {
-            const VertexGenericLit *v = &subMesh->verts[i];
-
-            BMeshVert bMeshVert;
-            bMeshVert.position = v->GetPosition();
-            bMeshVert.texCoord = v->GetTexCoord();
-            bMeshVert.normal = v->GetNormal();
-            bMeshVert.tangent = v->GetTangent();
-            bMeshVert.bitangent = v->GetBiTangent();
-            bMeshVert.color = v->GetColor();
-            fp->Write(&bMeshVert, sizeof(bMeshVert));
-        }
 
-        // --- vertex weights ---
-        if (bMeshSurf.maxWeights > 0) {
-            if (bMeshSurf.maxWeights == 1) {
-                VertexWeight1 *vw = (VertexWeight1 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndex);
-                }
-            } else if (bMeshSurf.maxWeights <= 4) {
-                VertexWeight4 *vw = (VertexWeight4 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndexes[0]);
-                    fp->WriteUChar(vw->jointIndexes[1]);
-                    fp->WriteUChar(vw->jointIndexes[2]);
-                    fp->WriteUChar(vw->jointIndexes[3]);
-
-                    fp->WriteUChar(vw->jointWeights[0]);
-                    fp->WriteUChar(vw->jointWeights[1]);
-                    fp->WriteUChar(vw->jointWeights[2]);
-                    fp->WriteUChar(vw->jointWeights[3]);
-                }
-            } else if (bMeshSurf.maxWeights <= 8) {
-                VertexWeight8 *vw = (VertexWeight8 *)subMesh->vertWeights;
-                for (int i = 0; i < bMeshSurf.numVerts; i++, vw++) {
-                    fp->WriteUChar(vw->jointIndexes[0]);
-                    fp->WriteUChar(vw->jointIndexes[1]);
-                    fp->WriteUChar(vw->jointIndexes[2]);
-                    fp->WriteUChar(vw->jointIndexes[3]);
-                    fp->WriteUChar(vw->jointIndexes[4]);
-                    fp->WriteUChar(vw->jointIndexes[5]);
-                    fp->WriteUChar(vw->jointIndexes[6]);
-                    fp->WriteUChar(vw->jointIndexes[7]);
-
-                    fp->WriteUChar(vw->jointWeights[0]);
-                    fp->WriteUChar(vw->jointWeights[1]);
-                    fp->WriteUChar(vw->jointWeights[2]);
-                    fp->WriteUChar(vw->jointWeights[3]);
-                    fp->WriteUChar(vw->jointWeights[4]);
-                    fp->WriteUChar(vw->jointWeights[5]);
-                    fp->WriteUChar(vw->jointWeights[6]);
-                    fp->WriteUChar(vw->jointWeights[7]);
-                }
-            }
+        WriteBinarySubMesh(fp, meshSurf->subMesh, meshSurf->materialIndex);
+    }
+
+    // --- LODs ---
+    BMeshLods bMeshLods;
+    memset(&bMeshLods, 0, sizeof(bMeshLods));
+    bMeshLods.numLodLevels = numLodLevels;
+    for (int lodLevel = 0; lodLevel < numLodLevels; lodLevel++) {
+        bMeshLods.screenSizes[lodLevel] = lodScreenSizes[lodLevel];
+    }
+    fp->Write(&bMeshLods, sizeof(bMeshLods));
+
+    for (int surfaceIndex = 0; surfaceIndex < bMeshHeader.numSurfs; surfaceIndex++) {
+        const MeshSurf *meshSurf = GetSurface(surfaceIndex);
+
+        fp->WriteUInt32(meshSurf->numLodLevels);
+
+        for (int lodLevel = 0; lodLevel < meshSurf->numLodLevels; lodLevel++) {
+            WriteBinarySubMesh(fp, meshSurf->lodSubMeshes[lodLevel], meshSurf->materialIndex);
         }
+    }
+
+    fileSystem.CloseFile(fp);
+}
 
-        // --- indexes ---
-        if (subMesh->numIndexes < BIT(16)) {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt16(subMesh->indexes[i]);
+// Writes BMeshSurf followed by vertexes, vertex weights and indexes.
+void Mesh::WriteBinarySubMesh(File *fp, const SubMesh *subMesh, int materialIndex) const {
+    BMeshSurf bMeshSurf;
+    bMeshSurf.materialIndex     = materialIndex;
+    bMeshSurf.numVerts          = subMesh->numVerts;
+    bMeshSurf.numIndexes        = subMesh->numIndexes;
+    bMeshSurf.indexSize         = subMesh->numIndexes < BIT(16) ? sizeof(uint16_t) : sizeof(uint32_t);
+    bMeshSurf.maxWeights        = subMesh->MaxVertexWeights();
+    bMeshSurf.aabbMin           = subMesh->GetAABB()[0];
+    bMeshSurf.aabbMax           = subMesh->GetAABB()[1];
+    fp->Write(&bMeshSurf, sizeof(bMeshSurf));
+
+    // Write in the optimized triangle and vertex order for the post-transform vertex cache and the overdraw
+    TriIndex *optimizedIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * subMesh->numIndexes);
+    int *vertexOrder = (int *)Mem_Alloc(sizeof(int) * subMesh->numVerts);
+
+    subMesh->ComputeOptimizedIndexes(true, optimizedIndexes, vertexOrder);
+
+    float oldACMR, oldATVR;
+    float newACMR, newATVR;
+    SubMesh::GetVertexCacheStats(subMesh->indexes, subMesh->numIndexes, subMesh->numVerts, oldACMR, oldATVR);
+    SubMesh::GetVertexCacheStats(optimizedIndexes, subMesh->numIndexes, subMesh->numVerts, newACMR, newATVR);
+
+    BE_LOG("%i verts, %i tris, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+        subMesh->numVerts, subMesh->numIndexes / 3, oldACMR, newACMR, oldATVR, newATVR);
+
+    // --- vertexes ---
+    for (int i = 0; i < subMesh->numVerts; i++) {
+        const VertexGenericLit *v = &subMesh->verts[vertexOrder[i]];
+
+        BMeshVert bMeshVert;
+        bMeshVert.position = v->GetPosition();
+        bMeshVert.texCoord = v->GetTexCoord();
+        bMeshVert.normal = v->GetNormal();
+        bMeshVert.tangent = v->GetTangent();
+        bMeshVert.bitangent = v->GetBiTangent();
+        bMeshVert.color = v->GetColor();
+        fp->Write(&bMeshVert, sizeof(bMeshVert));
+    }
+
+    // --- vertex weights ---
+    if (bMeshSurf.maxWeights > 0) {
+        if (bMeshSurf.maxWeights == 1) {
+            const VertexWeight1 *vertWeights = (const VertexWeight1 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++) {
+                const VertexWeight1 *vw = &vertWeights[vertexOrder[i]];
+                fp->WriteUChar(vw->jointIndex);
             }
-        } else {
-            for (int i = 0; i < subMesh->numIndexes; i++) {
-                fp->WriteUInt32(subMesh->indexes[i]);
+        } else if (bMeshSurf.maxWeights <= 4) {
+            const VertexWeight4 *vertWeights = (const VertexWeight4 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++) {
+                const VertexWeight4 *vw = &vertWeights[vertexOrder[i]];
+                fp->WriteUChar(vw->jointIndexes[0]);
+                fp->WriteUChar(vw->jointIndexes[1]);
+                fp->WriteUChar(vw->jointIndexes[2]);
+                fp->WriteUChar(vw->jointIndexes[3]);
+
+                fp->WriteUChar(vw->jointWeights[0]);
+                fp->WriteUChar(vw->jointWeights[1]);
+                fp->WriteUChar(vw->jointWeights[2]);
+                fp->WriteUChar(vw->jointWeights[3]);
+            }
+        } else if (bMeshSurf.maxWeights <= 8) {
+            const VertexWeight8 *vertWeights = (const VertexWeight8 *)subMesh->vertWeights;
+            for (int i = 0; i < bMeshSurf.numVerts; i++) {
+                const VertexWeight8 *vw = &vertWeights[vertexOrder[i]];
+                fp->WriteUChar(vw->jointIndexes[0]);
+                fp->WriteUChar(vw->jointIndexes[1]);
+                fp->WriteUChar(vw->jointIndexes[2]);
+                fp->WriteUChar(vw->jointIndexes[3]);
+                fp->WriteUChar(vw->jointIndexes[4]);
+                fp->WriteUChar(vw->jointIndexes[5]);
+                fp->WriteUChar(vw->jointIndexes[6]);
+                fp->WriteUChar(vw->jointIndexes[7]);
+
+                fp->WriteUChar(vw->jointWeights[0]);
+                fp->WriteUChar(vw->jointWeights[1]);
+                fp->WriteUChar(vw->jointWeights[2]);
+                fp->WriteUChar(vw->jointWeights[3]);
+                fp->WriteUChar(vw->jointWeights[4]);
+                fp->WriteUChar(vw->jointWeights[5]);
+                fp->WriteUChar(vw->jointWeights[6]);
+                fp->WriteUChar(vw->jointWeights[7]);
             }
         }
+    }
 
-        // guarantee 8 bytes aligned write
-        byte dummy[8] = { 0, };
-        int offset = fp->Tell();
-        int dummyBytes = AlignUp(offset, 8) - offset;
-        fp->Write(dummy, dummyBytes);
+    // --- indexes ---
+    if (subMesh->numIndexes < BIT(16)) {
+        for (int i = 0; i < subMesh->numIndexes; i++) {
+            fp->WriteUInt16(optimizedIndexes[i]);
+        }
+    } else {
+        for (int i = 0; i < subMesh->numIndexes; i++) {
+            fp->WriteUInt32(optimizedIndexes[i]);
+        }
     }
 
-    fileSystem.CloseFile(fp);
+    Mem_AlignedFree(optimizedIndexes);
+    Mem_Free(vertexOrder);
+
+    // guarantee 8 bytes aligned write
+    byte dummy[8] = { 0, };
+    int offset = fp->Tell();
+    int dummyBytes = AlignUp(offset, 8) - offset;
+    fp->Write(dummy, dummyBytes);
 }
-    
+
 BE_NAMESPACE_END
@@ -26,6 +26,7 @@ void Batch::Init() {
     indirectBuffer = RHI::NullBuffer;
 
     startIndex = -1;
+    vertexOffset = 0;
 
     numVerts = 0;
     numIndexes = 0;
@@ -146,7 +147,8 @@ void Batch::DrawSubMesh(SubMesh *subMesh) {
 }
 
 void Batch::DrawStaticSubMesh(SubMesh *subMesh) {
-    if (this->subMesh && this->subMesh->refSubMesh != subMesh->refSubMesh) {
+    // CPU skinned sub meshes share the reference indexes but have their own vertices
+    if (this->subMesh && (this->subMesh->refSubMesh != subMesh->refSubMesh || this->subMesh->vertexCache != subMesh->vertexCache)) {
         Flush();
     }
 
@@ -156,6 +158,9 @@ void Batch::DrawStaticSubMesh(SubMesh *subMesh) {
         vertexBuffer = subMesh->vertexCache->buffer;
         indexBuffer = subMesh->indexCache->buffer;
 
+        // Always 0 except for the CPU skinned vertices in the dynamic vertex buffer
+        vertexOffset = subMesh->vertexCache->offset;
+
         numVerts = subMesh->numVerts;
         numIndexes = subMesh->numIndexes;
 
@@ -178,6 +183,7 @@ void Batch::DrawDynamicSubMesh(SubMesh *subMesh) {
         }
     }
 
+    vertexOffset = 0;
     vertexBuffer = subMesh->vertexCache->buffer;
     indexBuffer = subMesh->indexCache->buffer;
 
@@ -196,25 +202,25 @@ void Batch::SetSubMeshVertexFormat(const SubMesh *subMesh, int vertexFormatIndex
         if (subMesh->useGpuSkinning) {
             rhi.SetVertexFormat(vertexFormats[vertexFormatIndex + 4 + subMesh->gpuSkinningVersionIndex + 1].vertexFormatHandle);
 
-            rhi.SetStreamSource(0, vertexBuffer, 0, vertexSize);
+            rhi.SetStreamSource(0, vertexBuffer, vertexOffset, vertexSize);
             rhi.SetStreamSource(1, vertexBuffer, vertexSize * numVerts, subMesh->VertexWeightSize());
             rhi.SetStreamSource(2, backEnd.instanceBufferCache->buffer, backEnd.instanceBufferCache->offset, renderGlobal.instanceBufferOffsetAlignment);
         } else {
             rhi.SetVertexFormat(vertexFormats[vertexFormatIndex + 4].vertexFormatHandle);
 
-            rhi.SetStreamSource(0, vertexBuffer, 0, vertexSize);
+            rhi.SetStreamSource(0, vertexBuffer, vertexOffset, vertexSize);
             rhi.SetStreamSource(1, backEnd.instanceBufferCache->buffer, backEnd.instanceBufferCache->offset, renderGlobal.instanceBufferOffsetAlignment);
         }
     } else {
         if (subMesh->useGpuSkinning) {
             rhi.SetVertexFormat(vertexFormats[vertexFormatIndex + subMesh->gpuSkinningVersionIndex + 1].vertexFormatHandle);
 
-            rhi.SetStreamSource(0, vertexBuffer, 0, vertexSize);
+            rhi.SetStreamSource(0, vertexBuffer, vertexOffset, vertexSize);
             rhi.SetStreamSource(1, vertexBuffer, vertexSize * numVerts, subMesh->VertexWeightSize());
         } else {
             rhi.SetVertexFormat(vertexFormats[vertexFormatIndex].vertexFormatHandle);
 
-            rhi.SetStreamSource(0, vertexBuffer, 0, vertexSize);
+            rhi.SetStreamSource(0, vertexBuffer, vertexOffset, vertexSize);
         }
     }
 }
@@ -275,6 +281,7 @@ void Batch::Flush() {
     }
 
     startIndex = -1;
+    vertexOffset = 0;
 
     //vertexBuffer = RHI::NullBuffer;
     //indexBuffer = RHI::NullBuffer;
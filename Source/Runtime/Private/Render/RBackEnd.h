@@ -122,6 +122,7 @@ private:
     RHI::Handle             indirectBuffer;
 
     int                     startIndex;
+    int                     vertexOffset;           // byte offset of the first vertex, used as the base vertex of the static indexes
     int                     numVerts;
     int                     numIndexes;
 
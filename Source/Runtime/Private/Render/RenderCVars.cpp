@@ -119,6 +119,11 @@ CVAR(r_useTwoSidedStencil, "1", CVar::Flag::Bool, "do stencil shadows in one pas
 CVAR(r_useLightScissors, "1", CVar::Flag::Bool, "use custom scissor rectangle for each light");
 CVAR(r_useLightOcclusionQuery, "0", CVar::Flag::Bool, "");
 CVAR(r_usePostProcessing, "1", CVar::Flag::Bool | CVar::Flag::Archive, "");
+CVAR(r_useParallelVisibility, "1", CVar::Flag::Bool, "use parallel jobs for visibility determination");
+CVAR(r_checkParallelVisibility, "0", CVar::Flag::Bool, "compare drawing surfaces of parallel visibility determination with the serial path every frame");
+CVAR(r_useMeshLods, "1", CVar::Flag::Bool | CVar::Flag::Archive, "use simplified mesh LOD levels by projected size on screen");
+CVAR(r_meshLodScale, "1.0", CVar::Flag::Float | CVar::Flag::Archive, "scale of projected size for mesh LOD selection, greater value keeps more detail");
+CVAR(r_forceMeshLod, "-1", CVar::Flag::Integer, "force mesh LOD level, -1 = no force");
 
 CVAR(r_skipBackEnd, "0", CVar::Flag::Bool, "don't draw anything");
 CVAR(r_skipBasePass, "0", CVar::Flag::Bool, "skip base draw pass");
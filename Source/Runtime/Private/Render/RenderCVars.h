@@ -128,6 +128,11 @@ extern CVar     r_useTwoSidedStencil;
 extern CVar     r_useLightScissors;
 extern CVar     r_useLightOcclusionQuery;
 extern CVar     r_usePostProcessing;
+extern CVar     r_useParallelVisibility;
+extern CVar     r_checkParallelVisibility;
+extern CVar     r_useMeshLods;
+extern CVar     r_meshLodScale;
+extern CVar     r_forceMeshLod;
 
 extern CVar     r_skipBackEnd;
 extern CVar     r_skipBasePass;
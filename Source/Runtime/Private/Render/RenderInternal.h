@@ -29,6 +29,8 @@ public:
 
     int                     instanceIndex;
 
+    int                     lodLevel;           // mesh LOD level selected for this camera
+
     EnvProbeBlendInfo       envProbeInfo[2];
 
     bool                    ambientVisible;
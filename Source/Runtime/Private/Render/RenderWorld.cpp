@@ -536,18 +536,30 @@ void RenderWorld::RenderScene(const RenderCamera *renderCamera) {
     }
 
     // Create current camera in frame data
-    currentVisCamera = (VisCamera *)frameData.ClearedAlloc(sizeof(*currentVisCamera));
-    currentVisCamera->def = renderCamera;
-    currentVisCamera->maxDrawSurfs = MaxViewDrawSurfs; 
-    currentVisCamera->drawSurfs = (DrawSurf **)frameData.Alloc(currentVisCamera->maxDrawSurfs * sizeof(DrawSurf *));
-    currentVisCamera->instanceBufferCache = (BufferCache *)frameData.ClearedAlloc(sizeof(BufferCache));
+    currentVisCamera = AllocVisCamera(renderCamera);
 
-    new (&currentVisCamera->visObjects) LinkList<VisObject>();
-    new (&currentVisCamera->visLights) LinkList<VisLight>();
+    // Bring the query trees up to date before the visibility queries
+    objectDbvt.UpdateQueryTree();
+    lightDbvt.UpdateQueryTree();
+    probeDbvt.UpdateQueryTree();
+    staticMeshDbvt.UpdateQueryTree();
 
     DrawCamera(currentVisCamera);
 }
 
+VisCamera *RenderWorld::AllocVisCamera(const RenderCamera *renderCamera) const {
+    VisCamera *visCamera = (VisCamera *)frameData.ClearedAlloc(sizeof(*visCamera));
+    visCamera->def = renderCamera;
+    visCamera->maxDrawSurfs = MaxViewDrawSurfs;
+    visCamera->drawSurfs = (DrawSurf **)frameData.Alloc(visCamera->maxDrawSurfs * sizeof(DrawSurf *));
+    visCamera->instanceBufferCache = (BufferCache *)frameData.ClearedAlloc(sizeof(BufferCache));
+
+    new (&visCamera->visObjects) LinkList<VisObject>();
+    new (&visCamera->visLights) LinkList<VisLight>();
+
+    return visCamera;
+}
+
 void RenderWorld::DrawGUICamera(GuiMesh &guiMesh) {
     BE_PROFILE_CPU_SCOPE("RenderWorld::DrawGUICamera", Color3::yellow);
 
@@ -15,6 +15,8 @@
 #include "Precompiled.h"
 #include "Render/Render.h"
 #include "RenderInternal.h"
+#include "Core/JobSystem.h"
+#include "Core/RadixSort.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -36,6 +38,10 @@ VisObject *RenderWorld::RegisterVisObject(VisCamera *camera, RenderObject *rende
 
     visObject->def = renderObject; 
 
+    renderObject->screenSize = ComputeScreenSize(camera, renderObject);
+
+    visObject->lodLevel = SelectMeshLodLevel(camera, renderObject);
+
     // Connect visObject to renderObject for use in this frame next time.
     renderObject->visObject = visObject;
 
@@ -45,6 +51,39 @@ VisObject *RenderWorld::RegisterVisObject(VisCamera *camera, RenderObject *rende
     return visObject;
 }
 
+// Returns the projected size of the bounding sphere on screen.
+float RenderWorld::ComputeScreenSize(const VisCamera *camera, const RenderObject *renderObject) {
+    if (camera->is2D) {
+        return 1.0f;
+    }
+
+    const RenderCamera::State &cameraDef = camera->def->GetState();
+    const float radius = renderObject->worldAABB.Extents().Length();
+
+    if (cameraDef.orthogonal) {
+        return radius / cameraDef.sizeY;
+    }
+    const float distance = Max(renderObject->worldAABB.Center().Distance(cameraDef.origin), radius);
+    return radius / (distance * Math::Tan(DEG2RAD(cameraDef.fovY) * 0.5f));
+}
+
+// Selects mesh LOD level by the projected size of the bounding sphere on screen.
+int RenderWorld::SelectMeshLodLevel(const VisCamera *camera, RenderObject *renderObject) const {
+    const Mesh *mesh = renderObject->state.mesh;
+    if (!mesh || mesh->NumLodLevels() == 0 || camera->is2D || !r_useMeshLods.GetBool()) {
+        return 0;
+    }
+
+    if (r_forceMeshLod.GetInteger() >= 0) {
+        return Min(r_forceMeshLod.GetInteger(), mesh->NumLodLevels());
+    }
+
+    const float screenSize = renderObject->screenSize * r_meshLodScale.GetFloat();
+
+    renderObject->lodLevel = mesh->SelectLodLevel(screenSize, renderObject->lodLevel);
+    return renderObject->lodLevel;
+}
+
 // Add visLight from renderLight.
 // Prevent to add multiple times in visCamera.
 VisLight *RenderWorld::RegisterVisLight(VisCamera *camera, RenderLight *renderLight) {
@@ -74,12 +113,89 @@ VisLight *RenderWorld::RegisterVisLight(VisCamera *camera, RenderLight *renderLi
     return visLight;
 }
 
-// Add visible lights/objects using bounding view volume.
-void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
-    camera->worldAABB.Clear();
-    camera->visLights.Clear();
-    camera->visObjects.Clear();
+// Returns true if the render object should not be drawn with the camera regardless of its bounds.
+bool RenderWorld::IsObjectExcluded(const VisCamera *camera, const RenderObject *renderObject) {
+    // Skip if object layer is not visible with this camera
+    if (!(BIT(renderObject->state.layer) & camera->def->GetState().layerMask)) {
+        return true;
+    }
+
+    // Skip if camera renders static objects and this object is not static
+    if (camera->def->GetState().flags & RenderCamera::Flag::StaticOnly) {
+        if (!(renderObject->state.staticMask & camera->def->GetState().staticMask)) {
+            return true;
+        }
+    }
+
+    // Skip first person camera only object in sub camera
+    if ((renderObject->state.flags & RenderObject::Flag::FirstPersonOnly) && camera->isSubCamera) {
+        return true;
+    }
+
+    // Skip 3rd person camera only object in sub camera
+    if ((renderObject->state.flags & RenderObject::Flag::ThirdPersonOnly) && !camera->isSubCamera) {
+        return true;
+    }
+
+    return false;
+}
+
+// Computes per camera data of the visible object.
+// This doesn't touch any shared data so it can be called from the job system workers.
+void RenderWorld::SetupVisObject(const VisCamera *camera, VisObject *visObject, const DbvtProxy *proxy) const {
+    const RenderObject *renderObject = visObject->def;
+
+    visObject->ambientVisible = true;
+    visObject->modelViewMatrix = camera->def->viewMatrix * renderObject->GetWorldMatrix();
+    visObject->modelViewProjMatrix = camera->def->viewProjMatrix * renderObject->GetWorldMatrix();
+
+    if (renderObject->state.flags & RenderObject::Flag::Billboard) {
+        Mat3 inverse = (camera->def->viewMatrix.ToMat3() * renderObject->GetWorldMatrix().ToMat3()).Inverse();
+        //inverse = inverse * Mat3(0, 0, 1, 1, 0, 0, 0, 1, 0);
+        Swap(inverse[0], inverse[2]);
+        Swap(inverse[1], inverse[2]);
+
+        Mat3 billboardMatrix = inverse * Mat3::FromScale(renderObject->GetWorldMatrix().ToScaleVec3());
+        visObject->modelViewMatrix *= billboardMatrix;
+        visObject->modelViewProjMatrix *= billboardMatrix;
+    }
+
+    if (renderObject->state.flags & RenderObject::Flag::EnvProbeLit) {
+        Array<EnvProbeBlendInfo> localEnvProbes;
+        GetClosestProbes(proxy->worldAABB, r_probeBlending.GetBool() ? EnvProbeBlending::Blending : EnvProbeBlending::Simple, localEnvProbes);
+
+        if (localEnvProbes.Count() > 0) {
+            visObject->envProbeInfo[0] = localEnvProbes[0];
+        } else {
+            visObject->envProbeInfo[0].envProbe = distantEnvProbe;
+            visObject->envProbeInfo[0].weight = 1.0f;
+        }
+
+        if (localEnvProbes.Count() > 1 && localEnvProbes[1].weight > 0.0f) {
+            visObject->envProbeInfo[1] = localEnvProbes[1];
+        } else {
+            visObject->envProbeInfo[1].envProbe = nullptr;
+            visObject->envProbeInfo[1].weight = 0.0f;
+        }
+    } else {
+        visObject->envProbeInfo[0].envProbe = nullptr;
+        visObject->envProbeInfo[1].envProbe = nullptr;
+    }
+}
+
+void RenderWorld::DebugVisObject(const VisCamera *camera, const VisObject *visObject, const DbvtProxy *proxy) {
+    if (r_showAABB.GetInteger() > 0) {
+        SetDebugColor(Color4::blue, Color4::zero);
+        DebugAABB(proxy->worldAABB, 1, true, r_showAABB.GetInteger() == 1 ? true : false);
+    }
 
+    if (visObject->def->state.numJoints > 0 && r_showSkeleton.GetInteger() > 0) {
+        DebugJoints(visObject->def, r_showSkeleton.GetInteger() == 2, camera->def->GetState().axis);
+    }
+}
+
+// Add visible lights using bounding view volume.
+void RenderWorld::FindVisLights(VisCamera *camera) {
     // Called for each scene lights that intersects with camera frustum.
     // Returns true if it want to proceed next query.
     auto addVisibleLights = [this, camera](int32_t proxyId) -> bool {
@@ -126,6 +242,21 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
         return true;
     };
 
+    if (camera->def->GetState().orthogonal) {
+        lightDbvt.Query(camera->def->box, addVisibleLights);
+    } else {
+        lightDbvt.Query(camera->def->frustum, addVisibleLights);
+    }
+}
+
+// Add visible lights/objects using bounding view volume.
+void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
+    camera->worldAABB.Clear();
+    camera->visLights.Clear();
+    camera->visObjects.Clear();
+
+    FindVisLights(camera);
+
     // Called for each scene objects that intersects with camera frustum.
     // Returns true if it want to proceed next query.
     auto addVisibleObjects = [this, camera](int32_t proxyId) -> bool {
@@ -136,25 +267,7 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
             return true;
         }
 
-        // Skip if object layer is not visible with this camera
-        if (!(BIT(renderObject->state.layer) & camera->def->GetState().layerMask)) {
-            return true;
-        }
-
-        // Skip if camera renders static objects and this object is not static
-        if (camera->def->GetState().flags & RenderCamera::Flag::StaticOnly) {
-            if (!(renderObject->state.staticMask & camera->def->GetState().staticMask)) {
-                return true;
-            }
-        }
-
-        // Skip first person camera only object in sub camera
-        if ((renderObject->state.flags & RenderObject::Flag::FirstPersonOnly) && camera->isSubCamera) {
-            return true;
-        }
-
-        // Skip 3rd person camera only object in sub camera
-        if ((renderObject->state.flags & RenderObject::Flag::ThirdPersonOnly) && !camera->isSubCamera) {
+        if (IsObjectExcluded(camera, renderObject)) {
             return true;
         }
 
@@ -166,62 +279,18 @@ void RenderWorld::FindVisLightsAndObjects(VisCamera *camera) {
         // Register visible object form the render object
         VisObject *visObject = RegisterVisObject(camera, renderObject);
 
-        visObject->ambientVisible = true;
-        visObject->modelViewMatrix = camera->def->viewMatrix * renderObject->GetWorldMatrix();
-        visObject->modelViewProjMatrix = camera->def->viewProjMatrix * renderObject->GetWorldMatrix();
-
-        if (renderObject->state.flags & RenderObject::Flag::Billboard) {
-            Mat3 inverse = (camera->def->viewMatrix.ToMat3() * renderObject->GetWorldMatrix().ToMat3()).Inverse();
-            //inverse = inverse * Mat3(0, 0, 1, 1, 0, 0, 0, 1, 0);
-            Swap(inverse[0], inverse[2]);
-            Swap(inverse[1], inverse[2]);
-
-            Mat3 billboardMatrix = inverse * Mat3::FromScale(renderObject->GetWorldMatrix().ToScaleVec3());
-            visObject->modelViewMatrix *= billboardMatrix;
-            visObject->modelViewProjMatrix *= billboardMatrix;
-        }
+        SetupVisObject(camera, visObject, proxy);
 
         camera->worldAABB.AddAABB(proxy->worldAABB);
 
-        if (renderObject->state.flags & RenderObject::Flag::EnvProbeLit) {
-            Array<EnvProbeBlendInfo> localEnvProbes;
-            GetClosestProbes(proxy->worldAABB, r_probeBlending.GetBool() ? EnvProbeBlending::Blending : EnvProbeBlending::Simple, localEnvProbes);
-
-            if (localEnvProbes.Count() > 0) {
-                visObject->envProbeInfo[0] = localEnvProbes[0];
-            } else {
-                visObject->envProbeInfo[0].envProbe = distantEnvProbe;
-                visObject->envProbeInfo[0].weight = 1.0f;
-            }
-
-            if (localEnvProbes.Count() > 1 && localEnvProbes[1].weight > 0.0f) {
-                visObject->envProbeInfo[1] = localEnvProbes[1];
-            } else {
-                visObject->envProbeInfo[1].envProbe = nullptr;
-                visObject->envProbeInfo[1].weight = 0.0f;
-            }
-        } else {
-            visObject->envProbeInfo[0].envProbe = nullptr;
-            visObject->envProbeInfo[1].envProbe = nullptr;
-        }
-
-        if (r_showAABB.GetInteger() > 0) {
-            SetDebugColor(Color4::blue, Color4::zero);
-            DebugAABB(proxy->worldAABB, 1, true, r_showAABB.GetInteger() == 1 ? true : false);
-        }
-
-        if (visObject->def->state.numJoints > 0 && r_showSkeleton.GetInteger() > 0) {
-            DebugJoints(visObject->def, r_showSkeleton.GetInteger() == 2, camera->def->GetState().axis);
-        }
+        DebugVisObject(camera, visObject, proxy);
 
         return true;
     };
 
     if (camera->def->GetState().orthogonal) {
-        lightDbvt.Query(camera->def->box, addVisibleLights);
         objectDbvt.Query(camera->def->box, addVisibleObjects);
     } else {
-        lightDbvt.Query(camera->def->frustum, addVisibleLights);
         objectDbvt.Query(camera->def->frustum, addVisibleObjects);
     }
 }
@@ -266,7 +335,7 @@ void RenderWorld::AddStaticMeshes(VisCamera *camera) {
         }
 
         VisObject *visObject = proxy->renderObject->visObject;
-        AddDrawSurf(camera, nullptr, visObject, visObject->def->state.materials[surf->materialIndex], surf->subMesh, flags);
+        AddDrawSurf(camera, nullptr, visObject, visObject->def->state.materials[surf->materialIndex], surf->GetLodSubMesh(visObject->lodLevel), flags);
 
         camera->numAmbientSurfs++;
 
@@ -322,7 +391,7 @@ void RenderWorld::AddSkinnedMeshes(VisCamera *camera) {
         for (int surfaceIndex = 0; surfaceIndex < renderObjectDef.mesh->NumSurfaces(); surfaceIndex++) {
             MeshSurf *surf = renderObjectDef.mesh->GetSurface(surfaceIndex);
 
-            AddDrawSurf(camera, nullptr, visObject, renderObjectDef.materials[surf->materialIndex], surf->subMesh, flags);
+            AddDrawSurf(camera, nullptr, visObject, renderObjectDef.materials[surf->materialIndex], surf->GetLodSubMesh(visObject->lodLevel), flags);
 
             camera->numAmbientSurfs++;
 
@@ -486,25 +555,7 @@ void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
             return true;
         }
 
-        // Skip if object layer is not visible with this camera
-        if (!(BIT(renderObject->state.layer) & camera->def->GetState().layerMask)) {
-            return true;
-        }
-
-        // Skip if camera renders static objects and this object is not static
-        if (camera->def->GetState().flags & RenderCamera::Flag::StaticOnly) {
-            if (!(renderObject->state.staticMask & camera->def->GetState().staticMask)) {
-                return true;
-            }
-        }
-
-        // Skip first person camera only object in sub camera.
-        if ((renderObject->state.flags & RenderObject::Flag::FirstPersonOnly) && camera->isSubCamera) {
-            return true;
-        }
-
-        // Skip 3rd person camera only object in sub camera.
-        if ((renderObject->state.flags & RenderObject::Flag::ThirdPersonOnly) && !camera->isSubCamera) {
+        if (IsObjectExcluded(camera, renderObject)) {
             return true;
         }
 
@@ -539,7 +590,7 @@ void RenderWorld::AddStaticMeshesForLights(VisCamera *camera) {
                 VisObject *shadowCasterObject = RegisterVisObject(camera, renderObject);
                 shadowCasterObject->shadowVisible = true;
 
-                AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->subMesh, DrawSurf::Flag::ShadowVisible);
+                AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->GetLodSubMesh(shadowCasterObject->lodLevel), DrawSurf::Flag::ShadowVisible);
 
                 surf->viewCount = this->viewCount;
                 surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
@@ -598,25 +649,7 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
             return true;
         }
 
-        // Skip if object layer is not visible with this camera
-        if (!(BIT(renderObject->state.layer) & camera->def->GetState().layerMask)) {
-            return true;
-        }
-
-        // Skip if camera renders static objects and this object is not static
-        if (camera->def->GetState().flags & RenderCamera::Flag::StaticOnly) {
-            if (!(renderObject->state.staticMask & camera->def->GetState().staticMask)) {
-                return true;
-            }
-        }
-
-        // Skip first person camera only object in sub camera 
-        if ((renderObject->state.flags & RenderObject::Flag::FirstPersonOnly) && camera->isSubCamera) {
-            return true;
-        }
-
-        // Skip 3rd person camera only object in sub camera
-        if ((renderObject->state.flags & RenderObject::Flag::ThirdPersonOnly) && !camera->isSubCamera) {
+        if (IsObjectExcluded(camera, renderObject)) {
             return true;
         }
 
@@ -662,7 +695,7 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
                         shadowCasterObject->def->state.mesh->UpdateSkinningJointCache(shadowCasterObject->def->state.skeleton, shadowCasterObject->def->state.joints);
                     }
 
-                    AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->subMesh, DrawSurf::Flag::ShadowVisible);
+                    AddDrawSurf(camera, visLight, shadowCasterObject, material, surf->GetLodSubMesh(shadowCasterObject->lodLevel), DrawSurf::Flag::ShadowVisible);
 
                     surf->viewCount = this->viewCount;
                     surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
@@ -703,11 +736,19 @@ void RenderWorld::AddSkinnedMeshesForLights(VisCamera *camera) {
     }
 }
 
-void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
+// Cache instance data for instancing.
+// If parallel is true, instance data of the visible objects are written in parallel by the job system workers.
+void RenderWorld::CacheInstanceBuffer(VisCamera *camera, bool parallel) {
     if (renderGlobal.instancingMethod == Mesh::InstancingMethod::NoInstancing) {
         return;
     }
 
+    static Array<const MeshSurf *> instanceSurfs;
+    static Array<VisObject *> instanceObjects;
+
+    instanceSurfs.SetCount(0, false);
+    instanceObjects.SetCount(0, false);
+
     int numInstances = 0;
 
     for (VisObject *visObject = camera->visObjects.Next(); visObject; visObject = visObject->node.Next()) {
@@ -729,42 +770,11 @@ void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
                 continue;
             }
 
-            byte *instanceData = ((byte *)renderGlobal.instanceBufferData + numInstances * renderGlobal.instanceBufferOffsetAlignment);
-
-            const Mat3x4 &localToWorldMatrix = renderObject->GetWorldMatrix();
-            *(Mat3x4 *)instanceData = localToWorldMatrix;
-            instanceData += 48;
-
-            /*if (surf->drawSurf->material->GetPass()->shader->GetPropertyInfoHashMap().Get("_PARALLAX")) {
-                Mat3x4 worldToLocalMatrix = renderObject->GetWorldMatrixInverse();
-                *(Mat3x4 *)instanceData = worldToLocalMatrix; 
-                instanceData += 48;
-            }*/
-
-            if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
-                if (surf->drawSurf->material->GetPass()->useOwnerColor) {
-                    *(uint32_t *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]).ToUInt32();
-                } else {
-                    *(uint32_t *)instanceData = surf->drawSurf->material->GetPass()->constantColor.ToUInt32();
-                }
-                instanceData += sizeof(uint32_t);
+            if (parallel) {
+                instanceObjects.Append(visObject);
+                instanceSurfs.Append(surf);
             } else {
-                if (surf->drawSurf->material->GetPass()->useOwnerColor) {
-                    *(Color4 *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]);
-                } else {
-                    *(Color4 *)instanceData = surf->drawSurf->material->GetPass()->constantColor;
-                }
-                instanceData += sizeof(Color4);
-            }
-
-            if (surf->subMesh->IsGpuSkinning()) {
-                const SkinningJointCache *skinningJointCache = renderObject->state.mesh->skinningJointCache;
-
-                if (renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
-                    *(uint32_t *)instanceData = (uint32_t)skinningJointCache->GetBufferCache().tcBase[0];
-                } else {
-                    *(Vec2 *)instanceData = Vec2(skinningJointCache->GetBufferCache().tcBase[0], skinningJointCache->GetBufferCache().tcBase[1]);
-                }
+                WriteInstanceData(visObject, surf, (byte *)renderGlobal.instanceBufferData + numInstances * renderGlobal.instanceBufferOffsetAlignment);
             }
 
             visObject->instanceIndex = numInstances++;
@@ -772,6 +782,24 @@ void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
         }
     }
 
+    if (parallel && numInstances > 0) {
+        struct WriteInstancesContext {
+            const RenderWorld *     renderWorld;
+            VisObject *const *      visObjects;
+            const MeshSurf *const * surfs;
+        };
+        WriteInstancesContext context = { this, instanceObjects.Ptr(), instanceSurfs.Ptr() };
+
+        jobSystem.ParallelFor(numInstances, 64, [](void *data, int begin, int end) {
+            const WriteInstancesContext *context = (const WriteInstancesContext *)data;
+
+            for (int i = begin; i < end; i++) {
+                byte *instanceData = (byte *)renderGlobal.instanceBufferData + i * renderGlobal.instanceBufferOffsetAlignment;
+                context->renderWorld->WriteInstanceData(context->visObjects[i], context->surfs[i], instanceData);
+            }
+        }, &context);
+    }
+
     if (numInstances > 0) {
         if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
             bufferCacheManager.AllocVertex(numInstances, renderGlobal.instanceBufferOffsetAlignment, renderGlobal.instanceBufferData, camera->instanceBufferCache);
@@ -781,6 +809,47 @@ void RenderWorld::CacheInstanceBuffer(VisCamera *camera) {
     }
 }
 
+// Writes instance data of the visible object to the instance buffer.
+void RenderWorld::WriteInstanceData(const VisObject *visObject, const MeshSurf *surf, byte *instanceData) const {
+    const RenderObject *renderObject = visObject->def;
+
+    const Mat3x4 &localToWorldMatrix = renderObject->GetWorldMatrix();
+    *(Mat3x4 *)instanceData = localToWorldMatrix;
+    instanceData += 48;
+
+    /*if (surf->drawSurf->material->GetPass()->shader->GetPropertyInfoHashMap().Get("_PARALLAX")) {
+        Mat3x4 worldToLocalMatrix = renderObject->GetWorldMatrixInverse();
+        *(Mat3x4 *)instanceData = worldToLocalMatrix; 
+        instanceData += 48;
+    }*/
+
+    if (renderGlobal.instancingMethod == Mesh::InstancingMethod::InstancedArrays) {
+        if (surf->drawSurf->material->GetPass()->useOwnerColor) {
+            *(uint32_t *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]).ToUInt32();
+        } else {
+            *(uint32_t *)instanceData = surf->drawSurf->material->GetPass()->constantColor.ToUInt32();
+        }
+        instanceData += sizeof(uint32_t);
+    } else {
+        if (surf->drawSurf->material->GetPass()->useOwnerColor) {
+            *(Color4 *)instanceData = Color4(&renderObject->state.materialParms[RenderObject::MaterialParm::Red]);
+        } else {
+            *(Color4 *)instanceData = surf->drawSurf->material->GetPass()->constantColor;
+        }
+        instanceData += sizeof(Color4);
+    }
+
+    if (surf->subMesh->IsGpuSkinning()) {
+        const SkinningJointCache *skinningJointCache = renderObject->state.mesh->skinningJointCache;
+
+        if (renderGlobal.vertexTextureMethod == BufferCacheManager::VertexTextureMethod::Tbo) {
+            *(uint32_t *)instanceData = (uint32_t)skinningJointCache->GetBufferCache().tcBase[0];
+        } else {
+            *(Vec2 *)instanceData = Vec2(skinningJointCache->GetBufferCache().tcBase[0], skinningJointCache->GetBufferCache().tcBase[1]);
+        }
+    }
+}
+
 void RenderWorld::OptimizeLights(VisCamera *camera) {
     LinkList<VisLight> *nextNode;
 
@@ -830,16 +899,32 @@ void RenderWorld::OptimizeLights(VisCamera *camera) {
 }
 
 void RenderWorld::DrawCamera(VisCamera *camera) {
+    // Queries and per object setup are distributed to the job system workers.
+    // Results are merged in the same order as the serial path.
+    const bool parallel = r_useParallelVisibility.GetBool() && jobSystem.NumWorkers() > 1;
+
+    if (parallel && r_checkParallelVisibility.GetBool()) {
+        CheckParallelVisibility(camera->def);
+    }
+
     viewCount++;
 
     // Find visible renderLights by querying view frustum in lightDBVT.
     // Then register each visible renderLight to the current camera as VisLight.
     // Find visible renderObjects by querying view frustum in objectDBVT.
     // Then register each visible renderObject to the current camera as VisObject.
-    FindVisLightsAndObjects(camera);
+    if (parallel) {
+        FindVisLightsAndObjectsParallel(camera);
+    } else {
+        FindVisLightsAndObjects(camera);
+    }
 
     // Add drawing surfaces of static meshes by querying view frustum in staticMeshDBVT.
-    AddStaticMeshes(camera);
+    if (parallel) {
+        AddStaticMeshesParallel(camera);
+    } else {
+        AddStaticMeshes(camera);
+    }
 
     // Add drawing surfaces of skinned meshes by searching in visObjects.
     AddSkinnedMeshes(camera);
@@ -857,7 +942,11 @@ void RenderWorld::DrawCamera(VisCamera *camera) {
     
     // Add drawing surfaces of static meshes by querying light BV in staticMeshDBVT.
     // Added drawing surface might be the shadow caster only surface if it is not the visible in the previous steps.
-    AddStaticMeshesForLights(camera);
+    if (parallel) {
+        AddStaticMeshesForLightsParallel(camera);
+    } else {
+        AddStaticMeshesForLights(camera);
+    }
 
     // Add drawing surfaces of skinned meshes by querying light BV in objectMeshDBVT.
     // Added drawing surface might be the shadow caster only surface if it is not the visible in the previous steps.
@@ -867,7 +956,7 @@ void RenderWorld::DrawCamera(VisCamera *camera) {
     OptimizeLights(camera);
 
     // Cache instance data for instancing.
-    CacheInstanceBuffer(camera);
+    CacheInstanceBuffer(camera, parallel);
     
     // Sort drawing surfaces.
     SortDrawSurfs(camera);
@@ -915,6 +1004,31 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
         actualMaterial = materialManager.defaultMaterial;
     }
 
+    if (!bufferCacheManager.IsCached(subMesh->vertexCache)) {
+        if (subMesh->GetType() == Mesh::Type::Reference ||
+            subMesh->GetType() == Mesh::Type::Static ||
+            (subMesh->GetType() == Mesh::Type::Skinned && subMesh->IsGpuSkinning())) {
+            subMesh->CacheStaticDataToGpu();
+        } else if (subMesh->GetType() == Mesh::Type::Skinned) {
+            const SkinningJointCache *skinningJointCache = visObject->def->state.mesh->skinningJointCache;
+            subMesh->CacheSkinnedDataToGpu(skinningJointCache && visObject->def->state.joints ? skinningJointCache->GetSkinningJoints() : nullptr);
+        } else {
+            subMesh->CacheDynamicDataToGpu(actualMaterial);
+        }
+    }
+
+    camera->drawSurfs[camera->numDrawSurfs++] = AllocDrawSurf(camera, visLight, visObject, actualMaterial, subMesh, flags);
+}
+
+// Allocates a drawing surface and computes its sort key.
+// The vertex data of the sub mesh should be cached already.
+// This can be called from the job system workers.
+DrawSurf *RenderWorld::AllocDrawSurf(const VisCamera *camera, const VisLight *visLight, const VisObject *visObject, const Material *material, SubMesh *subMesh, int flags) const {
+    const Material *actualMaterial = material;
+    if (!actualMaterial) {
+        actualMaterial = materialManager.defaultMaterial;
+    }
+
     //if (visObject->def->state.customSkin) {
     //  actualMaterial = (visObject->def->state.customSkin)->RemapMaterialBySkin(material);
     //}
@@ -926,23 +1040,14 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
 
     actualMaterial->GetExprChunk()->Evaluate(localParms, outputValues);*/
 
-    if (!bufferCacheManager.IsCached(subMesh->vertexCache)) {
-        if (subMesh->GetType() == Mesh::Type::Reference ||
-            subMesh->GetType() == Mesh::Type::Static ||
-            subMesh->GetType() == Mesh::Type::Skinned) {
-            subMesh->CacheStaticDataToGpu();
-        } else {
-            subMesh->CacheDynamicDataToGpu(visObject->def->state.joints, actualMaterial);
-        }
-    }
-
     if (renderGlobal.instancingMethod != Mesh::InstancingMethod::NoInstancing) {
         if (actualMaterial->GetPass()->instancingEnabled) {
             if (subMesh->IsGpuSkinning()) {
                 if (renderGlobal.skinningMethod == SkinningJointCache::SkinningMethod::VertexTextureFetchSkinning) {
                     flags |= DrawSurf::Flag::UseInstancing;
                 }
-            } else {
+            } else if (subMesh->GetType() != Mesh::Type::Skinned) {
+                // CPU skinned sub meshes have their own vertices for each instance
                 flags |= DrawSurf::Flag::UseInstancing;
             }
         }
@@ -994,7 +1099,7 @@ void RenderWorld::AddDrawSurf(VisCamera *camera, VisLight *visLight, VisObject *
         drawSurf->sortKey = ((visLightIndex << 52) | (materialSort << 48) | (subMeshIndex << 32) | (materialIndex << 16) | visObjectIndex);
     }
 
-    camera->drawSurfs[camera->numDrawSurfs++] = drawSurf;
+    return drawSurf;
 }
 
 void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visLight, bool shadowVisible, const DrawSurf *visibleDrawSurf) {
@@ -1003,6 +1108,12 @@ void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visL
         return;
     }
 
+    camera->drawSurfs[camera->numDrawSurfs++] = AllocDrawSurfFromAmbient(visLight, shadowVisible, visibleDrawSurf);
+}
+
+// Allocates a lit drawing surface copied from the visible drawing surface.
+// This can be called from the job system workers.
+DrawSurf *RenderWorld::AllocDrawSurfFromAmbient(const VisLight *visLight, bool shadowVisible, const DrawSurf *visibleDrawSurf) const {
     DrawSurf *drawSurf = (DrawSurf *)frameData.Alloc(sizeof(DrawSurf));
     drawSurf->sortKey = (visibleDrawSurf->sortKey & 0x000FFFFFFFFFFFFF) | ((uint64_t)(visLight->index + 1) << 52);
     drawSurf->flags = visibleDrawSurf->flags | (shadowVisible ? DrawSurf::Flag::ShadowVisible : 0);
@@ -1011,25 +1122,26 @@ void RenderWorld::AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *visL
     drawSurf->materialRegisters = visibleDrawSurf->materialRegisters;
     drawSurf->subMesh = visibleDrawSurf->subMesh;
 
-    camera->drawSurfs[camera->numDrawSurfs++] = drawSurf;
+    return drawSurf;
 }
 
-static int BE_CDECL _CompareDrawSurf(const void *elem1, const void *elem2) {
-    const uint64_t sortKey1 = (*(DrawSurf **)elem1)->sortKey;
-    const uint64_t sortKey2 = (*(DrawSurf **)elem2)->sortKey;
+void RenderWorld::SortDrawSurfs(VisCamera *camera) {
+    static Array<uint64_t> sortKeys;
+    static Array<uint64_t> tempSortKeys;
+    static Array<DrawSurf *> tempDrawSurfs;
 
-    if (sortKey1 < sortKey2) {
-        return -1;
-    }
-    if (sortKey1 > sortKey2) {
-        return 1;
+    const int numDrawSurfs = camera->numDrawSurfs;
+
+    sortKeys.SetCount(numDrawSurfs, false);
+    tempSortKeys.SetCount(numDrawSurfs, false);
+    tempDrawSurfs.SetCount(numDrawSurfs, false);
+
+    // Gather keys so that the sort doesn't dereference drawSurfs.
+    for (int i = 0; i < numDrawSurfs; i++) {
+        sortKeys[i] = camera->drawSurfs[i]->sortKey;
     }
-    return 0;
-}
 
-void RenderWorld::SortDrawSurfs(VisCamera *camera) {
-    // FIXME: Use radix sort to boost up speed
-    qsort(camera->drawSurfs, camera->numDrawSurfs, sizeof(DrawSurf *), _CompareDrawSurf);
+    RadixSort64_Parallel(sortKeys.Ptr(), camera->drawSurfs, numDrawSurfs, tempSortKeys.Ptr(), tempDrawSurfs.Ptr());
 
     VisLight *visLight = camera->visLights.Next();
 
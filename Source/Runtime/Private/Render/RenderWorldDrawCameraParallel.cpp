@@ -0,0 +1,466 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Core/JobSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    Parallel visibility determination
+
+    Each stage runs the tree queries and the filtering in the job system workers
+    and writes the results into per job arrays. Then the results are merged in
+    the calling thread in the same order as the serial stage, so registering
+    visible objects and appending drawing surfaces stay deterministic.
+
+-------------------------------------------------------------------------------
+*/
+
+static constexpr int MaxQuerySubtrees = 64;
+
+struct VisibleProxy {
+    VisObject *             visObject;
+    const DbvtProxy *       proxy;
+};
+
+struct StaticMeshSurfEntry {
+    const DbvtProxy *       proxy;
+    DrawSurf *              drawSurf;       ///< nullptr if the sub mesh is not cached yet
+    int                     flags;
+};
+
+struct LitSurfEntry {
+    const DbvtProxy *       proxy;
+    DrawSurf *              drawSurf;       ///< nullptr if this is a shadow caster candidate
+    bool                    isShadowCaster;
+};
+
+// Scratch arrays reused every frame.
+static Array<int32_t> querySubtrees;
+static Array<const DbvtProxy *> subtreeObjectProxies[MaxQuerySubtrees];
+static Array<StaticMeshSurfEntry> subtreeStaticMeshSurfs[MaxQuerySubtrees];
+static Array<VisibleProxy> visibleProxies;
+static Array<VisLight *> litVisLights;
+static Array<Array<LitSurfEntry>> lightLitSurfs;
+
+// Queries the tree with the bounding volume splitting into subtrees, and runs each subtree query in the job system workers.
+// The callback is called with the index of the subtree and the proxy id. Concatenating the results of the subtrees
+// in ascending order of the subtree index gives the same order as DynamicAABBTree::Query().
+// Returns the number of subtrees.
+template <typename BV, typename F>
+static int ParallelQuery(const DynamicAABBTree &tree, const BV &boundingVolume, F &callback) {
+    tree.GetQuerySubtrees(boundingVolume, MaxQuerySubtrees, querySubtrees);
+
+    struct QueryContext {
+        const DynamicAABBTree * tree;
+        const BV *              boundingVolume;
+        const int32_t *         subtrees;
+        F *                     callback;
+    };
+    QueryContext context = { &tree, &boundingVolume, querySubtrees.Ptr(), &callback };
+
+    jobSystem.ParallelFor(querySubtrees.Count(), 1, [](void *data, int begin, int end) {
+        const QueryContext *context = (const QueryContext *)data;
+
+        for (int subtreeIndex = begin; subtreeIndex < end; subtreeIndex++) {
+            auto subtreeCallback = [context, subtreeIndex](int32_t proxyId) -> bool {
+                return (*context->callback)(subtreeIndex, proxyId);
+            };
+            context->tree->QuerySubtree(*context->boundingVolume, context->subtrees[subtreeIndex], subtreeCallback);
+        }
+    }, &context);
+
+    return querySubtrees.Count();
+}
+
+// Add visible lights/objects using bounding view volume.
+// Lights are few so they are still found serially.
+void RenderWorld::FindVisLightsAndObjectsParallel(VisCamera *camera) {
+    camera->worldAABB.Clear();
+    camera->visLights.Clear();
+    camera->visObjects.Clear();
+
+    FindVisLights(camera);
+
+    for (int i = 0; i < MaxQuerySubtrees; i++) {
+        subtreeObjectProxies[i].SetCount(0, false);
+    }
+
+    // Called in the job system workers for each scene objects that intersects with camera frustum.
+    auto filterVisibleObjects = [this, camera](int subtreeIndex, int32_t proxyId) -> bool {
+        const DbvtProxy *proxy = (const DbvtProxy *)objectDbvt.GetUserData(proxyId);
+        const RenderObject *renderObject = proxy->renderObject;
+
+        if (!renderObject) {
+            return true;
+        }
+
+        if (IsObjectExcluded(camera, renderObject)) {
+            return true;
+        }
+
+        // Skip if a object is farther than maximum visible distance
+        if (renderObject->state.worldMatrix.ToTranslationVec3().DistanceSqr(camera->def->GetState().origin) > renderObject->maxVisDistSquared) {
+            return true;
+        }
+
+        subtreeObjectProxies[subtreeIndex].Append(proxy);
+        return true;
+    };
+
+    int numSubtrees;
+    if (camera->def->GetState().orthogonal) {
+        numSubtrees = ParallelQuery(objectDbvt, camera->def->box, filterVisibleObjects);
+    } else {
+        numSubtrees = ParallelQuery(objectDbvt, camera->def->frustum, filterVisibleObjects);
+    }
+
+    // Register visible objects in query order.
+    visibleProxies.SetCount(0, false);
+
+    for (int subtreeIndex = 0; subtreeIndex < numSubtrees; subtreeIndex++) {
+        const Array<const DbvtProxy *> &proxies = subtreeObjectProxies[subtreeIndex];
+
+        for (int i = 0; i < proxies.Count(); i++) {
+            VisibleProxy visibleProxy;
+            visibleProxy.visObject = RegisterVisObject(camera, proxies[i]->renderObject);
+            visibleProxy.proxy = proxies[i];
+            visibleProxies.Append(visibleProxy);
+
+            camera->worldAABB.AddAABB(proxies[i]->worldAABB);
+        }
+    }
+
+    // Compute per camera data of the visible objects.
+    struct SetupContext {
+        const RenderWorld *     renderWorld;
+        const VisCamera *       camera;
+        const VisibleProxy *    visibleProxies;
+    };
+    SetupContext context = { this, camera, visibleProxies.Ptr() };
+
+    jobSystem.ParallelFor(visibleProxies.Count(), 16, [](void *data, int begin, int end) {
+        const SetupContext *context = (const SetupContext *)data;
+
+        for (int i = begin; i < end; i++) {
+            context->renderWorld->SetupVisObject(context->camera, context->visibleProxies[i].visObject, context->visibleProxies[i].proxy);
+        }
+    }, &context);
+
+    for (int i = 0; i < visibleProxies.Count(); i++) {
+        DebugVisObject(camera, visibleProxies[i].visObject, visibleProxies[i].proxy);
+    }
+}
+
+// Add drawing surfaces of visible static meshes.
+void RenderWorld::AddStaticMeshesParallel(VisCamera *camera) {
+    for (int i = 0; i < MaxQuerySubtrees; i++) {
+        subtreeStaticMeshSurfs[i].SetCount(0, false);
+    }
+
+    // Called in the job system workers for each static mesh surfaces intersecting with camera frustum.
+    // Drawing surfaces are allocated here if the sub mesh is cached already.
+    auto filterStaticMeshSurfs = [this, camera](int subtreeIndex, int32_t proxyId) -> bool {
+        const DbvtProxy *proxy = (const DbvtProxy *)staticMeshDbvt.GetUserData(proxyId);
+        const MeshSurf *surf = proxy->mesh->GetSurface(proxy->meshSurfIndex);
+
+        // surf 가 없다면 static mesh 가 아님
+        if (!surf) {
+            return true;
+        }
+
+        if (proxy->renderObject->viewCount != this->viewCount) {
+            return true;
+        }
+
+        int flags = DrawSurf::Flag::Visible;
+        if (proxy->renderObject->state.wireframeMode != RenderObject::WireframeMode::ShowNone || r_showWireframe.GetInteger() > 0) {
+            flags |= DrawSurf::Flag::ShowWires;
+        }
+
+        StaticMeshSurfEntry entry;
+        entry.proxy = proxy;
+        entry.flags = flags;
+        entry.drawSurf = nullptr;
+
+        const VisObject *visObject = proxy->renderObject->visObject;
+        SubMesh *subMesh = surf->GetLodSubMesh(visObject->lodLevel);
+
+        if (bufferCacheManager.IsCached(subMesh->vertexCache)) {
+            entry.drawSurf = AllocDrawSurf(camera, nullptr, visObject, visObject->def->state.materials[surf->materialIndex], subMesh, flags);
+        }
+
+        subtreeStaticMeshSurfs[subtreeIndex].Append(entry);
+        return true;
+    };
+
+    int numSubtrees;
+    if (camera->def->GetState().orthogonal) {
+        numSubtrees = ParallelQuery(staticMeshDbvt, camera->def->box, filterStaticMeshSurfs);
+    } else {
+        numSubtrees = ParallelQuery(staticMeshDbvt, camera->def->frustum, filterStaticMeshSurfs);
+    }
+
+    for (int subtreeIndex = 0; subtreeIndex < numSubtrees; subtreeIndex++) {
+        const Array<StaticMeshSurfEntry> &entries = subtreeStaticMeshSurfs[subtreeIndex];
+
+        for (int i = 0; i < entries.Count(); i++) {
+            const StaticMeshSurfEntry &entry = entries[i];
+            MeshSurf *surf = entry.proxy->mesh->GetSurface(entry.proxy->meshSurfIndex);
+            VisObject *visObject = entry.proxy->renderObject->visObject;
+
+            if (entry.drawSurf) {
+                if (camera->numDrawSurfs + 1 > camera->maxDrawSurfs) {
+                    BE_WARNLOG("RenderWorld::AddStaticMeshesParallel: not enough renderable surfaces\n");
+                    return;
+                }
+                camera->drawSurfs[camera->numDrawSurfs++] = entry.drawSurf;
+            } else {
+                // Uploading vertex data should be done in this thread.
+                AddDrawSurf(camera, nullptr, visObject, visObject->def->state.materials[surf->materialIndex], surf->GetLodSubMesh(visObject->lodLevel), entry.flags);
+            }
+
+            camera->numAmbientSurfs++;
+
+            surf->viewCount = this->viewCount;
+            surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
+
+            if (r_showAABB.GetInteger() > 0) {
+                SetDebugColor(Color4(1, 1, 1, 0.5), Color4::zero);
+                DebugAABB(entry.proxy->worldAABB, 1, true, r_showAABB.GetInteger() == 1 ? true : false);
+            }
+        }
+    }
+}
+
+// Add lit drawing surfaces of visible static meshes for each light.
+// Each light is queried in a job. Lit surfaces of the visible surfaces are allocated in the job,
+// and shadow caster candidates are registered in the merge, because a surface registered
+// as a shadow caster of a light is skipped for the following lights.
+void RenderWorld::AddStaticMeshesForLightsParallel(VisCamera *camera) {
+    litVisLights.SetCount(0, false);
+
+    for (VisLight *visLight = camera->visLights.Next(); visLight; visLight = visLight->node.Next()) {
+        if (!(BIT(visLight->def->state.layer) & camera->def->GetState().layerMask)) {
+            continue;
+        }
+
+        litVisLights.Append(visLight);
+    }
+
+    if (lightLitSurfs.Count() < litVisLights.Count()) {
+        lightLitSurfs.SetCount(litVisLights.Count());
+    }
+    for (int i = 0; i < litVisLights.Count(); i++) {
+        lightLitSurfs[i].SetCount(0, false);
+    }
+
+    struct QueryContext {
+        const RenderWorld *     renderWorld;
+        const VisCamera *       camera;
+    };
+    QueryContext context = { this, camera };
+
+    jobSystem.ParallelFor(litVisLights.Count(), 1, [](void *data, int begin, int end) {
+        const QueryContext *context = (const QueryContext *)data;
+        const RenderWorld *renderWorld = context->renderWorld;
+        const VisCamera *camera = context->camera;
+
+        for (int lightIndex = begin; lightIndex < end; lightIndex++) {
+            const VisLight *visLight = litVisLights[lightIndex];
+            Array<LitSurfEntry> &entries = lightLitSurfs[lightIndex];
+
+            // Called for static mesh surfaces intersecting with the light volume.
+            auto filterStaticMeshSurfsForLight = [renderWorld, camera, visLight, &entries](int32_t proxyId) -> bool {
+                const DbvtProxy *proxy = (const DbvtProxy *)renderWorld->staticMeshDbvt.GetUserData(proxyId);
+                const RenderObject *renderObject = proxy->renderObject;
+
+                const MeshSurf *surf = proxy->mesh->GetSurface(proxy->meshSurfIndex);
+
+                if (!surf) {
+                    return true;
+                }
+
+                if (IsObjectExcluded(camera, renderObject)) {
+                    return true;
+                }
+
+                // Skip if the object is farther than maximum visible distance.
+                if (renderObject->state.worldMatrix.ToTranslationVec3().DistanceSqr(camera->def->state.origin) > renderObject->maxVisDistSquared) {
+                    return true;
+                }
+
+                const Material *material = renderObject->state.materials[surf->materialIndex];
+
+                bool isShadowCaster = (visLight->def->state.flags & RenderLight::Flag::CastShadows) && (renderObject->state.flags & RenderObject::Flag::CastShadows) && material->IsShadowCaster();
+
+                LitSurfEntry entry;
+                entry.proxy = proxy;
+                entry.isShadowCaster = isShadowCaster;
+
+                // Already visible in this frame.
+                if (surf->viewCount == renderWorld->viewCount) {
+                    if ((surf->drawSurf->flags & DrawSurf::Flag::Visible) && material->IsLitSurface()) {
+                        entry.drawSurf = renderWorld->AllocDrawSurfFromAmbient(visLight, isShadowCaster, surf->drawSurf);
+                        entries.Append(entry);
+                    }
+                } else if (isShadowCaster) {
+                    OBB surfBounds = OBB(surf->subMesh->GetAABB(), renderObject->state.worldMatrix);
+
+                    if (!visLight->def->CullShadowCaster(surfBounds, camera->def->frustum, camera->worldAABB)) {
+                        entry.drawSurf = nullptr;
+                        entries.Append(entry);
+                    }
+                }
+
+                return true;
+            };
+
+            const RenderLight *renderLight = visLight->def;
+
+            switch (renderLight->state.type) {
+            case RenderLight::Type::Directional:
+                renderWorld->staticMeshDbvt.Query(renderLight->worldOBB, filterStaticMeshSurfsForLight);
+                break;
+            case RenderLight::Type::Point:
+                if (renderLight->IsRadiusUniform()) {
+                    renderWorld->staticMeshDbvt.Query(Sphere(renderLight->GetOrigin(), renderLight->GetRadius()[0]), filterStaticMeshSurfsForLight);
+                } else {
+                    renderWorld->staticMeshDbvt.Query(renderLight->worldOBB, filterStaticMeshSurfsForLight);
+                }
+                break;
+            case RenderLight::Type::Spot:
+                renderWorld->staticMeshDbvt.Query(renderLight->worldFrustum, filterStaticMeshSurfsForLight);
+                break;
+            default:
+                break;
+            }
+        }
+    }, &context);
+
+    for (int lightIndex = 0; lightIndex < litVisLights.Count(); lightIndex++) {
+        VisLight *visLight = litVisLights[lightIndex];
+        const Array<LitSurfEntry> &entries = lightLitSurfs[lightIndex];
+
+        for (int i = 0; i < entries.Count(); i++) {
+            const LitSurfEntry &entry = entries[i];
+
+            if (entry.drawSurf) {
+                if (camera->numDrawSurfs + 1 > camera->maxDrawSurfs) {
+                    BE_WARNLOG("RenderWorld::AddStaticMeshesForLightsParallel: not enough renderable surfaces\n");
+                    return;
+                }
+                camera->drawSurfs[camera->numDrawSurfs++] = entry.drawSurf;
+
+                visLight->numDrawSurfs++;
+                visLight->litSurfsAABB.AddAABB(entry.proxy->worldAABB);
+
+                if (entry.isShadowCaster) {
+                    visLight->shadowCastersAABB.AddAABB(entry.proxy->worldAABB);
+                }
+                continue;
+            }
+
+            MeshSurf *surf = entry.proxy->mesh->GetSurface(entry.proxy->meshSurfIndex);
+
+            // Already registered as a shadow caster of the previous light.
+            if (surf->viewCount == this->viewCount) {
+                continue;
+            }
+
+            RenderObject *renderObject = entry.proxy->renderObject;
+
+            // This surface is not visible but shadow might be visible as a shadow caster.
+            // Register a visObject used only for shadow caster.
+            VisObject *shadowCasterObject = RegisterVisObject(camera, renderObject);
+            shadowCasterObject->shadowVisible = true;
+
+            AddDrawSurf(camera, visLight, shadowCasterObject, renderObject->state.materials[surf->materialIndex], surf->GetLodSubMesh(shadowCasterObject->lodLevel), DrawSurf::Flag::ShadowVisible);
+
+            surf->viewCount = this->viewCount;
+            surf->drawSurf = camera->drawSurfs[camera->numDrawSurfs - 1];
+
+            visLight->numDrawSurfs++;
+            visLight->shadowCastersAABB.AddAABB(entry.proxy->worldAABB);
+        }
+    }
+}
+
+// Runs the stages which have a parallel version both serially and in parallel with scratch cameras,
+// and reports the first difference of the visible lights, the visible objects or the drawing surfaces.
+void RenderWorld::CheckParallelVisibility(const RenderCamera *renderCamera) {
+    VisCamera *serialCamera = AllocVisCamera(renderCamera);
+
+    viewCount++;
+    FindVisLightsAndObjects(serialCamera);
+    AddStaticMeshes(serialCamera);
+    AddStaticMeshesForLights(serialCamera);
+
+    VisCamera *parallelCamera = AllocVisCamera(renderCamera);
+
+    viewCount++;
+    FindVisLightsAndObjectsParallel(parallelCamera);
+    AddStaticMeshesParallel(parallelCamera);
+    AddStaticMeshesForLightsParallel(parallelCamera);
+
+    if (serialCamera->numVisibleLights != parallelCamera->numVisibleLights ||
+        serialCamera->numVisibleObjects != parallelCamera->numVisibleObjects ||
+        serialCamera->numAmbientSurfs != parallelCamera->numAmbientSurfs ||
+        serialCamera->numDrawSurfs != parallelCamera->numDrawSurfs) {
+        BE_WARNLOG("RenderWorld::CheckParallelVisibility: %i lights, %i objects, %i surfaces with serial path but %i lights, %i objects, %i surfaces with parallel path\n",
+            serialCamera->numVisibleLights, serialCamera->numVisibleObjects, serialCamera->numDrawSurfs,
+            parallelCamera->numVisibleLights, parallelCamera->numVisibleObjects, parallelCamera->numDrawSurfs);
+        return;
+    }
+
+    const VisLight *parallelVisLight = parallelCamera->visLights.Next();
+    for (const VisLight *visLight = serialCamera->visLights.Next(); visLight; visLight = visLight->node.Next()) {
+        if (visLight->def != parallelVisLight->def || visLight->numDrawSurfs != parallelVisLight->numDrawSurfs) {
+            BE_WARNLOG("RenderWorld::CheckParallelVisibility: visible light %i differs\n", visLight->index);
+            return;
+        }
+        parallelVisLight = parallelVisLight->node.Next();
+    }
+
+    const VisObject *parallelVisObject = parallelCamera->visObjects.Next();
+    for (const VisObject *visObject = serialCamera->visObjects.Next(); visObject; visObject = visObject->node.Next()) {
+        if (visObject->def != parallelVisObject->def || visObject->lodLevel != parallelVisObject->lodLevel) {
+            BE_WARNLOG("RenderWorld::CheckParallelVisibility: visible object %i differs\n", visObject->index);
+            return;
+        }
+        parallelVisObject = parallelVisObject->node.Next();
+    }
+
+    for (int i = 0; i < serialCamera->numDrawSurfs; i++) {
+        const DrawSurf *drawSurf = serialCamera->drawSurfs[i];
+        const DrawSurf *parallelDrawSurf = parallelCamera->drawSurfs[i];
+
+        if (drawSurf->sortKey != parallelDrawSurf->sortKey ||
+            drawSurf->flags != parallelDrawSurf->flags ||
+            drawSurf->subMesh != parallelDrawSurf->subMesh ||
+            drawSurf->material != parallelDrawSurf->material ||
+            drawSurf->space->def != parallelDrawSurf->space->def ||
+            drawSurf->space->index != parallelDrawSurf->space->index) {
+            BE_WARNLOG("RenderWorld::CheckParallelVisibility: drawing surface %i differs\n", i);
+            return;
+        }
+    }
+}
+
+BE_NAMESPACE_END
@@ -52,7 +52,9 @@ void SkinningJointCache::Update(const Skeleton *skeleton, const Mat3x4 *jointMat
 
     viewFrameCount = renderSystem.GetCurrentRenderContext()->frameCount;
 
-    if (r_usePostProcessing.GetBool() && (r_motionBlur.GetInteger() & 2)) {
+    // Previous frame joints are kept only for VTF skinning
+    if (renderGlobal.skinningMethod == SkinningJointCache::SkinningMethod::VertexTextureFetchSkinning &&
+        r_usePostProcessing.GetBool() && (r_motionBlur.GetInteger() & 2)) {
         if (viewFrameCount == renderSystem.GetCurrentRenderContext()->frameCount) {
             jointIndexOffset[1] = jointIndexOffset[0];
             jointIndexOffset[0] = jointIndexOffset[0] == 0 ? numJoints : 0;
@@ -17,10 +17,13 @@
 #include "RenderInternal.h"
 #include "Simd/Simd.h"
 #include "Core/Heap.h"
-#include "NvTriStrip.h"
+#include "Core/JobSystem.h"
 
 BE_NAMESPACE_BEGIN
 
+// Meshes with more vertices than this are skinned in the job system workers
+static const int MinSkinningVertsPerJob = 4096;
+
 int SubMesh::Allocated() const {
     int size = 0;
 
@@ -36,6 +39,12 @@ int SubMesh::Allocated() const {
     if (edges) {
         size += sizeof(edges[0]) * numEdges;
     }
+    if (triangleBVH) {
+        size += triangleBVH->Allocated();
+    }
+    if (posedVerts) {
+        size += sizeof(posedVerts[0]) * numVerts;
+    }
     if (vertexCache) {
         size += sizeof(BufferCache);
     }
@@ -81,9 +90,12 @@ void SubMesh::AllocSubMesh(int numVerts, int numIndexes) {
 
     this->vertexCache               = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
     this->indexCache                = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
+
+    this->triangleBVH               = new TriangleBVH;
+    this->posedVerts                = nullptr;
 }
 
-void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
+void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType, bool gpuSkinning) {
     assert(ref->type == Mesh::Type::Reference);
 
     this->alloced                   = true;
@@ -112,23 +124,27 @@ void SubMesh::AllocInstantiatedSubMesh(const SubMesh *ref, int meshType) {
     this->jointWeightVerts          = ref->jointWeightVerts;
 
     this->vertWeights               = ref->vertWeights;
-    this->useGpuSkinning            = (ref->vertWeights && meshType == Mesh::Type::Skinned) ? true : false;
+    this->useGpuSkinning            = (ref->vertWeights && meshType == Mesh::Type::Skinned && gpuSkinning) ? true : false;
     this->gpuSkinningVersionIndex   = ref->gpuSkinningVersionIndex;
 
     this->aabb                      = ref->aabb;
 
+    // Shares the BVH of the reference sub mesh with the vertices until the skinned sub mesh is posed.
+    this->triangleBVH               = nullptr;
+    this->posedVerts                = nullptr;
+
     if (this->type == Mesh::Type::Static || this->useGpuSkinning) {
         this->verts                 = ref->verts;
 
         this->vertexCache           = ref->vertexCache;
         this->indexCache            = ref->indexCache;
     } else {
-        this->verts                 = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * ref->numVerts);
+        // CPU skinned vertices are written to the dynamic vertex buffer directly,
+        // so the vertices and the index buffer of the reference sub mesh are shared.
+        this->verts                 = ref->verts;
 
         this->vertexCache           = (BufferCache *)Mem_ClearedAlloc(sizeof(BufferCache));
-        this->indexCache            = nullptr;
-
-        simdProcessor->Memcpy(this->verts, ref->verts, sizeof(VertexGenericLit) * ref->numVerts);
+        this->indexCache            = ref->indexCache;
     }
 }
 
@@ -139,6 +155,16 @@ void SubMesh::FreeSubMesh() {
 
     alloced = false;
 
+    if (triangleBVH) {
+        delete triangleBVH;
+        triangleBVH = nullptr;
+    }
+
+    if (posedVerts) {
+        Mem_AlignedFree(posedVerts);
+        posedVerts = nullptr;
+    }
+
     if (type == Mesh::Type::Reference) {
         if (vertexCache->buffer != RHI::NullBuffer) {
             rhi.DestroyBuffer(vertexCache->buffer);
@@ -163,9 +189,11 @@ void SubMesh::FreeSubMesh() {
         return;
     }
 
-    if (type == Mesh::Type::Dynamic || (type == Mesh::Type::Skinned && !useGpuSkinning)) {
+    if (type == Mesh::Type::Dynamic) {
         Mem_AlignedFree(verts);
         Mem_Free(vertexCache);
+    } else if (type == Mesh::Type::Skinned && !useGpuSkinning) {
+        Mem_Free(vertexCache);
     }
 }
 
@@ -197,15 +225,11 @@ void SubMesh::CacheStaticDataToGpu() {
     }
 }
 
-void SubMesh::CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material) {
+void SubMesh::CacheDynamicDataToGpu(const Material *material) {
     if (bufferCacheManager.IsCached(vertexCache)) {
         return;
     }
 
-    if (joints) {
-        simdProcessor->TransformVerts(verts, numVerts, joints, jointWeightVerts, reinterpret_cast<int *>(jointWeights), numJointWeights);
-    }
-
     bool unsmoothedTangents = (material->GetFlags() & Material::Flag::UnsmoothTangents) ? true : false;
 
     ComputeTangents(true, unsmoothedTangents);
@@ -232,6 +256,54 @@ void SubMesh::CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *materi
     bufferCacheManager.UnmapIndexBuffer(indexCache);
 }
 
+void SubMesh::SkinVerts(const Mat3x4 *skinningJoints, VertexGenericLit *dstVerts) const {
+    struct SkinningContext {
+        VertexGenericLit *      dstVerts;
+        const VertexGenericLit *srcVerts;
+        const Mat3x4 *          skinningJoints;
+        const byte *            vertWeights;
+        int                     vertWeightSize;
+        int                     maxVertWeights;
+    };
+
+    SkinningContext context;
+    context.dstVerts = dstVerts;
+    context.srcVerts = verts;
+    context.skinningJoints = skinningJoints;
+    context.vertWeights = (const byte *)vertWeights;
+    context.vertWeightSize = VertexWeightSize();
+    context.maxVertWeights = MaxVertexWeights();
+
+    // Transforms positions, normals and tangents in one pass, large meshes are split across the job system workers
+    jobSystem.ParallelFor(numVerts, MinSkinningVertsPerJob, [](void *data, int begin, int end) {
+        const SkinningContext *context = (const SkinningContext *)data;
+
+        simdProcessor->SkinVerts(&context->dstVerts[begin], &context->srcVerts[begin], end - begin,
+            context->skinningJoints, context->vertWeights + begin * context->vertWeightSize, context->maxVertWeights);
+    }, &context);
+}
+
+void SubMesh::CacheSkinnedDataToGpu(const Mat3x4 *skinningJoints) {
+    if (bufferCacheManager.IsCached(vertexCache)) {
+        return;
+    }
+
+    if (!skinningJoints || !vertWeights) {
+        bufferCacheManager.AllocVertex(numVerts, sizeof(VertexGenericLit), verts, vertexCache);
+    } else {
+        bufferCacheManager.AllocVertex(numVerts, sizeof(VertexGenericLit), nullptr, vertexCache);
+
+        SkinVerts(skinningJoints, (VertexGenericLit *)bufferCacheManager.MapVertexBuffer(vertexCache));
+
+        bufferCacheManager.UnmapVertexBuffer(vertexCache);
+    }
+
+    // Index buffer of the reference sub mesh is drawn with the base vertex
+    if (!bufferCacheManager.IsCached(indexCache)) {
+        bufferCacheManager.AllocStaticIndex(numIndexes * sizeof(TriIndex), indexes, indexCache);
+    }
+}
+
 void SubMesh::SplitMirroredVerts() {
     Vec3        tangents[2];
     float       handedness;
@@ -397,6 +469,9 @@ void SubMesh::ComputeAABB() {
     for (int i = 0; i < numVerts; i++) {
         aabb.AddPoint(verts[i].xyz);
     }
+
+    // AABB is recomputed whenever the vertices are changed.
+    InvalidateTriangleBVHVertices();
 }
 
 // Compute area weighted average of the normals
@@ -1008,71 +1083,64 @@ bool SubMesh::IsClosed() const {
     return true;
 }
 
-bool SubMesh::IsIntersectLine(const Vec3 &start, const Vec3 &end, bool ignoreBackFace) const {
-    if (!edgesCalculated) {
-        return false;
+// Instantiated sub mesh shares the vertices and the BVH with the reference sub mesh.
+// Posed skinned sub mesh has its own BVH of the skinned vertices, see PoseTriangleBVH().
+const TriangleBVH *SubMesh::GetTriangleBVH() const {
+    if (posedVerts) {
+        triangleBVH->Update(posedVerts, indexes, numIndexes);
+        return triangleBVH;
     }
 
-    Ray ray;
-    ray.origin = start;
-    ray.dir = end - start;
-    ray.dir.Normalize();
+    const SubMesh *owner = refSubMesh ? refSubMesh : this;
+    assert(owner->triangleBVH && owner->verts == verts);
 
-    return IntersectRay(ray, ignoreBackFace);
+    // Builds or refits the BVH at the first query after the vertices are changed, only once for concurrent queries.
+    owner->triangleBVH->Update(owner->verts, owner->indexes, owner->numIndexes);
+    return owner->triangleBVH;
 }
 
-bool SubMesh::IntersectRay(const Ray &ray, bool ignoreBackFace, float *hitDist) const {
-    if (!edgesCalculated) {
-        return false;
-    }
+void SubMesh::InvalidateTriangleBVH() {
+    TriangleBVH *bvh = refSubMesh ? refSubMesh->triangleBVH : triangleBVH;
 
-    byte *sidedness = (byte *)_alloca(numEdges * sizeof(byte));
-    float dist = Math::Infinity;
+    if (bvh) {
+        bvh->Invalidate();
+    }
+}
 
-    Pluecker rayPl, pl;
-    rayPl.SetFromRay(ray.origin, ray.dir);
+void SubMesh::InvalidateTriangleBVHVertices() {
+    TriangleBVH *bvh = refSubMesh ? refSubMesh->triangleBVH : triangleBVH;
 
-    // ray sidedness for edges
-    for (int i = 0; i < numEdges; i++) {
-        pl.SetFromLine(verts[edges[i].v[1]].xyz, verts[edges[i].v[0]].xyz);
-        float d = pl.PermutedInnerProduct(rayPl);
-        sidedness[i] = IEEE_FLT_SIGNBITSET(d);
+    if (bvh) {
+        bvh->InvalidateVertices();
     }
+}
 
-    Plane plane;
+void SubMesh::PoseTriangleBVH(const Mat3x4 *skinningJoints) {
+    assert(refSubMesh && vertWeights);
 
-    // test triangles
-    for (int i = 0; i < numIndexes; i += 3) {
-        const int32_t i0 = edgeIndexes[i + 0];
-        const int32_t i1 = edgeIndexes[i + 1];
-        const int32_t i2 = edgeIndexes[i + 2];
-
-        const int32_t s0 = sidedness[Math::Abs(i0)] ^ INT32_SIGNBITSET(i0);
-        const int32_t s1 = sidedness[Math::Abs(i1)] ^ INT32_SIGNBITSET(i1);
-        const int32_t s2 = sidedness[Math::Abs(i2)] ^ INT32_SIGNBITSET(i2);
+    // Built at the first query, later poses only refit the BVH because the triangles are the same
+    if (!posedVerts) {
+        posedVerts = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * numVerts);
+        triangleBVH = new TriangleBVH;
+    }
 
-        if ((s0 & s1 & s2) || (!ignoreBackFace && !(s0 | s1 | s2))) {
-            plane.SetFromPoints(verts[indexes[i + 0]].xyz, verts[indexes[i + 1]].xyz, verts[indexes[i + 2]].xyz);
+    SkinVerts(skinningJoints, posedVerts);
 
-            float d;
-            if (plane.IntersectRay(ray, false, &d)) {
-                if (!hitDist) {
-                    return true;
-                }
+    triangleBVH->InvalidateVertices();
+}
 
-                if (d < dist) {
-                    dist = d;
-                }
-            }
-        }
-    }
+bool SubMesh::IsIntersectLine(const Vec3 &start, const Vec3 &end, bool ignoreBackFace) const {
+    Ray ray;
+    ray.origin = start;
+    ray.dir = end - start;
+    float length = ray.dir.Normalize();
 
-    if (dist == Math::Infinity) {
-        return false;
-    }
+    return GetTriangleBVH()->IntersectRay(ray, ignoreBackFace, true, length);
+}
 
-    *hitDist = dist;
-    return true;
+bool SubMesh::IntersectRay(const Ray &ray, bool ignoreBackFace, float *hitDist) const {
+    // Any hit is enough if the distance is not needed.
+    return GetTriangleBVH()->IntersectRay(ray, ignoreBackFace, hitDist == nullptr, FLT_MAX, hitDist);
 }
 
 float SubMesh::ComputeVolume() const {
@@ -1202,40 +1270,4 @@ const Mat3 SubMesh::ComputeInertiaTensor(const Vec3 &centroid, float mass) const
     return inertia;
 }
 
-void SubMesh::OptimizeIndexedTriangles() {
-#if 0
-    // NOTE: consider if size of the index is greater than 16 bit number or not
-    PrimitiveGroup *srcPrimGroup = new PrimitiveGroup;
-    srcPrimGroup->type = PrimType::PT_LIST;
-    srcPrimGroup->numIndices = numIndexes;
-    srcPrimGroup->indices = new unsigned short [numIndexes];
-
-    for (int i = 0; i < numIndexes; i++) {
-        srcPrimGroup->indices[i] = indexes[i];
-    }
-
-    PrimitiveGroup *dstPrimGroup;
-
-    // remap indices
-    RemapIndices(srcPrimGroup, 1, numVerts, &dstPrimGroup);
-
-    for (int i = 0; i < numIndexes; i++) {
-        indexes[i] = dstPrimGroup->indices[i];
-    }
-
-    // remap vertices
-    VertexGenericLit *remappedVerts = (VertexGenericLit *)Mem_Alloc16(sizeof(verts[0]) * numVerts);
-
-    for (int i = 0; i < numIndexes; i++) {
-        remappedVerts[dstPrimGroup->indices[i]] = verts[srcPrimGroup->indices[i]];
-    }
-
-    Mem_AlignedFree(verts);
-    verts = remappedVerts;
-    
-    delete srcPrimGroup;
-    delete [] dstPrimGroup;
-#endif
-}
-
 BE_NAMESPACE_END
@@ -0,0 +1,537 @@
+// Copyright(c) 2017 POLYGONTEK
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http ://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/Render.h"
+#include "RenderInternal.h"
+#include "Simd/Simd.h"
+#include "Core/Heap.h"
+
+BE_NAMESPACE_BEGIN
+
+/*
+-------------------------------------------------------------------------------
+
+    Triangle order optimization
+
+    1. Vertex cache : Tom Forsyth's linear-speed vertex cache optimization.
+       Greedily emits the triangle with the best score, where the score of a
+       triangle is the sum of the scores of its vertices. A vertex scores higher
+       if it is recently used and if it has few remaining triangles.
+
+    2. Overdraw : Sander et al. "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+       Splits the cache optimized triangles into clusters where the ACMR of a
+       cluster drops below the threshold, then sorts the clusters so that the
+       outward facing ones are drawn first.
+
+    3. Vertex fetch : renumbers the vertices in the order of first use.
+
+-------------------------------------------------------------------------------
+*/
+
+static constexpr int    VertexCacheSize = 32;
+static constexpr int    MaxValenceScores = 32;
+static constexpr float  OverdrawThreshold = 1.05f;
+
+struct VertexScoreTable {
+    float               cacheScores[VertexCacheSize];
+    float               valenceScores[MaxValenceScores + 1];
+};
+
+static void InitVertexScoreTable(VertexScoreTable &table) {
+    static constexpr float CacheDecayPower = 1.5f;
+    static constexpr float LastTriScore = 0.75f;
+    static constexpr float ValenceBoostScale = 2.0f;
+    static constexpr float ValenceBoostPower = 0.5f;
+
+    for (int i = 0; i < VertexCacheSize; i++) {
+        if (i < 3) {
+            // The vertices used in the last triangle get fixed score, so that it doesn't matter which one of them is used.
+            table.cacheScores[i] = LastTriScore;
+        } else {
+            const float scaler = 1.0f / (VertexCacheSize - 3);
+            table.cacheScores[i] = Math::Pow(1.0f - (i - 3) * scaler, CacheDecayPower);
+        }
+    }
+
+    table.valenceScores[0] = 0.0f;
+    for (int i = 1; i <= MaxValenceScores; i++) {
+        table.valenceScores[i] = ValenceBoostScale * Math::Pow((float)i, -ValenceBoostPower);
+    }
+}
+
+BE_INLINE static float VertexScore(const VertexScoreTable &table, int cachePosition, int numActiveTris) {
+    if (numActiveTris == 0) {
+        // No triangles need this vertex
+        return -1.0f;
+    }
+
+    float score = cachePosition >= 0 ? table.cacheScores[cachePosition] : 0.0f;
+
+    // Bonus points for having low number of triangles left, so that lone vertices are not left behind.
+    score += numActiveTris <= MaxValenceScores ? table.valenceScores[numActiveTris] : table.valenceScores[MaxValenceScores];
+
+    return score;
+}
+
+static void OptimizeVertexCache(const TriIndex *indexes, int numIndexes, int numVerts, TriIndex *dstIndexes) {
+    const int numTris = numIndexes / 3;
+
+    VertexScoreTable table;
+    InitVertexScoreTable(table);
+
+    int *numActiveTris = (int *)Mem_ClearedAlloc(sizeof(int) * numVerts);
+    int *adjacencyOffsets = (int *)Mem_Alloc(sizeof(int) * numVerts);
+    int *adjacencyTris = (int *)Mem_Alloc(sizeof(int) * numIndexes);
+    int *cachePositions = (int *)Mem_Alloc(sizeof(int) * numVerts);
+    float *vertexScores = (float *)Mem_Alloc(sizeof(float) * numVerts);
+    float *triScores = (float *)Mem_Alloc(sizeof(float) * numTris);
+    bool *triEmitted = (bool *)Mem_ClearedAlloc(sizeof(bool) * numTris);
+
+    // Build vertex to triangles adjacency
+    for (int i = 0; i < numIndexes; i++) {
+        numActiveTris[indexes[i]]++;
+    }
+
+    int offset = 0;
+    for (int i = 0; i < numVerts; i++) {
+        adjacencyOffsets[i] = offset;
+        offset += numActiveTris[i];
+        numActiveTris[i] = 0;
+    }
+
+    for (int i = 0; i < numIndexes; i++) {
+        int vertexIndex = indexes[i];
+        adjacencyTris[adjacencyOffsets[vertexIndex] + numActiveTris[vertexIndex]++] = i / 3;
+    }
+
+    for (int i = 0; i < numVerts; i++) {
+        cachePositions[i] = -1;
+        vertexScores[i] = VertexScore(table, -1, numActiveTris[i]);
+    }
+
+    int bestTri = -1;
+    float bestScore = -Math::Infinity;
+
+    for (int i = 0; i < numTris; i++) {
+        const TriIndex *tri = &indexes[i * 3];
+        triScores[i] = vertexScores[tri[0]] + vertexScores[tri[1]] + vertexScores[tri[2]];
+
+        if (triScores[i] > bestScore) {
+            bestScore = triScores[i];
+            bestTri = i;
+        }
+    }
+
+    // One more space for each vertex of the last triangle that pushes the others out of the cache
+    int cache[VertexCacheSize + 3];
+    int newCache[VertexCacheSize + 3];
+    int cacheCount = 0;
+
+    int nextScanTri = 0;
+
+    for (int dstTriIndex = 0; dstTriIndex < numTris; dstTriIndex++) {
+        if (bestTri < 0) {
+            // No candidates in the cache, continue with the next triangle not emitted
+            while (triEmitted[nextScanTri]) {
+                nextScanTri++;
+            }
+            bestTri = nextScanTri;
+        }
+
+        const TriIndex *tri = &indexes[bestTri * 3];
+
+        dstIndexes[dstTriIndex * 3 + 0] = tri[0];
+        dstIndexes[dstTriIndex * 3 + 1] = tri[1];
+        dstIndexes[dstTriIndex * 3 + 2] = tri[2];
+
+        triEmitted[bestTri] = true;
+
+        int newCacheCount = 0;
+
+        for (int i = 0; i < 3; i++) {
+            const int vertexIndex = tri[i];
+
+            // Remove the emitted triangle from the active triangles of the vertex
+            int *adjacency = &adjacencyTris[adjacencyOffsets[vertexIndex]];
+            for (int j = 0; j < numActiveTris[vertexIndex]; j++) {
+                if (adjacency[j] == bestTri) {
+                    adjacency[j] = adjacency[--numActiveTris[vertexIndex]];
+                    break;
+                }
+            }
+
+            // Degenerate triangles may have the same vertex twice
+            if (i > 0 && (vertexIndex == tri[0] || (i == 2 && vertexIndex == tri[1]))) {
+                continue;
+            }
+            newCache[newCacheCount++] = vertexIndex;
+        }
+
+        // Move the vertices of the emitted triangle to the front of the LRU cache
+        for (int i = 0; i < cacheCount; i++) {
+            const int vertexIndex = cache[i];
+            if (vertexIndex != tri[0] && vertexIndex != tri[1] && vertexIndex != tri[2]) {
+                newCache[newCacheCount++] = vertexIndex;
+            }
+        }
+
+        // Update the scores of the vertices in the cache including the ones pushed out of the cache
+        for (int i = 0; i < newCacheCount; i++) {
+            const int vertexIndex = newCache[i];
+
+            cachePositions[vertexIndex] = i < VertexCacheSize ? i : -1;
+
+            const float newScore = VertexScore(table, cachePositions[vertexIndex], numActiveTris[vertexIndex]);
+            const float scoreDelta = newScore - vertexScores[vertexIndex];
+            vertexScores[vertexIndex] = newScore;
+
+            const int *adjacency = &adjacencyTris[adjacencyOffsets[vertexIndex]];
+            for (int j = 0; j < numActiveTris[vertexIndex]; j++) {
+                triScores[adjacency[j]] += scoreDelta;
+            }
+        }
+
+        cacheCount = Min(newCacheCount, VertexCacheSize);
+        memcpy(cache, newCache, sizeof(cache[0]) * cacheCount);
+
+        // Find the best triangle among the ones using the vertices in the cache
+        bestTri = -1;
+        bestScore = -Math::Infinity;
+
+        for (int i = 0; i < cacheCount; i++) {
+            const int vertexIndex = cache[i];
+            const int *adjacency = &adjacencyTris[adjacencyOffsets[vertexIndex]];
+
+            for (int j = 0; j < numActiveTris[vertexIndex]; j++) {
+                const int triIndex = adjacency[j];
+                if (triScores[triIndex] > bestScore) {
+                    bestScore = triScores[triIndex];
+                    bestTri = triIndex;
+                }
+            }
+        }
+    }
+
+    Mem_Free(triEmitted);
+    Mem_Free(triScores);
+    Mem_Free(vertexScores);
+    Mem_Free(cachePositions);
+    Mem_Free(adjacencyTris);
+    Mem_Free(adjacencyOffsets);
+    Mem_Free(numActiveTris);
+}
+
+// FIFO post-transform vertex cache simulation using time stamps.
+struct VertexCacheSimulator {
+    VertexCacheSimulator(int numVerts, int cacheSize) : cacheSize(cacheSize) {
+        timeStamps = (int *)Mem_Alloc(sizeof(int) * numVerts);
+        for (int i = 0; i < numVerts; i++) {
+            timeStamps[i] = -cacheSize - 1;
+        }
+        time = 0;
+    }
+
+    ~VertexCacheSimulator() {
+        Mem_Free(timeStamps);
+    }
+
+    void Flush() { time += cacheSize + 1; }
+
+    // Returns 1 if the vertex is not in the cache.
+    int Fetch(int vertexIndex) {
+        if (time - timeStamps[vertexIndex] < cacheSize) {
+            return 0;
+        }
+        timeStamps[vertexIndex] = ++time;
+        return 1;
+    }
+
+    int *               timeStamps;
+    int                 time;
+    int                 cacheSize;
+};
+
+static int CountCacheMisses(const TriIndex *indexes, int numIndexes, int numVerts) {
+    VertexCacheSimulator cacheSim(numVerts, VertexCacheSize);
+
+    int numMisses = 0;
+    for (int i = 0; i < numIndexes; i++) {
+        numMisses += cacheSim.Fetch(indexes[i]);
+    }
+    return numMisses;
+}
+
+static void OptimizeOverdraw(const VertexGenericLit *verts, int numVerts, TriIndex *indexes, int numIndexes, float threshold) {
+    struct Cluster {
+        int             firstTri;
+        int             numTris;
+        float           sortKey;
+    };
+
+    const int numTris = numIndexes / 3;
+    const float maxACMR = threshold * CountCacheMisses(indexes, numIndexes, numVerts) / numTris;
+
+    Array<Cluster> clusters;
+
+    // Start a new cluster when the ACMR of the current cluster drops below the threshold.
+    // The cache is flushed at the start of each cluster because they will be drawn in any order.
+    VertexCacheSimulator cacheSim(numVerts, VertexCacheSize);
+
+    Cluster cluster;
+    cluster.firstTri = 0;
+    int clusterMisses = 0;
+
+    for (int triIndex = 0; triIndex < numTris; triIndex++) {
+        const TriIndex *tri = &indexes[triIndex * 3];
+
+        clusterMisses += cacheSim.Fetch(tri[0]);
+        clusterMisses += cacheSim.Fetch(tri[1]);
+        clusterMisses += cacheSim.Fetch(tri[2]);
+
+        const int clusterTris = triIndex - cluster.firstTri + 1;
+
+        if (clusterMisses <= maxACMR * clusterTris || triIndex == numTris - 1) {
+            cluster.numTris = clusterTris;
+            clusters.Append(cluster);
+
+            cluster.firstTri = triIndex + 1;
+            clusterMisses = 0;
+            cacheSim.Flush();
+        }
+    }
+
+    if (clusters.Count() <= 1) {
+        return;
+    }
+
+    // Area weighted centroid of the mesh
+    Vec3 meshCentroid = Vec3::zero;
+    float meshArea = 0.0f;
+
+    for (int triIndex = 0; triIndex < numTris; triIndex++) {
+        const TriIndex *tri = &indexes[triIndex * 3];
+        const Vec3 &p0 = verts[tri[0]].xyz;
+        const Vec3 &p1 = verts[tri[1]].xyz;
+        const Vec3 &p2 = verts[tri[2]].xyz;
+
+        const float area = (p1 - p0).Cross(p2 - p0).Length();
+        meshCentroid += (p0 + p1 + p2) * area;
+        meshArea += area;
+    }
+
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea * 3.0f;
+    }
+
+    // Clusters facing outward from the centroid of the mesh are likely to occlude the others, so draw them first.
+    for (int clusterIndex = 0; clusterIndex < clusters.Count(); clusterIndex++) {
+        Cluster &c = clusters[clusterIndex];
+
+        Vec3 centroid = Vec3::zero;
+        Vec3 normal = Vec3::zero;
+        float area = 0.0f;
+
+        for (int triIndex = c.firstTri; triIndex < c.firstTri + c.numTris; triIndex++) {
+            const TriIndex *tri = &indexes[triIndex * 3];
+            const Vec3 &p0 = verts[tri[0]].xyz;
+            const Vec3 &p1 = verts[tri[1]].xyz;
+            const Vec3 &p2 = verts[tri[2]].xyz;
+
+            const Vec3 faceNormal = (p1 - p0).Cross(p2 - p0);
+            const float triArea = faceNormal.Length();
+
+            centroid += (p0 + p1 + p2) * triArea;
+            normal += faceNormal;
+            area += triArea;
+        }
+
+        if (area > 0.0f) {
+            centroid /= area * 3.0f;
+        }
+        normal.Normalize();
+
+        c.sortKey = (centroid - meshCentroid).Dot(normal);
+    }
+
+    clusters.StableSort([](const Cluster &a, const Cluster &b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    TriIndex *sortedIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+    TriIndex *dstPtr = sortedIndexes;
+
+    for (int clusterIndex = 0; clusterIndex < clusters.Count(); clusterIndex++) {
+        const Cluster &c = clusters[clusterIndex];
+        simdProcessor->Memcpy(dstPtr, &indexes[c.firstTri * 3], sizeof(TriIndex) * c.numTris * 3);
+        dstPtr += c.numTris * 3;
+    }
+
+    simdProcessor->Memcpy(indexes, sortedIndexes, sizeof(TriIndex) * numIndexes);
+
+    Mem_AlignedFree(sortedIndexes);
+}
+
+bool SubMesh::CanReorderVerts() const {
+    // Mirrored vertices should be kept at the end of the vertex array and
+    // joint weights for CPU skinning are stored in vertex order.
+    return numMirroredVerts == 0 && numJointWeights == 0;
+}
+
+void SubMesh::ComputeOptimizedIndexes(bool optimizeOverdraw, TriIndex *dstIndexes, int *vertexOrder) const {
+    if (numIndexes < 3) {
+        simdProcessor->Memcpy(dstIndexes, indexes, sizeof(TriIndex) * numIndexes);
+        for (int i = 0; i < numVerts; i++) {
+            vertexOrder[i] = i;
+        }
+        return;
+    }
+
+    OptimizeVertexCache(indexes, numIndexes, numVerts, dstIndexes);
+
+    if (optimizeOverdraw) {
+        OptimizeOverdraw(verts, numVerts, dstIndexes, numIndexes, OverdrawThreshold);
+    }
+
+    if (!CanReorderVerts()) {
+        for (int i = 0; i < numVerts; i++) {
+            vertexOrder[i] = i;
+        }
+        return;
+    }
+
+    // Renumber the vertices in the order of first use
+    int *vertexRemap = (int *)Mem_Alloc(sizeof(int) * numVerts);
+    for (int i = 0; i < numVerts; i++) {
+        vertexRemap[i] = -1;
+    }
+
+    int numOrderedVerts = 0;
+
+    for (int i = 0; i < numIndexes; i++) {
+        const int vertexIndex = dstIndexes[i];
+        if (vertexRemap[vertexIndex] < 0) {
+            vertexRemap[vertexIndex] = numOrderedVerts;
+            vertexOrder[numOrderedVerts++] = vertexIndex;
+        }
+        dstIndexes[i] = vertexRemap[vertexIndex];
+    }
+
+    // Unreferenced vertices go to the end
+    for (int i = 0; i < numVerts; i++) {
+        if (vertexRemap[i] < 0) {
+            vertexOrder[numOrderedVerts++] = i;
+        }
+    }
+
+    Mem_Free(vertexRemap);
+}
+
+void SubMesh::GetVertexCacheStats(const TriIndex *indexes, int numIndexes, int numVerts, float &acmr, float &atvr) {
+    if (numIndexes < 3 || numVerts == 0) {
+        acmr = 0.0f;
+        atvr = 0.0f;
+        return;
+    }
+
+    const int numMisses = CountCacheMisses(indexes, numIndexes, numVerts);
+
+    acmr = (float)numMisses / (numIndexes / 3);
+    atvr = (float)numMisses / numVerts;
+}
+
+void SubMesh::OptimizeIndexedTriangles(bool optimizeOverdraw) {
+    if (type != Mesh::Type::Reference) {
+        // Instantiated sub meshes share the data of the reference
+        return;
+    }
+
+    if (numIndexes < 3) {
+        return;
+    }
+
+    TriIndex *optimizedIndexes = (TriIndex *)Mem_Alloc16(sizeof(TriIndex) * numIndexes);
+    int *vertexOrder = (int *)Mem_Alloc(sizeof(int) * numVerts);
+
+    ComputeOptimizedIndexes(optimizeOverdraw, optimizedIndexes, vertexOrder);
+
+    float oldACMR, oldATVR;
+    float newACMR, newATVR;
+    GetVertexCacheStats(indexes, numIndexes, numVerts, oldACMR, oldATVR);
+    GetVertexCacheStats(optimizedIndexes, numIndexes, numVerts, newACMR, newATVR);
+
+    BE_DLOG("SubMesh::OptimizeIndexedTriangles: %i verts, %i tris, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+        numVerts, numIndexes / 3, oldACMR, newACMR, oldATVR, newATVR);
+
+    simdProcessor->Memcpy(indexes, optimizedIndexes, sizeof(TriIndex) * numIndexes);
+    Mem_AlignedFree(optimizedIndexes);
+
+    if (CanReorderVerts()) {
+        // Reorder the vertex arrays in place because instantiated sub meshes may point to them
+        VertexGenericLit *tempVerts = (VertexGenericLit *)Mem_Alloc16(sizeof(VertexGenericLit) * numVerts);
+        simdProcessor->Memcpy(tempVerts, verts, sizeof(VertexGenericLit) * numVerts);
+        for (int i = 0; i < numVerts; i++) {
+            verts[i] = tempVerts[vertexOrder[i]];
+        }
+        Mem_AlignedFree(tempVerts);
+
+        if (vertWeights) {
+            const int vertexWeightSize = VertexWeightSize();
+            byte *tempWeights = (byte *)Mem_Alloc16(vertexWeightSize * numVerts);
+            simdProcessor->Memcpy(tempWeights, vertWeights, vertexWeightSize * numVerts);
+            for (int i = 0; i < numVerts; i++) {
+                memcpy((byte *)vertWeights + i * vertexWeightSize, tempWeights + vertexOrder[i] * vertexWeightSize, vertexWeightSize);
+            }
+            Mem_AlignedFree(tempWeights);
+        }
+
+        if (dominantTris) {
+            int *vertexRemap = (int *)Mem_Alloc(sizeof(int) * numVerts);
+            for (int i = 0; i < numVerts; i++) {
+                vertexRemap[vertexOrder[i]] = i;
+            }
+
+            DominantTri *tempDominantTris = (DominantTri *)Mem_Alloc16(sizeof(DominantTri) * numVerts);
+            simdProcessor->Memcpy(tempDominantTris, dominantTris, sizeof(DominantTri) * numVerts);
+            for (int i = 0; i < numVerts; i++) {
+                dominantTris[i] = tempDominantTris[vertexOrder[i]];
+                if (dominantTris[i].v2 < numVerts && dominantTris[i].v3 < numVerts) {
+                    dominantTris[i].v2 = vertexRemap[dominantTris[i].v2];
+                    dominantTris[i].v3 = vertexRemap[dominantTris[i].v3];
+                }
+            }
+            Mem_AlignedFree(tempDominantTris);
+
+            Mem_Free(vertexRemap);
+        }
+    }
+
+    Mem_Free(vertexOrder);
+
+    // Edges refer to the triangle numbers
+    if (edgesCalculated) {
+        Mem_AlignedFree(edges);
+        Mem_AlignedFree(edgeIndexes);
+        edges = nullptr;
+        edgeIndexes = nullptr;
+        numEdges = 0;
+        edgesCalculated = false;
+
+        ComputeEdges();
+    }
+
+    InvalidateTriangleBVH();
+}
+
+BE_NAMESPACE_END
@@ -534,8 +534,9 @@ void Texture::Upload(const Image *srcImage) {
     int dstWidth, dstHeight, dstDepth;
     rhi.AdjustTextureSize(type, useNPOT, srcWidth, srcHeight, srcDepth, &dstWidth, &dstHeight, &dstDepth);
 
-    // Apply scale down mip level
+    // Apply scale down mip level except for the levels already skipped by the image loader
     int mipLevel = !(flags & Flag::NoScaleDown) ? TextureManager::texture_mipLevel.GetInteger() : 0;
+    mipLevel = Max(mipLevel - skippedMipLevels, 0);
     if (mipLevel > 0) {
         dstWidth = Max(dstWidth >> mipLevel, 1);
         dstHeight = Max(dstHeight >> mipLevel, 1);
@@ -664,8 +665,11 @@ bool Texture::Load(const char *filename, int flags) {
     } else {
         BE_LOG("Loading texture '%s'...\n", filename);
 
+        // Let the image loader skip top mip levels instead of scaling down full size image on upload
+        int mipLevel = !(flags & Flag::NoScaleDown) ? TextureManager::texture_mipLevel.GetInteger() : 0;
+
         Image image;
-        image.Load(filename);
+        image.Load(filename, mipLevel, &skippedMipLevels);
 
         if (image.IsEmpty()) {
             BE_WARNLOG("Couldn't load texture \"%s\"\n", filename);
@@ -683,6 +687,8 @@ bool Texture::Load(const char *filename, int flags) {
         }
 
         Create(textureType, image, flags);
+
+        skippedMipLevels = 0;
     }
 
     return true;
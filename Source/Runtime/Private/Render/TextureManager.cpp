@@ -17,6 +17,7 @@
 #include "RenderInternal.h"
 #include "Core/Cmds.h"
 #include "File/FileSystem.h"
+#include "Platform/PlatformTime.h"
 
 BE_NAMESPACE_BEGIN
 
@@ -45,6 +46,7 @@ void TextureManager::Init() {
     cmdSystem.AddCommand("listTextures", Cmd_ListTextures);
     cmdSystem.AddCommand("reloadTexture", Cmd_ReloadTexture);
     cmdSystem.AddCommand("convertNormalAR2RGB", Cmd_ConvertNormalAR2RGB);
+    cmdSystem.AddCommand("benchTextureLoad", Cmd_BenchTextureLoad);
 
     textureHashMap.Init(1024, 1024, 1024);
 
@@ -62,6 +64,7 @@ void TextureManager::Shutdown() {
     cmdSystem.RemoveCommand("listTextures");
     cmdSystem.RemoveCommand("reloadTexture");
     cmdSystem.RemoveCommand("convertNormalAR2RGB");
+    cmdSystem.RemoveCommand("benchTextureLoad");
 
     textureHashMap.DeleteContents(true);
 }
@@ -520,4 +523,76 @@ void TextureManager::Cmd_ConvertNormalAR2RGB(const CmdArgs &args) {
     BE_LOG("all done\n");
 }
 
+// Compares loading a texture set at mip level 0/1/2 by scaling down the full size image after loading
+// with skipping top mip levels in the image loader. Peak memory is the sum of the file data read,
+// the loaded image and the scaled image per texture.
+void TextureManager::Cmd_BenchTextureLoad(const CmdArgs &args) {
+    char path[MaxAbsolutePath];
+
+    if (args.Argc() != 3) {
+        BE_LOG("benchTextureLoad <rootdir> <filter>\n");
+        return;
+    }
+
+    FileArray fileArray;
+    int numFiles = fileSystem.ListFiles(args.Argv(1), args.Argv(2), fileArray);
+    if (!numFiles) {
+        BE_WARNLOG("no files found\n");
+        return;
+    }
+
+    BE_LOG("MIP METHOD     TIME(ms)   PEAK MEM UPLOAD SIZE\n");
+
+    for (int mipLevel = 0; mipLevel <= 2; mipLevel++) {
+        for (int skipInLoader = 0; skipInLoader <= 1; skipInLoader++) {
+            if (mipLevel == 0 && skipInLoader) {
+                continue;
+            }
+
+            uint64_t startTime = PlatformTime::Microseconds();
+            size_t peakBytes = 0;
+            size_t uploadBytes = 0;
+
+            for (int i = 0; i < numFiles; i++) {
+                Str::snPrintf(path, sizeof(path), "%s/%s", args.Argv(1), fileArray.GetFileName(i));
+
+                int skippedMipLevels = 0;
+
+                Image image;
+                image.Load(path, skipInLoader ? mipLevel : 0, &skippedMipLevels);
+                if (image.IsEmpty()) {
+                    continue;
+                }
+
+                // Mapped file pages are touched only for the mip levels not skipped
+                size_t readBytes = skippedMipLevels > 0 ? image.GetSize(0, image.NumMipmaps()) : fileSystem.FileSize(path);
+                size_t imageBytes = image.GetSize(0, image.NumMipmaps());
+                size_t scaledBytes = 0;
+
+                int remainingMipLevel = mipLevel - skippedMipLevels;
+                if (remainingMipLevel > 0) {
+                    Image scaledImage;
+                    image.Resize(Max(image.GetWidth() >> remainingMipLevel, 1), Max(image.GetHeight() >> remainingMipLevel, 1), Image::ResampleFilter::Bicubic, scaledImage);
+
+                    scaledBytes = scaledImage.GetSize(0, scaledImage.NumMipmaps());
+                    uploadBytes += scaledBytes;
+                } else {
+                    uploadBytes += imageBytes;
+                }
+
+                peakBytes = Max(peakBytes, readBytes + imageBytes + scaledBytes);
+            }
+
+            uint64_t elapsedTime = PlatformTime::Microseconds() - startTime;
+
+            BE_LOG("%3d %-8s %10.2f %10s %s\n",
+                mipLevel,
+                skipInLoader ? "skip" : "resize",
+                elapsedTime / 1000.0f,
+                Str::FormatBytes((int)peakBytes).c_str(),
+                Str::FormatBytes((int)uploadBytes).c_str());
+        }
+    }
+}
+
 BE_NAMESPACE_END
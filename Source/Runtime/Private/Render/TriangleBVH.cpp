@@ -0,0 +1,580 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "Precompiled.h"
+#include "Render/TriangleBVH.h"
+#include "Core/Heap.h"
+#if defined(__X86__)
+#include "Simd/SSE/sse.h"
+#endif
+
+BE_NAMESPACE_BEGIN
+
+static constexpr int NumBins = 12;
+static constexpr int MaxLeafTriangles = 8;
+static constexpr int MaxTreeDepth = 64;
+
+struct ALIGN_AS16 TriangleBVH::TriangleBlock {
+    float                   v0x[4];
+    float                   v0y[4];
+    float                   v0z[4];
+    float                   e1x[4];             ///< v1 - v0
+    float                   e1y[4];
+    float                   e1z[4];
+    float                   e2x[4];             ///< v2 - v0
+    float                   e2y[4];
+    float                   e2z[4];
+};
+
+TriangleBVH::TriangleBVH() {
+    state = State::NeedsBuild;
+    updateMutex = (PlatformMutex *)PlatformMutex::Create();
+    numTriangles = 0;
+    numNodes = 0;
+    nodeCapacity = 0;
+    nodes = nullptr;
+    numBlocks = 0;
+    blockCapacity = 0;
+    blocks = nullptr;
+    blockTriangles = nullptr;
+}
+
+TriangleBVH::~TriangleBVH() {
+    Free();
+
+    PlatformMutex::Destroy(updateMutex);
+}
+
+void TriangleBVH::Free() {
+    if (nodes) {
+        Mem_AlignedFree(nodes);
+        nodes = nullptr;
+    }
+    if (blocks) {
+        Mem_AlignedFree(blocks);
+        blocks = nullptr;
+    }
+    if (blockTriangles) {
+        Mem_Free(blockTriangles);
+        blockTriangles = nullptr;
+    }
+    numTriangles = 0;
+    numNodes = 0;
+    nodeCapacity = 0;
+    numBlocks = 0;
+    blockCapacity = 0;
+    state = State::NeedsBuild;
+}
+
+int TriangleBVH::Allocated() const {
+    return nodeCapacity * sizeof(Node) + blockCapacity * (sizeof(TriangleBlock) + 4 * sizeof(int32_t));
+}
+
+// Cost of the triangles in a leaf, triangles are tested in blocks of 4.
+BE_INLINE static float LeafCost(float area, int numTriangles) {
+    return area * ((numTriangles + 3) >> 2);
+}
+
+void TriangleBVH::Build(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes) {
+    struct BuildTriangle {
+        AABB                bounds;
+        Vec3                center;
+    };
+
+    struct BuildEntry {
+        int32_t             nodeIndex;
+        int32_t             first;
+        int32_t             count;
+        int32_t             depth;
+    };
+
+    struct Bin {
+        AABB                bounds;
+        int                 count;
+    };
+
+    numTriangles = numIndexes / 3;
+    numNodes = 0;
+    numBlocks = 0;
+
+    if (numTriangles == 0) {
+        state.store(State::Valid, std::memory_order_release);
+        return;
+    }
+
+    // Binary tree has at most 2n - 1 nodes, and every leaf has at least one triangle so blocks are no more than triangles.
+    if (nodeCapacity < numTriangles * 2) {
+        if (nodes) {
+            Mem_AlignedFree(nodes);
+        }
+        nodeCapacity = numTriangles * 2;
+        nodes = (Node *)Mem_Alloc16(nodeCapacity * sizeof(nodes[0]));
+    }
+
+    if (blockCapacity < numTriangles) {
+        if (blocks) {
+            Mem_AlignedFree(blocks);
+        }
+        if (blockTriangles) {
+            Mem_Free(blockTriangles);
+        }
+        blockCapacity = numTriangles;
+        blocks = (TriangleBlock *)Mem_Alloc16(blockCapacity * sizeof(blocks[0]));
+        blockTriangles = (int32_t *)Mem_Alloc(blockCapacity * 4 * sizeof(blockTriangles[0]));
+    }
+
+    BuildTriangle *triangles = (BuildTriangle *)Mem_Alloc(numTriangles * sizeof(triangles[0]));
+    int32_t *triangleIndexes = (int32_t *)Mem_Alloc(numTriangles * sizeof(triangleIndexes[0]));
+    BuildEntry *stack = (BuildEntry *)Mem_Alloc(numTriangles * sizeof(stack[0]));
+
+    for (int i = 0; i < numTriangles; i++) {
+        BuildTriangle &triangle = triangles[i];
+        triangle.bounds.Clear();
+        triangle.bounds.AddPoint(verts[indexes[i * 3 + 0]].xyz);
+        triangle.bounds.AddPoint(verts[indexes[i * 3 + 1]].xyz);
+        triangle.bounds.AddPoint(verts[indexes[i * 3 + 2]].xyz);
+        triangle.center = triangle.bounds.Center();
+
+        triangleIndexes[i] = i;
+    }
+
+    int stackCount = 0;
+    stack[stackCount++] = { 0, 0, numTriangles, 0 };
+    numNodes = 1;
+
+    while (stackCount > 0) {
+        const BuildEntry entry = stack[--stackCount];
+        Node &node = nodes[entry.nodeIndex];
+
+        AABB bounds, centerBounds;
+        bounds.Clear();
+        centerBounds.Clear();
+
+        for (int i = entry.first; i < entry.first + entry.count; i++) {
+            const BuildTriangle &triangle = triangles[triangleIndexes[i]];
+            bounds.AddAABB(triangle.bounds);
+            centerBounds.AddPoint(triangle.center);
+        }
+
+        for (int i = 0; i < 3; i++) {
+            node.mins[i] = bounds[0][i];
+            node.maxs[i] = bounds[1][i];
+        }
+
+        // Find the best split plane with binned SAH.
+        int bestAxis = -1;
+        int bestSplit = 0;
+        float bestCost = FLT_MAX;
+
+        if (entry.count > 4 && entry.depth < MaxTreeDepth - 1) {
+            for (int axis = 0; axis < 3; axis++) {
+                const float minCenter = centerBounds[0][axis];
+                const float extent = centerBounds[1][axis] - minCenter;
+
+                if (extent <= 0.0f) {
+                    continue;
+                }
+
+                const float binScale = NumBins / extent;
+
+                Bin bins[NumBins];
+                for (int binIndex = 0; binIndex < NumBins; binIndex++) {
+                    bins[binIndex].bounds.Clear();
+                    bins[binIndex].count = 0;
+                }
+
+                for (int i = entry.first; i < entry.first + entry.count; i++) {
+                    const BuildTriangle &triangle = triangles[triangleIndexes[i]];
+                    int binIndex = Min((int)((triangle.center[axis] - minCenter) * binScale), NumBins - 1);
+                    bins[binIndex].bounds.AddAABB(triangle.bounds);
+                    bins[binIndex].count++;
+                }
+
+                // Sweep from the right to get the cost of the right side of each split plane.
+                float rightCosts[NumBins];
+                AABB rightBounds;
+                rightBounds.Clear();
+                int rightCount = 0;
+
+                for (int binIndex = NumBins - 1; binIndex > 0; binIndex--) {
+                    rightBounds.AddAABB(bins[binIndex].bounds);
+                    rightCount += bins[binIndex].count;
+                    rightCosts[binIndex] = rightCount > 0 ? LeafCost(rightBounds.Area(), rightCount) : -1.0f;
+                }
+
+                AABB leftBounds;
+                leftBounds.Clear();
+                int leftCount = 0;
+
+                // Split plane i is between the bin i - 1 and the bin i.
+                for (int split = 1; split < NumBins; split++) {
+                    leftBounds.AddAABB(bins[split - 1].bounds);
+                    leftCount += bins[split - 1].count;
+
+                    if (leftCount == 0 || rightCosts[split] < 0.0f) {
+                        continue;
+                    }
+
+                    float cost = LeafCost(leftBounds.Area(), leftCount) + rightCosts[split];
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = split;
+                    }
+                }
+            }
+        }
+
+        bool makeLeaf = bestAxis == -1;
+        if (!makeLeaf && entry.count <= MaxLeafTriangles) {
+            // Split only if it is cheaper than testing all the triangles. Traversal cost is assumed as a half of a block test.
+            makeLeaf = bestCost + bounds.Area() * 0.5f >= LeafCost(bounds.Area(), entry.count);
+        }
+
+        if (makeLeaf) {
+            node.first = numBlocks;
+            node.numBlocks = (entry.count + 3) >> 2;
+
+            for (int blockIndex = 0; blockIndex < node.numBlocks; blockIndex++) {
+                int32_t *laneTriangles = &blockTriangles[numBlocks * 4];
+
+                for (int lane = 0; lane < 4; lane++) {
+                    int i = blockIndex * 4 + lane;
+                    laneTriangles[lane] = i < entry.count ? triangleIndexes[entry.first + i] : -1;
+                }
+
+                FillBlock(blocks[numBlocks++], laneTriangles, verts, indexes);
+            }
+            continue;
+        }
+
+        // Partition the triangles by the split plane.
+        const float minCenter = centerBounds[0][bestAxis];
+        const float binScale = NumBins / (centerBounds[1][bestAxis] - minCenter);
+
+        int32_t *left = triangleIndexes + entry.first;
+        int32_t *right = left + entry.count - 1;
+
+        while (left <= right) {
+            int binIndex = Min((int)((triangles[*left].center[bestAxis] - minCenter) * binScale), NumBins - 1);
+            if (binIndex < bestSplit) {
+                left++;
+            } else {
+                Swap(*left, *right);
+                right--;
+            }
+        }
+
+        const int leftCount = (int)(left - (triangleIndexes + entry.first));
+        assert(leftCount > 0 && leftCount < entry.count);
+
+        const int32_t leftChild = numNodes;
+        numNodes += 2;
+
+        node.first = leftChild;
+        node.numBlocks = 0;
+
+        stack[stackCount++] = { leftChild + 1, entry.first + leftCount, entry.count - leftCount, entry.depth + 1 };
+        stack[stackCount++] = { leftChild, entry.first, leftCount, entry.depth + 1 };
+    }
+
+    Mem_Free(stack);
+    Mem_Free(triangleIndexes);
+    Mem_Free(triangles);
+
+    state.store(State::Valid, std::memory_order_release);
+}
+
+void TriangleBVH::FillBlock(TriangleBlock &block, const int32_t *triangleIndexes, const VertexGenericLit *verts, const TriIndex *indexes) const {
+    memset(&block, 0, sizeof(block));
+
+    for (int lane = 0; lane < 4; lane++) {
+        const int32_t triangleIndex = triangleIndexes[lane];
+        if (triangleIndex < 0) {
+            break;
+        }
+
+        const Vec3 &v0 = verts[indexes[triangleIndex * 3 + 0]].xyz;
+        const Vec3 e1 = verts[indexes[triangleIndex * 3 + 1]].xyz - v0;
+        const Vec3 e2 = verts[indexes[triangleIndex * 3 + 2]].xyz - v0;
+
+        block.v0x[lane] = v0.x; block.v0y[lane] = v0.y; block.v0z[lane] = v0.z;
+        block.e1x[lane] = e1.x; block.e1y[lane] = e1.y; block.e1z[lane] = e1.z;
+        block.e2x[lane] = e2.x; block.e2y[lane] = e2.y; block.e2z[lane] = e2.z;
+    }
+}
+
+// Children are always allocated after their parent, so the nodes are refitted in reverse order.
+void TriangleBVH::Refit(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes) {
+    assert(numIndexes / 3 == numTriangles);
+
+    for (int blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+        FillBlock(blocks[blockIndex], &blockTriangles[blockIndex * 4], verts, indexes);
+    }
+
+    for (int nodeIndex = numNodes - 1; nodeIndex >= 0; nodeIndex--) {
+        Node &node = nodes[nodeIndex];
+
+        AABB bounds;
+        bounds.Clear();
+
+        if (node.IsLeaf()) {
+            const int32_t *triangleIndexes = &blockTriangles[node.first * 4];
+
+            for (int i = 0; i < node.numBlocks * 4 && triangleIndexes[i] >= 0; i++) {
+                bounds.AddPoint(verts[indexes[triangleIndexes[i] * 3 + 0]].xyz);
+                bounds.AddPoint(verts[indexes[triangleIndexes[i] * 3 + 1]].xyz);
+                bounds.AddPoint(verts[indexes[triangleIndexes[i] * 3 + 2]].xyz);
+            }
+        } else {
+            const Node &child1 = nodes[node.first];
+            const Node &child2 = nodes[node.first + 1];
+
+            bounds.AddPoint(Vec3(child1.mins[0], child1.mins[1], child1.mins[2]));
+            bounds.AddPoint(Vec3(child1.maxs[0], child1.maxs[1], child1.maxs[2]));
+            bounds.AddPoint(Vec3(child2.mins[0], child2.mins[1], child2.mins[2]));
+            bounds.AddPoint(Vec3(child2.maxs[0], child2.maxs[1], child2.maxs[2]));
+        }
+
+        for (int i = 0; i < 3; i++) {
+            node.mins[i] = bounds[0][i];
+            node.maxs[i] = bounds[1][i];
+        }
+    }
+
+    state.store(State::Valid, std::memory_order_release);
+}
+
+void TriangleBVH::Update(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes) {
+    if (IsValid()) {
+        return;
+    }
+
+    PlatformMutex::Lock(updateMutex);
+
+    // Another thread might have updated the tree while waiting for the lock.
+    State currentState = state.load(std::memory_order_acquire);
+    if (currentState == State::NeedsRefit && numIndexes / 3 == numTriangles) {
+        Refit(verts, indexes, numIndexes);
+    } else if (currentState != State::Valid) {
+        Build(verts, indexes, numIndexes);
+    }
+
+    PlatformMutex::Unlock(updateMutex);
+}
+
+void TriangleBVH::InvalidateVertices() {
+    // Nothing to refit if the tree has not been built yet.
+    if (state == State::Valid) {
+        state = State::NeedsRefit;
+    }
+}
+
+// Slab test, entryDist is clamped to 0 if the ray origin is inside.
+BE_INLINE static bool IntersectRayBounds(const Vec3 &origin, const Vec3 &invDir, float maxDist, const float *mins, const float *maxs, float &entryDist) {
+    float tmin = 0.0f;
+    float tmax = maxDist;
+
+    for (int i = 0; i < 3; i++) {
+        float t1 = (mins[i] - origin[i]) * invDir[i];
+        float t2 = (maxs[i] - origin[i]) * invDir[i];
+
+        tmin = Max(tmin, Min(t1, t2));
+        tmax = Min(tmax, Max(t1, t2));
+    }
+
+    entryDist = tmin;
+    return tmin <= tmax;
+}
+
+// Moller-Trumbore ray intersection with 4 triangles. Front faces are counter clock-wise, which are hit when det > 0.
+// Returns true if any triangle is hit closer than closestDist, and closestDist is updated.
+template <typename TriangleBlock>
+BE_INLINE static bool IntersectRayBlock(const Ray &ray, const TriangleBlock &block, bool ignoreBackFace, float &closestDist) {
+#if defined(__X86__)
+    const ssef dirX(ray.dir.x);
+    const ssef dirY(ray.dir.y);
+    const ssef dirZ(ray.dir.z);
+
+    const ssef e1x(_mm_load_ps(block.e1x));
+    const ssef e1y(_mm_load_ps(block.e1y));
+    const ssef e1z(_mm_load_ps(block.e1z));
+    const ssef e2x(_mm_load_ps(block.e2x));
+    const ssef e2y(_mm_load_ps(block.e2y));
+    const ssef e2z(_mm_load_ps(block.e2z));
+
+    // p = dir x e2
+    const ssef px = dirY * e2z - dirZ * e2y;
+    const ssef py = dirZ * e2x - dirX * e2z;
+    const ssef pz = dirX * e2y - dirY * e2x;
+
+    const ssef det = e1x * px + e1y * py + e1z * pz;
+    const ssef invDet = ssef(1.0f) / det;
+
+    // s = origin - v0
+    const ssef sx = ssef(ray.origin.x) - ssef(_mm_load_ps(block.v0x));
+    const ssef sy = ssef(ray.origin.y) - ssef(_mm_load_ps(block.v0y));
+    const ssef sz = ssef(ray.origin.z) - ssef(_mm_load_ps(block.v0z));
+
+    const ssef u = (sx * px + sy * py + sz * pz) * invDet;
+
+    // q = s x e1
+    const ssef qx = sy * e1z - sz * e1y;
+    const ssef qy = sz * e1x - sx * e1z;
+    const ssef qz = sx * e1y - sy * e1x;
+
+    const ssef v = (dirX * qx + dirY * qy + dirZ * qz) * invDet;
+    const ssef t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+    // Ordered comparisons are false for NaN of the degenerate triangles.
+    sseb valid = (0.0f <= u) & (0.0f <= v) & (u + v <= 1.0f) & (0.0f <= t) & (t < closestDist);
+    valid = valid & (ignoreBackFace ? (0.0f < det) : (0.0f < abs(det)));
+
+    int mask = (int)movemask(valid);
+    if (!mask) {
+        return false;
+    }
+
+    for (int lane = 0; lane < 4; lane++) {
+        if ((mask & BIT(lane)) && t[lane] < closestDist) {
+            closestDist = t[lane];
+        }
+    }
+    return true;
+#else
+    bool hit = false;
+
+    for (int lane = 0; lane < 4; lane++) {
+        const Vec3 e1(block.e1x[lane], block.e1y[lane], block.e1z[lane]);
+        const Vec3 e2(block.e2x[lane], block.e2y[lane], block.e2z[lane]);
+
+        const Vec3 p = ray.dir.Cross(e2);
+        const float det = e1.Dot(p);
+
+        if (ignoreBackFace ? !(det > 0.0f) : det == 0.0f) {
+            continue;
+        }
+
+        const float invDet = 1.0f / det;
+        const Vec3 s = ray.origin - Vec3(block.v0x[lane], block.v0y[lane], block.v0z[lane]);
+
+        const float u = s.Dot(p) * invDet;
+        if (u < 0.0f || u > 1.0f) {
+            continue;
+        }
+
+        const Vec3 q = s.Cross(e1);
+        const float v = ray.dir.Dot(q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) {
+            continue;
+        }
+
+        const float t = e2.Dot(q) * invDet;
+        if (t >= 0.0f && t < closestDist) {
+            closestDist = t;
+            hit = true;
+        }
+    }
+
+    return hit;
+#endif
+}
+
+bool TriangleBVH::IntersectRay(const Ray &ray, bool ignoreBackFace, bool anyHit, float maxDist, float *hitDist) const {
+    struct StackEntry {
+        int32_t             nodeIndex;
+        float               entryDist;
+    };
+
+    assert(IsValid());
+
+    if (numNodes == 0) {
+        return false;
+    }
+
+    // Avoid 0 * infinity in the slab test for the axis aligned directions.
+    const Vec3 invDir(
+        ray.dir.x != 0.0f ? 1.0f / ray.dir.x : FLT_MAX,
+        ray.dir.y != 0.0f ? 1.0f / ray.dir.y : FLT_MAX,
+        ray.dir.z != 0.0f ? 1.0f / ray.dir.z : FLT_MAX);
+
+    float closestDist = maxDist;
+    bool hit = false;
+
+    // Each level pushes at most one more entry.
+    StackEntry stack[MaxTreeDepth + 1];
+    int stackCount = 0;
+
+    float entryDist;
+    if (!IntersectRayBounds(ray.origin, invDir, closestDist, nodes[0].mins, nodes[0].maxs, entryDist)) {
+        return false;
+    }
+    stack[stackCount++] = { 0, entryDist };
+
+    while (stackCount > 0) {
+        const StackEntry entry = stack[--stackCount];
+
+        // The ray might be clipped by a closer hit after this node was pushed.
+        if (entry.entryDist > closestDist) {
+            continue;
+        }
+
+        const Node &node = nodes[entry.nodeIndex];
+
+        if (node.IsLeaf()) {
+            for (int blockIndex = node.first; blockIndex < node.first + node.numBlocks; blockIndex++) {
+                if (IntersectRayBlock(ray, blocks[blockIndex], ignoreBackFace, closestDist)) {
+                    hit = true;
+                    if (anyHit) {
+                        // Terminate the traversal.
+                        stackCount = 0;
+                        break;
+                    }
+                }
+            }
+            continue;
+        }
+
+        const Node &child1 = nodes[node.first];
+        const Node &child2 = nodes[node.first + 1];
+
+        float entryDist1, entryDist2;
+        bool hit1 = IntersectRayBounds(ray.origin, invDir, closestDist, child1.mins, child1.maxs, entryDist1);
+        bool hit2 = IntersectRayBounds(ray.origin, invDir, closestDist, child2.mins, child2.maxs, entryDist2);
+
+        assert(stackCount + 2 <= MaxTreeDepth + 1);
+
+        // Push the farther child first to visit the nearer child first.
+        if (hit1 && hit2) {
+            if (entryDist1 <= entryDist2) {
+                stack[stackCount++] = { node.first + 1, entryDist2 };
+                stack[stackCount++] = { node.first, entryDist1 };
+            } else {
+                stack[stackCount++] = { node.first, entryDist1 };
+                stack[stackCount++] = { node.first + 1, entryDist2 };
+            }
+        } else if (hit1) {
+            stack[stackCount++] = { node.first, entryDist1 };
+        } else if (hit2) {
+            stack[stackCount++] = { node.first + 1, entryDist2 };
+        }
+    }
+
+    if (hit && hitDist) {
+        *hitDist = closestDist;
+    }
+    return hit;
+}
+
+BE_NAMESPACE_END
@@ -25,7 +25,9 @@ void LuaVM::RegisterPrefabAsset(LuaCpp::Module &module) {
     _Prefab.SetClass<Prefab>();
     _Prefab.AddClassMembers<Prefab>(
         "name", &Prefab::GetName,
-        "root_entity", &Prefab::GetRootEntity);
+        "root_entity", &Prefab::GetRootEntity,
+        "pool_capacity", &Prefab::GetPoolCapacity,
+        "set_pool_capacity", &Prefab::SetPoolCapacity);
 
     LuaCpp::Selector _PrefabAsset = module["PrefabAsset"];
 
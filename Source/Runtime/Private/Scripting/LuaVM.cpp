@@ -19,6 +19,7 @@
 #include "File/File.h"
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
+#include "Platform/PlatformTime.h"
 
 extern "C" {
 #include "luasocket/luasocket.h"
@@ -36,6 +37,10 @@ static CVAR(lua_debug, "0", CVar::Flag::Bool | CVar::Flag::Archive, "Enable Lua
 static CVAR(lua_debuggerServer, "localhost", CVar::Flag::Archive, "Lua debugger server address for remote debugging");
 static CVAR(lua_debuggeeController, "mobdebug_controller", 0, "Lua debuggee controller script name");
 
+static CVAR(lua_gcBudget, "1000", CVar::Flag::Integer | CVar::Flag::Archive, "Lua GC time budget per frame in microseconds, 0 = full collection every frame");
+static CVAR(lua_gcStepSize, "16", CVar::Flag::Integer, "Lua GC incremental step size in kilobytes");
+static CVAR(lua_gcGenerational, "1", CVar::Flag::Bool, "Use generational Lua GC if supported");
+
 static int engine_print(lua_State *L) {
     int nargs = lua_gettop(L);
     for (int i = 1; i <= nargs; ++i) {
@@ -63,6 +68,10 @@ void LuaVM::Init() {
     // Redirect global print function
     state->RegisterLib(printlib, nullptr);
 
+    if (lua_gcGenerational.GetBool()) {
+        state->SetGenerationalGC();
+    }
+
     state->HandleExceptionsWith([](int status, std::string msg, std::exception_ptr exception) {
         const char *statusStr = "";
         switch (status) {
@@ -289,6 +298,27 @@ void LuaVM::RegisterEngineModuleCallback(EngineModuleCallback callback) {
     engineModuleCallbacks.Append(callback);
 }
 
+void LuaVM::CollectGarbage() {
+    const uint64_t startTime = PlatformTime::Microseconds();
+    const uint64_t budget = Max(lua_gcBudget.GetInteger(), 0);
+
+    if (budget == 0) {
+        state->ForceGC();
+    } else {
+        const int stepKb = Max(lua_gcStepSize.GetInteger(), 1);
+
+        // Stop at the end of the cycle not to start the next one in the same frame.
+        while (!state->StepGC(stepKb)) {
+            if (PlatformTime::Microseconds() - startTime >= budget) {
+                break;
+            }
+        }
+    }
+
+    gcTime = (int)(PlatformTime::Microseconds() - startTime);
+    gcHeapKb = state->GetGCKb();
+}
+
 const char *LuaVM::GetLuaVersion() const { 
     static char versionString[32] = "";
     int major, minor;
@@ -35,29 +35,12 @@ void SIMD::Init(bool forceGeneric) {
 
     if (forceGeneric) {
         simdProcessor = simdGeneric;
+    } else if (IsSupported(Type::AVX)) {
+        simdProcessor = CreateProcessor(Type::AVX);
+    } else if (IsSupported(Type::SSE4)) {
+        simdProcessor = CreateProcessor(Type::SSE4);
     } else {
-#if defined(__X86__)
-        if ((cpuid & CPUID_MMX) && 
-            (cpuid & CPUID_SSE) && 
-            (cpuid & CPUID_SSE2) && 
-            (cpuid & CPUID_SSE3) && 
-            (cpuid & CPUID_SSE4) && 
-            (cpuid & CPUID_AVX)) {
-            simdProcessor = new SIMD_AVX;
-        } else if ((cpuid & CPUID_MMX) && 
-            (cpuid & CPUID_SSE) && 
-            (cpuid & CPUID_SSE2) && 
-            (cpuid & CPUID_SSE3) && 
-            (cpuid & CPUID_SSE4)) {
-            simdProcessor = new SIMD_SSE4;
-        } else {
-            simdProcessor = simdGeneric;
-        }
-#elif defined(__ARM__)
         simdProcessor = simdGeneric;
-#else
-        simdProcessor = simdGeneric;
-#endif
     }
 
     BE_LOG("using %s for SIMD processing\n", simdProcessor->GetName());
@@ -75,6 +58,49 @@ void SIMD::Init(bool forceGeneric) {
 #endif
 }
 
+bool SIMD::IsSupported(Type::Enum type) {
+    int cpuid = GetCpuInfo()->cpuid;
+
+    switch (type) {
+    case Type::Generic:
+        return true;
+#if defined(__X86__)
+    case Type::SSE4:
+        return (cpuid & CPUID_MMX) && 
+            (cpuid & CPUID_SSE) && 
+            (cpuid & CPUID_SSE2) && 
+            (cpuid & CPUID_SSE3) && 
+            (cpuid & CPUID_SSE4);
+    case Type::AVX:
+        return IsSupported(Type::SSE4) && 
+            (cpuid & CPUID_AVX) &&
+            (cpuid & CPUID_AVX2) &&
+            (cpuid & CPUID_FMA3);
+#endif
+    default:
+        return false;
+    }
+}
+
+SIMDProcessor *SIMD::CreateProcessor(Type::Enum type) {
+    if (!IsSupported(type)) {
+        return nullptr;
+    }
+
+    switch (type) {
+    case Type::Generic:
+        return new SIMD_Generic;
+#if defined(__X86__)
+    case Type::SSE4:
+        return new SIMD_SSE4;
+    case Type::AVX:
+        return new SIMD_AVX;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
 void SIMD::Shutdown() {
     if (simdProcessor != simdGeneric) {
         delete simdProcessor;
@@ -13,16 +13,626 @@
 // limitations under the License.
 
 #include "Precompiled.h"
+#include "Math/Math.h"
+#include "Core/Vertex.h"
+#include "Core/JointPose.h"
 #include "Simd/Simd.h"
 #include "Simd/Simd_Generic.h"
 
 #if defined(__X86__)
 
+#include <immintrin.h>
 #include "Simd/Simd_SSE4.h"
 #include "Simd/Simd_AVX.h"
 
 BE_NAMESPACE_BEGIN
 
+// This file is compiled with AVX2 and FMA code generation.
+// Only the intrinsics and the force inlined functions in this file should be used in here,
+// so that no AVX2 code is emitted for the inline functions shared with the other translation units.
+
+//-------------------------------------------------------------
+// Joint and skinning kernels
+//-------------------------------------------------------------
+
+// Loads the 4 floats at lo into the low 128 bits and the 4 floats at hi into the high 128 bits.
+static BE_FORCE_INLINE __m256 Load4x2(const float *lo, const float *hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+}
+
+// Loads the 2 floats at lo and the 2 floats at hi into the low 64 bits of each 128 bits lane.
+static BE_FORCE_INLINE __m256 Load2x2(const float *lo, const float *hi) {
+    __m128 l = _mm_castpd_ps(_mm_load_sd((const double *)lo));
+    __m128 h = _mm_castpd_ps(_mm_load_sd((const double *)hi));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(l), h, 1);
+}
+
+// Transposes the 4x4 matrices in the low and the high 128 bits lanes.
+static BE_FORCE_INLINE void Transpose4x4x2(__m256 &r0, __m256 &r1, __m256 &r2, __m256 &r3) {
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1); // 00, 10, 01, 11
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1); // 02, 12, 03, 13
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3); // 20, 30, 21, 31
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3); // 22, 32, 23, 33
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0)); // 00, 10, 20, 30
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2)); // 01, 11, 21, 31
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0)); // 02, 12, 22, 32
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2)); // 03, 13, 23, 33
+}
+
+static BE_FORCE_INLINE __m256 Select(const __m256 &mask, const __m256 &t, const __m256 &f) {
+    return _mm256_blendv_ps(f, t, mask);
+}
+
+static BE_FORCE_INLINE __m256 Abs(const __m256 &a) {
+    return _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff)));
+}
+
+static BE_FORCE_INLINE __m256 Negate(const __m256 &a) {
+    return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000)));
+}
+
+// Reciprocal square root with one Newton-Raphson iteration.
+static BE_FORCE_INLINE __m256 RSqrt(const __m256 &a) {
+    __m256 r = _mm256_rsqrt_ps(a);
+    __m256 h = _mm256_mul_ps(_mm256_mul_ps(a, _mm256_set1_ps(0.5f)), r);
+    return _mm256_mul_ps(r, _mm256_fnmadd_ps(h, r, _mm256_set1_ps(1.5f)));
+}
+
+// Returns lane indexes 0, 1, .. 7 clamped to count - 1.
+static BE_FORCE_INLINE __m256i ClampedLanes(int count) {
+    return _mm256_min_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(count - 1));
+}
+
+// dst = a * b for the row major 3x4 matrices (same as Mat3x4::operator*).
+// dst can be the same as a or b.
+static BE_FORCE_INLINE void MultiplyMat3x4(float *dst, const float *a, const float *b) {
+    const __m128 maskW = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+
+    // The first two rows are computed in one 256 bits register.
+    const __m256 a01 = _mm256_loadu_ps(a);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+
+    const __m128 b0 = _mm_loadu_ps(b);
+    const __m128 b1 = _mm_loadu_ps(b + 4);
+    const __m128 b2 = _mm_loadu_ps(b + 8);
+
+    const __m256 bb0 = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b0, 1);
+    const __m256 bb1 = _mm256_insertf128_ps(_mm256_castps128_ps256(b1), b1, 1);
+    const __m256 bb2 = _mm256_insertf128_ps(_mm256_castps128_ps256(b2), b2, 1);
+
+    __m256 r01 = _mm256_and_ps(a01, _mm256_insertf128_ps(_mm256_castps128_ps256(maskW), maskW, 1));
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(2, 2, 2, 2)), bb2, r01);
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(1, 1, 1, 1)), bb1, r01);
+    r01 = _mm256_fmadd_ps(_mm256_permute_ps(a01, _MM_SHUFFLE(0, 0, 0, 0)), bb0, r01);
+
+    __m128 r2 = _mm_and_ps(a2, maskW);
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(2, 2, 2, 2)), b2, r2);
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(1, 1, 1, 1)), b1, r2);
+    r2 = _mm_fmadd_ps(_mm_permute_ps(a2, _MM_SHUFFLE(0, 0, 0, 0)), b0, r2);
+
+    _mm256_storeu_ps(dst, r01);
+    _mm_storeu_ps(dst + 8, r2);
+}
+
+// Math::Sin16() for angles in range [0, pi/2].
+static BE_FORCE_INLINE __m256 Sin16(const __m256 &a) {
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_fmadd_ps(_mm256_set1_ps(-2.39e-08f), s, _mm256_set1_ps(2.7526e-06f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(-1.98409e-04f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(8.3333315e-03f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(-1.666666664e-01f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(1.0f));
+    return _mm256_mul_ps(a, r);
+}
+
+// Math::ATan16(y, x) for non-negative x and y.
+static BE_FORCE_INLINE __m256 ATan16(const __m256 &y, const __m256 &x) {
+    const __m256 swap = _mm256_cmp_ps(y, x, _CMP_GT_OQ);
+    const __m256 a = _mm256_div_ps(Select(swap, x, y), Select(swap, y, x));
+    const __m256 s = _mm256_mul_ps(a, a);
+    __m256 r = _mm256_fmadd_ps(_mm256_set1_ps(0.0028662257f), s, _mm256_set1_ps(-0.0161657367f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(0.0429096138f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(-0.0752896400f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(0.1065626393f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(-0.1420889944f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(0.1999355085f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(-0.3333314528f));
+    r = _mm256_fmadd_ps(r, s, _mm256_set1_ps(1.0f));
+    r = _mm256_mul_ps(r, a);
+    return Select(swap, _mm256_sub_ps(_mm256_set1_ps(Math::HalfPi), r), r);
+}
+
+// Computes the interpolation factors of 8 quaternion pairs like Quat::SetFromSlerp() does.
+// t should be in range (0, 1).
+static BE_FORCE_INLINE void SlerpFactors(const __m256 &cosom, const __m256 &t, __m256 &scale0, __m256 &scale1) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 flip = _mm256_cmp_ps(cosom, _mm256_setzero_ps(), _CMP_LT_OQ);
+    const __m256 absCosom = Abs(cosom);
+    const __m256 oneMinusT = _mm256_sub_ps(one, t);
+
+    const __m256 sinSqr = _mm256_fnmadd_ps(absCosom, absCosom, one);
+    const __m256 invSinom = RSqrt(sinSqr);
+    const __m256 omega = ATan16(_mm256_mul_ps(sinSqr, invSinom), absCosom);
+
+    // Quaternions which are very close are linearly interpolated.
+    const __m256 nearby = _mm256_cmp_ps(_mm256_sub_ps(one, absCosom), _mm256_set1_ps(1e-6f), _CMP_LE_OQ);
+    scale0 = Select(nearby, oneMinusT, _mm256_mul_ps(Sin16(_mm256_mul_ps(oneMinusT, omega)), invSinom));
+    scale1 = Select(nearby, t, _mm256_mul_ps(Sin16(_mm256_mul_ps(t, omega)), invSinom));
+
+    // Adjust signs to take the shortest path.
+    scale1 = Select(flip, Negate(scale1), scale1);
+}
+
+// Quaternion product a * b of 8 quaternions in SoA form.
+// The outputs can be the same as the inputs.
+static BE_FORCE_INLINE void MultiplyQuats(const __m256 &ax, const __m256 &ay, const __m256 &az, const __m256 &aw,
+    const __m256 &bx, const __m256 &by, const __m256 &bz, const __m256 &bw, __m256 &x, __m256 &y, __m256 &z, __m256 &w) {
+    __m256 rx = _mm256_fmsub_ps(ay, bz, _mm256_mul_ps(az, by));
+    rx = _mm256_fmadd_ps(ax, bw, rx);
+    rx = _mm256_fmadd_ps(aw, bx, rx);
+
+    __m256 ry = _mm256_fmsub_ps(az, bx, _mm256_mul_ps(ax, bz));
+    ry = _mm256_fmadd_ps(ay, bw, ry);
+    ry = _mm256_fmadd_ps(aw, by, ry);
+
+    __m256 rz = _mm256_fmsub_ps(ax, by, _mm256_mul_ps(ay, bx));
+    rz = _mm256_fmadd_ps(az, bw, rz);
+    rz = _mm256_fmadd_ps(aw, bz, rz);
+
+    __m256 rw = _mm256_fmsub_ps(aw, bw, _mm256_mul_ps(ax, bx));
+    rw = _mm256_fnmadd_ps(ay, by, rw);
+    rw = _mm256_fnmadd_ps(az, bz, rw);
+
+    x = rx;
+    y = ry;
+    z = rz;
+    w = rw;
+}
+
+void BE_FASTCALL SIMD_AVX::DecompressJoints(JointPose *joints, const CompressedJointPose *compressedJoints, const int *index, const int numJoints) {
+    const __m256 quatScale = _mm256_set1_ps(1.0f / 32767.0f);
+    const __m256 translationScale = _mm256_set1_ps(1.0f / (32767.0f / CompressedJointPose::MaxBoneTranslation));
+    const __m256 scaleScale = _mm256_set1_ps(1.0f / (32767.0f / CompressedJointPose::MaxBoneScale));
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    const int *base = (const int *)compressedJoints;
+
+    // Decompresses 8 joints at a time in SoA form.
+    // The last group is padded with the last joint.
+    for (int i = 0; i < numJoints; i += 8) {
+        const int count = Min(numJoints - i, 8);
+
+        const __m256i jointIndexes = _mm256_i32gather_epi32(index + i, ClampedLanes(count), 4);
+        const __m256i offsets = _mm256_mullo_epi32(jointIndexes, _mm256_set1_epi32(sizeof(CompressedJointPose)));
+
+        // Gather pairs of shorts. The last gather starts at s[1] not to read past the end of the compressed joint.
+        const __m256i q01 = _mm256_i32gather_epi32(base, offsets, 1);
+        const __m256i q2t0 = _mm256_i32gather_epi32((const int *)((const byte *)base + 4), offsets, 1);
+        const __m256i t12 = _mm256_i32gather_epi32((const int *)((const byte *)base + 8), offsets, 1);
+        const __m256i s01 = _mm256_i32gather_epi32((const int *)((const byte *)base + 12), offsets, 1);
+        const __m256i s12 = _mm256_i32gather_epi32((const int *)((const byte *)base + 14), offsets, 1);
+
+        // Sign extend the low and the high shorts to floats.
+#define LO_SHORT(v) _mm256_cvtepi32_ps(_mm256_srai_epi32(_mm256_slli_epi32(v, 16), 16))
+#define HI_SHORT(v) _mm256_cvtepi32_ps(_mm256_srai_epi32(v, 16))
+        __m256 qx = _mm256_mul_ps(LO_SHORT(q01), quatScale);
+        __m256 qy = _mm256_mul_ps(HI_SHORT(q01), quatScale);
+        __m256 qz = _mm256_mul_ps(LO_SHORT(q2t0), quatScale);
+        __m256 tx = _mm256_mul_ps(HI_SHORT(q2t0), translationScale);
+        __m256 ty = _mm256_mul_ps(LO_SHORT(t12), translationScale);
+        __m256 tz = _mm256_mul_ps(HI_SHORT(t12), translationScale);
+        __m256 sx = _mm256_mul_ps(LO_SHORT(s01), scaleScale);
+        __m256 sy = _mm256_mul_ps(HI_SHORT(s01), scaleScale);
+        __m256 sz = _mm256_mul_ps(HI_SHORT(s12), scaleScale);
+#undef LO_SHORT
+#undef HI_SHORT
+
+        // w = sqrt(|1 - (x * x + y * y + z * z)|)
+        __m256 dot = _mm256_fmadd_ps(qz, qz, _mm256_fmadd_ps(qy, qy, _mm256_mul_ps(qx, qx)));
+        __m256 qw = _mm256_sqrt_ps(Abs(_mm256_sub_ps(one, dot)));
+
+        Transpose4x4x2(qx, qy, qz, qw);
+        Transpose4x4x2(tx, ty, tz, sx);
+        const __m256 syz0 = _mm256_unpacklo_ps(sy, sz); // sy0, sz0, sy1, sz1
+        const __m256 syz1 = _mm256_unpackhi_ps(sy, sz); // sy2, sz2, sy3, sz3
+
+        const __m256 q[4] = { qx, qy, qz, qw };
+        const __m256 ts[4] = { tx, ty, tz, sx };
+
+        for (int k = 0; k < count; k++) {
+            const int lane = k & 3;
+            const bool hi = k >= 4;
+
+            float *dst = joints[index[i + k]].q.Ptr();
+            const __m128 syz = hi ? _mm256_extractf128_ps(lane < 2 ? syz0 : syz1, 1) : _mm256_castps256_ps128(lane < 2 ? syz0 : syz1);
+
+            _mm_storeu_ps(dst, hi ? _mm256_extractf128_ps(q[lane], 1) : _mm256_castps256_ps128(q[lane]));
+            _mm_storeu_ps(dst + 4, hi ? _mm256_extractf128_ps(ts[lane], 1) : _mm256_castps256_ps128(ts[lane]));
+            if (lane & 1) {
+                _mm_storeh_pi((__m64 *)(dst + 8), syz);
+            } else {
+                _mm_storel_pi((__m64 *)(dst + 8), syz);
+            }
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+// Blends 8 joints at a time in SoA form.
+// The last group is padded with the last joint. The padded lanes write the same results to the same joint.
+template <bool Additive, bool Fast>
+static BE_FORCE_INLINE void BlendJointQuats(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    const __m256 t = _mm256_set1_ps(fraction);
+
+    for (int i = 0; i < numJoints; i += 8) {
+        int j[8];
+        for (int k = 0; k < 8; k++) {
+            j[k] = index[Min(i + k, numJoints - 1)];
+        }
+
+        __m256 x = Load4x2(joints[j[0]].q.Ptr(), joints[j[4]].q.Ptr());
+        __m256 y = Load4x2(joints[j[1]].q.Ptr(), joints[j[5]].q.Ptr());
+        __m256 z = Load4x2(joints[j[2]].q.Ptr(), joints[j[6]].q.Ptr());
+        __m256 w = Load4x2(joints[j[3]].q.Ptr(), joints[j[7]].q.Ptr());
+        Transpose4x4x2(x, y, z, w);
+
+        __m256 bx = Load4x2(blendJoints[j[0]].q.Ptr(), blendJoints[j[4]].q.Ptr());
+        __m256 by = Load4x2(blendJoints[j[1]].q.Ptr(), blendJoints[j[5]].q.Ptr());
+        __m256 bz = Load4x2(blendJoints[j[2]].q.Ptr(), blendJoints[j[6]].q.Ptr());
+        __m256 bw = Load4x2(blendJoints[j[3]].q.Ptr(), blendJoints[j[7]].q.Ptr());
+        Transpose4x4x2(bx, by, bz, bw);
+
+        if (Additive) {
+            MultiplyQuats(bx, by, bz, bw, x, y, z, w, bx, by, bz, bw);
+        }
+
+        __m256 cosom = _mm256_mul_ps(x, bx);
+        cosom = _mm256_fmadd_ps(y, by, cosom);
+        cosom = _mm256_fmadd_ps(z, bz, cosom);
+        cosom = _mm256_fmadd_ps(w, bw, cosom);
+
+        __m256 scale0, scale1;
+        if (Fast) {
+            scale0 = _mm256_sub_ps(_mm256_set1_ps(1.0f), t);
+            scale1 = Select(_mm256_cmp_ps(cosom, _mm256_setzero_ps(), _CMP_LT_OQ), Negate(t), t);
+        } else {
+            SlerpFactors(cosom, t, scale0, scale1);
+        }
+
+        x = _mm256_fmadd_ps(scale0, x, _mm256_mul_ps(scale1, bx));
+        y = _mm256_fmadd_ps(scale0, y, _mm256_mul_ps(scale1, by));
+        z = _mm256_fmadd_ps(scale0, z, _mm256_mul_ps(scale1, bz));
+        w = _mm256_fmadd_ps(scale0, w, _mm256_mul_ps(scale1, bw));
+
+        if (Fast) {
+            __m256 lengthSqr = _mm256_mul_ps(x, x);
+            lengthSqr = _mm256_fmadd_ps(y, y, lengthSqr);
+            lengthSqr = _mm256_fmadd_ps(z, z, lengthSqr);
+            lengthSqr = _mm256_fmadd_ps(w, w, lengthSqr);
+
+            const __m256 invLength = RSqrt(lengthSqr);
+            x = _mm256_mul_ps(x, invLength);
+            y = _mm256_mul_ps(y, invLength);
+            z = _mm256_mul_ps(z, invLength);
+            w = _mm256_mul_ps(w, invLength);
+        }
+
+        Transpose4x4x2(x, y, z, w);
+
+        _mm_storeu_ps(joints[j[0]].q.Ptr(), _mm256_castps256_ps128(x));
+        _mm_storeu_ps(joints[j[1]].q.Ptr(), _mm256_castps256_ps128(y));
+        _mm_storeu_ps(joints[j[2]].q.Ptr(), _mm256_castps256_ps128(z));
+        _mm_storeu_ps(joints[j[3]].q.Ptr(), _mm256_castps256_ps128(w));
+        _mm_storeu_ps(joints[j[4]].q.Ptr(), _mm256_extractf128_ps(x, 1));
+        _mm_storeu_ps(joints[j[5]].q.Ptr(), _mm256_extractf128_ps(y, 1));
+        _mm_storeu_ps(joints[j[6]].q.Ptr(), _mm256_extractf128_ps(z, 1));
+        _mm_storeu_ps(joints[j[7]].q.Ptr(), _mm256_extractf128_ps(w, 1));
+    }
+}
+
+// Translation and scale of a joint are 6 consecutive floats.
+static BE_FORCE_INLINE __m256i TranslationScaleMask() {
+    return _mm256_setr_epi32(-1, -1, -1, -1, -1, -1, 0, 0);
+}
+
+// Linearly interpolates the translations and the scales of the joints.
+static BE_FORCE_INLINE void LerpTranslationScales(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    const __m256i mask = TranslationScaleMask();
+    const __m256 t = _mm256_set1_ps(fraction);
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        float *dst = joints[j].t.Ptr();
+        const __m256 ts = _mm256_maskload_ps(dst, mask);
+        const __m256 bts = _mm256_maskload_ps(blendJoints[j].t.Ptr(), mask);
+
+        _mm256_maskstore_ps(dst, mask, _mm256_fmadd_ps(t, _mm256_sub_ps(bts, ts), ts));
+    }
+}
+
+void BE_FASTCALL SIMD_AVX::BlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction <= 0.0f) {
+        return;
+    }
+
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j] = blendJoints[j];
+        }
+        return;
+    }
+
+    BlendJointQuats<false, false>(joints, blendJoints, fraction, index, numJoints);
+
+    LerpTranslationScales(joints, blendJoints, fraction, index, numJoints);
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::BlendJointsFast(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction <= 0.0f) {
+        return;
+    }
+
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j] = blendJoints[j];
+        }
+        return;
+    }
+
+    BlendJointQuats<false, true>(joints, blendJoints, fraction, index, numJoints);
+
+    LerpTranslationScales(joints, blendJoints, fraction, index, numJoints);
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::AdditiveBlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j].q = blendJoints[j].q * joints[j].q;
+        }
+    } else if (fraction > 0.0f) {
+        BlendJointQuats<true, false>(joints, blendJoints, fraction, index, numJoints);
+    }
+
+    const __m256i mask = TranslationScaleMask();
+    const __m256 t = _mm256_set1_ps(fraction);
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        // t += blend.t * fraction, s *= blend.s * fraction
+        float *dst = joints[j].t.Ptr();
+        const __m256 ts = _mm256_maskload_ps(dst, mask);
+        const __m256 bts = _mm256_mul_ps(_mm256_maskload_ps(blendJoints[j].t.Ptr(), mask), t);
+
+        _mm256_maskstore_ps(dst, mask, _mm256_blend_ps(_mm256_add_ps(ts, bts), _mm256_mul_ps(ts, bts), 0x38));
+    }
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::ConvertJointPosesToJointMats(Mat3x4 *jointMats, const JointPose *jointPoses, const int numJoints) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    // Converts 8 joints at a time in SoA form.
+    // The last group is padded with the last joint.
+    for (int i = 0; i < numJoints; i += 8) {
+        const JointPose *p[8];
+        float *m[8];
+        for (int k = 0; k < 8; k++) {
+            const int jointIndex = Min(i + k, numJoints - 1);
+            p[k] = &jointPoses[jointIndex];
+            m[k] = jointMats[jointIndex].Ptr();
+        }
+
+        __m256 x = Load4x2(p[0]->q.Ptr(), p[4]->q.Ptr());
+        __m256 y = Load4x2(p[1]->q.Ptr(), p[5]->q.Ptr());
+        __m256 z = Load4x2(p[2]->q.Ptr(), p[6]->q.Ptr());
+        __m256 w = Load4x2(p[3]->q.Ptr(), p[7]->q.Ptr());
+        Transpose4x4x2(x, y, z, w);
+
+        // tx, ty, tz, sx
+        __m256 tx = Load4x2(p[0]->t.Ptr(), p[4]->t.Ptr());
+        __m256 ty = Load4x2(p[1]->t.Ptr(), p[5]->t.Ptr());
+        __m256 tz = Load4x2(p[2]->t.Ptr(), p[6]->t.Ptr());
+        __m256 sx = Load4x2(p[3]->t.Ptr(), p[7]->t.Ptr());
+        Transpose4x4x2(tx, ty, tz, sx);
+
+        // sy, sz
+        const __m256 s01 = _mm256_unpacklo_ps(Load2x2(&p[0]->s.y, &p[4]->s.y), Load2x2(&p[1]->s.y, &p[5]->s.y));
+        const __m256 s23 = _mm256_unpacklo_ps(Load2x2(&p[2]->s.y, &p[6]->s.y), Load2x2(&p[3]->s.y, &p[7]->s.y));
+        const __m256 sy = _mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 sz = _mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(3, 2, 3, 2));
+
+        const __m256 x2 = _mm256_add_ps(x, x);
+        const __m256 y2 = _mm256_add_ps(y, y);
+        const __m256 z2 = _mm256_add_ps(z, z);
+
+        const __m256 xx2 = _mm256_mul_ps(x, x2);
+        const __m256 xy2 = _mm256_mul_ps(x, y2);
+        const __m256 xz2 = _mm256_mul_ps(x, z2);
+        const __m256 yy2 = _mm256_mul_ps(y, y2);
+        const __m256 yz2 = _mm256_mul_ps(y, z2);
+        const __m256 zz2 = _mm256_mul_ps(z, z2);
+
+        __m256 r0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, yy2), zz2), sx);
+        __m256 r1 = _mm256_mul_ps(_mm256_fnmadd_ps(w, z2, xy2), sy);
+        __m256 r2 = _mm256_mul_ps(_mm256_fmadd_ps(w, y2, xz2), sz);
+        __m256 r3 = tx;
+        Transpose4x4x2(r0, r1, r2, r3);
+        _mm_storeu_ps(m[0], _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(m[1], _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(m[2], _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(m[3], _mm256_castps256_ps128(r3));
+        _mm_storeu_ps(m[4], _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(m[5], _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(m[6], _mm256_extractf128_ps(r2, 1));
+        _mm_storeu_ps(m[7], _mm256_extractf128_ps(r3, 1));
+
+        r0 = _mm256_mul_ps(_mm256_fmadd_ps(w, z2, xy2), sx);
+        r1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, xx2), zz2), sy);
+        r2 = _mm256_mul_ps(_mm256_fnmadd_ps(w, x2, yz2), sz);
+        r3 = ty;
+        Transpose4x4x2(r0, r1, r2, r3);
+        _mm_storeu_ps(m[0] + 4, _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(m[1] + 4, _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(m[2] + 4, _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(m[3] + 4, _mm256_castps256_ps128(r3));
+        _mm_storeu_ps(m[4] + 4, _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(m[5] + 4, _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(m[6] + 4, _mm256_extractf128_ps(r2, 1));
+        _mm_storeu_ps(m[7] + 4, _mm256_extractf128_ps(r3, 1));
+
+        r0 = _mm256_mul_ps(_mm256_fnmadd_ps(w, y2, xz2), sx);
+        r1 = _mm256_mul_ps(_mm256_fmadd_ps(w, x2, yz2), sy);
+        r2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(one, xx2), yy2), sz);
+        r3 = tz;
+        Transpose4x4x2(r0, r1, r2, r3);
+        _mm_storeu_ps(m[0] + 8, _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(m[1] + 8, _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(m[2] + 8, _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(m[3] + 8, _mm256_castps256_ps128(r3));
+        _mm_storeu_ps(m[4] + 8, _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(m[5] + 8, _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(m[6] + 8, _mm256_extractf128_ps(r2, 1));
+        _mm_storeu_ps(m[7] + 8, _mm256_extractf128_ps(r3, 1));
+    }
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::TransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint) {
+    for (int i = firstJoint; i <= lastJoint; i++) {
+        assert(parents[i] < i);
+        if (parents[i] >= 0) {
+            // jointMats[i] = jointMats[parents[i]] * jointMats[i]
+            MultiplyMat3x4(jointMats[i].Ptr(), jointMats[parents[i]].Ptr(), jointMats[i].Ptr());
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints) {
+    for (int i = 0; i < numJoints; i++) {
+        MultiplyMat3x4(result[i].Ptr(), joints1[i].Ptr(), joints2[i].Ptr());
+    }
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::TransformVerts(VertexGenericLit *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *base, const int *index, const int numWeights) {
+    const byte *jointsPtr = (const byte *)joints;
+
+    for (int i = 0, j = 0; i < numVerts; i++) {
+        // Accumulate the products of the matrix rows and the weighted vertex,
+        // the first two rows in one 256 bits register. The horizontal sums are done once per vertex.
+        const float *mat = (const float *)(jointsPtr + index[j * 2 + 0]);
+        __m256 v = _mm256_broadcast_ps((const __m128 *)base[j].Ptr());
+
+        __m256 xy = _mm256_mul_ps(_mm256_loadu_ps(mat), v);
+        __m128 z = _mm_mul_ps(_mm_loadu_ps(mat + 8), _mm256_castps256_ps128(v));
+
+        while (index[j * 2 + 1] == 0) {
+            j++;
+            mat = (const float *)(jointsPtr + index[j * 2 + 0]);
+            v = _mm256_broadcast_ps((const __m128 *)base[j].Ptr());
+
+            xy = _mm256_fmadd_ps(_mm256_loadu_ps(mat), v, xy);
+            z = _mm_fmadd_ps(_mm_loadu_ps(mat + 8), _mm256_castps256_ps128(v), z);
+        }
+
+        j++;
+
+        __m128 h = _mm_hadd_ps(_mm256_castps256_ps128(xy), _mm256_extractf128_ps(xy, 1));
+        __m128 r = _mm_hadd_ps(h, _mm_hadd_ps(z, z));
+
+        float *dst = verts[i].xyz.Ptr();
+        _mm_storel_pi((__m64 *)dst, r);
+        _mm_store_ss(dst + 2, _mm_movehl_ps(r, r));
+    }
+
+    _mm256_zeroupper();
+}
+
+void BE_FASTCALL SIMD_AVX::DeriveTriPlanes(Plane *planes, const VertexGenericLit *verts, const int numVerts, const int *indexes, const int numIndexes) {
+    static_assert(sizeof(VertexGenericLit) % sizeof(float) == 0, "vertex size should be multiple of float size");
+
+    const __m256i vertexStride = _mm256_set1_epi32(sizeof(VertexGenericLit) / sizeof(float));
+    const float *xyz = verts[0].xyz.Ptr();
+    const int numTris = numIndexes / 3;
+
+    // Derives 8 planes at a time in SoA form.
+    // The last group is padded with the last triangle.
+    for (int i = 0; i < numTris; i += 8) {
+        const int count = Min(numTris - i, 8);
+
+        const __m256i triOffsets = _mm256_mullo_epi32(ClampedLanes(count), _mm256_set1_epi32(3));
+        const int *triIndexes = &indexes[i * 3];
+
+        const __m256i ia = _mm256_mullo_epi32(_mm256_i32gather_epi32(triIndexes + 0, triOffsets, 4), vertexStride);
+        const __m256i ib = _mm256_mullo_epi32(_mm256_i32gather_epi32(triIndexes + 1, triOffsets, 4), vertexStride);
+        const __m256i ic = _mm256_mullo_epi32(_mm256_i32gather_epi32(triIndexes + 2, triOffsets, 4), vertexStride);
+
+        const __m256 ax = _mm256_i32gather_ps(xyz + 0, ia, 4);
+        const __m256 ay = _mm256_i32gather_ps(xyz + 1, ia, 4);
+        const __m256 az = _mm256_i32gather_ps(xyz + 2, ia, 4);
+
+        const __m256 d0x = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 0, ib, 4), ax);
+        const __m256 d0y = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 1, ib, 4), ay);
+        const __m256 d0z = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 2, ib, 4), az);
+
+        const __m256 d1x = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 0, ic, 4), ax);
+        const __m256 d1y = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 1, ic, 4), ay);
+        const __m256 d1z = _mm256_sub_ps(_mm256_i32gather_ps(xyz + 2, ic, 4), az);
+
+        __m256 nx = _mm256_fmsub_ps(d1y, d0z, _mm256_mul_ps(d1z, d0y));
+        __m256 ny = _mm256_fmsub_ps(d1z, d0x, _mm256_mul_ps(d1x, d0z));
+        __m256 nz = _mm256_fmsub_ps(d1x, d0y, _mm256_mul_ps(d1y, d0x));
+
+        __m256 lengthSqr = _mm256_mul_ps(nx, nx);
+        lengthSqr = _mm256_fmadd_ps(ny, ny, lengthSqr);
+        lengthSqr = _mm256_fmadd_ps(nz, nz, lengthSqr);
+        // Degenerated triangles get zero normal.
+        // Fused cross product of the parallel edges doesn't cancel out exactly, so compare with the squared edge lengths.
+        __m256 d0LengthSqr = _mm256_mul_ps(d0x, d0x);
+        d0LengthSqr = _mm256_fmadd_ps(d0y, d0y, d0LengthSqr);
+        d0LengthSqr = _mm256_fmadd_ps(d0z, d0z, d0LengthSqr);
+        __m256 d1LengthSqr = _mm256_mul_ps(d1x, d1x);
+        d1LengthSqr = _mm256_fmadd_ps(d1y, d1y, d1LengthSqr);
+        d1LengthSqr = _mm256_fmadd_ps(d1z, d1z, d1LengthSqr);
+        const __m256 minLengthSqr = _mm256_mul_ps(_mm256_mul_ps(d0LengthSqr, d1LengthSqr), _mm256_set1_ps(1e-10f));
+        const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(lengthSqr, minLengthSqr, _CMP_GT_OQ), _mm256_cmp_ps(lengthSqr, _mm256_setzero_ps(), _CMP_GT_OQ));
+        const __m256 invLength = _mm256_and_ps(RSqrt(lengthSqr), valid);
+
+        nx = _mm256_mul_ps(nx, invLength);
+        ny = _mm256_mul_ps(ny, invLength);
+        nz = _mm256_mul_ps(nz, invLength);
+
+        __m256 offset = _mm256_mul_ps(nx, ax);
+        offset = _mm256_fmadd_ps(ny, ay, offset);
+        offset = _mm256_fmadd_ps(nz, az, offset);
+
+        Transpose4x4x2(nx, ny, nz, offset);
+
+        const __m256 p[4] = { nx, ny, nz, offset };
+
+        for (int k = 0; k < count; k++) {
+            _mm_storeu_ps(planes[i + k].Ptr(), k < 4 ? _mm256_castps256_ps128(p[k]) : _mm256_extractf128_ps(p[k - 4], 1));
+        }
+    }
+
+    _mm256_zeroupper();
+}
+
 BE_NAMESPACE_END
 
 #endif // defined(__X86__)
@@ -244,6 +244,75 @@ void BE_FASTCALL SIMD_Generic::TransformVerts(VertexGenericLit *verts, const int
     }
 }
 
+// Blends the skinning matrices of the joints influencing a vertex.
+static BE_INLINE void BlendSkinningMatrix(float *mat, const Mat3x4 *joints, const byte *jointIndexes, const JointWeightType *jointWeights, int numWeights) {
+    for (int k = 0; k < 12; k++) {
+        mat[k] = 0.0f;
+    }
+
+    for (int j = 0; j < numWeights; j++) {
+        if (!jointWeights[j]) {
+            continue;
+        }
+
+        const float w = JOINT_WEIGHT_TO_FLOAT(jointWeights[j]);
+        const float *jointMat = joints[jointIndexes[j]].Ptr();
+
+        for (int k = 0; k < 12; k++) {
+            mat[k] += jointMat[k] * w;
+        }
+    }
+}
+
+// Skins the position, normal and tangent of the vertices with the linear blend skinning.
+// vertWeights is the array of VertexWeight1, VertexWeight4 or VertexWeight8 by maxVertWeights.
+// The bitangent sign and the other attributes are copied from the source vertices.
+void BE_FASTCALL SIMD_Generic::SkinVerts(VertexGenericLit *dstVerts, const VertexGenericLit *srcVerts, const int numVerts, const Mat3x4 *joints, const void *vertWeights, const int maxVertWeights) {
+    float mat[12];
+
+    for (int i = 0; i < numVerts; i++) {
+        const float *m;
+
+        if (maxVertWeights == 1) {
+            m = joints[((const VertexWeight1 *)vertWeights)[i].jointIndex].Ptr();
+        } else if (maxVertWeights <= 4) {
+            const VertexWeight4 *vw = &((const VertexWeight4 *)vertWeights)[i];
+            BlendSkinningMatrix(mat, joints, vw->jointIndexes, vw->jointWeights, 4);
+            m = mat;
+        } else {
+            const VertexWeight8 *vw = &((const VertexWeight8 *)vertWeights)[i];
+            BlendSkinningMatrix(mat, joints, vw->jointIndexes, vw->jointWeights, 8);
+            m = mat;
+        }
+
+        // Build the vertex locally and write it at once, the destination might be a mapped buffer
+        VertexGenericLit v = srcVerts[i];
+
+        const Vec3 p = srcVerts[i].xyz;
+        v.xyz.x = m[0] * p.x + m[1] * p.y + m[2] * p.z + m[3];
+        v.xyz.y = m[4] * p.x + m[5] * p.y + m[6] * p.z + m[7];
+        v.xyz.z = m[8] * p.x + m[9] * p.y + m[10] * p.z + m[11];
+
+        const Vec3 n = srcVerts[i].GetNormalRaw();
+        Vec3 skinnedNormal(
+            m[0] * n.x + m[1] * n.y + m[2] * n.z,
+            m[4] * n.x + m[5] * n.y + m[6] * n.z,
+            m[8] * n.x + m[9] * n.y + m[10] * n.z);
+        skinnedNormal.Normalize();
+        v.SetNormal(skinnedNormal);
+
+        const Vec3 t = srcVerts[i].GetTangentRaw();
+        Vec3 skinnedTangent(
+            m[0] * t.x + m[1] * t.y + m[2] * t.z,
+            m[4] * t.x + m[5] * t.y + m[6] * t.z,
+            m[8] * t.x + m[9] * t.y + m[10] * t.z);
+        skinnedTangent.Normalize();
+        v.SetTangent(skinnedTangent);
+
+        dstVerts[i] = v;
+    }
+}
+
 void BE_FASTCALL SIMD_Generic::DeriveTriPlanes(Plane *planes, const VertexGenericLit *verts, const int numVerts, const int *indexes, const int numIndexes) {
     for (int i = 0; i < numIndexes; i += 3) {
         const VertexGenericLit *a, *b, *c;
@@ -14,6 +14,7 @@
 
 #include "Precompiled.h"
 #include "Math/Math.h"
+#include "Core/Vertex.h"
 #include "Core/JointPose.h"
 #include "Simd/Simd.h"
 #include "Simd/Simd_Generic.h"
@@ -696,6 +697,536 @@ void BE_FASTCALL SIMD_SSE4::Memset(void *dest0, const int val, const int count0)
 
 #endif
 
+//-------------------------------------------------------------
+// Joint and skinning kernels
+//-------------------------------------------------------------
+
+// Loads x, y, z without reading past the third float. w is set to zero.
+static BE_FORCE_INLINE ssef LoadVec3(const float *src) {
+    return _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double *)src)), _mm_load_ss(src + 2));
+}
+
+// Stores x, y, z of v.
+static BE_FORCE_INLINE void StoreVec3(float *dst, const ssef &v) {
+    _mm_storel_pi((__m64 *)dst, v);
+    _mm_store_ss(dst + 2, shuffle<2, 2, 2, 2>(v));
+}
+
+// Loads the 2 floats at src into x, y. z, w are set to zero.
+static BE_FORCE_INLINE ssef LoadVec2(const float *src) {
+    return _mm_castpd_ps(_mm_load_sd((const double *)src));
+}
+
+// dst = a * b for the row major 3x4 matrices (same as Mat3x4::operator*).
+// dst can be the same as a or b.
+static BE_FORCE_INLINE void MultiplyMat3x4(float *dst, const float *a, const float *b) {
+    const ssef maskW(_mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0)));
+
+    const ssef a0(a);
+    const ssef a1(a + 4);
+    const ssef a2(a + 8);
+
+    const ssef b0(b);
+    const ssef b1(b + 4);
+    const ssef b2(b + 8);
+
+    const ssef r0 = shuffle<0, 0, 0, 0>(a0) * b0 + shuffle<1, 1, 1, 1>(a0) * b1 + shuffle<2, 2, 2, 2>(a0) * b2 + ssef(_mm_and_ps(a0, maskW));
+    const ssef r1 = shuffle<0, 0, 0, 0>(a1) * b0 + shuffle<1, 1, 1, 1>(a1) * b1 + shuffle<2, 2, 2, 2>(a1) * b2 + ssef(_mm_and_ps(a1, maskW));
+    const ssef r2 = shuffle<0, 0, 0, 0>(a2) * b0 + shuffle<1, 1, 1, 1>(a2) * b1 + shuffle<2, 2, 2, 2>(a2) * b2 + ssef(_mm_and_ps(a2, maskW));
+
+    _mm_storeu_ps(dst, r0);
+    _mm_storeu_ps(dst + 4, r1);
+    _mm_storeu_ps(dst + 8, r2);
+}
+
+// Math::Sin16() for angles in range [0, pi/2].
+static BE_FORCE_INLINE ssef Sin16(const ssef &a) {
+    const ssef s = a * a;
+    return a * (((((-2.39e-08f * s + 2.7526e-06f) * s - 1.98409e-04f) * s + 8.3333315e-03f) * s - 1.666666664e-01f) * s + 1.0f);
+}
+
+// Math::ATan16(y, x) for non-negative x and y.
+static BE_FORCE_INLINE ssef ATan16(const ssef &y, const ssef &x) {
+    const sseb swap = y > x;
+    const ssef a = select(swap, x, y) / select(swap, y, x);
+    const ssef s = a * a;
+    const ssef r = (((((((((0.0028662257f * s - 0.0161657367f) * s + 0.0429096138f) * s - 0.0752896400f)
+        * s + 0.1065626393f) * s - 0.1420889944f) * s + 0.1999355085f) * s - 0.3333314528f) * s) + 1.0f) * a;
+    return select(swap, ssef(Math::HalfPi) - r, r);
+}
+
+// Computes the interpolation factors of 4 quaternion pairs like Quat::SetFromSlerp() does.
+// t should be in range (0, 1).
+static BE_FORCE_INLINE void SlerpFactors(const ssef &cosom, const ssef &t, ssef &scale0, ssef &scale1) {
+    const sseb flip = cosom < ssef(0.0f);
+    const ssef absCosom = abs(cosom);
+    const ssef oneMinusT = ssef(1.0f) - t;
+
+    const ssef sinSqr = ssef(1.0f) - absCosom * absCosom;
+    const ssef invSinom = rsqrt_nr(sinSqr);
+    const ssef omega = ATan16(sinSqr * invSinom, absCosom);
+
+    // Quaternions which are very close are linearly interpolated.
+    const sseb nearby = (ssef(1.0f) - absCosom) <= ssef(1e-6f);
+    scale0 = select(nearby, oneMinusT, Sin16(oneMinusT * omega) * invSinom);
+    scale1 = select(nearby, t, Sin16(t * omega) * invSinom);
+
+    // Adjust signs to take the shortest path.
+    scale1 = select(flip, -scale1, scale1);
+}
+
+// Quaternion product a * b of 4 quaternions in SoA form.
+static BE_FORCE_INLINE void MultiplyQuats(const ssef &ax, const ssef &ay, const ssef &az, const ssef &aw,
+    const ssef &bx, const ssef &by, const ssef &bz, const ssef &bw, ssef &x, ssef &y, ssef &z, ssef &w) {
+    // The outputs can be the same as the inputs.
+    const ssef rx = aw * bx + ax * bw + ay * bz - az * by;
+    const ssef ry = aw * by + ay * bw + az * bx - ax * bz;
+    const ssef rz = aw * bz + az * bw + ax * by - ay * bx;
+    const ssef rw = aw * bw - ax * bx - ay * by - az * bz;
+    x = rx;
+    y = ry;
+    z = rz;
+    w = rw;
+}
+
+void BE_FASTCALL SIMD_SSE4::DecompressJoints(JointPose *joints, const CompressedJointPose *compressedJoints, const int *index, const int numJoints) {
+    const ssef quatScale(1.0f / 32767.0f);
+    const ssef translationScale(1.0f / (32767.0f / CompressedJointPose::MaxBoneTranslation));
+    const ssef scaleScale(1.0f / (32767.0f / CompressedJointPose::MaxBoneScale));
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        const CompressedJointPose *compressedJoint = &compressedJoints[j];
+
+        // Load 4 shorts at once and sign extend them to ints.
+        // The last load starts at t[2] not to read past the end of the compressed joint.
+        __m128i q16 = _mm_loadl_epi64((const __m128i *)compressedJoint->q); // q0, q1, q2, t0
+        __m128i t16 = _mm_loadl_epi64((const __m128i *)compressedJoint->t); // t0, t1, t2, s0
+        __m128i s16 = _mm_loadl_epi64((const __m128i *)(compressedJoint->t + 2)); // t2, s0, s1, s2
+
+        ssef q = ssef(_mm_srai_epi32(_mm_unpacklo_epi16(q16, q16), 16)) * quatScale;
+        ssef t = ssef(_mm_srai_epi32(_mm_unpacklo_epi16(t16, t16), 16)) * translationScale;
+        ssef s = ssef(_mm_srai_epi32(_mm_unpacklo_epi16(s16, s16), 16)) * scaleScale;
+
+        // w = sqrt(|1 - (x * x + y * y + z * z)|)
+        ssef qq = q * q;
+        ssef w = sqrt(abs(ssef(1.0f) - (qq + shuffle<1, 1, 1, 1>(qq) + shuffle<2, 2, 2, 2>(qq))));
+        q = insert<3, 0>(q, w);
+
+        // t0, t1, t2, s0
+        ssef ts = shuffle<0, 1, 2, 1>(s);
+        ts = _mm_blend_ps(t, ts, 0x8);
+
+        float *dst = joints[j].q.Ptr();
+        _mm_storeu_ps(dst, q);
+        _mm_storeu_ps(dst + 4, ts);
+        // s1, s2
+        _mm_storel_pi((__m64 *)(dst + 8), shuffle<2, 3, 2, 3>(s));
+    }
+}
+
+// Blends 4 joints at a time in SoA form.
+// The last group is padded with the last joint. The padded lanes write the same results to the same joint.
+template <bool Additive, bool Fast>
+static BE_FORCE_INLINE void BlendJointQuats(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    const ssef t(fraction);
+
+    for (int i = 0; i < numJoints; i += 4) {
+        const int j0 = index[i];
+        const int j1 = index[Min(i + 1, numJoints - 1)];
+        const int j2 = index[Min(i + 2, numJoints - 1)];
+        const int j3 = index[Min(i + 3, numJoints - 1)];
+
+        ssef x, y, z, w;
+        transpose(ssef(joints[j0].q.Ptr()), ssef(joints[j1].q.Ptr()), ssef(joints[j2].q.Ptr()), ssef(joints[j3].q.Ptr()), x, y, z, w);
+
+        ssef bx, by, bz, bw;
+        transpose(ssef(blendJoints[j0].q.Ptr()), ssef(blendJoints[j1].q.Ptr()), ssef(blendJoints[j2].q.Ptr()), ssef(blendJoints[j3].q.Ptr()), bx, by, bz, bw);
+
+        if (Additive) {
+            MultiplyQuats(bx, by, bz, bw, x, y, z, w, bx, by, bz, bw);
+        }
+
+        const ssef cosom = x * bx + y * by + z * bz + w * bw;
+
+        ssef scale0, scale1;
+        if (Fast) {
+            scale0 = ssef(1.0f) - t;
+            scale1 = select(cosom < ssef(0.0f), -t, t);
+        } else {
+            SlerpFactors(cosom, t, scale0, scale1);
+        }
+
+        x = scale0 * x + scale1 * bx;
+        y = scale0 * y + scale1 * by;
+        z = scale0 * z + scale1 * bz;
+        w = scale0 * w + scale1 * bw;
+
+        if (Fast) {
+            const ssef invLength = rsqrt_nr(x * x + y * y + z * z + w * w);
+            x *= invLength;
+            y *= invLength;
+            z *= invLength;
+            w *= invLength;
+        }
+
+        ssef q0, q1, q2, q3;
+        transpose(x, y, z, w, q0, q1, q2, q3);
+
+        _mm_storeu_ps(joints[j0].q.Ptr(), q0);
+        _mm_storeu_ps(joints[j1].q.Ptr(), q1);
+        _mm_storeu_ps(joints[j2].q.Ptr(), q2);
+        _mm_storeu_ps(joints[j3].q.Ptr(), q3);
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::BlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction <= 0.0f) {
+        return;
+    }
+
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j] = blendJoints[j];
+        }
+        return;
+    }
+
+    BlendJointQuats<false, false>(joints, blendJoints, fraction, index, numJoints);
+
+    const ssef t(fraction);
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        // tx, ty, tz, sx and sy, sz
+        float *dst = joints[j].t.Ptr();
+        const float *src = blendJoints[j].t.Ptr();
+
+        ssef ts(dst);
+        ssef ss = LoadVec2(dst + 4);
+
+        ts = ts + t * (ssef(src) - ts);
+        ss = ss + t * (LoadVec2(src + 4) - ss);
+
+        _mm_storeu_ps(dst, ts);
+        _mm_storel_pi((__m64 *)(dst + 4), ss);
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::BlendJointsFast(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction <= 0.0f) {
+        return;
+    }
+
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j] = blendJoints[j];
+        }
+        return;
+    }
+
+    BlendJointQuats<false, true>(joints, blendJoints, fraction, index, numJoints);
+
+    const ssef t(fraction);
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        float *dst = joints[j].t.Ptr();
+        const float *src = blendJoints[j].t.Ptr();
+
+        ssef ts(dst);
+        ssef ss = LoadVec2(dst + 4);
+
+        ts = ts + t * (ssef(src) - ts);
+        ss = ss + t * (LoadVec2(src + 4) - ss);
+
+        _mm_storeu_ps(dst, ts);
+        _mm_storel_pi((__m64 *)(dst + 4), ss);
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::AdditiveBlendJoints(JointPose *joints, const JointPose *blendJoints, const float fraction, const int *index, const int numJoints) {
+    if (fraction >= 1.0f) {
+        for (int i = 0; i < numJoints; i++) {
+            int j = index[i];
+            joints[j].q = blendJoints[j].q * joints[j].q;
+        }
+    } else if (fraction > 0.0f) {
+        BlendJointQuats<true, false>(joints, blendJoints, fraction, index, numJoints);
+    }
+
+    const ssef t(fraction);
+
+    for (int i = 0; i < numJoints; i++) {
+        int j = index[i];
+
+        float *dst = joints[j].t.Ptr();
+        const float *src = blendJoints[j].t.Ptr();
+
+        // t += blend.t * fraction, s *= blend.s * fraction
+        ssef ts(dst);
+        ssef ss = LoadVec2(dst + 4);
+        ssef bts = ssef(src) * t;
+
+        ts = _mm_blend_ps(ts + bts, ts * bts, 0x8);
+        ss = ss * (LoadVec2(src + 4) * t);
+
+        _mm_storeu_ps(dst, ts);
+        _mm_storel_pi((__m64 *)(dst + 4), ss);
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::ConvertJointPosesToJointMats(Mat3x4 *jointMats, const JointPose *jointPoses, const int numJoints) {
+    // Converts 4 joints at a time in SoA form.
+    // The last group is padded with the last joint.
+    for (int i = 0; i < numJoints; i += 4) {
+        const JointPose *p0 = &jointPoses[i];
+        const JointPose *p1 = &jointPoses[Min(i + 1, numJoints - 1)];
+        const JointPose *p2 = &jointPoses[Min(i + 2, numJoints - 1)];
+        const JointPose *p3 = &jointPoses[Min(i + 3, numJoints - 1)];
+
+        ssef x, y, z, w;
+        transpose(ssef(p0->q.Ptr()), ssef(p1->q.Ptr()), ssef(p2->q.Ptr()), ssef(p3->q.Ptr()), x, y, z, w);
+
+        // tx, ty, tz, sx
+        ssef tx, ty, tz, sx;
+        transpose(ssef(p0->t.Ptr()), ssef(p1->t.Ptr()), ssef(p2->t.Ptr()), ssef(p3->t.Ptr()), tx, ty, tz, sx);
+
+        // sy, sz
+        ssef s01 = unpacklo(LoadVec2(&p0->s.y), LoadVec2(&p1->s.y));
+        ssef s23 = unpacklo(LoadVec2(&p2->s.y), LoadVec2(&p3->s.y));
+        ssef sy = _mm_movelh_ps(s01, s23);
+        ssef sz = _mm_movehl_ps(s23, s01);
+
+        const ssef x2 = x + x;
+        const ssef y2 = y + y;
+        const ssef z2 = z + z;
+
+        const ssef xx2 = x * x2;
+        const ssef xy2 = x * y2;
+        const ssef xz2 = x * z2;
+        const ssef yy2 = y * y2;
+        const ssef yz2 = y * z2;
+        const ssef zz2 = z * z2;
+        const ssef wx2 = w * x2;
+        const ssef wy2 = w * y2;
+        const ssef wz2 = w * z2;
+
+        const ssef one(1.0f);
+
+        ssef r0, r1, r2, r3;
+        transpose((one - yy2 - zz2) * sx, (xy2 - wz2) * sy, (xz2 + wy2) * sz, tx, r0, r1, r2, r3);
+        _mm_storeu_ps(jointMats[i].Ptr(), r0);
+        _mm_storeu_ps(jointMats[Min(i + 1, numJoints - 1)].Ptr(), r1);
+        _mm_storeu_ps(jointMats[Min(i + 2, numJoints - 1)].Ptr(), r2);
+        _mm_storeu_ps(jointMats[Min(i + 3, numJoints - 1)].Ptr(), r3);
+
+        transpose((xy2 + wz2) * sx, (one - xx2 - zz2) * sy, (yz2 - wx2) * sz, ty, r0, r1, r2, r3);
+        _mm_storeu_ps(jointMats[i].Ptr() + 4, r0);
+        _mm_storeu_ps(jointMats[Min(i + 1, numJoints - 1)].Ptr() + 4, r1);
+        _mm_storeu_ps(jointMats[Min(i + 2, numJoints - 1)].Ptr() + 4, r2);
+        _mm_storeu_ps(jointMats[Min(i + 3, numJoints - 1)].Ptr() + 4, r3);
+
+        transpose((xz2 - wy2) * sx, (yz2 + wx2) * sy, (one - xx2 - yy2) * sz, tz, r0, r1, r2, r3);
+        _mm_storeu_ps(jointMats[i].Ptr() + 8, r0);
+        _mm_storeu_ps(jointMats[Min(i + 1, numJoints - 1)].Ptr() + 8, r1);
+        _mm_storeu_ps(jointMats[Min(i + 2, numJoints - 1)].Ptr() + 8, r2);
+        _mm_storeu_ps(jointMats[Min(i + 3, numJoints - 1)].Ptr() + 8, r3);
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::TransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint) {
+    for (int i = firstJoint; i <= lastJoint; i++) {
+        assert(parents[i] < i);
+        if (parents[i] >= 0) {
+            // jointMats[i] = jointMats[parents[i]] * jointMats[i]
+            MultiplyMat3x4(jointMats[i].Ptr(), jointMats[parents[i]].Ptr(), jointMats[i].Ptr());
+        }
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints) {
+    for (int i = 0; i < numJoints; i++) {
+        MultiplyMat3x4(result[i].Ptr(), joints1[i].Ptr(), joints2[i].Ptr());
+    }
+}
+
+void BE_FASTCALL SIMD_SSE4::TransformVerts(VertexGenericLit *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *base, const int *index, const int numWeights) {
+    const byte *jointsPtr = (const byte *)joints;
+
+    for (int i = 0, j = 0; i < numVerts; i++) {
+        // Accumulate the products of the matrix rows and the weighted vertex,
+        // the horizontal sums are done once per vertex.
+        const float *mat = (const float *)(jointsPtr + index[j * 2 + 0]);
+        ssef v(base[j].Ptr());
+
+        ssef x = ssef(mat) * v;
+        ssef y = ssef(mat + 4) * v;
+        ssef z = ssef(mat + 8) * v;
+
+        while (index[j * 2 + 1] == 0) {
+            j++;
+            mat = (const float *)(jointsPtr + index[j * 2 + 0]);
+            v = ssef(base[j].Ptr());
+
+            x += ssef(mat) * v;
+            y += ssef(mat + 4) * v;
+            z += ssef(mat + 8) * v;
+        }
+
+        j++;
+
+        ssef c0, c1, c2, c3;
+        transpose(x, y, z, ssef(_mm_setzero_ps()), c0, c1, c2, c3);
+
+        StoreVec3(verts[i].xyz.Ptr(), (c0 + c1) + (c2 + c3));
+    }
+}
+
+// Blends the skinning matrix rows of the joints influencing a vertex.
+static BE_FORCE_INLINE void BlendSkinningRows(const Mat3x4 *joints, const byte *jointIndexes, const JointWeightType *jointWeights, const int numWeights, ssef &r0, ssef &r1, ssef &r2) {
+    r0 = ssef(_mm_setzero_ps());
+    r1 = r0;
+    r2 = r0;
+
+    for (int j = 0; j < numWeights; j++) {
+        if (!jointWeights[j]) {
+            continue;
+        }
+
+        const ssef w(JOINT_WEIGHT_TO_FLOAT(jointWeights[j]));
+        const float *mat = joints[jointIndexes[j]].Ptr();
+
+        r0 += ssef(mat) * w;
+        r1 += ssef(mat + 4) * w;
+        r2 += ssef(mat + 8) * w;
+    }
+}
+
+// Unpacks the signed normalized bytes of a normal or tangent. w is undefined.
+static BE_FORCE_INLINE ssef UnpackNormalBytes(const byte *src) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i b = _mm_cvtsi32_si128(*(const int *)src);
+    const __m128i i = _mm_unpacklo_epi16(_mm_unpacklo_epi8(b, zero), zero);
+    return ssef(_mm_cvtepi32_ps(i)) * ssef(2.0f / 255.0f) - ssef(1.0f);
+}
+
+// Normalizes x, y, z of v and packs them to signed normalized bytes.
+// The fourth byte is taken from w4.
+static BE_FORCE_INLINE uint32_t PackNormalBytes(const ssef &v, const uint32_t w4) {
+    const ssef lengthSqr = vreduce_add(v * v);
+    const ssef n = v * rsqrt_nr(vmax(lengthSqr, ssef(FLT_MIN)));
+    const __m128i i = _mm_cvttps_epi32(n * ssef(255.0f / 2.0f) + ssef(255.0f / 2.0f + 0.5f));
+    const __m128i b = _mm_packus_epi16(_mm_packs_epi32(i, i), _mm_setzero_si128());
+    return ((uint32_t)_mm_cvtsi128_si32(b) & 0x00ffffff) | (w4 & 0xff000000);
+}
+
+void BE_FASTCALL SIMD_SSE4::SkinVerts(VertexGenericLit *dstVerts, const VertexGenericLit *srcVerts, const int numVerts, const Mat3x4 *joints, const void *vertWeights, const int maxVertWeights) {
+#ifdef COMPRESSED_VERTEX_NORMAL_TANGENTS
+    for (int i = 0; i < numVerts; i++) {
+        ssef r0, r1, r2;
+
+        if (maxVertWeights == 1) {
+            const float *mat = joints[((const VertexWeight1 *)vertWeights)[i].jointIndex].Ptr();
+            r0 = ssef(mat);
+            r1 = ssef(mat + 4);
+            r2 = ssef(mat + 8);
+        } else if (maxVertWeights <= 4) {
+            const VertexWeight4 *vw = &((const VertexWeight4 *)vertWeights)[i];
+            BlendSkinningRows(joints, vw->jointIndexes, vw->jointWeights, 4, r0, r1, r2);
+        } else {
+            const VertexWeight8 *vw = &((const VertexWeight8 *)vertWeights)[i];
+            BlendSkinningRows(joints, vw->jointIndexes, vw->jointWeights, 8, r0, r1, r2);
+        }
+
+        // Columns of the blended matrix, c3 is the translation.
+        // Position, normal and tangent are transformed with the same columns.
+        ssef c0, c1, c2, c3;
+        transpose(r0, r1, r2, ssef(_mm_setzero_ps()), c0, c1, c2, c3);
+
+        const VertexGenericLit &src = srcVerts[i];
+
+        const ssef p = LoadVec3(src.xyz.Ptr());
+        const ssef n = UnpackNormalBytes(src.normal);
+        const ssef t = UnpackNormalBytes(src.tangent);
+
+        const ssef skinnedPosition = c0 * shuffle<0, 0, 0, 0>(p) + c1 * shuffle<1, 1, 1, 1>(p) + c2 * shuffle<2, 2, 2, 2>(p) + c3;
+        const ssef skinnedNormal = c0 * shuffle<0, 0, 0, 0>(n) + c1 * shuffle<1, 1, 1, 1>(n) + c2 * shuffle<2, 2, 2, 2>(n);
+        const ssef skinnedTangent = c0 * shuffle<0, 0, 0, 0>(t) + c1 * shuffle<1, 1, 1, 1>(t) + c2 * shuffle<2, 2, 2, 2>(t);
+
+        // Build the vertex locally and write it at once, the destination might be a mapped buffer
+        VertexGenericLit v = src;
+        StoreVec3(v.xyz.Ptr(), skinnedPosition);
+        *(uint32_t *)v.normal = PackNormalBytes(skinnedNormal, *(const uint32_t *)src.normal);
+        *(uint32_t *)v.tangent = PackNormalBytes(skinnedTangent, *(const uint32_t *)src.tangent);
+
+        dstVerts[i] = v;
+    }
+#else
+    SIMD_Generic::SkinVerts(dstVerts, srcVerts, numVerts, joints, vertWeights, maxVertWeights);
+#endif
+}
+
+void BE_FASTCALL SIMD_SSE4::DeriveTriPlanes(Plane *planes, const VertexGenericLit *verts, const int numVerts, const int *indexes, const int numIndexes) {
+    const int numTris = numIndexes / 3;
+
+    // Derives 4 planes at a time in SoA form.
+    // The last group is padded with the last triangle.
+    for (int i = 0; i < numTris; i += 4) {
+        const int count = Min(numTris - i, 4);
+
+        ssef a[4], b[4], c[4];
+        for (int k = 0; k < 4; k++) {
+            const int *triIndexes = &indexes[(i + Min(k, count - 1)) * 3];
+            // The vertex is bigger than 16 bytes, so the fourth float is safe to read.
+            a[k] = ssef(verts[triIndexes[0]].xyz.Ptr());
+            b[k] = ssef(verts[triIndexes[1]].xyz.Ptr());
+            c[k] = ssef(verts[triIndexes[2]].xyz.Ptr());
+        }
+
+        ssef ax, ay, az;
+        ssef bx, by, bz;
+        ssef cx, cy, cz;
+        transpose(a[0], a[1], a[2], a[3], ax, ay, az);
+        transpose(b[0], b[1], b[2], b[3], bx, by, bz);
+        transpose(c[0], c[1], c[2], c[3], cx, cy, cz);
+
+        const ssef d0x = bx - ax;
+        const ssef d0y = by - ay;
+        const ssef d0z = bz - az;
+
+        const ssef d1x = cx - ax;
+        const ssef d1y = cy - ay;
+        const ssef d1z = cz - az;
+
+        ssef nx = d1y * d0z - d1z * d0y;
+        ssef ny = d1z * d0x - d1x * d0z;
+        ssef nz = d1x * d0y - d1y * d0x;
+
+        // Degenerated triangles get zero normal.
+        const ssef lengthSqr = nx * nx + ny * ny + nz * nz;
+        const ssef invLength = select(lengthSqr > ssef(0.0f), rsqrt_nr(lengthSqr), ssef(0.0f));
+
+        nx *= invLength;
+        ny *= invLength;
+        nz *= invLength;
+
+        const ssef offset = nx * ax + ny * ay + nz * az;
+
+        ssef p[4];
+        transpose(nx, ny, nz, offset, p[0], p[1], p[2], p[3]);
+
+        for (int k = 0; k < count; k++) {
+            _mm_storeu_ps(planes[i + k].Ptr(), p[k]);
+        }
+    }
+}
+
 BE_NAMESPACE_END
 
 #endif // #if defined(__X86__)
@@ -143,6 +143,7 @@ void MeshCombiner::MakeCombinedMesh(Entity *staticBatchRoot, Array<ComStaticMesh
     for (int i = 0; i < meshRenderers.Count(); i++) {
         ComStaticMeshRenderer *batchMesh = meshRenderers[i];
         batchMesh->staticBatchIndex = staticBatch->GetIndex();
+        staticBatch->AddRenderable(batchMesh);
 
         BatchSubMesh batchSubMesh;
         batchSubMesh.subMesh = batchMesh->referenceMesh->GetSurface(0)->subMesh;
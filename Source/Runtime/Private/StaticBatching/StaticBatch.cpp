@@ -79,6 +79,36 @@ void StaticBatch::ClearAllStaticBatches() {
     staticBatches.DeleteContents(false);
 }
 
+Entity *StaticBatch::IntersectRay(const Ray &ray, bool backFaceCull, int layerMask, const Array<Entity *> &excludingEntities, float &lastDist) const {
+    Entity *minEntity = nullptr;
+    float dist;
+
+    for (int i = 0; i < renderables.Count(); i++) {
+        const ComRenderable *renderable = renderables[i];
+
+        if (!renderable->IsActiveInHierarchy()) {
+            continue;
+        }
+
+        Entity *entity = renderable->GetEntity();
+
+        if (!(BIT(entity->GetLayer()) & layerMask)) {
+            continue;
+        }
+
+        if (excludingEntities.Find(entity)) {
+            continue;
+        }
+
+        if (renderable->IntersectRay(ray, backFaceCull, &dist) && dist < lastDist) {
+            lastDist = dist;
+            minEntity = entity;
+        }
+    }
+
+    return minEntity;
+}
+
 StaticBatch *StaticBatch::GetStaticBatchByIndex(int index) {
     if (index < 0 || index >= staticBatches.Count()) {
         return nullptr;
@@ -96,7 +96,7 @@ public:
     int                     GetDuration(const Animator *animator) const;
 
                             // 모든 서브 노드들을 blending 해서 masked joint pose 계산
-    void                    GetFrame(const Animator *animator, float normalizedTime, int numJoints, JointPose *outJointPose) const;
+    void                    GetFrame(const Animator *animator, float normalizedTime, int numMaskJoints, const int *maskJoints, int numJoints, JointPose *outJointPose) const;
 
                             // 모든 서브 노드들을 blending 해서 translation 계산
     void                    GetTranslation(const Animator *animator, float normalizedTime, Vec3 &outTranslation) const;
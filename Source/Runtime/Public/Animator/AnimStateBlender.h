@@ -65,7 +65,7 @@ public:
     void                    CallEvents(Entity *entity, int fromTime, int toTime);
 
                             // blendedFrame 에 current time 의 frame 을 blend 한다.
-    bool                    BlendFrame(int currentTime, int numJoints, JointPose *blendedFrame, float &blendedWeight) const;
+    bool                    BlendFrame(int currentTime, int numMaskJoints, const int *maskJoints, int numJoints, JointPose *blendedFrame, float &blendedWeight) const;
                             // blendedTranslation 에 current time 의 translation 을 blend 한다.
     bool                    BlendTranslation(int currentTime, Vec3 &blendedTranslation, float &blendedWeight) const;
                             // blendedTranslationDelta 에 current time 의 translation delta 를 blend 한다.
@@ -43,12 +43,12 @@
 */
 
 #include "Math/Math.h"
+#include "Core/Str.h"
 #include "Containers/Array.h"
 #include "AnimStateBlender.h"
 
 BE_NAMESPACE_BEGIN
 
-class Str;
 class AnimController;
 class AnimLayer;
 class Mesh;
@@ -112,6 +112,15 @@ public:
                             // 모든 blending 을 계산한 current time 의 joint matrices 를 만든다 
     void                    ComputeFrame(int currentTime);
 
+                            /// Sets the reduced joint set for the animation LOD with the same syntax as the layer joint masks.
+                            /// Empty string means all joints.
+    void                    SetLodJointMask(const char *jointNames);
+                            /// Returns true if ComputeFrame() evaluates only the joints in LOD joint mask
+    bool                    IsLodJointMaskEnabled() const { return lodJointMaskEnabled; }
+                            /// Enables/disables evaluating only the joints in LOD joint mask.
+                            /// The other joints are set to the bind pose.
+    void                    EnableLodJointMask(bool enable) { lodJointMaskEnabled = enable; }
+
                             // ComputeFrame() 결과 행렬들을 리턴
     Mat3x4 *                GetFrame() const { return jointMats; }
 
@@ -135,6 +144,8 @@ public:
 private:
     void                    PushStateBlenders(int layerNum, int currentTime, int blendDuration);
     void                    FreeData();
+    void                    BuildLodMaskJoints();
+    const Array<int> &      GetLayerMaskJoints(int layerNum) const;
 
     AnimController *        animController;
     Array<AnimAABB>         animAABBs;
@@ -146,6 +157,10 @@ private:
     
     bool                    ignoreRootTranslation;
 
+    Str                     lodJointMask;           // joint names for the reduced joint set
+    bool                    lodJointMaskEnabled;
+    Array<int>              lodMaskJoints[MaxLayers];   // layer mask joints intersected with lodJointMask
+
     Array<float>            parameters;
     AnimStateBlender        layerAnimStateBlenders[MaxLayers][MaxBlendersPerLayer];
 };
@@ -88,6 +88,9 @@
 #include "Core/CVars.h"
 #include "Core/Cmds.h"
 #include "Core/Task.h"
+#include "Core/JobSystem.h"
+#include "Core/ScratchAllocator.h"
+#include "Core/RadixSort.h"
 #include "Core/Vertex.h"
 #include "Core/JointPose.h"
 
@@ -25,6 +25,13 @@ class ComAnimator : public Component {
 public:
     OBJECT_PROTOTYPE(ComAnimator);
 
+    struct CullingMode {
+        enum Enum {
+            AlwaysAnimate,          ///< Always computes the frame
+            CullCompletely          ///< Skips computing the frame while the skinned meshes are not visible
+        };
+    };
+
     ComAnimator();
     virtual ~ComAnimator();
 
@@ -41,6 +48,10 @@ public:
 
     void                    UpdateAnim(int time);
 
+                            /// Computes the frame deferred in Update().
+                            /// Called from the job system workers in GameWorld::UpdateAnimators().
+    void                    UpdatePendingAnim(int time);
+
     Vec3                    GetTranslation(int currentTime) const;
     Vec3                    GetTranslationDelta(int fromTime, int toTime) const;
     Mat3                    GetRotationDelta(int fromTime, int toTime) const;
@@ -58,12 +69,30 @@ public:
 
     Mat3x4 *                GetJointMatrices() const { return animator.GetFrame(); }
 
+                            /// Called from the skinned mesh renderers which was visible in the previous frame.
+    void                    NotifyVisible(float screenSize);
+
+    Str                     GetLodJointMask() const;
+    void                    SetLodJointMask(const Str &lodJointMask);
+
 protected:
     void                    ChangeAnimController(const Guid &animControllerGuid);
     void                    AnimControllerReloaded();
+    int                     ComputeUpdateInterval() const;
 
     Animator                animator;
     AnimControllerAsset *   animControllerAsset;
+    bool                    animUpdatePending;      ///< Registered to GameWorld::UpdateAnimators()
+
+    CullingMode::Enum       cullingMode;
+    bool                    useLod;                 ///< Reduces the update rate and the joint set by the screen size
+    float                   lodScreenSize;          ///< Screen size under which the update rate is reduced
+    int                     lodMaxUpdateInterval;   ///< Maximum number of frames between the updates
+    Str                     lodJointMask;           ///< Reduced joint set used while the update rate is reduced
+
+    int                     lodFrameCount;          ///< Starts at the instance ID to stagger the throttled updates
+    int                     visibleTime;            ///< Game time when the skinned meshes were notified to be visible
+    float                   visibleScreenSize;      ///< Maximum screen size of the skinned meshes at visibleTime
 };
 
 BE_INLINE Vec3 ComAnimator::GetTranslation(int currentTime) const {
@@ -73,12 +73,18 @@ public:
 
     bool                    IsVisibleInPreviousFrame() const;
 
+                            /// Returns index of the static batch that this renderer is combined into, -1 if not combined.
+    int                     GetStaticBatchIndex() const { return staticBatchIndex; }
+
 protected:
     virtual void            OnActive() override;
     virtual void            OnInactive() override;
 
     virtual void            UpdateVisuals();
 
+                            /// Tests the ray against the mesh placed with the world matrix of this renderer.
+    bool                    IntersectRayMesh(const Mesh *mesh, const Ray &ray, bool backFaceCull, float *hitDist) const;
+
     void                    LayerChanged(const Entity *entity);
     void                    StaticMaskChanged(const Entity *entity);
     void                    TransformUpdated(const ComTransform *transform);
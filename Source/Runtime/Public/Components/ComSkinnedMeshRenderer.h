@@ -38,6 +38,9 @@ public:
                             /// Called on game world update, variable timestep.
     virtual void            Update() override;
 
+                            /// Ray intersection with the mesh skinned to the current pose.
+    virtual bool            IntersectRay(const Ray &ray, bool backFaceCull, float *hitDist) const override;
+
     Guid                    GetRootGuid() const;
     void                    SetRootGuid(const Guid &rootGuid);
 
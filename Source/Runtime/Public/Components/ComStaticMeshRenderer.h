@@ -36,6 +36,9 @@ public:
                             /// Called on game world update, variable timestep.
     virtual void            Update() override;
 
+                            /// Tests the ray against the mesh of this renderer, not the combined mesh of the static batch.
+    virtual bool            IntersectRay(const Ray &ray, bool backFaceCull, float *hitDist) const override;
+
     bool                    IsOccluder() const;
     void                    SetOccluder(bool occluder);
 
@@ -32,6 +32,10 @@ public:
     ComTransform();
     virtual ~ComTransform();
 
+                            /// Transform components are allocated from the fixed size blocks.
+    static void *           operator new(size_t size);
+    static void             operator delete(void *ptr);
+
                             /// Initializes this component. Called after deserialization.
     virtual void            Init() override;
 
@@ -22,6 +22,7 @@
 -------------------------------------------------------------------------------
 */
 
+#include "Containers/Array.h"
 #include "Containers/Stack.h"
 #include "Math/Math.h"
 
@@ -69,6 +70,13 @@ public:
                     /// Build an optimal tree. Very expensive. For testing.
     void            RebuildBottomUp();
 
+                    /// Rebuild the 4-wide query tree if proxies have been created since the last update.
+                    /// Moved and destroyed proxies are refitted in the query tree without rebuilding.
+                    /// Queries fall back to the binary tree until this is called, so call this before querying from multiple threads.
+    void            UpdateQueryTree();
+
+    bool            IsQueryTreeValid() const { return queryTreeValid; }
+
     template <typename F>
     void            Query(const Sphere &boundingVolume, F &callback) const;
     template <typename F>
@@ -78,7 +86,78 @@ public:
     template <typename F>
     void            Query(const Frustum &boundingVolume, F &callback) const;
 
+                    /// Cast a ray against the fat AABBs of the proxies within maxDist. Nearer nodes are visited first.
+                    /// callback(proxyId, maxDist) returns the new max distance to clip the ray, so returning the hit distance finds the closest hit.
+                    /// Returning maxDist continues without clipping, returning 0 or less terminates the ray cast.
+    template <typename F>
+    void            RayCast(const Ray &ray, float maxDist, F &callback) const;
+
+                    /// Cast multiple rays in one traversal. maxDists are the max distances of each ray and updated with the callback results.
+                    /// callback(rayIndex, proxyId, maxDist) returns the new max distance of the ray in the same way as RayCast().
+    template <typename F>
+    void            RayCastBatch(const Ray *rays, float *maxDists, int count, F &callback) const;
+
+                    /// Query multiple bounding volumes in one traversal.
+                    /// callback(volumeIndex, proxyId) is called for each proxy intersecting with each volume, returning false terminates the query.
+    template <typename BV, typename F>
+    void            QueryBatch(const BV *boundingVolumes, int count, F &callback) const;
+
+                    /// Find the pairs of proxies whose fat AABBs overlap between this tree and the other tree.
+                    /// If the other tree is this tree, each pair of different proxies is reported once.
+                    /// callback(proxyId, otherProxyId) returns false to terminate the query.
+    template <typename F>
+    void            QueryOverlapPairs(const DynamicAABBTree &other, F &callback) const;
+
+                    /// Collects at most maxSubtrees disjoint subtrees intersecting with the bounding volume, in the order that Query() visits them.
+                    /// Querying each subtree with QuerySubtree() in that order reports the same proxies in the same order as Query(),
+                    /// so the subtrees can be traversed in parallel and the results concatenated.
+                    /// Subtrees are taken from the query tree if it is valid, so the tree must not be changed until the subtrees are queried.
+    template <typename BV>
+    void            GetQuerySubtrees(const BV &boundingVolume, int maxSubtrees, Array<int32_t> &subtrees) const;
+
+                    /// Query only in the subtree collected by GetQuerySubtrees().
+    template <typename BV, typename F>
+    void            QuerySubtree(const BV &boundingVolume, int32_t subtreeRoot, F &callback) const;
+
 private:
+    static constexpr int MaxStackDepth = 256;
+
+    using QueryLeafFunc = bool (*)(void *data, int32_t proxyId);
+
+    struct QueryNode;
+
+    void            QueryWide(const Sphere &sphere, int32_t subtreeRoot, QueryLeafFunc func, void *data) const;
+    void            QueryWide(const AABB &aabb, int32_t subtreeRoot, QueryLeafFunc func, void *data) const;
+    void            QueryWide(const OBB &obb, int32_t subtreeRoot, QueryLeafFunc func, void *data) const;
+    void            QueryWide(const Frustum &frustum, int32_t subtreeRoot, QueryLeafFunc func, void *data) const;
+
+    void            GetQuerySubtreesWide(const Sphere &sphere, int maxSubtrees, Array<int32_t> &subtrees) const;
+    void            GetQuerySubtreesWide(const AABB &aabb, int maxSubtrees, Array<int32_t> &subtrees) const;
+    void            GetQuerySubtreesWide(const OBB &obb, int maxSubtrees, Array<int32_t> &subtrees) const;
+    void            GetQuerySubtreesWide(const Frustum &frustum, int maxSubtrees, Array<int32_t> &subtrees) const;
+
+    template <typename Tester>
+    void            TraverseQueryTree(const Tester &tester, int32_t subtreeRoot, QueryLeafFunc func, void *data) const;
+    template <typename Tester>
+    void            CollectQuerySubtrees(const Tester &tester, int maxSubtrees, Array<int32_t> &subtrees) const;
+
+    int32_t         BuildQueryNode(int32_t nodeId, int32_t parentSlot);
+    void            RefitQueryLeaf(int32_t proxyId);
+    void            RemoveQueryLeaf(int32_t proxyId);
+    void            FreeQueryTree();
+
+    static bool     IsIntersectNode(const Sphere &sphere, const AABB &aabb) { return sphere.IsIntersectAABB(aabb); }
+    static bool     IsIntersectNode(const AABB &box, const AABB &aabb) { return box.IsIntersectAABB(aabb); }
+    static bool     IsIntersectNode(const OBB &obb, const AABB &aabb) { return obb.IsIntersectOBB(OBB(aabb)); }
+    static bool     IsIntersectNode(const Frustum &frustum, const AABB &aabb) { return !frustum.CullAABB(aabb); }
+
+                    /// Slab test with the reciprocal of the ray direction. entryDist is clamped to 0 if the origin is inside.
+    static bool     IntersectRayNode(const Vec3 &origin, const Vec3 &invDir, float maxDist, const AABB &aabb, float &entryDist);
+    static Vec3     GetInverseRayDir(const Vec3 &dir);
+
+    template <typename TestFunc, typename LeafFunc>
+    void            TraverseBatch(int count, const TestFunc &testNode, const LeafFunc &reportLeaf) const;
+
     int             AllocNode();
     void            FreeNode(int32_t node);
 
@@ -114,6 +193,14 @@ private:
     int32_t         freeList;
     Node *          nodes;
     int             insertionCount;
+
+    QueryNode *     queryNodes;             ///< 4-wide tree for queries, child bounds are stored as SoA
+    int32_t         queryNodeCount;
+    int32_t         queryNodeCapacity;
+    int32_t *       queryLeafSlots;         ///< Query node index * 4 + child slot of each proxy, indexed by proxy id
+    int32_t         queryLeafSlotCapacity;
+    int32_t         numQueryRefits;         ///< Number of refits since the last rebuild
+    bool            queryTreeValid;
 };
 
 BE_INLINE void *DynamicAABBTree::GetUserData(int32_t proxyId) const {
@@ -135,6 +222,11 @@ BE_INLINE const AABB &DynamicAABBTree::GetRootFatAABB() const {
 
 template <typename F>
 BE_INLINE void DynamicAABBTree::Query(const Sphere &sphere, F &callback) const {
+    if (queryTreeValid) {
+        QueryWide(sphere, 0, [](void *data, int32_t proxyId) -> bool { return (*(F *)data)(proxyId); }, &callback);
+        return;
+    }
+
     Stack<int32_t> stack(256);
     stack.Push(root);
 
@@ -162,6 +254,11 @@ BE_INLINE void DynamicAABBTree::Query(const Sphere &sphere, F &callback) const {
 
 template <typename F>
 BE_INLINE void DynamicAABBTree::Query(const AABB &aabb, F &callback) const {
+    if (queryTreeValid) {
+        QueryWide(aabb, 0, [](void *data, int32_t proxyId) -> bool { return (*(F *)data)(proxyId); }, &callback);
+        return;
+    }
+
     Stack<int32_t> stack(256);
     stack.Push(root);
 
@@ -189,6 +286,11 @@ BE_INLINE void DynamicAABBTree::Query(const AABB &aabb, F &callback) const {
 
 template <typename F>
 BE_INLINE void DynamicAABBTree::Query(const OBB &obb, F &callback) const {
+    if (queryTreeValid) {
+        QueryWide(obb, 0, [](void *data, int32_t proxyId) -> bool { return (*(F *)data)(proxyId); }, &callback);
+        return;
+    }
+
     Stack<int32_t> stack(256);
     stack.Push(root);
 
@@ -216,6 +318,11 @@ BE_INLINE void DynamicAABBTree::Query(const OBB &obb, F &callback) const {
 
 template <typename F>
 BE_INLINE void DynamicAABBTree::Query(const Frustum &frustum, F &callback) const {
+    if (queryTreeValid) {
+        QueryWide(frustum, 0, [](void *data, int32_t proxyId) -> bool { return (*(F *)data)(proxyId); }, &callback);
+        return;
+    }
+
     Stack<int32_t> stack(256);
     stack.Push(root);
 
@@ -241,4 +348,336 @@ BE_INLINE void DynamicAABBTree::Query(const Frustum &frustum, F &callback) const
     }
 }
 
+template <typename BV>
+BE_INLINE void DynamicAABBTree::GetQuerySubtrees(const BV &boundingVolume, int maxSubtrees, Array<int32_t> &subtrees) const {
+    if (queryTreeValid) {
+        GetQuerySubtreesWide(boundingVolume, maxSubtrees, subtrees);
+        return;
+    }
+
+    subtrees.SetCount(0, false);
+
+    if (root == -1 || !IsIntersectNode(boundingVolume, nodes[root].aabb)) {
+        return;
+    }
+
+    subtrees.Append(root);
+
+    Array<int32_t> expanded;
+
+    // Expand internal nodes level by level. Query() pops child2 before child1,
+    // so children replace their parent in that order to keep the visiting order.
+    while (subtrees.Count() < maxSubtrees) {
+        expanded.SetCount(0, false);
+
+        bool hasInternalNode = false;
+
+        for (int i = 0; i < subtrees.Count(); i++) {
+            const Node *node = nodes + subtrees[i];
+
+            if (node->IsLeaf()) {
+                expanded.Append(subtrees[i]);
+                continue;
+            }
+
+            hasInternalNode = true;
+
+            if (node->child2 != -1 && IsIntersectNode(boundingVolume, nodes[node->child2].aabb)) {
+                expanded.Append(node->child2);
+            }
+            if (node->child1 != -1 && IsIntersectNode(boundingVolume, nodes[node->child1].aabb)) {
+                expanded.Append(node->child1);
+            }
+        }
+
+        if (!hasInternalNode || expanded.Count() > maxSubtrees) {
+            break;
+        }
+
+        subtrees.Swap(expanded);
+    }
+}
+
+template <typename BV, typename F>
+BE_INLINE void DynamicAABBTree::QuerySubtree(const BV &boundingVolume, int32_t subtreeRoot, F &callback) const {
+    if (queryTreeValid) {
+        QueryWide(boundingVolume, subtreeRoot, [](void *data, int32_t proxyId) -> bool { return (*(F *)data)(proxyId); }, &callback);
+        return;
+    }
+
+    Stack<int32_t> stack(256);
+    stack.Push(subtreeRoot);
+
+    while (!stack.IsEmpty()) {
+        int32_t nodeId = stack.Pop();
+        if (nodeId == -1) {
+            continue;
+        }
+
+        const Node *node = nodes + nodeId;
+
+        if (IsIntersectNode(boundingVolume, node->aabb)) {
+            if (node->IsLeaf()) {
+                bool proceed = callback(nodeId);
+                if (proceed == false) {
+                    return;
+                }
+            } else {
+                stack.Push(node->child1);
+                stack.Push(node->child2);
+            }
+        }
+    }
+}
+
+BE_INLINE Vec3 DynamicAABBTree::GetInverseRayDir(const Vec3 &dir) {
+    // Avoid 0 * infinity in the slab test for the axis aligned directions.
+    return Vec3(
+        dir.x != 0.0f ? 1.0f / dir.x : FLT_MAX,
+        dir.y != 0.0f ? 1.0f / dir.y : FLT_MAX,
+        dir.z != 0.0f ? 1.0f / dir.z : FLT_MAX);
+}
+
+BE_INLINE bool DynamicAABBTree::IntersectRayNode(const Vec3 &origin, const Vec3 &invDir, float maxDist, const AABB &aabb, float &entryDist) {
+    float tmin = 0.0f;
+    float tmax = maxDist;
+
+    for (int i = 0; i < 3; i++) {
+        float t1 = (aabb[0][i] - origin[i]) * invDir[i];
+        float t2 = (aabb[1][i] - origin[i]) * invDir[i];
+
+        tmin = Max(tmin, Min(t1, t2));
+        tmax = Min(tmax, Max(t1, t2));
+    }
+
+    entryDist = tmin;
+    return tmin <= tmax;
+}
+
+template <typename F>
+BE_INLINE void DynamicAABBTree::RayCast(const Ray &ray, float maxDist, F &callback) const {
+    struct StackEntry {
+        int32_t     nodeId;
+        float       entryDist;
+    };
+
+    if (root == -1) {
+        return;
+    }
+
+    const Vec3 invDir = GetInverseRayDir(ray.dir);
+
+    StackEntry stack[MaxStackDepth];
+    int stackCount = 0;
+
+    float entryDist;
+    if (!IntersectRayNode(ray.origin, invDir, maxDist, nodes[root].aabb, entryDist)) {
+        return;
+    }
+    stack[stackCount++] = { root, entryDist };
+
+    while (stackCount > 0) {
+        const StackEntry entry = stack[--stackCount];
+
+        // The ray might be clipped after this node was pushed.
+        if (entry.entryDist > maxDist) {
+            continue;
+        }
+
+        const Node *node = nodes + entry.nodeId;
+
+        if (node->IsLeaf()) {
+            maxDist = callback(entry.nodeId, maxDist);
+            if (maxDist <= 0.0f) {
+                return;
+            }
+            continue;
+        }
+
+        float entryDist1, entryDist2;
+        bool hit1 = IntersectRayNode(ray.origin, invDir, maxDist, nodes[node->child1].aabb, entryDist1);
+        bool hit2 = IntersectRayNode(ray.origin, invDir, maxDist, nodes[node->child2].aabb, entryDist2);
+
+        assert(stackCount + 2 <= MaxStackDepth);
+
+        // Push the farther child first to visit the nearer child first.
+        if (hit1 && hit2) {
+            if (entryDist1 <= entryDist2) {
+                stack[stackCount++] = { node->child2, entryDist2 };
+                stack[stackCount++] = { node->child1, entryDist1 };
+            } else {
+                stack[stackCount++] = { node->child1, entryDist1 };
+                stack[stackCount++] = { node->child2, entryDist2 };
+            }
+        } else if (hit1) {
+            stack[stackCount++] = { node->child1, entryDist1 };
+        } else if (hit2) {
+            stack[stackCount++] = { node->child2, entryDist2 };
+        }
+    }
+}
+
+template <typename F>
+BE_INLINE void DynamicAABBTree::RayCastBatch(const Ray *rays, float *maxDists, int count, F &callback) const {
+    if (root == -1 || count <= 0) {
+        return;
+    }
+
+    Array<Vec3> invDirs;
+    invDirs.SetCount(count);
+    for (int i = 0; i < count; i++) {
+        invDirs[i] = GetInverseRayDir(rays[i].dir);
+    }
+
+    auto testNode = [rays, maxDists, &invDirs](int rayIndex, const AABB &aabb) -> bool {
+        float entryDist;
+        return maxDists[rayIndex] > 0.0f && IntersectRayNode(rays[rayIndex].origin, invDirs[rayIndex], maxDists[rayIndex], aabb, entryDist);
+    };
+
+    auto reportLeaf = [maxDists, &callback](int rayIndex, int32_t proxyId) -> bool {
+        if (maxDists[rayIndex] > 0.0f) {
+            maxDists[rayIndex] = callback(rayIndex, proxyId, maxDists[rayIndex]);
+        }
+        return true;
+    };
+
+    TraverseBatch(count, testNode, reportLeaf);
+}
+
+template <typename BV, typename F>
+BE_INLINE void DynamicAABBTree::QueryBatch(const BV *boundingVolumes, int count, F &callback) const {
+    if (root == -1 || count <= 0) {
+        return;
+    }
+
+    auto testNode = [boundingVolumes](int volumeIndex, const AABB &aabb) -> bool {
+        return IsIntersectNode(boundingVolumes[volumeIndex], aabb);
+    };
+
+    auto reportLeaf = [&callback](int volumeIndex, int32_t proxyId) -> bool {
+        return callback(volumeIndex, proxyId);
+    };
+
+    TraverseBatch(count, testNode, reportLeaf);
+}
+
+template <typename TestFunc, typename LeafFunc>
+BE_INLINE void DynamicAABBTree::TraverseBatch(int count, const TestFunc &testNode, const LeafFunc &reportLeaf) const {
+    // Each stack entry references the list of the indices intersecting with the parent node.
+    // The lists are stacked in a shared array, the list of a node is built on top of the list of its parent,
+    // and the lists above are discarded since they belong to the subtrees already visited.
+    struct StackEntry {
+        int32_t     nodeId;
+        int32_t     listOffset;
+        int32_t     listCount;
+    };
+
+    Array<int32_t> lists;
+    lists.Reserve(count * 4);
+    lists.SetCount(count, false);
+    for (int i = 0; i < count; i++) {
+        lists[i] = i;
+    }
+
+    StackEntry stack[MaxStackDepth];
+    int stackCount = 0;
+    stack[stackCount++] = { root, 0, count };
+
+    while (stackCount > 0) {
+        const StackEntry entry = stack[--stackCount];
+        const Node *node = nodes + entry.nodeId;
+
+        const int32_t listOffset = entry.listOffset + entry.listCount;
+        const int32_t requiredCount = listOffset + entry.listCount;
+        if (lists.Capacity() < requiredCount) {
+            lists.Reserve(Max(requiredCount, lists.Capacity() * 2));
+        }
+        lists.SetCount(requiredCount, false);
+
+        int32_t *indexes = lists.Ptr();
+        int32_t listCount = 0;
+
+        for (int i = 0; i < entry.listCount; i++) {
+            int32_t index = indexes[entry.listOffset + i];
+            if (testNode(index, node->aabb)) {
+                indexes[listOffset + listCount++] = index;
+            }
+        }
+
+        if (listCount == 0) {
+            continue;
+        }
+
+        if (node->IsLeaf()) {
+            for (int i = 0; i < listCount; i++) {
+                if (!reportLeaf(indexes[listOffset + i], entry.nodeId)) {
+                    return;
+                }
+            }
+            continue;
+        }
+
+        assert(stackCount + 2 <= MaxStackDepth);
+        stack[stackCount++] = { node->child1, listOffset, listCount };
+        stack[stackCount++] = { node->child2, listOffset, listCount };
+    }
+}
+
+template <typename F>
+BE_INLINE void DynamicAABBTree::QueryOverlapPairs(const DynamicAABBTree &other, F &callback) const {
+    struct NodePair {
+        int32_t     nodeId;
+        int32_t     otherNodeId;
+    };
+
+    if (root == -1 || other.root == -1) {
+        return;
+    }
+
+    const bool selfQuery = &other == this;
+
+    // Descending into one node of a pair pushes at most 3 pairs.
+    NodePair stack[MaxStackDepth * 2];
+    int stackCount = 0;
+    stack[stackCount++] = { root, other.root };
+
+    while (stackCount > 0) {
+        const NodePair pair = stack[--stackCount];
+        const Node *node = nodes + pair.nodeId;
+        const Node *otherNode = other.nodes + pair.otherNodeId;
+
+        assert(stackCount + 3 <= MaxStackDepth * 2);
+
+        if (selfQuery && pair.nodeId == pair.otherNodeId) {
+            // Pairs in the same subtree are the pairs in each child and the pairs between the children.
+            if (!node->IsLeaf()) {
+                stack[stackCount++] = { node->child1, node->child2 };
+                stack[stackCount++] = { node->child2, node->child2 };
+                stack[stackCount++] = { node->child1, node->child1 };
+            }
+            continue;
+        }
+
+        if (!node->aabb.IsIntersectAABB(otherNode->aabb)) {
+            continue;
+        }
+
+        if (node->IsLeaf() && otherNode->IsLeaf()) {
+            if (!callback(pair.nodeId, pair.otherNodeId)) {
+                return;
+            }
+            continue;
+        }
+
+        // Descend into the larger node.
+        if (otherNode->IsLeaf() || (!node->IsLeaf() && node->aabb.Area() >= otherNode->aabb.Area())) {
+            stack[stackCount++] = { node->child2, pair.otherNodeId };
+            stack[stackCount++] = { node->child1, pair.otherNodeId };
+        } else {
+            stack[stackCount++] = { pair.nodeId, otherNode->child2 };
+            stack[stackCount++] = { pair.nodeId, otherNode->child1 };
+        }
+    }
+}
+
 BE_NAMESPACE_END
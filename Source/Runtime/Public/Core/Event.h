@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include "Containers/Array.h"
 #include "Containers/LinkList.h"
 
 BE_NAMESPACE_BEGIN
@@ -66,6 +67,7 @@ private:
 
 class BE_API Event {
     friend class EventSystem;
+    friend class EventQueue;
 
 public:
     Event() = default;
@@ -74,16 +76,44 @@ public:
     byte *                  GetData() { return data; }
 
 private:
-    const EventDef *        eventDef;
-    byte *                  data;
-    int                     time;
-    Object *                sender;
-    LinkList<Event>         node;
+    const EventDef *        eventDef = nullptr;
+    byte *                  data = nullptr;
+    int                     time = 0;
+    uint64_t                sequence = 0;       ///< Scheduled order to keep FIFO order of the events at the same time
+    int                     queueIndex = -1;    ///< Index in the event queue, -1 if not scheduled
+    Object *                sender = nullptr;
+    LinkList<Event>         node;               ///< Node in the free event list
+    LinkList<Event>         senderNode;         ///< Node in the event list of the sender
+};
+
+/// Priority queue of the scheduled events ordered by time.
+/// Implemented as a 4-ary min heap so that insertion and removal are O(log n).
+class BE_API EventQueue {
+public:
+    bool                    IsEmpty() const { return events.Count() == 0; }
+    int                     Count() const { return events.Count(); }
+
+                            /// Returns the earliest event
+    Event *                 First() const { return events[0]; }
+
+    void                    Push(Event *event);
+    void                    Remove(Event *event);
+    void                    Clear();
+
+private:
+    static constexpr int    Arity = 4;
+
+    static bool             IsEarlier(const Event *a, const Event *b);
+    void                    SiftUp(int index);
+    void                    SiftDown(int index);
+    void                    Place(Event *event, int index) { events[index] = event; event->queueIndex = index; }
+
+    Array<Event *>          events;
 };
 
 class BE_API EventSystem {
 public:
-    static const int MaxEvents = 4096;
+    static constexpr int    EventBlockSize = 256;   ///< Number of events allocated at once when the pool runs out
 
     static void             Init();
     static void             Shutdown();
@@ -98,7 +128,8 @@ public:
 
     static void             ScheduleEvent(Event *event, Object *sender, int time);
 
-                            /// Cancels a event which is posted by sender in event queue
+                            /// Cancels events which are posted by sender.
+                            /// Cancels all the events of the sender if eventDef is nullptr.
     static void             CancelEvents(const Object *sender, const EventDef *eventDef = nullptr);
 
     static void             ServiceEvents();
@@ -108,11 +139,13 @@ public:
 
 private:
     static void             ServiceEvent(Event *event);
+    static void             AllocEventBlock();
 
-    static Event            eventPool[MaxEvents];
+    static Array<Event *>   eventBlocks;
     static LinkList<Event>  freeEvents;
-    static LinkList<Event>  eventQueue;
-    static LinkList<Event>  guiEventQueue;
+    static EventQueue       eventQueue;
+    static EventQueue       guiEventQueue;
+    static uint64_t         eventSequence;
 };
 
 BE_NAMESPACE_END
@@ -0,0 +1,143 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Work-stealing job system
+
+    Every worker thread (including the thread that called Init) owns a
+    lock-free deque. Workers pop jobs from the bottom of their own deque and
+    steal from the top of the others when they run out of work.
+
+    Jobs are allocated from a fixed ring buffer and recycled automatically,
+    so no more than MaxJobs jobs may be alive at the same time. A slot is
+    reused only after its job has submitted its continuations and finished
+    its parent. Jobs are referenced by handles which hold the generation of
+    the slot, so a handle to a finished job never refers to the job that
+    reuses its slot.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Platform/PlatformThread.h"
+
+BE_NAMESPACE_BEGIN
+
+using JobFunc = void (*)(void *data);
+using ParallelForFunc = void (*)(void *data, int begin, int end);
+
+struct Job;
+class JobQueue;
+
+/// Handle to a job. The generation is incremented when the slot is released, so a handle of a finished job becomes stale instead of referring to a new job.
+struct JobHandle {
+    Job *                   job = nullptr;
+    uint32_t                generation = 0;
+
+    bool                    IsValid() const { return job != nullptr; }
+};
+
+class BE_API JobSystem {
+public:
+    static constexpr int MaxJobs = 8192;
+    static constexpr int MaxJobDataSize = 48;
+    static constexpr int MaxContinuations = 5;
+
+    JobSystem();
+
+                            /// Starts worker threads.
+                            /// If numThreads is negative, one worker is created per logical processor except the calling thread.
+    void                    Init(int numThreads = -1);
+    void                    Shutdown();
+
+    bool                    IsInitialized() const { return initialized; }
+
+                            /// Returns number of workers including the thread that called Init.
+    int                     NumWorkers() const { return numWorkers; }
+
+                            /// Returns worker index of the calling thread, -1 if it is not a worker.
+    int                     GetCurrentWorkerIndex() const;
+
+                            /// Creates a job. If dataSize is greater than 0, data is copied into the job and the function receives a pointer to the copy.
+    JobHandle               CreateJob(JobFunc function, const void *data = nullptr, size_t dataSize = 0);
+
+                            /// Creates a job as a child of the parent. The parent is not finished until all of its children are finished.
+                            /// Should be called before the parent is finished, typically from inside the parent's function.
+    JobHandle               CreateChildJob(const JobHandle &parent, JobFunc function, const void *data = nullptr, size_t dataSize = 0);
+
+                            /// Makes the job wait for the prerequisite to finish before it runs.
+                            /// Should be called before the job is run. If the prerequisite is already finished, no dependency is added.
+    void                    AddDependency(const JobHandle &job, const JobHandle &prerequisite);
+
+                            /// Submits the job. It is executed as soon as all of its dependencies are finished.
+    void                    Run(const JobHandle &job);
+
+                            /// Waits until the job and all of its children are finished.
+                            /// Worker threads execute other jobs while waiting instead of blocking.
+                            /// Non-worker threads only sleep, so they must not wait when there are no worker threads except the main thread.
+    void                    Wait(const JobHandle &job);
+
+                            /// Is the job and all of its children finished ? Always true once the slot of the job is reused.
+    bool                    IsFinished(const JobHandle &job) const;
+
+                            /// Creates a job that calls function over the index range [0, count) split into batches of at least minBatchSize.
+                            /// The returned job is not yet submitted.
+    JobHandle               CreateParallelForJob(int count, int minBatchSize, ParallelForFunc function, void *data);
+
+                            /// Calls function over the index range [0, count) in parallel and waits for it.
+    void                    ParallelFor(int count, int minBatchSize, ParallelForFunc function, void *data);
+
+private:
+    struct Worker {
+        JobSystem *         jobSystem;
+        int                 index;
+        JobQueue *          queue;
+        PlatformThread *    thread;
+    };
+
+    JobHandle               AllocJob();
+    void                    Push(Job *job);
+    Job *                   GetJob(Worker *worker);
+    void                    Execute(Job *job);
+    void                    Finish(Job *job);
+    Worker *                GetCurrentWorker() const;
+    void                    WakeWorkers();
+
+    static void             WorkerThreadProc(void *param);
+
+    bool                    initialized;
+
+    Job *                   jobPool;
+    std::atomic<uint32_t>   numAllocatedJobs;
+
+    int                     numWorkers;
+    Worker *                workers;
+    uint32_t                workerTlsSlot;
+
+    JobQueue *              sharedQueue;        ///< Queue for jobs submitted from non-worker threads.
+    PlatformMutex *         sharedQueueMutex;
+
+    std::atomic<int>        stopping;
+    std::atomic<int>        numSleepingWorkers;
+    std::atomic<uint32_t>   numPushedJobs;      ///< Incremented on every push, used to detect lost wake-ups.
+    PlatformMutex *         sleepMutex;
+    PlatformCondition *     sleepCondition;
+};
+
+extern JobSystem            jobSystem;
+
+BE_NAMESPACE_END
@@ -168,6 +168,8 @@ private:
 };
 
 class BE_API Object : public Serializable {
+    friend class EventSystem;
+
 public:
     ABSTRACT_PROTOTYPE(Object);
 
@@ -238,6 +240,11 @@ public:
     static void                 DestroyInstance(Object *instance, bool immediate = false);
     static void                 DestroyInstanceImmediate(Object *instance) { DestroyInstance(instance, true); }
     static Object *             FindInstance(const Guid &guid);
+
+                                /// Removes this instance from the GUID lookup table, so that FindInstance() doesn't return it while kept for reuse.
+    void                        UnregisterInstance();
+                                /// Adds this instance back to the GUID lookup table.
+    bool                        RegisterInstance();
    
     static void                 ListClasses(const CmdArgs &args);
 
@@ -257,6 +264,8 @@ private:
     Guid                        guid;
     int                         instanceID;
 
+    LinkList<Event>             postedEvents;   // events posted by this object not yet processed
+
     static bool                 initialized;
     static Array<MetaObject *>  types;          // in alphabetical order
 };
@@ -0,0 +1,210 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Radix Sort templated functions
+
+    LSD radix sort of key/value pairs with 64-bit keys, 8 bits per pass.
+    Passes for the key bytes which are the same in all keys are skipped.
+    The sort is stable.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Core/Heap.h"
+#include "Core/JobSystem.h"
+
+BE_NAMESPACE_BEGIN
+
+/// Minimum number of elements to sort with the job system workers.
+static constexpr int RadixSort_ParallelThreshold = 65536;
+
+/// Sorts the values by the keys in ascending order.
+/// tempKeys and tempValues are scratch buffers of count elements.
+template <typename T>
+void RadixSort64(uint64_t *keys, T *values, int count, uint64_t *tempKeys, T *tempValues) {
+    if (count <= 1) {
+        return;
+    }
+
+    // Build the histograms of all bytes in one pass.
+    uint32_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (int i = 0; i < count; i++) {
+        uint64_t key = keys[i];
+        for (int byteIndex = 0; byteIndex < 8; byteIndex++) {
+            histograms[byteIndex][(key >> (byteIndex << 3)) & 0xFF]++;
+        }
+    }
+
+    uint64_t *srcKeys = keys;
+    uint64_t *dstKeys = tempKeys;
+    T *srcValues = values;
+    T *dstValues = tempValues;
+
+    for (int byteIndex = 0; byteIndex < 8; byteIndex++) {
+        const int shift = byteIndex << 3;
+        uint32_t *histogram = histograms[byteIndex];
+
+        // Skip if all keys have the same byte.
+        if (histogram[(srcKeys[0] >> shift) & 0xFF] == (uint32_t)count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (int i = 0; i < count; i++) {
+            uint32_t dstIndex = histogram[(srcKeys[i] >> shift) & 0xFF]++;
+            dstKeys[dstIndex] = srcKeys[i];
+            dstValues[dstIndex] = srcValues[i];
+        }
+
+        Swap(srcKeys, dstKeys);
+        Swap(srcValues, dstValues);
+    }
+
+    if (srcKeys != keys) {
+        memcpy(keys, srcKeys, count * sizeof(keys[0]));
+        for (int i = 0; i < count; i++) {
+            values[i] = srcValues[i];
+        }
+    }
+}
+
+/// Same as RadixSort64() but histograms and scatters are distributed to the job system workers.
+/// Falls back to RadixSort64() if count is smaller than RadixSort_ParallelThreshold.
+template <typename T>
+void RadixSort64_Parallel(uint64_t *keys, T *values, int count, uint64_t *tempKeys, T *tempValues) {
+    static constexpr int MaxBlocks = 32;
+
+    if (count < RadixSort_ParallelThreshold || jobSystem.NumWorkers() <= 1) {
+        RadixSort64(keys, values, count, tempKeys, tempValues);
+        return;
+    }
+
+    // Each block keeps the order of its elements, so concatenating the blocks in order keeps the sort stable.
+    const int numBlocks = Min(jobSystem.NumWorkers() * 2, MaxBlocks);
+    const int blockSize = (count + numBlocks - 1) / numBlocks;
+
+    struct SortContext {
+        const uint64_t *    srcKeys;
+        const T *           srcValues;
+        uint64_t *          dstKeys;
+        T *                 dstValues;
+        int                 count;
+        int                 blockSize;
+        int                 shift;
+        uint32_t            blockHistograms[MaxBlocks][256];
+    };
+
+    // Keep the block histograms off the stack.
+    SortContext *context = (SortContext *)Mem_Alloc(sizeof(SortContext));
+    context->count = count;
+    context->blockSize = blockSize;
+
+    // Find out key bytes that are the same in all keys.
+    uint64_t orKeys = 0;
+    uint64_t andKeys = ~(uint64_t)0;
+    for (int i = 0; i < count; i++) {
+        orKeys |= keys[i];
+        andKeys &= keys[i];
+    }
+    const uint64_t varyingBits = orKeys ^ andKeys;
+
+    uint64_t *srcKeys = keys;
+    uint64_t *dstKeys = tempKeys;
+    T *srcValues = values;
+    T *dstValues = tempValues;
+
+    for (int byteIndex = 0; byteIndex < 8; byteIndex++) {
+        const int shift = byteIndex << 3;
+
+        if (!((varyingBits >> shift) & 0xFF)) {
+            continue;
+        }
+
+        context->srcKeys = srcKeys;
+        context->srcValues = srcValues;
+        context->dstKeys = dstKeys;
+        context->dstValues = dstValues;
+        context->shift = shift;
+
+        jobSystem.ParallelFor(numBlocks, 1, [](void *data, int begin, int end) {
+            SortContext *context = (SortContext *)data;
+
+            for (int blockIndex = begin; blockIndex < end; blockIndex++) {
+                uint32_t *histogram = context->blockHistograms[blockIndex];
+                memset(histogram, 0, sizeof(context->blockHistograms[0]));
+
+                const int first = blockIndex * context->blockSize;
+                const int last = Min(first + context->blockSize, context->count);
+
+                for (int i = first; i < last; i++) {
+                    histogram[(context->srcKeys[i] >> context->shift) & 0xFF]++;
+                }
+            }
+        }, context);
+
+        // Convert the counts to the destination offsets of each block.
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; digit++) {
+            for (int blockIndex = 0; blockIndex < numBlocks; blockIndex++) {
+                uint32_t digitCount = context->blockHistograms[blockIndex][digit];
+                context->blockHistograms[blockIndex][digit] = offset;
+                offset += digitCount;
+            }
+        }
+
+        jobSystem.ParallelFor(numBlocks, 1, [](void *data, int begin, int end) {
+            SortContext *context = (SortContext *)data;
+
+            for (int blockIndex = begin; blockIndex < end; blockIndex++) {
+                uint32_t *offsets = context->blockHistograms[blockIndex];
+
+                const int first = blockIndex * context->blockSize;
+                const int last = Min(first + context->blockSize, context->count);
+
+                for (int i = first; i < last; i++) {
+                    uint32_t dstIndex = offsets[(context->srcKeys[i] >> context->shift) & 0xFF]++;
+                    context->dstKeys[dstIndex] = context->srcKeys[i];
+                    context->dstValues[dstIndex] = context->srcValues[i];
+                }
+            }
+        }, context);
+
+        Swap(srcKeys, dstKeys);
+        Swap(srcValues, dstValues);
+    }
+
+    Mem_Free(context);
+
+    if (srcKeys != keys) {
+        memcpy(keys, srcKeys, count * sizeof(keys[0]));
+        for (int i = 0; i < count; i++) {
+            values[i] = srcValues[i];
+        }
+    }
+}
+
+BE_NAMESPACE_END
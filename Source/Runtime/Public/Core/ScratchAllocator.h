@@ -0,0 +1,96 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Scratch allocator
+
+    Per thread stack of memory blocks for short-lived temporary buffers.
+    Used instead of _alloca16() in the code that runs in the job system
+    workers, so that big or nested temporaries don't overflow the worker
+    thread stacks.
+
+    Memory is allocated in stack order and freed when the enclosing
+    ScratchAllocator::Scope goes out of scope. The blocks are kept for
+    reuse in the next frames.
+
+    Workers use the stacks from the first one in the order of the worker
+    index. Other threads take a free stack from the last one when they
+    open their outermost Scope, and give it back when it is closed, so
+    that threads that come and go don't run out of stacks.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Platform/PlatformThread.h"
+
+BE_NAMESPACE_BEGIN
+
+class BE_API ScratchAllocator {
+public:
+    static constexpr int MaxThreads = 64;
+    static constexpr int BlockSize = 64 * 1024;
+
+    struct Block;
+
+    /// Frees everything allocated by the calling thread after construction when it goes out of scope.
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        int                 threadIndex;
+        Block *             block;
+        int                 used;
+    };
+
+    ScratchAllocator();
+
+    void                    Init();
+    void                    Shutdown();
+
+                            /// Allocates 16 bytes aligned memory from the stack of the calling thread.
+                            /// Should be called inside of a Scope.
+    void *                  Alloc(int bytes);
+
+                            /// Allocates an array of count elements. Constructors are not called.
+    template <typename T>
+    T *                     Alloc(int count) { return (T *)Alloc(count * (int)sizeof(T)); }
+
+private:
+    struct Stack {
+        Block *             first;
+        Block *             current;        ///< nullptr if nothing is allocated
+        int                 numScopes;      ///< Number of open scopes
+        bool                taken;          ///< Taken by a non-worker thread
+    };
+
+    static int              GetThreadIndex();
+    static void             ReleaseThreadIndex(int threadIndex);
+
+    Stack                   stacks[MaxThreads];
+    uint32_t                threadTlsSlot;          ///< Stack index + 1 of non-worker threads
+    PlatformMutex *         otherStacksMutex;       ///< Guards taking and releasing the stacks of non-worker threads
+};
+
+extern ScratchAllocator     scratchAllocator;
+
+BE_NAMESPACE_END
@@ -84,6 +84,9 @@ public:
                             /// Sets property array count by property info. This function is valid only if property is an array.
     void                    SetPropertyArrayCount(const PropertyInfo &propertyInfo, int numElements);
 
+                            /// Converts JSON value to variant of the given property type. Returns default value if JSON value is not convertible.
+    static Variant          JsonValueToVariant(Variant::Type::Enum type, const Json::Value &value, const Variant &defaultValue);
+
     static const SignalDef  SIG_PropertyChanged;            ///< A signal emitted when a property value changed.
     static const SignalDef  SIG_PropertyArrayCountChanged;  ///< A signal emitted when a property array count changed.
     static const SignalDef  SIG_PropertyInfoUpdated;        ///< A signal emitted when property info list updated.
@@ -402,8 +402,10 @@ BE_INLINE void VertexGenericLit::Transform(const Mat3 &rotation, const Vec3 &sca
 
 #if 1
 typedef byte JointWeightType;
+#define JOINT_WEIGHT_TO_FLOAT(x)        ((x) * (1.0f / 255.0f))
 #else
 typedef float JointWeightType;
+#define JOINT_WEIGHT_TO_FLOAT(x)        (x)
 #endif
 
 struct VertexWeight1 {
@@ -20,6 +20,7 @@ BE_NAMESPACE_BEGIN
 
 class Guid;
 class Object;
+struct ZipArchive;
 
 class BE_API File {
     friend class FileSystem;
@@ -117,7 +118,7 @@ class BE_API FileInZip : public File {
     friend class FileSystem;
     
 public:
-    FileInZip(const char *filename, void *pointer);
+    FileInZip(const char *filename, ZipArchive *archive, void *pointer);
     virtual ~FileInZip();
     
     virtual const char *    GetFilePath() const override { return filename; }
@@ -137,6 +138,7 @@ public:
     
 protected:
     char                    filename[MaxAbsolutePath];
+    ZipArchive *            archive;
     void *                  pointer;
     size_t                  size;
 };
@@ -53,6 +53,8 @@ private:
 };
 
 class BE_API FileSystem {
+    friend class FileInZip;
+
 public:
     void                Init(const char *baseDir);
     void                Shutdown();
@@ -119,6 +121,10 @@ private:
     void                ClearSearchPath();
     void                AddSearchPath(const char *path);
     void                AddSearchPath_ZIP(const char *path, const char *filename);
+
+                        /// Returns a handle of the archive that is not used by the other open files
+    static void *       AllocZipHandle(ZipArchive *archive);
+    static void         FreeZipHandle(ZipArchive *archive, void *handle);
     
     static void         Cmd_Dir(const CmdArgs &args);
     static void         Cmd_Path(const CmdArgs &args);
@@ -33,6 +33,7 @@ class Component;
 class ComTransform;
 class GameWorld;
 class Prefab;
+class EntityPool;
 class Entity;
 
 using EntityPtr = Entity*;
@@ -43,6 +44,8 @@ class Entity : public Object {
     friend class GameWorld;
     friend class GameEdit;
     friend class Prefab;
+    friend class EntityTemplate;
+    friend class EntityPool;
     friend class Component;
 
 public:
@@ -58,6 +61,10 @@ public:
     OBJECT_PROTOTYPE(Entity);
     
     Entity();
+
+                                /// Entities are allocated from the fixed size blocks.
+    static void *               operator new(size_t size);
+    static void                 operator delete(void *ptr);
     virtual ~Entity();
 
     virtual Str                 ToString() const override { return GetName(); }
@@ -249,6 +256,9 @@ public:
 protected:
     void                        SetActiveInHierarchy(bool active);
 
+                                /// Removes from the game world and purges all of the data to reuse this entity by EntityPool.
+    void                        PurgeForReuse();
+
     virtual void                Event_ImmediateDestroy() override;
 
                                 /// Called when the application resizes.
@@ -279,6 +289,8 @@ protected:
     GameWorld *                 gameWorld;
     int                         sceneIndex = -1;
 
+    EntityPool *                pool = nullptr;     ///< Pool to return when destroyed, only set for the root entity of pooled instance
+
     ComponentPtrArray           components;         ///< 0'th component is always transform component
 };
 
@@ -0,0 +1,62 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    EntityPool
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Entity.h"
+
+BE_NAMESPACE_BEGIN
+
+class GameWorld;
+class Prefab;
+class EntityTemplate;
+
+/// Pool of the instances of a prefab in a game world.
+/// Destroyed instances are purged, kept out of the game world and reused by the next instantiation.
+class EntityPool {
+public:
+    EntityPool(GameWorld *gameWorld, Prefab *prefab);
+    ~EntityPool();
+
+                                /// Returns the prefab of this pool. Returns nullptr if the prefab has been cleared.
+    Prefab *                    GetPrefab() const { return prefab; }
+
+                                /// Returns number of instances waiting for reuse.
+    int                         NumFreeInstances() const { return freeInstances.Count(); }
+
+                                /// Returns an instance which is reused or newly created by the given template.
+    Entity *                    Alloc(const EntityTemplate &entityTemplate, int sceneIndex);
+                                /// Returns an instance to the pool. Returns false if the instance can't be pooled.
+    bool                        Free(Entity *rootEntity);
+
+                                /// Destroys all of the free instances.
+    void                        Clear();
+                                /// Destroys all of the free instances and stops pooling. Called when the prefab is cleared.
+    void                        DetachPrefab();
+
+private:
+    GameWorld *                 gameWorld;
+    Prefab *                    prefab;
+    Array<EntityPtrArray>       freeInstances;      ///< Entities of each free instance in depth-first order
+};
+
+BE_NAMESPACE_END
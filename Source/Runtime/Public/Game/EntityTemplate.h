@@ -0,0 +1,94 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    EntityTemplate
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Containers/HashTable.h"
+#include "Entity.h"
+
+BE_NAMESPACE_BEGIN
+
+class GameWorld;
+
+/// Compiled instantiation template of an entity hierarchy.
+/// Property values are parsed once and bound to their property info, and references between objects
+/// in the hierarchy are resolved through the GUID remap table, so instantiation doesn't go through JSON.
+class EntityTemplate {
+public:
+    EntityTemplate() {}
+
+                                /// Returns true if nothing is compiled.
+    bool                        IsEmpty() const { return entities.Count() == 0; }
+                                /// Returns number of entities in the compiled hierarchy.
+    int                         NumEntities() const { return entities.Count(); }
+
+                                /// Clears compiled data.
+    void                        Clear();
+
+                                /// Compiles the given entity and it's children.
+    bool                        Compile(const Entity *rootEntity);
+
+                                /// Creates new copy of the compiled hierarchy and returns the root entity.
+                                /// The result is the same as cloning from JSON. Created entities are not registered to the game world.
+    Entity *                    Instantiate(GameWorld *gameWorld, int sceneIndex = 0) const;
+
+                                /// Tests if the given entities in depth-first order have the same structure with the compiled hierarchy.
+    bool                        Matches(const EntityPtrArray &hierarchyEntities) const;
+                                /// Resets the entities instantiated from this template to reuse them. Entities should be purged and matched.
+    Entity *                    Reset(const EntityPtrArray &hierarchyEntities, GameWorld *gameWorld, int sceneIndex = 0) const;
+
+private:
+    struct PropertyBinding {
+        PropertyInfo            propertyInfo;       ///< Pre-resolved property info
+        int                     arrayCount;         ///< Number of elements for array property, -1 for non-array property
+        int                     firstValue;         ///< Index of the first value in values[]
+    };
+
+    struct ObjectTemplate {
+        const MetaObject *      metaObject;
+        int                     guidSlot;           ///< Index of the GUID remap table
+        int                     firstProperty;      ///< Index of the first property binding in properties[]
+        int                     numProperties;
+        Json::Value             deserializeValue;   ///< JSON value for the object that should be deserialized by itself
+    };
+
+    struct EntityEntry {
+        int                     objectIndex;        ///< Index of the entity object in objects[], followed by it's components
+        int                     numComponents;
+        bool                    needRemapGuids;     ///< Has components which is deserialized from JSON value
+        Guid                    prefabSourceGuid;   ///< Source entity GUID if the source is prefab
+    };
+
+    void                        CompileObject(const MetaObject *metaObject, const Array<PropertyInfo> &propertyInfoList, const Json::Value &objectValue, int guidSlot, const HashTable<Guid, int> &guidSlotTable);
+    void                        CompileValue(Variant::Type::Enum type, const Json::Value &jsonValue, const Variant &defaultValue, const HashTable<Guid, int> &guidSlotTable);
+    void                        ApplyProperties(Serializable *object, const ObjectTemplate &objectTemplate, const Guid *newGuids) const;
+    void                        InitEntity(Entity *entity, const EntityEntry &entry, const ComponentPtrArray &components, const Array<Guid> &newGuids, HashTable<Guid, Guid> &guidMap) const;
+
+    Array<EntityEntry>          entities;
+    Array<ObjectTemplate>       objects;
+    Array<PropertyBinding>      properties;
+    Array<Variant>              values;
+    Array<int>                  valueGuidSlots;     ///< GUID slot of each value which references object in this template, -1 otherwise
+    Array<Guid>                 sourceGuids;        ///< GUID remap table, source object GUIDs indexed by slot
+};
+
+BE_NAMESPACE_END
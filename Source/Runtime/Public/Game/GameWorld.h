@@ -35,15 +35,22 @@ class Prefab;
 class TagLayerSettings;
 class PhysicsSettings;
 class MapRenderSettings;
+class ComAnimator;
 class PlayerSettings;
 class GameWorld;
+class MapLoadRequest;
+class BMapReader;
+class TaskManager;
 
 struct GameScene {
     Hierarchy<Entity>           root;
+    bool                        isLoading = false;  ///< Entities are being spawned by asynchronous map loading
 };
 
 class GameWorld : public Object {
     friend class GameEdit;
+    friend class Entity;
+    friend class PrefabManager;
 
 public:
     static constexpr int MaxScenes = 16;
@@ -61,6 +68,13 @@ public:
         };
     };
 
+    /// Animation LOD results of the animators in the last update
+    struct AnimatorCounter {
+        int                     numFullUpdates;     ///< Number of animators computed at full rate
+        int                     numThrottled;       ///< Number of animators at reduced update rate and joint set
+        int                     numSkipped;         ///< Number of animators skipped because they were not visible
+    };
+
     OBJECT_PROTOTYPE(GameWorld);
 
     GameWorld();
@@ -136,12 +150,24 @@ public:
 
     void                        UnregisterEntity(Entity *ent);
 
+                                /// Registers an animator to compute its frame after updating entities in this frame.
+                                /// All of the registered animators are computed together in the job system workers.
+    void                        RegisterAnimatorToUpdate(ComAnimator *animator);
+    void                        UnregisterAnimatorToUpdate(ComAnimator *animator);
+
+                                /// Returns animation LOD counters of the last update.
+    const AnimatorCounter &     GetAnimatorCounter() const { return animatorCounter; }
+    AnimatorCounter &           GetAnimatorCounter() { return animatorCounter; }
+
                                 /// Creates an entity that has no components but transform component.
     Entity *                    CreateEmptyEntity(const char *name);
 
     Entity *                    InstantiateEntity(const Entity *originalEntity);
     Entity *                    InstantiateEntityWithTransform(const Entity *originalEntity, const Vec3 &origin, const Quat &rotation);
 
+                                /// Deactivates the pooled entity and returns it to the pool at the end of the frame.
+    void                        RecycleEntity(Entity *entity);
+
     Entity *                    SpawnEntityFromJson(Json::Value &entityValue, int sceneIndex = 0);
     void                        SpawnEntitiesFromJson(Json::Value &entitiesValue, int sceneIndex = 0);
 
@@ -164,11 +190,23 @@ public:
     const char *                MapName() const { return mapName.c_str(); }
 
     void                        NewMap();
+                                /// Loads map. Cooked binary map (.bmap) is loaded instead of the JSON map if it is up to date.
     bool                        LoadMap(const char *filename, LoadSceneMode::Enum mode);
     void                        SaveMap(const char *filename);
 
+                                /// Cooks JSON map to the binary map which can be loaded without parsing.
+    static bool                 CookMap(const char *filename, const char *cookedFilename);
+
+                                /// Starts loading map asynchronously. The file is read and decoded in the background, and then
+                                /// entities are spawned in Update() within the time budget of g_mapLoadTimeBudget milliseconds per frame.
+                                /// SIG_MapLoaded is emitted when it is done. Returned handle is valid until ReleaseMapLoadRequest() is called.
+    MapLoadRequest *            LoadMapAsync(const char *filename, LoadSceneMode::Enum mode);
+                                /// Releases the handle of asynchronous map loading. Spawning is stopped if it's not done yet.
+    void                        ReleaseMapLoadRequest(MapLoadRequest *request);
+
     static const SignalDef      SIG_EntityRegistered;
     static const SignalDef      SIG_EntityUnregistered;
+    static const SignalDef      SIG_MapLoaded;
     
 private:
     void                        Event_RestartGame(const char *mapName);
@@ -177,11 +215,25 @@ private:
     Entity *                    FindEntityRelativePath(const Entity *entity, const char *path) const;
     void                        BeginMapLoading();
     void                        FinishMapLoading();
+    bool                        LoadJsonMap(const char *filename, int sceneIndex);
+    bool                        LoadBinaryMap(const char *filename, int sceneIndex);
+    Entity *                    SpawnEntityFromBinaryMap(const BMapReader &reader, int entityIndex, int sceneIndex);
+    int                         FindFreeSceneIndex() const;
+    void                        UpdateMapLoadRequests();
+    void                        BeginMapLoadRequest(MapLoadRequest *request);
+    void                        SpawnMapLoadRequestEntity(MapLoadRequest *request);
+    void                        FinishMapLoadRequest(MapLoadRequest *request);
     Entity *                    CloneEntity(const Entity *originalEntity);
+    Entity *                    CloneEntityFromJson(const Entity *originalEntity);
     void                        FixedUpdateEntities(float timeStep);
     void                        FixedLateUpdateEntities(float timeStep);
     void                        UpdateEntities();
+    void                        UpdateAnimators();
     void                        LateUpdateEntities();
+    EntityPool *                GetEntityPool(Prefab *prefab);
+    void                        PrefabCleared(Prefab *prefab);
+    void                        RecycleEntities();
+    void                        ClearEntityPools();
 
     Entity *                    entities[MaxEntities] = { nullptr, };
     HashIndex                   entityHash;
@@ -190,6 +242,15 @@ private:
 
     GameScene                   scenes[MaxScenes];
 
+    Array<EntityPool *>         entityPools;
+    EntityPtrArray              entitiesToRecycle;
+
+    Array<MapLoadRequest *>     mapLoadRequests;
+    TaskManager *               mapLoadTaskManager = nullptr;
+
+    Array<ComAnimator *>        animatorsToUpdate;
+    AnimatorCounter             animatorCounter = {};
+
     Json::Value                 snapshotValues;
 
     Random                      random;
@@ -213,6 +274,52 @@ private:
     bool                        isMapLoading = false;
 };
 
+/// Handle of the asynchronous map loading.
+class MapLoadRequest {
+    friend class GameWorld;
+
+public:
+    struct State {
+        enum Enum {
+            Reading,                ///< Reading and decoding the file in the background
+            Spawning,               ///< Spawning entities on the main thread
+            Finished,
+            Failed
+        };
+    };
+
+    const char *                GetFilename() const { return filename.c_str(); }
+
+    State::Enum                 GetState() const { return state; }
+
+    bool                        IsDone() const { return state == State::Finished || state == State::Failed; }
+
+                                /// Returns progress in the range [0, 1].
+    float                       GetProgress() const;
+
+                                /// Returns the scene index which the map is loaded into, -1 if spawning is not started.
+    int                         GetSceneIndex() const { return sceneIndex; }
+
+private:
+    MapLoadRequest(const char *filename, GameWorld::LoadSceneMode::Enum mode);
+    ~MapLoadRequest();
+
+    static void                 ReadTask(void *data);
+    void                        Read();
+
+    Str                         filename;
+    GameWorld::LoadSceneMode::Enum mode;
+    State::Enum                 state = State::Reading;
+    int                         sceneIndex = -1;
+    std::atomic<bool>           readFinished;
+    bool                        readSucceeded = false;
+    bool                        released = false;
+    BMapReader *                binaryMap = nullptr;
+    Json::Value                 map;
+    int                         numEntities = 0;
+    int                         numSpawnedEntities = 0;
+};
+
 template <typename Func>
 BE_INLINE void GameWorld::IterateEntities(Func func) const {
     for (int sceneIndex = 0; sceneIndex < COUNT_OF(scenes); sceneIndex++) {
@@ -16,17 +16,29 @@
 
 #include "Containers/HashMap.h"
 #include "Entity.h"
+#include "EntityTemplate.h"
 
 BE_NAMESPACE_BEGIN
 
 class Component;
+class CmdArgs;
 
 class Prefab : public Object {
     friend class PrefabManager;
 
 public:
+    /// Pooling statistics accumulated over all game worlds.
+    struct PoolStats {
+        int                     numSpawns = 0;      ///< Number of instantiations through the pool
+        int                     numHits = 0;        ///< Number of instantiations reused pooled instance
+        int                     numRecycles = 0;    ///< Number of destroyed instances returned to the pool
+        int                     numDiscards = 0;    ///< Number of destroyed instances which couldn't be pooled
+    };
+
     OBJECT_PROTOTYPE(Prefab);
 
+    static const SignalDef      SIG_Cleared;        ///< A signal emitted before the prefab entities are destroyed by reloading or destroying the prefab.
+
     Prefab() {}
     virtual ~Prefab();
 
@@ -36,6 +48,19 @@ public:
     Hierarchy<Entity> &         GetRootNode() { return entityHierarchy; }
     Entity *                    GetRootEntity() { return entityHierarchy.GetChild(); }
 
+                                /// Returns compiled template to instantiate this prefab. Returns nullptr if the prefab should be cloned through JSON serialization.
+                                /// The template is compiled again if the prefab entities have been changed after the last compilation.
+    const EntityTemplate *      GetInstantiationTemplate();
+                                /// Forces the template to be compiled again on next use.
+    void                        InvalidateInstantiationTemplate() { instantiationTemplateInvalidated = true; }
+
+                                /// Returns maximum number of destroyed instances kept for reuse per game world. 0 means no pooling.
+    int                         GetPoolCapacity() const { return poolCapacity; }
+                                /// Sets maximum number of destroyed instances kept for reuse per game world.
+    void                        SetPoolCapacity(int capacity) { poolCapacity = Max(capacity, 0); }
+
+    PoolStats &                 GetPoolStats() { return poolStats; }
+
     void                        Clear();
     bool                        Create(const Json::Value &entitiesValue);
 
@@ -45,10 +70,20 @@ public:
     bool                        Reload();
 
 private:
+    void                        CompileInstantiationTemplate();
+
+    void                        PropertyChanged(const char *propName, int index);
+    void                        PropertyArrayCountChanged(const char *propName);
+
     Str                         hashName;
     Str                         name;
     EntityPtrArray              entities;
     Hierarchy<Entity>           entityHierarchy;
+    EntityTemplate              instantiationTemplate;
+    bool                        instantiationTemplateInvalidated = true;
+    bool                        instantiationTemplateVerified = false;
+    int                         poolCapacity = 0;
+    PoolStats                   poolStats;
 };
 
 BE_INLINE Prefab::~Prefab() {
@@ -79,6 +114,8 @@ private:
 };*/
 
 class PrefabManager {
+    friend class Prefab;
+
 public:
     PrefabManager() : initialized(false) {}
 
@@ -88,6 +125,8 @@ public:
     Prefab *                    AllocPrefab(const char *hashName, const Guid &guid = Guid::zero);
     Prefab *                    FindPrefab(const char *hashName) const;
     Prefab *                    GetPrefab(const char *filename);
+                                /// Returns prefab which has the given root entity.
+    Prefab *                    FindPrefabByRootEntity(const Entity *rootEntity) const;
 
     void                        DestroyPrefab(Prefab *prefab);
 
@@ -95,10 +134,17 @@ public:
 
     static Json::Value          CreatePrefabValue(const Entity *entity);
 
+                                /// Returns true if the entities instantiated from the given template are the same with the entities cloned through JSON serialization.
+    static bool                 VerifyInstantiationTemplate(const Entity *rootEntity, const EntityTemplate &entityTemplate, GameWorld *gameWorld);
+
     GameWorld *                 GetPrefabWorld() { return prefabWorld; }
 
 private:
+    static void                 Cmd_ListPrefabs(const CmdArgs &args);
+    static void                 Cmd_BenchPrefab(const CmdArgs &args);
+
     StrIHashMap<Prefab *>       prefabHashMap;
+    HashMap<Guid, Prefab *>     rootEntityGuidToPrefabMap;
     GameWorld *                 prefabWorld;
 
     bool                        initialized;
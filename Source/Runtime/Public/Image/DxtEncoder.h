@@ -39,6 +39,13 @@ public:
     static void             CompressImageDXN2Fast(const byte *src, const int width, const int height, const int depth, byte *dst);
     static void             CompressImageDXN2HQ(const byte *src, const int width, const int height, const int depth, byte *dst);
 
+                            /// SIMD versions of the fast compression. The output is identical with the scalar fast compression.
+                            /// Falls back to the scalar fast compression on the platforms without SSE.
+    static void             CompressImageDXT1FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst);
+    static void             CompressImageDXT3FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst);
+    static void             CompressImageDXT5FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst);
+    static void             CompressImageDXN2FastSIMD(const byte *src, const int width, const int height, const int depth, byte *dst);
+
 private:
                             /// Extracts a 4x4 block from the texture and stores it in a fixed size buffer.
     static void             ExtractBlock(const byte *src, int srcPitch, int blockWidth, int blockHeight, byte *colorBlock);
@@ -75,6 +82,12 @@ private:
     static void             EncodeDXT3BlockHQ(const byte *src, byte **dstPtr);
     static void             EncodeDXT5BlockHQ(const byte *src, byte **dstPtr);
     static void             EncodeDXN2BlockHQ(const byte *src, byte **dstPtr);
+
+                            /// Encodes a 4x4 block read directly from the image with the given pitch.
+    static void             EncodeDXT1BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr);
+    static void             EncodeDXT3BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr);
+    static void             EncodeDXT5BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr);
+    static void             EncodeDXN2BlockFastSIMD(const byte *src, int srcPitch, byte **dstPtr);
 };
 
 BE_INLINE unsigned int DXTEncoder::AlphaDistance(const byte a1, const byte a2) {
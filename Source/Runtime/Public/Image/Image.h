@@ -165,6 +165,15 @@ public:
         };
     };
 
+    /// Mipmap generation filter
+    struct MipmapFilter {
+        enum Enum {
+            Box,                ///< 2x2 average, matches the classic mipmap generation
+            Kaiser,             ///< Kaiser windowed sinc, sharper than box
+            Lanczos             ///< Lanczos-3 windowed sinc, sharpest but with some ringing
+        };
+    };
+
     /// Compression quality
     struct CompressionQuality {
         enum Enum {
@@ -299,7 +308,8 @@ public:
     Image &             CopyFrom(const Image &srcImage, int firstLevel = 0, int numLevels = 1);
     
                         /// Generates full mipmaps if this image has
-    Image &             GenerateMipmaps();
+                        /// Windowed filters are applied to 1D/2D/cube/array images only, volume images always use box filter.
+    Image &             GenerateMipmaps(MipmapFilter::Enum filter = MipmapFilter::Box);
 
                         /// Converts this image to the given targetimage.
     bool                ConvertFormat(Image::Format::Enum dstFormat, Image &dstImage, bool regenerateMipmaps = false, CompressionQuality::Enum compressionQuality = CompressionQuality::Normal) const;
@@ -329,7 +339,9 @@ public:
     Image &             AddNormalMapRGBA8888(const Image &normalMap);
 
                         /// Loads image from the file.
-    bool                Load(const char *filename);
+                        /// If the file has pre-built mipmaps (DDS/PVR), up to firstMipLevel top levels are skipped without being read.
+                        /// The number of actually skipped levels is returned in skippedMipLevels.
+    bool                Load(const char *filename, int firstMipLevel = 0, int *skippedMipLevels = nullptr);
 
                         /// Writes image to the file.
     bool                Write(const char *filename) const;
@@ -388,10 +400,10 @@ private:
     template <typename T>
     T                   WrapCoord(T coord, T maxCoord, SampleWrapMode::Enum wrapMode) const;
 
-    bool                LoadDDSFromMemory(const char *name, const byte *data, size_t size);
-    bool                LoadPVRFromMemory(const char *name, const byte *data, size_t size);
-    bool                LoadPVR2FromMemory(const char *name, const byte *data, size_t size);
-    bool                LoadPVR3FromMemory(const char *name, const byte *data, size_t size);
+    bool                LoadDDSFromMemory(const char *name, const byte *data, size_t size, int firstMipLevel = 0, int *skippedMipLevels = nullptr);
+    bool                LoadPVRFromMemory(const char *name, const byte *data, size_t size, int firstMipLevel = 0, int *skippedMipLevels = nullptr);
+    bool                LoadPVR2FromMemory(const char *name, const byte *data, size_t size, int firstMipLevel = 0, int *skippedMipLevels = nullptr);
+    bool                LoadPVR3FromMemory(const char *name, const byte *data, size_t size, int firstMipLevel = 0, int *skippedMipLevels = nullptr);
     bool                LoadBMPFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadPCXFromMemory(const char *name, const byte *data, size_t size);
     bool                LoadTGAFromMemory(const char *name, const byte *data, size_t size);
@@ -443,7 +443,7 @@ BE_INLINE Mat3x4 Mat3x4::Inverse() const {
 BE_INLINE Mat3x4 Mat3x4::operator*(const float rhs) const {
     return Mat3x4(
         mat[0][0] * rhs, mat[0][1] * rhs, mat[0][2] * rhs, mat[0][3] * rhs, 
-        mat[1][1] * rhs, mat[1][1] * rhs, mat[1][2] * rhs, mat[1][3] * rhs,
+        mat[1][0] * rhs, mat[1][1] * rhs, mat[1][2] * rhs, mat[1][3] * rhs,
         mat[2][0] * rhs, mat[2][1] * rhs, mat[2][2] * rhs, mat[2][3] * rhs);
 }
 
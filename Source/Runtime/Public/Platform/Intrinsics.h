@@ -32,6 +32,12 @@ BE_FORCE_INLINE uint64_t __rdpmc(int i) {
     return __readpmc(i);
 }
 
+#if (_MSC_FULL_VER >= 160040219)
+BE_FORCE_INLINE uint64_t read_xcr(unsigned int index) {
+    return _xgetbv(index);
+}
+#endif
+
 BE_FORCE_INLINE int __bsf(int v) {
     unsigned long r = 0; 
     _BitScanForward(&r, v); 
@@ -136,17 +142,32 @@ BE_FORCE_INLINE void __cpuid(int out[4], int op) {
     asm volatile ("cpuid" : "=a"(out[0]), "=b"(out[1]), "=c"(out[2]), "=d"(out[3]) : "a"(op));
 }
 
+BE_FORCE_INLINE void __cpuidex(int out[4], int op, int subop) {
+    asm volatile ("cpuid" : "=a"(out[0]), "=b"(out[1]), "=c"(out[2]), "=d"(out[3]) : "a"(op), "c"(subop));
+}
+
 BE_FORCE_INLINE uint64_t read_tsc()  {
     uint32_t high, low;
     asm volatile ("rdtsc" : "=d"(high), "=a"(low));
     return (((uint64_t)high) << 32) + (uint64_t)low;
 }
 
+// <immintrin.h> of GCC and Clang already has __rdpmc() when AVX is enabled
+#if defined(__AVX__)
+#include <immintrin.h>
+#else
 BE_FORCE_INLINE uint64_t __rdpmc(int i) {
     uint32_t high, low;
     asm volatile ("rdpmc" : "=d"(high), "=a"(low) : "c"(i));
     return (((uint64_t)high) << 32) + (uint64_t)low;
 }
+#endif
+
+BE_FORCE_INLINE uint64_t read_xcr(unsigned int index) {
+    uint32_t high, low;
+    asm volatile ("xgetbv" : "=d"(high), "=a"(low) : "c"(index));
+    return (((uint64_t)high) << 32) + (uint64_t)low;
+}
 
 BE_FORCE_INLINE unsigned int __popcnt(unsigned int in) {
     int r = 0; 
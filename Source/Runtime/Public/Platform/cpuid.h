@@ -38,7 +38,8 @@ enum CpuId {
     CPUID_SSE42                 = 0x04000,  ///< Streaming SIMD Extensions 4.2
     CPUID_AVX                   = 0x08000,  ///< Advanced Vector Extensions
     CPUID_AVX2                  = 0x10000,  ///< Advanced Vector Extensions 2
-    CPUID_NEON                  = 0x20000   ///< ARM Neon
+    CPUID_NEON                  = 0x20000,  ///< ARM Neon
+    CPUID_FMA3                  = 0x40000   ///< Fused Multiply-Add 3
 };
 
 struct CpuInfo {
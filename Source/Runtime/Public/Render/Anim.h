@@ -64,6 +64,25 @@ public:
         int32_t             componentOffset;    ///< Offset of the component buffer for this joint.
     };
 
+    struct TrackChannel {
+        enum Enum {
+            Translation,
+            Rotation,
+            Scale,
+            Count
+        };
+    };
+
+    /// Quantized keys of a translation, rotation or scale channel of a joint.
+    /// Rotation keys are 48 bits smallest three quaternions.
+    /// Translation and scale keys are 16 bits for each axis normalized in [rangeMin, rangeMin + rangeExtent].
+    struct CompressedTrack {
+        int32_t             numKeys;            ///< Number of keys.
+        int32_t             keyOffset;          ///< Offset of the key frame numbers. Key values are at 3 * keyOffset.
+        Vec3                rangeMin;           ///< Minimum of the translation or scale keys.
+        Vec3                rangeExtent;        ///< Extent of the translation or scale keys.
+    };
+
     struct FrameInterpolation {
         int32_t             frame1;             ///< Frame number 1 for interpolation.
         int32_t             frame2;             ///< Frame number 2 for interpolation.
@@ -81,6 +100,9 @@ public:
     bool                    IsDefaultAnim() const { return isDefaultAnim; }
     bool                    IsAdditiveAnim() const { return isAdditiveAnim; }
 
+                            /// Returns true if the components are compressed to the quantized tracks.
+    bool                    IsCompressed() const { return isCompressed; }
+
                             /// Returns number of frames.
     int                     NumFrames() const { return numFrames; }
 
@@ -106,6 +128,10 @@ public:
 
     void                    Purge();
 
+                            /// Compresses the components to the quantized tracks with error-bounded key reduction.
+                            /// positionTolerance is the maximum position error that each joint can add to its descendants.
+    void                    Compress(float positionTolerance = CentiToUnit(0.01f));
+
                             /// Creates additive anim from other anim.
     Anim *                  CreateAdditiveAnim(const Anim *refAnim, int numJointIndexes, const int *jointIndexes);
 
@@ -158,6 +184,13 @@ private:
     bool                    LoadBinaryAnim(const char *filename);
     void                    WriteBinaryAnim(const char *filename);
 
+    void                    DecodeRawFrame(int frameNum, JointPose *frame) const;
+    void                    DecodeCompressedFrame(int frameNum, float frameTime, int numJointIndexes, const int *jointIndexes, JointPose *frame) const;
+    Vec3                    DecodeCompressedVec3(const CompressedTrack &track, int frameNum, float frameTime) const;
+    Quat                    DecodeCompressedQuat(const CompressedTrack &track, int frameNum, float frameTime) const;
+    const CompressedTrack * GetCompressedTrack(int jointIndex, TrackChannel::Enum channel) const;
+    float                   FrameInterpolationToTime(const FrameInterpolation &frameInterpolation) const;
+
     void                    ComputeTotalDelta();
 
     void                    ComputeRemovableFrames(const JointPose *frameJoints, const int *jointIndexes, JointPose *lerpedJoints,
@@ -175,6 +208,7 @@ private:
 
     bool                    isDefaultAnim;
     bool                    isAdditiveAnim;
+    bool                    isCompressed = false;
 
     int                     numJoints = 0;              ///< Number of joints.
     int                     numFrames = 0;              ///< Number of frames.
@@ -187,6 +221,11 @@ private:
     Array<float>            components;                 ///< Components for each animated joints of all frames.
     Array<int>              frameTimes;                 ///< Times for each frames.
     Vec3                    totalDelta = Vec3::zero;    ///< Root translation offset in total animation evaluation.
+
+    Array<int32_t>          jointTracks;                ///< Compressed track index for each channels of joints. -1 for constant channel.
+    Array<CompressedTrack>  compressedTracks;           ///< Compressed tracks.
+    Array<uint16_t>         keyFrameNums;               ///< Frame numbers of the keys of all compressed tracks.
+    Array<uint16_t>         keyValues;                  ///< Quantized values of the keys of all compressed tracks, 3 for each keys.
 };
 
 BE_INLINE Anim::Anim() {
@@ -25,6 +25,8 @@
 #include "Math/Math.h"
 #include "Containers/Array.h"
 #include "Containers/HashMap.h"
+#include "Core/Vertex.h"
+#include "Platform/PlatformThread.h"
 
 class MeshImporter;
 
@@ -38,10 +40,20 @@ class SkinningJointCache;
 class DrawSurf;
 class SubMesh;
 class Ray;
+class File;
+struct BMeshSurf;
 
 class MeshSurf {
 public:
+    static constexpr int    MaxLodLevels = 4;       ///< Maximum number of the simplified levels not including the original
+
+                            /// Returns sub mesh of the given LOD level. LOD level 0 is the original sub mesh.
+                            /// The coarsest one is returned if this surface doesn't have enough levels.
+    SubMesh *               GetLodSubMesh(int lodLevel) const;
+
     SubMesh *               subMesh;
+    int32_t                 numLodLevels;
+    SubMesh *               lodSubMeshes[MaxLodLevels];
     DrawSurf *              drawSurf;
     int32_t                 materialIndex;
     int32_t                 viewCount;
@@ -87,6 +99,8 @@ public:
         };
     };
 
+    static constexpr int    DefaultNumLodLevels = 3;    ///< Number of LOD levels generated when writing a mesh without LODs
+
     Mesh();
     ~Mesh();
 
@@ -120,6 +134,23 @@ public:
 
     void                    OptimizeIndexedTriangles();
 
+                            /// Generates simplified LOD levels of all surfaces using quadric error metric.
+                            /// Each level has reductionRatio times the triangles of the previous level.
+                            /// Surfaces with too few triangles or CPU skinning weights get no LOD levels.
+    void                    GenerateLods(int numLodLevels, float reductionRatio = 0.5f);
+    void                    FreeLods();
+
+    int                     NumLodLevels() const { return numLodLevels; }
+
+                            /// Returns the projected size on screen below which the LOD level is used.
+                            /// Projected size is the ratio of the bounding sphere diameter to the screen height.
+    float                   GetLodScreenSize(int lodLevel) const { assert(lodLevel > 0 && lodLevel <= numLodLevels); return lodScreenSizes[lodLevel - 1]; }
+    void                    SetLodScreenSize(int lodLevel, float screenSize);
+
+                            /// Selects LOD level for the projected size on screen.
+                            /// The current LOD level is kept until the size goes over the threshold by the hysteresis margin.
+    int                     SelectLodLevel(float screenSize, int currentLodLevel) const;
+
     void                    Voxelize();
 
     void                    UpdateSkinningJointCache(const Skeleton *skeleton, const Mat3x4 *joints);
@@ -131,6 +162,11 @@ public:
     bool                    IntersectRay(const Ray &ray, bool ignoreBackFace, float *hitDist = nullptr) const;
     float                   IntersectRay(const Ray &ray, bool ignoreBackFace) const;
 
+                            /// Skins the triangle BVHs of this instantiated skinned mesh to the pose for the ray tests.
+                            /// Vertices are skinned on the CPU only if the skinning joints are changed since the last pose.
+                            /// Ray tests use the bind pose until this is called.
+    void                    PoseTriangleBVHs(const Mat3x4 *skinningJoints);
+
                             /// Returns volume of solid mesh.
                             /// Should be a closed polytope to calculate exactly or AABB approximation.
     float                   ComputeVolume() const;
@@ -151,6 +187,8 @@ public:
     bool                    Load(const char *filename);
     bool                    Reload();
 
+                            /// Writes binary mesh with the indexes optimized for the vertex cache.
+                            /// DefaultNumLodLevels LOD levels are generated if the mesh has no LOD levels.
     void                    Write(const char *filename);
 
     const Mesh *            AddRefCount() const { refCount++; return this; }
@@ -159,6 +197,7 @@ public:
 private:
     void                    FreeSurface(MeshSurf *surf) const;
     MeshSurf *              AllocInstantiatedSurface(const MeshSurf *refSurf, int meshType) const;
+    SubMesh *               AllocLodSubMesh(const SubMesh *subMesh, const TriIndex *lodIndexes, int numLodIndexes) const;
 
     void                    Instantiate(int meshType);
 
@@ -171,7 +210,9 @@ private:
     void                    ComputeEdges();
 
     bool                    LoadBinaryMesh(const char *filename);
+    void                    ReadBinarySubMesh(const BMeshSurf *bMeshSurf, const byte *&ptr, SubMesh *subMesh) const;
     void                    WriteBinaryMesh(const char *filename);
+    void                    WriteBinarySubMesh(File *fp, const SubMesh *subMesh, int materialIndex) const;
 
     Str                     hashName;
     Str                     name;
@@ -187,13 +228,24 @@ private:
     AABB                    aabb = AABB::empty;
     Array<MeshSurf *>       surfaces;
 
+    int32_t                 numLodLevels = 0;
+    float                   lodScreenSizes[MeshSurf::MaxLodLevels];
+
     bool                    useGpuSkinning = false;
-    SkinningJointCache *    skinningJointCache = nullptr;   // joint cache for HW skinning
+    SkinningJointCache *    skinningJointCache = nullptr;   // joint cache for HW skinning and CPU skinning
+
+    Mat3x4 *                posedSkinningJoints = nullptr;  // skinning joints of the posed triangle BVHs
+    PlatformMutex *         poseMutex = nullptr;
 
     int32_t                 numJoints = 0;
     Joint *                 joints = nullptr;               // joint information array
 };
 
+BE_INLINE SubMesh *MeshSurf::GetLodSubMesh(int lodLevel) const {
+    lodLevel = Min(lodLevel, (int)numLodLevels);
+    return lodLevel > 0 ? lodSubMeshes[lodLevel - 1] : subMesh;
+}
+
 BE_INLINE Mesh::Mesh() {
     surfaces.SetGranularity(16);
 }
@@ -23,6 +23,7 @@
 #include "Render/Skin.h"
 #include "Render/Font.h"
 #include "Render/Skeleton.h"
+#include "Render/TriangleBVH.h"
 #include "Render/SubMesh.h"
 #include "Render/Mesh.h"
 #include "Render/ParticleMesh.h"
@@ -109,6 +109,7 @@ public:
         int                 staticMask = 0;
         int                 time = 0;
         float               maxVisDist = MeterToUnit(100);
+        void *              userPointer = nullptr;      ///< Owner of this render object, not used by the renderer
 
         //
         // Transform info
@@ -164,6 +165,10 @@ public:
                             /// Returns view count.
     int                     GetViewCount() const { return viewCount; }
 
+                            /// Returns projected size of the bounding sphere on screen when it was drawn last time.
+                            /// Projected size is the ratio of the bounding sphere diameter to the screen height.
+    float                   GetScreenSize() const { return screenSize; }
+
                             /// Returns state.
     const State &           GetState() const { return state; }
 
@@ -198,6 +203,8 @@ private:
 
     VisObject *             visObject = nullptr;
     int                     viewCount = 0;
+    int                     lodLevel = 0;               // last selected mesh LOD level for hysteresis
+    float                   screenSize = 0.0f;          // projected size in the last view
 
     RenderWorld *           renderWorld;
     int                     index;                      // index of object list in RenderWorld
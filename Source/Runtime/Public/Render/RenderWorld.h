@@ -77,6 +77,11 @@ public:
                             /// Gets RenderObject pointer by given render object handle.
     RenderObject *          GetRenderObject(int handle) const;
 
+                            /// Casts a ray against the world AABBs of the render objects, nearer objects first.
+                            /// callback(renderObject, maxDist) returns the new max distance in the same way as DynamicAABBTree::RayCast().
+    template <typename F>
+    void                    RayCastRenderObjects(const Ray &ray, float maxDist, F &callback) const;
+
                             /// Adds render light to this world.
     int                     AddRenderLight(const RenderLight::State *def);
 
@@ -159,21 +164,35 @@ public:
 private:
     VisObject *             RegisterVisObject(VisCamera *camera, RenderObject *object);
     VisLight *              RegisterVisLight(VisCamera *camera, RenderLight *light);
+    static float            ComputeScreenSize(const VisCamera *camera, const RenderObject *object);
+    int                     SelectMeshLodLevel(const VisCamera *camera, RenderObject *object) const;
+    static bool             IsObjectExcluded(const VisCamera *camera, const RenderObject *object);
+    void                    SetupVisObject(const VisCamera *camera, VisObject *visObject, const DbvtProxy *proxy) const;
+    void                    DebugVisObject(const VisCamera *camera, const VisObject *visObject, const DbvtProxy *proxy);
+    void                    FindVisLights(VisCamera *camera);
     void                    FindVisLightsAndObjects(VisCamera *camera);
+    void                    FindVisLightsAndObjectsParallel(VisCamera *camera);
     void                    AddStaticMeshes(VisCamera *camera);
+    void                    AddStaticMeshesParallel(VisCamera *camera);
     void                    AddSkinnedMeshes(VisCamera *camera);
     void                    AddParticleMeshes(VisCamera *camera);
     void                    AddTextMeshes(VisCamera *camera);
     void                    AddSkyBoxMeshes(VisCamera *camera);
     void                    AddStaticMeshesForLights(VisCamera *camera);
+    void                    AddStaticMeshesForLightsParallel(VisCamera *camera);
     void                    AddSkinnedMeshesForLights(VisCamera *camera);
     void                    AddSubCamera(VisCamera *camera);
-    void                    CacheInstanceBuffer(VisCamera *camera);
+    void                    CacheInstanceBuffer(VisCamera *camera, bool parallel);
+    void                    WriteInstanceData(const VisObject *visObject, const MeshSurf *surf, byte *instanceData) const;
     void                    OptimizeLights(VisCamera *camera);
     void                    AddDrawSurf(VisCamera *camera, VisLight *light, VisObject *entity, const Material *material, SubMesh *subMesh, int flags);
     void                    AddDrawSurfFromAmbient(VisCamera *camera, const VisLight *light, bool shadowVisible, const DrawSurf *ambientDrawSurf);
+    DrawSurf *              AllocDrawSurf(const VisCamera *camera, const VisLight *light, const VisObject *entity, const Material *material, SubMesh *subMesh, int flags) const;
+    DrawSurf *              AllocDrawSurfFromAmbient(const VisLight *light, bool shadowVisible, const DrawSurf *ambientDrawSurf) const;
     void                    SortDrawSurfs(VisCamera *camera);
+    void                    CheckParallelVisibility(const RenderCamera *renderCamera);
 
+    VisCamera *             AllocVisCamera(const RenderCamera *renderCamera) const;
     void                    DrawCamera(VisCamera *camera);
     void                    DrawSubCamera(const VisObject *object, const DrawSurf *drawSurf, const Material *material);
     void                    DrawGUICamera(GuiMesh &guiMesh);
@@ -205,4 +224,14 @@ private:
     DynamicAABBTree         staticMeshDbvt;         ///< Dynamic bounding volume tree for static meshes
 };
 
+template <typename F>
+BE_INLINE void RenderWorld::RayCastRenderObjects(const Ray &ray, float maxDist, F &callback) const {
+    auto rayCastCallback = [this, &callback](int32_t proxyId, float maxDist) -> float {
+        const DbvtProxy *proxy = (const DbvtProxy *)objectDbvt.GetUserData(proxyId);
+        return callback(proxy->renderObject, maxDist);
+    };
+
+    objectDbvt.RayCast(ray, maxDist, rayCastCallback);
+}
+
 BE_NAMESPACE_END
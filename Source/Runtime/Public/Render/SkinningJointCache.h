@@ -20,7 +20,7 @@ class Mat3x4;
 class Skeleton;
 class Batch;
 
-// Joint cache for HW skinning
+// Skinning joint cache for HW skinning and CPU skinning
 class SkinningJointCache {
     friend class Batch;
 
@@ -41,6 +41,9 @@ public:
 
     const BufferCache & GetBufferCache() const { return bufferCache; }
 
+                        // Skinning matrices of the current frame
+    const Mat3x4 *      GetSkinningJoints() const { return skinningJoints + jointIndexOffset[0]; }
+
     void                Update(const Skeleton *skeleton, const Mat3x4 *jointMats);
 
     static bool         CapableGPUJointSkinning(SkinningMethod::Enum skinningMethod, int numJoints);
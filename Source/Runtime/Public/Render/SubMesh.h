@@ -53,6 +53,7 @@ struct JointWeight {
 struct BufferCache;
 
 class Material;
+class TriangleBVH;
 
 class SubMesh {
     friend class Mesh;
@@ -94,11 +95,10 @@ public:
     bool                    IsClosed() const;
 
                             /// Tests if this sub mesh intersect with the given line segment.
-                            /// To use this function, edge information must be pre-calculated.
     bool                    IsIntersectLine(const Vec3 &p1, const Vec3 &p2, bool ignoreBackFace) const;
 
-                            /// Ray intersection.
-                            /// To use this function, edge information must be pre-calculated.
+                            /// Ray intersection. Returns the distance of the closest hit in hitDist.
+                            /// The triangle BVH is built at the first call. Concurrent calls wait for the build.
     bool                    IntersectRay(const Ray &ray, bool ignoreBackFace, float *hitDist = nullptr) const;
 
     const AABB &            GetAABB() const { return aabb; }
@@ -108,20 +108,38 @@ public:
     const Vec3              ComputeCentroid() const;
     const Mat3              ComputeInertiaTensor(const Vec3 &centroid, float mass) const;
 
-    void                    OptimizeIndexedTriangles();
+                            /// Reorders the triangles for the post-transform vertex cache and optionally for the overdraw,
+                            /// then reorders the vertices in the order of first use.
+                            /// Should be called before the data is cached to GPU.
+    void                    OptimizeIndexedTriangles(bool optimizeOverdraw = true);
+
+                            /// Computes the optimized indexes without modifying this sub mesh.
+                            /// dstIndexes refer to the reordered vertices, vertexOrder[newIndex] gives the old vertex index.
+    void                    ComputeOptimizedIndexes(bool optimizeOverdraw, TriIndex *dstIndexes, int *vertexOrder) const;
+
+                            /// Returns average cache miss ratio (per triangle) and average transform to vertex ratio
+                            /// simulated with FIFO post-transform vertex cache.
+    static void             GetVertexCacheStats(const TriIndex *indexes, int numIndexes, int numVerts, float &acmr, float &atvr);
 
     bool                    IsGpuSkinning() const { return useGpuSkinning; }
 
     void                    CacheStaticDataToGpu();
-    void                    CacheDynamicDataToGpu(const Mat3x4 *joints, const Material *material);
+    void                    CacheDynamicDataToGpu(const Material *material);
+                            /// Skins the vertices with the given skinning matrices on the CPU.
+                            /// Large sub meshes are split across the job system workers.
+    void                    SkinVerts(const Mat3x4 *skinningJoints, VertexGenericLit *dstVerts) const;
+                            /// Skins the vertices with the given skinning matrices directly into the dynamic vertex buffer.
+                            /// Indexes are drawn from the static index buffer of the reference sub mesh.
+    void                    CacheSkinnedDataToGpu(const Mat3x4 *skinningJoints);
 
 private:
     void                    AllocSubMesh(int numVerts, int numIndexes);
-    void                    AllocInstantiatedSubMesh(const SubMesh *refMesh, int meshType);
+    void                    AllocInstantiatedSubMesh(const SubMesh *refMesh, int meshType, bool gpuSkinning);
     void                    FreeSubMesh();
 
     void                    SplitMirroredVerts();
     void                    FixMirroredVerts();
+    bool                    CanReorderVerts() const;
 
     void                    ComputeAABB();
     void                    ComputeNormals();
@@ -129,6 +147,14 @@ private:
     void                    ComputeTangents(bool includeNormals, bool useUnsmoothedTangents);
     void                    ComputeEdges();
 
+    const TriangleBVH *     GetTriangleBVH() const;
+    void                    InvalidateTriangleBVH();
+    void                    InvalidateTriangleBVHVertices();
+
+                            // Skins the vertices into the own triangle BVH of instantiated skinned sub mesh for the ray tests.
+                            // Ray tests use the bind pose of the reference sub mesh until this is called.
+    void                    PoseTriangleBVH(const Mat3x4 *skinningJoints);
+
     int                     type;
     bool                    alloced;
     const SubMesh *         refSubMesh;
@@ -161,6 +187,9 @@ private:
 
     AABB                    aabb;                       // AABB in local submesh space
 
+    TriangleBVH *           triangleBVH;                // triangle BVH for ray intersection, built on demand
+    VertexGenericLit *      posedVerts;                 // skinned vertices of the posed triangle BVH of instantiated skinned sub mesh
+
     BufferCache *           vertexCache;
     BufferCache *           indexCache;
 };
@@ -148,6 +148,7 @@ private:
     int                     srcHeight = 0;              // original height
     int                     srcDepth = 0;               // original depth
     int                     numSlices = 0;
+    int                     skippedMipLevels = 0;       // top mip levels already skipped by the image loader
 
     int                     width = 0;                  // scaled width
     int                     height = 0;                 // scaled height
@@ -239,6 +240,7 @@ private:
     static void             Cmd_ListTextures(const CmdArgs &args);
     static void             Cmd_ReloadTexture(const CmdArgs &args);
     static void             Cmd_ConvertNormalAR2RGB(const CmdArgs &args);
+    static void             Cmd_BenchTextureLoad(const CmdArgs &args);
 
     friend void             RB_DrawDebugTextures();
 
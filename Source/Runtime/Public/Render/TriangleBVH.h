@@ -0,0 +1,108 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+/*
+-------------------------------------------------------------------------------
+
+    Triangle BVH
+
+    Bounding volume hierarchy of the triangles of a mesh for ray intersection.
+    The tree is built with binned SAH. Leaves hold blocks of 4 triangles in SoA
+    layout, so a ray is tested against 4 triangles at once with SIMD.
+
+    When only the vertices are changed, the tree is refitted keeping its
+    structure instead of being rebuilt.
+
+-------------------------------------------------------------------------------
+*/
+
+#include "Core/Vertex.h"
+#include "Platform/PlatformThread.h"
+#include <atomic>
+
+BE_NAMESPACE_BEGIN
+
+class TriangleBVH {
+public:
+    TriangleBVH();
+    ~TriangleBVH();
+
+                            /// Returns total size of allocated memory.
+    int                     Allocated() const;
+
+    bool                    IsValid() const { return state.load(std::memory_order_acquire) == State::Valid; }
+
+                            /// Builds the tree from the triangles. The memory of the previous build is reused if possible.
+    void                    Build(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes);
+
+                            /// Recomputes the triangles and the node bounds keeping the tree structure.
+                            /// The number of triangles must be the same as the last build.
+    void                    Refit(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes);
+
+                            /// Builds or refits the tree if it is not valid.
+                            /// Thread-safe, the tree is updated only once when called from multiple threads.
+    void                    Update(const VertexGenericLit *verts, const TriIndex *indexes, int numIndexes);
+
+                            /// Marks the tree to be rebuilt, call this when the triangles are changed.
+    void                    Invalidate() { state = State::NeedsBuild; }
+
+                            /// Marks the tree to be refitted, call this when only the vertices are changed.
+    void                    InvalidateVertices();
+
+    void                    Free();
+
+                            /// Ray intersection within maxDist.
+                            /// If anyHit is true, returns as soon as any triangle is hit, otherwise hitDist is the distance of the closest hit.
+    bool                    IntersectRay(const Ray &ray, bool ignoreBackFace, bool anyHit, float maxDist, float *hitDist = nullptr) const;
+
+private:
+    enum class State {
+        NeedsBuild,
+        NeedsRefit,
+        Valid
+    };
+
+    /// 32 bytes node.
+    struct Node {
+        float               mins[3];
+        int32_t             first;              ///< Index of the left child (right child follows it) for internal node, index of the first block for leaf
+        float               maxs[3];
+        int32_t             numBlocks;          ///< Number of triangle blocks, 0 for internal node
+
+        bool                IsLeaf() const { return numBlocks > 0; }
+    };
+
+    /// 4 triangles in SoA layout. Unused triangles are zero-sized so they are never hit.
+    struct TriangleBlock;
+
+    void                    FillBlock(TriangleBlock &block, const int32_t *triangleIndexes, const VertexGenericLit *verts, const TriIndex *indexes) const;
+
+    std::atomic<State>      state;
+    PlatformMutex *         updateMutex;
+
+    int                     numTriangles;
+
+    int                     numNodes;
+    int                     nodeCapacity;
+    Node *                  nodes;
+
+    int                     numBlocks;
+    int                     blockCapacity;
+    TriangleBlock *         blocks;
+    int32_t *               blockTriangles;     ///< 4 triangle indexes of each block, -1 for unused
+};
+
+BE_NAMESPACE_END
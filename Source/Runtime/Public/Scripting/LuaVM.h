@@ -37,6 +37,15 @@ public:
     const char *            GetLuaJitVersion() const;
     int                     GetLuaMemory() const { return state->GetGCKb() * 1024; }
 
+                            /// Runs incremental garbage collection steps within the time budget of lua_gcBudget.
+                            /// Call this once per frame.
+    void                    CollectGarbage();
+
+                            /// Returns the time spent in the last CollectGarbage() call in microseconds.
+    int                     GetGCTime() const { return gcTime; }
+                            /// Returns the heap size after the last CollectGarbage() call in kilobytes.
+    int                     GetGCHeapKb() const { return gcHeapKb; }
+
     void                    EnableJIT(bool enabled);
 
     void                    ClearTweeners();
@@ -159,6 +168,9 @@ private:
 
     bool                    debuggeeStarted = false;
 
+    int                     gcTime = 0;
+    int                     gcHeapKb = 0;
+
     Array<EngineModuleCallback> engineModuleCallbacks;
 
     const GameWorld *       gameWorld;
@@ -26,10 +26,28 @@
 
 BE_NAMESPACE_BEGIN
 
+class SIMDProcessor;
+
 class SIMD {
 public:
+    struct Type {
+        enum Enum {
+            Generic,
+            SSE4,
+            AVX,
+            Count
+        };
+    };
+
     static void         Init(bool forceGeneric = false);
     static void         Shutdown();
+
+                        /// Returns true if the CPU supports the SIMD processor of the given type.
+    static bool         IsSupported(Type::Enum type);
+
+                        /// Creates a new SIMD processor of the given type.
+                        /// Returns nullptr if the CPU doesn't support it.
+    static SIMDProcessor *CreateProcessor(Type::Enum type);
 };
 
 /*
@@ -86,6 +104,7 @@ public:
     virtual void BE_FASTCALL            UntransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint) = 0;
     virtual void BE_FASTCALL            MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints) = 0;
     virtual void BE_FASTCALL            TransformVerts(VertexGenericLit *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *weights, const int *index, const int numWeights) = 0;
+    virtual void BE_FASTCALL            SkinVerts(VertexGenericLit *dstVerts, const VertexGenericLit *srcVerts, const int numVerts, const Mat3x4 *joints, const void *vertWeights, const int maxVertWeights) = 0;
     virtual void BE_FASTCALL            DeriveTriPlanes(Plane *planes, const VertexGenericLit *verts, const int numVerts, const int *indexes, const int numIndexes) = 0;
 };
 
@@ -49,6 +49,7 @@ public:
     virtual void BE_FASTCALL            UntransformJoints(Mat3x4 *jointMats, const int *parents, const int firstJoint, const int lastJoint);
     virtual void BE_FASTCALL            MultiplyJoints(Mat3x4 *result, const Mat3x4 *joints1, const Mat3x4 *joints2, const int numJoints);
     virtual void BE_FASTCALL            TransformVerts(VertexGenericLit *verts, const int numVerts, const Mat3x4 *joints, const Vec4 *weights, const int *index, const int numWeights);
+    virtual void BE_FASTCALL            SkinVerts(VertexGenericLit *dstVerts, const VertexGenericLit *srcVerts, const int numVerts, const Mat3x4 *joints, const void *vertWeights, const int maxVertWeights);
     virtual void BE_FASTCALL            DeriveTriPlanes(Plane *planes, const VertexGenericLit *verts, const int numVerts, const int *indexes, const int numIndexes);
 };
 
@@ -20,6 +20,8 @@ BE_NAMESPACE_BEGIN
 
 class Entity;
 class Mesh;
+class Ray;
+class ComRenderable;
 
 class StaticBatch {
 public:
@@ -42,10 +44,21 @@ public:
     Mesh *                      GetMesh() const { return referenceMesh; }
     void                        SetMesh(Mesh *mesh) { referenceMesh = mesh; }
 
+                                /// Renderers combined into this batch. Only the renderer of the root entity has a render object.
+    int                         NumRenderables() const { return renderables.Count(); }
+    ComRenderable *             GetRenderable(int index) const { return renderables[index]; }
+    void                        AddRenderable(ComRenderable *renderable) { renderables.Append(renderable); }
+    void                        RemoveRenderable(ComRenderable *renderable) { renderables.Remove(renderable); }
+
+                                /// Tests the ray against each renderer of this batch with its own mesh, because the combined mesh can't tell which renderer is hit.
+                                /// Returns the entity of the closest hit nearer than lastDist and updates lastDist, or nullptr if there is no such hit.
+    Entity *                    IntersectRay(const Ray &ray, bool backFaceCull, int layerMask, const Array<Entity *> &excludingEntities, float &lastDist) const;
+
 private:
     int                         index;
     Entity *                    rootEntity;
     Mesh *                      referenceMesh;
+    Array<ComRenderable *>      renderables;
 
     static Array<StaticBatch *> staticBatches;
 };
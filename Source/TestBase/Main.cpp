@@ -18,6 +18,14 @@
 #include "TestSIMD.h"
 #include "TestCUDA.h"
 #include "TestLua.h"
+#include "TestJobSystem.h"
+#include "TestRadixSort.h"
+#include "TestDynamicAABBTree.h"
+#include "TestImage.h"
+#include "TestMesh.h"
+#include "TestStaticBatch.h"
+#include "TestAnim.h"
+#include "TestBMap.h"
 
 void SystemLog(const int logLevel, const char *msg) {
     printf("%s", msg);
@@ -59,5 +67,21 @@ int main(int argc, char *argv[]) {
 
     TestLua();
 
+    TestJobSystem();
+
+    TestRadixSort();
+
+    TestDynamicAABBTree();
+
+    TestImage();
+
+    TestMesh();
+
+    TestStaticBatch();
+
+    TestAnim();
+
+    TestBMap();
+
     BE1::Engine::ShutdownBase();
 }
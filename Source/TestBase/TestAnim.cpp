@@ -0,0 +1,486 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BlueshiftEngine.h"
+#include "../Runtime/Private/Render/BModel.h"
+#include "TestAnim.h"
+
+static const int NumJoints = 16;
+static const int NumFrames = 120;
+static const int FrameRate = 30;
+
+static const char *rawAnimFilename = "TestAnimRaw.banim";
+static const char *compressedAnimFilename = "TestAnimCompressed.banim";
+static const char *rawCopyAnimFilename = "TestAnimRawCopy.banim";
+static const char *skeletonFilename = "TestAnimSkeleton.bskel";
+static const char *animControllerFilename = "TestAnimController.controller";
+
+static const BE1::Guid skeletonGuid(0x7e57a000, 0, 0, 1);
+static const BE1::Guid rawAnimGuid(0x7e57a000, 0, 0, 2);
+
+static const int NumAnimators = 8;
+static const int NumUpdateFrames = 240;
+static const int UpdateFrameMsec = 16;
+
+// Chain of 8 joints with a branch of 8 joints from the middle of it.
+static int ParentIndex(int jointIndex) {
+    return jointIndex < 8 ? jointIndex - 1 : jointIndex - 6;
+}
+
+static int ComponentBits(int jointIndex) {
+    if (jointIndex == 0) {
+        return BE1::Anim::ComponentBit::Tx | BE1::Anim::ComponentBit::Ty | BE1::Anim::ComponentBit::Tz |
+            BE1::Anim::ComponentBit::Qx | BE1::Anim::ComponentBit::Qy | BE1::Anim::ComponentBit::Qz;
+    }
+    if (jointIndex == NumJoints - 1) {
+        return 0;
+    }
+    switch (jointIndex % 4) {
+    case 1:
+        return BE1::Anim::ComponentBit::Qx | BE1::Anim::ComponentBit::Qy | BE1::Anim::ComponentBit::Qz;
+    case 2:
+        return BE1::Anim::ComponentBit::Tx | BE1::Anim::ComponentBit::Ty | BE1::Anim::ComponentBit::Tz |
+            BE1::Anim::ComponentBit::Qx | BE1::Anim::ComponentBit::Qy | BE1::Anim::ComponentBit::Qz;
+    case 3:
+        return BE1::Anim::ComponentBit::Qx | BE1::Anim::ComponentBit::Qy | BE1::Anim::ComponentBit::Qz |
+            BE1::Anim::ComponentBit::Sx | BE1::Anim::ComponentBit::Sy | BE1::Anim::ComponentBit::Sz;
+    default:
+        return BE1::Anim::ComponentBit::Ty | BE1::Anim::ComponentBit::Qz;
+    }
+}
+
+// Smooth motion of the joint. Only the components in the component bits are animated.
+static BE1::JointPose JointPoseAt(int jointIndex, int frameNum) {
+    const int componentBits = ComponentBits(jointIndex);
+    const float phase = BE1::Math::TwoPi * frameNum / NumFrames;
+
+    BE1::JointPose pose;
+    pose.t = jointIndex == 0 ? BE1::Vec3::zero : BE1::Vec3(0.05f * BE1::Math::Sin((float)jointIndex), 0.15f, 0.05f * BE1::Math::Cos((float)jointIndex));
+    pose.q = BE1::Quat::identity;
+    pose.s = BE1::Vec3::one;
+
+    for (int i = 0; i < 3; i++) {
+        if (componentBits & (BE1::Anim::ComponentBit::Tx << i)) {
+            pose.t[i] += 0.02f * BE1::Math::Sin(phase * 2 + jointIndex + i);
+        }
+    }
+
+    BE1::Vec3 axis(BE1::Math::Sin((float)jointIndex), BE1::Math::Cos(2.0f * jointIndex), 0.5f);
+    for (int i = 0; i < 3; i++) {
+        if (!(componentBits & (BE1::Anim::ComponentBit::Qx << i))) {
+            axis[i] = 0.0f;
+        }
+    }
+    if (axis.Normalize() > 0.0f) {
+        // Half angle is less than 90 degrees so w is positive as the decoder assumes.
+        const float halfAngle = 0.3f * BE1::Math::Sin(phase * (1 + jointIndex % 3) + jointIndex);
+        const BE1::Vec3 v = axis * BE1::Math::Sin(halfAngle);
+        pose.q = BE1::Quat(v.x, v.y, v.z, BE1::Math::Cos(halfAngle));
+    }
+
+    // Joint 11 has constant scale channel to be stripped.
+    const float scaleAmplitude = jointIndex == 11 ? 0.0f : 0.1f;
+    for (int i = 0; i < 3; i++) {
+        if (componentBits & (BE1::Anim::ComponentBit::Sx << i)) {
+            pose.s[i] += scaleAmplitude * BE1::Math::Sin(phase + jointIndex * i);
+        }
+    }
+    return pose;
+}
+
+// Writes the raw anim in .banim format.
+static bool WriteRawAnim(const char *filename) {
+    BE1::File *fp = BE1::fileSystem.OpenFile(filename, BE1::File::Mode::Write);
+    if (!fp) {
+        return false;
+    }
+
+    int componentOffsets[NumJoints];
+    int numComponentsPerFrame = 0;
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        componentOffsets[jointIndex] = numComponentsPerFrame;
+
+        for (int componentBits = ComponentBits(jointIndex); componentBits; componentBits &= componentBits - 1) {
+            numComponentsPerFrame++;
+        }
+    }
+
+    BE1::BAnimHeader bAnimHeader;
+    bAnimHeader.ident = BANIM_IDENT;
+    bAnimHeader.version = BANIM_VERSION;
+    bAnimHeader.flags = BE1::BAnimFlag::RootTranslationXY | BE1::BAnimFlag::RootTranslationZ | BE1::BAnimFlag::RootRotation;
+    bAnimHeader.numJoints = NumJoints;
+    bAnimHeader.numFrames = NumFrames;
+    bAnimHeader.numComponentsPerFrame = numComponentsPerFrame;
+    bAnimHeader.length = (NumFrames - 1) * 1000 / FrameRate;
+    bAnimHeader.maxCycleCount = 0;
+    fp->Write(&bAnimHeader, sizeof(bAnimHeader));
+
+    int frameTimesCount = NumFrames;
+    fp->Write(&frameTimesCount, sizeof(frameTimesCount));
+    for (int frameNum = 0; frameNum < NumFrames; frameNum++) {
+        int frameTime = frameNum * 1000 / FrameRate;
+        fp->Write(&frameTime, sizeof(frameTime));
+    }
+
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        BE1::BAnimJoint bAnimJoint;
+        BE1::Str::Copynz(bAnimJoint.name, BE1::va("joint%i", jointIndex), sizeof(bAnimJoint.name));
+        bAnimJoint.parentIndex = ParentIndex(jointIndex);
+        bAnimJoint.componentBits = ComponentBits(jointIndex);
+        bAnimJoint.componentOffset = componentOffsets[jointIndex];
+        fp->Write(&bAnimJoint, sizeof(bAnimJoint));
+    }
+
+    // Base frame is the first frame.
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        BE1::JointPose pose = JointPoseAt(jointIndex, 0);
+        fp->Write(&pose.q, sizeof(pose.q));
+        fp->Write(&pose.t, sizeof(pose.t));
+        fp->Write(&pose.s, sizeof(pose.s));
+    }
+
+    // Components are in the order of the component bits.
+    for (int frameNum = 0; frameNum < NumFrames; frameNum++) {
+        for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+            BE1::JointPose pose = JointPoseAt(jointIndex, frameNum);
+            float components[9] = { pose.t.x, pose.t.y, pose.t.z, pose.q.x, pose.q.y, pose.q.z, pose.s.x, pose.s.y, pose.s.z };
+
+            for (int i = 0; i < 9; i++) {
+                if (ComponentBits(jointIndex) & BIT(i)) {
+                    fp->Write(&components[i], sizeof(components[i]));
+                }
+            }
+        }
+    }
+
+    BE1::Vec3 totalDelta = BE1::Vec3::zero;
+    fp->Write(&totalDelta, sizeof(totalDelta));
+
+    BE1::fileSystem.CloseFile(fp);
+    return true;
+}
+
+// Writes the skeleton of the raw anim in .bskel format. Bind poses are the first frame.
+static bool WriteSkeleton(const char *filename) {
+    BE1::File *fp = BE1::fileSystem.OpenFile(filename, BE1::File::Mode::Write);
+    if (!fp) {
+        return false;
+    }
+
+    BE1::BSkelHeader bSkelHeader;
+    bSkelHeader.ident = BSKEL_IDENT;
+    bSkelHeader.version = BSKEL_VERSION;
+    bSkelHeader.numJoints = NumJoints;
+    bSkelHeader.padding = 0;
+    fp->Write(&bSkelHeader, sizeof(bSkelHeader));
+
+    int parents[NumJoints];
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        parents[jointIndex] = ParentIndex(jointIndex);
+
+        BE1::BJoint bJoint;
+        BE1::Str::Copynz(bJoint.name, BE1::va("joint%i", jointIndex), sizeof(bJoint.name));
+        bJoint.parentIndex = parents[jointIndex];
+        fp->Write(&bJoint, sizeof(bJoint));
+    }
+
+    BE1::JointPose bindPoses[NumJoints];
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        bindPoses[jointIndex] = JointPoseAt(jointIndex, 0);
+        fp->Write(&bindPoses[jointIndex].q, sizeof(bindPoses[jointIndex].q));
+        fp->Write(&bindPoses[jointIndex].t, sizeof(bindPoses[jointIndex].t));
+        fp->Write(&bindPoses[jointIndex].s, sizeof(bindPoses[jointIndex].s));
+    }
+
+    BE1::Mat3x4 bindPoseMats[NumJoints];
+    BE1::simdGeneric->ConvertJointPosesToJointMats(bindPoseMats, bindPoses, NumJoints);
+    BE1::simdGeneric->TransformJoints(bindPoseMats, parents, 1, NumJoints - 1);
+
+    for (int jointIndex = 0; jointIndex < NumJoints; jointIndex++) {
+        BE1::Mat3x4 invBindPoseMat = bindPoseMats[jointIndex].Inverse();
+        fp->Write(&invBindPoseMat, sizeof(invBindPoseMat));
+    }
+
+    BE1::fileSystem.CloseFile(fp);
+    return true;
+}
+
+// Writes the anim controller with two states playing the raw anim.
+static bool WriteAnimController(const char *filename) {
+    BE1::File *fp = BE1::fileSystem.OpenFile(filename, BE1::File::Mode::Write);
+    if (!fp) {
+        return false;
+    }
+
+    fp->Printf("animController {\n");
+    fp->Printf("  skeleton \"%s\"\n", skeletonGuid.ToString());
+    fp->Printf("  baseLayer {\n");
+    fp->Printf("    state \"Walk\" {\n");
+    fp->Printf("      animClip \"%s\"\n", rawAnimGuid.ToString());
+    fp->Printf("      default\n");
+    fp->Printf("    }\n");
+    fp->Printf("    state \"Run\" {\n");
+    fp->Printf("      animClip \"%s\"\n", rawAnimGuid.ToString());
+    fp->Printf("    }\n");
+    fp->Printf("  }\n");
+    fp->Printf("}\n");
+
+    BE1::fileSystem.CloseFile(fp);
+    return true;
+}
+
+static void GetJointPositions(const BE1::Anim &anim, int frameNum, BE1::Vec3 *positions) {
+    int jointIndexes[NumJoints];
+    int parents[NumJoints];
+    for (int i = 0; i < NumJoints; i++) {
+        jointIndexes[i] = i;
+        parents[i] = anim.GetJointInfo(i).parentIndex;
+    }
+
+    BE1::JointPose frame[NumJoints];
+    anim.GetSingleFrame(frameNum, NumJoints, jointIndexes, frame);
+
+    BE1::Mat3x4 jointMats[NumJoints];
+    BE1::simdGeneric->ConvertJointPosesToJointMats(jointMats, frame, NumJoints);
+    BE1::simdGeneric->TransformJoints(jointMats, parents, 0, NumJoints - 1);
+
+    for (int i = 0; i < NumJoints; i++) {
+        positions[i] = jointMats[i].ToTranslationVec3();
+    }
+}
+
+static bool FramesEqual(const BE1::Anim &anim1, const BE1::Anim &anim2) {
+    if (anim1.NumFrames() != anim2.NumFrames() || anim1.NumJoints() != anim2.NumJoints()) {
+        return false;
+    }
+
+    int jointIndexes[NumJoints];
+    for (int i = 0; i < NumJoints; i++) {
+        jointIndexes[i] = i;
+    }
+
+    for (int frameNum = 0; frameNum < anim1.NumFrames(); frameNum++) {
+        BE1::JointPose frame1[NumJoints];
+        BE1::JointPose frame2[NumJoints];
+        anim1.GetSingleFrame(frameNum, NumJoints, jointIndexes, frame1);
+        anim2.GetSingleFrame(frameNum, NumJoints, jointIndexes, frame2);
+
+        if (memcmp(frame1, frame2, sizeof(frame1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compressed joint positions must be within the tolerance of each channel of the joint and its ancestors.
+static void TestCompressionError() {
+    const float tolerance = BE1::CentiToUnit(0.01f);
+
+    BE1::Anim rawAnim;
+    BE1::Anim compressedAnim;
+    rawAnim.Load(rawAnimFilename);
+    compressedAnim.Load(rawAnimFilename);
+    compressedAnim.Compress(tolerance);
+
+    assert(!rawAnim.IsCompressed() && rawAnim.NumJoints() == NumJoints && rawAnim.NumFrames() == NumFrames);
+    assert(compressedAnim.IsCompressed());
+    assert(compressedAnim.Allocated() < rawAnim.Allocated());
+
+    int depths[NumJoints];
+    for (int i = 0; i < NumJoints; i++) {
+        depths[i] = ParentIndex(i) >= 0 ? depths[ParentIndex(i)] + 1 : 0;
+    }
+
+    float maxError = 0.0f;
+
+    for (int frameNum = 0; frameNum < NumFrames; frameNum++) {
+        BE1::Vec3 rawPositions[NumJoints];
+        BE1::Vec3 compressedPositions[NumJoints];
+        GetJointPositions(rawAnim, frameNum, rawPositions);
+        GetJointPositions(compressedAnim, frameNum, compressedPositions);
+
+        for (int i = 0; i < NumJoints; i++) {
+            float error = rawPositions[i].Distance(compressedPositions[i]);
+            maxError = BE1::Max(maxError, error);
+
+            // Translation, rotation and scale errors of the joint and its ancestors.
+            assert(error <= 3.0f * tolerance * (depths[i] + 1));
+        }
+    }
+
+    BE_LOG("Anim compression: %s -> %s, max error %.3f mm\n",
+        BE1::Str::FormatBytes((int)rawAnim.Allocated()).c_str(), BE1::Str::FormatBytes((int)compressedAnim.Allocated()).c_str(), BE1::UnitToCenti(maxError) * 10.0f);
+}
+
+// Written anims must be decoded the same after reloading.
+static void TestWriteRead() {
+    BE1::Anim rawAnim;
+    rawAnim.Load(rawAnimFilename);
+    rawAnim.Write(rawCopyAnimFilename);
+
+    BE1::Anim rawCopyAnim;
+    rawCopyAnim.Load(rawCopyAnimFilename);
+
+    assert(!rawCopyAnim.IsCompressed());
+    assert(FramesEqual(rawAnim, rawCopyAnim));
+
+    BE1::Anim compressedAnim;
+    compressedAnim.Load(rawAnimFilename);
+    compressedAnim.Compress();
+    compressedAnim.Write(compressedAnimFilename);
+
+    BE1::Anim compressedCopyAnim;
+    compressedCopyAnim.Load(compressedAnimFilename);
+
+    assert(compressedCopyAnim.IsCompressed());
+    assert(compressedCopyAnim.Allocated() == compressedAnim.Allocated());
+    assert(FramesEqual(compressedAnim, compressedCopyAnim));
+}
+
+struct AnimatorsUpdate {
+    BE1::Animator *         animators;
+    int                     currentTime;
+};
+
+// Runs the animators as ComAnimator::Update() does with anim_parallelUpdate 0 or 1.
+// Records the root motion deltas read before and after the frames are computed, and the computed joint matrices.
+static void RunAnimators(bool parallelUpdate, BE1::Vec3 *translationDeltas, BE1::Mat3x4 *jointMats) {
+    BE1::Entity *entities[NumAnimators];
+    BE1::Animator animators[NumAnimators];
+
+    for (int i = 0; i < NumAnimators; i++) {
+        entities[i] = static_cast<BE1::Entity *>(BE1::Entity::metaObject.CreateInstance(BE1::Guid::zero));
+
+        animators[i].SetAnimController(animControllerFilename);
+        assert(animators[i].NumJoints() == NumJoints);
+
+        animators[i].ResetState(0);
+    }
+
+    int previousTime = 0;
+
+    for (int frameIndex = 0; frameIndex < NumUpdateFrames; frameIndex++) {
+        const int currentTime = (frameIndex + 1) * UpdateFrameMsec;
+
+        // Entity updates
+        for (int i = 0; i < NumAnimators; i++) {
+            // Staggered transitions, so that the animators blend the states at the different times
+            if (frameIndex % 60 == i * 7) {
+                animators[i].TransitState(0, (frameIndex / 60) & 1 ? "Walk" : "Run", currentTime, (float)i / NumAnimators, 250, false);
+            }
+
+            animators[i].UpdateFrame(entities[i], previousTime, currentTime);
+
+            if (!parallelUpdate) {
+                animators[i].ComputeFrame(currentTime);
+            }
+
+            animators[i].GetTranslationDelta(previousTime, currentTime, translationDeltas[(frameIndex * NumAnimators + i) * 2]);
+        }
+
+        if (parallelUpdate) {
+            AnimatorsUpdate update;
+            update.animators = animators;
+            update.currentTime = currentTime;
+
+            BE1::jobSystem.ParallelFor(NumAnimators, 1, [](void *data, int begin, int end) {
+                const AnimatorsUpdate *update = (const AnimatorsUpdate *)data;
+
+                for (int i = begin; i < end; i++) {
+                    update->animators[i].ComputeFrame(update->currentTime);
+                }
+            }, &update);
+        }
+
+        // Late updates
+        for (int i = 0; i < NumAnimators; i++) {
+            animators[i].GetTranslationDelta(previousTime, currentTime, translationDeltas[(frameIndex * NumAnimators + i) * 2 + 1]);
+
+            memcpy(&jointMats[(frameIndex * NumAnimators + i) * NumJoints], animators[i].GetFrame(), NumJoints * sizeof(jointMats[0]));
+        }
+
+        previousTime = currentTime;
+    }
+
+    for (int i = 0; i < NumAnimators; i++) {
+        animators[i].ClearAnimController();
+
+        BE1::Entity::DestroyInstanceImmediate(entities[i]);
+    }
+}
+
+// Root motion and the joint matrices must be the same whether the animator frames are computed in parallel or not.
+static void TestAnimatorParallelUpdate() {
+    if (!WriteSkeleton(skeletonFilename) || !WriteAnimController(animControllerFilename)) {
+        BE_WARNLOG("TestAnimatorParallelUpdate: failed to write '%s'\n", animControllerFilename);
+        return;
+    }
+
+    BE1::resourceGuidMapper.Set(skeletonGuid, skeletonFilename);
+    BE1::resourceGuidMapper.Set(rawAnimGuid, rawAnimFilename);
+
+    BE1::skeletonManager.Init();
+    BE1::animManager.Init();
+    BE1::animControllerManager.Init();
+
+    const int numDeltas = NumUpdateFrames * NumAnimators * 2;
+    const int numJointMats = NumUpdateFrames * NumAnimators * NumJoints;
+
+    BE1::Vec3 *serialDeltas = new BE1::Vec3[numDeltas];
+    BE1::Vec3 *parallelDeltas = new BE1::Vec3[numDeltas];
+    BE1::Mat3x4 *serialJointMats = new BE1::Mat3x4[numJointMats];
+    BE1::Mat3x4 *parallelJointMats = new BE1::Mat3x4[numJointMats];
+
+    RunAnimators(false, serialDeltas, serialJointMats);
+    RunAnimators(true, parallelDeltas, parallelJointMats);
+
+    // Root motion is not zero, otherwise this test would not tell anything
+    float totalDistance = 0.0f;
+    for (int i = 0; i < numDeltas; i++) {
+        totalDistance += serialDeltas[i].Length();
+    }
+    assert(totalDistance > 0.0f);
+
+    assert(!memcmp(serialDeltas, parallelDeltas, numDeltas * sizeof(serialDeltas[0])));
+    assert(!memcmp(serialJointMats, parallelJointMats, numJointMats * sizeof(serialJointMats[0])));
+
+    delete [] serialDeltas;
+    delete [] parallelDeltas;
+    delete [] serialJointMats;
+    delete [] parallelJointMats;
+
+    BE1::animControllerManager.Shutdown();
+    BE1::animManager.Shutdown();
+    BE1::skeletonManager.Shutdown();
+
+    BE1::fileSystem.RemoveFile(skeletonFilename, true);
+    BE1::fileSystem.RemoveFile(animControllerFilename, true);
+}
+
+void TestAnim() {
+    if (!WriteRawAnim(rawAnimFilename)) {
+        BE_WARNLOG("TestAnim: failed to write '%s'\n", rawAnimFilename);
+        return;
+    }
+
+    TestCompressionError();
+    TestWriteRead();
+    TestAnimatorParallelUpdate();
+
+    BE1::fileSystem.RemoveFile(rawAnimFilename, true);
+    BE1::fileSystem.RemoveFile(rawCopyAnimFilename, true);
+    BE1::fileSystem.RemoveFile(compressedAnimFilename, true);
+}
@@ -0,0 +1,215 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "../Runtime/Private/Game/BMap.h"
+#include "TestBMap.h"
+
+static const char *jsonMapFilename = "TestBMap.map";
+static const char *bMapFilename = "TestBMap.bmap";
+static const char *corruptBMapFilename = "TestBMapCorrupt.bmap";
+
+static Json::Value MakeEntityValue(const char *name, const BE1::Guid &parentGuid, const BE1::Vec3 &origin, bool active) {
+    Json::Value transformValue;
+    transformValue["classname"] = BE1::ComTransform::metaObject.ClassName();
+    transformValue["guid"] = BE1::Guid::CreateGuid().ToString();
+    transformValue["origin"] = origin.ToString();
+    transformValue["angles"] = BE1::Angles(10.0f, 20.0f, 30.0f).ToString();
+    transformValue["scale"] = BE1::Vec3(1.0f, 2.0f, 3.0f).ToString();
+
+    Json::Value entityValue;
+    entityValue["classname"] = BE1::Entity::metaObject.ClassName();
+    entityValue["guid"] = BE1::Guid::CreateGuid().ToString();
+    entityValue["parent"] = parentGuid.ToString();
+    entityValue["name"] = name;
+    entityValue["tag"] = "TestTag";
+    entityValue["layer"] = 3;
+    entityValue["staticMask"] = 5;
+    entityValue["active"] = active;
+    entityValue["components"].append(transformValue);
+
+    return entityValue;
+}
+
+static bool WriteJsonMap(const char *filename, Json::Value &entitiesValue) {
+    entitiesValue.append(MakeEntityValue("Root", BE1::Guid::zero, BE1::Vec3(1.0f, 2.0f, 3.0f), true));
+    entitiesValue.append(MakeEntityValue("Child", BE1::Guid::FromString(entitiesValue[0]["guid"].asCString()), BE1::Vec3(-4.5f, 0.25f, 100.0f), false));
+
+    Json::Value mapValue;
+    mapValue["version"] = 1;
+    mapValue["renderSettings"]["classname"] = BE1::MapRenderSettings::metaObject.ClassName();
+    mapValue["entities"] = entitiesValue;
+
+    Json::StyledWriter jsonWriter;
+    BE1::Str jsonText = jsonWriter.write(mapValue).c_str();
+
+    BE1::fileSystem.WriteFile(filename, jsonText.c_str(), jsonText.Length());
+
+    return BE1::fileSystem.FileExists(filename);
+}
+
+// Serializes the properties except for GUID which differs for each instance.
+static Json::Value SerializeProperties(const BE1::Serializable *object) {
+    Json::Value value;
+    object->BE1::Serializable::Serialize(value);
+    value.removeMember("guid");
+    return value;
+}
+
+// Objects set by the cooked map should have the same properties with the objects deserialized from JSON.
+static void TestJsonEquivalence(const Json::Value &entitiesValue) {
+    BE1::BMapReader reader;
+    bool opened = reader.Open(bMapFilename);
+    assert(opened);
+    assert(reader.NumEntities() == entitiesValue.size());
+
+    int objectIndex = 0;
+
+    for (int entityIndex = 0; entityIndex < entitiesValue.size(); entityIndex++) {
+        const Json::Value &entityValue = entitiesValue[entityIndex];
+        const Json::Value &componentsValue = entityValue["components"];
+
+        const BE1::BMapEntity &bEntity = reader.entities[entityIndex];
+        assert(bEntity.numComponents == componentsValue.size());
+        assert(reader.guids[reader.objects[bEntity.objectIndex].guidIndex] == BE1::Guid::FromString(entityValue["guid"].asCString()));
+        assert(bEntity.objectIndex > objectIndex);
+        objectIndex = bEntity.objectIndex;
+
+        BE1::Entity *jsonEntity = static_cast<BE1::Entity *>(BE1::Entity::metaObject.CreateInstance(BE1::Guid::zero));
+        BE1::Entity *bMapEntity = static_cast<BE1::Entity *>(BE1::Entity::metaObject.CreateInstance(BE1::Guid::zero));
+
+        jsonEntity->BE1::Serializable::Deserialize(entityValue);
+        reader.ReadObject(bEntity.objectIndex, bMapEntity);
+
+        assert(SerializeProperties(jsonEntity) == SerializeProperties(bMapEntity));
+
+        for (int componentIndex = 0; componentIndex < componentsValue.size(); componentIndex++) {
+            const Json::Value &componentValue = componentsValue[componentIndex];
+            const BE1::MetaObject *metaComponent = BE1::Object::FindMetaObject(componentValue["classname"].asCString());
+
+            BE1::Component *jsonComponent = static_cast<BE1::Component *>(metaComponent->CreateInstance(BE1::Guid::zero));
+            BE1::Component *bMapComponent = static_cast<BE1::Component *>(metaComponent->CreateInstance(BE1::Guid::zero));
+            jsonComponent->SetEntity(jsonEntity);
+            bMapComponent->SetEntity(bMapEntity);
+
+            jsonComponent->BE1::Serializable::Deserialize(componentValue);
+            reader.ReadObject(bEntity.objectIndex + 1 + componentIndex, bMapComponent);
+
+            assert(SerializeProperties(jsonComponent) == SerializeProperties(bMapComponent));
+
+            // Destroyed with the entity
+            jsonEntity->AddComponent(jsonComponent);
+            bMapEntity->AddComponent(bMapComponent);
+        }
+
+        BE1::Entity::DestroyInstanceImmediate(jsonEntity);
+        BE1::Entity::DestroyInstanceImmediate(bMapEntity);
+    }
+}
+
+// Writes a copy of the cooked map which is corrupted by the given function, and then checks it fails to open.
+template <typename CorruptFunc>
+static void TestCorruptFile(const BE1::Array<byte> &bMapData, CorruptFunc corrupt) {
+    BE1::Array<byte> corruptData = bMapData;
+    int size = corruptData.Count();
+    corrupt(corruptData.Ptr(), size);
+
+    BE1::fileSystem.WriteFile(corruptBMapFilename, corruptData.Ptr(), size);
+
+    BE1::BMapReader reader;
+    bool opened = reader.Open(corruptBMapFilename);
+    assert(!opened);
+    assert(reader.NumEntities() == 0);
+}
+
+static void TestCorruptFiles() {
+    byte *data = nullptr;
+    size_t size = BE1::fileSystem.LoadFile(bMapFilename, true, (void **)&data);
+    assert(data);
+
+    BE1::Array<byte> bMapData;
+    bMapData.SetCount((int)size);
+    memcpy(bMapData.Ptr(), data, size);
+    BE1::fileSystem.FreeFile(data);
+
+    const BE1::BMapHeader header = *(const BE1::BMapHeader *)bMapData.Ptr();
+
+    // Truncated in the values
+    TestCorruptFile(bMapData, [](byte *data, int &size) {
+        size -= 4;
+    });
+
+    // String offset out of the string data
+    TestCorruptFile(bMapData, [&header](byte *data, int &size) {
+        ((uint32_t *)(data + header.stringsOffset))[0] = 0x7FFFFFFF;
+    });
+
+    // Last string not terminated before the GUIDs
+    TestCorruptFile(bMapData, [&header](byte *data, int &size) {
+        data[header.guidsOffset - 1] = 'x';
+    });
+
+    // Value blob of the last object runs past the end of the values
+    TestCorruptFile(bMapData, [&header](byte *data, int &size) {
+        BE1::BMapObject *objects = (BE1::BMapObject *)(data + header.objectsOffset);
+        objects[header.numObjects - 1].valueOffset = header.valuesSize - 2;
+    });
+
+    // GUID and string indexes in the values out of the tables
+    TestCorruptFile(bMapData, [&header](byte *data, int &size) {
+        uint32_t *values = (uint32_t *)(data + header.valuesOffset);
+        for (uint32_t i = 0; i < header.valuesSize / sizeof(uint32_t); i++) {
+            values[i] = 0xFFFFFFF0;
+        }
+    });
+
+    // Component object which is an entity class
+    TestCorruptFile(bMapData, [&header](byte *data, int &size) {
+        const BE1::BMapEntity *entities = (const BE1::BMapEntity *)(data + header.entitiesOffset);
+        BE1::BMapObject *objects = (BE1::BMapObject *)(data + header.objectsOffset);
+        objects[entities[0].objectIndex + 1].classIndex = objects[entities[0].objectIndex].classIndex;
+    });
+}
+
+void TestBMap() {
+    // Object system is not initialized by Engine::InitBase()
+    BE1::EventSystem::Init();
+    BE1::SignalSystem::Init();
+    BE1::Object::Init();
+
+    BE1::Object::RegisterProperties();
+    BE1::Component::RegisterProperties();
+    BE1::ComTransform::RegisterProperties();
+    BE1::Entity::RegisterProperties();
+    BE1::MapRenderSettings::RegisterProperties();
+
+    Json::Value entitiesValue;
+
+    if (!WriteJsonMap(jsonMapFilename, entitiesValue)) {
+        BE_WARNLOG("TestBMap: failed to write '%s'\n", jsonMapFilename);
+    } else if (!BE1::GameWorld::CookMap(jsonMapFilename, bMapFilename)) {
+        BE_WARNLOG("TestBMap: failed to cook '%s'\n", jsonMapFilename);
+    } else {
+        TestJsonEquivalence(entitiesValue);
+        TestCorruptFiles();
+    }
+
+    BE1::fileSystem.RemoveFile(jsonMapFilename, true);
+    BE1::fileSystem.RemoveFile(bMapFilename, true);
+    BE1::fileSystem.RemoveFile(corruptBMapFilename, true);
+
+    BE1::Object::Shutdown();
+    BE1::EventSystem::Shutdown();
+    BE1::SignalSystem::Shutdown();
+}
@@ -0,0 +1,376 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "TestDynamicAABBTree.h"
+
+static uint32_t randomSeed;
+
+static float RandomFloat(float min, float max) {
+    randomSeed = randomSeed * 1664525 + 1013904223;
+    return min + (max - min) * ((randomSeed >> 8) / (float)(1 << 24));
+}
+
+static BE1::AABB RandomAABB() {
+    BE1::Vec3 center(RandomFloat(-500.0f, 500.0f), RandomFloat(-500.0f, 500.0f), RandomFloat(-50.0f, 50.0f));
+    BE1::Vec3 extents(RandomFloat(0.5f, 5.0f), RandomFloat(0.5f, 5.0f), RandomFloat(0.5f, 5.0f));
+    return BE1::AABB(center - extents, center + extents);
+}
+
+static BE1::Frustum RandomFrustum() {
+    BE1::Frustum frustum;
+    frustum.SetOrigin(BE1::Vec3(RandomFloat(-500.0f, 500.0f), RandomFloat(-500.0f, 500.0f), 0.0f));
+    frustum.SetAxis(BE1::Angles(RandomFloat(0.0f, 360.0f), RandomFloat(-30.0f, 30.0f), 0.0f).ToMat3());
+    frustum.SetSize(1.0f, RandomFloat(100.0f, 600.0f), RandomFloat(50.0f, 200.0f), RandomFloat(50.0f, 200.0f));
+    return frustum;
+}
+
+template <typename BV>
+static void QueryAll(const BE1::DynamicAABBTree &tree, const BV &boundingVolume, BE1::Array<int32_t> &result) {
+    auto callback = [&result](int32_t proxyId) -> bool {
+        result.Append(proxyId);
+        return true;
+    };
+
+    tree.Query(boundingVolume, callback);
+}
+
+// Queries the subtrees one by one and concatenates the results, as the parallel query does.
+template <typename BV>
+static void QuerySubtrees(const BE1::DynamicAABBTree &tree, const BV &boundingVolume, int maxSubtrees, BE1::Array<int32_t> &result) {
+    BE1::Array<int32_t> subtrees;
+    tree.GetQuerySubtrees(boundingVolume, maxSubtrees, subtrees);
+
+    assert(subtrees.Count() <= maxSubtrees);
+
+    auto callback = [&result](int32_t proxyId) -> bool {
+        result.Append(proxyId);
+        return true;
+    };
+
+    for (int i = 0; i < subtrees.Count(); i++) {
+        tree.QuerySubtree(boundingVolume, subtrees[i], callback);
+    }
+}
+
+static bool IsIntersectProxy(const BE1::Sphere &sphere, const BE1::AABB &aabb) { return sphere.IsIntersectAABB(aabb); }
+static bool IsIntersectProxy(const BE1::AABB &box, const BE1::AABB &aabb) { return box.IsIntersectAABB(aabb); }
+static bool IsIntersectProxy(const BE1::OBB &obb, const BE1::AABB &aabb) { return obb.IsIntersectOBB(BE1::OBB(aabb)); }
+static bool IsIntersectProxy(const BE1::Frustum &frustum, const BE1::AABB &aabb) { return !frustum.CullAABB(aabb); }
+
+// Query() reports the proxies found by brute force, and the subtree queries report them in the same order as Query().
+template <typename BV>
+static void CompareQuery(const BE1::DynamicAABBTree &tree, const BE1::Array<int32_t> &proxies, const BV &boundingVolume) {
+    BE1::Array<int32_t> result;
+    QueryAll(tree, boundingVolume, result);
+
+    BE1::Array<int32_t> sortedResult = result;
+    sortedResult.Sort();
+
+    BE1::Array<int32_t> bruteForceResult;
+    for (int i = 0; i < proxies.Count(); i++) {
+        if (IsIntersectProxy(boundingVolume, tree.GetFatAABB(proxies[i]))) {
+            bruteForceResult.Append(proxies[i]);
+        }
+    }
+    bruteForceResult.Sort();
+
+    assert(sortedResult.Count() == bruteForceResult.Count());
+    for (int i = 0; i < sortedResult.Count(); i++) {
+        assert(sortedResult[i] == bruteForceResult[i]);
+    }
+
+    static const int maxSubtreeCounts[] = { 1, 7, 64 };
+
+    for (int maxSubtrees : maxSubtreeCounts) {
+        BE1::Array<int32_t> subtreeResult;
+        QuerySubtrees(tree, boundingVolume, maxSubtrees, subtreeResult);
+
+        assert(subtreeResult.Count() == result.Count());
+        for (int i = 0; i < result.Count(); i++) {
+            assert(subtreeResult[i] == result[i]);
+        }
+    }
+}
+
+// The query tree built from the binary tree reports proxies in the same order as the binary tree.
+template <typename BV>
+static void CompareBuiltQueryTree(const BV &boundingVolume) {
+    BE1::DynamicAABBTree tree;
+
+    for (int i = 0; i < 2000; i++) {
+        tree.CreateProxy(RandomAABB(), 0.1f, nullptr);
+    }
+
+    BE1::Array<int32_t> binaryResult;
+    QueryAll(tree, boundingVolume, binaryResult);
+
+    tree.UpdateQueryTree();
+    assert(tree.IsQueryTreeValid());
+
+    BE1::Array<int32_t> wideResult;
+    QueryAll(tree, boundingVolume, wideResult);
+
+    assert(binaryResult.Count() == wideResult.Count());
+    for (int i = 0; i < binaryResult.Count(); i++) {
+        assert(binaryResult[i] == wideResult[i]);
+    }
+}
+
+static void TestQueryTreeCorrectness() {
+    BE1::DynamicAABBTree tree;
+    BE1::Array<int32_t> proxies;
+
+    randomSeed = 1;
+
+    for (int i = 0; i < 10000; i++) {
+        proxies.Append(tree.CreateProxy(RandomAABB(), 0.1f, nullptr));
+    }
+
+    for (int iteration = 0; iteration < 20; iteration++) {
+        BE1::Vec3 center(RandomFloat(-500.0f, 500.0f), RandomFloat(-500.0f, 500.0f), 0.0f);
+        BE1::Vec3 extents(RandomFloat(10.0f, 100.0f), RandomFloat(10.0f, 100.0f), RandomFloat(10.0f, 100.0f));
+        BE1::Mat3 axis = BE1::Angles(RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f)).ToMat3();
+        BE1::Sphere sphere(center, extents.x);
+        BE1::AABB box(center - extents, center + extents);
+        BE1::OBB obb(center, extents, axis);
+        BE1::Frustum frustum = RandomFrustum();
+
+        // Binary tree.
+        CompareQuery(tree, proxies, sphere);
+        CompareQuery(tree, proxies, box);
+        CompareQuery(tree, proxies, obb);
+        CompareQuery(tree, proxies, frustum);
+
+        tree.UpdateQueryTree();
+        assert(tree.IsQueryTreeValid());
+
+        // Query tree.
+        CompareQuery(tree, proxies, sphere);
+        CompareQuery(tree, proxies, box);
+        CompareQuery(tree, proxies, obb);
+        CompareQuery(tree, proxies, frustum);
+
+        // Move and destroy some proxies to refit the query tree.
+        for (int i = 0; i < 50; i++) {
+            int index = (int)RandomFloat(0.0f, (float)proxies.Count() - 1);
+            if (i & 1) {
+                tree.DestroyProxy(proxies[index]);
+                proxies.RemoveIndex(index);
+            } else {
+                tree.MoveProxy(proxies[index], RandomAABB(), 0.1f, BE1::Vec3::zero);
+            }
+        }
+
+        // Refitted query tree, or binary tree if too many proxies have been refitted.
+        CompareQuery(tree, proxies, sphere);
+        CompareQuery(tree, proxies, box);
+        CompareQuery(tree, proxies, obb);
+        CompareQuery(tree, proxies, frustum);
+
+        // Create a proxy to rebuild the query tree at the next update.
+        proxies.Append(tree.CreateProxy(RandomAABB(), 0.1f, nullptr));
+    }
+
+    for (int i = 0; i < 5; i++) {
+        BE1::Vec3 center(RandomFloat(-500.0f, 500.0f), RandomFloat(-500.0f, 500.0f), 0.0f);
+        BE1::Vec3 extents(RandomFloat(10.0f, 100.0f), RandomFloat(10.0f, 100.0f), RandomFloat(10.0f, 100.0f));
+        BE1::Mat3 axis = BE1::Angles(RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f), RandomFloat(0.0f, 360.0f)).ToMat3();
+
+        CompareBuiltQueryTree(BE1::Sphere(center, extents.x));
+        CompareBuiltQueryTree(BE1::AABB(center - extents, center + extents));
+        CompareBuiltQueryTree(BE1::OBB(center, extents, axis));
+        CompareBuiltQueryTree(RandomFrustum());
+    }
+}
+
+static BE1::Ray RandomRay() {
+    BE1::Vec3 origin(RandomFloat(-600.0f, 600.0f), RandomFloat(-600.0f, 600.0f), RandomFloat(-60.0f, 60.0f));
+    BE1::Vec3 dir(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-0.1f, 0.1f));
+    dir.Normalize();
+    return BE1::Ray(origin, dir);
+}
+
+// Returns the distance to the fat AABB of the proxy, or -1 if it is not hit.
+static float RayCastProxy(const BE1::DynamicAABBTree &tree, const BE1::Ray &ray, int32_t proxyId) {
+    float hitDistMin, hitDistMax;
+    if (!tree.GetFatAABB(proxyId).IntersectRay(ray, &hitDistMin, &hitDistMax) || hitDistMax < 0.0f) {
+        return -1.0f;
+    }
+    return BE1::Max(hitDistMin, 0.0f);
+}
+
+static void TestRayCastAndBatchQueries() {
+    const int numRays = 100;
+
+    BE1::DynamicAABBTree tree;
+    BE1::Array<int32_t> proxies;
+
+    randomSeed = 1;
+
+    for (int i = 0; i < 2000; i++) {
+        proxies.Append(tree.CreateProxy(RandomAABB(), 0.1f, nullptr));
+    }
+
+    BE1::Ray rays[numRays];
+    float closestDists[numRays];
+    int32_t closestProxies[numRays];
+
+    for (int i = 0; i < numRays; i++) {
+        rays[i] = RandomRay();
+
+        // Closest hit by brute force.
+        closestDists[i] = FLT_MAX;
+        closestProxies[i] = -1;
+        for (int j = 0; j < proxies.Count(); j++) {
+            float dist = RayCastProxy(tree, rays[i], proxies[j]);
+            if (dist >= 0.0f && dist < closestDists[i]) {
+                closestDists[i] = dist;
+                closestProxies[i] = proxies[j];
+            }
+        }
+
+        int32_t hitProxy = -1;
+        auto rayCastCallback = [&](int32_t proxyId, float maxDist) -> float {
+            float dist = RayCastProxy(tree, rays[i], proxyId);
+            if (dist >= 0.0f && dist < maxDist) {
+                hitProxy = proxyId;
+                return dist;
+            }
+            return maxDist;
+        };
+        tree.RayCast(rays[i], FLT_MAX, rayCastCallback);
+
+        assert(hitProxy == -1 ? closestProxies[i] == -1 : BE1::Math::Fabs(RayCastProxy(tree, rays[i], hitProxy) - closestDists[i]) < 0.001f);
+    }
+
+    // Batched ray casts find the same closest hits.
+    float maxDists[numRays];
+    int32_t hitProxies[numRays];
+    for (int i = 0; i < numRays; i++) {
+        maxDists[i] = FLT_MAX;
+        hitProxies[i] = -1;
+    }
+
+    auto rayCastBatchCallback = [&](int rayIndex, int32_t proxyId, float maxDist) -> float {
+        float dist = RayCastProxy(tree, rays[rayIndex], proxyId);
+        if (dist >= 0.0f && dist < maxDist) {
+            hitProxies[rayIndex] = proxyId;
+            return dist;
+        }
+        return maxDist;
+    };
+    tree.RayCastBatch(rays, maxDists, numRays, rayCastBatchCallback);
+
+    for (int i = 0; i < numRays; i++) {
+        assert(hitProxies[i] == -1 ? closestProxies[i] == -1 : BE1::Math::Fabs(maxDists[i] - closestDists[i]) < 0.001f);
+    }
+
+    // Batched volume queries report the same pairs as the single queries.
+    BE1::AABB boxes[numRays];
+    int numBatchResults[numRays];
+    int numSingleResults[numRays];
+
+    for (int i = 0; i < numRays; i++) {
+        BE1::Vec3 center(RandomFloat(-500.0f, 500.0f), RandomFloat(-500.0f, 500.0f), 0.0f);
+        boxes[i] = BE1::AABB(center - BE1::Vec3(50.0f), center + BE1::Vec3(50.0f));
+        numBatchResults[i] = 0;
+        numSingleResults[i] = 0;
+
+        auto queryCallback = [&](int32_t proxyId) -> bool {
+            numSingleResults[i]++;
+            return true;
+        };
+        tree.Query(boxes[i], queryCallback);
+    }
+
+    auto queryBatchCallback = [&](int volumeIndex, int32_t proxyId) -> bool {
+        assert(boxes[volumeIndex].IsIntersectAABB(tree.GetFatAABB(proxyId)));
+        numBatchResults[volumeIndex]++;
+        return true;
+    };
+    tree.QueryBatch(boxes, numRays, queryBatchCallback);
+
+    for (int i = 0; i < numRays; i++) {
+        assert(numBatchResults[i] == numSingleResults[i]);
+    }
+
+    // Overlap pairs in the same tree are reported once.
+    int numPairs = 0;
+    for (int i = 0; i < proxies.Count(); i++) {
+        for (int j = i + 1; j < proxies.Count(); j++) {
+            if (tree.GetFatAABB(proxies[i]).IsIntersectAABB(tree.GetFatAABB(proxies[j]))) {
+                numPairs++;
+            }
+        }
+    }
+
+    int numReportedPairs = 0;
+    auto overlapPairCallback = [&](int32_t proxyId, int32_t otherProxyId) -> bool {
+        assert(proxyId != otherProxyId);
+        assert(tree.GetFatAABB(proxyId).IsIntersectAABB(tree.GetFatAABB(otherProxyId)));
+        numReportedPairs++;
+        return true;
+    };
+    tree.QueryOverlapPairs(tree, overlapPairCallback);
+
+    assert(numReportedPairs == numPairs);
+}
+
+static void BenchmarkFrustumQuery(int numProxies) {
+    const int numQueries = 200;
+
+    BE1::DynamicAABBTree tree;
+    BE1::Array<BE1::Frustum> frustums;
+
+    randomSeed = 1;
+
+    for (int i = 0; i < numProxies; i++) {
+        tree.CreateProxy(RandomAABB(), 0.1f, nullptr);
+    }
+
+    for (int i = 0; i < numQueries; i++) {
+        frustums.Append(RandomFrustum());
+    }
+
+    BE1::Array<int32_t> result;
+    result.Resize(numProxies);
+
+    uint64_t t0 = BE1::PlatformTime::Microseconds();
+    for (int i = 0; i < numQueries; i++) {
+        result.SetCount(0, false);
+        QueryAll(tree, frustums[i], result);
+    }
+    uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+    tree.UpdateQueryTree();
+
+    uint64_t t2 = BE1::PlatformTime::Microseconds();
+    for (int i = 0; i < numQueries; i++) {
+        result.SetCount(0, false);
+        QueryAll(tree, frustums[i], result);
+    }
+    uint64_t t3 = BE1::PlatformTime::Microseconds();
+
+    BE_LOG("Frustum query %7i proxies: binary tree %" PRIu64 " us, 4-wide tree %" PRIu64 " us (%i queries)\n", 
+        numProxies, t1 - t0, t3 - t2, numQueries);
+}
+
+void TestDynamicAABBTree() {
+    TestQueryTreeCorrectness();
+    TestRayCastAndBatchQueries();
+
+    BenchmarkFrustumQuery(10000);
+    BenchmarkFrustumQuery(100000);
+}
@@ -0,0 +1,980 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "../Runtime/Private/Image/ImageInternal.h"
+#include "TestImage.h"
+
+// Benchmarks with 4K images take several seconds, define to 1 to run them
+//#define BENCHMARK_LARGE_IMAGES  1
+
+static uint32_t randomSeed;
+
+static uint32_t NextRandom() {
+    randomSeed = randomSeed * 1664525 + 1013904223;
+    return randomSeed;
+}
+
+// Creates RGBA8888 image filled with smooth gradients and a bit of noise, which looks more like a real texture than pure noise.
+static void CreateTestImage(int width, int height, int numSlices, BE1::Image &image) {
+    int numMipmaps = BE1::Image::MaxMipMapLevels(width, height, 1);
+
+    if (numSlices == 6) {
+        image.CreateCube(width, numMipmaps, BE1::Image::Format::RGBA_8_8_8_8, nullptr, 0);
+    } else {
+        image.Create2D(width, height, numMipmaps, BE1::Image::Format::RGBA_8_8_8_8, nullptr, 0);
+    }
+
+    randomSeed = 1;
+
+    for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
+        byte *ptr = image.GetPixels(0, sliceIndex);
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int noise = NextRandom() >> 28;
+                ptr[0] = (byte)((x * 255 / width + noise + sliceIndex * 40) & 0xFF);
+                ptr[1] = (byte)((y * 255 / height + noise) & 0xFF);
+                ptr[2] = (byte)(((x ^ y) & 0x7F) + noise);
+                ptr[3] = (byte)(((x + y) * 255 / (width + height)) & 0xFF);
+                ptr += 4;
+            }
+        }
+    }
+
+    image.GenerateMipmaps();
+}
+
+// Calls func with 1, 2, 4, ... worker threads up to the current number of workers, and then restores the number of workers.
+template <typename Func>
+static void RunWithWorkerCounts(Func func) {
+    const int maxThreads = BE1::Max(BE1::jobSystem.NumWorkers(), 1);
+
+    for (int numThreads = 1; ; numThreads = BE1::Min(numThreads * 2, maxThreads)) {
+        BE1::jobSystem.Shutdown();
+        BE1::jobSystem.Init(numThreads - 1);
+
+        func(numThreads);
+
+        if (numThreads == maxThreads) {
+            break;
+        }
+    }
+
+    BE1::jobSystem.Shutdown();
+    BE1::jobSystem.Init(maxThreads - 1);
+}
+
+static void CompressImageSerial(const BE1::Image &srcImage, BE1::Image &dstImage, BE1::Image::CompressionQuality::Enum quality) {
+    for (int mipLevel = 0; mipLevel < srcImage.NumMipmaps(); mipLevel++) {
+        int w = srcImage.GetWidth(mipLevel);
+        int h = srcImage.GetHeight(mipLevel);
+        int d = srcImage.GetDepth(mipLevel);
+
+        for (int sliceIndex = 0; sliceIndex < srcImage.NumSlices(); sliceIndex++) {
+            const byte *src = srcImage.GetPixels(mipLevel, sliceIndex);
+            byte *dst = dstImage.GetPixels(mipLevel, sliceIndex);
+
+            if (dstImage.GetFormat() == BE1::Image::Format::RGBA_DXT1) {
+                if (quality == BE1::Image::CompressionQuality::HighQuality) {
+                    BE1::DXTEncoder::CompressImageDXT1HQ(src, w, h, d, dst);
+                } else {
+                    BE1::DXTEncoder::CompressImageDXT1Fast(src, w, h, d, dst);
+                }
+            } else {
+                if (quality == BE1::Image::CompressionQuality::HighQuality) {
+                    BE1::DXTEncoder::CompressImageDXT5HQ(src, w, h, d, dst);
+                } else {
+                    BE1::DXTEncoder::CompressImageDXT5Fast(src, w, h, d, dst);
+                }
+            }
+        }
+    }
+}
+
+// Parallel compression should be bit-identical with the serial compression.
+static void TestCompressDXTParallel() {
+    static const int sizes[][2] = { { 256, 256 }, { 130, 67 }, { 3, 5 } };
+    static const BE1::Image::Format::Enum formats[] = { BE1::Image::Format::RGBA_DXT1, BE1::Image::Format::RGBA_DXT5 };
+    static const BE1::Image::CompressionQuality::Enum qualities[] = { BE1::Image::CompressionQuality::Fast, BE1::Image::CompressionQuality::HighQuality };
+
+    for (int sizeIndex = 0; sizeIndex < COUNT_OF(sizes); sizeIndex++) {
+        BE1::Image srcImage;
+        CreateTestImage(sizes[sizeIndex][0], sizes[sizeIndex][1], 1, srcImage);
+
+        for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+            for (int qualityIndex = 0; qualityIndex < COUNT_OF(qualities); qualityIndex++) {
+                BE1::Image parallelImage;
+                srcImage.ConvertFormat(formats[formatIndex], parallelImage, false, qualities[qualityIndex]);
+
+                BE1::Image serialImage;
+                serialImage.Create2D(srcImage.GetWidth(), srcImage.GetHeight(), srcImage.NumMipmaps(), formats[formatIndex], nullptr, 0);
+                CompressImageSerial(srcImage, serialImage, qualities[qualityIndex]);
+
+                int size = serialImage.GetSize(0, serialImage.NumMipmaps());
+                assert(parallelImage.GetSize(0, parallelImage.NumMipmaps()) == size);
+                assert(memcmp(parallelImage.GetPixels(), serialImage.GetPixels(), size) == 0);
+            }
+        }
+    }
+}
+
+static void BenchmarkCompressDXT() {
+    static const BE1::Image::Format::Enum formats[] = { BE1::Image::Format::RGBA_DXT1, BE1::Image::Format::RGBA_DXT5 };
+    static const BE1::Image::CompressionQuality::Enum qualities[] = { BE1::Image::CompressionQuality::Fast, BE1::Image::CompressionQuality::HighQuality };
+    static const char *qualityNames[] = { "Fast", "HQ" };
+
+    // Cubemap with full mipmaps
+    BE1::Image srcImage;
+    CreateTestImage(512, 512, 6, srcImage);
+
+    int numPixels = srcImage.NumPixels(0, srcImage.NumMipmaps());
+
+    RunWithWorkerCounts([&](int numThreads) {
+        for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+            for (int qualityIndex = 0; qualityIndex < COUNT_OF(qualities); qualityIndex++) {
+                BE1::Image dstImage;
+
+                uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+                srcImage.ConvertFormat(formats[formatIndex], dstImage, false, qualities[qualityIndex]);
+
+                uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+                BE_LOG("Compress %s %s (%i threads): %.2f MP/s\n", BE1::Image::FormatName(formats[formatIndex]), qualityNames[qualityIndex], numThreads, numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+            }
+        }
+    });
+}
+
+// Fixed image corpus for the quality measurements.
+static void CreateCorpusImage(int index, int size, BE1::Image &image) {
+    image.Create2D(size, size, 1, BE1::Image::Format::RGBA_8_8_8_8, nullptr, 0);
+
+    randomSeed = index + 1;
+
+    byte *ptr = image.GetPixels();
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            switch (index) {
+            case 0: // smooth gradients
+                ptr[0] = (byte)(x * 255 / size);
+                ptr[1] = (byte)(y * 255 / size);
+                ptr[2] = (byte)((x + y) * 255 / (size * 2));
+                ptr[3] = (byte)(255 - x * 255 / size);
+                break;
+            case 1: // gradients with noise
+                ptr[0] = (byte)BE1::Min(x * 255 / size + (int)(NextRandom() >> 27), 255);
+                ptr[1] = (byte)BE1::Min(y * 255 / size + (int)(NextRandom() >> 27), 255);
+                ptr[2] = (byte)(NextRandom() >> 25);
+                ptr[3] = (byte)(y * 255 / size);
+                break;
+            case 2: // hard edged shapes
+                ptr[0] = ((x / 13) ^ (y / 7)) & 1 ? 230 : 20;
+                ptr[1] = ((x / 5 + y / 11) & 3) * 80;
+                ptr[2] = (x * x + y * y) % 4096 < 2048 ? 200 : 40;
+                ptr[3] = ((x / 16) & 1) ? 255 : 0;
+                break;
+            default: // white noise
+                ptr[0] = (byte)(NextRandom() >> 24);
+                ptr[1] = (byte)(NextRandom() >> 24);
+                ptr[2] = (byte)(NextRandom() >> 24);
+                ptr[3] = (byte)(NextRandom() >> 24);
+                break;
+            }
+            ptr += 4;
+        }
+    }
+}
+
+// PSNR of RGB components, or alpha only if alpha is true.
+static double ComputePSNR(const byte *data0, const byte *data1, int numPixels, bool alpha) {
+    double sumSquaredError = 0;
+    int count = 0;
+
+    for (int i = 0; i < numPixels; i++) {
+        for (int c = alpha ? 3 : 0; c < (alpha ? 4 : 3); c++) {
+            int d = (int)data0[i * 4 + c] - (int)data1[i * 4 + c];
+            sumSquaredError += d * d;
+            count++;
+        }
+    }
+
+    if (sumSquaredError == 0) {
+        return 99.0;
+    }
+    double mse = sumSquaredError / count;
+    return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+// SIMD fast compression should be bit-identical with the scalar fast compression.
+static void TestCompressDXTSIMD() {
+    static const int sizes[][2] = { { 256, 256 }, { 130, 67 }, { 3, 5 }, { 1, 1 } };
+
+    using CompressFunc = void (*)(const byte *, const int, const int, const int, byte *);
+    static const CompressFunc funcs[][2] = {
+        { BE1::DXTEncoder::CompressImageDXT1Fast, BE1::DXTEncoder::CompressImageDXT1FastSIMD },
+        { BE1::DXTEncoder::CompressImageDXT3Fast, BE1::DXTEncoder::CompressImageDXT3FastSIMD },
+        { BE1::DXTEncoder::CompressImageDXT5Fast, BE1::DXTEncoder::CompressImageDXT5FastSIMD },
+        { BE1::DXTEncoder::CompressImageDXN2Fast, BE1::DXTEncoder::CompressImageDXN2FastSIMD }
+    };
+
+    for (int sizeIndex = 0; sizeIndex < COUNT_OF(sizes); sizeIndex++) {
+        int w = sizes[sizeIndex][0];
+        int h = sizes[sizeIndex][1];
+
+        BE1::Image srcImage;
+        CreateTestImage(w, h, 1, srcImage);
+
+        int size = ((w + 3) / 4) * ((h + 3) / 4) * 16;
+
+        BE1::Array<byte> scalarData;
+        BE1::Array<byte> simdData;
+        scalarData.SetCount(size);
+        simdData.SetCount(size);
+
+        for (int funcIndex = 0; funcIndex < COUNT_OF(funcs); funcIndex++) {
+            funcs[funcIndex][0](srcImage.GetPixels(), w, h, 1, scalarData.Ptr());
+            funcs[funcIndex][1](srcImage.GetPixels(), w, h, 1, simdData.Ptr());
+
+            assert(memcmp(scalarData.Ptr(), simdData.Ptr(), size) == 0);
+        }
+    }
+}
+
+// Reports speed of the scalar fast, SIMD fast and high quality compression on a single thread,
+// and PSNR of the fast compression against the high quality compression output.
+static void BenchmarkCompressDXTSIMD() {
+    const int size = 512;
+    const int numCorpusImages = 4;
+    const int numBlocks = (size / 4) * (size / 4);
+
+    BE1::Image srcImage;
+    BE1::Array<byte> compressedData;
+    BE1::Array<byte> fastDecoded;
+    BE1::Array<byte> hqDecoded;
+    BE1::Array<byte> sourceData;
+
+    compressedData.SetCount(numBlocks * 16);
+    fastDecoded.SetCount(size * size * 4);
+    hqDecoded.SetCount(size * size * 4);
+
+    for (int format = 0; format < 2; format++) {
+        bool isDXT5 = format == 1;
+        uint64_t scalarTime = 0;
+        uint64_t simdTime = 0;
+        uint64_t hqTime = 0;
+
+        for (int imageIndex = 0; imageIndex < numCorpusImages; imageIndex++) {
+            CreateCorpusImage(imageIndex, size, srcImage);
+            const byte *src = srcImage.GetPixels();
+            const BE1::DXTBlock *blocks = (const BE1::DXTBlock *)compressedData.Ptr();
+
+            uint64_t t0 = BE1::PlatformTime::Microseconds();
+            if (isDXT5) {
+                BE1::DXTEncoder::CompressImageDXT5Fast(src, size, size, 1, compressedData.Ptr());
+            } else {
+                BE1::DXTEncoder::CompressImageDXT1Fast(src, size, size, 1, compressedData.Ptr());
+            }
+            uint64_t t1 = BE1::PlatformTime::Microseconds();
+            if (isDXT5) {
+                BE1::DXTEncoder::CompressImageDXT5FastSIMD(src, size, size, 1, compressedData.Ptr());
+                BE1::DXTDecoder::DecompressImageDXT5(blocks, size, size, 1, fastDecoded.Ptr());
+            } else {
+                BE1::DXTEncoder::CompressImageDXT1FastSIMD(src, size, size, 1, compressedData.Ptr());
+                BE1::DXTDecoder::DecompressImageDXT1(blocks, size, size, 1, fastDecoded.Ptr());
+            }
+            uint64_t t2 = BE1::PlatformTime::Microseconds();
+            if (isDXT5) {
+                BE1::DXTEncoder::CompressImageDXT5HQ(src, size, size, 1, compressedData.Ptr());
+            } else {
+                BE1::DXTEncoder::CompressImageDXT1HQ(src, size, size, 1, compressedData.Ptr());
+            }
+            uint64_t t3 = BE1::PlatformTime::Microseconds();
+            if (isDXT5) {
+                BE1::DXTDecoder::DecompressImageDXT5(blocks, size, size, 1, hqDecoded.Ptr());
+            } else {
+                BE1::DXTDecoder::DecompressImageDXT1(blocks, size, size, 1, hqDecoded.Ptr());
+            }
+
+            scalarTime += t1 - t0;
+            simdTime += t2 - t1;
+            hqTime += t3 - t2;
+
+            BE_LOG("%s corpus %i: PSNR fast vs HQ %.2f dB, fast vs source %.2f dB, HQ vs source %.2f dB",
+                isDXT5 ? "DXT5" : "DXT1", imageIndex,
+                ComputePSNR(fastDecoded.Ptr(), hqDecoded.Ptr(), size * size, false),
+                ComputePSNR(fastDecoded.Ptr(), src, size * size, false),
+                ComputePSNR(hqDecoded.Ptr(), src, size * size, false));
+            if (isDXT5) {
+                BE_LOG(", alpha fast vs HQ %.2f dB", ComputePSNR(fastDecoded.Ptr(), hqDecoded.Ptr(), size * size, true));
+            }
+            BE_LOG("\n");
+        }
+
+        // Decompression time is included in the SIMD time, so the speed up is underestimated
+        float numMegaPixels = (float)(size * size * numCorpusImages);
+        BE_LOG("%s: scalar fast %.2f MP/s, SIMD fast %.2f MP/s (x%.1f), HQ %.2f MP/s\n",
+            isDXT5 ? "DXT5" : "DXT1",
+            numMegaPixels / BE1::Max(scalarTime, (uint64_t)1),
+            numMegaPixels / BE1::Max(simdTime, (uint64_t)1),
+            (float)scalarTime / BE1::Max(simdTime, (uint64_t)1),
+            numMegaPixels / BE1::Max(hqTime, (uint64_t)1));
+    }
+}
+
+// Reference serial box filter mipmap generation for 2D images.
+// Odd sizes drop the last source row and column, dimensions of size 1 are not filtered.
+static void ReferenceGenerateMipmaps(BE1::Image &image) {
+    int components = image.NumComponents();
+    bool gamma = !image.IsLinearSpace();
+
+    for (int mipLevel = 0; mipLevel < image.NumMipmaps() - 1; mipLevel++) {
+        int w = image.GetWidth(mipLevel);
+        int h = image.GetHeight(mipLevel);
+        int dstWidth = image.GetWidth(mipLevel + 1);
+        int dstHeight = image.GetHeight(mipLevel + 1);
+        int xOff = (w < 2) ? 0 : components;
+        int yOff = (h < 2) ? 0 : components * w;
+
+        for (int sliceIndex = 0; sliceIndex < image.NumSlices(); sliceIndex++) {
+            const byte *srcSlice = image.GetPixels(mipLevel, sliceIndex);
+            byte *dst = image.GetPixels(mipLevel + 1, sliceIndex);
+
+            for (int y = 0; y < dstHeight; y++) {
+                for (int x = 0; x < dstWidth; x++) {
+                    const byte *src = srcSlice + (BE1::Min(2 * y, h - 1) * w + BE1::Min(2 * x, w - 1)) * components;
+
+                    for (int i = 0; i < components; i++) {
+                        if (gamma) {
+                            float sum = BE1::Math::Pow(src[0] / 255.0f, 2.2f) + BE1::Math::Pow(src[xOff] / 255.0f, 2.2f) + 
+                                BE1::Math::Pow(src[yOff] / 255.0f, 2.2f) + BE1::Math::Pow(src[yOff + xOff] / 255.0f, 2.2f);
+                            *dst++ = BE1::Math::Ftob(255.0f * BE1::Math::Pow(0.25f * sum, 1.0f / 2.2f));
+                        } else {
+                            *dst++ = (src[0] + src[xOff] + src[yOff] + src[yOff + xOff]) / 4;
+                        }
+                        src++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static double ReferenceSinc(double x) {
+    if (fabs(x) < 1e-6) {
+        return 1.0;
+    }
+    return sin(BE1::Math::Pi * x) / (BE1::Math::Pi * x);
+}
+
+static double ReferenceBesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 64; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// Weight of the source pixel at the distance x in destination pixels, Kaiser (alpha 4) or Lanczos windowed sinc of the width 3.
+static double ReferenceMipmapFilterWeight(BE1::Image::MipmapFilter::Enum filter, double x) {
+    double t = x / 3.0;
+    if (t * t >= 1.0) {
+        return 0.0;
+    }
+    if (filter == BE1::Image::MipmapFilter::Kaiser) {
+        return ReferenceSinc(x) * ReferenceBesselI0(4.0 * sqrt(1.0 - t * t)) / ReferenceBesselI0(4.0);
+    }
+    return ReferenceSinc(x) * ReferenceSinc(t);
+}
+
+// Reference windowed filter in double precision. Builds the next level of the given 2D image level into dst in linear space.
+// Source pixels 2x - 5 ... 2x + 6 are clamped to the edges.
+static void ReferenceFilterMipmap(const BE1::Image &image, int mipLevel, BE1::Image::MipmapFilter::Enum filter, double *dst) {
+    const int components = image.NumComponents();
+    const int w = image.GetWidth(mipLevel);
+    const int h = image.GetHeight(mipLevel);
+    const int dstWidth = image.GetWidth(mipLevel + 1);
+    const int dstHeight = image.GetHeight(mipLevel + 1);
+    const bool gamma = !image.IsFloatFormat() && !image.IsLinearSpace();
+
+    double weights[12];
+    double weightSum = 0.0;
+    for (int k = 0; k < 12; k++) {
+        weights[k] = ReferenceMipmapFilterWeight(filter, (k - 5 - 0.5) * 0.5);
+        weightSum += weights[k];
+    }
+
+    const byte *src = image.GetPixels(mipLevel);
+
+    for (int y = 0; y < dstHeight; y++) {
+        for (int x = 0; x < dstWidth; x++) {
+            for (int i = 0; i < components; i++) {
+                double sum = 0.0;
+
+                for (int ky = 0; ky < 12; ky++) {
+                    int sy = BE1::Clamp(2 * y - 5 + ky, 0, h - 1);
+
+                    for (int kx = 0; kx < 12; kx++) {
+                        int sx = BE1::Clamp(2 * x - 5 + kx, 0, w - 1);
+                        int index = (sy * w + sx) * components + i;
+
+                        double value;
+                        if (image.IsFloatFormat()) {
+                            value = ((const float *)src)[index];
+                        } else if (gamma) {
+                            value = pow(src[index] / 255.0, 2.2);
+                        } else {
+                            value = src[index];
+                        }
+                        sum += weights[ky] * weights[kx] * value;
+                    }
+                }
+
+                *dst++ = sum / (weightSum * weightSum);
+            }
+        }
+    }
+}
+
+// Box filter mipmaps should be within 1 LSB of the serial reference, including odd sizes.
+// Windowed filters should be within 1 LSB of the double precision reference for bytes, and within 0.01% for floats.
+static void TestGenerateMipmaps() {
+    static const BE1::Image::Format::Enum formats[] = { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::L_8, BE1::Image::Format::LA_8_8, BE1::Image::Format::RGB_8_8_8 };
+    static const int flags[] = { 0, BE1::Image::Flag::LinearSpace };
+    static const int sizes[][2] = { { 128, 64 }, { 67, 35 }, { 35, 1 } };
+
+    for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+        for (int flagIndex = 0; flagIndex < COUNT_OF(flags); flagIndex++) {
+            for (int sizeIndex = 0; sizeIndex < COUNT_OF(sizes); sizeIndex++) {
+                for (int numSlices = 1; numSlices <= 6; numSlices += 5) {
+                    int width = sizes[sizeIndex][0];
+                    int height = numSlices == 6 ? width : sizes[sizeIndex][1];
+                    int numMipmaps = BE1::Image::MaxMipMapLevels(width, height, 1);
+
+                    BE1::Image image;
+                    if (numSlices == 6) {
+                        image.CreateCube(width, numMipmaps, formats[formatIndex], nullptr, flags[flagIndex]);
+                    } else {
+                        image.Create2D(width, height, numMipmaps, formats[formatIndex], nullptr, flags[flagIndex]);
+                    }
+
+                    randomSeed = 1;
+                    for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
+                        byte *ptr = image.GetPixels(0, sliceIndex);
+                        for (int i = 0; i < image.GetSliceSize(0); i++) {
+                            ptr[i] = (byte)(NextRandom() >> 24);
+                        }
+                    }
+
+                    BE1::Image referenceImage = image;
+
+                    image.GenerateMipmaps();
+                    ReferenceGenerateMipmaps(referenceImage);
+
+                    for (int mipLevel = 1; mipLevel < numMipmaps; mipLevel++) {
+                        for (int sliceIndex = 0; sliceIndex < numSlices; sliceIndex++) {
+                            const byte *ptr = image.GetPixels(mipLevel, sliceIndex);
+                            const byte *referencePtr = referenceImage.GetPixels(mipLevel, sliceIndex);
+
+                            for (int i = 0; i < image.GetSliceSize(mipLevel); i++) {
+                                assert(BE1::Math::Abs(ptr[i] - referencePtr[i]) <= 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    static const BE1::Image::MipmapFilter::Enum filters[] = { BE1::Image::MipmapFilter::Kaiser, BE1::Image::MipmapFilter::Lanczos };
+    static const BE1::Image::Format::Enum windowedFormats[] = { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::L_8, BE1::Image::Format::RGBA_32F_32F_32F_32F };
+
+    for (int filterIndex = 0; filterIndex < COUNT_OF(filters); filterIndex++) {
+        for (int formatIndex = 0; formatIndex < COUNT_OF(windowedFormats); formatIndex++) {
+            for (int flagIndex = 0; flagIndex < COUNT_OF(flags); flagIndex++) {
+                for (int sizeIndex = 0; sizeIndex < COUNT_OF(sizes); sizeIndex++) {
+                    int width = sizes[sizeIndex][0];
+                    int height = sizes[sizeIndex][1];
+
+                    BE1::Image image;
+                    image.Create2D(width, height, BE1::Image::MaxMipMapLevels(width, height, 1), windowedFormats[formatIndex], nullptr, flags[flagIndex]);
+
+                    // Smooth gradients with noise, so that the result depends on every tap
+                    randomSeed = 1;
+                    int numSamples = image.NumPixels(0, 1) * image.NumComponents();
+                    for (int i = 0; i < numSamples; i++) {
+                        int x = (i / image.NumComponents()) % width;
+                        int y = (i / image.NumComponents()) / width;
+                        float value = 0.5f + 0.3f * BE1::Math::Sin(x * 0.3f + (i % image.NumComponents())) * BE1::Math::Cos(y * 0.2f) + 0.2f * ((NextRandom() >> 8) / 16777216.0f - 0.5f);
+
+                        if (image.IsFloatFormat()) {
+                            ((float *)image.GetPixels())[i] = value;
+                        } else {
+                            image.GetPixels()[i] = BE1::Math::Ftob(255.0f * value);
+                        }
+                    }
+
+                    image.GenerateMipmaps(filters[filterIndex]);
+
+                    // Every level is built from the previous level of the image
+                    for (int mipLevel = 0; mipLevel < image.NumMipmaps() - 1; mipLevel++) {
+                        int count = image.NumPixels(mipLevel + 1, 1) * image.NumComponents();
+                        BE1::Array<double> reference;
+                        reference.SetCount(count);
+
+                        ReferenceFilterMipmap(image, mipLevel, filters[filterIndex], reference.Ptr());
+
+                        const byte *ptr = image.GetPixels(mipLevel + 1);
+
+                        for (int i = 0; i < count; i++) {
+                            if (image.IsFloatFormat()) {
+                                assert(BE1::Math::Fabs(((const float *)ptr)[i] - reference[i]) <= 1e-4 * BE1::Max(fabs(reference[i]), 1.0));
+                            } else if (image.IsLinearSpace()) {
+                                int expected = (int)BE1::Max(BE1::Min(reference[i] + 0.5, 255.0), 0.0);
+                                assert(BE1::Math::Abs(ptr[i] - expected) <= 1);
+                            } else {
+                                int expected = (int)(255.0 * pow(BE1::Max(BE1::Min(reference[i], 1.0), 0.0), 1.0 / 2.2));
+                                assert(BE1::Math::Abs(ptr[i] - expected) <= 1);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void BenchmarkGenerateMipmaps() {
+    static const BE1::Image::MipmapFilter::Enum filters[] = { BE1::Image::MipmapFilter::Box, BE1::Image::MipmapFilter::Kaiser, BE1::Image::MipmapFilter::Lanczos };
+    static const char *filterNames[] = { "Box", "Kaiser", "Lanczos" };
+
+    BE1::Image image;
+    CreateTestImage(2048, 2048, 1, image);
+
+    // Mipmaps are generated from the top level
+    int numPixels = image.NumPixels(0, 1);
+
+    BE1::Image referenceImage = image;
+
+    uint64_t t0 = BE1::PlatformTime::Microseconds();
+    ReferenceGenerateMipmaps(referenceImage);
+    uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+    BE_LOG("GenerateMipmaps reference: %.2f MP/s\n", numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+
+    RunWithWorkerCounts([&](int numThreads) {
+        for (int filterIndex = 0; filterIndex < COUNT_OF(filters); filterIndex++) {
+            uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+            image.GenerateMipmaps(filters[filterIndex]);
+
+            uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+            BE_LOG("GenerateMipmaps %s (%i threads): %.2f MP/s\n", filterNames[filterIndex], numThreads, numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+        }
+    });
+}
+
+// Converts to the given format and back to RGBA8888, and compares with the source image.
+// Formats which lose precision must reproduce the same packed pixels when converted again.
+static void TestConvertFormat() {
+    static const BE1::Image::Format::Enum formats[] = {
+        BE1::Image::Format::RGB_8_8_8, BE1::Image::Format::BGRA_8_8_8_8, BE1::Image::Format::RGB_5_6_5, BE1::Image::Format::RGBA_4_4_4_4,
+        BE1::Image::Format::RGBA_5_5_5_1, BE1::Image::Format::RGBA_16F_16F_16F_16F, BE1::Image::Format::RGBA_32F_32F_32F_32F
+    };
+    static const int flags[] = { 0, BE1::Image::Flag::LinearSpace };
+
+    for (int flagIndex = 0; flagIndex < COUNT_OF(flags); flagIndex++) {
+        BE1::Image srcImage;
+        CreateTestImage(133, 67, 1, srcImage);
+
+        BE1::Image image;
+        image.Create2D(srcImage.GetWidth(), srcImage.GetHeight(), srcImage.NumMipmaps(), BE1::Image::Format::RGBA_8_8_8_8, srcImage.GetPixels(), flags[flagIndex]);
+
+        int numPixels = image.NumPixels(0, image.NumMipmaps());
+
+        for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+            BE1::Image::Format::Enum format = formats[formatIndex];
+            bool isFloat = BE1::Image::IsFloatFormat(format);
+
+            BE1::Image convertedImage;
+            image.ConvertFormat(format, convertedImage);
+
+            BE1::Image restoredImage;
+            convertedImage.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, restoredImage);
+
+            const byte *ptr = image.GetPixels();
+            const byte *restoredPtr = restoredImage.GetPixels();
+
+            if (format == BE1::Image::Format::RGB_8_8_8) {
+                for (int i = 0; i < numPixels * 4; i++) {
+                    assert(restoredPtr[i] == ((i & 3) == 3 ? 255 : ptr[i]));
+                }
+            } else if (format == BE1::Image::Format::BGRA_8_8_8_8) {
+                assert(memcmp(ptr, restoredPtr, numPixels * 4) == 0);
+            } else if (isFloat) {
+                // Gamma space goes through pow and back, and half floats flush linear values below the smallest normal to zero
+                bool isGamma = !(flags[flagIndex] & BE1::Image::Flag::LinearSpace);
+                for (int i = 0; i < numPixels * 4; i++) {
+                    if (isGamma && BE1::Image::IsHalfFormat(format) && BE1::Math::Pow(ptr[i] / 255.0f, 2.2f) < HALF_NRM_MIN) {
+                        assert(restoredPtr[i] <= ptr[i]);
+                        continue;
+                    }
+                    assert(BE1::Math::Abs(ptr[i] - restoredPtr[i]) <= 1);
+                }
+            } else if (!isFloat) {
+                BE1::Image reconvertedImage;
+                restoredImage.ConvertFormat(format, reconvertedImage);
+                assert(memcmp(convertedImage.GetPixels(), reconvertedImage.GetPixels(), convertedImage.GetSize(0, convertedImage.NumMipmaps())) == 0);
+            }
+
+            if (format == BE1::Image::Format::RGBA_32F_32F_32F_32F && (flags[flagIndex] & BE1::Image::Flag::LinearSpace)) {
+                const float *floatPtr = (const float *)convertedImage.GetPixels();
+                for (int i = 0; i < numPixels * 4; i++) {
+                    assert(floatPtr[i] == ptr[i] * (1.0f / 255.0f));
+                }
+            }
+
+            // In-place conversion should give the same result
+            if (BE1::Image::BytesPerPixel(format) <= 4) {
+                BE1::Image selfImage = image;
+                selfImage.ConvertFormatSelf(format);
+                assert(selfImage.GetFormat() == format);
+                assert(memcmp(selfImage.GetPixels(), convertedImage.GetPixels(), convertedImage.GetSize(0, convertedImage.NumMipmaps())) == 0);
+            }
+        }
+    }
+
+    // Expansions of single and dual channel formats
+    BE1::Image image;
+    image.Create2D(37, 19, 1, BE1::Image::Format::LA_8_8, nullptr, BE1::Image::Flag::LinearSpace);
+    randomSeed = 1;
+    for (int i = 0; i < image.GetSize(0); i++) {
+        image.GetPixels()[i] = (byte)(NextRandom() >> 24);
+    }
+
+    BE1::Image rgbaImage;
+    image.ConvertFormat(BE1::Image::Format::RGBA_8_8_8_8, rgbaImage);
+
+    for (int i = 0; i < image.NumPixels(); i++) {
+        const byte *la = &image.GetPixels()[i * 2];
+        const byte *rgba = &rgbaImage.GetPixels()[i * 4];
+        assert(rgba[0] == la[0] && rgba[1] == la[0] && rgba[2] == la[0] && rgba[3] == la[1]);
+    }
+}
+
+// Fills pixels of the given format with random samples. Float samples are in [-0.25, 1.25] to cover clamping.
+static void FillRandomPixels(BE1::Image::Format::Enum format, byte *pixels, int numPixels) {
+    int size = BE1::Image::BytesPerPixel(format) * numPixels;
+
+    if (BE1::Image::IsHalfFormat(format)) {
+        for (int i = 0; i < size / 2; i++) {
+            ((BE1::half *)pixels)[i] = BE1::half((NextRandom() >> 8) / 16777216.0f * 1.5f - 0.25f);
+        }
+    } else if (BE1::Image::IsFloatFormat(format)) {
+        for (int i = 0; i < size / 4; i++) {
+            ((float *)pixels)[i] = (NextRandom() >> 8) / 16777216.0f * 1.5f - 0.25f;
+        }
+    } else {
+        for (int i = 0; i < size; i++) {
+            pixels[i] = (byte)(NextRandom() >> 24);
+        }
+    }
+}
+
+// Every direct conversion function should give the same pixels as the unpack/pack path in both linear and gamma space.
+static void TestDirectConvertFunctions() {
+    const int numPixels = 1031;
+
+    int numDirectConvertFuncs = 0;
+
+    for (int srcFormat = 0; srcFormat < BE1::Image::Format::Count; srcFormat++) {
+        for (int dstFormat = 0; dstFormat < BE1::Image::Format::Count; dstFormat++) {
+            for (int gammaIndex = 0; gammaIndex < 2; gammaIndex++) {
+                bool isGamma = gammaIndex == 1;
+
+                BE1::ImageConvertFunc directConvertFunc = BE1::GetImageDirectConvertFunc((BE1::Image::Format::Enum)srcFormat, (BE1::Image::Format::Enum)dstFormat, isGamma);
+                if (!directConvertFunc) {
+                    continue;
+                }
+                numDirectConvertFuncs++;
+
+                const BE1::ImageFormatInfo *srcFormatInfo = BE1::GetImageFormatInfo((BE1::Image::Format::Enum)srcFormat);
+                const BE1::ImageFormatInfo *dstFormatInfo = BE1::GetImageFormatInfo((BE1::Image::Format::Enum)dstFormat);
+
+                bool unpackFloat = (srcFormatInfo->type & BE1::Image::FormatType::Float) || (dstFormatInfo->type & BE1::Image::FormatType::Float);
+                BE1::ImageUnpackFunc unpackFunc = unpackFloat ? srcFormatInfo->unpackRGBA32F : srcFormatInfo->unpackRGBA8888;
+                BE1::ImagePackFunc packFunc = unpackFloat ? dstFormatInfo->packRGBA32F : dstFormatInfo->packRGBA8888;
+                assert(unpackFunc && packFunc);
+
+                int srcSize = BE1::Image::BytesPerPixel((BE1::Image::Format::Enum)srcFormat) * numPixels;
+                int dstSize = BE1::Image::BytesPerPixel((BE1::Image::Format::Enum)dstFormat) * numPixels;
+
+                BE1::Array<byte> srcPixels;
+                BE1::Array<byte> unpackedPixels;
+                BE1::Array<byte> referencePixels;
+                BE1::Array<byte> directPixels;
+                srcPixels.SetCount(srcSize);
+                unpackedPixels.SetCount(numPixels * 4 * (unpackFloat ? sizeof(float) : 1));
+                referencePixels.SetCount(dstSize);
+                directPixels.SetCount(dstSize);
+
+                randomSeed = 1;
+                FillRandomPixels((BE1::Image::Format::Enum)srcFormat, srcPixels.Ptr(), numPixels);
+
+                unpackFunc(srcPixels.Ptr(), unpackedPixels.Ptr(), numPixels, isGamma);
+                packFunc(unpackedPixels.Ptr(), referencePixels.Ptr(), numPixels, isGamma);
+
+                directConvertFunc(srcPixels.Ptr(), directPixels.Ptr(), numPixels, isGamma);
+
+                assert(memcmp(referencePixels.Ptr(), directPixels.Ptr(), dstSize) == 0);
+            }
+        }
+    }
+
+    assert(numDirectConvertFuncs > 0);
+}
+
+static void BenchmarkConvertFormat() {
+    static const BE1::Image::Format::Enum formatPairs[][2] = {
+        { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGB_8_8_8 },
+        { BE1::Image::Format::RGB_8_8_8, BE1::Image::Format::RGBA_8_8_8_8 },
+        { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::BGRA_8_8_8_8 },
+        { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGB_5_6_5 },
+        { BE1::Image::Format::RGB_5_6_5, BE1::Image::Format::RGBA_8_8_8_8 },
+        { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGBA_16F_16F_16F_16F },
+        { BE1::Image::Format::RGBA_16F_16F_16F_16F, BE1::Image::Format::RGBA_8_8_8_8 },
+        { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGBA_32F_32F_32F_32F },
+        { BE1::Image::Format::RGBA_32F_32F_32F_32F, BE1::Image::Format::RGBA_8_8_8_8 }
+    };
+
+    BE1::Image image;
+    image.Create2D(2048, 2048, 1, BE1::Image::Format::RGBA_8_8_8_8, nullptr, BE1::Image::Flag::LinearSpace);
+    randomSeed = 1;
+    for (int i = 0; i < image.GetSize(0); i++) {
+        image.GetPixels()[i] = (byte)(NextRandom() >> 24);
+    }
+
+    int numPixels = image.NumPixels();
+
+    for (int pairIndex = 0; pairIndex < COUNT_OF(formatPairs); pairIndex++) {
+        BE1::Image srcImage;
+        image.ConvertFormat(formatPairs[pairIndex][0], srcImage);
+
+        BE1::Image dstImage;
+
+        uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+        srcImage.ConvertFormat(formatPairs[pairIndex][1], dstImage);
+
+        uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+        BE_LOG("ConvertFormat %s -> %s: %.2f MP/s\n", BE1::Image::FormatName(formatPairs[pairIndex][0]), BE1::Image::FormatName(formatPairs[pairIndex][1]),
+            numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+    }
+}
+
+// Per pixel bilinear and bicubic sampling which truncates byte results, used as a reference of Image::Resize.
+template <typename T>
+static void ReferenceResizeImage(const T *src, int srcWidth, int srcHeight, T *dst, int dstWidth, int dstHeight, int components, BE1::Image::ResampleFilter::Enum filter, float maxValue) {
+    float ratioX = (float)srcWidth / dstWidth;
+    float ratioY = (float)srcHeight / dstHeight;
+
+    for (int y = 0; y < dstHeight; y++) {
+        float fracY = BE1::Math::Fract(y * ratioY);
+        int iY = y * ratioY - fracY;
+        int rows[4] = { BE1::Max(iY - 1, 0), iY, BE1::Min(iY + 1, srcHeight - 1), BE1::Min(iY + 2, srcHeight - 1) };
+
+        for (int x = 0; x < dstWidth; x++) {
+            float fracX = BE1::Math::Fract(x * ratioX);
+            int iX = x * ratioX - fracX;
+            int columns[4] = { BE1::Max(iX - 1, 0), iX, BE1::Min(iX + 1, srcWidth - 1), BE1::Min(iX + 2, srcWidth - 1) };
+
+            for (int i = 0; i < components; i++) {
+                float p[4];
+                for (int k = 0; k < 4; k++) {
+                    const T *row = &src[rows[k] * srcWidth * components + i];
+                    float p0 = row[columns[0] * components];
+                    float p1 = row[columns[1] * components];
+                    float p2 = row[columns[2] * components];
+                    float p3 = row[columns[3] * components];
+                    p[k] = filter == BE1::Image::ResampleFilter::Bicubic ? BE1::Cerp(p0, p1, p2, p3, fracX) : BE1::Lerp(p1, p2, fracX);
+                }
+                float po = filter == BE1::Image::ResampleFilter::Bicubic ? BE1::Clamp(BE1::Cerp(p[0], p[1], p[2], p[3], fracY), 0.0f, maxValue) : BE1::Lerp(p[1], p[2], fracY);
+
+                *dst++ = (T)po;
+            }
+        }
+    }
+}
+
+static void ReferenceResizeImage(const BE1::Image &srcImage, BE1::Image &dstImage, BE1::Image::ResampleFilter::Enum filter) {
+    if (srcImage.IsHalfFormat()) {
+        ReferenceResizeImage((const BE1::half *)srcImage.GetPixels(), srcImage.GetWidth(), srcImage.GetHeight(), (BE1::half *)dstImage.GetPixels(), dstImage.GetWidth(), dstImage.GetHeight(), srcImage.NumComponents(), filter, HALF_MAX);
+    } else if (srcImage.IsFloatFormat()) {
+        ReferenceResizeImage((const float *)srcImage.GetPixels(), srcImage.GetWidth(), srcImage.GetHeight(), (float *)dstImage.GetPixels(), dstImage.GetWidth(), dstImage.GetHeight(), srcImage.NumComponents(), filter, FLT_MAX);
+    } else {
+        ReferenceResizeImage(srcImage.GetPixels(), srcImage.GetWidth(), srcImage.GetHeight(), dstImage.GetPixels(), dstImage.GetWidth(), dstImage.GetHeight(), srcImage.NumComponents(), filter, 255.0f);
+    }
+}
+
+static float GetSampleValue(const BE1::Image &image, int index) {
+    if (image.IsHalfFormat()) {
+        return (float)((const BE1::half *)image.GetPixels())[index];
+    } else if (image.IsFloatFormat()) {
+        return ((const float *)image.GetPixels())[index];
+    }
+    return image.GetPixels()[index];
+}
+
+// Resized images should be within 1 LSB of the per pixel reference for bytes, and within 0.1% for floats.
+// Nearest filter should pick exactly the same source pixels.
+static void TestResize() {
+    static const BE1::Image::Format::Enum formats[] = {
+        BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGB_8_8_8, BE1::Image::Format::L_8, BE1::Image::Format::RGBA_16F_16F_16F_16F, BE1::Image::Format::RGBA_32F_32F_32F_32F
+    };
+    static const BE1::Image::ResampleFilter::Enum filters[] = { BE1::Image::ResampleFilter::Nearest, BE1::Image::ResampleFilter::Bilinear, BE1::Image::ResampleFilter::Bicubic };
+    static const int sizes[][4] = { { 67, 35, 128, 64 }, { 256, 256, 61, 97 }, { 100, 1, 33, 1 } };
+
+    for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+        for (int sizeIndex = 0; sizeIndex < COUNT_OF(sizes); sizeIndex++) {
+            BE1::Image image;
+            image.Create2D(sizes[sizeIndex][0], sizes[sizeIndex][1], 1, formats[formatIndex], nullptr, BE1::Image::Flag::LinearSpace);
+
+            randomSeed = 1;
+            int numSamples = image.NumPixels() * image.NumComponents();
+            for (int i = 0; i < numSamples; i++) {
+                float value = (NextRandom() >> 24) / 255.0f;
+                if (image.IsHalfFormat()) {
+                    ((BE1::half *)image.GetPixels())[i] = BE1::half(value);
+                } else if (image.IsFloatFormat()) {
+                    ((float *)image.GetPixels())[i] = value;
+                } else {
+                    image.GetPixels()[i] = (byte)(value * 255.0f);
+                }
+            }
+
+            for (int filterIndex = 0; filterIndex < COUNT_OF(filters); filterIndex++) {
+                BE1::Image resizedImage;
+                image.Resize(sizes[sizeIndex][2], sizes[sizeIndex][3], filters[filterIndex], resizedImage);
+
+                int numResizedSamples = resizedImage.NumPixels() * resizedImage.NumComponents();
+
+                if (filters[filterIndex] == BE1::Image::ResampleFilter::Nearest) {
+                    float ratioX = (float)image.GetWidth() / resizedImage.GetWidth();
+                    float ratioY = (float)image.GetHeight() / resizedImage.GetHeight();
+
+                    for (int i = 0; i < numResizedSamples; i++) {
+                        int pixelIndex = i / resizedImage.NumComponents();
+                        int x = (int)((pixelIndex % resizedImage.GetWidth()) * ratioX);
+                        int y = (int)((pixelIndex / resizedImage.GetWidth()) * ratioY);
+                        int srcIndex = (y * image.GetWidth() + x) * image.NumComponents() + i % resizedImage.NumComponents();
+
+                        assert(GetSampleValue(resizedImage, i) == GetSampleValue(image, srcIndex));
+                    }
+                    continue;
+                }
+
+                BE1::Image referenceImage;
+                referenceImage.Create2D(resizedImage.GetWidth(), resizedImage.GetHeight(), 1, resizedImage.GetFormat(), nullptr, resizedImage.GetFlags());
+                ReferenceResizeImage(image, referenceImage, filters[filterIndex]);
+
+                for (int i = 0; i < numResizedSamples; i++) {
+                    float value = GetSampleValue(resizedImage, i);
+                    float referenceValue = GetSampleValue(referenceImage, i);
+
+                    if (image.IsFloatFormat()) {
+                        assert(BE1::Math::Fabs(value - referenceValue) <= 0.001f * BE1::Max(BE1::Math::Fabs(referenceValue), 1.0f));
+                    } else {
+                        assert(BE1::Math::Fabs(value - referenceValue) <= 1.0f);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void BenchmarkResize() {
+    static const BE1::Image::ResampleFilter::Enum filters[] = { BE1::Image::ResampleFilter::Nearest, BE1::Image::ResampleFilter::Bilinear, BE1::Image::ResampleFilter::Bicubic };
+    static const char *filterNames[] = { "Nearest", "Bilinear", "Bicubic" };
+    static const BE1::Image::Format::Enum formats[] = { BE1::Image::Format::RGBA_8_8_8_8, BE1::Image::Format::RGBA_16F_16F_16F_16F };
+
+#if BENCHMARK_LARGE_IMAGES
+    const int srcSize = 4096;
+#else
+    const int srcSize = 1024;
+#endif
+
+    for (int formatIndex = 0; formatIndex < COUNT_OF(formats); formatIndex++) {
+        BE1::Image image;
+        CreateTestImage(srcSize, srcSize, 1, image);
+        image.ConvertFormatSelf(formats[formatIndex]);
+
+        // Downscale to a quarter
+        int dstSize = image.GetWidth() / 4;
+        int numPixels = dstSize * dstSize;
+
+        BE1::Image resizedImage;
+        BE1::Image referenceImage;
+        referenceImage.Create2D(dstSize, dstSize, 1, image.GetFormat(), nullptr, image.GetFlags());
+
+        for (int filterIndex = 1; filterIndex < COUNT_OF(filters); filterIndex++) {
+            uint64_t t0 = BE1::PlatformTime::Microseconds();
+            ReferenceResizeImage(image, referenceImage, filters[filterIndex]);
+            uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+            BE_LOG("Resize %s %s reference: %.2f MP/s\n", image.FormatName(), filterNames[filterIndex], numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+        }
+
+        RunWithWorkerCounts([&](int numThreads) {
+            for (int filterIndex = 0; filterIndex < COUNT_OF(filters); filterIndex++) {
+                uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+                image.Resize(dstSize, dstSize, filters[filterIndex], resizedImage);
+
+                uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+                BE_LOG("Resize %s %s (%i threads): %.2f MP/s\n", image.FormatName(), filterNames[filterIndex], numThreads, numPixels / (float)BE1::Max(t1 - t0, (uint64_t)1));
+            }
+        });
+    }
+}
+
+void TestImage() {
+    TestCompressDXTParallel();
+
+    TestCompressDXTSIMD();
+
+    BenchmarkCompressDXTSIMD();
+
+    BenchmarkCompressDXT();
+
+    TestGenerateMipmaps();
+
+    BenchmarkGenerateMipmaps();
+
+    TestConvertFormat();
+
+    TestDirectConvertFunctions();
+
+    BenchmarkConvertFormat();
+
+    TestResize();
+
+    BenchmarkResize();
+}
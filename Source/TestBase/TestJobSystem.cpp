@@ -0,0 +1,354 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "TestJobSystem.h"
+
+#define NUM_WORK_ITEMS      16384
+#define WORK_ITEM_SIZE      256
+
+static float workResults[NUM_WORK_ITEMS];
+
+static float DoWork(int index) {
+    float sum = 0.0f;
+    for (int i = 0; i < WORK_ITEM_SIZE; i++) {
+        sum += BE1::Math::Sqrt((float)(index * WORK_ITEM_SIZE + i));
+    }
+    return sum;
+}
+
+static void WorkTaskFunc(void *data) {
+    int index = (int)(intptr_t)data;
+    workResults[index] = DoWork(index);
+}
+
+static void WorkParallelForFunc(void *data, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+        workResults[i] = DoWork(i);
+    }
+}
+
+static void TestJobDependencies() {
+    static int order[3];
+    static std::atomic<int> counter;
+
+    counter = 0;
+
+    auto recordFunc = [](void *data) {
+        order[(intptr_t)data] = counter++;
+    };
+
+    BE1::JobHandle a = BE1::jobSystem.CreateJob(recordFunc, (void *)0);
+    BE1::JobHandle b = BE1::jobSystem.CreateJob(recordFunc, (void *)1);
+    BE1::JobHandle c = BE1::jobSystem.CreateJob(recordFunc, (void *)2);
+
+    // c -> b -> a
+    BE1::jobSystem.AddDependency(b, a);
+    BE1::jobSystem.AddDependency(c, b);
+
+    BE1::jobSystem.Run(c);
+    BE1::jobSystem.Run(b);
+    BE1::jobSystem.Run(a);
+    BE1::jobSystem.Wait(c);
+
+    assert(order[0] == 0 && order[1] == 1 && order[2] == 2);
+
+    // Depending on a finished job should not wait for it
+    BE1::JobHandle d = BE1::jobSystem.CreateJob(recordFunc, (void *)0);
+    BE1::jobSystem.Run(d);
+    BE1::jobSystem.Wait(d);
+
+    BE1::JobHandle e = BE1::jobSystem.CreateJob(recordFunc, (void *)1);
+    BE1::jobSystem.AddDependency(e, d);
+    BE1::jobSystem.Run(e);
+    BE1::jobSystem.Wait(e);
+
+    assert(order[0] == 3 && order[1] == 4);
+}
+
+// Runs more jobs than the pool size, so that slots are recycled while other jobs are still finishing
+static void TestJobRecycling() {
+    static std::atomic<int> counter;
+
+    counter = 0;
+
+    auto countFunc = [](void *) {
+        counter++;
+    };
+
+    const int numChains = BE1::JobSystem::MaxJobs * 4 / 3;
+
+    for (int i = 0; i < numChains; i++) {
+        BE1::JobHandle root = BE1::jobSystem.CreateJob(countFunc);
+        BE1::JobHandle child = BE1::jobSystem.CreateChildJob(root, countFunc);
+        BE1::JobHandle continuation = BE1::jobSystem.CreateJob(countFunc);
+
+        BE1::jobSystem.AddDependency(continuation, child);
+
+        BE1::jobSystem.Run(continuation);
+        BE1::jobSystem.Run(child);
+        BE1::jobSystem.Run(root);
+        BE1::jobSystem.Wait(root);
+        BE1::jobSystem.Wait(continuation);
+    }
+
+    assert(counter == numChains * 3);
+}
+
+// Handles of finished jobs should not refer to the jobs that reuse their slots
+static void TestStaleJobHandle() {
+    static std::atomic<int> counter;
+
+    counter = 0;
+
+    auto countFunc = [](void *) {
+        counter++;
+    };
+
+    BE1::JobHandle finished = BE1::jobSystem.CreateJob(countFunc);
+    BE1::jobSystem.Run(finished);
+    BE1::jobSystem.Wait(finished);
+
+    // Allocate jobs until one of them reuses the slot of the finished job
+    BE1::JobHandle reused;
+    for (int i = 0; i < BE1::JobSystem::MaxJobs * 2; i++) {
+        BE1::JobHandle job = BE1::jobSystem.CreateJob(countFunc);
+        if (job.job == finished.job) {
+            reused = job;
+            break;
+        }
+        BE1::jobSystem.Run(job);
+        BE1::jobSystem.Wait(job);
+    }
+    assert(reused.IsValid());
+
+    // The reused job is not submitted yet, so none of these should wait for it
+    assert(BE1::jobSystem.IsFinished(finished));
+    assert(!BE1::jobSystem.IsFinished(reused));
+    BE1::jobSystem.Wait(finished);
+
+    BE1::JobHandle dependent = BE1::jobSystem.CreateJob(countFunc);
+    BE1::jobSystem.AddDependency(dependent, finished);
+    BE1::jobSystem.Run(dependent);
+    BE1::jobSystem.Wait(dependent);
+
+    int count = counter;
+
+    BE1::jobSystem.Run(reused);
+    BE1::jobSystem.Wait(reused);
+
+    assert(counter == count + 1);
+}
+
+static void TestParallelFor() {
+    static float expected[NUM_WORK_ITEMS];
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        expected[i] = DoWork(i);
+    }
+
+    memset(workResults, 0, sizeof(workResults));
+    BE1::jobSystem.ParallelFor(NUM_WORK_ITEMS, 64, WorkParallelForFunc, nullptr);
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        assert(workResults[i] == expected[i]);
+    }
+}
+
+// ParallelFor from a non-worker thread should leave all the batches to the workers.
+static void TestNonWorkerParallelFor() {
+    static float expected[NUM_WORK_ITEMS];
+    static std::atomic<int> numNonWorkerBatches;
+
+    if (BE1::jobSystem.NumWorkers() <= 1) {
+        return;
+    }
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        expected[i] = DoWork(i);
+    }
+
+    memset(workResults, 0, sizeof(workResults));
+    numNonWorkerBatches = 0;
+
+    BE1::TaskManager taskManager(2, 1);
+    taskManager.AddTask([](void *) {
+        BE1::jobSystem.ParallelFor(NUM_WORK_ITEMS, 64, [](void *data, int begin, int end) {
+            if (BE1::jobSystem.GetCurrentWorkerIndex() < 0) {
+                numNonWorkerBatches++;
+            }
+            WorkParallelForFunc(data, begin, end);
+        }, nullptr);
+    }, nullptr);
+    taskManager.Start();
+    taskManager.WaitFinish();
+
+    assert(numNonWorkerBatches == 0);
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        assert(workResults[i] == expected[i]);
+    }
+}
+
+// data is the offset of the work items.
+static void ScratchParallelForFunc(void *data, int begin, int end) {
+    const int offset = (int)(intptr_t)data;
+
+    for (int i = begin + offset; i < end + offset; i++) {
+        BE1::ScratchAllocator::Scope scratchScope;
+
+        // Bigger than a block every 64 items
+        int count = (i & 63) ? 1000 : BE1::ScratchAllocator::BlockSize;
+        int *outer = BE1::scratchAllocator.Alloc<int>(count);
+        for (int j = 0; j < count; j++) {
+            outer[j] = i;
+        }
+
+        {
+            BE1::ScratchAllocator::Scope innerScratchScope;
+
+            int *inner = BE1::scratchAllocator.Alloc<int>(count);
+            assert(((intptr_t)inner & 15) == 0);
+            memset(inner, 0xff, count * sizeof(inner[0]));
+        }
+
+        int numMatches = 0;
+        for (int j = 0; j < count; j++) {
+            numMatches += outer[j] == i ? 1 : 0;
+        }
+        workResults[i] = (float)numMatches;
+    }
+}
+
+static void TestScratchAllocator() {
+    memset(workResults, 0, sizeof(workResults));
+    BE1::jobSystem.ParallelFor(NUM_WORK_ITEMS, 16, ScratchParallelForFunc, nullptr);
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        assert(workResults[i] == (float)((i & 63) ? 1000 : BE1::ScratchAllocator::BlockSize));
+    }
+
+    // Non-worker threads allocate at the same time as the workers.
+    memset(workResults, 0, sizeof(workResults));
+
+    const int numTasks = 16;
+    const int numTaskItems = NUM_WORK_ITEMS / 2 / numTasks;
+
+    BE1::TaskManager taskManager(numTasks + 1);
+    for (int i = 0; i < numTasks; i++) {
+        taskManager.AddTask([](void *data) {
+            const int index = (int)(intptr_t)data;
+            ScratchParallelForFunc((void *)(intptr_t)(index * numTaskItems), 0, numTaskItems);
+        }, (void *)(intptr_t)i);
+    }
+    taskManager.Start();
+
+    BE1::jobSystem.ParallelFor(NUM_WORK_ITEMS / 2, 16, ScratchParallelForFunc, (void *)(intptr_t)(NUM_WORK_ITEMS / 2));
+
+    taskManager.WaitFinish();
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        assert(workResults[i] == (float)((i & 63) ? 1000 : BE1::ScratchAllocator::BlockSize));
+    }
+
+    // More short-lived threads than ScratchAllocator::MaxThreads in total.
+    static std::atomic<int> numStartedTasks;
+
+    const int numRounds = 4;
+    const int numRoundThreads = BE1::ScratchAllocator::MaxThreads / 2;
+    const int numThreadItems = NUM_WORK_ITEMS / numRounds / numRoundThreads;
+
+    memset(workResults, 0, sizeof(workResults));
+
+    for (int round = 0; round < numRounds; round++) {
+        BE1::TaskManager roundTaskManager(numRoundThreads + 1, numRoundThreads);
+        numStartedTasks = 0;
+        for (int i = 0; i < numRoundThreads; i++) {
+            roundTaskManager.AddTask([](void *data) {
+                // Wait for all the tasks to start, so that each task runs on its own thread
+                numStartedTasks++;
+                while (numStartedTasks < numRoundThreads) {}
+
+                const int index = (int)(intptr_t)data;
+                ScratchParallelForFunc((void *)(intptr_t)(index * numThreadItems), 0, numThreadItems);
+            }, (void *)(intptr_t)(round * numRoundThreads + i));
+        }
+        roundTaskManager.Start();
+        roundTaskManager.WaitFinish();
+    }
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        assert(workResults[i] == (float)((i & 63) ? 1000 : BE1::ScratchAllocator::BlockSize));
+    }
+}
+
+static void BenchmarkTaskManager() {
+    BE1::TaskManager taskManager(NUM_WORK_ITEMS + 1);
+
+    uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+    for (int i = 0; i < NUM_WORK_ITEMS; i++) {
+        taskManager.AddTask(WorkTaskFunc, (void *)(intptr_t)i);
+    }
+    taskManager.Start();
+    taskManager.WaitFinish();
+
+    uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+    BE_LOG("TaskManager (%i threads): %i tasks in %" PRIu64 " us\n", (int)taskManager.NumThreads(), NUM_WORK_ITEMS, t1 - t0);
+}
+
+static void BenchmarkJobSystem() {
+    uint64_t t0 = BE1::PlatformTime::Microseconds();
+
+    // One job per work item, like the TaskManager benchmark.
+    for (int i = 0; i < NUM_WORK_ITEMS; i += BE1::JobSystem::MaxJobs / 2) {
+        int count = BE1::Min(NUM_WORK_ITEMS - i, BE1::JobSystem::MaxJobs / 2);
+
+        BE1::JobHandle root = BE1::jobSystem.CreateJob([](void *) {});
+        for (int j = 0; j < count; j++) {
+            BE1::JobHandle job = BE1::jobSystem.CreateChildJob(root, WorkTaskFunc, (void *)(intptr_t)(i + j));
+            BE1::jobSystem.Run(job);
+        }
+        BE1::jobSystem.Run(root);
+        BE1::jobSystem.Wait(root);
+    }
+
+    uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+    BE1::jobSystem.ParallelFor(NUM_WORK_ITEMS, 64, WorkParallelForFunc, nullptr);
+
+    uint64_t t2 = BE1::PlatformTime::Microseconds();
+
+    BE_LOG("JobSystem (%i workers): %i jobs in %" PRIu64 " us\n", BE1::jobSystem.NumWorkers(), NUM_WORK_ITEMS, t1 - t0);
+    BE_LOG("JobSystem (%i workers): ParallelFor %i items in %" PRIu64 " us\n", BE1::jobSystem.NumWorkers(), NUM_WORK_ITEMS, t2 - t1);
+}
+
+void TestJobSystem() {
+    TestJobDependencies();
+
+    TestJobRecycling();
+
+    TestStaleJobHandle();
+
+    TestParallelFor();
+
+    TestNonWorkerParallelFor();
+
+    TestScratchAllocator();
+
+    BenchmarkTaskManager();
+
+    BenchmarkJobSystem();
+}
@@ -323,6 +323,71 @@ static void TestCompile(LuaCpp::State &lua) {
     }
 }
 
+// Sandboxed scripts allocating garbage every frame like script components do.
+static void TestGCStress() {
+    static constexpr int NumSandboxes = 2000;
+    static constexpr int NumWarmUpFrames = 100;
+    static constexpr int NumFrames = 400;
+
+    BE1::LuaVM luaVM;
+    luaVM.Init();
+
+    LuaCpp::State &lua = luaVM.State();
+
+    const char *script = R"(
+        pos = { x = 0, y = 0, z = 0 }
+        history = {}
+        function update(dt)
+            local p = pos
+            pos = { x = p.x + dt, y = p.y + dt * 2, z = p.z }
+            history[#history % 8 + 1] = tostring(p.x)
+        end
+    )";
+
+    BE1::Array<LuaCpp::Selector> updateFuncs;
+    for (int i = 0; i < NumSandboxes; i++) {
+        const char *sandboxName = BE1::va("gc_stress_%i", i);
+        lua.RunBuffer("gc_stress", script, 0, sandboxName);
+        updateFuncs.Append(lua[sandboxName]["update"]);
+    }
+
+    const int budget = BE1::cvarSystem.GetCVarInteger("lua_gcBudget");
+
+    BE1::Array<int> gcTimes;
+    int warmUpHeapKb = 0;
+    int maxHeapKb = 0;
+
+    for (int frame = 0; frame < NumFrames; frame++) {
+        for (int i = 0; i < updateFuncs.Count(); i++) {
+            updateFuncs[i](0.016f);
+        }
+
+        luaVM.CollectGarbage();
+
+        if (frame < NumWarmUpFrames) {
+            warmUpHeapKb = BE1::Max(warmUpHeapKb, luaVM.GetGCHeapKb());
+        } else {
+            maxHeapKb = BE1::Max(maxHeapKb, luaVM.GetGCHeapKb());
+            gcTimes.Append(luaVM.GetGCTime());
+        }
+    }
+
+    gcTimes.Sort();
+
+    BE_LOG("Lua GC stress: budget %i us, GC p50 %i us, p99 %i us, heap %i KB -> %i KB\n", budget,
+        gcTimes[gcTimes.Count() / 2], gcTimes[gcTimes.Count() * 99 / 100], warmUpHeapKb, maxHeapKb);
+
+    // Incremental steps must keep up with the garbage, not let the heap grow.
+    assert(maxHeapKb <= warmUpHeapKb * 2);
+    if (budget > 0) {
+        assert(gcTimes[gcTimes.Count() / 2] <= budget * 2);
+    }
+
+    updateFuncs.Clear();
+
+    luaVM.Shutdown();
+}
+
 void TestLua() {
     LuaCpp::State lua(true);
 
@@ -360,4 +425,6 @@ void TestLua() {
     TestTableEnumeration(lua);
     TestModule(lua);
     TestCompile(lua);
+
+    TestGCStress();
 }
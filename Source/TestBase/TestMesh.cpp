@@ -0,0 +1,586 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "BlueshiftEngine.h"
+#include "../Runtime/Private/Render/BModel.h"
+#include "TestMesh.h"
+
+static uint32_t randomSeed;
+
+static float RandomFloat(float min, float max) {
+    randomSeed = randomSeed * 1664525 + 1013904223;
+    return min + (max - min) * ((randomSeed >> 8) / (float)(1 << 24));
+}
+
+static BE1::Vec3 RandomDir() {
+    BE1::Vec3 dir(RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f), RandomFloat(-1.0f, 1.0f));
+    dir.Normalize();
+    return dir;
+}
+
+// Makes a UV sphere with counter clock-wise triangles seen from outside.
+static void MakeSphere(const BE1::Vec3 &center, float radius, int numSlices, int numStacks, BE1::Array<BE1::VertexGenericLit> &verts, BE1::Array<BE1::TriIndex> &indexes) {
+    verts.SetCount((numStacks + 1) * (numSlices + 1));
+    indexes.SetCount(0, false);
+
+    for (int stack = 0; stack <= numStacks; stack++) {
+        float phi = BE1::Math::Pi * stack / numStacks;
+
+        for (int slice = 0; slice <= numSlices; slice++) {
+            float theta = BE1::Math::TwoPi * slice / numSlices;
+
+            BE1::VertexGenericLit &v = verts[stack * (numSlices + 1) + slice];
+            v.Clear();
+            v.xyz = center + radius * BE1::Vec3(BE1::Math::Sin(phi) * BE1::Math::Cos(theta), BE1::Math::Sin(phi) * BE1::Math::Sin(theta), BE1::Math::Cos(phi));
+        }
+    }
+
+    for (int stack = 0; stack < numStacks; stack++) {
+        for (int slice = 0; slice < numSlices; slice++) {
+            BE1::TriIndex i0 = stack * (numSlices + 1) + slice;
+            BE1::TriIndex i1 = i0 + 1;
+            BE1::TriIndex i2 = i0 + numSlices + 1;
+            BE1::TriIndex i3 = i2 + 1;
+
+            if (stack > 0) {
+                indexes.Append(i0);
+                indexes.Append(i2);
+                indexes.Append(i1);
+            }
+            if (stack < numStacks - 1) {
+                indexes.Append(i1);
+                indexes.Append(i2);
+                indexes.Append(i3);
+            }
+        }
+    }
+}
+
+// Tests all the triangles one by one. Front faces are counter clock-wise.
+static bool IntersectRayBruteForce(const BE1::Array<BE1::VertexGenericLit> &verts, const BE1::Array<BE1::TriIndex> &indexes, const BE1::Ray &ray, bool ignoreBackFace, float maxDist, float &hitDist) {
+    hitDist = maxDist;
+    bool hit = false;
+
+    for (int i = 0; i < indexes.Count(); i += 3) {
+        const BE1::Vec3 &v0 = verts[indexes[i]].xyz;
+        const BE1::Vec3 e1 = verts[indexes[i + 1]].xyz - v0;
+        const BE1::Vec3 e2 = verts[indexes[i + 2]].xyz - v0;
+
+        const BE1::Vec3 p = ray.dir.Cross(e2);
+        const float det = e1.Dot(p);
+        if (ignoreBackFace ? det <= 0.0f : det == 0.0f) {
+            continue;
+        }
+
+        const float invDet = 1.0f / det;
+        const BE1::Vec3 s = ray.origin - v0;
+        const float u = s.Dot(p) * invDet;
+        if (u < 0.0f || u > 1.0f) {
+            continue;
+        }
+
+        const BE1::Vec3 q = s.Cross(e1);
+        const float v = ray.dir.Dot(q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) {
+            continue;
+        }
+
+        const float t = e2.Dot(q) * invDet;
+        if (t >= 0.0f && t < hitDist) {
+            hitDist = t;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+// Rays from outside of the sphere to a random point inside of it, and from inside to outside.
+static BE1::Ray RandomSphereRay(const BE1::Vec3 &center, float radius, bool inside) {
+    BE1::Ray ray;
+    if (inside) {
+        ray.origin = center + RandomDir() * RandomFloat(0.0f, radius * 0.5f);
+        ray.dir = RandomDir();
+    } else {
+        ray.origin = center + RandomDir() * RandomFloat(radius * 1.5f, radius * 4.0f);
+        ray.dir = center + RandomDir() * RandomFloat(0.0f, radius * 1.2f) - ray.origin;
+        ray.dir.Normalize();
+    }
+    return ray;
+}
+
+static void CompareRays(const BE1::TriangleBVH &bvh, const BE1::Array<BE1::VertexGenericLit> &verts, const BE1::Array<BE1::TriIndex> &indexes, const BE1::Vec3 &center, float radius, int numSlices) {
+    // Distance from the sphere to the triangles is less than the sagitta of the diagonal of a quad.
+    const float tessellationError = radius * (1.0f - BE1::Math::Cos(BE1::Math::TwoPi / numSlices));
+
+    for (int i = 0; i < 500; i++) {
+        bool inside = (i & 3) == 0;
+        bool ignoreBackFace = (i & 1) != 0;
+        BE1::Ray ray = RandomSphereRay(center, radius, inside);
+
+        float bruteForceDist;
+        bool bruteForceHit = IntersectRayBruteForce(verts, indexes, ray, ignoreBackFace, FLT_MAX, bruteForceDist);
+
+        float hitDist = -1.0f;
+        bool hit = bvh.IntersectRay(ray, ignoreBackFace, false, FLT_MAX, &hitDist);
+
+        assert(hit == bruteForceHit);
+        assert(!hit || BE1::Math::Fabs(hitDist - bruteForceDist) < 0.001f);
+
+        // Any hit stops at the first hit but still finds one.
+        assert(bvh.IntersectRay(ray, ignoreBackFace, true, FLT_MAX) == bruteForceHit);
+
+        // Clipped by the max distance.
+        if (hit) {
+            assert(!bvh.IntersectRay(ray, ignoreBackFace, false, hitDist * 0.99f));
+        }
+
+        // Inner side of the sphere is back faces.
+        if (inside) {
+            assert(ignoreBackFace ? !hit : hit);
+        }
+
+        // Hit points are on the sphere up to the tessellation error.
+        if (hit) {
+            float dist = (ray.GetPoint(hitDist) - center).Length();
+            assert(dist > radius - tessellationError && dist < radius + 0.001f);
+        }
+    }
+}
+
+static void TestTriangleBVHIntersectRay() {
+    BE1::Array<BE1::VertexGenericLit> verts;
+    BE1::Array<BE1::TriIndex> indexes;
+
+    BE1::Vec3 center(1.0f, 2.0f, 3.0f);
+    float radius = 10.0f;
+
+    randomSeed = 1;
+
+    MakeSphere(center, radius, 64, 32, verts, indexes);
+
+    BE1::TriangleBVH bvh;
+    bvh.Build(verts.Ptr(), indexes.Ptr(), indexes.Count());
+    assert(bvh.IsValid());
+
+    CompareRays(bvh, verts, indexes, center, radius, 64);
+
+    // Refit to the moved and scaled vertices.
+    BE1::Vec3 newCenter(-20.0f, 5.0f, 0.0f);
+    float newRadius = 25.0f;
+
+    for (int i = 0; i < verts.Count(); i++) {
+        verts[i].xyz = newCenter + (verts[i].xyz - center) * (newRadius / radius);
+    }
+
+    bvh.InvalidateVertices();
+    assert(!bvh.IsValid());
+    bvh.Update(verts.Ptr(), indexes.Ptr(), indexes.Count());
+    assert(bvh.IsValid());
+
+    CompareRays(bvh, verts, indexes, newCenter, newRadius, 64);
+
+    // Rebuild with the different triangles.
+    MakeSphere(center, radius, 24, 12, verts, indexes);
+
+    bvh.Invalidate();
+    bvh.Update(verts.Ptr(), indexes.Ptr(), indexes.Count());
+    assert(bvh.IsValid());
+
+    CompareRays(bvh, verts, indexes, center, radius, 24);
+}
+
+// The first queries from multiple workers update the invalidated BVH only once, and all of them see the updated BVH.
+static void TestTriangleBVHConcurrentUpdate() {
+    static const int numRays = 256;
+
+    struct QueryContext {
+        BE1::TriangleBVH *      bvh;
+        const BE1::VertexGenericLit *verts;
+        const BE1::TriIndex *   indexes;
+        int                     numIndexes;
+        const BE1::Ray *        rays;
+        float *                 hitDists;
+    };
+
+    BE1::Array<BE1::VertexGenericLit> verts;
+    BE1::Array<BE1::TriIndex> indexes;
+
+    BE1::Vec3 center(0.0f, 0.0f, 0.0f);
+    float radius = 10.0f;
+
+    randomSeed = 2;
+
+    MakeSphere(center, radius, 128, 64, verts, indexes);
+
+    BE1::Ray rays[numRays];
+    float hitDists[numRays];
+    for (int i = 0; i < numRays; i++) {
+        rays[i] = RandomSphereRay(center, radius, false);
+    }
+
+    BE1::TriangleBVH bvh;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 0) {
+            bvh.Invalidate();
+        } else {
+            for (int i = 0; i < verts.Count(); i++) {
+                verts[i].xyz *= 0.5f;
+            }
+            bvh.InvalidateVertices();
+        }
+
+        QueryContext context = { &bvh, verts.Ptr(), indexes.Ptr(), indexes.Count(), rays, hitDists };
+
+        BE1::jobSystem.ParallelFor(numRays, 1, [](void *data, int begin, int end) {
+            const QueryContext *context = (const QueryContext *)data;
+
+            for (int i = begin; i < end; i++) {
+                context->bvh->Update(context->verts, context->indexes, context->numIndexes);
+
+                if (!context->bvh->IntersectRay(context->rays[i], false, false, FLT_MAX, &context->hitDists[i])) {
+                    context->hitDists[i] = -1.0f;
+                }
+            }
+        }, &context);
+
+        for (int i = 0; i < numRays; i++) {
+            float bruteForceDist;
+            if (IntersectRayBruteForce(verts, indexes, rays[i], false, FLT_MAX, bruteForceDist)) {
+                assert(BE1::Math::Fabs(hitDists[i] - bruteForceDist) < 0.001f);
+            } else {
+                assert(hitDists[i] == -1.0f);
+            }
+        }
+    }
+}
+
+// Sorted triangle centroids to compare the triangles regardless of the order of the triangles and vertices.
+static void GetSortedCentroids(const BE1::SubMesh *subMesh, BE1::Array<BE1::Vec3> &centroids) {
+    centroids.SetCount(0, false);
+
+    for (int i = 0; i < subMesh->NumIndexes(); i += 3) {
+        const BE1::VertexGenericLit *verts = subMesh->Verts();
+        const BE1::TriIndex *indexes = subMesh->Indexes();
+        centroids.Append((verts[indexes[i]].xyz + verts[indexes[i + 1]].xyz + verts[indexes[i + 2]].xyz) / 3.0f);
+    }
+
+    centroids.Sort([](const BE1::Vec3 &a, const BE1::Vec3 &b) -> bool {
+        return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+    });
+}
+
+static void TestOptimizeIndices() {
+    BE1::Mesh mesh;
+    mesh.CreatePlane(BE1::Vec3::origin, BE1::Mat3::identity, 10.0f, 64);
+
+    BE1::SubMesh *subMesh = mesh.GetSurface(0)->subMesh;
+    BE1::TriIndex *indexes = subMesh->Indexes();
+    const int numTris = subMesh->NumIndexes() / 3;
+
+    // Shuffle the triangles with the fixed seed.
+    randomSeed = 3;
+
+    for (int i = numTris - 1; i > 0; i--) {
+        int j = BE1::Min((int)RandomFloat(0.0f, (float)(i + 1)), i);
+        for (int k = 0; k < 3; k++) {
+            BE1::Swap(indexes[i * 3 + k], indexes[j * 3 + k]);
+        }
+    }
+
+    BE1::Array<BE1::Vec3> oldCentroids;
+    GetSortedCentroids(subMesh, oldCentroids);
+
+    float oldACMR, oldATVR;
+    BE1::SubMesh::GetVertexCacheStats(subMesh->Indexes(), subMesh->NumIndexes(), subMesh->NumVerts(), oldACMR, oldATVR);
+
+    mesh.FinishSurfaces(BE1::Mesh::FinishFlag::OptimizeIndices);
+
+    float newACMR, newATVR;
+    BE1::SubMesh::GetVertexCacheStats(subMesh->Indexes(), subMesh->NumIndexes(), subMesh->NumVerts(), newACMR, newATVR);
+
+    BE_LOG("Optimize indices: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", oldACMR, newACMR, oldATVR, newATVR);
+
+    // Shuffled grid misses the cache for almost every vertex. A grid would get 0.5 with an infinite cache.
+    assert(oldACMR > 2.0f);
+    assert(newACMR < 0.8f);
+    assert(newATVR < 1.6f);
+
+    // Same triangles with the same vertices.
+    BE1::Array<BE1::Vec3> newCentroids;
+    GetSortedCentroids(subMesh, newCentroids);
+
+    assert(oldCentroids.Count() == newCentroids.Count());
+    for (int i = 0; i < oldCentroids.Count(); i++) {
+        assert(oldCentroids[i] == newCentroids[i]);
+    }
+}
+
+static void TestGenerateLods() {
+    const float radius = 10.0f;
+
+    BE1::Mesh mesh;
+    mesh.CreateSphere(BE1::Vec3::origin, BE1::Mat3::identity, radius, 64);
+
+    mesh.GenerateLods(3, 0.5f);
+
+    const BE1::MeshSurf *surf = mesh.GetSurface(0);
+    const int numTris = surf->subMesh->NumIndexes() / 3;
+
+    assert(mesh.NumLodLevels() == 3);
+    assert(surf->numLodLevels == 3);
+
+    for (int lodLevel = 1; lodLevel <= surf->numLodLevels; lodLevel++) {
+        const BE1::SubMesh *lodSubMesh = surf->GetLodSubMesh(lodLevel);
+        const BE1::VertexGenericLit *verts = lodSubMesh->Verts();
+        const BE1::TriIndex *indexes = lodSubMesh->Indexes();
+        const int numLodTris = lodSubMesh->NumIndexes() / 3;
+
+        // Each level halves the triangles of the original mesh.
+        const int targetNumTris = numTris >> lodLevel;
+        assert(numLodTris > targetNumTris * 0.9f && numLodTris <= targetNumTris);
+
+        // LOD vertices are taken from the original vertices on the sphere, so the error is
+        // how far the triangles are cut inside the sphere.
+        float maxError = 0.0f;
+        for (int i = 0; i < lodSubMesh->NumIndexes(); i += 3) {
+            const BE1::Vec3 centroid = (verts[indexes[i]].xyz + verts[indexes[i + 1]].xyz + verts[indexes[i + 2]].xyz) / 3.0f;
+            maxError = BE1::Max(maxError, radius - centroid.Length());
+        }
+        for (int i = 0; i < lodSubMesh->NumVerts(); i++) {
+            assert(BE1::Math::Fabs(verts[i].xyz.Length() - radius) < radius * 0.001f);
+        }
+
+        BE_LOG("Generate LODs: level %i %i tris -> %i tris, error %.3f\n", lodLevel, numTris, numLodTris, maxError);
+
+        assert(maxError < radius * 0.05f * lodLevel);
+
+        // Smaller on screen for lower levels.
+        if (lodLevel > 1) {
+            assert(mesh.GetLodScreenSize(lodLevel) < mesh.GetLodScreenSize(lodLevel - 1));
+        }
+    }
+
+    // Too few triangles to simplify.
+    BE1::Mesh box;
+    box.CreateBox(BE1::Vec3::origin, BE1::Mat3::identity, BE1::Vec3(1.0f));
+    box.GenerateLods(3, 0.5f);
+
+    assert(box.NumLodLevels() == 0);
+}
+
+static const int NumSkinningJoints = 4;
+static const int SkinnedGridSize = 100;
+
+static const char *skinnedMeshFilename = "TestMeshSkinned.bmesh";
+
+// Writes a grid skinned along the x axis with 4 joints in .bmesh format.
+// Each vertex is weighted to the two nearest joints.
+static bool WriteSkinnedGridMesh(const char *filename) {
+    BE1::File *fp = BE1::fileSystem.OpenFile(filename, BE1::File::Mode::Write);
+    if (!fp) {
+        return false;
+    }
+
+    const int numVerts = (SkinnedGridSize + 1) * (SkinnedGridSize + 1);
+    const int numIndexes = SkinnedGridSize * SkinnedGridSize * 6;
+
+    BE1::BMeshHeader bMeshHeader;
+    bMeshHeader.ident = BMESH_IDENT;
+    bMeshHeader.version = BMESH_VERSION;
+    bMeshHeader.numJoints = NumSkinningJoints;
+    bMeshHeader.numSurfs = 1;
+    bMeshHeader.aabbMin = BE1::Vec3(0.0f, 0.0f, 0.0f);
+    bMeshHeader.aabbMax = BE1::Vec3(1.0f, 1.0f, 0.0f);
+    fp->Write(&bMeshHeader, sizeof(bMeshHeader));
+
+    for (int jointIndex = 0; jointIndex < NumSkinningJoints; jointIndex++) {
+        BE1::BJoint bJoint;
+        BE1::Str::Copynz(bJoint.name, BE1::va("joint%i", jointIndex), sizeof(bJoint.name));
+        bJoint.parentIndex = jointIndex - 1;
+        fp->Write(&bJoint, sizeof(bJoint));
+    }
+
+    BE1::BMeshSurf bMeshSurf;
+    bMeshSurf.materialIndex = 0;
+    bMeshSurf.numVerts = numVerts;
+    bMeshSurf.numIndexes = numIndexes;
+    bMeshSurf.indexSize = sizeof(uint16_t);
+    bMeshSurf.maxWeights = 4;
+    bMeshSurf.aabbMin = bMeshHeader.aabbMin;
+    bMeshSurf.aabbMax = bMeshHeader.aabbMax;
+    fp->Write(&bMeshSurf, sizeof(bMeshSurf));
+
+    for (int y = 0; y <= SkinnedGridSize; y++) {
+        for (int x = 0; x <= SkinnedGridSize; x++) {
+            BE1::BMeshVert bMeshVert;
+            memset(&bMeshVert, 0, sizeof(bMeshVert));
+            bMeshVert.position = BE1::Vec3((float)x / SkinnedGridSize, (float)y / SkinnedGridSize, 0.0f);
+            bMeshVert.texCoord = bMeshVert.position.ToVec2();
+            bMeshVert.normal = BE1::Vec3::unitZ;
+            bMeshVert.tangent = BE1::Vec3::unitX;
+            bMeshVert.bitangent = BE1::Vec3::unitY;
+            bMeshVert.color = 0xffffffff;
+            fp->Write(&bMeshVert, sizeof(bMeshVert));
+        }
+    }
+
+    for (int y = 0; y <= SkinnedGridSize; y++) {
+        for (int x = 0; x <= SkinnedGridSize; x++) {
+            const float s = (float)x / SkinnedGridSize * (NumSkinningJoints - 1);
+            const int jointIndex = BE1::Min((int)s, NumSkinningJoints - 2);
+            const int weight = (int)((s - jointIndex) * 255.0f + 0.5f);
+
+            byte vertWeight[8] = { (byte)jointIndex, (byte)(jointIndex + 1), 0, 0, (byte)(255 - weight), (byte)weight, 0, 0 };
+            fp->Write(vertWeight, sizeof(vertWeight));
+        }
+    }
+
+    for (int y = 0; y < SkinnedGridSize; y++) {
+        for (int x = 0; x < SkinnedGridSize; x++) {
+            uint16_t i0 = y * (SkinnedGridSize + 1) + x;
+            uint16_t i1 = i0 + 1;
+            uint16_t i2 = i0 + SkinnedGridSize + 1;
+            uint16_t i3 = i2 + 1;
+            uint16_t indexes[6] = { i0, i1, i2, i2, i1, i3 };
+            fp->Write(indexes, sizeof(indexes));
+        }
+    }
+
+    // Sub mesh data is 8 bytes aligned
+    byte dummy[8] = { 0, };
+    int offset = fp->Tell();
+    fp->Write(dummy, BE1::AlignUp(offset, 8) - offset);
+
+    BE1::BMeshLods bMeshLods;
+    memset(&bMeshLods, 0, sizeof(bMeshLods));
+    fp->Write(&bMeshLods, sizeof(bMeshLods));
+    fp->WriteUInt32(0);
+
+    BE1::fileSystem.CloseFile(fp);
+    return true;
+}
+
+// Skinned mesh instance falls back to the CPU skinning without the GPU skinning capable renderer.
+// Skinned vertices are split across the job system workers, so compares them with the linear blend of each vertex.
+static void TestCpuSkinning() {
+    if (!WriteSkinnedGridMesh(skinnedMeshFilename)) {
+        BE_WARNLOG("TestCpuSkinning: failed to write '%s'\n", skinnedMeshFilename);
+        return;
+    }
+
+    BE1::Mesh mesh;
+    mesh.Load(skinnedMeshFilename);
+    assert(mesh.NumJoints() == NumSkinningJoints && mesh.NumSurfaces() == 1);
+
+    BE1::Mesh *instance = mesh.InstantiateMesh(BE1::Mesh::Type::Skinned);
+    assert(instance->IsSkinnedMesh());
+
+    const BE1::SubMesh *subMesh = instance->GetSurface(0)->subMesh;
+    assert(!subMesh->IsGpuSkinning());
+
+    BE1::Mat3x4 skinningJoints[NumSkinningJoints];
+    for (int jointIndex = 0; jointIndex < NumSkinningJoints; jointIndex++) {
+        BE1::Mat3 rotation = BE1::Rotation(BE1::Vec3::origin, BE1::Vec3(0.6f, 0.8f, 0.0f), 30.0f * jointIndex).ToMat3();
+        skinningJoints[jointIndex] = BE1::Mat3x4(rotation, BE1::Vec3(0.0f, 0.1f * jointIndex, 0.2f * jointIndex));
+    }
+
+    BE1::VertexGenericLit *skinnedVerts = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(sizeof(BE1::VertexGenericLit) * subMesh->NumVerts());
+    subMesh->SkinVerts(skinningJoints, skinnedVerts);
+
+    const BE1::VertexGenericLit *verts = subMesh->Verts();
+    const BE1::VertexWeight4 *vertWeights = (const BE1::VertexWeight4 *)subMesh->VertexWeights();
+    assert(subMesh->MaxVertexWeights() == 4);
+
+    for (int i = 0; i < subMesh->NumVerts(); i++) {
+        BE1::Mat3x4 blendedMat = BE1::Mat3x4::zero;
+        for (int j = 0; j < 4; j++) {
+            blendedMat += skinningJoints[vertWeights[i].jointIndexes[j]] * JOINT_WEIGHT_TO_FLOAT(vertWeights[i].jointWeights[j]);
+        }
+
+        const BE1::Vec3 position = blendedMat.Transform(verts[i].xyz);
+        BE1::Vec3 normal = blendedMat.TransformNormal(verts[i].GetNormal());
+        normal.Normalize();
+
+        assert(skinnedVerts[i].xyz.Distance(position) < 1e-4f);
+        assert(skinnedVerts[i].GetNormal().Distance(normal) < 0.02f);
+    }
+
+    BE1::Mem_AlignedFree(skinnedVerts);
+
+    BE1::meshManager.ReleaseMesh(instance);
+
+    BE1::fileSystem.RemoveFile(skinnedMeshFilename, true);
+}
+
+// Ray tests of skinned mesh instance use the bind pose until the triangle BVH is posed.
+// Posing an instance should not move the shared BVH of the reference mesh.
+static void TestPosedTriangleBVH() {
+    if (!WriteSkinnedGridMesh(skinnedMeshFilename)) {
+        BE_WARNLOG("TestPosedTriangleBVH: failed to write '%s'\n", skinnedMeshFilename);
+        return;
+    }
+
+    BE1::Mesh mesh;
+    mesh.Load(skinnedMeshFilename);
+
+    BE1::Mesh *instance = mesh.InstantiateMesh(BE1::Mesh::Type::Skinned);
+    assert(instance->IsSkinnedMesh());
+
+    // Ray hitting the grid in the bind pose, and the ray hitting the grid moved by the pose
+    BE1::Ray bindPoseRay;
+    bindPoseRay.origin = BE1::Vec3(0.5f, 0.5f, 5.0f);
+    bindPoseRay.dir = -BE1::Vec3::unitZ;
+
+    BE1::Ray posedRay;
+    posedRay.origin = BE1::Vec3(2.5f, 0.5f, 5.0f);
+    posedRay.dir = -BE1::Vec3::unitZ;
+
+    float hitDist;
+    bool hit = instance->IntersectRay(bindPoseRay, true, &hitDist);
+    assert(hit && BE1::Math::Fabs(hitDist - 5.0f) < 1e-4f);
+    assert(!instance->IntersectRay(posedRay, true, &hitDist));
+
+    BE1::Mat3x4 skinningJoints[NumSkinningJoints];
+    for (int pose = 1; pose <= 2; pose++) {
+        for (int jointIndex = 0; jointIndex < NumSkinningJoints; jointIndex++) {
+            skinningJoints[jointIndex] = BE1::Mat3x4(BE1::Mat3::identity, BE1::Vec3(2.0f, 0.0f, (float)pose));
+        }
+
+        // Same pose again doesn't skin the vertices again
+        instance->PoseTriangleBVHs(skinningJoints);
+        instance->PoseTriangleBVHs(skinningJoints);
+
+        assert(!instance->IntersectRay(bindPoseRay, true, &hitDist));
+        hit = instance->IntersectRay(posedRay, true, &hitDist);
+        assert(hit && BE1::Math::Fabs(hitDist - (5.0f - pose)) < 1e-4f);
+
+        hit = mesh.IntersectRay(bindPoseRay, true, &hitDist);
+        assert(hit && BE1::Math::Fabs(hitDist - 5.0f) < 1e-4f);
+    }
+
+    BE1::meshManager.ReleaseMesh(instance);
+
+    BE1::fileSystem.RemoveFile(skinnedMeshFilename, true);
+}
+
+void TestMesh() {
+    TestTriangleBVHIntersectRay();
+    TestTriangleBVHConcurrentUpdate();
+    TestOptimizeIndices();
+    TestGenerateLods();
+    TestCpuSkinning();
+    TestPosedTriangleBVH();
+}
@@ -0,0 +1,168 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "TestRadixSort.h"
+
+// Mimics DrawSurf for the benchmark, sortKey is not the first member.
+struct TestSurf {
+    int         flags;
+    const void *material;
+    uint64_t    sortKey;
+};
+
+static uint32_t randomSeed;
+
+static uint32_t NextRandom() {
+    randomSeed = randomSeed * 1664525 + 1013904223;
+    return randomSeed;
+}
+
+// Generates sort keys laid out like the draw surface sort keys.
+// visLight index is 0 and material sort takes a few values, so some passes can be skipped.
+static uint64_t RandomSortKey() {
+    uint64_t materialSort = NextRandom() % 3;
+    uint64_t subMeshIndex = NextRandom() & 0xFF;
+    uint64_t materialIndex = NextRandom() & 0x3FF;
+    uint64_t visObjectIndex = NextRandom() & 0xFFFF;
+    return (materialSort << 48) | (subMeshIndex << 32) | (materialIndex << 16) | visObjectIndex;
+}
+
+static int BE_CDECL CompareTestSurf(const void *elem1, const void *elem2) {
+    const uint64_t sortKey1 = (*(TestSurf **)elem1)->sortKey;
+    const uint64_t sortKey2 = (*(TestSurf **)elem2)->sortKey;
+
+    if (sortKey1 < sortKey2) {
+        return -1;
+    }
+    if (sortKey1 > sortKey2) {
+        return 1;
+    }
+    return 0;
+}
+
+static void TestRadixSortCorrectness() {
+    const int count = 100000;
+
+    BE1::Array<uint64_t> keys;
+    BE1::Array<int> values;
+    BE1::Array<uint64_t> tempKeys;
+    BE1::Array<int> tempValues;
+
+    keys.SetCount(count);
+    values.SetCount(count);
+    tempKeys.SetCount(count);
+    tempValues.SetCount(count);
+
+    for (int parallel = 0; parallel < 2; parallel++) {
+        randomSeed = 1;
+        for (int i = 0; i < count; i++) {
+            keys[i] = RandomSortKey();
+            values[i] = i;
+        }
+
+        BE1::Array<uint64_t> originalKeys = keys;
+
+        if (parallel) {
+            BE1::RadixSort64_Parallel(keys.Ptr(), values.Ptr(), count, tempKeys.Ptr(), tempValues.Ptr());
+        } else {
+            BE1::RadixSort64(keys.Ptr(), values.Ptr(), count, tempKeys.Ptr(), tempValues.Ptr());
+        }
+
+        for (int i = 0; i < count; i++) {
+            // Values follow their keys.
+            assert(originalKeys[values[i]] == keys[i]);
+            if (i > 0) {
+                assert(keys[i - 1] <= keys[i]);
+                // Stable
+                assert(keys[i - 1] != keys[i] || values[i - 1] < values[i]);
+            }
+        }
+    }
+}
+
+static void BenchmarkSortDrawSurfs(int count) {
+    BE1::Array<TestSurf> surfs;
+    BE1::Array<TestSurf *> surfPtrs;
+    BE1::Array<uint64_t> keys;
+    BE1::Array<uint64_t> tempKeys;
+    BE1::Array<TestSurf *> tempSurfPtrs;
+
+    surfs.SetCount(count);
+    surfPtrs.SetCount(count);
+    keys.SetCount(count);
+    tempKeys.SetCount(count);
+    tempSurfPtrs.SetCount(count);
+
+    randomSeed = 1;
+    for (int i = 0; i < count; i++) {
+        surfs[i].sortKey = RandomSortKey();
+    }
+
+    // Surfaces are scattered in memory like the frame allocated draw surfaces.
+    auto shuffle = [&]() {
+        randomSeed = 7;
+        for (int i = 0; i < count; i++) {
+            surfPtrs[i] = &surfs[i];
+        }
+        for (int i = count - 1; i > 0; i--) {
+            BE1::Swap(surfPtrs[i], surfPtrs[NextRandom() % (i + 1)]);
+        }
+    };
+
+    auto radixSort = [&](bool parallel) {
+        for (int i = 0; i < count; i++) {
+            keys[i] = surfPtrs[i]->sortKey;
+        }
+        if (parallel) {
+            BE1::RadixSort64_Parallel(keys.Ptr(), surfPtrs.Ptr(), count, tempKeys.Ptr(), tempSurfPtrs.Ptr());
+        } else {
+            BE1::RadixSort64(keys.Ptr(), surfPtrs.Ptr(), count, tempKeys.Ptr(), tempSurfPtrs.Ptr());
+        }
+    };
+
+    shuffle();
+    uint64_t t0 = BE1::PlatformTime::Microseconds();
+    qsort(surfPtrs.Ptr(), count, sizeof(TestSurf *), CompareTestSurf);
+    uint64_t t1 = BE1::PlatformTime::Microseconds();
+
+    shuffle();
+    uint64_t t2 = BE1::PlatformTime::Microseconds();
+    radixSort(false);
+    uint64_t t3 = BE1::PlatformTime::Microseconds();
+
+    for (int i = 1; i < count; i++) {
+        assert(surfPtrs[i - 1]->sortKey <= surfPtrs[i]->sortKey);
+    }
+
+    shuffle();
+    uint64_t t4 = BE1::PlatformTime::Microseconds();
+    radixSort(true);
+    uint64_t t5 = BE1::PlatformTime::Microseconds();
+
+    for (int i = 1; i < count; i++) {
+        assert(surfPtrs[i - 1]->sortKey <= surfPtrs[i]->sortKey);
+    }
+
+    BE_LOG("SortDrawSurfs %7i surfs: qsort %" PRIu64 " us, radix sort %" PRIu64 " us, parallel radix sort (%i workers) %" PRIu64 " us\n", 
+        count, t1 - t0, t3 - t2, BE1::jobSystem.NumWorkers(), t5 - t4);
+}
+
+void TestRadixSort() {
+    TestRadixSortCorrectness();
+
+    BenchmarkSortDrawSurfs(10000);
+    BenchmarkSortDrawSurfs(100000);
+    BenchmarkSortDrawSurfs(1000000);
+}
@@ -23,12 +23,15 @@
         best = end - start; \
     }
 
+// SIMD processor compared against the generic implementation
+static BE1::SIMDProcessor *simdTested;
+
 static void PrintClocksGeneric(const char *string, uint64_t clocks) {
     BE_LOG("generic->%s: %" PRIu64 " clocks\n", string, clocks);
 }
 
 static void PrintClocksSIMD(const char *string, uint64_t clocksGeneric, uint64_t clocksSIMD) {
-    BE_LOG("   simd->%s: %" PRIu64 " clocks (%.2fx fast)\n", string, clocksSIMD, (float)clocksGeneric / (float)clocksSIMD);
+    BE_LOG("   %s->%s: %" PRIu64 " clocks (%.2fx fast)\n", simdTested->GetName(), string, clocksSIMD, (float)clocksGeneric / (float)clocksSIMD);
 }
 
 static void RandomFloatArrayInit(float *dst, int count, float minimum, float maximum) {
@@ -62,7 +65,7 @@ static void TestAdd() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Add(dst, c, src0, COUNT_OF(dst));
+        simdTested->Add(dst, c, src0, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -88,7 +91,7 @@ static void TestAdd() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Add(dst, src0, src1, COUNT_OF(dst));
+        simdTested->Add(dst, src0, src1, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -121,7 +124,7 @@ static void TestSub() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Sub(dst, c, src0, COUNT_OF(dst));
+        simdTested->Sub(dst, c, src0, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -147,7 +150,7 @@ static void TestSub() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Sub(dst, src0, src1, COUNT_OF(dst));
+        simdTested->Sub(dst, src0, src1, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -180,7 +183,7 @@ static void TestMul() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Mul(dst, c, src0, COUNT_OF(dst));
+        simdTested->Mul(dst, c, src0, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -206,7 +209,7 @@ static void TestMul() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Mul(dst, src0, src1, COUNT_OF(dst));
+        simdTested->Mul(dst, src0, src1, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -239,7 +242,7 @@ static void TestDiv() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Div(dst, c, src0, COUNT_OF(dst));
+        simdTested->Div(dst, c, src0, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -265,7 +268,7 @@ static void TestDiv() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Div(dst, src0, src1, COUNT_OF(dst));
+        simdTested->Div(dst, src0, src1, COUNT_OF(dst));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -296,7 +299,7 @@ static void TestSum() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        sum = BE1::simdProcessor->Sum(src, COUNT_OF(src));
+        sum = simdTested->Sum(src, COUNT_OF(src));
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -332,7 +335,7 @@ static void TestMemcpy() {
         }
 
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Memcpy(bufferDst, bufferSrc, bufferSize);
+        simdTested->Memcpy(bufferDst, bufferSrc, bufferSize);
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -370,7 +373,7 @@ static void TestMemset() {
         }
 
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->Memset(buffer, 0, bufferSize);
+        simdTested->Memset(buffer, 0, bufferSize);
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -405,7 +408,7 @@ static void TestMatrixMultiply() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->MatrixMultiply(matrixC, matrixA, matrixB);
+        simdTested->MatrixMultiply(matrixC, matrixA, matrixB);
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -438,7 +441,7 @@ static void TestMatrixTranspose() {
     bestClocksSIMD = 0;
     for (int i = 0; i < TEST_COUNT; i++) {
         uint64_t startClocks = rdtsc();
-        BE1::simdProcessor->MatrixTranspose(matrixB, matrixA);
+        simdTested->MatrixTranspose(matrixB, matrixA);
         uint64_t endClocks = rdtsc();
         GetBest(startClocks, endClocks, bestClocksSIMD);
     }
@@ -446,16 +449,462 @@ static void TestMatrixTranspose() {
     PrintClocksSIMD("MatrixTranspose", bestClocksGeneric, bestClocksSIMD);
 }
 
+#define NUM_TEST_JOINTS     256
+#define NUM_TEST_VERTS      1024
+#define NUM_TEST_TRIS       1024
+
+static void PrintAccuracySIMD(const char *string, bool ok) {
+    BE_LOG("   %s->%s: %s\n", simdTested->GetName(), string, ok ? "ok" : "mismatch");
+    assert(ok);
+}
+
+static void RandomJointPoseArrayInit(BE1::JointPose *dst, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i].q.Set(BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f));
+        dst[i].q.Normalize();
+        dst[i].t.Set(BE1::Math::Random(-100.0f, 100.0f), BE1::Math::Random(-100.0f, 100.0f), BE1::Math::Random(-100.0f, 100.0f));
+        dst[i].s.Set(BE1::Math::Random(0.5f, 2.0f), BE1::Math::Random(0.5f, 2.0f), BE1::Math::Random(0.5f, 2.0f));
+    }
+}
+
+static void RandomJointMatArrayInit(BE1::Mat3x4 *dst, int count) {
+    BE1::JointPose *poses = (BE1::JointPose *)BE1::Mem_Alloc(count * sizeof(poses[0]));
+    RandomJointPoseArrayInit(poses, count);
+    BE1::simdGeneric->ConvertJointPosesToJointMats(dst, poses, count);
+    BE1::Mem_Free(poses);
+}
+
+static bool CompareJointPoses(const BE1::JointPose *a, const BE1::JointPose *b, int count) {
+    for (int i = 0; i < count; i++) {
+        // Sign of the quaternions can be different
+        const BE1::Quat &aq = a[i].q;
+        const BE1::Quat &bq = b[i].q;
+        BE1::Quat q = aq.x * bq.x + aq.y * bq.y + aq.z * bq.z + aq.w * bq.w < 0.0f ? -bq : bq;
+        if (!a[i].q.Equals(q, 1e-3f) || !a[i].t.Equals(b[i].t, 1e-3f) || !a[i].s.Equals(b[i].s, 1e-4f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CompareJointMats(const BE1::Mat3x4 *a, const BE1::Mat3x4 *b, int count, float epsilon) {
+    for (int i = 0; i < count; i++) {
+        if (!a[i].Equals(b[i], epsilon)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef void (BE_FASTCALL BE1::SIMDProcessor::*BlendJointsFunc)(BE1::JointPose *, const BE1::JointPose *, const float, const int *, const int);
+
+static void TestBlendJointsFunc(const char *string, BlendJointsFunc func) {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::JointPose joints[NUM_TEST_JOINTS];
+    BE1::JointPose blendJoints[NUM_TEST_JOINTS];
+    BE1::JointPose jointsGeneric[NUM_TEST_JOINTS];
+    BE1::JointPose jointsSIMD[NUM_TEST_JOINTS];
+    int index[NUM_TEST_JOINTS];
+    // Odd count to test the remainder
+    const int numJoints = NUM_TEST_JOINTS - 3;
+
+    RandomJointPoseArrayInit(joints, NUM_TEST_JOINTS);
+    RandomJointPoseArrayInit(blendJoints, NUM_TEST_JOINTS);
+    for (int i = 0; i < numJoints; i++) {
+        index[i] = i;
+    }
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        memcpy(jointsGeneric, joints, sizeof(joints));
+        uint64_t startClocks = rdtsc();
+        (BE1::simdGeneric->*func)(jointsGeneric, blendJoints, 0.3f, index, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric(string, bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        memcpy(jointsSIMD, joints, sizeof(joints));
+        uint64_t startClocks = rdtsc();
+        (simdTested->*func)(jointsSIMD, blendJoints, 0.3f, index, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD(string, bestClocksGeneric, bestClocksSIMD);
+    PrintAccuracySIMD(string, CompareJointPoses(jointsGeneric, jointsSIMD, NUM_TEST_JOINTS));
+}
+
+static void TestBlendJoints() {
+    TestBlendJointsFunc("BlendJoints", &BE1::SIMDProcessor::BlendJoints);
+    TestBlendJointsFunc("BlendJointsFast", &BE1::SIMDProcessor::BlendJointsFast);
+    TestBlendJointsFunc("AdditiveBlendJoints", &BE1::SIMDProcessor::AdditiveBlendJoints);
+}
+
+static void TestDecompressJoints() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::CompressedJointPose compressedJoints[NUM_TEST_JOINTS];
+    BE1::JointPose jointsGeneric[NUM_TEST_JOINTS];
+    BE1::JointPose jointsSIMD[NUM_TEST_JOINTS];
+    int index[NUM_TEST_JOINTS];
+    const int numJoints = NUM_TEST_JOINTS - 3;
+
+    for (int i = 0; i < NUM_TEST_JOINTS; i++) {
+        BE1::Quat q(BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f));
+        q.Normalize();
+        if (q.w < 0.0f) {
+            q = -q;
+        }
+        compressedJoints[i].q[0] = BE1::CompressedJointPose::QuatToShort(q.x);
+        compressedJoints[i].q[1] = BE1::CompressedJointPose::QuatToShort(q.y);
+        compressedJoints[i].q[2] = BE1::CompressedJointPose::QuatToShort(q.z);
+        for (int k = 0; k < 3; k++) {
+            compressedJoints[i].t[k] = BE1::CompressedJointPose::TranslationToShort(BE1::Math::Random(-0.9f, 0.9f) * BE1::CompressedJointPose::MaxBoneTranslation);
+            compressedJoints[i].s[k] = BE1::CompressedJointPose::ScaleToShort(BE1::Math::Random(0.5f, 2.0f));
+        }
+    }
+    // Shuffled indexes to test the scattered accesses
+    for (int i = 0; i < numJoints; i++) {
+        index[i] = (i * 7) % numJoints;
+    }
+
+    memset(jointsGeneric, 0, sizeof(jointsGeneric));
+    memset(jointsSIMD, 0, sizeof(jointsSIMD));
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->DecompressJoints(jointsGeneric, compressedJoints, index, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("DecompressJoints", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->DecompressJoints(jointsSIMD, compressedJoints, index, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("DecompressJoints", bestClocksGeneric, bestClocksSIMD);
+    PrintAccuracySIMD("DecompressJoints", CompareJointPoses(jointsGeneric, jointsSIMD, NUM_TEST_JOINTS));
+}
+
+static void TestConvertJointPosesToJointMats() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::JointPose joints[NUM_TEST_JOINTS];
+    BE1::Mat3x4 matsGeneric[NUM_TEST_JOINTS];
+    BE1::Mat3x4 matsSIMD[NUM_TEST_JOINTS];
+    const int numJoints = NUM_TEST_JOINTS - 3;
+
+    RandomJointPoseArrayInit(joints, NUM_TEST_JOINTS);
+    memset(matsGeneric, 0, sizeof(matsGeneric));
+    memset(matsSIMD, 0, sizeof(matsSIMD));
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->ConvertJointPosesToJointMats(matsGeneric, joints, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("ConvertJointPosesToJointMats", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->ConvertJointPosesToJointMats(matsSIMD, joints, numJoints);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("ConvertJointPosesToJointMats", bestClocksGeneric, bestClocksSIMD);
+    PrintAccuracySIMD("ConvertJointPosesToJointMats", CompareJointMats(matsGeneric, matsSIMD, NUM_TEST_JOINTS, 1e-4f));
+}
+
+static void TestTransformJoints() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::Mat3x4 mats[NUM_TEST_JOINTS];
+    BE1::Mat3x4 mats2[NUM_TEST_JOINTS];
+    BE1::Mat3x4 matsGeneric[NUM_TEST_JOINTS];
+    BE1::Mat3x4 matsSIMD[NUM_TEST_JOINTS];
+    int parents[NUM_TEST_JOINTS];
+
+    // Keep the hierarchy shallow not to accumulate the translations too much
+    RandomJointMatArrayInit(mats, NUM_TEST_JOINTS);
+    RandomJointMatArrayInit(mats2, NUM_TEST_JOINTS);
+    for (int i = 0; i < NUM_TEST_JOINTS; i++) {
+        parents[i] = i < 8 ? -1 : (i - 1) & 7;
+    }
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        memcpy(matsGeneric, mats, sizeof(mats));
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->TransformJoints(matsGeneric, parents, 0, NUM_TEST_JOINTS - 1);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("TransformJoints", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        memcpy(matsSIMD, mats, sizeof(mats));
+        uint64_t startClocks = rdtsc();
+        simdTested->TransformJoints(matsSIMD, parents, 0, NUM_TEST_JOINTS - 1);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("TransformJoints", bestClocksGeneric, bestClocksSIMD);
+    PrintAccuracySIMD("TransformJoints", CompareJointMats(matsGeneric, matsSIMD, NUM_TEST_JOINTS, 1e-2f));
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->MultiplyJoints(matsGeneric, mats, mats2, NUM_TEST_JOINTS);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("MultiplyJoints", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->MultiplyJoints(matsSIMD, mats, mats2, NUM_TEST_JOINTS);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("MultiplyJoints", bestClocksGeneric, bestClocksSIMD);
+    PrintAccuracySIMD("MultiplyJoints", CompareJointMats(matsGeneric, matsSIMD, NUM_TEST_JOINTS, 1e-2f));
+}
+
+static void TestTransformVerts() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::Mat3x4 mats[NUM_TEST_JOINTS];
+    BE1::VertexGenericLit *vertsGeneric = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::VertexGenericLit *vertsSIMD = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::Vec4 *base = (BE1::Vec4 *)BE1::Mem_Alloc16(NUM_TEST_VERTS * 4 * sizeof(BE1::Vec4));
+    int *index = (int *)BE1::Mem_Alloc16(NUM_TEST_VERTS * 4 * 2 * sizeof(int));
+    int numWeights = 0;
+
+    RandomJointMatArrayInit(mats, NUM_TEST_JOINTS);
+
+    // 1 ~ 4 weights per vertex. base is the weighted vertex position and index is the byte offset of the joint matrix
+    for (int i = 0; i < NUM_TEST_VERTS; i++) {
+        const int count = (i & 3) + 1;
+        const BE1::Vec3 v(BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f));
+
+        for (int j = 0; j < count; j++) {
+            const float weight = 1.0f / count;
+            base[numWeights].Set(v.x * weight, v.y * weight, v.z * weight, weight);
+            index[numWeights * 2 + 0] = (rand() % NUM_TEST_JOINTS) * sizeof(BE1::Mat3x4);
+            index[numWeights * 2 + 1] = j == count - 1 ? 1 : 0;
+            numWeights++;
+        }
+    }
+
+    memset(vertsGeneric, 0, NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    memset(vertsSIMD, 0, NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->TransformVerts(vertsGeneric, NUM_TEST_VERTS, mats, base, index, numWeights);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("TransformVerts", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->TransformVerts(vertsSIMD, NUM_TEST_VERTS, mats, base, index, numWeights);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("TransformVerts", bestClocksGeneric, bestClocksSIMD);
+
+    bool ok = true;
+    for (int i = 0; i < NUM_TEST_VERTS && ok; i++) {
+        ok = vertsGeneric[i].xyz.Equals(vertsSIMD[i].xyz, 1e-2f);
+    }
+    PrintAccuracySIMD("TransformVerts", ok);
+
+    BE1::Mem_AlignedFree(index);
+    BE1::Mem_AlignedFree(base);
+    BE1::Mem_AlignedFree(vertsSIMD);
+    BE1::Mem_AlignedFree(vertsGeneric);
+}
+
+static void TestSkinVerts() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::Mat3x4 mats[NUM_TEST_JOINTS];
+    BE1::VertexGenericLit *srcVerts = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::VertexGenericLit *vertsGeneric = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::VertexGenericLit *vertsSIMD = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::VertexWeight4 *vertWeights = (BE1::VertexWeight4 *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexWeight4));
+
+    RandomJointMatArrayInit(mats, NUM_TEST_JOINTS);
+
+    for (int i = 0; i < NUM_TEST_VERTS; i++) {
+        BE1::Vec3 normal(BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f), BE1::Math::Random(-1.0f, 1.0f));
+        BE1::Vec3 tangent = normal.Cross(BE1::Vec3::unitZ);
+        normal.Normalize();
+        tangent.Normalize();
+
+        srcVerts[i].Clear();
+        srcVerts[i].xyz.Set(BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f), BE1::Math::Random(-10.0f, 10.0f));
+        srcVerts[i].SetNormal(normal);
+        srcVerts[i].SetTangent(tangent);
+        srcVerts[i].SetBiTangentSign((i & 1) ? 1.0f : -1.0f);
+
+        // 4 weights summing up to 255
+        int remaining = 255;
+        for (int j = 0; j < 4; j++) {
+            const int weight = j == 3 ? remaining : rand() % (remaining + 1);
+            vertWeights[i].jointIndexes[j] = rand() % NUM_TEST_JOINTS;
+            vertWeights[i].jointWeights[j] = weight;
+            remaining -= weight;
+        }
+    }
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->SkinVerts(vertsGeneric, srcVerts, NUM_TEST_VERTS, mats, vertWeights, 4);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("SkinVerts", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->SkinVerts(vertsSIMD, srcVerts, NUM_TEST_VERTS, mats, vertWeights, 4);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("SkinVerts", bestClocksGeneric, bestClocksSIMD);
+
+    // Normals and tangents are quantized to bytes
+    bool ok = true;
+    for (int i = 0; i < NUM_TEST_VERTS && ok; i++) {
+        ok = vertsGeneric[i].xyz.Equals(vertsSIMD[i].xyz, 1e-2f) &&
+            vertsGeneric[i].GetNormal().Equals(vertsSIMD[i].GetNormal(), 2e-2f) &&
+            vertsGeneric[i].GetTangent().Equals(vertsSIMD[i].GetTangent(), 2e-2f) &&
+            vertsGeneric[i].GetBiTangentSign() == vertsSIMD[i].GetBiTangentSign();
+    }
+    PrintAccuracySIMD("SkinVerts", ok);
+
+    BE1::Mem_AlignedFree(vertWeights);
+    BE1::Mem_AlignedFree(vertsSIMD);
+    BE1::Mem_AlignedFree(vertsGeneric);
+    BE1::Mem_AlignedFree(srcVerts);
+}
+
+static void TestDeriveTriPlanes() {
+    uint64_t bestClocksGeneric;
+    uint64_t bestClocksSIMD;
+    BE1::VertexGenericLit *verts = (BE1::VertexGenericLit *)BE1::Mem_Alloc16(NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    BE1::Plane *planesGeneric = (BE1::Plane *)BE1::Mem_Alloc16(NUM_TEST_TRIS * sizeof(BE1::Plane));
+    BE1::Plane *planesSIMD = (BE1::Plane *)BE1::Mem_Alloc16(NUM_TEST_TRIS * sizeof(BE1::Plane));
+    int *indexes = (int *)BE1::Mem_Alloc16(NUM_TEST_TRIS * 3 * sizeof(int));
+    // Odd count to test the remainder
+    const int numTris = NUM_TEST_TRIS - 3;
+
+    memset(verts, 0, NUM_TEST_VERTS * sizeof(BE1::VertexGenericLit));
+    for (int i = 0; i < NUM_TEST_VERTS; i++) {
+        verts[i].xyz.Set(BE1::Math::Random(-100.0f, 100.0f), BE1::Math::Random(-100.0f, 100.0f), BE1::Math::Random(-100.0f, 100.0f));
+    }
+    for (int i = 0; i < numTris * 3; i++) {
+        indexes[i] = rand() % NUM_TEST_VERTS;
+    }
+
+    bestClocksGeneric = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        BE1::simdGeneric->DeriveTriPlanes(planesGeneric, verts, NUM_TEST_VERTS, indexes, numTris * 3);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksGeneric);
+    }
+
+    PrintClocksGeneric("DeriveTriPlanes", bestClocksGeneric);
+
+    bestClocksSIMD = 0;
+    for (int i = 0; i < TEST_COUNT; i++) {
+        uint64_t startClocks = rdtsc();
+        simdTested->DeriveTriPlanes(planesSIMD, verts, NUM_TEST_VERTS, indexes, numTris * 3);
+        uint64_t endClocks = rdtsc();
+        GetBest(startClocks, endClocks, bestClocksSIMD);
+    }
+
+    PrintClocksSIMD("DeriveTriPlanes", bestClocksGeneric, bestClocksSIMD);
+
+    // Generic version normalizes with the approximated reciprocal square root
+    bool ok = true;
+    for (int i = 0; i < numTris && ok; i++) {
+        ok = planesGeneric[i].normal.Equals(planesSIMD[i].normal, 1e-2f) &&
+            BE1::Math::Fabs(planesGeneric[i].offset - planesSIMD[i].offset) <= 1e-2f * BE1::Max(BE1::Math::Fabs(planesGeneric[i].offset), 1.0f);
+    }
+    PrintAccuracySIMD("DeriveTriPlanes", ok);
+
+    BE1::Mem_AlignedFree(indexes);
+    BE1::Mem_AlignedFree(planesSIMD);
+    BE1::Mem_AlignedFree(planesGeneric);
+    BE1::Mem_AlignedFree(verts);
+}
+
 void TestSIMD() {
     BE_LOG("Testing SIMD processors..\n");
 
-    TestAdd();
-    TestSub();
-    TestMul();
-    TestDiv();
-    TestSum();
-    TestMemcpy();
-    TestMemset();
-    TestMatrixMultiply();
-    TestMatrixTranspose();
+    // Test all the SIMD processors supported by this CPU, not only the one in use.
+    for (int type = BE1::SIMD::Type::Generic + 1; type < BE1::SIMD::Type::Count; type++) {
+        simdTested = BE1::SIMD::CreateProcessor((BE1::SIMD::Type::Enum)type);
+        if (!simdTested) {
+            continue;
+        }
+
+        BE_LOG("Testing %s..\n", simdTested->GetName());
+
+        TestAdd();
+        TestSub();
+        TestMul();
+        TestDiv();
+        TestSum();
+        TestMemcpy();
+        TestMemset();
+        TestMatrixMultiply();
+        TestMatrixTranspose();
+        TestDecompressJoints();
+        TestBlendJoints();
+        TestConvertJointPosesToJointMats();
+        TestTransformJoints();
+        TestTransformVerts();
+        TestSkinVerts();
+        TestDeriveTriPlanes();
+
+        delete simdTested;
+        simdTested = nullptr;
+    }
 }
@@ -0,0 +1,134 @@
+// Copyright(c) 2017 POLYGONTEK
+// 
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+// http ://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "BlueshiftEngine.h"
+#include "StaticBatching/StaticBatch.h"
+#include "TestStaticBatch.h"
+
+// Sets up what Init() and MeshCombiner set up, so that renderers can be tested without a game world.
+class TestStaticMeshRenderer : public BE1::ComStaticMeshRenderer {
+public:
+    void Setup(BE1::Mesh *ownMesh, BE1::Mesh *renderedMesh, const BE1::Vec3 &origin) {
+        referenceMesh = ownMesh;
+        renderObjectDef.mesh = renderedMesh;
+        renderObjectDef.worldMatrix = BE1::Mat3x4(BE1::Mat3::identity, origin);
+    }
+
+    void AddToStaticBatch(BE1::StaticBatch *staticBatch) {
+        staticBatchIndex = staticBatch->GetIndex();
+        staticBatch->AddRenderable(this);
+    }
+
+    // Meshes are owned by the test.
+    void DetachMeshes() {
+        referenceMesh = nullptr;
+        renderObjectDef.mesh = nullptr;
+    }
+};
+
+static BE1::Ray MakeRayAlongY(float x) {
+    BE1::Ray ray;
+    ray.origin = BE1::Vec3(x, -100.0f, 0.0f);
+    ray.dir = BE1::Vec3(0.0f, 1.0f, 0.0f);
+    return ray;
+}
+
+// Picks an entity in a static batch. The batch root renders the combined mesh of all the renderers in the batch,
+// so hitting the combined mesh doesn't tell which renderer is hit.
+static void TestStaticBatchIntersectRay() {
+    BE1::Mesh rootMesh;
+    rootMesh.CreateBox(BE1::Vec3::origin, BE1::Mat3::identity, BE1::Vec3(1.0f));
+
+    BE1::Mesh childMesh;
+    childMesh.CreateBox(BE1::Vec3::origin, BE1::Mat3::identity, BE1::Vec3(1.0f));
+
+    // Covers both of the meshes at x = 0 and x = 10, and also the gap between them.
+    BE1::Mesh combinedMesh;
+    combinedMesh.CreateBox(BE1::Vec3(5.0f, 0.0f, 0.0f), BE1::Mat3::identity, BE1::Vec3(6.0f, 1.0f, 1.0f));
+
+    BE1::Entity *rootEntity = static_cast<BE1::Entity *>(BE1::Entity::metaObject.CreateInstance(BE1::Guid::zero));
+    BE1::Entity *childEntity = static_cast<BE1::Entity *>(BE1::Entity::metaObject.CreateInstance(BE1::Guid::zero));
+
+    TestStaticMeshRenderer *rootRenderer = new TestStaticMeshRenderer;
+    rootRenderer->SetEntity(rootEntity);
+    rootRenderer->Setup(&rootMesh, &combinedMesh, BE1::Vec3::origin);
+
+    TestStaticMeshRenderer *childRenderer = new TestStaticMeshRenderer;
+    childRenderer->SetEntity(childEntity);
+    childRenderer->Setup(&childMesh, &childMesh, BE1::Vec3(10.0f, 0.0f, 0.0f));
+
+    BE1::StaticBatch *staticBatch = BE1::StaticBatch::AllocStaticBatch(rootEntity);
+    rootRenderer->AddToStaticBatch(staticBatch);
+    childRenderer->AddToStaticBatch(staticBatch);
+
+    const BE1::Array<BE1::Entity *> noExcludingEntities;
+    float dist;
+
+    // The root renderer is hit only by its own mesh
+    assert(rootRenderer->IntersectRay(MakeRayAlongY(0.0f), true, &dist));
+    assert(!rootRenderer->IntersectRay(MakeRayAlongY(10.0f), true, &dist));
+    assert(!rootRenderer->IntersectRay(MakeRayAlongY(5.0f), true, &dist));
+
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(0.0f), true, -1, noExcludingEntities, dist) == rootEntity);
+    assert(BE1::Math::Fabs(dist - 99.0f) < 0.001f);
+
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(10.0f), true, -1, noExcludingEntities, dist) == childEntity);
+    assert(BE1::Math::Fabs(dist - 99.0f) < 0.001f);
+
+    // Nearer hits than the given distance only
+    dist = 50.0f;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(10.0f), true, -1, noExcludingEntities, dist) == nullptr);
+    assert(dist == 50.0f);
+
+    // Hits only the combined mesh
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(5.0f), true, -1, noExcludingEntities, dist) == nullptr);
+
+    // Excluded by entity and by layer
+    BE1::Array<BE1::Entity *> excludingEntities;
+    excludingEntities.Append(childEntity);
+
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(10.0f), true, -1, excludingEntities, dist) == nullptr);
+
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(10.0f), true, ~BIT(childEntity->GetLayer()), noExcludingEntities, dist) == nullptr);
+
+    // Destroyed renderers are removed from the batch
+    assert(staticBatch->NumRenderables() == 2);
+
+    childRenderer->DetachMeshes();
+    delete childRenderer;
+
+    assert(staticBatch->NumRenderables() == 1);
+
+    dist = FLT_MAX;
+    assert(staticBatch->IntersectRay(MakeRayAlongY(10.0f), true, -1, noExcludingEntities, dist) == nullptr);
+
+    rootRenderer->DetachMeshes();
+    delete rootRenderer;
+
+    assert(staticBatch->NumRenderables() == 0);
+
+    BE1::StaticBatch::DestroyStaticBatch(staticBatch);
+
+    BE1::Entity::DestroyInstanceImmediate(rootEntity);
+    BE1::Entity::DestroyInstanceImmediate(childEntity);
+}
+
+void TestStaticBatch() {
+    TestStaticBatchIntersectRay();
+}
@@ -127,6 +127,26 @@ public:
         lua_gc(_l, LUA_GCCOLLECT, 0);
     }
 
+    // Performs an incremental step of the garbage collection.
+    // Returns true if the step finished a collection cycle.
+    bool StepGC(int stepKb) {
+        return lua_gc(_l, LUA_GCSTEP, stepKb) != 0;
+    }
+
+    // Switches the garbage collector to the generational mode.
+    // Returns false if this Lua version doesn't support it.
+    bool SetGenerationalGC() {
+#if defined(LUA_GCGEN) && LUA_VERSION_NUM >= 504
+        lua_gc(_l, LUA_GCGEN, 0, 0);
+        return true;
+#elif defined(LUA_GCGEN)
+        lua_gc(_l, LUA_GCGEN, 0);
+        return true;
+#else
+        return false;
+#endif
+    }
+
     int GetGCKb() {
         // Returns the current amount of memory (in Kbytes) in use by Lua.
         int kb = lua_gc(_l, LUA_GCCOUNT, 0);